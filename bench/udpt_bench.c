@@ -0,0 +1,786 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup udpt_bench UDP Template Engine Benchmark
+ * @brief Micro-benchmark of the render and send pipeline
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file udpt_bench.c
+
+    UDP Template Engine Benchmark
+
+    The udpt_bench application measures the template render and datagram
+    send paths used by udpt.  Synthetic templates of varying size and
+    variable count are compiled and rendered against an in-process
+    variable source, and batches of datagrams are sent to a local
+    discard socket on the loopback interface.  The render cost is
+    reported in ns/render, and the send cost in ns/packet and packets/s.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <varserver/varserver.h>
+#include "ctemplate.h"
+#include "txbatch.h"
+#include "txsched.h"
+#include "varstub.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+#ifndef BENCH_RENDER_BUFFER_SIZE
+/*! size of the render output buffer */
+#define BENCH_RENDER_BUFFER_SIZE ( CTEMPLATE_MAX_SIZE * 4 )
+#endif
+
+/*! benchmark configuration */
+typedef struct _benchConfig
+{
+    /*! number of render iterations per template */
+    size_t renderIterations;
+
+    /*! number of datagrams to send per payload size */
+    size_t sendPackets;
+
+    /*! number of datagrams per transmit batch */
+    size_t batchSize;
+
+} BenchConfig;
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! synthetic template sizes (bytes of static text) */
+static const size_t templateSizes[] = { 64, 512, 1400, 8192 };
+
+/*! synthetic template variable counts */
+static const size_t varCounts[] = { 0, 8, 32, 128 };
+
+/*! datagram payload sizes */
+static const size_t payloadSizes[] = { 64, 512, 1472 };
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+int main( int argc, char **argv );
+static int ProcessOptions( int argC, char *argV[], BenchConfig *pConfig );
+static void usage( char *cmdname );
+static int MakeTemplate( char *filename,
+                         size_t size,
+                         size_t nVars,
+                         size_t *pLen );
+static int BenchRender( BenchConfig *pConfig, size_t size, size_t nVars );
+static int BenchSend( BenchConfig *pConfig, size_t payloadSize );
+static int OpenSink( struct sockaddr_in *pAddr );
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  main                                                                      */
+/*!
+    Main entry point for the UDP Template Engine benchmark
+
+    The main function runs the render benchmark for each combination
+    of template size and variable count, followed by the send benchmark
+    for each payload size.
+
+    @param[in]
+        argc
+            number of arguments on the command line
+            (including the command itself)
+
+    @param[in]
+        argv
+            array of pointers to the command line arguments
+
+    @retval 0 - no error
+    @retval 1 - an error occurred
+
+==============================================================================*/
+int main( int argc, char **argv )
+{
+    BenchConfig config;
+    int result = EOK;
+    size_t i;
+    size_t j;
+
+    config.renderIterations = 10000;
+    config.sendPackets = 100000;
+    config.batchSize = TXBATCH_MAX_MSGS;
+
+    ProcessOptions( argc, argv, &config );
+
+    printf( "%-8s %8s %6s %12s %12s %12s %12s %12s %10s\n",
+            "render", "size", "vars", "ns/render", "ns/snap", "ns/buffer",
+            "ns/cached", "ns/cbor", "cbor size" );
+    for ( i = 0; i < sizeof( templateSizes ) / sizeof( templateSizes[0] ); i++ )
+    {
+        for ( j = 0; j < sizeof( varCounts ) / sizeof( varCounts[0] ); j++ )
+        {
+            if ( BenchRender( &config, templateSizes[i], varCounts[j] ) != EOK )
+            {
+                result = EIO;
+            }
+        }
+    }
+
+    printf( "\n%-8s %8s %6s %12s %12s %10s\n",
+            "send", "size", "batch", "ns/packet", "packets/s", "calls" );
+    for ( i = 0; i < sizeof( payloadSizes ) / sizeof( payloadSizes[0] ); i++ )
+    {
+        if ( BenchSend( &config, payloadSizes[i] ) != EOK )
+        {
+            result = EIO;
+        }
+    }
+
+    return ( result == EOK ) ? 0 : 1;
+}
+
+/*============================================================================*/
+/*  usage                                                                     */
+/*!
+    Display the application usage
+
+    The usage function dumps the application usage message
+    to stderr.
+
+    @param[in]
+       cmdname
+            pointer to the invoked command name
+
+    @return none
+
+==============================================================================*/
+static void usage( char *cmdname )
+{
+    if( cmdname != NULL )
+    {
+        fprintf( stderr,
+                 "usage: %s [-h] [-n renders] [-p packets] [-b batch]\n"
+                 " [-n] : number of renders per template\n"
+                 " [-p] : number of packets per payload size\n"
+                 " [-b] : number of packets per transmit batch\n"
+                 " [-h] : display this help\n",
+                 cmdname );
+    }
+}
+
+/*============================================================================*/
+/*  ProcessOptions                                                            */
+/*!
+    Process the command line options
+
+    The ProcessOptions function processes the command line options and
+    populates the BenchConfig object
+
+    @param[in]
+        argC
+            number of arguments
+            (including the command itself)
+
+    @param[in]
+        argv
+            array of pointers to the command line arguments
+
+    @param[in]
+        pConfig
+            pointer to the benchmark configuration
+
+    @return 0
+
+==============================================================================*/
+static int ProcessOptions( int argC, char *argV[], BenchConfig *pConfig )
+{
+    int c;
+    const char *options = "hn:p:b:";
+
+    if( ( pConfig != NULL ) &&
+        ( argV != NULL ) )
+    {
+        while( ( c = getopt( argC, argV, options ) ) != -1 )
+        {
+            switch( c )
+            {
+                case 'h':
+                    usage( argV[0] );
+                    exit( 0 );
+                    break;
+
+                case 'n':
+                    pConfig->renderIterations = strtoul( optarg, NULL, 0 );
+                    break;
+
+                case 'p':
+                    pConfig->sendPackets = strtoul( optarg, NULL, 0 );
+                    break;
+
+                case 'b':
+                    pConfig->batchSize = strtoul( optarg, NULL, 0 );
+                    if ( ( pConfig->batchSize == 0 ) ||
+                         ( pConfig->batchSize > TXBATCH_MAX_MSGS ) )
+                    {
+                        pConfig->batchSize = TXBATCH_MAX_MSGS;
+                    }
+                    break;
+
+                default:
+                    break;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/*============================================================================*/
+/*  MakeTemplate                                                              */
+/*!
+    Create a synthetic template file
+
+    The MakeTemplate function creates a temporary JSON template file
+    containing the specified number of variable references, padded
+    with static text to approximately the specified size.
+
+    @param[in,out]
+        filename
+            mkstemp() template for the name of the file to create.
+            On return it contains the name of the created file.
+
+    @param[in]
+        size
+            approximate number of bytes of template text
+
+    @param[in]
+        nVars
+            number of variable references in the template
+
+    @param[out]
+        pLen
+            pointer to a location to store the template length
+
+    @retval EOK the template was created
+    @retval EIO the template could not be written
+    @retval other error from mkstemp() or close()
+
+==============================================================================*/
+static int MakeTemplate( char *filename,
+                         size_t size,
+                         size_t nVars,
+                         size_t *pLen )
+{
+    int result = EOK;
+    size_t len = 0;
+    size_t i;
+    int fd;
+    int n;
+
+    fd = mkstemp( filename );
+    if ( fd == -1 )
+    {
+        result = errno;
+    }
+    else
+    {
+        n = dprintf( fd, "{" );
+        result = ( n > 0 ) ? EOK : EIO;
+        len += ( n > 0 ) ? (size_t)n : 0;
+
+        for ( i = 0; ( i < nVars ) && ( result == EOK ); i++ )
+        {
+            n = dprintf( fd,
+                         "\"k%zu\":\"${" VARSTUB_PREFIX "%zu}\",",
+                         i,
+                         i % VARSTUB_MAX_VARS );
+            result = ( n > 0 ) ? EOK : EIO;
+            len += ( n > 0 ) ? (size_t)n : 0;
+        }
+
+        if ( result == EOK )
+        {
+            n = dprintf( fd, "\"pad\":\"" );
+            result = ( n > 0 ) ? EOK : EIO;
+            len += ( n > 0 ) ? (size_t)n : 0;
+        }
+
+        while ( ( result == EOK ) && ( len + 2 < size ) )
+        {
+            n = dprintf( fd, "x" );
+            result = ( n > 0 ) ? EOK : EIO;
+            len += ( n > 0 ) ? (size_t)n : 0;
+        }
+
+        if ( result == EOK )
+        {
+            n = dprintf( fd, "\"}" );
+            result = ( n > 0 ) ? EOK : EIO;
+            len += ( n > 0 ) ? (size_t)n : 0;
+        }
+
+        if ( ( close( fd ) != 0 ) &&
+             ( result == EOK ) )
+        {
+            result = errno;
+        }
+    }
+
+    *pLen = len;
+
+    return result;
+}
+
+/*============================================================================*/
+/*  BenchRender                                                               */
+/*!
+    Run the render benchmark for one synthetic template
+
+    The BenchRender function compiles a synthetic template and renders
+    it repeatedly into a shared memory buffer, in the same way as udpt
+    renders into its VarFP output stream.  It then renders the same
+    template repeatedly as CBOR into a memory buffer, as udpt does for
+    channels using the binary encoding.  The text rendering is also
+    measured when formatted from a variable snapshot taken before each
+    render, as udpt does with the -S option, both into the shared memory
+    buffer and into an in-process buffer, as udpt renders text.  The
+    incremental rendering (-I) is measured with one variable changing
+    between renders.
+
+    @param[in]
+        pConfig
+            pointer to the benchmark configuration
+
+    @param[in]
+        size
+            approximate template size
+
+    @param[in]
+        nVars
+            number of variable references in the template
+
+    @retval EOK the benchmark completed
+    @retval other error from the template compiler or renderer
+
+==============================================================================*/
+static int BenchRender( BenchConfig *pConfig, size_t size, size_t nVars )
+{
+    char filename[] = "/tmp/udpt_bench_XXXXXX";
+    CompiledTemplate compiled;
+    VarSnapshot snap;
+    CborWriter writer;
+    CTBuffer buffer;
+    char *pBinary;
+    uint64_t start_ns;
+    uint64_t elapsed_ns;
+    uint64_t snap_ns = 0;
+    uint64_t buffer_ns = 0;
+    uint64_t cached_ns = 0;
+    uint64_t cbor_ns = 0;
+    size_t len = 0;
+    size_t i;
+    int result = EOK;
+    int fd = -1;
+
+    memset( &compiled, 0, sizeof( compiled ) );
+    memset( &snap, 0, sizeof( snap ) );
+
+    pBinary = malloc( BENCH_RENDER_BUFFER_SIZE );
+    if ( pBinary == NULL )
+    {
+        result = ENOMEM;
+    }
+    else
+    {
+        result = MakeTemplate( filename, size, nVars, &len );
+        if ( result != EOK )
+        {
+            fprintf( stderr,
+                     "Failed to create template: %s\n",
+                     strerror( result ) );
+        }
+    }
+
+    if ( result == EOK )
+    {
+        fd = memfd_create( "udpt_bench", MFD_CLOEXEC );
+        if ( fd == -1 )
+        {
+            result = errno;
+        }
+        else if ( ftruncate( fd, BENCH_RENDER_BUFFER_SIZE ) != 0 )
+        {
+            result = errno;
+        }
+        else
+        {
+            result = CTEMPLATE_Compile( &compiled, NULL, filename );
+        }
+    }
+
+    if ( result == EOK )
+    {
+        start_ns = SCHED_Now();
+
+        for ( i = 0; ( i < pConfig->renderIterations ) && ( result == EOK ); i++ )
+        {
+            if ( lseek( fd, 0, SEEK_SET ) != 0 )
+            {
+                result = EIO;
+            }
+            else
+            {
+                result = CTEMPLATE_RenderSplice( &compiled,
+                                                 NULL,
+                                                 NULL,
+                                                 fd,
+                                                 NULL );
+            }
+        }
+
+        elapsed_ns = SCHED_Now() - start_ns;
+
+        for ( i = 0; ( i < compiled.nElements ) && ( result == EOK ); i++ )
+        {
+            if ( compiled.elements[i].isVar == true )
+            {
+                result = VARSNAP_Add( &snap, compiled.elements[i].hVar );
+            }
+        }
+
+        start_ns = SCHED_Now();
+
+        for ( i = 0; ( i < pConfig->renderIterations ) && ( result == EOK ); i++ )
+        {
+            if ( lseek( fd, 0, SEEK_SET ) != 0 )
+            {
+                result = EIO;
+            }
+            else
+            {
+                (void)VARSNAP_Take( &snap, NULL );
+                result = CTEMPLATE_RenderSplice( &compiled,
+                                                 NULL,
+                                                 &snap,
+                                                 fd,
+                                                 NULL );
+            }
+        }
+
+        snap_ns = SCHED_Now() - start_ns;
+
+        buffer.pBuf = pBinary;
+        buffer.size = BENCH_RENDER_BUFFER_SIZE;
+        buffer.fd = -1;
+        buffer.pFdData = NULL;
+        buffer.fdSize = 0;
+
+        start_ns = SCHED_Now();
+
+        for ( i = 0; ( i < pConfig->renderIterations ) && ( result == EOK ); i++ )
+        {
+            (void)VARSNAP_Take( &snap, NULL );
+            result = CTEMPLATE_RenderBuffer( &compiled,
+                                             NULL,
+                                             &snap,
+                                             &buffer,
+                                             NULL );
+        }
+
+        buffer_ns = SCHED_Now() - start_ns;
+
+        /* subscribe the references as udpt does.  The stub variables
+           never notify, so the benchmark invalidates the changed
+           reference itself */
+        if ( result == EOK )
+        {
+            result = CTEMPLATE_Subscribe( &compiled, NULL, NULL, 0 );
+        }
+
+        start_ns = SCHED_Now();
+
+        for ( i = 0; ( i < pConfig->renderIterations ) && ( result == EOK ); i++ )
+        {
+            /* change one variable between renders.  The snapshot holds
+               the handle of each variable the template references, so
+               static text elements never flush the whole cache */
+            if ( snap.n > 0 )
+            {
+                (void)CTEMPLATE_Invalidate( &compiled,
+                                            snap.entries[i % snap.n].hVar );
+            }
+            (void)VARSNAP_Take( &snap, NULL );
+            result = CTEMPLATE_RenderCached( &compiled,
+                                             NULL,
+                                             &snap,
+                                             &buffer,
+                                             NULL );
+        }
+
+        cached_ns = SCHED_Now() - start_ns;
+
+        start_ns = SCHED_Now();
+
+        for ( i = 0; ( i < pConfig->renderIterations ) && ( result == EOK ); i++ )
+        {
+            CBOR_Init( &writer, pBinary, BENCH_RENDER_BUFFER_SIZE );
+            result = CTEMPLATE_RenderCBOR( &compiled,
+                                           NULL,
+                                           NULL,
+                                           &writer,
+                                           NULL );
+        }
+
+        cbor_ns = SCHED_Now() - start_ns;
+
+        if ( result == EOK )
+        {
+            printf( "%-8s %8zu %6zu %12.0f %12.0f %12.0f %12.0f %12.0f %10zu\n",
+                    "",
+                    len,
+                    nVars,
+                    ( i > 0 ) ? (double)elapsed_ns / i : 0.0,
+                    ( i > 0 ) ? (double)snap_ns / i : 0.0,
+                    ( i > 0 ) ? (double)buffer_ns / i : 0.0,
+                    ( i > 0 ) ? (double)cached_ns / i : 0.0,
+                    ( i > 0 ) ? (double)cbor_ns / i : 0.0,
+                    writer.len );
+        }
+    }
+
+    if ( result != EOK )
+    {
+        fprintf( stderr, "render benchmark failed: %s\n", strerror( result ) );
+    }
+
+    CTEMPLATE_Free( &compiled );
+    VARSNAP_Free( &snap );
+    free( pBinary );
+
+    if ( fd != -1 )
+    {
+        close( fd );
+    }
+
+    unlink( filename );
+
+    return result;
+}
+
+/*============================================================================*/
+/*  BenchSend                                                                 */
+/*!
+    Run the send benchmark for one payload size
+
+    The BenchSend function sends datagrams of the specified size to a
+    local discard socket using transmit batches, in the same way as
+    udpt sends each pass's datagrams.
+
+    @param[in]
+        pConfig
+            pointer to the benchmark configuration
+
+    @param[in]
+        payloadSize
+            size of each datagram payload
+
+    @retval EOK the benchmark completed
+    @retval other error from the socket setup or the sends
+
+==============================================================================*/
+static int BenchSend( BenchConfig *pConfig, size_t payloadSize )
+{
+    static TxBatch batch;
+    struct sockaddr_in addr;
+    uint64_t start_ns;
+    uint64_t elapsed_ns;
+    size_t sent = 0;
+    size_t errors = 0;
+    size_t calls = 0;
+    size_t slotSize;
+    size_t i;
+    char *pSlot;
+    int result = EOK;
+    int sink;
+    int fd = -1;
+
+    sink = OpenSink( &addr );
+    if ( sink == -1 )
+    {
+        result = errno;
+        fprintf( stderr, "Failed to open sink: %s\n", strerror( result ) );
+    }
+    else
+    {
+        fd = socket( AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0 );
+        if ( fd == -1 )
+        {
+            result = errno;
+        }
+    }
+
+    if ( result == EOK )
+    {
+        start_ns = SCHED_Now();
+
+        while ( sent + errors < pConfig->sendPackets )
+        {
+            TXBATCH_Reset( &batch );
+
+            pSlot = TXBATCH_GetSlot( &batch, &slotSize );
+            for ( i = 0;
+                  ( i < pConfig->batchSize ) &&
+                  ( sent + errors + i < pConfig->sendPackets ) &&
+                  ( pSlot != NULL );
+                  i++ )
+            {
+                memset( pSlot, 'x', payloadSize );
+                (void)TXBATCH_Add( &batch,
+                                   fd,
+                                   (struct sockaddr *)&addr,
+                                   sizeof( addr ),
+                                   pSlot,
+                                   ( payloadSize < slotSize ) ? payloadSize
+                                                              : slotSize,
+                                   NULL );
+
+                pSlot = TXBATCH_GetSlot( &batch, &slotSize );
+            }
+
+            (void)TXBATCH_Send( &batch );
+            calls += batch.nCalls;
+
+            for ( i = 0; i < batch.n; i++ )
+            {
+                if ( batch.result[i] == EOK )
+                {
+                    sent++;
+                }
+                else
+                {
+                    errors++;
+                }
+            }
+        }
+
+        elapsed_ns = SCHED_Now() - start_ns;
+
+        printf( "%-8s %8zu %6zu %12.0f %12.0f %10zu",
+                "",
+                payloadSize,
+                pConfig->batchSize,
+                ( sent + errors > 0 ) ? (double)elapsed_ns / ( sent + errors )
+                                      : 0.0,
+                ( elapsed_ns > 0 ) ? (double)sent * 1e9 / elapsed_ns : 0.0,
+                calls );
+
+        if ( errors > 0 )
+        {
+            printf( " (%zu errors)", errors );
+            result = EIO;
+        }
+
+        printf( "\n" );
+    }
+
+    if ( fd != -1 )
+    {
+        close( fd );
+    }
+
+    if ( sink != -1 )
+    {
+        close( sink );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  OpenSink                                                                  */
+/*!
+    Open a local discard socket
+
+    The OpenSink function opens a UDP socket bound to an ephemeral port
+    on the loopback interface.  The socket is never read, so datagrams
+    sent to it are discarded by the kernel once its receive buffer is
+    full.
+
+    @param[out]
+        pAddr
+            pointer to a location to store the address of the socket
+
+    @retval the socket file descriptor
+    @retval -1 the socket could not be opened
+
+==============================================================================*/
+static int OpenSink( struct sockaddr_in *pAddr )
+{
+    socklen_t len = sizeof( struct sockaddr_in );
+    int fd;
+
+    fd = socket( AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0 );
+    if ( fd != -1 )
+    {
+        memset( pAddr, 0, sizeof( struct sockaddr_in ) );
+        pAddr->sin_family = AF_INET;
+        pAddr->sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+        pAddr->sin_port = 0;
+
+        if ( ( bind( fd, (struct sockaddr *)pAddr, len ) != 0 ) ||
+             ( getsockname( fd, (struct sockaddr *)pAddr, &len ) != 0 ) )
+        {
+            close( fd );
+            fd = -1;
+        }
+    }
+
+    return fd;
+}
+
+/*! @}
+ * end of udpt_bench group */
@@ -0,0 +1,236 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup varstub Benchmark Variable Source
+ * @brief In-process stand-in for the variable server
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file varstub.c
+
+    Benchmark Variable Source
+
+    The varstub component provides an in-process implementation of the
+    variable server functions used by the template renderer, so the
+    render and send pipeline can be benchmarked without a running
+    variable server.  Variables are named /bench/var<n>, and each one
+    renders as a counter which changes every time it is printed.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <varserver/varserver.h>
+#include "varstub.h"
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! current value of each benchmark variable */
+static uint32_t values[VARSTUB_MAX_VARS];
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  VAR_FindByName                                                            */
+/*!
+    Find a benchmark variable by name
+
+    The VAR_FindByName function gets the handle of a benchmark variable
+    named /bench/var<n>
+
+    @param[in]
+        hVarServer
+            handle to the variable server (unused)
+
+    @param[in]
+        name
+            name of the variable to find
+
+    @retval handle of the variable
+    @retval VAR_INVALID the variable does not exist
+
+==============================================================================*/
+VAR_HANDLE VAR_FindByName( VARSERVER_HANDLE hVarServer, char *name )
+{
+    VAR_HANDLE hVar = VAR_INVALID;
+    unsigned int idx;
+
+    (void)hVarServer;
+
+    if ( ( name != NULL ) &&
+         ( sscanf( name, VARSTUB_PREFIX "%u", &idx ) == 1 ) &&
+         ( idx < VARSTUB_MAX_VARS ) )
+    {
+        hVar = (VAR_HANDLE)( idx + 1 );
+    }
+
+    return hVar;
+}
+
+/*============================================================================*/
+/*  VAR_Print                                                                 */
+/*!
+    Print a benchmark variable
+
+    The VAR_Print function writes the current value of a benchmark
+    variable to the output file descriptor, and then changes the value.
+
+    @param[in]
+        hVarServer
+            handle to the variable server (unused)
+
+    @param[in]
+        hVar
+            handle of the variable to print
+
+    @param[in]
+        fd
+            output file descriptor
+
+    @retval EOK the variable was printed
+    @retval ENOENT the variable does not exist
+
+==============================================================================*/
+int VAR_Print( VARSERVER_HANDLE hVarServer, VAR_HANDLE hVar, int fd )
+{
+    int result = ENOENT;
+
+    (void)hVarServer;
+
+    if ( ( hVar != VAR_INVALID ) &&
+         ( hVar <= VARSTUB_MAX_VARS ) )
+    {
+        dprintf( fd, "%u", values[hVar - 1]++ );
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_Get                                                                   */
+/*!
+    Get a benchmark variable
+
+    The VAR_Get function gets the current value of a benchmark variable
+    as an unsigned 32-bit integer, and then changes the value.
+
+    @param[in]
+        hVarServer
+            handle to the variable server (unused)
+
+    @param[in]
+        hVar
+            handle of the variable to get
+
+    @param[out]
+        pVarObject
+            pointer to the location to store the variable value
+
+    @retval EOK the variable was retrieved
+    @retval ENOENT the variable does not exist
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VAR_Get( VARSERVER_HANDLE hVarServer, VAR_HANDLE hVar, VarObject *pVarObject )
+{
+    int result = EINVAL;
+
+    (void)hVarServer;
+
+    if ( pVarObject != NULL )
+    {
+        result = ENOENT;
+        if ( ( hVar != VAR_INVALID ) &&
+             ( hVar <= VARSTUB_MAX_VARS ) )
+        {
+            pVarObject->type = VARTYPE_UINT32;
+            pVarObject->len = sizeof( uint32_t );
+            pVarObject->val.ul = values[hVar - 1]++;
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_Notify                                                                */
+/*!
+    Request a notification for a benchmark variable
+
+    The VAR_Notify function accepts notification requests for the
+    benchmark variables.  The benchmark variables never send a
+    notification.
+
+    @param[in]
+        hVarServer
+            handle to the variable server (unused)
+
+    @param[in]
+        hVar
+            handle of the variable to be notified about
+
+    @param[in]
+        notificationType
+            type of notification requested (unused)
+
+    @retval EOK the notification was requested
+    @retval ENOENT the variable does not exist
+
+==============================================================================*/
+int VAR_Notify( VARSERVER_HANDLE hVarServer,
+                VAR_HANDLE hVar,
+                NotificationType notificationType )
+{
+    int result = ENOENT;
+
+    (void)hVarServer;
+    (void)notificationType;
+
+    if ( ( hVar != VAR_INVALID ) &&
+         ( hVar <= VARSTUB_MAX_VARS ) )
+    {
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*! @}
+ * end of varstub group */
@@ -0,0 +1,136 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef CBOR_H
+#define CBOR_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+/*! maximum size of an encoded CBOR data item head */
+#define CBOR_MAX_HEAD_SIZE ( 9 )
+
+/*! CBOR writer which encodes data items into a buffer */
+typedef struct _cborWriter
+{
+    /*! pointer to the output buffer */
+    char *pBuf;
+
+    /*! size of the output buffer */
+    size_t size;
+
+    /*! number of bytes written to the output buffer */
+    size_t len;
+
+    /*! indicates a data item did not fit in the output buffer */
+    bool overflow;
+
+} CborWriter;
+
+/*! CBOR data item types decoded by the CBOR reader */
+typedef enum _cborType
+{
+    /*! unsigned integer, in val.u */
+    CBOR_TYPE_UINT,
+
+    /*! negative integer, in val.i */
+    CBOR_TYPE_INT,
+
+    /*! floating point number, in val.d */
+    CBOR_TYPE_FLOAT,
+
+    /*! text string, at pText with length len */
+    CBOR_TYPE_TEXT,
+
+    /*! array head, with the number of elements in len */
+    CBOR_TYPE_ARRAY,
+
+    /*! null */
+    CBOR_TYPE_NULL
+
+} CborType;
+
+/*! CBOR data item decoded by the CBOR reader */
+typedef struct _cborItem
+{
+    /*! type of the data item */
+    CborType type;
+
+    /*! numeric value of the data item */
+    union
+    {
+        uint64_t u;
+        int64_t i;
+        double d;
+    } val;
+
+    /*! text of a text string, which is not NUL terminated */
+    const char *pText;
+
+    /*! length of a text string, or number of elements of an array */
+    size_t len;
+
+} CborItem;
+
+/*! CBOR reader which decodes data items from a buffer */
+typedef struct _cborReader
+{
+    /*! pointer to the input buffer */
+    const char *pBuf;
+
+    /*! length of the input */
+    size_t len;
+
+    /*! offset of the next data item */
+    size_t offset;
+
+} CborReader;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+void CBOR_Init( CborWriter *pWriter, char *pBuf, size_t size );
+void CBOR_Array( CborWriter *pWriter, size_t count );
+void CBOR_UInt( CborWriter *pWriter, uint64_t val );
+void CBOR_Int( CborWriter *pWriter, int64_t val );
+void CBOR_Float( CborWriter *pWriter, float val );
+void CBOR_Text( CborWriter *pWriter, const char *pText, size_t len );
+void CBOR_Null( CborWriter *pWriter );
+int CBOR_Result( CborWriter *pWriter );
+
+void CBOR_InitReader( CborReader *pReader, const char *pBuf, size_t len );
+int CBOR_Read( CborReader *pReader, CborItem *pItem );
+
+#endif
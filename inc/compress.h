@@ -0,0 +1,114 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+/*! no compression */
+#define COMPRESS_NONE ( 0 )
+
+/*! LZ4 block compression */
+#define COMPRESS_LZ4 ( 1 )
+
+/*! zstd compression */
+#define COMPRESS_ZSTD ( 2 )
+
+#ifndef COMPRESS_ZSTD_LEVEL
+/*! zstd compression level */
+#define COMPRESS_ZSTD_LEVEL ( 3 )
+#endif
+
+#ifndef COMPRESS_MAX_DICT_SIZE
+/*! maximum size of a compression dictionary.  LZ4 only uses the
+    last 64 KB of its dictionary */
+#define COMPRESS_MAX_DICT_SIZE ( 65536 )
+#endif
+
+/*! payload compressor */
+typedef struct _compressor
+{
+    /*! compression dictionary, or NULL if no dictionary is set */
+    char *pDict;
+
+    /*! length of the compression dictionary */
+    size_t dictLen;
+
+    /*! identifier of the compression dictionary (0 = no dictionary) */
+    uint32_t dictId;
+
+    /*! LZ4 stream state (LZ4_stream_t) */
+    void *pLz4Stream;
+
+    /*! zstd compression context (ZSTD_CCtx) */
+    void *pZstdCtx;
+
+    /*! zstd digested dictionary (ZSTD_CDict) */
+    void *pZstdDict;
+
+    /*! zstd decompression context (ZSTD_DCtx) */
+    void *pZstdDCtx;
+
+} Compressor;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+void COMPRESS_Init( Compressor *pCompressor );
+bool COMPRESS_IsSupported( int algorithm );
+const char *COMPRESS_Name( int algorithm );
+size_t COMPRESS_Bound( int algorithm, size_t len );
+int COMPRESS_SetDictionary( Compressor *pCompressor,
+                            const char *pDict,
+                            size_t len );
+int COMPRESS_Compress( Compressor *pCompressor,
+                       int algorithm,
+                       const char *pIn,
+                       size_t inLen,
+                       char *pOut,
+                       size_t outSize,
+                       size_t *pOutLen );
+int COMPRESS_Decompress( Compressor *pCompressor,
+                         int algorithm,
+                         const char *pIn,
+                         size_t inLen,
+                         char *pOut,
+                         size_t outSize,
+                         size_t *pOutLen );
+void COMPRESS_Free( Compressor *pCompressor );
+
+#endif
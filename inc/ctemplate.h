@@ -0,0 +1,287 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef CTEMPLATE_H
+#define CTEMPLATE_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+#include <varserver/varserver.h>
+#include "cbor.h"
+#include "varsnap.h"
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef CTEMPLATE_FILENAME_SIZE
+/*! maximum length of the template filename */
+#define CTEMPLATE_FILENAME_SIZE ( 256 )
+#endif
+
+#ifndef CTEMPLATE_MAX_NAME_LEN
+/*! maximum length of a variable name referenced in a template */
+#define CTEMPLATE_MAX_NAME_LEN ( 256 )
+#endif
+
+#ifndef CTEMPLATE_MAX_SIZE
+/*! maximum size of a template file */
+#define CTEMPLATE_MAX_SIZE ( 65536 )
+#endif
+
+#ifndef CTEMPLATE_MAX_STRING
+/*! maximum length of a string variable value in a binary rendering */
+#define CTEMPLATE_MAX_STRING ( 1024 )
+#endif
+
+#ifndef CTEMPLATE_REFRESH_NS
+/*! minimum interval between checks of the template file for changes,
+    and between retries of unresolved variable references */
+#define CTEMPLATE_REFRESH_NS ( 1000000000ULL )
+#endif
+
+#ifndef CTEMPLATE_MAX_SPLICE_VARS
+/*! maximum number of variables whose references can be splice points */
+#define CTEMPLATE_MAX_SPLICE_VARS ( 4 )
+#endif
+
+#ifndef CTEMPLATE_MAX_SPLICES
+/*! maximum number of splice points in a rendering */
+#define CTEMPLATE_MAX_SPLICES ( 16 )
+#endif
+
+#ifndef CTEMPLATE_SLOT_SIZE
+/*! size of the formatted text cache slot of each variable reference.
+    Longer values are formatted on every render */
+#define CTEMPLATE_SLOT_SIZE ( 64 )
+#endif
+
+/*! compiled template element */
+typedef struct _ctElement
+{
+    /*! offset of the static text or variable name in the template text */
+    size_t offset;
+
+    /*! length of the static text or variable name */
+    size_t len;
+
+    /*! indicates this element is a variable reference */
+    bool isVar;
+
+    /*! handle of the referenced variable, or VAR_INVALID if unresolved */
+    VAR_HANDLE hVar;
+
+    /*! index of the variable reference, which selects its slot in the
+        formatted text cache */
+    size_t slot;
+
+    /*! length of the cached formatted text */
+    size_t cachedLen;
+
+    /*! indicates the cached formatted text is up to date */
+    bool cached;
+
+    /*! indicates a modification notification has been requested for
+        the referenced variable (see CTEMPLATE_Subscribe) */
+    bool notified;
+
+} CTElement;
+
+/*! compiled template */
+typedef struct _compiledTemplate
+{
+    /*! indicates the template has been compiled successfully */
+    bool valid;
+
+    /*! name of the compiled template file */
+    char filename[CTEMPLATE_FILENAME_SIZE];
+
+    /*! device of the compiled template file */
+    dev_t dev;
+
+    /*! inode of the compiled template file */
+    ino_t ino;
+
+    /*! size of the compiled template file */
+    off_t size;
+
+    /*! modification time of the compiled template file */
+    struct timespec mtime;
+
+    /*! monotonic time in nanoseconds the template file was last
+        checked for changes */
+    uint64_t checked_ns;
+
+    /*! template text */
+    char *text;
+
+    /*! length of the template text */
+    size_t textLen;
+
+    /*! array of template elements */
+    CTElement *elements;
+
+    /*! number of template elements */
+    size_t nElements;
+
+    /*! number of unresolved variable references */
+    size_t nUnresolved;
+
+    /*! number of variable references */
+    size_t nVars;
+
+    /*! schema identifier of binary renderings (hash of the template text) */
+    uint32_t schemaId;
+
+    /*! compile counter, incremented every time the template file is
+        re-compiled so derived data can be rebuilt */
+    uint32_t generation;
+
+    /*! variable binding counter, incremented every time the template is
+        compiled or a previously unresolved variable reference is
+        resolved, so the users of the variable handles can pick up the
+        new handles */
+    uint32_t bindings;
+
+    /*! formatted text cache, with CTEMPLATE_SLOT_SIZE bytes for each
+        variable reference, allocated by the first cached render */
+    char *cache;
+
+    /*! number of variable references formatted by cached renders */
+    uint64_t formatted;
+
+    /*! number of variable references reused from the cache */
+    uint64_t reused;
+
+} CompiledTemplate;
+
+/*! in-process buffer a template is rendered into */
+typedef struct _ctBuffer
+{
+    /*! output buffer */
+    char *pBuf;
+
+    /*! size of the output buffer */
+    size_t size;
+
+    /*! length of the rendered output */
+    size_t len;
+
+    /*! print stream for the variables which are printed by the
+        variable server, or -1 if there is none */
+    int fd;
+
+    /*! contents of the print stream */
+    const char *pFdData;
+
+    /*! size of the print stream contents */
+    size_t fdSize;
+
+    /*! offset of the print stream, or -1 if it is not yet positioned */
+    off_t fdOffset;
+
+} CTBuffer;
+
+/*! splice point in a rendering */
+typedef struct _ctSplicePoint
+{
+    /*! output offset of the splice point */
+    size_t offset;
+
+    /*! index of the spliced variable in CTSplices.hVars */
+    size_t field;
+
+} CTSplicePoint;
+
+/*! variables whose references are left out of a rendering, with the
+    splice points recorded where the caller inserts their values */
+typedef struct _ctSplices
+{
+    /*! handles of the spliced variables.  VAR_INVALID entries are
+        rendered normally */
+    VAR_HANDLE hVars[CTEMPLATE_MAX_SPLICE_VARS];
+
+    /*! number of entries in hVars */
+    size_t nVars;
+
+    /*! splice points of the last rendering, in output order */
+    CTSplicePoint points[CTEMPLATE_MAX_SPLICES];
+
+    /*! number of splice points of the last rendering */
+    size_t nPoints;
+
+} CTSplices;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int CTEMPLATE_Compile( CompiledTemplate *pTemplate,
+                       VARSERVER_HANDLE hVarServer,
+                       const char *filename );
+int CTEMPLATE_Refresh( CompiledTemplate *pTemplate,
+                       VARSERVER_HANDLE hVarServer,
+                       const char *filename );
+int CTEMPLATE_Render( CompiledTemplate *pTemplate,
+                      VARSERVER_HANDLE hVarServer,
+                      int fd );
+int CTEMPLATE_RenderSplice( CompiledTemplate *pTemplate,
+                            VARSERVER_HANDLE hVarServer,
+                            const VarSnapshot *pSnap,
+                            int fd,
+                            CTSplices *pSplices );
+int CTEMPLATE_RenderBuffer( CompiledTemplate *pTemplate,
+                            VARSERVER_HANDLE hVarServer,
+                            const VarSnapshot *pSnap,
+                            CTBuffer *pBuffer,
+                            CTSplices *pSplices );
+int CTEMPLATE_RenderCached( CompiledTemplate *pTemplate,
+                            VARSERVER_HANDLE hVarServer,
+                            const VarSnapshot *pSnap,
+                            CTBuffer *pBuffer,
+                            CTSplices *pSplices );
+bool CTEMPLATE_Invalidate( CompiledTemplate *pTemplate, VAR_HANDLE hVar );
+int CTEMPLATE_RenderCBOR( CompiledTemplate *pTemplate,
+                          VARSERVER_HANDLE hVarServer,
+                          const VarSnapshot *pSnap,
+                          CborWriter *pWriter,
+                          CTSplices *pSplices );
+size_t CTEMPLATE_GetStaticText( CompiledTemplate *pTemplate,
+                                char *pBuf,
+                                size_t size );
+bool CTEMPLATE_References( CompiledTemplate *pTemplate, VAR_HANDLE hVar );
+int CTEMPLATE_Subscribe( CompiledTemplate *pTemplate,
+                         VARSERVER_HANDLE hVarServer,
+                         const VAR_HANDLE *pExclude,
+                         size_t nExclude );
+void CTEMPLATE_Free( CompiledTemplate *pTemplate );
+
+#endif
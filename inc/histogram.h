@@ -0,0 +1,72 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+/*! number of buckets in a latency histogram.  Bucket 0 counts samples
+    below 1us, and bucket n (n > 0) counts samples from 2^(n-1)us up to
+    2^n us.  The last bucket also counts all larger samples */
+#define HISTOGRAM_BUCKETS ( 24 )
+
+/*! fixed-bucket latency histogram */
+typedef struct _histogram
+{
+    /*! sample counts for each bucket */
+    uint32_t buckets[HISTOGRAM_BUCKETS];
+
+    /*! total number of samples */
+    uint32_t count;
+
+    /*! smallest sample in nanoseconds */
+    uint64_t min_ns;
+
+    /*! largest sample in nanoseconds */
+    uint64_t max_ns;
+
+    /*! sum of all samples in nanoseconds */
+    uint64_t sum_ns;
+
+} Histogram;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+void HISTOGRAM_Record( Histogram *pHistogram, uint64_t ns );
+void HISTOGRAM_Dump( Histogram *pHistogram, int fd );
+
+#endif
@@ -0,0 +1,103 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef IFSET_H
+#define IFSET_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "iftable.h"
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef IFSET_PATTERN_LEN
+/*! maximum length of an interface name pattern */
+#define IFSET_PATTERN_LEN ( 32 )
+#endif
+
+/*! interface name pattern */
+typedef struct _ifPattern
+{
+    /*! interface name, which may contain fnmatch(3) wildcards */
+    char pattern[IFSET_PATTERN_LEN];
+
+    /*! indicates matching interfaces are excluded ('!' prefix) */
+    bool exclude;
+
+} IfPattern;
+
+/*! compiled interface allow-list.  A zeroed set allows every interface */
+typedef struct _ifSet
+{
+    /*! interface name patterns in the order they were specified */
+    IfPattern *patterns;
+
+    /*! number of interface name patterns */
+    size_t nPatterns;
+
+    /*! number of inclusion patterns.  If there are none, every interface
+        which is not excluded is allowed */
+    size_t nIncludes;
+
+    /*! bitmap of the allowed interface indexes */
+    uint64_t *bits;
+
+    /*! number of 64 bit words in the bitmap */
+    size_t nWords;
+
+    /*! indicates the bitmap has been built from the interface table */
+    bool resolved;
+
+    /*! interface table generation the bitmap was built from */
+    uint32_t generation;
+
+    /*! indicates an interface list has been parsed successfully */
+    bool valid;
+
+    /*! indicates no interface is allowed, since the only interface
+        list specified could not be parsed */
+    bool denyAll;
+
+} IfSet;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int IFSET_Parse( IfSet *pSet, const char *spec );
+bool IFSET_Match( IfSet *pSet, const char *ifname );
+int IFSET_Resolve( IfSet *pSet, IfTable *pTable );
+bool IFSET_Contains( IfSet *pSet, int ifindex );
+int IFSET_Reserve( IfSet *pSet, int maxIndex );
+void IFSET_Free( IfSet *pSet );
+
+#endif
@@ -0,0 +1,146 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef IFTABLE_H
+#define IFTABLE_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <net/if.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef IFTABLE_MAX_LINKS
+/*! maximum number of network links tracked by the interface table */
+#define IFTABLE_MAX_LINKS ( 64 )
+#endif
+
+#ifndef IFTABLE_MAX_ADDRS
+/*! maximum number of interface addresses tracked by the interface table */
+#define IFTABLE_MAX_ADDRS ( 64 )
+#endif
+
+#ifndef IFTABLE_HOST_LEN
+/*! length of a numeric interface address, including an IPv6 scope */
+#define IFTABLE_HOST_LEN ( INET6_ADDRSTRLEN + IFNAMSIZ + 1 )
+#endif
+
+/*! network link information */
+typedef struct _ifLink
+{
+    /*! interface index */
+    int ifindex;
+
+    /*! interface flags (IFF_UP, IFF_BROADCAST, etc) */
+    unsigned int flags;
+
+    /*! link MTU, or 0 if it is not known */
+    unsigned int mtu;
+
+    /*! interface name */
+    char ifname[IFNAMSIZ];
+
+} IfLink;
+
+/*! interface address entry */
+typedef struct _ifEntry
+{
+    /*! interface index */
+    int ifindex;
+
+    /*! address family (AF_INET or AF_INET6) */
+    int family;
+
+    /*! indicates the interface link is up */
+    bool up;
+
+    /*! indicates the broadcast address is valid */
+    bool hasBroadcast;
+
+    /*! MTU of the interface link, or 0 if it is not known */
+    unsigned int mtu;
+
+    /*! interface name */
+    char ifname[IFNAMSIZ];
+
+    /*! local address on the interface */
+    struct sockaddr_storage addr;
+
+    /*! numeric local address on the interface, formatted once when
+        the address is learned */
+    char host[IFTABLE_HOST_LEN];
+
+    /*! broadcast address on the interface (AF_INET only) */
+    struct sockaddr_storage broadaddr;
+
+} IfEntry;
+
+/*! interface table */
+typedef struct _ifTable
+{
+    /*! netlink socket subscribed to link and address changes */
+    int fd;
+
+    /*! netlink request sequence number */
+    uint32_t seq;
+
+    /*! indicates the table must be re-synchronized via a full dump */
+    bool resync;
+
+    /*! incremented every time the table content changes */
+    uint32_t generation;
+
+    /*! network links */
+    IfLink links[IFTABLE_MAX_LINKS];
+
+    /*! number of network links */
+    size_t nLinks;
+
+    /*! interface addresses */
+    IfEntry entries[IFTABLE_MAX_ADDRS];
+
+    /*! number of interface addresses */
+    size_t n;
+
+} IfTable;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int IFTABLE_Init( IfTable *pTable );
+int IFTABLE_GetFd( IfTable *pTable );
+int IFTABLE_Process( IfTable *pTable );
+void IFTABLE_Close( IfTable *pTable );
+
+#endif
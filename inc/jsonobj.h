@@ -0,0 +1,93 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef JSONOBJ_H
+#define JSONOBJ_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stddef.h>
+#include "cbor.h"
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef JSONOBJ_MAX_MEMBERS
+/*! maximum number of members of a JSON object */
+#define JSONOBJ_MAX_MEMBERS ( 4096 )
+#endif
+
+#ifndef JSONOBJ_VALUE_SIZE
+/*! maximum decoded length of a string value, including its NUL */
+#define JSONOBJ_VALUE_SIZE ( 1024 )
+#endif
+
+/*! member of a JSON object */
+typedef struct _jsonMember
+{
+    /*! decoded member name */
+    const char *name;
+
+    /*! length of the member name */
+    size_t nameLen;
+
+    /*! member value.  Strings and numbers are CBOR_TYPE_TEXT, true and
+        false are the text "1" and "0", and null is CBOR_TYPE_NULL */
+    CborItem item;
+
+} JsonMember;
+
+/*! flat JSON object parser */
+typedef struct _jsonObject
+{
+    /*! members of the last object parsed */
+    JsonMember *pMembers;
+
+    /*! number of members of the last object parsed */
+    size_t n;
+
+    /*! buffer the member names and string values are decoded into */
+    char *pArena;
+
+    /*! size of the arena */
+    size_t arenaSize;
+
+    /*! maximum length of an object */
+    size_t maxLen;
+
+} JsonObject;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int JSONOBJ_Init( JsonObject *pObject, size_t maxLen );
+int JSONOBJ_Parse( JsonObject *pObject, const char *pBuf, size_t len );
+void JSONOBJ_Free( JsonObject *pObject );
+
+#endif
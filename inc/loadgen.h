@@ -0,0 +1,155 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef LOADGEN_H
+#define LOADGEN_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef LOADGEN_MAX_SOURCES
+/*! maximum number of virtual sources */
+#define LOADGEN_MAX_SOURCES ( 65536 )
+#endif
+
+#ifndef LOADGEN_TICK_NS
+/*! interval at which the due transmissions are sent */
+#define LOADGEN_TICK_NS ( 1000000ULL )
+#endif
+
+#ifndef LOADGEN_MAX_BURST
+/*! maximum number of transmissions sent in one tick, so the event loop
+    keeps serving its other events when the target cannot be reached */
+#define LOADGEN_MAX_BURST ( 1024 )
+#endif
+
+#ifndef LOADGEN_WINDOW_NS
+/*! interval over which the achieved rate and CPU time are measured */
+#define LOADGEN_WINDOW_NS ( 1000000000ULL )
+#endif
+
+#ifndef LOADGEN_PREFIX_LEN
+/*! maximum length of the variable name prefix */
+#define LOADGEN_PREFIX_LEN ( 64 )
+#endif
+
+/*! default prefix of the virtual source variables */
+#define LOADGEN_DEFAULT_PREFIX "/udpt/load"
+
+/*! virtual source */
+typedef struct _loadSource
+{
+    /*! payload seed which identifies the source */
+    uint32_t seed;
+
+    /*! sequence number of the next transmission of the source */
+    uint32_t seq;
+
+} LoadSource;
+
+/*! synthetic load generator */
+typedef struct _loadGen
+{
+    /*! virtual sources */
+    LoadSource *sources;
+
+    /*! number of virtual sources */
+    size_t nSources;
+
+    /*! target rate at the start of the ramp, in transmissions per
+        second across all sources */
+    uint64_t startRate;
+
+    /*! target rate at the end of the ramp, in transmissions per second */
+    uint64_t endRate;
+
+    /*! duration of the ramp in nanoseconds, or 0 to start at the end
+        rate */
+    uint64_t ramp_ns;
+
+    /*! prefix of the virtual source variables */
+    char prefix[LOADGEN_PREFIX_LEN];
+
+    /*! indicates the load generator is running */
+    bool running;
+
+    /*! monotonic time at which the load generator was started */
+    uint64_t start_ns;
+
+    /*! index of the source which transmits next */
+    size_t next;
+
+    /*! number of transmissions sent since the start */
+    uint64_t sent;
+
+    /*! process CPU time at the start, in nanoseconds */
+    uint64_t startCpu_ns;
+
+    /*! monotonic time at which the measurement window started */
+    uint64_t window_ns;
+
+    /*! number of transmissions sent when the window started */
+    uint64_t windowSent;
+
+    /*! process CPU time when the window started, in nanoseconds */
+    uint64_t windowCpu_ns;
+
+    /*! rate achieved in the last complete window, in transmissions per
+        second */
+    uint64_t achieved;
+
+    /*! process CPU time per transmission in the last complete window,
+        in nanoseconds */
+    uint64_t cpuPerSend_ns;
+
+} LoadGen;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+void LOADGEN_Init( LoadGen *pGen );
+int LOADGEN_Parse( LoadGen *pGen, const char *spec );
+void LOADGEN_Start( LoadGen *pGen, uint64_t now_ns, uint64_t salt );
+void LOADGEN_Stop( LoadGen *pGen );
+uint64_t LOADGEN_Target( LoadGen *pGen, uint64_t now_ns );
+uint64_t LOADGEN_Behind( LoadGen *pGen, uint64_t now_ns );
+size_t LOADGEN_Due( LoadGen *pGen, uint64_t now_ns );
+LoadSource *LOADGEN_Next( LoadGen *pGen );
+void LOADGEN_Sent( LoadGen *pGen, LoadSource *pSource );
+void LOADGEN_Sample( LoadGen *pGen, uint64_t now_ns );
+uint64_t LOADGEN_CpuNow( void );
+void LOADGEN_Free( LoadGen *pGen );
+
+#endif
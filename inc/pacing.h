@@ -0,0 +1,134 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef PACING_H
+#define PACING_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <net/if.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef PACING_MAX_ENTRIES
+/*! maximum number of paced interfaces */
+#define PACING_MAX_ENTRIES ( 16 )
+#endif
+
+#ifndef PACING_BURST_NS
+/*! default burst allowance, as the time to send it at the pacing rate */
+#define PACING_BURST_NS ( 10000000ULL )
+#endif
+
+#ifndef PACING_MIN_BURST
+/*! minimum burst allowance in bytes, so a full sized datagram is never
+    refused by an idle interface */
+#define PACING_MIN_BURST ( 1500 )
+#endif
+
+#ifndef PACING_HORIZON_NS
+/*! maximum time a datagram may be deferred with SO_TXTIME before it is
+    dropped instead */
+#define PACING_HORIZON_NS ( 1000000000ULL )
+#endif
+
+/*! pace in user space with a token bucket, dropping excess payloads */
+#define PACING_MODE_BUCKET ( 0 )
+
+/*! pace in the kernel using the socket pacing rate (SO_MAX_PACING_RATE),
+    which requires the fq qdisc */
+#define PACING_MODE_FQ ( 1 )
+
+/*! pace with SO_TXTIME launch times, which requires the fq or etf qdisc */
+#define PACING_MODE_TXTIME ( 2 )
+
+/*! interface pacing configuration and state */
+typedef struct _pacingEntry
+{
+    /*! name of the paced interface, or "*" for every other interface */
+    char ifname[IFNAMSIZ];
+
+    /*! configured pacing mode */
+    int mode;
+
+    /*! pacing mode in use, which falls back to PACING_MODE_BUCKET if the
+        kernel rejects the configured mode */
+    int active;
+
+    /*! pacing rate in bytes per second */
+    uint64_t rate;
+
+    /*! burst allowance in bytes */
+    uint64_t burst;
+
+    /*! monotonic time at which the interface has sent everything
+        admitted so far at the pacing rate */
+    uint64_t next_ns;
+
+    /*! number of payloads admitted */
+    uint64_t admitted;
+
+    /*! number of payloads deferred to a later launch time */
+    uint64_t deferred;
+
+    /*! number of payloads dropped because they exceeded the rate */
+    uint64_t dropped;
+
+} PacingEntry;
+
+/*! per-interface pacing table */
+typedef struct _pacing
+{
+    /*! pacing entries */
+    PacingEntry entries[PACING_MAX_ENTRIES];
+
+    /*! number of pacing entries */
+    size_t n;
+
+} Pacing;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+void PACING_Init( Pacing *pPacing );
+int PACING_Parse( Pacing *pPacing, const char *spec );
+PacingEntry *PACING_Find( Pacing *pPacing, const char *ifname );
+int PACING_SetupSocket( PacingEntry *pEntry, int fd );
+int PACING_Admit( PacingEntry *pEntry,
+                  size_t len,
+                  uint64_t now_ns,
+                  uint64_t *pLaunch_ns );
+uint64_t PACING_Duration( const PacingEntry *pEntry, size_t len );
+const char *PACING_ModeName( int mode );
+
+#endif
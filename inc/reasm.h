@@ -0,0 +1,139 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef REASM_H
+#define REASM_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include "udptmsg.h"
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef REASM_MAX_MESSAGES
+/*! maximum number of segmented payloads being reassembled at once */
+#define REASM_MAX_MESSAGES ( 32 )
+#endif
+
+#ifndef REASM_MAX_PAYLOAD
+/*! maximum size of a reassembled payload */
+#define REASM_MAX_PAYLOAD ( 1048576 )
+#endif
+
+#ifndef REASM_MAX_SEGMENT
+/*! maximum size of the data in one segment */
+#define REASM_MAX_SEGMENT ( 65535 )
+#endif
+
+#ifndef REASM_TIMEOUT_NS
+/*! time after which an incomplete payload is discarded */
+#define REASM_TIMEOUT_NS ( 2000000000ULL )
+#endif
+
+/*! segmented payload being reassembled */
+typedef struct _reasmMessage
+{
+    /*! indicates the message is being reassembled */
+    bool active;
+
+    /*! address the segments are sent from */
+    struct sockaddr_storage source;
+
+    /*! message identifier shared by all segments of the payload */
+    uint16_t msgId;
+
+    /*! total number of segments in the payload */
+    uint16_t count;
+
+    /*! number of distinct segments received */
+    uint16_t received;
+
+    /*! size of the data in every segment but the last, or 0 if no such
+        segment has been received yet */
+    size_t segSize;
+
+    /*! size of the data in the last segment, if it has been received */
+    size_t lastLen;
+
+    /*! reassembly buffer */
+    char *pBuf;
+
+    /*! size of the reassembly buffer */
+    size_t bufSize;
+
+    /*! bitmap of the segments received */
+    uint8_t *pHave;
+
+    /*! size of the bitmap in bytes */
+    size_t haveSize;
+
+    /*! monotonic time the first segment was received */
+    uint64_t start_ns;
+
+} ReasmMessage;
+
+/*! segment reassembler */
+typedef struct _reasm
+{
+    /*! payloads being reassembled */
+    ReasmMessage msgs[REASM_MAX_MESSAGES];
+
+    /*! number of payloads reassembled */
+    uint64_t completed;
+
+    /*! number of incomplete payloads discarded after REASM_TIMEOUT_NS */
+    uint64_t expired;
+
+    /*! number of incomplete payloads discarded to make room */
+    uint64_t evicted;
+
+    /*! number of segments which did not fit their payload */
+    uint64_t invalid;
+
+} Reasm;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int REASM_Add( Reasm *pReasm,
+               const struct sockaddr *pSource,
+               const UDPTSegment *pSegment,
+               const char *pData,
+               size_t len,
+               uint64_t now_ns,
+               const char **ppPayload,
+               size_t *pLen );
+void REASM_Free( Reasm *pReasm );
+
+#endif
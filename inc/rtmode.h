@@ -0,0 +1,97 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef RTMODE_H
+#define RTMODE_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+/* cpu_set_t requires _GNU_SOURCE to be defined before sched.h is first
+   included */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef RTMODE_STACK_PREFAULT
+/*! size of the stack which is touched after locking memory, so the
+    event loop does not take page faults as its stack grows */
+#define RTMODE_STACK_PREFAULT ( 256 * 1024 )
+#endif
+
+/*! real-time mode configuration and state */
+typedef struct _rtMode
+{
+    /*! indicates the real-time mode is enabled */
+    bool enabled;
+
+    /*! indicates all of the process memory is locked */
+    bool locked;
+
+    /*! SCHED_FIFO priority of the event loop and sender thread, or 0
+        to keep the default scheduling policy */
+    int priority;
+
+    /*! CPUs the event loop is pinned to */
+    cpu_set_t loopCpus;
+
+    /*! CPUs the sender thread is pinned to */
+    cpu_set_t senderCpus;
+
+    /*! heap allocation count when the steady state was entered, or
+        since it was last checked */
+    uint64_t baseline;
+
+    /*! indicates the steady state has been entered */
+    bool armed;
+
+    /*! number of heap allocations made in the steady state, only
+        counted when built with UDPT_RT_ALLOC_CHECK */
+    uint64_t allocs;
+
+} RtMode;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+void RTMODE_Init( RtMode *pRt );
+int RTMODE_ParseCpus( const char *spec, cpu_set_t *pSet );
+int RTMODE_Lock( RtMode *pRt );
+int RTMODE_SetupThread( RtMode *pRt,
+                        pthread_t thread,
+                        const cpu_set_t *pCpus );
+void RTMODE_Arm( RtMode *pRt );
+uint64_t RTMODE_Check( RtMode *pRt );
+uint64_t RTMODE_Allocations( void );
+bool RTMODE_CountsAllocations( void );
+
+#endif
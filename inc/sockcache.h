@@ -0,0 +1,107 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef SOCKCACHE_H
+#define SOCKCACHE_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <net/if.h>
+#include "pacing.h"
+#include "txstamp.h"
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef SOCKCACHE_MAX_ENTRIES
+/*! maximum number of cached interface sockets */
+#define SOCKCACHE_MAX_ENTRIES ( 64 )
+#endif
+
+/*! cached socket bound to a specific interface and address family */
+typedef struct _sockCacheEntry
+{
+    /*! name of the interface the socket is bound to */
+    char ifname[IFNAMSIZ];
+
+    /*! address family of the socket */
+    int family;
+
+    /*! socket file descriptor */
+    int fd;
+
+    /*! indicates the interface was seen in the current send pass */
+    bool seen;
+
+} SockCacheEntry;
+
+/*! socket cache object */
+typedef struct _sockCache
+{
+    /*! cached socket entries */
+    SockCacheEntry entries[SOCKCACHE_MAX_ENTRIES];
+
+    /*! number of entries in use */
+    size_t n;
+
+    /*! multicast TTL (IPv4) or hop limit (IPv6) of new sockets */
+    int mcastHops;
+
+    /*! loop multicast datagrams back to local receivers */
+    bool mcastLoop;
+
+    /*! pacing table whose kernel pacing options are set on new
+        sockets, or NULL */
+    Pacing *pPacing;
+
+    /*! transmit timestamp tracker which timestamps new sockets, or NULL */
+    TxStamp *pTxStamp;
+
+} SockCache;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+void SOCKCACHE_Init( SockCache *pCache );
+void SOCKCACHE_SetMulticast( SockCache *pCache, int hops, bool loop );
+void SOCKCACHE_SetPacing( SockCache *pCache, Pacing *pPacing );
+void SOCKCACHE_SetTxStamp( SockCache *pCache, TxStamp *pTxStamp );
+int SOCKCACHE_Get( SockCache *pCache,
+                   const char *ifname,
+                   int family,
+                   int *pFd );
+void SOCKCACHE_BeginPass( SockCache *pCache );
+void SOCKCACHE_Touch( SockCache *pCache, const char *ifname, int family );
+void SOCKCACHE_EndPass( SockCache *pCache );
+void SOCKCACHE_Invalidate( SockCache *pCache, int fd );
+void SOCKCACHE_Flush( SockCache *pCache );
+bool SOCKCACHE_IsStale( int err );
+
+#endif
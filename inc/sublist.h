@@ -0,0 +1,135 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef SUBLIST_H
+#define SUBLIST_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef SUBLIST_MAX_ENTRIES
+/*! maximum number of subscribers in a subscriber list */
+#define SUBLIST_MAX_ENTRIES ( 1024 )
+#endif
+
+#ifndef SUBLIST_NAME_LEN
+/*! maximum length of a subscriber address:port entry */
+#define SUBLIST_NAME_LEN ( 64 )
+#endif
+
+#ifndef SUBLIST_ADDR_LEN
+/*! maximum length of a numeric source address */
+#define SUBLIST_ADDR_LEN ( 48 )
+#endif
+
+#ifndef SUBLIST_BACKOFF_MIN_NS
+/*! time a subscriber is skipped after its first reported error */
+#define SUBLIST_BACKOFF_MIN_NS ( 1000000000ULL )
+#endif
+
+#ifndef SUBLIST_BACKOFF_MAX_NS
+/*! longest time a subscriber is skipped after repeated errors */
+#define SUBLIST_BACKOFF_MAX_NS ( 64000000000ULL )
+#endif
+
+/*! unicast subscriber */
+typedef struct _subscriber
+{
+    /*! destination address.  The port is zero if it was not specified,
+        in which case the channel port is used */
+    struct sockaddr_storage addr;
+
+    /*! length of the destination address */
+    socklen_t addrlen;
+
+    /*! subscriber entry as it was specified */
+    char name[SUBLIST_NAME_LEN];
+
+    /*! numeric local address used to reach the subscriber */
+    char source[SUBLIST_ADDR_LEN];
+
+    /*! number of datagrams sent to the subscriber */
+    uint32_t txcount;
+
+    /*! number of errors reported for the subscriber */
+    uint32_t errcount;
+
+    /*! number of transmissions skipped while backing off */
+    uint32_t skipped;
+
+    /*! most recent error reported for the subscriber */
+    int lastError;
+
+    /*! number of consecutive errors, which sets the backoff time */
+    uint32_t failures;
+
+    /*! monotonic time of the most recent error in nanoseconds */
+    uint64_t failure_ns;
+
+    /*! monotonic time before which the subscriber is skipped */
+    uint64_t retry_ns;
+
+} Subscriber;
+
+/*! list of unicast subscribers.  A zeroed list is empty */
+typedef struct _subList
+{
+    /*! subscriber entries, allocated when the first list is parsed */
+    Subscriber *entries;
+
+    /*! number of subscribers */
+    size_t n;
+
+} SubList;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int SUBLIST_Parse( SubList *pList, const char *spec );
+int SUBLIST_Reserve( SubList *pList );
+void SUBLIST_ResolveSources( SubList *pList );
+Subscriber *SUBLIST_Find( SubList *pList,
+                          const struct sockaddr *pAddr,
+                          uint16_t defaultPort );
+void SUBLIST_GetAddr( Subscriber *pSub,
+                      uint16_t defaultPort,
+                      struct sockaddr_storage *pAddr );
+bool SUBLIST_Ready( Subscriber *pSub, uint64_t now_ns );
+void SUBLIST_Failure( Subscriber *pSub, int err, uint64_t now_ns );
+size_t SUBLIST_CountBackoff( SubList *pList, uint64_t now_ns );
+void SUBLIST_Free( SubList *pList );
+
+#endif
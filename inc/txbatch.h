@@ -0,0 +1,142 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef TXBATCH_H
+#define TXBATCH_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+/* struct mmsghdr requires _GNU_SOURCE to be defined before sys/socket.h
+   is first included */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef TXBATCH_MAX_MSGS
+/*! maximum number of datagrams in a transmit batch */
+#define TXBATCH_MAX_MSGS ( 64 )
+#endif
+
+#ifndef TXBATCH_SLOT_SIZE
+/*! size of each preallocated datagram buffer in a transmit batch */
+#define TXBATCH_SLOT_SIZE ( 1472 )
+#endif
+
+#ifndef TXBATCH_CONTROL_SIZE
+/*! size of the ancillary data buffer of each datagram */
+#define TXBATCH_CONTROL_SIZE ( 64 )
+#endif
+
+/*! maximum number of segments the kernel will send for one UDP GSO
+    datagram (UDP_MAX_SEGMENTS) */
+#define TXBATCH_GSO_MAX_SEGMENTS ( 64 )
+
+/*! ancillary data buffer, aligned for struct cmsghdr */
+typedef union _txControl
+{
+    /*! ancillary data */
+    char buf[TXBATCH_CONTROL_SIZE];
+
+    /*! alignment of the ancillary data */
+    struct cmsghdr align;
+
+} TxControl;
+
+/*! transmit batch of datagrams to be sent using sendmmsg() */
+typedef struct _txBatch
+{
+    /*! message headers passed to sendmmsg() */
+    struct mmsghdr msgs[TXBATCH_MAX_MSGS];
+
+    /*! datagram payload vectors */
+    struct iovec iov[TXBATCH_MAX_MSGS];
+
+    /*! datagram destination addresses */
+    struct sockaddr_storage addr[TXBATCH_MAX_MSGS];
+
+    /*! socket to send each datagram on */
+    int fd[TXBATCH_MAX_MSGS];
+
+    /*! caller context associated with each datagram */
+    void *pCtx[TXBATCH_MAX_MSGS];
+
+    /*! send result for each datagram (EOK or errno) */
+    int result[TXBATCH_MAX_MSGS];
+
+    /*! ancillary data of each datagram */
+    TxControl control[TXBATCH_MAX_MSGS];
+
+    /*! preallocated datagram buffers */
+    char slots[TXBATCH_MAX_MSGS][TXBATCH_SLOT_SIZE];
+
+    /*! number of datagrams in the batch */
+    size_t n;
+
+    /*! number of sendmmsg() calls made by the last TXBATCH_Send */
+    size_t nCalls;
+
+    /*! monotonic time in nanoseconds the batch was handed to the kernel,
+        set by the sender */
+    uint64_t sent_ns;
+
+} TxBatch;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+void TXBATCH_Reset( TxBatch *pBatch );
+char *TXBATCH_GetSlot( TxBatch *pBatch, size_t *pSize );
+int TXBATCH_Add( TxBatch *pBatch,
+                 int fd,
+                 const struct sockaddr *pAddr,
+                 socklen_t addrlen,
+                 char *pMsg,
+                 size_t len,
+                 void *pCtx );
+int TXBATCH_AddCopy( TxBatch *pBatch,
+                     int fd,
+                     const struct sockaddr *pAddr,
+                     socklen_t addrlen,
+                     const char *pMsg,
+                     size_t len,
+                     void *pCtx );
+int TXBATCH_AddControl( TxBatch *pBatch,
+                        int level,
+                        int type,
+                        const void *pData,
+                        size_t len );
+bool TXBATCH_HasControl( TxBatch *pBatch, size_t i, int level, int type );
+int TXBATCH_Send( TxBatch *pBatch );
+bool TXBATCH_ProbeGSO( void );
+
+#endif
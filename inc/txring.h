@@ -0,0 +1,127 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef TXRING_H
+#define TXRING_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "txbatch.h"
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef TXRING_MAX_SLOTS
+/*! maximum number of transmit batches in a transmit ring */
+#define TXRING_MAX_SLOTS ( 4 )
+#endif
+
+/*! function used by the sender thread to send a batch of datagrams */
+typedef int (*TxRingSendFn)( void *pCtx, TxBatch *pBatch );
+
+/*! transmit ring slot holding one batch of datagrams */
+typedef struct _txRingSlot
+{
+    /*! batch of datagrams to send */
+    TxBatch batch;
+
+    /*! time taken by the sender thread to send the batch, in
+        nanoseconds */
+    uint64_t send_ns;
+
+    /*! caller context associated with the slot */
+    void *pCtx;
+
+} TxRingSlot;
+
+/*! single producer, single consumer ring of transmit batches which
+    are sent by a sender thread */
+typedef struct _txRing
+{
+    /*! preallocated transmit batches */
+    TxRingSlot *slots;
+
+    /*! number of slots in the ring */
+    size_t size;
+
+    /*! number of batches published by the producer */
+    atomic_size_t head;
+
+    /*! number of batches sent by the sender thread */
+    atomic_size_t tail;
+
+    /*! number of sent batches reaped by the producer */
+    size_t reaped;
+
+    /*! eventfd used to wake the sender thread */
+    int kickFd;
+
+    /*! eventfd signalled by the sender thread when a batch is sent */
+    int doneFd;
+
+    /*! requests the sender thread to exit */
+    atomic_bool stop;
+
+    /*! sender thread */
+    pthread_t thread;
+
+    /*! function used to send each batch */
+    TxRingSendFn pfnSend;
+
+    /*! context passed to the send function */
+    void *pSendCtx;
+
+    /*! indicates the sender thread is running */
+    bool running;
+
+} TxRing;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int TXRING_Init( TxRing *pRing,
+                 size_t size,
+                 TxRingSendFn pfnSend,
+                 void *pSendCtx );
+void TXRING_Close( TxRing *pRing );
+TxRingSlot *TXRING_GetSlot( TxRing *pRing, size_t idx );
+TxRingSlot *TXRING_Acquire( TxRing *pRing );
+void TXRING_Publish( TxRing *pRing );
+TxRingSlot *TXRING_Reap( TxRing *pRing );
+void TXRING_Release( TxRing *pRing );
+void TXRING_ClearEvent( TxRing *pRing );
+void TXRING_Wait( TxRing *pRing );
+int TXRING_GetFd( TxRing *pRing );
+
+#endif
@@ -0,0 +1,82 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef TXSCHED_H
+#define TXSCHED_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef SCHED_MAX_ENTRIES
+/*! maximum number of scheduled entries */
+#define SCHED_MAX_ENTRIES ( 16 )
+#endif
+
+/*! scheduled entry */
+typedef struct _schedEntry
+{
+    /*! absolute monotonic deadline in nanoseconds */
+    uint64_t deadline_ns;
+
+    /*! caller context associated with the deadline */
+    void *pCtx;
+
+} SchedEntry;
+
+/*! transmission schedule, kept as a binary min-heap ordered by deadline */
+typedef struct _schedule
+{
+    /*! heap of scheduled entries */
+    SchedEntry entries[SCHED_MAX_ENTRIES];
+
+    /*! number of scheduled entries */
+    size_t n;
+
+} Schedule;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+void SCHED_Init( Schedule *pSched );
+int SCHED_Insert( Schedule *pSched, uint64_t deadline_ns, void *pCtx );
+int SCHED_Remove( Schedule *pSched, void *pCtx );
+int SCHED_Peek( Schedule *pSched, uint64_t *pDeadline, void **ppCtx );
+int SCHED_Pop( Schedule *pSched, uint64_t *pDeadline, void **ppCtx );
+uint64_t SCHED_Now( void );
+uint64_t SCHED_Align( uint64_t now_ns,
+                      uint64_t period_ns,
+                      uint64_t phase_ns,
+                      uint64_t epoch_ns );
+uint64_t SCHED_RealtimeOffset( void );
+
+#endif
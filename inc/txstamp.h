@@ -0,0 +1,162 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef TXSTAMP_H
+#define TXSTAMP_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <net/if.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef TXSTAMP_MAX_SOCKETS
+/*! maximum number of timestamped sockets */
+#define TXSTAMP_MAX_SOCKETS ( 64 )
+#endif
+
+#ifndef TXSTAMP_PENDING
+/*! number of sent datagrams per socket which are remembered until their
+    timestamps arrive (a power of 2) */
+#define TXSTAMP_PENDING ( 256 )
+#endif
+
+#ifndef TXSTAMP_MAX_LATENCY_NS
+/*! largest plausible send latency.  Larger latencies, like negative
+    ones, mean a timestamp was matched with the wrong datagram */
+#define TXSTAMP_MAX_LATENCY_NS ( 1000000000ULL )
+#endif
+
+/*! no transmit timestamps */
+#define TXSTAMP_OFF ( 0 )
+
+/*! software transmit timestamps */
+#define TXSTAMP_SOFTWARE ( 1 )
+
+/*! software, and hardware where the interface supports it */
+#define TXSTAMP_HARDWARE ( 2 )
+
+/*! the datagram entered the qdisc (SCM_TSTAMP_SCHED) */
+#define TXSTAMP_TYPE_SCHED ( 0 )
+
+/*! the datagram was handed to the device driver (SCM_TSTAMP_SND) */
+#define TXSTAMP_TYPE_DRIVER ( 1 )
+
+/*! the device put the datagram on the wire (hardware SCM_TSTAMP_SND) */
+#define TXSTAMP_TYPE_WIRE ( 2 )
+
+/*! datagram sent on a timestamped socket, waiting for its timestamps */
+typedef struct _txStampPending
+{
+    /*! timestamp key (SOF_TIMESTAMPING_OPT_ID) of the datagram */
+    uint32_t key;
+
+    /*! indicates the entry holds a sent datagram */
+    bool valid;
+
+    /*! wall clock time the datagram was sent, in nanoseconds */
+    uint64_t sent_ns;
+
+    /*! caller context associated with the datagram */
+    void *pCtx;
+
+} TxStampPending;
+
+/*! timestamped socket */
+typedef struct _txStampSocket
+{
+    /*! socket file descriptor */
+    int fd;
+
+    /*! indicates hardware timestamps were enabled on the interface */
+    bool hardware;
+
+    /*! timestamp key the kernel gives the next datagram sent */
+    uint32_t nextKey;
+
+    /*! datagrams waiting for their timestamps, indexed by key */
+    TxStampPending pending[TXSTAMP_PENDING];
+
+} TxStampSocket;
+
+/*! transmit timestamp sample */
+typedef struct _txStampSample
+{
+    /*! caller context of the timestamped datagram */
+    void *pCtx;
+
+    /*! timestamp type (TXSTAMP_TYPE_SCHED, _DRIVER or _WIRE) */
+    int type;
+
+    /*! time from the send call to the timestamp in nanoseconds */
+    uint64_t latency_ns;
+
+} TxStampSample;
+
+/*! transmit timestamp tracker */
+typedef struct _txStamp
+{
+    /*! timestamp mode (TXSTAMP_OFF, TXSTAMP_SOFTWARE, TXSTAMP_HARDWARE) */
+    int mode;
+
+    /*! timestamped sockets */
+    TxStampSocket sockets[TXSTAMP_MAX_SOCKETS];
+
+    /*! number of timestamped sockets */
+    size_t n;
+
+    /*! number of timestamps matched with their datagram */
+    uint64_t samples;
+
+    /*! number of timestamps which could not be matched */
+    uint64_t unmatched;
+
+} TxStamp;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+void TXSTAMP_Init( TxStamp *pTxStamp, int mode );
+int TXSTAMP_Open( TxStamp *pTxStamp, int fd, const char *ifname );
+void TXSTAMP_Close( TxStamp *pTxStamp, int fd );
+bool TXSTAMP_IsOpen( TxStamp *pTxStamp, int fd );
+void TXSTAMP_Sent( TxStamp *pTxStamp,
+                   int fd,
+                   int result,
+                   uint64_t sent_ns,
+                   void *pCtx );
+int TXSTAMP_Read( TxStamp *pTxStamp, int fd, TxStampSample *pSample );
+size_t TXSTAMP_CountHardware( TxStamp *pTxStamp );
+const char *TXSTAMP_ModeName( int mode );
+
+#endif
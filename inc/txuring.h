@@ -0,0 +1,90 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef TXURING_H
+#define TXURING_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/uio.h>
+#include "txbatch.h"
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef TXURING_MAX_FILES
+/*! maximum number of sockets registered with the io_uring instance */
+#define TXURING_MAX_FILES ( 64 )
+#endif
+
+#ifndef TXURING_MAX_BUFFERS
+/*! maximum number of buffers registered with the io_uring instance */
+#define TXURING_MAX_BUFFERS ( 8 )
+#endif
+
+/*! io_uring transmit backend */
+typedef struct _txUring
+{
+    /*! io_uring instance (struct io_uring), or NULL if not initialized */
+    void *pRing;
+
+    /*! socket registered in each fixed file slot, or -1 if the slot
+        is free */
+    int files[TXURING_MAX_FILES];
+
+    /*! indicates sockets are sent on using fixed file slots */
+    bool fixedFiles;
+
+    /*! registered buffers */
+    struct iovec buffers[TXURING_MAX_BUFFERS];
+
+    /*! number of registered buffers */
+    size_t nBuffers;
+
+    /*! indicates datagrams in the registered buffers are sent using
+        zero copy fixed buffer sends */
+    bool zeroCopy;
+
+} TxUring;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+bool TXURING_IsSupported( void );
+int TXURING_Init( TxUring *pUring );
+int TXURING_RegisterBuffers( TxUring *pUring,
+                             const struct iovec *pBuffers,
+                             size_t count );
+int TXURING_Send( TxUring *pUring, TxBatch *pBatch );
+void TXURING_ResetFiles( TxUring *pUring );
+void TXURING_Close( TxUring *pUring );
+
+#endif
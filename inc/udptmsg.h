@@ -0,0 +1,151 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef UDPTMSG_H
+#define UDPTMSG_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+/*! first byte of a framed UDPT message.  0xFE never occurs in UTF-8 text,
+    so framed messages can be told apart from plain rendered templates */
+#define UDPTMSG_MAGIC ( 0xFE )
+
+/*! message type: one segment of a payload spanning several datagrams */
+#define UDPTMSG_TYPE_SEGMENT ( 0x01 )
+
+/*! message type: a compressed payload */
+#define UDPTMSG_TYPE_COMPRESSED ( 0x02 )
+
+/*! message type: a CBOR rendering of a template */
+#define UDPTMSG_TYPE_CBOR ( 0x03 )
+
+/*! size of the segment header */
+#define UDPTMSG_SEGMENT_HEADER_SIZE ( 8 )
+
+/*! maximum number of segments in a segmented payload */
+#define UDPTMSG_MAX_SEGMENTS ( 0xFFFF )
+
+/*! size of the compressed payload header */
+#define UDPTMSG_COMPRESSED_HEADER_SIZE ( 12 )
+
+/*! size of the CBOR payload header */
+#define UDPTMSG_CBOR_HEADER_SIZE ( 6 )
+
+/*! segment header
+
+    The segment header is sent in network byte order as:
+
+        byte 0     UDPTMSG_MAGIC
+        byte 1     UDPTMSG_TYPE_SEGMENT
+        bytes 2-3  message identifier
+        bytes 4-5  segment index (0 based)
+        bytes 6-7  segment count
+*/
+typedef struct _udptSegment
+{
+    /*! message identifier shared by all segments of the payload */
+    uint16_t msgId;
+
+    /*! index of this segment */
+    uint16_t index;
+
+    /*! total number of segments in the payload */
+    uint16_t count;
+
+} UDPTSegment;
+
+/*! compressed payload header
+
+    The compressed payload header is sent in network byte order as:
+
+        byte 0     UDPTMSG_MAGIC
+        byte 1     UDPTMSG_TYPE_COMPRESSED
+        byte 2     compression algorithm (1 = LZ4, 2 = zstd)
+        byte 3     reserved (0)
+        bytes 4-7  dictionary identifier (0 = no dictionary)
+        bytes 8-11 length of the uncompressed payload
+
+    The compressed data follows the header.  A compressed payload which
+    does not fit in one datagram is itself sent as segments.
+*/
+typedef struct _udptCompressed
+{
+    /*! compression algorithm */
+    uint8_t algorithm;
+
+    /*! identifier of the dictionary the payload was compressed with */
+    uint32_t dictId;
+
+    /*! length of the uncompressed payload */
+    uint32_t len;
+
+} UDPTCompressed;
+
+/*! CBOR payload header
+
+    The CBOR payload header is sent in network byte order as:
+
+        byte 0     UDPTMSG_MAGIC
+        byte 1     UDPTMSG_TYPE_CBOR
+        bytes 2-5  schema identifier of the template
+
+    A CBOR array with the values of the template's variable references,
+    in template order, follows the header.
+*/
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+size_t UDPTMSG_WriteSegmentHeader( char *pBuf,
+                                   uint16_t msgId,
+                                   uint16_t index,
+                                   uint16_t count );
+int UDPTMSG_ParseSegmentHeader( const char *pBuf,
+                                size_t len,
+                                UDPTSegment *pSegment );
+size_t UDPTMSG_WriteCompressedHeader( char *pBuf,
+                                      uint8_t algorithm,
+                                      uint32_t dictId,
+                                      uint32_t len );
+int UDPTMSG_ParseCompressedHeader( const char *pBuf,
+                                   size_t len,
+                                   UDPTCompressed *pCompressed );
+
+size_t UDPTMSG_WriteCBORHeader( char *pBuf, uint32_t schemaId );
+int UDPTMSG_ParseCBORHeader( const char *pBuf,
+                             size_t len,
+                             uint32_t *pSchemaId );
+
+#endif
@@ -0,0 +1,98 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef VARCACHE_H
+#define VARCACHE_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <varserver/varserver.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef VARCACHE_INITIAL_SIZE
+/*! initial number of slots in the variable cache (a power of two) */
+#define VARCACHE_INITIAL_SIZE ( 256 )
+#endif
+
+/*! cached variable */
+typedef struct _varCacheEntry
+{
+    /*! variable name, or NULL if the slot is unused */
+    char *name;
+
+    /*! hash of the variable name */
+    uint64_t hash;
+
+    /*! variable handle, or VAR_INVALID if the variable does not exist */
+    VAR_HANDLE hVar;
+
+    /*! type of the variable */
+    VarType type;
+
+    /*! hash of the value last written to the variable */
+    uint64_t valueHash;
+
+    /*! indicates valueHash holds the value last written */
+    bool written;
+
+} VarCacheEntry;
+
+/*! cache mapping variable names to their handles and types */
+typedef struct _varCache
+{
+    /*! open-addressed hash table of cached variables */
+    VarCacheEntry *entries;
+
+    /*! number of slots in the hash table (a power of two) */
+    size_t size;
+
+    /*! number of cached variables */
+    size_t n;
+
+    /*! number of lookups which had to query the variable server */
+    uint64_t misses;
+
+} VarCache;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int VARCACHE_Lookup( VarCache *pCache,
+                     VARSERVER_HANDLE hVarServer,
+                     const char *name,
+                     VarCacheEntry **ppEntry );
+void VARCACHE_Clear( VarCache *pCache );
+void VARCACHE_Free( VarCache *pCache );
+
+#endif
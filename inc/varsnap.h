@@ -0,0 +1,99 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef VARSNAP_H
+#define VARSNAP_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <varserver/varserver.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef VARSNAP_STRING_LEN
+/*! size of the arena space reserved for each string variable value */
+#define VARSNAP_STRING_LEN ( 256 )
+#endif
+
+/*! snapshot of one variable */
+typedef struct _varSnapEntry
+{
+    /*! handle of the variable */
+    VAR_HANDLE hVar;
+
+    /*! value of the variable when the snapshot was taken.  String
+        values point into the snapshot arena */
+    VarObject obj;
+
+    /*! indicates the value was retrieved and can be formatted */
+    bool valid;
+
+} VarSnapEntry;
+
+/*! snapshot of a set of variables.  A zeroed snapshot is empty */
+typedef struct _varSnapshot
+{
+    /*! snapshot entries, sorted by variable handle */
+    VarSnapEntry *entries;
+
+    /*! number of variables in the snapshot */
+    size_t n;
+
+    /*! number of entries allocated */
+    size_t max;
+
+    /*! arena holding VARSNAP_STRING_LEN bytes of string space for
+        each allocated entry */
+    char *arena;
+
+    /*! indicates the snapshot holds current values */
+    bool valid;
+
+    /*! number of snapshots taken */
+    uint32_t count;
+
+} VarSnapshot;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int VARSNAP_Add( VarSnapshot *pSnap, VAR_HANDLE hVar );
+int VARSNAP_Reserve( VarSnapshot *pSnap, size_t n );
+void VARSNAP_Clear( VarSnapshot *pSnap );
+int VARSNAP_Take( VarSnapshot *pSnap, VARSERVER_HANDLE hVarServer );
+void VARSNAP_Invalidate( VarSnapshot *pSnap );
+const VarObject *VARSNAP_Get( const VarSnapshot *pSnap, VAR_HANDLE hVar );
+size_t VARSNAP_Format( const VarObject *pObj, char *pBuf, size_t size );
+void VARSNAP_Free( VarSnapshot *pSnap );
+
+#endif
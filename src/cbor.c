@@ -0,0 +1,644 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup cbor CBOR Encoder
+ * @brief Minimal CBOR (RFC 8949) encoder and decoder for binary payloads
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file cbor.c
+
+    CBOR Encoder
+
+    The cbor component encodes the CBOR data items needed to send
+    variable values in their native form: arrays, unsigned and negative
+    integers, single precision floats, text strings and null.  Data
+    items are written to a caller supplied buffer.  If a data item does
+    not fit, the writer is marked as overflowed and nothing more is
+    written, so the caller only needs to check the result once.
+
+    The reader decodes the same set of data items, plus half and double
+    precision floats, so receivers can parse the binary payloads.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <varserver/varserver.h>
+#include "cbor.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! CBOR major types */
+#define CBOR_MAJOR_UINT ( 0 )
+#define CBOR_MAJOR_NEGINT ( 1 )
+#define CBOR_MAJOR_TEXT ( 3 )
+#define CBOR_MAJOR_ARRAY ( 4 )
+#define CBOR_MAJOR_SIMPLE ( 7 )
+
+/*! CBOR simple value null */
+#define CBOR_NULL ( 22 )
+
+/*! CBOR additional information for a half precision float */
+#define CBOR_FLOAT16 ( 25 )
+
+/*! CBOR additional information for a single precision float */
+#define CBOR_FLOAT32 ( 26 )
+
+/*! CBOR additional information for a double precision float */
+#define CBOR_FLOAT64 ( 27 )
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static void Head( CborWriter *pWriter, int major, uint64_t val );
+static void Put( CborWriter *pWriter, const void *pData, size_t len );
+static int ReadArgument( CborReader *pReader, int info, uint64_t *pVal );
+static double HalfToDouble( uint16_t half );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  CBOR_Init                                                                 */
+/*!
+    Initialize a CBOR writer
+
+    @param[in]
+        pWriter
+            pointer to the CBOR writer
+
+    @param[in]
+        pBuf
+            pointer to the output buffer
+
+    @param[in]
+        size
+            size of the output buffer
+
+==============================================================================*/
+void CBOR_Init( CborWriter *pWriter, char *pBuf, size_t size )
+{
+    pWriter->pBuf = pBuf;
+    pWriter->size = size;
+    pWriter->len = 0;
+    pWriter->overflow = false;
+}
+
+/*============================================================================*/
+/*  CBOR_Array                                                                */
+/*!
+    Start a CBOR array
+
+    The CBOR_Array function writes the head of a definite length array.
+    The array elements must follow.
+
+    @param[in]
+        pWriter
+            pointer to the CBOR writer
+
+    @param[in]
+        count
+            number of elements in the array
+
+==============================================================================*/
+void CBOR_Array( CborWriter *pWriter, size_t count )
+{
+    Head( pWriter, CBOR_MAJOR_ARRAY, (uint64_t)count );
+}
+
+/*============================================================================*/
+/*  CBOR_UInt                                                                 */
+/*!
+    Write an unsigned integer
+
+    @param[in]
+        pWriter
+            pointer to the CBOR writer
+
+    @param[in]
+        val
+            value to write
+
+==============================================================================*/
+void CBOR_UInt( CborWriter *pWriter, uint64_t val )
+{
+    Head( pWriter, CBOR_MAJOR_UINT, val );
+}
+
+/*============================================================================*/
+/*  CBOR_Int                                                                  */
+/*!
+    Write a signed integer
+
+    The CBOR_Int function writes a signed integer, using the negative
+    integer major type (-1 - n) for negative values.
+
+    @param[in]
+        pWriter
+            pointer to the CBOR writer
+
+    @param[in]
+        val
+            value to write
+
+==============================================================================*/
+void CBOR_Int( CborWriter *pWriter, int64_t val )
+{
+    if ( val < 0 )
+    {
+        Head( pWriter, CBOR_MAJOR_NEGINT, (uint64_t)( -1 - val ) );
+    }
+    else
+    {
+        Head( pWriter, CBOR_MAJOR_UINT, (uint64_t)val );
+    }
+}
+
+/*============================================================================*/
+/*  CBOR_Float                                                                */
+/*!
+    Write a single precision float
+
+    @param[in]
+        pWriter
+            pointer to the CBOR writer
+
+    @param[in]
+        val
+            value to write
+
+==============================================================================*/
+void CBOR_Float( CborWriter *pWriter, float val )
+{
+    unsigned char buf[5];
+    uint32_t bits;
+
+    memcpy( &bits, &val, sizeof( bits ) );
+
+    buf[0] = ( CBOR_MAJOR_SIMPLE << 5 ) | CBOR_FLOAT32;
+    buf[1] = (unsigned char)( bits >> 24 );
+    buf[2] = (unsigned char)( bits >> 16 );
+    buf[3] = (unsigned char)( bits >> 8 );
+    buf[4] = (unsigned char)bits;
+
+    Put( pWriter, buf, sizeof( buf ) );
+}
+
+/*============================================================================*/
+/*  CBOR_Text                                                                 */
+/*!
+    Write a text string
+
+    @param[in]
+        pWriter
+            pointer to the CBOR writer
+
+    @param[in]
+        pText
+            pointer to the UTF-8 text
+
+    @param[in]
+        len
+            length of the text in bytes
+
+==============================================================================*/
+void CBOR_Text( CborWriter *pWriter, const char *pText, size_t len )
+{
+    Head( pWriter, CBOR_MAJOR_TEXT, (uint64_t)len );
+    Put( pWriter, pText, len );
+}
+
+/*============================================================================*/
+/*  CBOR_Null                                                                 */
+/*!
+    Write a null value
+
+    @param[in]
+        pWriter
+            pointer to the CBOR writer
+
+==============================================================================*/
+void CBOR_Null( CborWriter *pWriter )
+{
+    unsigned char b = ( CBOR_MAJOR_SIMPLE << 5 ) | CBOR_NULL;
+
+    Put( pWriter, &b, 1 );
+}
+
+/*============================================================================*/
+/*  CBOR_Result                                                               */
+/*!
+    Get the result of a sequence of CBOR writes
+
+    @param[in]
+        pWriter
+            pointer to the CBOR writer
+
+    @retval EOK all of the data items were written
+    @retval E2BIG the data items did not fit in the output buffer
+
+==============================================================================*/
+int CBOR_Result( CborWriter *pWriter )
+{
+    return ( pWriter->overflow == true ) ? E2BIG : EOK;
+}
+
+/*============================================================================*/
+/*  CBOR_InitReader                                                           */
+/*!
+    Initialize a CBOR reader
+
+    @param[in]
+        pReader
+            pointer to the CBOR reader
+
+    @param[in]
+        pBuf
+            pointer to the CBOR input
+
+    @param[in]
+        len
+            length of the CBOR input
+
+==============================================================================*/
+void CBOR_InitReader( CborReader *pReader, const char *pBuf, size_t len )
+{
+    if ( pReader != NULL )
+    {
+        pReader->pBuf = pBuf;
+        pReader->len = ( pBuf != NULL ) ? len : 0;
+        pReader->offset = 0;
+    }
+}
+
+/*============================================================================*/
+/*  CBOR_Read                                                                 */
+/*!
+    Read the next CBOR data item
+
+    The CBOR_Read function decodes the next data item from the input.
+    Text strings are returned in place, and an array returns only its
+    head, so its elements are read by the following calls.
+
+    @param[in]
+        pReader
+            pointer to the CBOR reader
+
+    @param[out]
+        pItem
+            pointer to a location to store the data item
+
+    @retval EOK the data item was read
+    @retval ENODATA there are no more data items
+    @retval EBADMSG the data item is truncated or malformed
+    @retval ENOTSUP the data item is of a type we do not decode
+    @retval ERANGE a negative integer does not fit in 64 bits
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int CBOR_Read( CborReader *pReader, CborItem *pItem )
+{
+    int result = EINVAL;
+    unsigned char b;
+    uint64_t val;
+    uint32_t bits32;
+    float f;
+    int major;
+    int info;
+
+    if ( ( pReader != NULL ) &&
+         ( pItem != NULL ) )
+    {
+        if ( pReader->offset >= pReader->len )
+        {
+            return ENODATA;
+        }
+
+        memset( pItem, 0, sizeof( CborItem ) );
+
+        b = (unsigned char)pReader->pBuf[pReader->offset++];
+        major = b >> 5;
+        info = b & 0x1F;
+
+        result = ReadArgument( pReader, info, &val );
+        if ( result != EOK )
+        {
+            return result;
+        }
+
+        switch( major )
+        {
+            case CBOR_MAJOR_UINT:
+                pItem->type = CBOR_TYPE_UINT;
+                pItem->val.u = val;
+                break;
+
+            case CBOR_MAJOR_NEGINT:
+                if ( val > (uint64_t)INT64_MAX )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    pItem->type = CBOR_TYPE_INT;
+                    pItem->val.i = -1 - (int64_t)val;
+                }
+                break;
+
+            case CBOR_MAJOR_TEXT:
+                if ( ( info == 31 ) ||
+                     ( val > pReader->len - pReader->offset ) )
+                {
+                    result = EBADMSG;
+                }
+                else
+                {
+                    pItem->type = CBOR_TYPE_TEXT;
+                    pItem->pText = &pReader->pBuf[pReader->offset];
+                    pItem->len = (size_t)val;
+                    pReader->offset += (size_t)val;
+                }
+                break;
+
+            case CBOR_MAJOR_ARRAY:
+                if ( info == 31 )
+                {
+                    result = ENOTSUP;
+                }
+                else
+                {
+                    pItem->type = CBOR_TYPE_ARRAY;
+                    pItem->len = (size_t)val;
+                }
+                break;
+
+            case CBOR_MAJOR_SIMPLE:
+                if ( info == CBOR_NULL )
+                {
+                    pItem->type = CBOR_TYPE_NULL;
+                }
+                else if ( info == CBOR_FLOAT16 )
+                {
+                    pItem->type = CBOR_TYPE_FLOAT;
+                    pItem->val.d = HalfToDouble( (uint16_t)val );
+                }
+                else if ( info == CBOR_FLOAT32 )
+                {
+                    bits32 = (uint32_t)val;
+                    memcpy( &f, &bits32, sizeof( f ) );
+                    pItem->type = CBOR_TYPE_FLOAT;
+                    pItem->val.d = f;
+                }
+                else if ( info == CBOR_FLOAT64 )
+                {
+                    pItem->type = CBOR_TYPE_FLOAT;
+                    memcpy( &pItem->val.d, &val, sizeof( double ) );
+                }
+                else
+                {
+                    result = ENOTSUP;
+                }
+                break;
+
+            default:
+                result = ENOTSUP;
+                break;
+        }
+    }
+
+    return result;
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  Head                                                                      */
+/*!
+    Write the head of a CBOR data item
+
+    The Head function writes the initial byte of a data item, followed
+    by its argument in the shortest of the 0, 1, 2, 4 or 8 byte forms.
+
+    @param[in]
+        pWriter
+            pointer to the CBOR writer
+
+    @param[in]
+        major
+            major type of the data item
+
+    @param[in]
+        val
+            argument of the data item
+
+==============================================================================*/
+static void Head( CborWriter *pWriter, int major, uint64_t val )
+{
+    unsigned char buf[CBOR_MAX_HEAD_SIZE];
+    size_t n;
+    size_t i;
+
+    if ( val < 24 )
+    {
+        buf[0] = (unsigned char)( ( major << 5 ) | val );
+        n = 0;
+    }
+    else if ( val <= 0xFF )
+    {
+        buf[0] = (unsigned char)( ( major << 5 ) | 24 );
+        n = 1;
+    }
+    else if ( val <= 0xFFFF )
+    {
+        buf[0] = (unsigned char)( ( major << 5 ) | 25 );
+        n = 2;
+    }
+    else if ( val <= 0xFFFFFFFF )
+    {
+        buf[0] = (unsigned char)( ( major << 5 ) | 26 );
+        n = 4;
+    }
+    else
+    {
+        buf[0] = (unsigned char)( ( major << 5 ) | 27 );
+        n = 8;
+    }
+
+    /* argument in network byte order */
+    for ( i = 0; i < n; i++ )
+    {
+        buf[1 + i] = (unsigned char)( val >> ( 8 * ( n - 1 - i ) ) );
+    }
+
+    Put( pWriter, buf, n + 1 );
+}
+
+/*============================================================================*/
+/*  Put                                                                       */
+/*!
+    Write bytes to the output buffer
+
+    @param[in]
+        pWriter
+            pointer to the CBOR writer
+
+    @param[in]
+        pData
+            pointer to the data to write
+
+    @param[in]
+        len
+            number of bytes to write
+
+==============================================================================*/
+static void Put( CborWriter *pWriter, const void *pData, size_t len )
+{
+    if ( ( pWriter->overflow == false ) &&
+         ( len <= pWriter->size - pWriter->len ) )
+    {
+        memcpy( &pWriter->pBuf[pWriter->len], pData, len );
+        pWriter->len += len;
+    }
+    else
+    {
+        pWriter->overflow = true;
+    }
+}
+
+/*============================================================================*/
+/*  ReadArgument                                                              */
+/*!
+    Read the argument of a CBOR data item
+
+    The ReadArgument function decodes the argument of a data item from
+    the additional information of its initial byte, reading the 1, 2,
+    4 or 8 following bytes if they hold it.
+
+    @param[in]
+        pReader
+            pointer to the CBOR reader, positioned after the initial byte
+
+    @param[in]
+        info
+            additional information from the initial byte
+
+    @param[out]
+        pVal
+            pointer to a location to store the argument
+
+    @retval EOK the argument was read
+    @retval EBADMSG the argument is truncated or reserved
+
+==============================================================================*/
+static int ReadArgument( CborReader *pReader, int info, uint64_t *pVal )
+{
+    size_t n;
+    size_t i;
+
+    *pVal = 0;
+
+    if ( info < 24 )
+    {
+        *pVal = (uint64_t)info;
+        return EOK;
+    }
+    else if ( info == 31 )
+    {
+        /* indefinite length */
+        return EOK;
+    }
+    else if ( info > 27 )
+    {
+        return EBADMSG;
+    }
+
+    n = (size_t)1 << ( info - 24 );
+    if ( n > pReader->len - pReader->offset )
+    {
+        return EBADMSG;
+    }
+
+    /* argument in network byte order */
+    for ( i = 0; i < n; i++ )
+    {
+        *pVal = ( *pVal << 8 ) |
+                (unsigned char)pReader->pBuf[pReader->offset++];
+    }
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  HalfToDouble                                                              */
+/*!
+    Convert a half precision float
+
+    @param[in]
+        half
+            IEEE 754 half precision value
+
+    @retval the value as a double
+
+==============================================================================*/
+static double HalfToDouble( uint16_t half )
+{
+    int exponent = ( half >> 10 ) & 0x1F;
+    int mantissa = half & 0x3FF;
+    double val;
+
+    if ( exponent == 0 )
+    {
+        val = ldexp( mantissa, -24 );
+    }
+    else if ( exponent != 31 )
+    {
+        val = ldexp( mantissa + 1024, exponent - 25 );
+    }
+    else
+    {
+        val = ( mantissa == 0 ) ? INFINITY : NAN;
+    }
+
+    return ( half & 0x8000 ) ? -val : val;
+}
+
+/*! @}
+ * end of cbor group */
@@ -0,0 +1,979 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup compress Payload Compression
+ * @brief Optional compression of rendered payloads
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file compress.c
+
+    Payload Compression
+
+    The compress component compresses rendered payloads using LZ4 or
+    zstd, optionally primed with a dictionary.  Rendered templates are
+    mostly made up of the template's static text, so a dictionary built
+    from that text lets even a small payload compress well.
+
+    Each algorithm is only available if udpt was built with its library
+    (UDPT_WITH_LZ4, UDPT_WITH_ZSTD).  The library contexts are created
+    the first time they are used.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <varserver/varserver.h>
+#ifdef UDPT_WITH_LZ4
+#include <lz4.h>
+#endif
+#ifdef UDPT_WITH_ZSTD
+#include <zstd.h>
+#include <zstd_errors.h>
+#endif
+#include "compress.h"
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+#ifdef UDPT_WITH_LZ4
+static int CompressLZ4( Compressor *pCompressor,
+                        const char *pIn,
+                        size_t inLen,
+                        char *pOut,
+                        size_t outSize,
+                        size_t *pOutLen );
+#endif
+
+#ifdef UDPT_WITH_ZSTD
+static int CompressZstd( Compressor *pCompressor,
+                         const char *pIn,
+                         size_t inLen,
+                         char *pOut,
+                         size_t outSize,
+                         size_t *pOutLen );
+#endif
+
+#ifdef UDPT_WITH_LZ4
+static int DecompressLZ4( Compressor *pCompressor,
+                          const char *pIn,
+                          size_t inLen,
+                          char *pOut,
+                          size_t outSize,
+                          size_t *pOutLen );
+#endif
+
+#ifdef UDPT_WITH_ZSTD
+static int DecompressZstd( Compressor *pCompressor,
+                           const char *pIn,
+                           size_t inLen,
+                           char *pOut,
+                           size_t outSize,
+                           size_t *pOutLen );
+#endif
+
+static uint32_t DictionaryId( const char *pDict, size_t len );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  COMPRESS_Init                                                             */
+/*!
+    Initialize a payload compressor
+
+    The COMPRESS_Init function initializes a payload compressor with
+    no dictionary.
+
+    @param[in]
+        pCompressor
+            pointer to the compressor to initialize
+
+==============================================================================*/
+void COMPRESS_Init( Compressor *pCompressor )
+{
+    if ( pCompressor != NULL )
+    {
+        memset( pCompressor, 0, sizeof( Compressor ) );
+    }
+}
+
+/*============================================================================*/
+/*  COMPRESS_IsSupported                                                      */
+/*!
+    Check if a compression algorithm is available
+
+    The COMPRESS_IsSupported function checks if udpt was built with
+    support for the specified compression algorithm.
+
+    @param[in]
+        algorithm
+            compression algorithm (COMPRESS_NONE, COMPRESS_LZ4,
+            COMPRESS_ZSTD)
+
+    @retval true the algorithm is available
+    @retval false the algorithm is not available
+
+==============================================================================*/
+bool COMPRESS_IsSupported( int algorithm )
+{
+    bool supported = false;
+
+    switch( algorithm )
+    {
+        case COMPRESS_NONE:
+            supported = true;
+            break;
+
+#ifdef UDPT_WITH_LZ4
+        case COMPRESS_LZ4:
+            supported = true;
+            break;
+#endif
+
+#ifdef UDPT_WITH_ZSTD
+        case COMPRESS_ZSTD:
+            supported = true;
+            break;
+#endif
+
+        default:
+            break;
+    }
+
+    return supported;
+}
+
+/*============================================================================*/
+/*  COMPRESS_Name                                                             */
+/*!
+    Get the name of a compression algorithm
+
+    @param[in]
+        algorithm
+            compression algorithm
+
+    @retval name of the compression algorithm
+
+==============================================================================*/
+const char *COMPRESS_Name( int algorithm )
+{
+    const char *name;
+
+    switch( algorithm )
+    {
+        case COMPRESS_NONE:
+            name = "none";
+            break;
+
+        case COMPRESS_LZ4:
+            name = "lz4";
+            break;
+
+        case COMPRESS_ZSTD:
+            name = "zstd";
+            break;
+
+        default:
+            name = "unknown";
+            break;
+    }
+
+    return name;
+}
+
+/*============================================================================*/
+/*  COMPRESS_Bound                                                            */
+/*!
+    Get the worst case compressed size
+
+    The COMPRESS_Bound function gets the largest size the specified
+    algorithm may compress an input of the given length to.
+
+    @param[in]
+        algorithm
+            compression algorithm
+
+    @param[in]
+        len
+            length of the input
+
+    @retval worst case compressed size
+
+==============================================================================*/
+size_t COMPRESS_Bound( int algorithm, size_t len )
+{
+    size_t bound = len;
+
+    switch( algorithm )
+    {
+#ifdef UDPT_WITH_LZ4
+        case COMPRESS_LZ4:
+            if ( len <= LZ4_MAX_INPUT_SIZE )
+            {
+                bound = (size_t)LZ4_compressBound( (int)len );
+            }
+            break;
+#endif
+
+#ifdef UDPT_WITH_ZSTD
+        case COMPRESS_ZSTD:
+            bound = ZSTD_compressBound( len );
+            break;
+#endif
+
+        default:
+            break;
+    }
+
+    return bound;
+}
+
+/*============================================================================*/
+/*  COMPRESS_SetDictionary                                                    */
+/*!
+    Set the compression dictionary
+
+    The COMPRESS_SetDictionary function replaces the compressor's
+    dictionary with a copy of the specified data.  Only the last
+    COMPRESS_MAX_DICT_SIZE bytes are used.  The dictionary identifier
+    is a hash of the dictionary so receivers can check they are using
+    the same one.  A zero length dictionary removes the dictionary.
+
+    @param[in]
+        pCompressor
+            pointer to the compressor
+
+    @param[in]
+        pDict
+            pointer to the dictionary data
+
+    @param[in]
+        len
+            length of the dictionary data
+
+    @retval EOK the dictionary was set
+    @retval ENOMEM memory allocation failed
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int COMPRESS_SetDictionary( Compressor *pCompressor,
+                            const char *pDict,
+                            size_t len )
+{
+    int result = EINVAL;
+
+    if ( ( pCompressor != NULL ) &&
+         ( ( pDict != NULL ) || ( len == 0 ) ) )
+    {
+        free( pCompressor->pDict );
+        pCompressor->pDict = NULL;
+        pCompressor->dictLen = 0;
+        pCompressor->dictId = 0;
+
+#ifdef UDPT_WITH_ZSTD
+        /* the digested dictionary is re-created on next use */
+        ZSTD_freeCDict( (ZSTD_CDict *)pCompressor->pZstdDict );
+        pCompressor->pZstdDict = NULL;
+#endif
+
+        result = EOK;
+
+        if ( len > COMPRESS_MAX_DICT_SIZE )
+        {
+            pDict += len - COMPRESS_MAX_DICT_SIZE;
+            len = COMPRESS_MAX_DICT_SIZE;
+        }
+
+        if ( len > 0 )
+        {
+            pCompressor->pDict = malloc( len );
+            if ( pCompressor->pDict != NULL )
+            {
+                memcpy( pCompressor->pDict, pDict, len );
+                pCompressor->dictLen = len;
+                pCompressor->dictId = DictionaryId( pDict, len );
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  COMPRESS_Compress                                                         */
+/*!
+    Compress a payload
+
+    The COMPRESS_Compress function compresses the input using the
+    specified algorithm and the compressor's dictionary, if it has one.
+
+    @param[in]
+        pCompressor
+            pointer to the compressor
+
+    @param[in]
+        algorithm
+            compression algorithm (COMPRESS_LZ4 or COMPRESS_ZSTD)
+
+    @param[in]
+        pIn
+            pointer to the input
+
+    @param[in]
+        inLen
+            length of the input
+
+    @param[out]
+        pOut
+            pointer to the output buffer
+
+    @param[in]
+        outSize
+            size of the output buffer
+
+    @param[out]
+        pOutLen
+            pointer to a location to store the compressed length
+
+    @retval EOK the payload was compressed
+    @retval E2BIG the compressed payload does not fit in the output buffer
+    @retval ENOTSUP the algorithm is not available
+    @retval ENOMEM memory allocation failed
+    @retval EIO compression failed
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int COMPRESS_Compress( Compressor *pCompressor,
+                       int algorithm,
+                       const char *pIn,
+                       size_t inLen,
+                       char *pOut,
+                       size_t outSize,
+                       size_t *pOutLen )
+{
+    int result = EINVAL;
+
+#if !defined( UDPT_WITH_LZ4 ) && !defined( UDPT_WITH_ZSTD )
+    /* only used by the compression libraries */
+    (void)inLen;
+    (void)outSize;
+#endif
+
+    if ( ( pCompressor != NULL ) &&
+         ( pIn != NULL ) &&
+         ( pOut != NULL ) &&
+         ( pOutLen != NULL ) )
+    {
+        switch( algorithm )
+        {
+#ifdef UDPT_WITH_LZ4
+            case COMPRESS_LZ4:
+                result = CompressLZ4( pCompressor,
+                                      pIn,
+                                      inLen,
+                                      pOut,
+                                      outSize,
+                                      pOutLen );
+                break;
+#endif
+
+#ifdef UDPT_WITH_ZSTD
+            case COMPRESS_ZSTD:
+                result = CompressZstd( pCompressor,
+                                       pIn,
+                                       inLen,
+                                       pOut,
+                                       outSize,
+                                       pOutLen );
+                break;
+#endif
+
+            default:
+                result = ENOTSUP;
+                break;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  COMPRESS_Decompress                                                       */
+/*!
+    Decompress a payload
+
+    The COMPRESS_Decompress function decompresses a payload produced by
+    COMPRESS_Compress, using the compressor's dictionary if it has one.
+    The dictionary must be the one the payload was compressed with.
+
+    @param[in]
+        pCompressor
+            pointer to the compressor
+
+    @param[in]
+        algorithm
+            compression algorithm (COMPRESS_LZ4 or COMPRESS_ZSTD)
+
+    @param[in]
+        pIn
+            pointer to the compressed payload
+
+    @param[in]
+        inLen
+            length of the compressed payload
+
+    @param[out]
+        pOut
+            pointer to the output buffer
+
+    @param[in]
+        outSize
+            size of the output buffer
+
+    @param[out]
+        pOutLen
+            pointer to a location to store the decompressed length
+
+    @retval EOK the payload was decompressed
+    @retval E2BIG the payload does not fit in the output buffer
+    @retval EBADMSG the compressed payload is corrupt
+    @retval ENOTSUP the algorithm is not available
+    @retval ENOMEM memory allocation failed
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int COMPRESS_Decompress( Compressor *pCompressor,
+                         int algorithm,
+                         const char *pIn,
+                         size_t inLen,
+                         char *pOut,
+                         size_t outSize,
+                         size_t *pOutLen )
+{
+    int result = EINVAL;
+
+#if !defined( UDPT_WITH_LZ4 ) && !defined( UDPT_WITH_ZSTD )
+    /* only used by the compression libraries */
+    (void)inLen;
+    (void)outSize;
+#endif
+
+    if ( ( pCompressor != NULL ) &&
+         ( pIn != NULL ) &&
+         ( pOut != NULL ) &&
+         ( pOutLen != NULL ) )
+    {
+        switch( algorithm )
+        {
+#ifdef UDPT_WITH_LZ4
+            case COMPRESS_LZ4:
+                result = DecompressLZ4( pCompressor,
+                                        pIn,
+                                        inLen,
+                                        pOut,
+                                        outSize,
+                                        pOutLen );
+                break;
+#endif
+
+#ifdef UDPT_WITH_ZSTD
+            case COMPRESS_ZSTD:
+                result = DecompressZstd( pCompressor,
+                                         pIn,
+                                         inLen,
+                                         pOut,
+                                         outSize,
+                                         pOutLen );
+                break;
+#endif
+
+            default:
+                result = ENOTSUP;
+                break;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  COMPRESS_Free                                                             */
+/*!
+    Free the resources used by a payload compressor
+
+    The COMPRESS_Free function releases the compressor's dictionary and
+    library contexts, leaving it in its initialized state.
+
+    @param[in]
+        pCompressor
+            pointer to the compressor
+
+==============================================================================*/
+void COMPRESS_Free( Compressor *pCompressor )
+{
+    if ( pCompressor != NULL )
+    {
+        free( pCompressor->pDict );
+
+#ifdef UDPT_WITH_LZ4
+        if ( pCompressor->pLz4Stream != NULL )
+        {
+            (void)LZ4_freeStream( (LZ4_stream_t *)pCompressor->pLz4Stream );
+        }
+#endif
+
+#ifdef UDPT_WITH_ZSTD
+        ZSTD_freeCDict( (ZSTD_CDict *)pCompressor->pZstdDict );
+        ZSTD_freeCCtx( (ZSTD_CCtx *)pCompressor->pZstdCtx );
+        ZSTD_freeDCtx( (ZSTD_DCtx *)pCompressor->pZstdDCtx );
+#endif
+
+        memset( pCompressor, 0, sizeof( Compressor ) );
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+#ifdef UDPT_WITH_LZ4
+/*============================================================================*/
+/*  CompressLZ4                                                               */
+/*!
+    Compress a payload using LZ4
+
+    The CompressLZ4 function compresses the input as a single LZ4 block.
+    If the compressor has a dictionary, it is loaded into the LZ4 stream
+    before every block, so each block can be decompressed on its own
+    using LZ4_decompress_safe_usingDict().
+
+    @param[in]
+        pCompressor
+            pointer to the compressor
+
+    @param[in]
+        pIn
+            pointer to the input
+
+    @param[in]
+        inLen
+            length of the input
+
+    @param[out]
+        pOut
+            pointer to the output buffer
+
+    @param[in]
+        outSize
+            size of the output buffer
+
+    @param[out]
+        pOutLen
+            pointer to a location to store the compressed length
+
+    @retval EOK the payload was compressed
+    @retval E2BIG the compressed payload does not fit in the output buffer
+    @retval ENOMEM memory allocation failed
+
+==============================================================================*/
+static int CompressLZ4( Compressor *pCompressor,
+                        const char *pIn,
+                        size_t inLen,
+                        char *pOut,
+                        size_t outSize,
+                        size_t *pOutLen )
+{
+    int result = EOK;
+    LZ4_stream_t *pStream;
+    int n;
+
+    if ( inLen > LZ4_MAX_INPUT_SIZE )
+    {
+        result = E2BIG;
+    }
+
+    if ( outSize > INT_MAX )
+    {
+        outSize = INT_MAX;
+    }
+
+    if ( ( result == EOK ) &&
+         ( pCompressor->pLz4Stream == NULL ) )
+    {
+        pCompressor->pLz4Stream = LZ4_createStream();
+        if ( pCompressor->pLz4Stream == NULL )
+        {
+            result = ENOMEM;
+        }
+    }
+
+    if ( result == EOK )
+    {
+        pStream = (LZ4_stream_t *)pCompressor->pLz4Stream;
+
+        /* loading the dictionary also resets the stream, so the block
+           only references the dictionary */
+        (void)LZ4_loadDict( pStream,
+                            pCompressor->pDict,
+                            (int)pCompressor->dictLen );
+
+        n = LZ4_compress_fast_continue( pStream,
+                                        pIn,
+                                        pOut,
+                                        (int)inLen,
+                                        (int)outSize,
+                                        1 );
+        if ( n > 0 )
+        {
+            *pOutLen = (size_t)n;
+        }
+        else
+        {
+            result = E2BIG;
+        }
+    }
+
+    return result;
+}
+#endif
+
+#ifdef UDPT_WITH_ZSTD
+/*============================================================================*/
+/*  CompressZstd                                                              */
+/*!
+    Compress a payload using zstd
+
+    The CompressZstd function compresses the input as a single zstd
+    frame.  If the compressor has a dictionary, it is digested the
+    first time it is used and treated as raw content, so the receiver
+    only needs the same dictionary bytes to decompress the frame.
+
+    @param[in]
+        pCompressor
+            pointer to the compressor
+
+    @param[in]
+        pIn
+            pointer to the input
+
+    @param[in]
+        inLen
+            length of the input
+
+    @param[out]
+        pOut
+            pointer to the output buffer
+
+    @param[in]
+        outSize
+            size of the output buffer
+
+    @param[out]
+        pOutLen
+            pointer to a location to store the compressed length
+
+    @retval EOK the payload was compressed
+    @retval E2BIG the compressed payload does not fit in the output buffer
+    @retval ENOMEM memory allocation failed
+    @retval EIO compression failed
+
+==============================================================================*/
+static int CompressZstd( Compressor *pCompressor,
+                         const char *pIn,
+                         size_t inLen,
+                         char *pOut,
+                         size_t outSize,
+                         size_t *pOutLen )
+{
+    int result = EOK;
+    size_t n;
+
+    if ( pCompressor->pZstdCtx == NULL )
+    {
+        pCompressor->pZstdCtx = ZSTD_createCCtx();
+        if ( pCompressor->pZstdCtx == NULL )
+        {
+            result = ENOMEM;
+        }
+    }
+
+    if ( ( result == EOK ) &&
+         ( pCompressor->pDict != NULL ) &&
+         ( pCompressor->pZstdDict == NULL ) )
+    {
+        pCompressor->pZstdDict = ZSTD_createCDict( pCompressor->pDict,
+                                                   pCompressor->dictLen,
+                                                   COMPRESS_ZSTD_LEVEL );
+        if ( pCompressor->pZstdDict == NULL )
+        {
+            result = ENOMEM;
+        }
+    }
+
+    if ( result == EOK )
+    {
+        if ( pCompressor->pZstdDict != NULL )
+        {
+            n = ZSTD_compress_usingCDict(
+                                    (ZSTD_CCtx *)pCompressor->pZstdCtx,
+                                    pOut,
+                                    outSize,
+                                    pIn,
+                                    inLen,
+                                    (ZSTD_CDict *)pCompressor->pZstdDict );
+        }
+        else
+        {
+            n = ZSTD_compressCCtx( (ZSTD_CCtx *)pCompressor->pZstdCtx,
+                                   pOut,
+                                   outSize,
+                                   pIn,
+                                   inLen,
+                                   COMPRESS_ZSTD_LEVEL );
+        }
+
+        if ( ZSTD_isError( n ) )
+        {
+            result = ( ZSTD_getErrorCode( n ) == ZSTD_error_dstSize_tooSmall )
+                     ? E2BIG
+                     : EIO;
+        }
+        else
+        {
+            *pOutLen = n;
+        }
+    }
+
+    return result;
+}
+#endif
+
+#ifdef UDPT_WITH_LZ4
+/*============================================================================*/
+/*  DecompressLZ4                                                             */
+/*!
+    Decompress an LZ4 payload
+
+    The DecompressLZ4 function decompresses a single LZ4 block which
+    only references the compressor's dictionary.
+
+    @param[in]
+        pCompressor
+            pointer to the compressor
+
+    @param[in]
+        pIn
+            pointer to the compressed block
+
+    @param[in]
+        inLen
+            length of the compressed block
+
+    @param[out]
+        pOut
+            pointer to the output buffer
+
+    @param[in]
+        outSize
+            size of the output buffer
+
+    @param[out]
+        pOutLen
+            pointer to a location to store the decompressed length
+
+    @retval EOK the payload was decompressed
+    @retval EBADMSG the block is corrupt or does not fit in the output buffer
+
+==============================================================================*/
+static int DecompressLZ4( Compressor *pCompressor,
+                          const char *pIn,
+                          size_t inLen,
+                          char *pOut,
+                          size_t outSize,
+                          size_t *pOutLen )
+{
+    int result = EBADMSG;
+    int n;
+
+    if ( outSize > INT_MAX )
+    {
+        outSize = INT_MAX;
+    }
+
+    if ( inLen <= INT_MAX )
+    {
+        n = LZ4_decompress_safe_usingDict( pIn,
+                                           pOut,
+                                           (int)inLen,
+                                           (int)outSize,
+                                           pCompressor->pDict,
+                                           (int)pCompressor->dictLen );
+        if ( n >= 0 )
+        {
+            *pOutLen = (size_t)n;
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+#endif
+
+#ifdef UDPT_WITH_ZSTD
+/*============================================================================*/
+/*  DecompressZstd                                                            */
+/*!
+    Decompress a zstd payload
+
+    The DecompressZstd function decompresses a single zstd frame, using
+    the compressor's dictionary as raw content if it has one.
+
+    @param[in]
+        pCompressor
+            pointer to the compressor
+
+    @param[in]
+        pIn
+            pointer to the compressed frame
+
+    @param[in]
+        inLen
+            length of the compressed frame
+
+    @param[out]
+        pOut
+            pointer to the output buffer
+
+    @param[in]
+        outSize
+            size of the output buffer
+
+    @param[out]
+        pOutLen
+            pointer to a location to store the decompressed length
+
+    @retval EOK the payload was decompressed
+    @retval E2BIG the payload does not fit in the output buffer
+    @retval ENOMEM memory allocation failed
+    @retval EBADMSG the frame is corrupt
+
+==============================================================================*/
+static int DecompressZstd( Compressor *pCompressor,
+                           const char *pIn,
+                           size_t inLen,
+                           char *pOut,
+                           size_t outSize,
+                           size_t *pOutLen )
+{
+    int result = EOK;
+    size_t n;
+
+    if ( pCompressor->pZstdDCtx == NULL )
+    {
+        pCompressor->pZstdDCtx = ZSTD_createDCtx();
+        if ( pCompressor->pZstdDCtx == NULL )
+        {
+            result = ENOMEM;
+        }
+    }
+
+    if ( result == EOK )
+    {
+        n = ZSTD_decompress_usingDict( (ZSTD_DCtx *)pCompressor->pZstdDCtx,
+                                       pOut,
+                                       outSize,
+                                       pIn,
+                                       inLen,
+                                       pCompressor->pDict,
+                                       pCompressor->dictLen );
+        if ( ZSTD_isError( n ) )
+        {
+            result = ( ZSTD_getErrorCode( n ) == ZSTD_error_dstSize_tooSmall )
+                     ? E2BIG
+                     : EBADMSG;
+        }
+        else
+        {
+            *pOutLen = n;
+        }
+    }
+
+    return result;
+}
+#endif
+
+/*============================================================================*/
+/*  DictionaryId                                                              */
+/*!
+    Calculate a dictionary identifier
+
+    The DictionaryId function calculates the 32-bit FNV-1a hash of a
+    dictionary.  Zero is reserved to mean no dictionary.
+
+    @param[in]
+        pDict
+            pointer to the dictionary data
+
+    @param[in]
+        len
+            length of the dictionary data
+
+    @retval the dictionary identifier
+
+==============================================================================*/
+static uint32_t DictionaryId( const char *pDict, size_t len )
+{
+    uint32_t hash = 2166136261u;
+    size_t i;
+
+    for ( i = 0; i < len; i++ )
+    {
+        hash ^= (unsigned char)pDict[i];
+        hash *= 16777619u;
+    }
+
+    return ( hash != 0 ) ? hash : 1;
+}
+
+/*! @}
+ * end of compress group */
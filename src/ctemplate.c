@@ -0,0 +1,1860 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup ctemplate Compiled Template
+ * @brief Pre-parsed template with pre-resolved variable handles
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file ctemplate.c
+
+    Compiled Template
+
+    The ctemplate component parses a template file containing static text
+    and embedded ${varname} references into a flat array of static text
+    spans and variable references.  The variable names are resolved to
+    varserver handles once at compile time, so rendering the template
+    only needs to walk the element array.
+
+    The template is re-compiled when its file name changes, or when the
+    template file's inode, size or modification time changes.  The file
+    is checked at most once every CTEMPLATE_REFRESH_NS, so a template
+    which is rendered for every transmission does not cost a stat() and
+    a variable server lookup for each unresolved name every time.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <varserver/varserver.h>
+#include "ctemplate.h"
+#include "hash.h"
+#include "txsched.h"
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static int ReadTemplate( CompiledTemplate *pTemplate, int fd, size_t size );
+static int Parse( CompiledTemplate *pTemplate );
+static int AddElement( CompiledTemplate *pTemplate,
+                       size_t *pMaxElements,
+                       size_t offset,
+                       size_t len,
+                       bool isVar );
+static size_t Resolve( CompiledTemplate *pTemplate,
+                       VARSERVER_HANDLE hVarServer );
+static bool IsChanged( CompiledTemplate *pTemplate,
+                       const char *filename,
+                       struct stat *pStat );
+static void Output( int fd, char *buf, size_t len );
+static int RenderBuffer( CompiledTemplate *pTemplate,
+                         VARSERVER_HANDLE hVarServer,
+                         const VarSnapshot *pSnap,
+                         CTBuffer *pBuffer,
+                         CTSplices *pSplices,
+                         bool useCache );
+static bool IsSplice( const CTSplices *pSplices,
+                      VAR_HANDLE hVar,
+                      size_t *pField );
+static int AddSplice( CTSplices *pSplices, size_t field, size_t offset );
+static int RenderVar( VARSERVER_HANDLE hVarServer,
+                      const VarSnapshot *pSnap,
+                      VAR_HANDLE hVar,
+                      CTBuffer *pBuffer,
+                      bool *pPrinted );
+static void CacheVar( CompiledTemplate *pTemplate,
+                      CTElement *pElement,
+                      const char *text,
+                      size_t len );
+static int Append( CTBuffer *pBuffer, const char *buf, size_t len );
+static int PrintVar( VARSERVER_HANDLE hVarServer,
+                     VAR_HANDLE hVar,
+                     CTBuffer *pBuffer );
+static void EncodeVar( VARSERVER_HANDLE hVarServer,
+                       const VarSnapshot *pSnap,
+                       VAR_HANDLE hVar,
+                       CborWriter *pWriter );
+static void EncodeObject( const VarObject *pObj,
+                          size_t maxLen,
+                          CborWriter *pWriter );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  CTEMPLATE_Compile                                                         */
+/*!
+    Compile a template file
+
+    The CTEMPLATE_Compile function reads the specified template file,
+    splits it into static text spans and variable references, and
+    resolves the referenced variable names to varserver handles.
+    Any previously compiled template is discarded, and the template
+    generation and variable binding counters are incremented.
+
+    @param[in]
+        pTemplate
+            pointer to the compiled template object
+
+    @param[in]
+        hVarServer
+            handle to the variable server used to resolve variable names
+
+    @param[in]
+        filename
+            name of the template file to compile
+
+    @retval EOK the template was compiled
+    @retval ENOENT no template file specified, or it could not be opened
+    @retval E2BIG the template file is too large
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int CTEMPLATE_Compile( CompiledTemplate *pTemplate,
+                       VARSERVER_HANDLE hVarServer,
+                       const char *filename )
+{
+    int result = EINVAL;
+    struct stat sb;
+    uint32_t generation;
+    uint32_t bindings;
+    int fd;
+
+    if ( ( pTemplate != NULL ) &&
+         ( filename != NULL ) )
+    {
+        generation = pTemplate->generation;
+        bindings = pTemplate->bindings;
+        CTEMPLATE_Free( pTemplate );
+
+        result = ENOENT;
+        if ( strlen( filename ) > 0 )
+        {
+            fd = open( filename, O_RDONLY | O_CLOEXEC );
+            if ( fd != -1 )
+            {
+                if ( fstat( fd, &sb ) == 0 )
+                {
+                    result = ( sb.st_size <= CTEMPLATE_MAX_SIZE ) ? EOK : E2BIG;
+                    if ( result == EOK )
+                    {
+                        result = ReadTemplate( pTemplate, fd, sb.st_size );
+                    }
+
+                    if ( result == EOK )
+                    {
+                        result = Parse( pTemplate );
+                    }
+
+                    if ( result == EOK )
+                    {
+                        snprintf( pTemplate->filename,
+                                  sizeof( pTemplate->filename ),
+                                  "%s",
+                                  filename );
+                        pTemplate->dev = sb.st_dev;
+                        pTemplate->ino = sb.st_ino;
+                        pTemplate->size = sb.st_size;
+                        pTemplate->mtime = sb.st_mtim;
+                        pTemplate->schemaId =
+                            (uint32_t)HASH_Compute( pTemplate->text,
+                                                    pTemplate->textLen );
+                        pTemplate->valid = true;
+                        pTemplate->checked_ns = SCHED_Now();
+
+                        (void)Resolve( pTemplate, hVarServer );
+                    }
+                    else
+                    {
+                        CTEMPLATE_Free( pTemplate );
+                    }
+                }
+                else
+                {
+                    result = errno;
+                }
+
+                close( fd );
+            }
+        }
+
+        pTemplate->generation = generation + 1;
+        pTemplate->bindings = bindings + 1;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CTEMPLATE_Refresh                                                         */
+/*!
+    Refresh a compiled template
+
+    The CTEMPLATE_Refresh function checks if the template file has been
+    renamed, replaced, or modified since it was compiled, and re-compiles
+    it if necessary.  It also retries resolution of any variable
+    references which could not be resolved previously, since the
+    referenced variables may have been created since.  Both are done at
+    most once every CTEMPLATE_REFRESH_NS, unless the file name changes.
+    The variable binding counter is incremented if any reference was
+    resolved.
+
+    @param[in]
+        pTemplate
+            pointer to the compiled template object
+
+    @param[in]
+        hVarServer
+            handle to the variable server used to resolve variable names
+
+    @param[in]
+        filename
+            name of the template file
+
+    @retval EOK the compiled template is up to date
+    @retval EINVAL invalid arguments
+    @retval other error from CTEMPLATE_Compile
+
+==============================================================================*/
+int CTEMPLATE_Refresh( CompiledTemplate *pTemplate,
+                       VARSERVER_HANDLE hVarServer,
+                       const char *filename )
+{
+    int result = EINVAL;
+    struct stat sb;
+    uint64_t now_ns;
+
+    if ( ( pTemplate != NULL ) &&
+         ( filename != NULL ) )
+    {
+        now_ns = SCHED_Now();
+
+        if ( ( now_ns - pTemplate->checked_ns < CTEMPLATE_REFRESH_NS ) &&
+             ( ( pTemplate->valid == false ) ||
+               ( strcmp( pTemplate->filename, filename ) == 0 ) ) )
+        {
+            /* checked recently */
+            result = EOK;
+        }
+        else if ( ( stat( filename, &sb ) != 0 ) ||
+             ( IsChanged( pTemplate, filename, &sb ) == true ) )
+        {
+            result = CTEMPLATE_Compile( pTemplate, hVarServer, filename );
+        }
+        else
+        {
+            if ( ( pTemplate->nUnresolved > 0 ) &&
+                 ( Resolve( pTemplate, hVarServer ) > 0 ) )
+            {
+                pTemplate->bindings++;
+            }
+
+            result = EOK;
+        }
+
+        /* a template which failed to compile is retried at the same
+           rate */
+        pTemplate->checked_ns = now_ns;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CTEMPLATE_Render                                                          */
+/*!
+    Render a compiled template
+
+    The CTEMPLATE_Render function walks the compiled template elements,
+    writing the static text spans and the values of the referenced
+    variables to the output file descriptor.  Unresolved variable
+    references render as empty text.
+
+    @param[in]
+        pTemplate
+            pointer to the compiled template object
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        fd
+            output file descriptor
+
+    @retval EOK the template was rendered
+    @retval ENOENT the template has not been compiled
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int CTEMPLATE_Render( CompiledTemplate *pTemplate,
+                      VARSERVER_HANDLE hVarServer,
+                      int fd )
+{
+    return CTEMPLATE_RenderSplice( pTemplate,
+                                   hVarServer,
+                                   NULL,
+                                   fd,
+                                   NULL );
+}
+
+/*============================================================================*/
+/*  CTEMPLATE_RenderSplice                                                    */
+/*!
+    Render a compiled template with splice points
+
+    The CTEMPLATE_RenderSplice function renders the compiled template in
+    the same way as CTEMPLATE_Render, except that references to the
+    splice variables are not rendered.  Instead, the output offset of
+    each reference is recorded, along with the variable it refers to,
+    so the caller can insert a different value at each splice point
+    without re-rendering the template.
+
+    If a variable snapshot is supplied, the variables it holds a value
+    for are formatted from the snapshot rather than printed by the
+    variable server.
+
+    @param[in]
+        pTemplate
+            pointer to the compiled template object
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        pSnap
+            pointer to a snapshot of the variable values, or NULL to
+            print every variable using the variable server
+
+    @param[in]
+        fd
+            output file descriptor.  It must support lseek()
+
+    @param[in,out]
+        pSplices
+            pointer to the variables whose references are splice
+            points, which receives the output offsets of the splice
+            points, or NULL to render all variables
+
+    @retval EOK the template was rendered
+    @retval ENOENT the template has not been compiled
+    @retval ENOSPC too many splice points
+    @retval EIO unable to get the output offset
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int CTEMPLATE_RenderSplice( CompiledTemplate *pTemplate,
+                            VARSERVER_HANDLE hVarServer,
+                            const VarSnapshot *pSnap,
+                            int fd,
+                            CTSplices *pSplices )
+{
+    int result = EINVAL;
+    CTElement *pElement;
+    const VarObject *pObj;
+    char buf[CTEMPLATE_MAX_STRING];
+    size_t field;
+    size_t len;
+    off_t offset;
+    size_t i;
+
+    if ( ( pTemplate != NULL ) &&
+         ( fd != -1 ) )
+    {
+        if ( pSplices != NULL )
+        {
+            pSplices->nPoints = 0;
+        }
+
+        result = ENOENT;
+        if ( pTemplate->valid == true )
+        {
+            result = EOK;
+
+            for ( i = 0; ( i < pTemplate->nElements ) && ( result == EOK ); i++ )
+            {
+                pElement = &pTemplate->elements[i];
+                if ( pElement->isVar == false )
+                {
+                    Output( fd,
+                            &pTemplate->text[pElement->offset],
+                            pElement->len );
+                }
+                else if ( pElement->hVar == VAR_INVALID )
+                {
+                    /* unresolved references render as empty text */
+                    continue;
+                }
+                else if ( IsSplice( pSplices, pElement->hVar, &field ) )
+                {
+                    offset = lseek( fd, 0, SEEK_CUR );
+                    result = ( offset != -1 )
+                             ? AddSplice( pSplices, field, (size_t)offset )
+                             : EIO;
+                }
+                else
+                {
+                    pObj = VARSNAP_Get( pSnap, pElement->hVar );
+                    if ( pObj != NULL )
+                    {
+                        /* format the value from the snapshot */
+                        len = VARSNAP_Format( pObj, buf, sizeof( buf ) );
+                        Output( fd, buf, len );
+                    }
+                    else
+                    {
+                        (void)VAR_Print( hVarServer, pElement->hVar, fd );
+                    }
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CTEMPLATE_RenderBuffer                                                    */
+/*!
+    Render a compiled template into an in-process buffer
+
+    The CTEMPLATE_RenderBuffer function renders the compiled template in
+    the same way as CTEMPLATE_RenderSplice, but into a buffer in this
+    process.  The static text, and the variables formatted from the
+    snapshot, are copied straight into the buffer without any system
+    calls, and the rendered length is tracked so the output does not
+    have to be read back or measured.
+
+    Variables which are not in the snapshot are printed by the variable
+    server, possibly using another process's print handler, into the
+    buffer's print stream, and copied from the stream contents into the
+    buffer.  The rendered output is NUL terminated when it fits.
+
+    @param[in]
+        pTemplate
+            pointer to the compiled template object
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        pSnap
+            pointer to a snapshot of the variable values, or NULL to
+            print every variable using the variable server
+
+    @param[in,out]
+        pBuffer
+            pointer to the buffer to render into
+
+    @param[in,out]
+        pSplices
+            pointer to the variables whose references are splice
+            points, which receives the buffer offsets of the splice
+            points, or NULL to render all variables
+
+    @retval EOK the template was rendered
+    @retval ENOENT the template has not been compiled
+    @retval ENOSPC too many splice points
+    @retval E2BIG the rendering does not fit in the buffer
+    @retval EBADF a variable must be printed but there is no print stream
+    @retval EIO unable to get the print stream offset
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int CTEMPLATE_RenderBuffer( CompiledTemplate *pTemplate,
+                            VARSERVER_HANDLE hVarServer,
+                            const VarSnapshot *pSnap,
+                            CTBuffer *pBuffer,
+                            CTSplices *pSplices )
+{
+    return RenderBuffer( pTemplate,
+                         hVarServer,
+                         pSnap,
+                         pBuffer,
+                         pSplices,
+                         false );
+}
+
+/*============================================================================*/
+/*  CTEMPLATE_RenderCached                                                    */
+/*!
+    Render a compiled template into a buffer, reusing unchanged values
+
+    The CTEMPLATE_RenderCached function renders the compiled template in
+    the same way as CTEMPLATE_RenderBuffer, but keeps the formatted text
+    of each variable reference.  References whose text is still cached
+    are copied byte-for-byte from the cache instead of being formatted
+    again, so the render work depends on the number of variables which
+    have changed rather than the template size.
+
+    The caller must call CTEMPLATE_Invalidate whenever a referenced
+    variable changes, for example on a NOTIFY_MODIFIED notification
+    requested by CTEMPLATE_Subscribe.
+    Only values formatted from the snapshot for notified references
+    are cached.  Values which are printed by the variable server, which
+    may come from a print handler that never notifies a change, values
+    of references which are not notified, and values which do not fit
+    in a cache slot, are formatted on every render.
+
+    @param[in]
+        pTemplate
+            pointer to the compiled template object
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        pSnap
+            pointer to a snapshot of the variable values, or NULL to
+            print every changed variable using the variable server
+
+    @param[in,out]
+        pBuffer
+            pointer to the buffer to render into
+
+    @param[in,out]
+        pSplices
+            pointer to the variables whose references are splice
+            points, which receives the buffer offsets of the splice
+            points, or NULL to render all variables
+
+    @retval EOK the template was rendered
+    @retval ENOMEM the cache could not be allocated
+    @retval other error from CTEMPLATE_RenderBuffer
+
+==============================================================================*/
+int CTEMPLATE_RenderCached( CompiledTemplate *pTemplate,
+                            VARSERVER_HANDLE hVarServer,
+                            const VarSnapshot *pSnap,
+                            CTBuffer *pBuffer,
+                            CTSplices *pSplices )
+{
+    int result = EINVAL;
+
+    if ( pTemplate != NULL )
+    {
+        result = EOK;
+
+        if ( ( pTemplate->cache == NULL ) &&
+             ( pTemplate->nVars > 0 ) )
+        {
+            pTemplate->cache = malloc( pTemplate->nVars * CTEMPLATE_SLOT_SIZE );
+            result = ( pTemplate->cache != NULL ) ? EOK : ENOMEM;
+        }
+
+        if ( result == EOK )
+        {
+            result = RenderBuffer( pTemplate,
+                                   hVarServer,
+                                   pSnap,
+                                   pBuffer,
+                                   pSplices,
+                                   true );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CTEMPLATE_Invalidate                                                      */
+/*!
+    Invalidate the cached text of a variable
+
+    The CTEMPLATE_Invalidate function discards the cached formatted text
+    of every reference to a variable, so it is formatted again by the
+    next cached render.
+
+    @param[in]
+        pTemplate
+            pointer to the compiled template object
+
+    @param[in]
+        hVar
+            handle of the variable which changed, or VAR_INVALID to
+            discard the cached text of every variable
+
+    @retval true the template references the variable
+    @retval false the template does not reference the variable
+
+==============================================================================*/
+bool CTEMPLATE_Invalidate( CompiledTemplate *pTemplate, VAR_HANDLE hVar )
+{
+    bool found = false;
+    CTElement *pElement;
+    size_t i;
+
+    for ( i = 0; ( pTemplate != NULL ) && ( i < pTemplate->nElements ); i++ )
+    {
+        pElement = &pTemplate->elements[i];
+        if ( ( pElement->isVar == true ) &&
+             ( ( hVar == VAR_INVALID ) || ( pElement->hVar == hVar ) ) )
+        {
+            pElement->cached = false;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+/*============================================================================*/
+/*  CTEMPLATE_RenderCBOR                                                      */
+/*!
+    Render a compiled template as CBOR
+
+    The CTEMPLATE_RenderCBOR function renders the values of the variables
+    referenced by the template, in template order, as a CBOR array.
+    The static text is not rendered: the template itself is the schema
+    which tells the receiver what each array element means.  Numeric
+    variables are encoded as CBOR integers or floats, strings as CBOR
+    text, and unresolved references as null.
+
+    References to the splice variables are not rendered.  Instead, the
+    writer offset of each reference is recorded so the caller can
+    insert a different encoded value at each splice point.
+
+    If a variable snapshot is supplied, the variables it holds a value
+    for are encoded from the snapshot rather than retrieved from the
+    variable server.
+
+    @param[in]
+        pTemplate
+            pointer to the compiled template object
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        pSnap
+            pointer to a snapshot of the variable values, or NULL to
+            retrieve every variable from the variable server
+
+    @param[in]
+        pWriter
+            pointer to the CBOR writer to render to
+
+    @param[in,out]
+        pSplices
+            pointer to the variables whose references are splice
+            points, which receives the writer offsets of the splice
+            points, or NULL to render all variables
+
+    @retval EOK the template was rendered
+    @retval ENOENT the template has not been compiled
+    @retval ENOSPC too many splice points
+    @retval E2BIG the rendering does not fit in the writer buffer
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int CTEMPLATE_RenderCBOR( CompiledTemplate *pTemplate,
+                          VARSERVER_HANDLE hVarServer,
+                          const VarSnapshot *pSnap,
+                          CborWriter *pWriter,
+                          CTSplices *pSplices )
+{
+    int result = EINVAL;
+    CTElement *pElement;
+    size_t field;
+    size_t i;
+
+    if ( ( pTemplate != NULL ) &&
+         ( pWriter != NULL ) )
+    {
+        if ( pSplices != NULL )
+        {
+            pSplices->nPoints = 0;
+        }
+
+        result = ENOENT;
+        if ( pTemplate->valid == true )
+        {
+            result = EOK;
+
+            CBOR_Array( pWriter, pTemplate->nVars );
+
+            for ( i = 0; ( i < pTemplate->nElements ) && ( result == EOK ); i++ )
+            {
+                pElement = &pTemplate->elements[i];
+                if ( pElement->isVar == false )
+                {
+                    continue;
+                }
+                else if ( pElement->hVar == VAR_INVALID )
+                {
+                    CBOR_Null( pWriter );
+                }
+                else if ( IsSplice( pSplices, pElement->hVar, &field ) )
+                {
+                    result = AddSplice( pSplices, field, pWriter->len );
+                }
+                else
+                {
+                    EncodeVar( hVarServer, pSnap, pElement->hVar, pWriter );
+                }
+            }
+
+            if ( result == EOK )
+            {
+                result = CBOR_Result( pWriter );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CTEMPLATE_GetStaticText                                                   */
+/*!
+    Get the static text of a compiled template
+
+    The CTEMPLATE_GetStaticText function concatenates all of the static
+    text spans of the compiled template, in template order, leaving out
+    the variable references.  This text is common to every rendering of
+    the template, so it makes a good compression dictionary.  The static
+    text is never longer than the template text (textLen).
+
+    @param[in]
+        pTemplate
+            pointer to the compiled template object
+
+    @param[out]
+        pBuf
+            pointer to the buffer to store the static text
+
+    @param[in]
+        size
+            size of the buffer
+
+    @retval number of bytes of static text stored in the buffer
+
+==============================================================================*/
+size_t CTEMPLATE_GetStaticText( CompiledTemplate *pTemplate,
+                                char *pBuf,
+                                size_t size )
+{
+    CTElement *pElement;
+    size_t len = 0;
+    size_t n;
+    size_t i;
+
+    if ( ( pTemplate != NULL ) &&
+         ( pTemplate->valid == true ) &&
+         ( pBuf != NULL ) )
+    {
+        for ( i = 0; ( i < pTemplate->nElements ) && ( len < size ); i++ )
+        {
+            pElement = &pTemplate->elements[i];
+            if ( pElement->isVar == false )
+            {
+                n = pElement->len;
+                if ( n > size - len )
+                {
+                    n = size - len;
+                }
+
+                memcpy( &pBuf[len], &pTemplate->text[pElement->offset], n );
+                len += n;
+            }
+        }
+    }
+
+    return len;
+}
+
+/*============================================================================*/
+/*  CTEMPLATE_References                                                      */
+/*!
+    Check if a compiled template references a variable
+
+    The CTEMPLATE_References function checks if any of the resolved
+    variable references of the compiled template refer to the
+    specified variable.
+
+    @param[in]
+        pTemplate
+            pointer to the compiled template object
+
+    @param[in]
+        hVar
+            handle of the variable to look for
+
+    @retval true the template references the variable
+    @retval false the template does not reference the variable
+
+==============================================================================*/
+bool CTEMPLATE_References( CompiledTemplate *pTemplate, VAR_HANDLE hVar )
+{
+    bool found = false;
+    size_t i;
+
+    if ( ( pTemplate != NULL ) &&
+         ( pTemplate->valid == true ) &&
+         ( hVar != VAR_INVALID ) )
+    {
+        for ( i = 0; ( i < pTemplate->nElements ) && ( found == false ); i++ )
+        {
+            found = ( pTemplate->elements[i].isVar == true ) &&
+                    ( pTemplate->elements[i].hVar == hVar );
+        }
+    }
+
+    return found;
+}
+
+/*============================================================================*/
+/*  CTEMPLATE_Subscribe                                                       */
+/*!
+    Request notifications for the variables referenced by a template
+
+    The CTEMPLATE_Subscribe function requests a NOTIFY_MODIFIED
+    notification for every resolved variable reference of the compiled
+    template which is not yet notified, other than references to the
+    excluded variables, and marks the references whose notification was
+    set up as notified.  References whose notification could not be set
+    up are tried again by the next call.
+
+    @param[in]
+        pTemplate
+            pointer to the compiled template object
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        pExclude
+            pointer to the handles of the variables which are not to be
+            notified, or NULL
+
+    @param[in]
+        nExclude
+            number of handles in pExclude
+
+    @retval EOK every reference which needs a notification is notified
+    @retval ENOENT the template has not been compiled
+    @retval EINVAL invalid arguments
+    @retval other error from VAR_Notify
+
+==============================================================================*/
+int CTEMPLATE_Subscribe( CompiledTemplate *pTemplate,
+                         VARSERVER_HANDLE hVarServer,
+                         const VAR_HANDLE *pExclude,
+                         size_t nExclude )
+{
+    int result = EINVAL;
+    CTElement *pElement;
+    bool excluded;
+    size_t i;
+    size_t j;
+    int rc;
+
+    if ( ( pTemplate != NULL ) &&
+         ( ( pExclude != NULL ) || ( nExclude == 0 ) ) )
+    {
+        result = ENOENT;
+        if ( pTemplate->valid == true )
+        {
+            result = EOK;
+
+            for ( i = 0; i < pTemplate->nElements; i++ )
+            {
+                pElement = &pTemplate->elements[i];
+                if ( ( pElement->isVar == false ) ||
+                     ( pElement->notified == true ) ||
+                     ( pElement->hVar == VAR_INVALID ) )
+                {
+                    continue;
+                }
+
+                excluded = false;
+                for ( j = 0; ( j < nExclude ) && ( excluded == false ); j++ )
+                {
+                    excluded = ( pElement->hVar == pExclude[j] );
+                }
+
+                if ( excluded == false )
+                {
+                    rc = VAR_Notify( hVarServer,
+                                     pElement->hVar,
+                                     NOTIFY_MODIFIED );
+                    pElement->notified = ( rc == EOK );
+                    if ( rc != EOK )
+                    {
+                        result = rc;
+                    }
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CTEMPLATE_Free                                                            */
+/*!
+    Free the resources used by a compiled template
+
+    The CTEMPLATE_Free function releases the template text and element
+    array and marks the template as not compiled.
+
+    @param[in]
+        pTemplate
+            pointer to the compiled template object
+
+==============================================================================*/
+void CTEMPLATE_Free( CompiledTemplate *pTemplate )
+{
+    if ( pTemplate != NULL )
+    {
+        free( pTemplate->text );
+        free( pTemplate->elements );
+        free( pTemplate->cache );
+        memset( pTemplate, 0, sizeof( CompiledTemplate ) );
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  ReadTemplate                                                              */
+/*!
+    Read the template file into memory
+
+    @param[in]
+        pTemplate
+            pointer to the compiled template object
+
+    @param[in]
+        fd
+            file descriptor of the template file
+
+    @param[in]
+        size
+            size of the template file
+
+    @retval EOK the template was read
+    @retval ENOMEM memory allocation failure
+    @retval other error from read
+
+==============================================================================*/
+static int ReadTemplate( CompiledTemplate *pTemplate, int fd, size_t size )
+{
+    int result = ENOMEM;
+    ssize_t n;
+    size_t total = 0;
+
+    pTemplate->text = malloc( size + 1 );
+    if ( pTemplate->text != NULL )
+    {
+        result = EOK;
+
+        while ( total < size )
+        {
+            n = read( fd, &pTemplate->text[total], size - total );
+            if ( n > 0 )
+            {
+                total += n;
+            }
+            else if ( ( n == -1 ) && ( errno == EINTR ) )
+            {
+                continue;
+            }
+            else
+            {
+                /* file was truncated or an error occurred */
+                result = ( n == 0 ) ? EOK : errno;
+                break;
+            }
+        }
+
+        pTemplate->text[total] = '\0';
+        pTemplate->textLen = total;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  Parse                                                                     */
+/*!
+    Parse the template text into elements
+
+    The Parse function splits the template text into static text spans
+    and ${varname} variable references.  An unterminated reference, or
+    a reference with an empty, over-long or nested name, is treated as
+    static text.
+
+    @param[in]
+        pTemplate
+            pointer to the compiled template object
+
+    @retval EOK the template was parsed
+    @retval ENOMEM memory allocation failure
+
+==============================================================================*/
+static int Parse( CompiledTemplate *pTemplate )
+{
+    int result = EOK;
+    size_t maxElements = 0;
+    size_t start = 0;
+    size_t i = 0;
+    char *text = pTemplate->text;
+    size_t len = pTemplate->textLen;
+    char *end;
+    size_t namelen;
+
+    while ( ( result == EOK ) && ( i + 1 < len ) )
+    {
+        if ( ( text[i] == '$' ) && ( text[i+1] == '{' ) )
+        {
+            end = memchr( &text[i+2], '}', len - ( i + 2 ) );
+            if ( end != NULL )
+            {
+                namelen = end - &text[i+2];
+                if ( ( namelen > 0 ) &&
+                     ( namelen <= CTEMPLATE_MAX_NAME_LEN ) &&
+                     ( memchr( &text[i+2], '{', namelen ) == NULL ) )
+                {
+                    if ( i > start )
+                    {
+                        result = AddElement( pTemplate,
+                                             &maxElements,
+                                             start,
+                                             i - start,
+                                             false );
+                    }
+
+                    if ( result == EOK )
+                    {
+                        result = AddElement( pTemplate,
+                                             &maxElements,
+                                             i + 2,
+                                             namelen,
+                                             true );
+                    }
+
+                    i += namelen + 3;
+                    start = i;
+                    continue;
+                }
+            }
+        }
+
+        i++;
+    }
+
+    if ( ( result == EOK ) && ( len > start ) )
+    {
+        result = AddElement( pTemplate,
+                             &maxElements,
+                             start,
+                             len - start,
+                             false );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  AddElement                                                                */
+/*!
+    Add an element to the compiled template
+
+    @param[in]
+        pTemplate
+            pointer to the compiled template object
+
+    @param[in,out]
+        pMaxElements
+            pointer to the current capacity of the element array
+
+    @param[in]
+        offset
+            offset of the element text in the template text
+
+    @param[in]
+        len
+            length of the element text
+
+    @param[in]
+        isVar
+            true if the element is a variable reference
+
+    @retval EOK the element was added
+    @retval ENOMEM memory allocation failure
+
+==============================================================================*/
+static int AddElement( CompiledTemplate *pTemplate,
+                       size_t *pMaxElements,
+                       size_t offset,
+                       size_t len,
+                       bool isVar )
+{
+    int result = EOK;
+    CTElement *p;
+    size_t n;
+
+    if ( pTemplate->nElements == *pMaxElements )
+    {
+        n = ( *pMaxElements == 0 ) ? 16 : *pMaxElements * 2;
+        p = realloc( pTemplate->elements, n * sizeof( CTElement ) );
+        if ( p != NULL )
+        {
+            pTemplate->elements = p;
+            *pMaxElements = n;
+        }
+        else
+        {
+            result = ENOMEM;
+        }
+    }
+
+    if ( result == EOK )
+    {
+        p = &pTemplate->elements[pTemplate->nElements++];
+        p->offset = offset;
+        p->len = len;
+        p->isVar = isVar;
+        p->hVar = VAR_INVALID;
+        p->slot = pTemplate->nVars;
+        p->cachedLen = 0;
+        p->cached = false;
+        p->notified = false;
+
+        if ( isVar == true )
+        {
+            pTemplate->nVars++;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  Resolve                                                                   */
+/*!
+    Resolve the template variable references
+
+    The Resolve function looks up the varserver handle for each
+    unresolved variable reference in the compiled template.
+
+    @param[in]
+        pTemplate
+            pointer to the compiled template object
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @retval number of variable references which were resolved
+
+==============================================================================*/
+static size_t Resolve( CompiledTemplate *pTemplate,
+                       VARSERVER_HANDLE hVarServer )
+{
+    char name[CTEMPLATE_MAX_NAME_LEN + 1];
+    CTElement *pElement;
+    size_t resolved = 0;
+    size_t i;
+
+    pTemplate->nUnresolved = 0;
+
+    for ( i = 0; i < pTemplate->nElements; i++ )
+    {
+        pElement = &pTemplate->elements[i];
+        if ( ( pElement->isVar == true ) &&
+             ( pElement->hVar == VAR_INVALID ) )
+        {
+            memcpy( name, &pTemplate->text[pElement->offset], pElement->len );
+            name[pElement->len] = '\0';
+
+            pElement->hVar = VAR_FindByName( hVarServer, name );
+            if ( pElement->hVar == VAR_INVALID )
+            {
+                pTemplate->nUnresolved++;
+            }
+            else
+            {
+                resolved++;
+            }
+        }
+    }
+
+    return resolved;
+}
+
+/*============================================================================*/
+/*  IsChanged                                                                 */
+/*!
+    Check if the template file has changed since it was compiled
+
+    @param[in]
+        pTemplate
+            pointer to the compiled template object
+
+    @param[in]
+        filename
+            name of the template file
+
+    @param[in]
+        pStat
+            pointer to the current status of the template file
+
+    @retval true the template needs to be re-compiled
+    @retval false the compiled template is up to date
+
+==============================================================================*/
+static bool IsChanged( CompiledTemplate *pTemplate,
+                       const char *filename,
+                       struct stat *pStat )
+{
+    return ( pTemplate->valid == false ) ||
+           ( strcmp( pTemplate->filename, filename ) != 0 ) ||
+           ( pTemplate->dev != pStat->st_dev ) ||
+           ( pTemplate->ino != pStat->st_ino ) ||
+           ( pTemplate->size != pStat->st_size ) ||
+           ( pTemplate->mtime.tv_sec != pStat->st_mtim.tv_sec ) ||
+           ( pTemplate->mtime.tv_nsec != pStat->st_mtim.tv_nsec );
+}
+
+/*============================================================================*/
+/*  Output                                                                    */
+/*!
+    Output a buffer to an output file descriptor
+
+    The Output function wraps the write() system call and performs
+    error checking.
+
+    @param[in]
+        fd
+            output file descriptor
+
+    @param[in]
+        buf
+            pointer to output buffer
+
+    @param[in]
+        len
+            number of bytes to write
+
+==============================================================================*/
+static void Output( int fd, char *buf, size_t len )
+{
+    int n;
+
+    if ( ( buf != NULL ) &&
+         ( fd != -1 ) &&
+         ( len > 0 ) )
+    {
+        n = write( fd, buf, len );
+        if ( (size_t)n != len )
+        {
+            fprintf( stderr, "write failed\n" );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  EncodeVar                                                                 */
+/*!
+    Encode the value of a variable as CBOR
+
+    The EncodeVar function gets the value of a variable, from the
+    snapshot if it holds one, and writes it as a CBOR data item of the
+    matching type.  Variables which cannot be read, or whose type has
+    no CBOR mapping, are written as null.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        pSnap
+            pointer to a snapshot of the variable values, or NULL
+
+    @param[in]
+        hVar
+            handle of the variable to encode
+
+    @param[in]
+        pWriter
+            pointer to the CBOR writer
+
+==============================================================================*/
+static void EncodeVar( VARSERVER_HANDLE hVarServer,
+                       const VarSnapshot *pSnap,
+                       VAR_HANDLE hVar,
+                       CborWriter *pWriter )
+{
+    char str[CTEMPLATE_MAX_STRING];
+    const VarObject *pObj;
+    VarObject obj;
+
+    pObj = VARSNAP_Get( pSnap, hVar );
+    if ( pObj != NULL )
+    {
+        EncodeObject( pObj, VARSNAP_STRING_LEN, pWriter );
+        return;
+    }
+
+    /* string values are copied into the supplied buffer */
+    memset( &obj, 0, sizeof( obj ) );
+    obj.val.str = str;
+    obj.len = sizeof( str );
+
+    if ( VAR_Get( hVarServer, hVar, &obj ) != EOK )
+    {
+        CBOR_Null( pWriter );
+        return;
+    }
+
+    EncodeObject( &obj, sizeof( str ), pWriter );
+}
+
+/*============================================================================*/
+/*  EncodeObject                                                              */
+/*!
+    Encode a variable value as CBOR
+
+    The EncodeObject function writes a variable value as a CBOR data
+    item of the matching type.  Values whose type has no CBOR mapping
+    are written as null.
+
+    @param[in]
+        pObj
+            pointer to the variable value
+
+    @param[in]
+        maxLen
+            size of the buffer holding a string value
+
+    @param[in]
+        pWriter
+            pointer to the CBOR writer
+
+==============================================================================*/
+static void EncodeObject( const VarObject *pObj,
+                          size_t maxLen,
+                          CborWriter *pWriter )
+{
+    switch( pObj->type )
+    {
+        case VARTYPE_UINT16:
+            CBOR_UInt( pWriter, pObj->val.ui );
+            break;
+
+        case VARTYPE_INT16:
+            CBOR_Int( pWriter, pObj->val.i );
+            break;
+
+        case VARTYPE_UINT32:
+            CBOR_UInt( pWriter, pObj->val.ul );
+            break;
+
+        case VARTYPE_INT32:
+            CBOR_Int( pWriter, pObj->val.l );
+            break;
+
+        case VARTYPE_UINT64:
+            CBOR_UInt( pWriter, pObj->val.ull );
+            break;
+
+        case VARTYPE_INT64:
+            CBOR_Int( pWriter, pObj->val.ll );
+            break;
+
+        case VARTYPE_FLOAT:
+            CBOR_Float( pWriter, pObj->val.f );
+            break;
+
+        case VARTYPE_STR:
+            CBOR_Text( pWriter, pObj->val.str, strnlen( pObj->val.str, maxLen ) );
+            break;
+
+        default:
+            CBOR_Null( pWriter );
+            break;
+    }
+}
+
+/*============================================================================*/
+/*  RenderBuffer                                                              */
+/*!
+    Render a compiled template into an in-process buffer
+
+    The RenderBuffer function implements CTEMPLATE_RenderBuffer and
+    CTEMPLATE_RenderCached.
+
+    @param[in]
+        pTemplate
+            pointer to the compiled template object
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        pSnap
+            pointer to a snapshot of the variable values, or NULL
+
+    @param[in,out]
+        pBuffer
+            pointer to the buffer to render into
+
+    @param[in,out]
+        pSplices
+            pointer to the variables whose references are splice
+            points, which receives the buffer offsets of the splice
+            points, or NULL to render all variables
+
+    @param[in]
+        useCache
+            true to reuse and update the formatted text cache
+
+    @retval EOK the template was rendered
+    @retval ENOENT the template has not been compiled
+    @retval ENOSPC too many splice points
+    @retval E2BIG the rendering does not fit in the buffer
+    @retval EBADF a variable must be printed but there is no print stream
+    @retval EIO unable to get the print stream offset
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int RenderBuffer( CompiledTemplate *pTemplate,
+                         VARSERVER_HANDLE hVarServer,
+                         const VarSnapshot *pSnap,
+                         CTBuffer *pBuffer,
+                         CTSplices *pSplices,
+                         bool useCache )
+{
+    int result = EINVAL;
+    CTElement *pElement;
+    size_t field;
+    bool printed = false;
+    size_t start;
+    size_t i;
+
+    if ( ( pTemplate != NULL ) &&
+         ( pBuffer != NULL ) &&
+         ( pBuffer->pBuf != NULL ) )
+    {
+        pBuffer->len = 0;
+        pBuffer->fdOffset = -1;
+
+        if ( pSplices != NULL )
+        {
+            pSplices->nPoints = 0;
+        }
+
+        result = ENOENT;
+        if ( pTemplate->valid == true )
+        {
+            result = EOK;
+
+            for ( i = 0; ( i < pTemplate->nElements ) && ( result == EOK ); i++ )
+            {
+                pElement = &pTemplate->elements[i];
+                if ( pElement->isVar == false )
+                {
+                    result = Append( pBuffer,
+                                     &pTemplate->text[pElement->offset],
+                                     pElement->len );
+                }
+                else if ( pElement->hVar == VAR_INVALID )
+                {
+                    /* unresolved references render as empty text */
+                    continue;
+                }
+                else if ( IsSplice( pSplices, pElement->hVar, &field ) )
+                {
+                    result = AddSplice( pSplices, field, pBuffer->len );
+                }
+                else if ( ( useCache == true ) &&
+                          ( pElement->cached == true ) )
+                {
+                    /* reuse the text formatted by an earlier render */
+                    result = Append( pBuffer,
+                                     &pTemplate->cache[pElement->slot *
+                                                       CTEMPLATE_SLOT_SIZE],
+                                     pElement->cachedLen );
+                    pTemplate->reused++;
+                }
+                else
+                {
+                    start = pBuffer->len;
+                    result = RenderVar( hVarServer,
+                                        pSnap,
+                                        pElement->hVar,
+                                        pBuffer,
+                                        &printed );
+                    if ( ( useCache == true ) &&
+                         ( result == EOK ) &&
+                         ( printed == false ) &&
+                         ( pElement->notified == true ) )
+                    {
+                        CacheVar( pTemplate,
+                                  pElement,
+                                  &pBuffer->pBuf[start],
+                                  pBuffer->len - start );
+                    }
+                }
+            }
+
+            if ( pBuffer->len < pBuffer->size )
+            {
+                pBuffer->pBuf[pBuffer->len] = '\0';
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  IsSplice                                                                  */
+/*!
+    Check if a variable is a splice variable
+
+    @param[in]
+        pSplices
+            pointer to the splice variables, or NULL
+
+    @param[in]
+        hVar
+            handle of the referenced variable
+
+    @param[out]
+        pField
+            pointer to a location to store the index of the variable
+            in the splice variables
+
+    @retval true the variable references are splice points
+    @retval false the variable is rendered
+
+==============================================================================*/
+static bool IsSplice( const CTSplices *pSplices,
+                      VAR_HANDLE hVar,
+                      size_t *pField )
+{
+    size_t i;
+
+    for ( i = 0;
+          ( pSplices != NULL ) &&
+          ( i < pSplices->nVars ) &&
+          ( i < CTEMPLATE_MAX_SPLICE_VARS );
+          i++ )
+    {
+        if ( ( pSplices->hVars[i] != VAR_INVALID ) &&
+             ( pSplices->hVars[i] == hVar ) )
+        {
+            *pField = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*============================================================================*/
+/*  AddSplice                                                                 */
+/*!
+    Record a splice point
+
+    @param[in,out]
+        pSplices
+            pointer to the splice variables
+
+    @param[in]
+        field
+            index of the spliced variable
+
+    @param[in]
+        offset
+            output offset of the splice point
+
+    @retval EOK the splice point was recorded
+    @retval ENOSPC too many splice points
+
+==============================================================================*/
+static int AddSplice( CTSplices *pSplices, size_t field, size_t offset )
+{
+    int result = ENOSPC;
+
+    if ( pSplices->nPoints < CTEMPLATE_MAX_SPLICES )
+    {
+        pSplices->points[pSplices->nPoints].offset = offset;
+        pSplices->points[pSplices->nPoints].field = field;
+        pSplices->nPoints++;
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RenderVar                                                                 */
+/*!
+    Render the value of a variable into a render buffer
+
+    The RenderVar function formats the value of a variable from the
+    snapshot if it holds one, and otherwise has the variable server
+    print it.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        pSnap
+            pointer to a snapshot of the variable values, or NULL
+
+    @param[in]
+        hVar
+            handle of the variable to render
+
+    @param[in]
+        pBuffer
+            pointer to the render buffer
+
+    @param[out]
+        pPrinted
+            pointer to a location to store whether the variable was
+            printed by the variable server
+
+    @retval EOK the variable was rendered
+    @retval other error from Append or PrintVar
+
+==============================================================================*/
+static int RenderVar( VARSERVER_HANDLE hVarServer,
+                      const VarSnapshot *pSnap,
+                      VAR_HANDLE hVar,
+                      CTBuffer *pBuffer,
+                      bool *pPrinted )
+{
+    int result;
+    const VarObject *pObj;
+    char buf[CTEMPLATE_MAX_STRING];
+    size_t len;
+
+    pObj = VARSNAP_Get( pSnap, hVar );
+    if ( pObj != NULL )
+    {
+        /* format the value from the snapshot */
+        len = VARSNAP_Format( pObj, buf, sizeof( buf ) );
+        result = Append( pBuffer, buf, len );
+        *pPrinted = false;
+    }
+    else
+    {
+        result = PrintVar( hVarServer, hVar, pBuffer );
+        *pPrinted = true;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CacheVar                                                                  */
+/*!
+    Store the formatted text of a variable reference in the cache
+
+    The CacheVar function keeps the text just rendered for a variable
+    reference so later cached renders can reuse it.  Text which does
+    not fit in a cache slot is not kept.
+
+    @param[in]
+        pTemplate
+            pointer to the compiled template object
+
+    @param[in]
+        pElement
+            pointer to the variable reference element
+
+    @param[in]
+        text
+            pointer to the formatted text
+
+    @param[in]
+        len
+            length of the formatted text
+
+==============================================================================*/
+static void CacheVar( CompiledTemplate *pTemplate,
+                      CTElement *pElement,
+                      const char *text,
+                      size_t len )
+{
+    pTemplate->formatted++;
+
+    if ( ( pTemplate->cache != NULL ) &&
+         ( len <= CTEMPLATE_SLOT_SIZE ) )
+    {
+        memcpy( &pTemplate->cache[pElement->slot * CTEMPLATE_SLOT_SIZE],
+                text,
+                len );
+        pElement->cachedLen = len;
+        pElement->cached = true;
+    }
+}
+
+/*============================================================================*/
+/*  Append                                                                    */
+/*!
+    Append text to a render buffer
+
+    @param[in]
+        pBuffer
+            pointer to the render buffer
+
+    @param[in]
+        buf
+            pointer to the text to append
+
+    @param[in]
+        len
+            length of the text to append
+
+    @retval EOK the text was appended
+    @retval E2BIG the text does not fit in the buffer
+
+==============================================================================*/
+static int Append( CTBuffer *pBuffer, const char *buf, size_t len )
+{
+    int result = E2BIG;
+
+    if ( len <= pBuffer->size - pBuffer->len )
+    {
+        memcpy( &pBuffer->pBuf[pBuffer->len], buf, len );
+        pBuffer->len += len;
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  PrintVar                                                                  */
+/*!
+    Print a variable into a render buffer using the variable server
+
+    The PrintVar function asks the variable server to print a variable
+    into the render buffer's print stream, and copies the printed text
+    into the render buffer.  The print stream is only rewound when it
+    is first used during a render, or when it is full, so each variable
+    costs one lseek() in addition to the print request.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        hVar
+            handle of the variable to print
+
+    @param[in]
+        pBuffer
+            pointer to the render buffer
+
+    @retval EOK the variable was printed
+    @retval EBADF there is no print stream
+    @retval EIO unable to position the print stream
+    @retval E2BIG the printed text does not fit in the buffer
+
+==============================================================================*/
+static int PrintVar( VARSERVER_HANDLE hVarServer,
+                     VAR_HANDLE hVar,
+                     CTBuffer *pBuffer )
+{
+    int result = EBADF;
+    off_t end;
+
+    if ( ( pBuffer->fd != -1 ) &&
+         ( pBuffer->pFdData != NULL ) )
+    {
+        result = EOK;
+
+        if ( ( pBuffer->fdOffset < 0 ) ||
+             ( (size_t)pBuffer->fdOffset >= pBuffer->fdSize ) )
+        {
+            pBuffer->fdOffset = lseek( pBuffer->fd, 0, SEEK_SET );
+            result = ( pBuffer->fdOffset == 0 ) ? EOK : EIO;
+        }
+
+        if ( result == EOK )
+        {
+            (void)VAR_Print( hVarServer, hVar, pBuffer->fd );
+
+            end = lseek( pBuffer->fd, 0, SEEK_CUR );
+            if ( end < pBuffer->fdOffset )
+            {
+                pBuffer->fdOffset = -1;
+                result = EIO;
+            }
+            else if ( (size_t)end > pBuffer->fdSize )
+            {
+                /* the text ran past the end of the print stream */
+                pBuffer->fdOffset = -1;
+                result = E2BIG;
+            }
+            else
+            {
+                result = Append( pBuffer,
+                                 &pBuffer->pFdData[pBuffer->fdOffset],
+                                 (size_t)( end - pBuffer->fdOffset ) );
+                pBuffer->fdOffset = end;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*! @}
+ * end of ctemplate group */
@@ -0,0 +1,287 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup hash Payload Hash
+ * @brief Fast 64-bit hash of rendered payloads
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file hash.c
+
+    Payload Hash
+
+    The hash component calculates a fast 64-bit hash of a payload so
+    that successive payloads can be compared without keeping a copy of
+    them.  It implements the XXH64 algorithm, which processes the input
+    eight bytes at a time.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <string.h>
+#include "hash.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! XXH64 prime constants */
+#define PRIME64_1 ( 11400714785074694791ULL )
+#define PRIME64_2 ( 14029467366897019727ULL )
+#define PRIME64_3 ( 1609587929392839161ULL )
+#define PRIME64_4 ( 9650029242287828579ULL )
+#define PRIME64_5 ( 2870177450012600261ULL )
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static uint64_t Rotl( uint64_t x, int r );
+static uint64_t Round( uint64_t acc, uint64_t input );
+static uint64_t MergeRound( uint64_t acc, uint64_t val );
+static uint64_t Read64( const unsigned char *p );
+static uint32_t Read32( const unsigned char *p );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  HASH_Compute                                                              */
+/*!
+    Calculate the 64-bit hash of a payload
+
+    The HASH_Compute function calculates the XXH64 hash (seed 0) of
+    the specified data.  The data is read in native byte order, so
+    hashes are only comparable on the host which calculated them.
+
+    @param[in]
+        pData
+            pointer to the data to hash
+
+    @param[in]
+        len
+            length of the data
+
+    @retval the 64-bit hash of the data
+
+==============================================================================*/
+uint64_t HASH_Compute( const void *pData, size_t len )
+{
+    const unsigned char *p = (const unsigned char *)pData;
+    const unsigned char *pEnd = p + len;
+    uint64_t v1;
+    uint64_t v2;
+    uint64_t v3;
+    uint64_t v4;
+    uint64_t h;
+
+    if ( len >= 32 )
+    {
+        v1 = PRIME64_1 + PRIME64_2;
+        v2 = PRIME64_2;
+        v3 = 0;
+        v4 = -PRIME64_1;
+
+        /* consume the input in 32 byte stripes */
+        do
+        {
+            v1 = Round( v1, Read64( p ) );
+            v2 = Round( v2, Read64( p + 8 ) );
+            v3 = Round( v3, Read64( p + 16 ) );
+            v4 = Round( v4, Read64( p + 24 ) );
+            p += 32;
+        } while ( pEnd - p >= 32 );
+
+        h = Rotl( v1, 1 ) + Rotl( v2, 7 ) + Rotl( v3, 12 ) + Rotl( v4, 18 );
+        h = MergeRound( h, v1 );
+        h = MergeRound( h, v2 );
+        h = MergeRound( h, v3 );
+        h = MergeRound( h, v4 );
+    }
+    else
+    {
+        h = PRIME64_5;
+    }
+
+    h += (uint64_t)len;
+
+    /* consume the remaining input */
+    while ( pEnd - p >= 8 )
+    {
+        h ^= Round( 0, Read64( p ) );
+        h = Rotl( h, 27 ) * PRIME64_1 + PRIME64_4;
+        p += 8;
+    }
+
+    if ( pEnd - p >= 4 )
+    {
+        h ^= (uint64_t)Read32( p ) * PRIME64_1;
+        h = Rotl( h, 23 ) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+
+    while ( p < pEnd )
+    {
+        h ^= (uint64_t)(*p) * PRIME64_5;
+        h = Rotl( h, 11 ) * PRIME64_1;
+        p++;
+    }
+
+    /* final avalanche */
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    h ^= h >> 32;
+
+    return h;
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  Rotl                                                                      */
+/*!
+    Rotate a 64-bit value left
+
+    @param[in]
+        x
+            value to rotate
+
+    @param[in]
+        r
+            number of bits to rotate by (1 to 63)
+
+    @retval the rotated value
+
+==============================================================================*/
+static uint64_t Rotl( uint64_t x, int r )
+{
+    return ( x << r ) | ( x >> ( 64 - r ) );
+}
+
+/*============================================================================*/
+/*  Round                                                                     */
+/*!
+    Mix eight bytes of input into an accumulator
+
+    @param[in]
+        acc
+            accumulator
+
+    @param[in]
+        input
+            eight bytes of input
+
+    @retval the updated accumulator
+
+==============================================================================*/
+static uint64_t Round( uint64_t acc, uint64_t input )
+{
+    acc += input * PRIME64_2;
+    acc = Rotl( acc, 31 );
+    acc *= PRIME64_1;
+
+    return acc;
+}
+
+/*============================================================================*/
+/*  MergeRound                                                                */
+/*!
+    Merge a stripe accumulator into the hash
+
+    @param[in]
+        acc
+            hash value
+
+    @param[in]
+        val
+            stripe accumulator
+
+    @retval the updated hash value
+
+==============================================================================*/
+static uint64_t MergeRound( uint64_t acc, uint64_t val )
+{
+    acc ^= Round( 0, val );
+    acc = acc * PRIME64_1 + PRIME64_4;
+
+    return acc;
+}
+
+/*============================================================================*/
+/*  Read64                                                                    */
+/*!
+    Read an unaligned 64-bit value
+
+    @param[in]
+        p
+            pointer to the value
+
+    @retval the value read
+
+==============================================================================*/
+static uint64_t Read64( const unsigned char *p )
+{
+    uint64_t val;
+
+    memcpy( &val, p, sizeof( val ) );
+
+    return val;
+}
+
+/*============================================================================*/
+/*  Read32                                                                    */
+/*!
+    Read an unaligned 32-bit value
+
+    @param[in]
+        p
+            pointer to the value
+
+    @retval the value read
+
+==============================================================================*/
+static uint32_t Read32( const unsigned char *p )
+{
+    uint32_t val;
+
+    memcpy( &val, p, sizeof( val ) );
+
+    return val;
+}
+
+/*! @}
+ * end of hash group */
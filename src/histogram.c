@@ -0,0 +1,176 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup histogram Latency Histogram
+ * @brief Fixed-bucket latency histograms
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file histogram.c
+
+    Latency Histogram
+
+    The histogram component records latency samples into a fixed set
+    of power-of-two microsecond buckets.  Recording a sample does not
+    allocate memory or make any system calls, so it is safe to use on
+    the transmission path.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include "histogram.h"
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  HISTOGRAM_Record                                                          */
+/*!
+    Record a latency sample
+
+    The HISTOGRAM_Record function adds a latency sample to the histogram.
+    The histogram must have been zero initialized before the first sample
+    is recorded.
+
+    @param[in]
+        pHistogram
+            pointer to the histogram
+
+    @param[in]
+        ns
+            latency sample in nanoseconds
+
+==============================================================================*/
+void HISTOGRAM_Record( Histogram *pHistogram, uint64_t ns )
+{
+    uint64_t us;
+    size_t idx = 0;
+
+    if ( pHistogram != NULL )
+    {
+        /* find the power-of-two microsecond bucket */
+        for ( us = ns / 1000ULL; us > 0; us >>= 1 )
+        {
+            idx++;
+        }
+
+        if ( idx >= HISTOGRAM_BUCKETS )
+        {
+            idx = HISTOGRAM_BUCKETS - 1;
+        }
+
+        pHistogram->buckets[idx]++;
+
+        if ( ( pHistogram->count == 0 ) ||
+             ( ns < pHistogram->min_ns ) )
+        {
+            pHistogram->min_ns = ns;
+        }
+
+        if ( ns > pHistogram->max_ns )
+        {
+            pHistogram->max_ns = ns;
+        }
+
+        pHistogram->count++;
+        pHistogram->sum_ns += ns;
+    }
+}
+
+/*============================================================================*/
+/*  HISTOGRAM_Dump                                                            */
+/*!
+    Dump a histogram to the output file descriptor
+
+    The HISTOGRAM_Dump function writes the histogram to the output file
+    descriptor as a JSON object.  The "buckets" array holds the sample
+    counts, and the "le_us" array holds the upper bound of each bucket
+    in microseconds.
+
+    @param[in]
+        pHistogram
+            pointer to the histogram
+
+    @param[in]
+        fd
+            output file descriptor
+
+==============================================================================*/
+void HISTOGRAM_Dump( Histogram *pHistogram, int fd )
+{
+    size_t i;
+    size_t last = 0;
+
+    if ( pHistogram != NULL )
+    {
+        /* only the buckets up to the last non-empty one are written */
+        for ( i = 0; i < HISTOGRAM_BUCKETS; i++ )
+        {
+            if ( pHistogram->buckets[i] != 0 )
+            {
+                last = i + 1;
+            }
+        }
+
+        dprintf( fd,
+                 "{\"count\": %u, \"min_us\": %llu, \"max_us\": %llu, "
+                 "\"mean_us\": %llu, \"le_us\": [",
+                 pHistogram->count,
+                 (unsigned long long)( pHistogram->min_ns / 1000ULL ),
+                 (unsigned long long)( pHistogram->max_ns / 1000ULL ),
+                 (unsigned long long)( ( pHistogram->count > 0 )
+                    ? pHistogram->sum_ns / pHistogram->count / 1000ULL
+                    : 0 ) );
+
+        for ( i = 0; i < last; i++ )
+        {
+            dprintf( fd, "%s%llu", ( i > 0 ) ? ", " : "", 1ULL << i );
+        }
+
+        dprintf( fd, "], \"buckets\": [" );
+
+        for ( i = 0; i < last; i++ )
+        {
+            dprintf( fd,
+                     "%s%u",
+                     ( i > 0 ) ? ", " : "",
+                     pHistogram->buckets[i] );
+        }
+
+        dprintf( fd, "]}" );
+    }
+}
+
+/*! @}
+ * end of histogram group */
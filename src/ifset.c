@@ -0,0 +1,492 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup ifset Interface Set
+ * @brief Compiled interface allow-list
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file ifset.c
+
+    Interface Set
+
+    The ifset component compiles a channel's interface allow-list into
+    a set of interface indexes, so checking whether a payload may be
+    sent on an interface is a bitmap lookup rather than a scan of the
+    list text.  The list is a comma or white space separated set of
+    interface names, which may contain fnmatch(3) wildcards such as
+    eth* or vlan1*, and may be excluded with a '!' prefix, for example
+    !docker*.
+
+    The list is parsed once when it changes, and the bitmap is rebuilt
+    from the interface table whenever the interface table changes.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fnmatch.h>
+#include <varserver/varserver.h>
+#include "ifset.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! separators between interface list entries */
+#define IFSET_SEPARATORS ", \t\r\n"
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static int AddIndex( IfSet *pSet, int ifindex );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  IFSET_Parse                                                               */
+/*!
+    Parse an interface allow-list
+
+    The IFSET_Parse function replaces the patterns of the interface set
+    with the ones in the specification, a comma or white space separated
+    list of interface names which may contain wildcards, and may be
+    prefixed with '!' to exclude the matching interfaces.  An interface
+    is allowed if it matches an inclusion pattern, or there are no
+    inclusion patterns, and it does not match an exclusion pattern.  An
+    empty list allows every interface.
+
+    The set must be resolved against the interface table before it is
+    next checked.
+
+    Entries which are too long are reported, and the list is rejected.
+    A rejected list leaves the previous list of the set in place, or
+    if there is none, denies every interface until a valid list is
+    parsed.
+
+    @param[in]
+        pSet
+            pointer to the interface set
+
+    @param[in]
+        spec
+            interface list specification
+
+    @retval EOK the interface list was parsed
+    @retval E2BIG one or more entries were empty or too long
+    @retval ENOMEM memory allocation failed
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int IFSET_Parse( IfSet *pSet, const char *spec )
+{
+    int result = EINVAL;
+    IfPattern *pPattern;
+    IfSet parsed;
+    char *saveptr = NULL;
+    char *pText;
+    char *token;
+    size_t n = 0;
+    size_t i;
+
+    if ( ( pSet != NULL ) &&
+         ( spec != NULL ) )
+    {
+        /* parse into a new set, so a rejected list keeps the old one */
+        memset( &parsed, 0, sizeof( parsed ) );
+
+        /* make a mutable copy of the list */
+        pText = strdup( spec );
+        result = ( pText != NULL ) ? EOK : ENOMEM;
+
+        /* the list has at most one entry per separator */
+        for ( i = 0; ( result == EOK ) && ( spec[i] != '\0' ); i++ )
+        {
+            n += ( strchr( IFSET_SEPARATORS, spec[i] ) != NULL ) ? 1 : 0;
+        }
+
+        if ( ( result == EOK ) && ( i > 0 ) )
+        {
+            parsed.patterns = calloc( n + 1, sizeof( IfPattern ) );
+            result = ( parsed.patterns != NULL ) ? EOK : ENOMEM;
+        }
+
+        token = ( parsed.patterns != NULL )
+                ? strtok_r( pText, IFSET_SEPARATORS, &saveptr )
+                : NULL;
+
+        while ( token != NULL )
+        {
+            pPattern = &parsed.patterns[parsed.nPatterns];
+            pPattern->exclude = ( token[0] == '!' );
+            if ( pPattern->exclude == true )
+            {
+                token++;
+            }
+
+            if ( ( token[0] == '\0' ) ||
+                 ( strlen( token ) >= sizeof( pPattern->pattern ) ) )
+            {
+                fprintf( stderr, "invalid interface: %s\n", token );
+                result = E2BIG;
+            }
+            else
+            {
+                strcpy( pPattern->pattern, token );
+                parsed.nIncludes += ( pPattern->exclude == false ) ? 1 : 0;
+                parsed.nPatterns++;
+            }
+
+            token = strtok_r( NULL, IFSET_SEPARATORS, &saveptr );
+        }
+
+        free( pText );
+
+        if ( result == EOK )
+        {
+            /* replace the patterns of the set */
+            free( pSet->patterns );
+            pSet->patterns = parsed.patterns;
+            pSet->nPatterns = parsed.nPatterns;
+            pSet->nIncludes = parsed.nIncludes;
+            pSet->valid = true;
+            pSet->denyAll = false;
+            pSet->resolved = false;
+        }
+        else
+        {
+            free( parsed.patterns );
+
+            if ( pSet->valid == false )
+            {
+                /* there is no list to fall back to */
+                pSet->denyAll = true;
+                pSet->resolved = false;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  IFSET_Match                                                               */
+/*!
+    Check an interface name against an interface allow-list
+
+    The IFSET_Match function checks an interface name against the
+    patterns of the interface set.  It is used to build the bitmap of
+    allowed interfaces, rather than on every transmission.  No
+    interface matches a set whose only list was rejected.
+
+    @param[in]
+        pSet
+            pointer to the interface set
+
+    @param[in]
+        ifname
+            name of the interface to check
+
+    @retval true the interface is allowed
+    @retval false the interface is not allowed
+
+==============================================================================*/
+bool IFSET_Match( IfSet *pSet, const char *ifname )
+{
+    bool included = false;
+    bool excluded = true;
+    IfPattern *pPattern;
+    size_t i;
+
+    if ( ( pSet != NULL ) &&
+         ( ifname != NULL ) &&
+         ( pSet->denyAll == false ) )
+    {
+        included = ( pSet->nIncludes == 0 );
+        excluded = false;
+    }
+
+    for ( i = 0; ( excluded == false ) && ( i < pSet->nPatterns ); i++ )
+    {
+        pPattern = &pSet->patterns[i];
+        if ( fnmatch( pPattern->pattern, ifname, 0 ) == 0 )
+        {
+            if ( pPattern->exclude == true )
+            {
+                excluded = true;
+            }
+            else
+            {
+                included = true;
+            }
+        }
+    }
+
+    return ( included == true ) && ( excluded == false );
+}
+
+/*============================================================================*/
+/*  IFSET_Resolve                                                             */
+/*!
+    Build the bitmap of allowed interfaces
+
+    The IFSET_Resolve function builds the bitmap of allowed interface
+    indexes by matching every link and interface address in the
+    interface table against the patterns of the interface set.  The
+    bitmap is only rebuilt if the set has been parsed or the interface
+    table has changed since it was last built, so it may be called
+    before every transmission.
+
+    @param[in]
+        pSet
+            pointer to the interface set
+
+    @param[in]
+        pTable
+            pointer to the interface table
+
+    @retval EOK the bitmap is up to date
+    @retval ENOMEM memory allocation failed
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int IFSET_Resolve( IfSet *pSet, IfTable *pTable )
+{
+    int result = EINVAL;
+    size_t i;
+
+    if ( ( pSet != NULL ) &&
+         ( pTable != NULL ) )
+    {
+        result = EOK;
+
+        if ( ( pSet->resolved == false ) ||
+             ( pSet->generation != pTable->generation ) )
+        {
+            if ( pSet->bits != NULL )
+            {
+                memset( pSet->bits, 0, pSet->nWords * sizeof( uint64_t ) );
+            }
+
+            for ( i = 0; i < pTable->nLinks; i++ )
+            {
+                if ( IFSET_Match( pSet, pTable->links[i].ifname ) &&
+                     ( AddIndex( pSet, pTable->links[i].ifindex ) != EOK ) )
+                {
+                    result = ENOMEM;
+                }
+            }
+
+            /* the address entries carry their interface name, in case
+               the link table is full */
+            for ( i = 0; i < pTable->n; i++ )
+            {
+                if ( IFSET_Match( pSet, pTable->entries[i].ifname ) &&
+                     ( AddIndex( pSet, pTable->entries[i].ifindex ) != EOK ) )
+                {
+                    result = ENOMEM;
+                }
+            }
+
+            pSet->generation = pTable->generation;
+            pSet->resolved = ( result == EOK );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  IFSET_Contains                                                            */
+/*!
+    Check if an interface is in the allow-list
+
+    The IFSET_Contains function checks the bitmap built by IFSET_Resolve
+    to see if payloads may be sent on the specified interface.
+
+    @param[in]
+        pSet
+            pointer to the interface set
+
+    @param[in]
+        ifindex
+            index of the interface to check
+
+    @retval true the interface is allowed
+    @retval false the interface is not allowed
+
+==============================================================================*/
+bool IFSET_Contains( IfSet *pSet, int ifindex )
+{
+    bool contains = false;
+    size_t word;
+
+    if ( ( pSet != NULL ) &&
+         ( ifindex >= 0 ) )
+    {
+        word = (size_t)ifindex / 64;
+
+        contains = ( word < pSet->nWords ) &&
+                   ( ( pSet->bits[word] &
+                       ( 1ULL << ( ifindex % 64 ) ) ) != 0 );
+    }
+
+    return contains;
+}
+
+/*============================================================================*/
+/*  IFSET_Reserve                                                             */
+/*!
+    Reserve space in the bitmap of an interface set
+
+    The IFSET_Reserve function grows the bitmap of allowed interfaces to
+    hold every interface index up to the specified maximum, so the set
+    can be resolved without allocating memory.
+
+    @param[in]
+        pSet
+            pointer to the interface set
+
+    @param[in]
+        maxIndex
+            largest interface index to reserve space for
+
+    @retval EOK the space was reserved
+    @retval ENOMEM memory allocation failed
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int IFSET_Reserve( IfSet *pSet, int maxIndex )
+{
+    int result = EINVAL;
+    size_t nWords;
+    uint64_t *bits;
+
+    if ( ( pSet != NULL ) &&
+         ( maxIndex >= 0 ) )
+    {
+        result = EOK;
+
+        nWords = (size_t)maxIndex / 64 + 1;
+        if ( nWords > pSet->nWords )
+        {
+            bits = realloc( pSet->bits, nWords * sizeof( uint64_t ) );
+            if ( bits == NULL )
+            {
+                result = ENOMEM;
+            }
+            else
+            {
+                memset( &bits[pSet->nWords],
+                        0,
+                        ( nWords - pSet->nWords ) * sizeof( uint64_t ) );
+                pSet->bits = bits;
+                pSet->nWords = nWords;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  IFSET_Free                                                                */
+/*!
+    Free an interface set
+
+    The IFSET_Free function releases the memory used by the interface
+    set, leaving it empty so that it allows every interface once
+    resolved again.
+
+    @param[in]
+        pSet
+            pointer to the interface set
+
+==============================================================================*/
+void IFSET_Free( IfSet *pSet )
+{
+    if ( pSet != NULL )
+    {
+        free( pSet->patterns );
+        free( pSet->bits );
+        memset( pSet, 0, sizeof( IfSet ) );
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  AddIndex                                                                  */
+/*!
+    Add an interface index to the bitmap
+
+    The AddIndex function sets the bit of an interface index in the
+    bitmap of allowed interfaces, growing the bitmap if required.
+
+    @param[in]
+        pSet
+            pointer to the interface set
+
+    @param[in]
+        ifindex
+            index of the allowed interface
+
+    @retval EOK the interface index was added
+    @retval ENOMEM memory allocation failed
+    @retval EINVAL invalid interface index
+
+==============================================================================*/
+static int AddIndex( IfSet *pSet, int ifindex )
+{
+    size_t word;
+    int result;
+
+    result = IFSET_Reserve( pSet, ifindex );
+    if ( result == EOK )
+    {
+        word = (size_t)ifindex / 64;
+        pSet->bits[word] |= ( 1ULL << ( ifindex % 64 ) );
+    }
+
+    return result;
+}
+
+/*! @}
+ * end of ifset group */
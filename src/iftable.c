@@ -0,0 +1,984 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup iftable Network Interface Table
+ * @brief In-process table of network interface addresses
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file iftable.c
+
+    Network Interface Table
+
+    The iftable component maintains a compact array of the network
+    interface addresses on the system.  The table is populated once via
+    an RTNETLINK dump at startup, and is then kept current by processing
+    the RTM_NEWLINK, RTM_DELLINK, RTM_NEWADDR and RTM_DELADDR
+    notifications which the kernel sends on the netlink socket.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <net/if.h>
+#include <netdb.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_addr.h>
+#include <varserver/varserver.h>
+#include "iftable.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+#ifndef IFTABLE_BUFSIZE
+/*! size of the netlink receive buffer */
+#define IFTABLE_BUFSIZE ( 16384 )
+#endif
+
+#ifndef IFTABLE_DUMP_TIMEOUT_MS
+/*! maximum time to wait for a netlink dump response */
+#define IFTABLE_DUMP_TIMEOUT_MS ( 1000 )
+#endif
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static int Dump( IfTable *pTable );
+static int RequestDump( IfTable *pTable, int type, int family );
+static int ReadDump( IfTable *pTable, uint32_t seq );
+static int ParseMessages( IfTable *pTable,
+                          char *buf,
+                          size_t len,
+                          uint32_t seq,
+                          bool *pDone );
+static void HandleLink( IfTable *pTable, struct nlmsghdr *nlh );
+static void HandleDelLink( IfTable *pTable, struct nlmsghdr *nlh );
+static void HandleAddr( IfTable *pTable, struct nlmsghdr *nlh );
+static IfLink *FindLink( IfTable *pTable, int ifindex );
+static IfEntry *FindEntry( IfTable *pTable,
+                           int ifindex,
+                           int family,
+                           const void *addr );
+static bool SetAddr( struct sockaddr_storage *pAddr,
+                     int family,
+                     int ifindex,
+                     const void *data,
+                     size_t len );
+static void RemoveEntry( IfTable *pTable, size_t idx );
+static void SetHost( IfEntry *pEntry );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  IFTABLE_Init                                                              */
+/*!
+    Initialize the interface table
+
+    The IFTABLE_Init function opens a netlink socket subscribed to the
+    link and address change notifications, and populates the interface
+    table with the current network links and addresses.
+
+    @param[in]
+        pTable
+            pointer to the interface table to initialize
+
+    @retval EOK the interface table was initialized
+    @retval EINVAL invalid arguments
+    @retval other error from socket, bind, or the netlink dump
+
+==============================================================================*/
+int IFTABLE_Init( IfTable *pTable )
+{
+    int result = EINVAL;
+    struct sockaddr_nl sa;
+
+    if ( pTable != NULL )
+    {
+        memset( pTable, 0, sizeof( IfTable ) );
+
+        pTable->fd = socket( AF_NETLINK,
+                             SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK,
+                             NETLINK_ROUTE );
+        if ( pTable->fd != -1 )
+        {
+            memset( &sa, 0, sizeof( sa ) );
+            sa.nl_family = AF_NETLINK;
+            sa.nl_groups = RTMGRP_LINK |
+                           RTMGRP_IPV4_IFADDR |
+                           RTMGRP_IPV6_IFADDR;
+
+            if ( bind( pTable->fd, (struct sockaddr *)&sa, sizeof(sa) ) == 0 )
+            {
+                result = Dump( pTable );
+            }
+            else
+            {
+                result = errno;
+            }
+
+            if ( result != EOK )
+            {
+                close( pTable->fd );
+                pTable->fd = -1;
+            }
+        }
+        else
+        {
+            result = errno;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  IFTABLE_GetFd                                                             */
+/*!
+    Get the interface table notification file descriptor
+
+    The IFTABLE_GetFd function gets the netlink socket file descriptor
+    which becomes readable when interface changes are pending.
+
+    @param[in]
+        pTable
+            pointer to the interface table
+
+    @retval file descriptor of the netlink socket
+    @retval -1 the interface table is not initialized
+
+==============================================================================*/
+int IFTABLE_GetFd( IfTable *pTable )
+{
+    return ( pTable != NULL ) ? pTable->fd : -1;
+}
+
+/*============================================================================*/
+/*  IFTABLE_Process                                                           */
+/*!
+    Process pending interface change notifications
+
+    The IFTABLE_Process function drains all pending netlink notifications
+    from the netlink socket and applies them to the interface table.
+    It does not block.  If the kernel reports that notifications were
+    lost, the whole table is re-synchronized with a netlink dump.
+
+    @param[in]
+        pTable
+            pointer to the interface table
+
+    @retval EOK the pending notifications were processed
+    @retval EINVAL invalid arguments
+    @retval other error from recv or the netlink dump
+
+==============================================================================*/
+int IFTABLE_Process( IfTable *pTable )
+{
+    int result = EINVAL;
+    char buf[IFTABLE_BUFSIZE] __attribute__ ((aligned(__alignof__(struct nlmsghdr))));
+    ssize_t n = 0;
+    bool done = false;
+
+    if ( ( pTable != NULL ) &&
+         ( pTable->fd != -1 ) )
+    {
+        result = EOK;
+
+        while ( ( pTable->resync == false ) &&
+                ( ( n = recv( pTable->fd, buf, sizeof(buf), 0 ) ) > 0 ) )
+        {
+            (void)ParseMessages( pTable, buf, (size_t)n, 0, &done );
+        }
+
+        if ( ( pTable->resync == false ) &&
+             ( n == -1 ) &&
+             ( errno == ENOBUFS ) )
+        {
+            /* the kernel dropped notifications */
+            pTable->resync = true;
+        }
+
+        if ( pTable->resync == true )
+        {
+            result = Dump( pTable );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  IFTABLE_Close                                                             */
+/*!
+    Close the interface table
+
+    The IFTABLE_Close function closes the netlink socket and clears
+    the interface table.
+
+    @param[in]
+        pTable
+            pointer to the interface table
+
+==============================================================================*/
+void IFTABLE_Close( IfTable *pTable )
+{
+    if ( pTable != NULL )
+    {
+        if ( pTable->fd != -1 )
+        {
+            close( pTable->fd );
+        }
+
+        memset( pTable, 0, sizeof( IfTable ) );
+        pTable->fd = -1;
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  Dump                                                                      */
+/*!
+    Re-populate the interface table
+
+    The Dump function clears the interface table and re-populates it
+    by requesting a dump of all links, followed by a dump of all
+    addresses from the kernel.
+
+    @param[in]
+        pTable
+            pointer to the interface table
+
+    @retval EOK the interface table was populated
+    @retval other error from the netlink request or response
+
+==============================================================================*/
+static int Dump( IfTable *pTable )
+{
+    int result;
+
+    pTable->nLinks = 0;
+    pTable->n = 0;
+    pTable->resync = false;
+    pTable->generation++;
+
+    result = RequestDump( pTable, RTM_GETLINK, AF_UNSPEC );
+    if ( result == EOK )
+    {
+        result = ReadDump( pTable, pTable->seq );
+    }
+
+    if ( result == EOK )
+    {
+        result = RequestDump( pTable, RTM_GETADDR, AF_UNSPEC );
+        if ( result == EOK )
+        {
+            result = ReadDump( pTable, pTable->seq );
+        }
+    }
+
+    if ( result != EOK )
+    {
+        /* try again on the next call to IFTABLE_Process */
+        pTable->resync = true;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RequestDump                                                               */
+/*!
+    Send a netlink dump request
+
+    The RequestDump function sends a netlink dump request of the specified
+    type to the kernel.
+
+    @param[in]
+        pTable
+            pointer to the interface table
+
+    @param[in]
+        type
+            netlink request type (RTM_GETLINK or RTM_GETADDR)
+
+    @param[in]
+        family
+            address family to dump
+
+    @retval EOK the dump request was sent
+    @retval other error from send
+
+==============================================================================*/
+static int RequestDump( IfTable *pTable, int type, int family )
+{
+    struct
+    {
+        struct nlmsghdr nlh;
+        struct rtgenmsg gen;
+    } req;
+    int result = EOK;
+
+    memset( &req, 0, sizeof( req ) );
+    req.nlh.nlmsg_len = NLMSG_LENGTH( sizeof( struct rtgenmsg ) );
+    req.nlh.nlmsg_type = type;
+    req.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    req.nlh.nlmsg_seq = ++pTable->seq;
+    req.gen.rtgen_family = family;
+
+    if ( send( pTable->fd, &req, req.nlh.nlmsg_len, 0 ) == -1 )
+    {
+        result = errno;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ReadDump                                                                  */
+/*!
+    Read a netlink dump response
+
+    The ReadDump function reads and processes netlink messages until
+    the end of the dump response with the specified sequence number
+    is received.  Change notifications which arrive interleaved with
+    the dump response are processed as well.
+
+    @param[in]
+        pTable
+            pointer to the interface table
+
+    @param[in]
+        seq
+            sequence number of the dump request
+
+    @retval EOK the dump response was processed
+    @retval ETIMEDOUT the dump response was not received in time
+    @retval other error from poll or recv
+
+==============================================================================*/
+static int ReadDump( IfTable *pTable, uint32_t seq )
+{
+    int result = EOK;
+    char buf[IFTABLE_BUFSIZE] __attribute__ ((aligned(__alignof__(struct nlmsghdr))));
+    struct pollfd pfd;
+    bool done = false;
+    ssize_t n;
+    int rc;
+
+    pfd.fd = pTable->fd;
+    pfd.events = POLLIN;
+
+    while ( ( done == false ) && ( result == EOK ) )
+    {
+        n = recv( pTable->fd, buf, sizeof(buf), 0 );
+        if ( n > 0 )
+        {
+            result = ParseMessages( pTable, buf, (size_t)n, seq, &done );
+        }
+        else if ( ( n == -1 ) && ( errno == EAGAIN ) )
+        {
+            rc = poll( &pfd, 1, IFTABLE_DUMP_TIMEOUT_MS );
+            if ( rc == 0 )
+            {
+                result = ETIMEDOUT;
+            }
+            else if ( ( rc == -1 ) && ( errno != EINTR ) )
+            {
+                result = errno;
+            }
+        }
+        else if ( ( n == -1 ) && ( errno == EINTR ) )
+        {
+            continue;
+        }
+        else
+        {
+            result = ( n == 0 ) ? EIO : errno;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseMessages                                                             */
+/*!
+    Parse a buffer of netlink messages
+
+    The ParseMessages function walks a buffer of received netlink
+    messages and applies each link and address message to the table.
+
+    @param[in]
+        pTable
+            pointer to the interface table
+
+    @param[in]
+        buf
+            pointer to the received netlink data
+
+    @param[in]
+        len
+            number of bytes of netlink data
+
+    @param[in]
+        seq
+            sequence number of an outstanding dump request, or 0
+
+    @param[out]
+        pDone
+            set to true when the end of the dump response is found
+
+    @retval EOK the messages were parsed
+    @retval other error reported by the kernel
+
+==============================================================================*/
+static int ParseMessages( IfTable *pTable,
+                          char *buf,
+                          size_t len,
+                          uint32_t seq,
+                          bool *pDone )
+{
+    int result = EOK;
+    struct nlmsghdr *nlh;
+    struct nlmsgerr *err;
+    int msglen = (int)len;
+
+    for ( nlh = (struct nlmsghdr *)buf;
+          NLMSG_OK( nlh, msglen );
+          nlh = NLMSG_NEXT( nlh, msglen ) )
+    {
+        switch( nlh->nlmsg_type )
+        {
+            case NLMSG_DONE:
+                if ( ( seq != 0 ) && ( nlh->nlmsg_seq == seq ) )
+                {
+                    *pDone = true;
+                }
+                break;
+
+            case NLMSG_ERROR:
+                err = (struct nlmsgerr *)NLMSG_DATA( nlh );
+                if ( ( seq != 0 ) && ( nlh->nlmsg_seq == seq ) )
+                {
+                    result = ( err->error != 0 ) ? -err->error : EOK;
+                    *pDone = true;
+                }
+                break;
+
+            case RTM_NEWLINK:
+                HandleLink( pTable, nlh );
+                break;
+
+            case RTM_DELLINK:
+                HandleDelLink( pTable, nlh );
+                break;
+
+            case RTM_NEWADDR:
+            case RTM_DELADDR:
+                HandleAddr( pTable, nlh );
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  HandleLink                                                                */
+/*!
+    Handle an RTM_NEWLINK message
+
+    The HandleLink function adds or updates a network link in the table,
+    and propagates name, state and MTU changes to the link's addresses.
+
+    @param[in]
+        pTable
+            pointer to the interface table
+
+    @param[in]
+        nlh
+            pointer to the RTM_NEWLINK message
+
+==============================================================================*/
+static void HandleLink( IfTable *pTable, struct nlmsghdr *nlh )
+{
+    struct ifinfomsg *ifi = (struct ifinfomsg *)NLMSG_DATA( nlh );
+    struct rtattr *rta;
+    int rtalen = IFLA_PAYLOAD( nlh );
+    const char *name = NULL;
+    unsigned int mtu = 0;
+    IfLink *pLink;
+    size_t i;
+
+    for ( rta = IFLA_RTA( ifi ); RTA_OK( rta, rtalen ); rta = RTA_NEXT( rta, rtalen ) )
+    {
+        if ( rta->rta_type == IFLA_IFNAME )
+        {
+            name = (const char *)RTA_DATA( rta );
+        }
+        else if ( ( rta->rta_type == IFLA_MTU ) &&
+                  ( RTA_PAYLOAD( rta ) >= sizeof( uint32_t ) ) )
+        {
+            mtu = *(const uint32_t *)RTA_DATA( rta );
+        }
+    }
+
+    pLink = FindLink( pTable, ifi->ifi_index );
+    if ( ( pLink == NULL ) &&
+         ( pTable->nLinks < IFTABLE_MAX_LINKS ) )
+    {
+        pLink = &pTable->links[pTable->nLinks++];
+        memset( pLink, 0, sizeof( IfLink ) );
+        pLink->ifindex = ifi->ifi_index;
+    }
+
+    if ( pLink != NULL )
+    {
+        pLink->flags = ifi->ifi_flags;
+        if ( mtu != 0 )
+        {
+            pLink->mtu = mtu;
+        }
+
+        if ( name != NULL )
+        {
+            snprintf( pLink->ifname, sizeof( pLink->ifname ), "%s", name );
+        }
+
+        /* propagate the link state to its addresses */
+        for ( i = 0; i < pTable->n; i++ )
+        {
+            if ( pTable->entries[i].ifindex == pLink->ifindex )
+            {
+                pTable->entries[i].up = ( pLink->flags & IFF_UP ) ? true : false;
+                pTable->entries[i].mtu = pLink->mtu;
+                memcpy( pTable->entries[i].ifname,
+                        pLink->ifname,
+                        sizeof( pLink->ifname ) );
+            }
+        }
+
+        pTable->generation++;
+    }
+}
+
+/*============================================================================*/
+/*  HandleDelLink                                                             */
+/*!
+    Handle an RTM_DELLINK message
+
+    The HandleDelLink function removes a network link and all of its
+    addresses from the table.
+
+    @param[in]
+        pTable
+            pointer to the interface table
+
+    @param[in]
+        nlh
+            pointer to the RTM_DELLINK message
+
+==============================================================================*/
+static void HandleDelLink( IfTable *pTable, struct nlmsghdr *nlh )
+{
+    struct ifinfomsg *ifi = (struct ifinfomsg *)NLMSG_DATA( nlh );
+    IfLink *pLink;
+    size_t i = 0;
+
+    pLink = FindLink( pTable, ifi->ifi_index );
+    if ( pLink != NULL )
+    {
+        *pLink = pTable->links[--pTable->nLinks];
+    }
+
+    while ( i < pTable->n )
+    {
+        if ( pTable->entries[i].ifindex == ifi->ifi_index )
+        {
+            RemoveEntry( pTable, i );
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    pTable->generation++;
+}
+
+/*============================================================================*/
+/*  HandleAddr                                                                */
+/*!
+    Handle an RTM_NEWADDR or RTM_DELADDR message
+
+    The HandleAddr function adds, updates, or removes an interface
+    address in the table.
+
+    @param[in]
+        pTable
+            pointer to the interface table
+
+    @param[in]
+        nlh
+            pointer to the RTM_NEWADDR or RTM_DELADDR message
+
+==============================================================================*/
+static void HandleAddr( IfTable *pTable, struct nlmsghdr *nlh )
+{
+    struct ifaddrmsg *ifa = (struct ifaddrmsg *)NLMSG_DATA( nlh );
+    struct rtattr *rta;
+    int rtalen = IFA_PAYLOAD( nlh );
+    struct rtattr *pAddress = NULL;
+    struct rtattr *pLocal = NULL;
+    struct rtattr *pBroadcast = NULL;
+    struct rtattr *pAddr;
+    IfEntry *pEntry;
+    IfLink *pLink;
+
+    if ( ( ifa->ifa_family != AF_INET ) &&
+         ( ifa->ifa_family != AF_INET6 ) )
+    {
+        return;
+    }
+
+    for ( rta = IFA_RTA( ifa ); RTA_OK( rta, rtalen ); rta = RTA_NEXT( rta, rtalen ) )
+    {
+        switch( rta->rta_type )
+        {
+            case IFA_ADDRESS:   pAddress = rta;     break;
+            case IFA_LOCAL:     pLocal = rta;       break;
+            case IFA_BROADCAST: pBroadcast = rta;   break;
+            default:                                break;
+        }
+    }
+
+    /* IFA_LOCAL is the local address on point-to-point links */
+    pAddr = ( pLocal != NULL ) ? pLocal : pAddress;
+    if ( pAddr == NULL )
+    {
+        return;
+    }
+
+    pEntry = FindEntry( pTable,
+                        ifa->ifa_index,
+                        ifa->ifa_family,
+                        RTA_DATA( pAddr ) );
+
+    if ( nlh->nlmsg_type == RTM_DELADDR )
+    {
+        if ( pEntry != NULL )
+        {
+            RemoveEntry( pTable, (size_t)( pEntry - pTable->entries ) );
+            pTable->generation++;
+        }
+
+        return;
+    }
+
+    if ( ( pEntry == NULL ) &&
+         ( pTable->n < IFTABLE_MAX_ADDRS ) )
+    {
+        pEntry = &pTable->entries[pTable->n++];
+        memset( pEntry, 0, sizeof( IfEntry ) );
+        pEntry->ifindex = ifa->ifa_index;
+        pEntry->family = ifa->ifa_family;
+        (void)SetAddr( &pEntry->addr,
+                       ifa->ifa_family,
+                       ifa->ifa_index,
+                       RTA_DATA( pAddr ),
+                       RTA_PAYLOAD( pAddr ) );
+    }
+
+    if ( pEntry != NULL )
+    {
+        pEntry->hasBroadcast = ( pBroadcast != NULL ) &&
+                               SetAddr( &pEntry->broadaddr,
+                                        ifa->ifa_family,
+                                        ifa->ifa_index,
+                                        RTA_DATA( pBroadcast ),
+                                        RTA_PAYLOAD( pBroadcast ) );
+
+        pLink = FindLink( pTable, ifa->ifa_index );
+        if ( pLink != NULL )
+        {
+            pEntry->up = ( pLink->flags & IFF_UP ) ? true : false;
+            pEntry->mtu = pLink->mtu;
+            memcpy( pEntry->ifname, pLink->ifname, sizeof( pLink->ifname ) );
+        }
+        else if ( if_indextoname( ifa->ifa_index, pEntry->ifname ) != NULL )
+        {
+            pEntry->up = true;
+        }
+
+        SetHost( pEntry );
+
+        pTable->generation++;
+    }
+}
+
+/*============================================================================*/
+/*  FindLink                                                                  */
+/*!
+    Find a network link by interface index
+
+    @param[in]
+        pTable
+            pointer to the interface table
+
+    @param[in]
+        ifindex
+            interface index to search for
+
+    @retval pointer to the network link
+    @retval NULL the link was not found
+
+==============================================================================*/
+static IfLink *FindLink( IfTable *pTable, int ifindex )
+{
+    size_t i;
+
+    for ( i = 0; i < pTable->nLinks; i++ )
+    {
+        if ( pTable->links[i].ifindex == ifindex )
+        {
+            return &pTable->links[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*============================================================================*/
+/*  FindEntry                                                                 */
+/*!
+    Find an interface address entry
+
+    @param[in]
+        pTable
+            pointer to the interface table
+
+    @param[in]
+        ifindex
+            interface index of the address
+
+    @param[in]
+        family
+            address family
+
+    @param[in]
+        addr
+            pointer to the raw address (struct in_addr or struct in6_addr)
+
+    @retval pointer to the interface address entry
+    @retval NULL the address was not found
+
+==============================================================================*/
+static IfEntry *FindEntry( IfTable *pTable,
+                           int ifindex,
+                           int family,
+                           const void *addr )
+{
+    IfEntry *pEntry;
+    const void *p;
+    size_t len;
+    size_t i;
+
+    for ( i = 0; i < pTable->n; i++ )
+    {
+        pEntry = &pTable->entries[i];
+        if ( ( pEntry->ifindex == ifindex ) &&
+             ( pEntry->family == family ) )
+        {
+            if ( family == AF_INET )
+            {
+                p = &((struct sockaddr_in *)&pEntry->addr)->sin_addr;
+                len = sizeof( struct in_addr );
+            }
+            else
+            {
+                p = &((struct sockaddr_in6 *)&pEntry->addr)->sin6_addr;
+                len = sizeof( struct in6_addr );
+            }
+
+            if ( memcmp( p, addr, len ) == 0 )
+            {
+                return pEntry;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/*============================================================================*/
+/*  SetAddr                                                                   */
+/*!
+    Populate a socket address from a netlink address attribute
+
+    @param[out]
+        pAddr
+            pointer to the socket address to populate
+
+    @param[in]
+        family
+            address family
+
+    @param[in]
+        ifindex
+            interface index (used as the IPv6 scope identifier)
+
+    @param[in]
+        data
+            pointer to the raw address data
+
+    @param[in]
+        len
+            length of the raw address data
+
+    @retval true the address was populated
+    @retval false the address data is invalid
+
+==============================================================================*/
+static bool SetAddr( struct sockaddr_storage *pAddr,
+                     int family,
+                     int ifindex,
+                     const void *data,
+                     size_t len )
+{
+    struct sockaddr_in *pAddr4 = (struct sockaddr_in *)pAddr;
+    struct sockaddr_in6 *pAddr6 = (struct sockaddr_in6 *)pAddr;
+    bool result = false;
+
+    memset( pAddr, 0, sizeof( struct sockaddr_storage ) );
+
+    if ( ( family == AF_INET ) &&
+         ( len >= sizeof( struct in_addr ) ) )
+    {
+        pAddr4->sin_family = AF_INET;
+        memcpy( &pAddr4->sin_addr, data, sizeof( struct in_addr ) );
+        result = true;
+    }
+    else if ( ( family == AF_INET6 ) &&
+              ( len >= sizeof( struct in6_addr ) ) )
+    {
+        pAddr6->sin6_family = AF_INET6;
+        memcpy( &pAddr6->sin6_addr, data, sizeof( struct in6_addr ) );
+        if ( IN6_IS_ADDR_LINKLOCAL( &pAddr6->sin6_addr ) )
+        {
+            pAddr6->sin6_scope_id = ifindex;
+        }
+        result = true;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RemoveEntry                                                               */
+/*!
+    Remove an interface address entry
+
+    The RemoveEntry function removes the entry at the specified index by
+    moving the last entry of the table into its slot.
+
+    @param[in]
+        pTable
+            pointer to the interface table
+
+    @param[in]
+        idx
+            index of the entry to remove
+
+==============================================================================*/
+static void RemoveEntry( IfTable *pTable, size_t idx )
+{
+    if ( idx < pTable->n )
+    {
+        pTable->n--;
+        if ( idx != pTable->n )
+        {
+            pTable->entries[idx] = pTable->entries[pTable->n];
+        }
+    }
+}
+
+/*============================================================================*/
+/*  SetHost                                                                   */
+/*!
+    Format the numeric local address of an interface address entry
+
+    The SetHost function formats the local address of an interface
+    address entry as a numeric string, including the scope of IPv6
+    link-local addresses, so it does not have to be formatted for
+    every transmission.
+
+    @param[in]
+        pEntry
+            pointer to the interface address entry
+
+==============================================================================*/
+static void SetHost( IfEntry *pEntry )
+{
+    socklen_t len = ( pEntry->family == AF_INET )
+                    ? sizeof( struct sockaddr_in )
+                    : sizeof( struct sockaddr_in6 );
+
+    if ( getnameinfo( (struct sockaddr *)&pEntry->addr,
+                      len,
+                      pEntry->host,
+                      sizeof( pEntry->host ),
+                      NULL,
+                      0,
+                      NI_NUMERICHOST ) != 0 )
+    {
+        pEntry->host[0] = '\0';
+    }
+}
+
+/*! @}
+ * end of iftable group */
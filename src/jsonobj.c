@@ -0,0 +1,856 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup jsonobj JSON Object Parser
+ * @brief Parser for flat JSON objects of scalar values
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file jsonobj.c
+
+    JSON Object Parser
+
+    The jsonobj component parses the flat JSON objects which udpt
+    templates usually render: an object of names and scalar values,
+    without nested objects or arrays.  The member names and string
+    values are decoded, including their escape sequences, into an arena
+    owned by the parser, so parsing an object does not allocate memory.
+    Numbers are checked against the JSON number syntax and passed on
+    as text, leaving their conversion to the caller.
+
+    The members are only made available once the whole object has been
+    parsed, so a malformed or truncated object yields no members at all.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <varserver/varserver.h>
+#include "jsonobj.h"
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static int ParseString( const char *pBuf,
+                        size_t len,
+                        size_t *pPos,
+                        char *pOut,
+                        size_t outSize,
+                        size_t *pOutLen );
+static int ParseEscape( const char *pBuf,
+                        size_t len,
+                        size_t *pPos,
+                        char *pOut,
+                        size_t *pOutLen );
+static int ParseNumber( const char *pBuf, size_t len, size_t *pPos );
+static size_t SkipDigits( const char *pBuf, size_t len, size_t *pPos );
+static int ParseHex4( const char *pBuf, size_t len, size_t pos, uint32_t *pVal );
+static size_t PutUTF8( char *pOut, uint32_t cp );
+static void SkipSpace( const char *pBuf, size_t len, size_t *pPos );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  JSONOBJ_Init                                                              */
+/*!
+    Set up a JSON object parser
+
+    The JSONOBJ_Init function allocates the member table and the arena
+    of a JSON object parser.  A decoded string is never longer than its
+    encoding, so the arena holds every string of the longest object,
+    plus room for the last string to be decoded.
+
+    @param[in]
+        pObject
+            pointer to the JSON object parser
+
+    @param[in]
+        maxLen
+            maximum length of the objects to be parsed
+
+    @retval EOK the parser was set up
+    @retval ENOMEM memory allocation failed
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int JSONOBJ_Init( JsonObject *pObject, size_t maxLen )
+{
+    int result = EINVAL;
+
+    if ( pObject != NULL )
+    {
+        memset( pObject, 0, sizeof( JsonObject ) );
+        pObject->arenaSize = maxLen + JSONOBJ_VALUE_SIZE;
+        pObject->maxLen = maxLen;
+        pObject->pMembers = calloc( JSONOBJ_MAX_MEMBERS, sizeof( JsonMember ) );
+        pObject->pArena = malloc( pObject->arenaSize );
+        if ( ( pObject->pMembers != NULL ) &&
+             ( pObject->pArena != NULL ) )
+        {
+            result = EOK;
+        }
+        else
+        {
+            JSONOBJ_Free( pObject );
+            result = ENOMEM;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  JSONOBJ_Parse                                                             */
+/*!
+    Parse a flat JSON object
+
+    The JSONOBJ_Parse function parses a JSON object of names and scalar
+    values.  On success the members are stored in pObject->pMembers and
+    their number in pObject->n, and remain valid until the next call to
+    JSONOBJ_Parse or JSONOBJ_Free.  Number values point into pBuf, which
+    must remain valid while they are used.  On failure pObject->n is 0.
+
+    @param[in]
+        pObject
+            pointer to the JSON object parser
+
+    @param[in]
+        pBuf
+            pointer to the JSON text
+
+    @param[in]
+        len
+            length of the JSON text
+
+    @retval EOK the object was parsed
+    @retval EBADMSG the text is not a flat JSON object, or a number
+            value is not a valid JSON number
+    @retval E2BIG the object is longer than the parser's maximum length,
+            has more than JSONOBJ_MAX_MEMBERS members, or a name or
+            value is too long
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int JSONOBJ_Parse( JsonObject *pObject, const char *pBuf, size_t len )
+{
+    int result = EINVAL;
+    char *pArena = NULL;
+    JsonMember *pMember;
+    CborItem *pItem;
+    size_t used = 0;
+    size_t avail;
+    size_t n = 0;
+    size_t start;
+    size_t pos = 0;
+    bool done = false;
+
+    if ( ( pObject != NULL ) &&
+         ( pObject->pMembers != NULL ) &&
+         ( pObject->pArena != NULL ) &&
+         ( pBuf != NULL ) )
+    {
+        pObject->n = 0;
+        pArena = pObject->pArena;
+
+        result = ( len > pObject->maxLen ) ? E2BIG : EOK;
+    }
+
+    if ( result == EOK )
+    {
+        SkipSpace( pBuf, len, &pos );
+        if ( ( pos >= len ) || ( pBuf[pos++] != '{' ) )
+        {
+            result = EBADMSG;
+        }
+        else
+        {
+            SkipSpace( pBuf, len, &pos );
+            if ( ( pos < len ) && ( pBuf[pos] == '}' ) )
+            {
+                /* empty object */
+                pos++;
+                done = true;
+            }
+        }
+    }
+
+    while ( ( result == EOK ) && ( done == false ) )
+    {
+        if ( n >= JSONOBJ_MAX_MEMBERS )
+        {
+            result = E2BIG;
+        }
+        else
+        {
+            pMember = &pObject->pMembers[n];
+            pItem = &pMember->item;
+
+            avail = pObject->arenaSize - used;
+            result = ParseString( pBuf,
+                                  len,
+                                  &pos,
+                                  &pArena[used],
+                                  ( avail < MAX_NAME_LEN + 1 )
+                                      ? avail
+                                      : MAX_NAME_LEN + 1,
+                                  &pMember->nameLen );
+        }
+
+        if ( result == EOK )
+        {
+            pMember->name = &pArena[used];
+            used += pMember->nameLen + 1;
+
+            SkipSpace( pBuf, len, &pos );
+            if ( ( pos >= len ) || ( pBuf[pos++] != ':' ) )
+            {
+                result = EBADMSG;
+            }
+            else
+            {
+                SkipSpace( pBuf, len, &pos );
+                if ( pos >= len )
+                {
+                    result = EBADMSG;
+                }
+            }
+        }
+
+        if ( result == EOK )
+        {
+            memset( pItem, 0, sizeof( CborItem ) );
+            pItem->type = CBOR_TYPE_TEXT;
+
+            if ( pBuf[pos] == '"' )
+            {
+                avail = pObject->arenaSize - used;
+                result = ParseString( pBuf,
+                                      len,
+                                      &pos,
+                                      &pArena[used],
+                                      ( avail < JSONOBJ_VALUE_SIZE )
+                                          ? avail
+                                          : JSONOBJ_VALUE_SIZE,
+                                      &pItem->len );
+                pItem->pText = &pArena[used];
+                used += pItem->len + 1;
+            }
+            else if ( ( len - pos >= 4 ) &&
+                      ( memcmp( &pBuf[pos], "true", 4 ) == 0 ) )
+            {
+                pItem->pText = "1";
+                pItem->len = 1;
+                pos += 4;
+            }
+            else if ( ( len - pos >= 5 ) &&
+                      ( memcmp( &pBuf[pos], "false", 5 ) == 0 ) )
+            {
+                pItem->pText = "0";
+                pItem->len = 1;
+                pos += 5;
+            }
+            else if ( ( len - pos >= 4 ) &&
+                      ( memcmp( &pBuf[pos], "null", 4 ) == 0 ) )
+            {
+                pItem->type = CBOR_TYPE_NULL;
+                pos += 4;
+            }
+            else
+            {
+                /* numbers are passed on as text and converted by the
+                   caller */
+                start = pos;
+                result = ParseNumber( pBuf, len, &pos );
+                pItem->pText = &pBuf[start];
+                pItem->len = pos - start;
+            }
+        }
+
+        if ( result == EOK )
+        {
+            n++;
+
+            SkipSpace( pBuf, len, &pos );
+            if ( pos >= len )
+            {
+                result = EBADMSG;
+            }
+            else if ( pBuf[pos] == ',' )
+            {
+                pos++;
+                SkipSpace( pBuf, len, &pos );
+            }
+            else if ( pBuf[pos] == '}' )
+            {
+                pos++;
+                done = true;
+            }
+            else
+            {
+                result = EBADMSG;
+            }
+        }
+    }
+
+    if ( result == EOK )
+    {
+        SkipSpace( pBuf, len, &pos );
+        if ( pos != len )
+        {
+            result = EBADMSG;
+        }
+        else
+        {
+            /* the whole object is valid, so publish its members */
+            pObject->n = n;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  JSONOBJ_Free                                                              */
+/*!
+    Free the resources used by a JSON object parser
+
+    @param[in]
+        pObject
+            pointer to the JSON object parser
+
+==============================================================================*/
+void JSONOBJ_Free( JsonObject *pObject )
+{
+    if ( pObject != NULL )
+    {
+        free( pObject->pMembers );
+        free( pObject->pArena );
+        memset( pObject, 0, sizeof( JsonObject ) );
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  ParseString                                                               */
+/*!
+    Parse a JSON string
+
+    The ParseString function decodes a JSON string, including its
+    escape sequences, into a NUL terminated buffer.
+
+    @param[in]
+        pBuf
+            pointer to the JSON text
+
+    @param[in]
+        len
+            length of the JSON text
+
+    @param[in,out]
+        pPos
+            position of the opening quote, updated to the position
+            following the closing quote
+
+    @param[out]
+        pOut
+            pointer to the output buffer
+
+    @param[in]
+        outSize
+            size of the output buffer
+
+    @param[out]
+        pOutLen
+            pointer to a location to store the decoded length
+
+    @retval EOK the string was parsed
+    @retval E2BIG the string does not fit in the output buffer
+    @retval EBADMSG the string is malformed
+
+==============================================================================*/
+static int ParseString( const char *pBuf,
+                        size_t len,
+                        size_t *pPos,
+                        char *pOut,
+                        size_t outSize,
+                        size_t *pOutLen )
+{
+    int result = EOK;
+    size_t pos = *pPos;
+    size_t n = 0;
+    char c;
+
+    if ( ( pos >= len ) || ( pBuf[pos++] != '"' ) )
+    {
+        result = EBADMSG;
+    }
+
+    while ( ( result == EOK ) && ( pos < len ) && ( pBuf[pos] != '"' ) )
+    {
+        /* leave room for the longest UTF-8 sequence and the NUL */
+        if ( n + 5 > outSize )
+        {
+            result = E2BIG;
+        }
+        else
+        {
+            c = pBuf[pos++];
+            if ( c != '\\' )
+            {
+                pOut[n++] = c;
+            }
+            else
+            {
+                result = ParseEscape( pBuf, len, &pos, &pOut[n], &n );
+            }
+        }
+    }
+
+    if ( ( result == EOK ) && ( pos >= len ) )
+    {
+        /* the closing quote is missing */
+        result = EBADMSG;
+    }
+
+    if ( result == EOK )
+    {
+        pOut[n] = '\0';
+        *pOutLen = n;
+        *pPos = pos + 1;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseEscape                                                               */
+/*!
+    Decode a JSON escape sequence
+
+    The ParseEscape function decodes the escape sequence following a
+    backslash in a JSON string, combining a unicode escape with a
+    following low surrogate escape into one code point.
+
+    @param[in]
+        pBuf
+            pointer to the JSON text
+
+    @param[in]
+        len
+            length of the JSON text
+
+    @param[in,out]
+        pPos
+            position following the backslash, updated to the position
+            following the escape sequence
+
+    @param[out]
+        pOut
+            pointer to a buffer with room for at least 4 bytes
+
+    @param[in,out]
+        pOutLen
+            pointer to the decoded length, which is increased by the
+            number of bytes written
+
+    @retval EOK the escape sequence was decoded
+    @retval EBADMSG the escape sequence is malformed
+
+==============================================================================*/
+static int ParseEscape( const char *pBuf,
+                        size_t len,
+                        size_t *pPos,
+                        char *pOut,
+                        size_t *pOutLen )
+{
+    int result = EOK;
+    size_t pos = *pPos;
+    size_t n = 0;
+    uint32_t cp;
+    uint32_t low;
+    char c = '\0';
+
+    if ( pos >= len )
+    {
+        result = EBADMSG;
+    }
+    else
+    {
+        c = pBuf[pos++];
+    }
+
+    if ( result == EOK )
+    {
+        switch( c )
+        {
+            case '"':
+            case '\\':
+            case '/':
+                pOut[n++] = c;
+                break;
+
+            case 'b':
+                pOut[n++] = '\b';
+                break;
+
+            case 'f':
+                pOut[n++] = '\f';
+                break;
+
+            case 'n':
+                pOut[n++] = '\n';
+                break;
+
+            case 'r':
+                pOut[n++] = '\r';
+                break;
+
+            case 't':
+                pOut[n++] = '\t';
+                break;
+
+            case 'u':
+                result = ParseHex4( pBuf, len, pos, &cp );
+                if ( result == EOK )
+                {
+                    pos += 4;
+
+                    /* combine a surrogate pair */
+                    if ( ( cp >= 0xD800 ) && ( cp <= 0xDBFF ) &&
+                         ( len - pos >= 6 ) &&
+                         ( pBuf[pos] == '\\' ) &&
+                         ( pBuf[pos + 1] == 'u' ) &&
+                         ( ParseHex4( pBuf, len, pos + 2, &low ) == EOK ) &&
+                         ( low >= 0xDC00 ) && ( low <= 0xDFFF ) )
+                    {
+                        cp = 0x10000 +
+                             ( ( cp - 0xD800 ) << 10 ) +
+                             ( low - 0xDC00 );
+                        pos += 6;
+                    }
+
+                    n += PutUTF8( pOut, cp );
+                }
+                break;
+
+            default:
+                result = EBADMSG;
+                break;
+        }
+    }
+
+    if ( result == EOK )
+    {
+        *pPos = pos;
+        *pOutLen += n;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseNumber                                                               */
+/*!
+    Check the syntax of a JSON number
+
+    The ParseNumber function checks that the text at a position is a
+    JSON number: an optional minus sign, an integer part without
+    leading zeros, and optional fraction and exponent parts which each
+    have at least one digit.
+
+    @param[in]
+        pBuf
+            pointer to the JSON text
+
+    @param[in]
+        len
+            length of the JSON text
+
+    @param[in,out]
+        pPos
+            position of the number, updated to the position following
+            it
+
+    @retval EOK the number is valid
+    @retval EBADMSG the number is malformed
+
+==============================================================================*/
+static int ParseNumber( const char *pBuf, size_t len, size_t *pPos )
+{
+    int result = EOK;
+    size_t pos = *pPos;
+
+    if ( ( pos < len ) && ( pBuf[pos] == '-' ) )
+    {
+        pos++;
+    }
+
+    if ( ( pos < len ) && ( pBuf[pos] == '0' ) )
+    {
+        pos++;
+    }
+    else if ( SkipDigits( pBuf, len, &pos ) == 0 )
+    {
+        result = EBADMSG;
+    }
+
+    if ( ( result == EOK ) &&
+         ( pos < len ) &&
+         ( pBuf[pos] == '.' ) )
+    {
+        pos++;
+        if ( SkipDigits( pBuf, len, &pos ) == 0 )
+        {
+            result = EBADMSG;
+        }
+    }
+
+    if ( ( result == EOK ) &&
+         ( pos < len ) &&
+         ( ( pBuf[pos] == 'e' ) || ( pBuf[pos] == 'E' ) ) )
+    {
+        pos++;
+        if ( ( pos < len ) &&
+             ( ( pBuf[pos] == '+' ) || ( pBuf[pos] == '-' ) ) )
+        {
+            pos++;
+        }
+
+        if ( SkipDigits( pBuf, len, &pos ) == 0 )
+        {
+            result = EBADMSG;
+        }
+    }
+
+    if ( result == EOK )
+    {
+        *pPos = pos;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SkipDigits                                                                */
+/*!
+    Skip decimal digits
+
+    @param[in]
+        pBuf
+            pointer to the JSON text
+
+    @param[in]
+        len
+            length of the JSON text
+
+    @param[in,out]
+        pPos
+            position to skip the digits from
+
+    @return the number of digits skipped
+
+==============================================================================*/
+static size_t SkipDigits( const char *pBuf, size_t len, size_t *pPos )
+{
+    size_t start = *pPos;
+
+    while ( ( *pPos < len ) &&
+            ( pBuf[*pPos] >= '0' ) &&
+            ( pBuf[*pPos] <= '9' ) )
+    {
+        (*pPos)++;
+    }
+
+    return *pPos - start;
+}
+
+/*============================================================================*/
+/*  ParseHex4                                                                 */
+/*!
+    Parse the four hex digits of a JSON unicode escape
+
+    @param[in]
+        pBuf
+            pointer to the JSON text
+
+    @param[in]
+        len
+            length of the JSON text
+
+    @param[in]
+        pos
+            position of the first hex digit
+
+    @param[out]
+        pVal
+            pointer to a location to store the value
+
+    @retval EOK the hex digits were parsed
+    @retval EBADMSG the hex digits are missing or invalid
+
+==============================================================================*/
+static int ParseHex4( const char *pBuf, size_t len, size_t pos, uint32_t *pVal )
+{
+    int result = EOK;
+    uint32_t val = 0;
+    size_t i;
+    char c;
+
+    if ( ( pos > len ) || ( len - pos < 4 ) )
+    {
+        result = EBADMSG;
+    }
+
+    for ( i = 0; ( i < 4 ) && ( result == EOK ); i++ )
+    {
+        c = pBuf[pos + i];
+        val <<= 4;
+
+        if ( ( c >= '0' ) && ( c <= '9' ) )
+        {
+            val |= (uint32_t)( c - '0' );
+        }
+        else if ( ( c >= 'a' ) && ( c <= 'f' ) )
+        {
+            val |= (uint32_t)( c - 'a' + 10 );
+        }
+        else if ( ( c >= 'A' ) && ( c <= 'F' ) )
+        {
+            val |= (uint32_t)( c - 'A' + 10 );
+        }
+        else
+        {
+            result = EBADMSG;
+        }
+    }
+
+    if ( result == EOK )
+    {
+        *pVal = val;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  PutUTF8                                                                   */
+/*!
+    Encode a code point as UTF-8
+
+    @param[out]
+        pOut
+            pointer to a buffer with room for at least 4 bytes
+
+    @param[in]
+        cp
+            unicode code point
+
+    @retval number of bytes written
+
+==============================================================================*/
+static size_t PutUTF8( char *pOut, uint32_t cp )
+{
+    size_t n;
+
+    if ( cp < 0x80 )
+    {
+        pOut[0] = (char)cp;
+        n = 1;
+    }
+    else if ( cp < 0x800 )
+    {
+        pOut[0] = (char)( 0xC0 | ( cp >> 6 ) );
+        pOut[1] = (char)( 0x80 | ( cp & 0x3F ) );
+        n = 2;
+    }
+    else if ( cp < 0x10000 )
+    {
+        pOut[0] = (char)( 0xE0 | ( cp >> 12 ) );
+        pOut[1] = (char)( 0x80 | ( ( cp >> 6 ) & 0x3F ) );
+        pOut[2] = (char)( 0x80 | ( cp & 0x3F ) );
+        n = 3;
+    }
+    else
+    {
+        pOut[0] = (char)( 0xF0 | ( cp >> 18 ) );
+        pOut[1] = (char)( 0x80 | ( ( cp >> 12 ) & 0x3F ) );
+        pOut[2] = (char)( 0x80 | ( ( cp >> 6 ) & 0x3F ) );
+        pOut[3] = (char)( 0x80 | ( cp & 0x3F ) );
+        n = 4;
+    }
+
+    return n;
+}
+
+/*============================================================================*/
+/*  SkipSpace                                                                 */
+/*!
+    Skip JSON white space
+
+    @param[in]
+        pBuf
+            pointer to the JSON text
+
+    @param[in]
+        len
+            length of the JSON text
+
+    @param[in,out]
+        pPos
+            position to skip the white space from
+
+==============================================================================*/
+static void SkipSpace( const char *pBuf, size_t len, size_t *pPos )
+{
+    while ( ( *pPos < len ) &&
+            ( ( pBuf[*pPos] == ' ' ) ||
+              ( pBuf[*pPos] == '\t' ) ||
+              ( pBuf[*pPos] == '\r' ) ||
+              ( pBuf[*pPos] == '\n' ) ) )
+    {
+        (*pPos)++;
+    }
+}
+
+/*! @}
+ * end of jsonobj group */
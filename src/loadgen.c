@@ -0,0 +1,648 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup loadgen Load Generator
+ * @brief Synthetic load from virtual sources for capacity testing
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file loadgen.c
+
+    Load Generator
+
+    The loadgen component emulates a number of virtual sources for
+    capacity testing of collectors and networks.  Each source has its
+    own payload seed and sequence number, and the sources take turns to
+    transmit at a combined target rate which ramps linearly from a
+    start rate to an end rate, and then holds.
+
+    The load generator only decides which source transmits and when.
+    The transmissions themselves are sent by the caller through the
+    normal render and send path.  The number of transmissions due at
+    any time is the integral of the target rate since the start, so
+    transmissions which could not be sent in time are caught up later,
+    up to LOADGEN_MAX_BURST per tick.  The achieved rate and the
+    process CPU time per transmission are measured over
+    LOADGEN_WINDOW_NS windows.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <time.h>
+#include <varserver/varserver.h>
+#include "hash.h"
+#include "loadgen.h"
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static uint64_t Expected( LoadGen *pGen, uint64_t elapsed_ns );
+static int ParseCount( const char *str, uint64_t *pVal );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  LOADGEN_Init                                                              */
+/*!
+    Initialize a load generator
+
+    The LOADGEN_Init function initializes a load generator with no
+    virtual sources, which disables it.
+
+    @param[in]
+        pGen
+            pointer to the load generator to initialize
+
+==============================================================================*/
+void LOADGEN_Init( LoadGen *pGen )
+{
+    if ( pGen != NULL )
+    {
+        memset( pGen, 0, sizeof( LoadGen ) );
+        snprintf( pGen->prefix,
+                  sizeof( pGen->prefix ),
+                  "%s",
+                  LOADGEN_DEFAULT_PREFIX );
+    }
+}
+
+/*============================================================================*/
+/*  LOADGEN_Parse                                                             */
+/*!
+    Parse a load generator specification
+
+    The LOADGEN_Parse function parses a load specification of the form:
+
+        sources:rate[:endrate[:ramp[:prefix]]]
+
+    where sources is the number of virtual sources, rate is the target
+    number of transmissions per second across all sources, and the
+    rates may have a k or M suffix (powers of 1000).  If an end rate is
+    specified, the target ramps from rate to endrate over ramp seconds.
+    The prefix sets the names of the seed and sequence number variables
+    (prefix/seed and prefix/seq).  The virtual sources are allocated.
+
+    @param[in]
+        pGen
+            pointer to the load generator
+
+    @param[in]
+        spec
+            load specification
+
+    @retval EOK the specification was parsed
+    @retval ENOMEM memory allocation failed
+    @retval EINVAL invalid specification
+
+==============================================================================*/
+int LOADGEN_Parse( LoadGen *pGen, const char *spec )
+{
+    int result = EINVAL;
+    char *fields[5] = { NULL, NULL, NULL, NULL, NULL };
+    char *saveptr = NULL;
+    uint64_t sources = 0;
+    uint64_t ramp_s = 0;
+    size_t n = 0;
+    char *copy = NULL;
+    char *p = NULL;
+
+    if ( ( pGen != NULL ) &&
+         ( spec != NULL ) )
+    {
+        copy = strdup( spec );
+        result = ( copy != NULL ) ? EOK : ENOMEM;
+    }
+
+    if ( result == EOK )
+    {
+        for ( p = strtok_r( copy, ":", &saveptr );
+              ( p != NULL ) && ( n < 5 );
+              p = strtok_r( NULL, ":", &saveptr ) )
+        {
+            fields[n++] = p;
+        }
+
+        LOADGEN_Free( pGen );
+
+        if ( ( p == NULL ) &&
+             ( n >= 2 ) &&
+             ( ParseCount( fields[0], &sources ) == EOK ) &&
+             ( sources > 0 ) &&
+             ( sources <= LOADGEN_MAX_SOURCES ) &&
+             ( ParseCount( fields[1], &pGen->startRate ) == EOK ) &&
+             ( ( fields[2] == NULL ) ||
+               ( ParseCount( fields[2], &pGen->endRate ) == EOK ) ) &&
+             ( ( fields[3] == NULL ) ||
+               ( ParseCount( fields[3], &ramp_s ) == EOK ) ) &&
+             ( ( fields[4] == NULL ) ||
+               ( strlen( fields[4] ) < sizeof( pGen->prefix ) ) ) )
+        {
+            if ( fields[2] == NULL )
+            {
+                pGen->endRate = pGen->startRate;
+            }
+
+            pGen->ramp_ns = ramp_s * 1000000000ULL;
+
+            if ( fields[4] != NULL )
+            {
+                snprintf( pGen->prefix,
+                          sizeof( pGen->prefix ),
+                          "%s",
+                          fields[4] );
+            }
+
+            pGen->sources = calloc( sources, sizeof( LoadSource ) );
+            if ( pGen->sources != NULL )
+            {
+                pGen->nSources = sources;
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+        else
+        {
+            result = EINVAL;
+        }
+    }
+
+    free( copy );
+
+    return result;
+}
+
+/*============================================================================*/
+/*  LOADGEN_Start                                                             */
+/*!
+    Start the load generator
+
+    The LOADGEN_Start function starts the target rate ramp, and derives
+    the payload seed of every virtual source from its index and a salt,
+    so the sources of different instances are also distinct.  The
+    sequence numbers and counters start again from zero.
+
+    @param[in]
+        pGen
+            pointer to the load generator
+
+    @param[in]
+        now_ns
+            current monotonic time in nanoseconds
+
+    @param[in]
+        salt
+            value which is unique to this instance
+
+==============================================================================*/
+void LOADGEN_Start( LoadGen *pGen, uint64_t now_ns, uint64_t salt )
+{
+    uint64_t key[2];
+    size_t i;
+
+    if ( ( pGen != NULL ) &&
+         ( pGen->sources != NULL ) )
+    {
+        key[0] = salt;
+        for ( i = 0; i < pGen->nSources; i++ )
+        {
+            key[1] = i;
+            pGen->sources[i].seed = (uint32_t)HASH_Compute( key,
+                                                            sizeof( key ) );
+            pGen->sources[i].seq = 0;
+        }
+
+        pGen->running = true;
+        pGen->start_ns = now_ns;
+        pGen->next = 0;
+        pGen->sent = 0;
+        pGen->startCpu_ns = LOADGEN_CpuNow();
+        pGen->window_ns = now_ns;
+        pGen->windowSent = 0;
+        pGen->windowCpu_ns = pGen->startCpu_ns;
+        pGen->achieved = 0;
+        pGen->cpuPerSend_ns = 0;
+    }
+}
+
+/*============================================================================*/
+/*  LOADGEN_Stop                                                              */
+/*!
+    Stop the load generator
+
+    The LOADGEN_Stop function stops the load generator.  Its counters
+    are kept until it is started again.
+
+    @param[in]
+        pGen
+            pointer to the load generator
+
+==============================================================================*/
+void LOADGEN_Stop( LoadGen *pGen )
+{
+    if ( pGen != NULL )
+    {
+        pGen->running = false;
+    }
+}
+
+/*============================================================================*/
+/*  LOADGEN_Target                                                            */
+/*!
+    Get the current target rate
+
+    @param[in]
+        pGen
+            pointer to the load generator
+
+    @param[in]
+        now_ns
+            current monotonic time in nanoseconds
+
+    @retval target rate in transmissions per second across all sources
+
+==============================================================================*/
+uint64_t LOADGEN_Target( LoadGen *pGen, uint64_t now_ns )
+{
+    uint64_t target = 0;
+    uint64_t elapsed_ns;
+    double rate;
+
+    if ( ( pGen != NULL ) &&
+         ( pGen->running == true ) )
+    {
+        elapsed_ns = now_ns - pGen->start_ns;
+        if ( elapsed_ns >= pGen->ramp_ns )
+        {
+            target = pGen->endRate;
+        }
+        else
+        {
+            rate = (double)pGen->startRate +
+                   ( (double)pGen->endRate - (double)pGen->startRate ) *
+                   (double)elapsed_ns / (double)pGen->ramp_ns;
+            target = (uint64_t)rate;
+        }
+    }
+
+    return target;
+}
+
+/*============================================================================*/
+/*  LOADGEN_Behind                                                            */
+/*!
+    Get the number of transmissions the load generator is behind
+
+    The LOADGEN_Behind function gets the number of transmissions which
+    should have been sent by now at the target rate, but have not.
+
+    @param[in]
+        pGen
+            pointer to the load generator
+
+    @param[in]
+        now_ns
+            current monotonic time in nanoseconds
+
+    @retval number of transmissions behind the target
+
+==============================================================================*/
+uint64_t LOADGEN_Behind( LoadGen *pGen, uint64_t now_ns )
+{
+    uint64_t behind = 0;
+    uint64_t expected;
+
+    if ( ( pGen != NULL ) &&
+         ( pGen->running == true ) )
+    {
+        expected = Expected( pGen, now_ns - pGen->start_ns );
+        if ( expected > pGen->sent )
+        {
+            behind = expected - pGen->sent;
+        }
+    }
+
+    return behind;
+}
+
+/*============================================================================*/
+/*  LOADGEN_Due                                                               */
+/*!
+    Get the number of transmissions due
+
+    The LOADGEN_Due function gets the number of transmissions to send
+    now to keep up with the target rate, limited to LOADGEN_MAX_BURST.
+
+    @param[in]
+        pGen
+            pointer to the load generator
+
+    @param[in]
+        now_ns
+            current monotonic time in nanoseconds
+
+    @retval number of transmissions to send
+
+==============================================================================*/
+size_t LOADGEN_Due( LoadGen *pGen, uint64_t now_ns )
+{
+    uint64_t behind = LOADGEN_Behind( pGen, now_ns );
+
+    return ( behind > LOADGEN_MAX_BURST ) ? LOADGEN_MAX_BURST
+                                          : (size_t)behind;
+}
+
+/*============================================================================*/
+/*  LOADGEN_Next                                                              */
+/*!
+    Get the virtual source which transmits next
+
+    The LOADGEN_Next function gets the virtual sources in turn.
+
+    @param[in]
+        pGen
+            pointer to the load generator
+
+    @retval pointer to the virtual source
+    @retval NULL the load generator has no sources
+
+==============================================================================*/
+LoadSource *LOADGEN_Next( LoadGen *pGen )
+{
+    LoadSource *pSource = NULL;
+
+    if ( ( pGen != NULL ) &&
+         ( pGen->nSources > 0 ) )
+    {
+        pSource = &pGen->sources[pGen->next];
+        pGen->next = ( pGen->next + 1 ) % pGen->nSources;
+    }
+
+    return pSource;
+}
+
+/*============================================================================*/
+/*  LOADGEN_Sent                                                              */
+/*!
+    Count a transmission of a virtual source
+
+    The LOADGEN_Sent function advances the sequence number of a virtual
+    source once its transmission has been sent.
+
+    @param[in]
+        pGen
+            pointer to the load generator
+
+    @param[in]
+        pSource
+            pointer to the virtual source which transmitted
+
+==============================================================================*/
+void LOADGEN_Sent( LoadGen *pGen, LoadSource *pSource )
+{
+    if ( ( pGen != NULL ) &&
+         ( pSource != NULL ) )
+    {
+        pSource->seq++;
+        pGen->sent++;
+    }
+}
+
+/*============================================================================*/
+/*  LOADGEN_Sample                                                            */
+/*!
+    Measure the achieved rate and CPU time
+
+    The LOADGEN_Sample function completes the measurement window once
+    LOADGEN_WINDOW_NS has elapsed, and stores the rate achieved and the
+    process CPU time used per transmission during it.
+
+    @param[in]
+        pGen
+            pointer to the load generator
+
+    @param[in]
+        now_ns
+            current monotonic time in nanoseconds
+
+==============================================================================*/
+void LOADGEN_Sample( LoadGen *pGen, uint64_t now_ns )
+{
+    uint64_t elapsed_ns;
+    uint64_t sent;
+    uint64_t cpu_ns;
+
+    if ( ( pGen != NULL ) &&
+         ( pGen->running == true ) )
+    {
+        elapsed_ns = now_ns - pGen->window_ns;
+        if ( elapsed_ns >= LOADGEN_WINDOW_NS )
+        {
+            cpu_ns = LOADGEN_CpuNow();
+            sent = pGen->sent - pGen->windowSent;
+
+            pGen->achieved = (uint64_t)( (double)sent * 1e9 /
+                                         (double)elapsed_ns );
+            pGen->cpuPerSend_ns = ( sent > 0 )
+                                  ? ( cpu_ns - pGen->windowCpu_ns ) / sent
+                                  : 0;
+
+            pGen->window_ns = now_ns;
+            pGen->windowSent = pGen->sent;
+            pGen->windowCpu_ns = cpu_ns;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  LOADGEN_CpuNow                                                            */
+/*!
+    Get the CPU time used by the process
+
+    The LOADGEN_CpuNow function gets the CPU time used by all of the
+    threads of the process, including the sender thread.
+
+    @retval process CPU time in nanoseconds
+
+==============================================================================*/
+uint64_t LOADGEN_CpuNow( void )
+{
+    uint64_t now_ns = 0;
+    struct timespec ts;
+
+    if ( clock_gettime( CLOCK_PROCESS_CPUTIME_ID, &ts ) == 0 )
+    {
+        now_ns = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    }
+
+    return now_ns;
+}
+
+/*============================================================================*/
+/*  LOADGEN_Free                                                              */
+/*!
+    Free a load generator
+
+    The LOADGEN_Free function releases the virtual sources, which
+    disables the load generator.
+
+    @param[in]
+        pGen
+            pointer to the load generator
+
+==============================================================================*/
+void LOADGEN_Free( LoadGen *pGen )
+{
+    if ( pGen != NULL )
+    {
+        free( pGen->sources );
+        pGen->sources = NULL;
+        pGen->nSources = 0;
+        pGen->running = false;
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  Expected                                                                  */
+/*!
+    Get the number of transmissions expected since the start
+
+    The Expected function integrates the target rate from the start of
+    the load generator: the average of the start and current rates over
+    the ramp, followed by the end rate.
+
+    @param[in]
+        pGen
+            pointer to the load generator
+
+    @param[in]
+        elapsed_ns
+            time since the start in nanoseconds
+
+    @retval number of transmissions expected
+
+==============================================================================*/
+static uint64_t Expected( LoadGen *pGen, uint64_t elapsed_ns )
+{
+    double r0 = (double)pGen->startRate;
+    double r1 = (double)pGen->endRate;
+    double t = (double)elapsed_ns / 1e9;
+    double ramp = (double)pGen->ramp_ns / 1e9;
+    double rate;
+    double count;
+
+    if ( elapsed_ns < pGen->ramp_ns )
+    {
+        rate = r0 + ( r1 - r0 ) * t / ramp;
+        count = ( r0 + rate ) / 2.0 * t;
+    }
+    else
+    {
+        count = ( r0 + r1 ) / 2.0 * ramp + r1 * ( t - ramp );
+    }
+
+    return (uint64_t)count;
+}
+
+/*============================================================================*/
+/*  ParseCount                                                                */
+/*!
+    Parse a count or rate with an optional k or M suffix
+
+    @param[in]
+        str
+            string to parse
+
+    @param[out]
+        pVal
+            pointer to a location to store the value
+
+    @retval EOK the value was parsed
+    @retval EINVAL invalid value
+
+==============================================================================*/
+static int ParseCount( const char *str, uint64_t *pVal )
+{
+    int result = EINVAL;
+    char *pEnd = NULL;
+    uint64_t val;
+    uint64_t scale = 1;
+
+    errno = 0;
+    val = strtoull( str, &pEnd, 10 );
+    if ( ( errno == 0 ) &&
+         ( pEnd != str ) &&
+         ( str[0] != '-' ) )
+    {
+        switch( *pEnd )
+        {
+            case 'k':
+            case 'K':
+                scale = 1000ULL;
+                pEnd++;
+                break;
+
+            case 'M':
+                scale = 1000000ULL;
+                pEnd++;
+                break;
+
+            default:
+                break;
+        }
+
+        if ( ( *pEnd == '\0' ) &&
+             ( val <= UINT64_MAX / scale ) )
+        {
+            *pVal = val * scale;
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*! @}
+ * end of loadgen group */
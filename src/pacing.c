@@ -0,0 +1,623 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup pacing Transmit Pacing
+ * @brief Per-interface transmit rate limiting
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file pacing.c
+
+    Transmit Pacing
+
+    The pacing component limits the rate at which datagrams are sent on
+    each configured interface, so a transmission which fans out to many
+    destinations does not burst more onto a slow link than its queue
+    can hold.  The rate is enforced by the kernel using the socket
+    pacing rate, by SO_TXTIME launch times which spread the datagrams
+    out at the pacing rate, or in user space by a token bucket which
+    drops the payloads exceeding the rate.
+
+    The token bucket is kept as the time the interface will have sent
+    everything admitted so far (a virtual scheduling time), which also
+    provides the SO_TXTIME launch times.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <linux/net_tstamp.h>
+#include <varserver/varserver.h>
+#include "pacing.h"
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static int ParseEntry( PacingEntry *pEntry, char *entry );
+static int ParseSize( const char *str, uint64_t *pVal );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  PACING_Init                                                               */
+/*!
+    Initialize a pacing table
+
+    The PACING_Init function initializes an empty pacing table, so no
+    interface is paced.
+
+    @param[in]
+        pPacing
+            pointer to the pacing table to initialize
+
+==============================================================================*/
+void PACING_Init( Pacing *pPacing )
+{
+    if ( pPacing != NULL )
+    {
+        memset( pPacing, 0, sizeof( Pacing ) );
+    }
+}
+
+/*============================================================================*/
+/*  PACING_Parse                                                              */
+/*!
+    Parse a pacing specification
+
+    The PACING_Parse function adds the interfaces of a comma separated
+    pacing specification to the pacing table.  Each entry has the form
+
+        ifname:rate[:mode[:burst]]
+
+    where rate is in bytes per second, mode is one of "bucket" (the
+    default), "fq" or "txtime", and burst is in bytes.  The rate and
+    burst may have a k, M or G suffix (powers of 1000).  An ifname of
+    "*" paces every interface which is not listed.
+
+    @param[in]
+        pPacing
+            pointer to the pacing table
+
+    @param[in]
+        spec
+            pacing specification
+
+    @retval EOK the specification was parsed
+    @retval ENOSPC too many interfaces are paced
+    @retval ENOMEM memory allocation failed
+    @retval EINVAL invalid specification
+
+==============================================================================*/
+int PACING_Parse( Pacing *pPacing, const char *spec )
+{
+    int result = EINVAL;
+    char *copy = NULL;
+    char *entry;
+    char *saveptr = NULL;
+
+    if ( ( pPacing != NULL ) &&
+         ( spec != NULL ) )
+    {
+        copy = strdup( spec );
+        result = ( copy != NULL ) ? EOK : ENOMEM;
+    }
+
+    if ( result == EOK )
+    {
+        for ( entry = strtok_r( copy, ",", &saveptr );
+              ( entry != NULL ) && ( result == EOK );
+              entry = strtok_r( NULL, ",", &saveptr ) )
+        {
+            if ( pPacing->n >= PACING_MAX_ENTRIES )
+            {
+                result = ENOSPC;
+            }
+            else
+            {
+                result = ParseEntry( &pPacing->entries[pPacing->n], entry );
+            }
+
+            if ( result == EOK )
+            {
+                pPacing->n++;
+            }
+        }
+    }
+
+    free( copy );
+
+    return result;
+}
+
+/*============================================================================*/
+/*  PACING_Find                                                               */
+/*!
+    Find the pacing entry of an interface
+
+    The PACING_Find function gets the pacing entry for the specified
+    interface, or the "*" entry if the interface is not listed.
+
+    @param[in]
+        pPacing
+            pointer to the pacing table
+
+    @param[in]
+        ifname
+            name of the interface
+
+    @retval pointer to the pacing entry
+    @retval NULL the interface is not paced
+
+==============================================================================*/
+PacingEntry *PACING_Find( Pacing *pPacing, const char *ifname )
+{
+    PacingEntry *pFound = NULL;
+    PacingEntry *pDefault = NULL;
+    size_t i;
+
+    if ( ( pPacing != NULL ) &&
+         ( ifname != NULL ) )
+    {
+        for ( i = 0; ( i < pPacing->n ) && ( pFound == NULL ); i++ )
+        {
+            if ( strcmp( pPacing->entries[i].ifname, ifname ) == 0 )
+            {
+                pFound = &pPacing->entries[i];
+            }
+            else if ( strcmp( pPacing->entries[i].ifname, "*" ) == 0 )
+            {
+                pDefault = &pPacing->entries[i];
+            }
+        }
+    }
+
+    return ( pFound != NULL ) ? pFound : pDefault;
+}
+
+/*============================================================================*/
+/*  PACING_SetupSocket                                                        */
+/*!
+    Set up a socket for kernel pacing
+
+    The PACING_SetupSocket function sets the pacing rate (fq mode) or
+    enables launch times (txtime mode) on a new socket bound to a paced
+    interface.  Launch times use the monotonic clock, as the fq qdisc
+    requires.  If the kernel rejects the socket option, the interface
+    falls back to the user space token bucket.
+
+    @param[in]
+        pEntry
+            pointer to the pacing entry of the interface
+
+    @param[in]
+        fd
+            socket bound to the interface
+
+    @retval EOK the socket was set up
+    @retval ENOTSUP the socket option is not supported
+    @retval EINVAL invalid arguments
+    @retval other error from setsockopt
+
+==============================================================================*/
+int PACING_SetupSocket( PacingEntry *pEntry, int fd )
+{
+    int result = EINVAL;
+    unsigned int rate;
+#ifdef SO_TXTIME
+    struct sock_txtime txtime;
+#endif
+
+    if ( ( pEntry != NULL ) &&
+         ( fd >= 0 ) )
+    {
+        result = EOK;
+
+        if ( pEntry->mode == PACING_MODE_FQ )
+        {
+            /* ~0U means unlimited, so stop just short of it */
+            rate = ( pEntry->rate < UINT32_MAX )
+                   ? (unsigned int)pEntry->rate
+                   : UINT32_MAX - 1;
+            if ( setsockopt( fd,
+                             SOL_SOCKET,
+                             SO_MAX_PACING_RATE,
+                             &rate,
+                             sizeof( rate ) ) != 0 )
+            {
+                result = errno;
+            }
+        }
+        else if ( pEntry->mode == PACING_MODE_TXTIME )
+        {
+#ifdef SO_TXTIME
+            memset( &txtime, 0, sizeof( txtime ) );
+            txtime.clockid = CLOCK_MONOTONIC;
+            if ( setsockopt( fd,
+                             SOL_SOCKET,
+                             SO_TXTIME,
+                             &txtime,
+                             sizeof( txtime ) ) != 0 )
+            {
+                result = errno;
+            }
+#else
+            result = ENOTSUP;
+#endif
+        }
+
+        if ( result != EOK )
+        {
+            pEntry->active = PACING_MODE_BUCKET;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  PACING_Admit                                                              */
+/*!
+    Admit a payload for transmission on a paced interface
+
+    The PACING_Admit function decides if a payload of the specified
+    wire length may be sent on the interface now.
+
+    With the token bucket, the payload is admitted if the interface is
+    no more than the burst allowance behind in sending what it has
+    already admitted, and is dropped otherwise.  A payload larger than
+    the burst allowance is admitted by an idle interface, which is then
+    behind by the whole payload.  With launch times, the
+    payload is admitted with the launch time at which the interface is
+    free, and is dropped if that is more than PACING_HORIZON_NS away.
+    With kernel pacing, every payload is admitted and the socket paces
+    it.
+
+    @param[in]
+        pEntry
+            pointer to the pacing entry of the interface
+
+    @param[in]
+        len
+            number of bytes the payload occupies on the wire
+
+    @param[in]
+        now_ns
+            current monotonic time in nanoseconds
+
+    @param[out]
+        pLaunch_ns
+            pointer to a location to store the SO_TXTIME launch time of
+            the payload, or 0 if it is not sent with a launch time
+
+    @retval EOK the payload may be sent
+    @retval ENOBUFS the payload exceeds the pacing rate and is dropped
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int PACING_Admit( PacingEntry *pEntry,
+                  size_t len,
+                  uint64_t now_ns,
+                  uint64_t *pLaunch_ns )
+{
+    int result = EINVAL;
+    uint64_t burst_ns;
+    uint64_t start_ns;
+
+    if ( ( pEntry != NULL ) &&
+         ( pLaunch_ns != NULL ) )
+    {
+        *pLaunch_ns = 0;
+        result = EOK;
+
+        burst_ns = PACING_Duration( pEntry, pEntry->burst );
+        start_ns = ( pEntry->next_ns > now_ns ) ? pEntry->next_ns : now_ns;
+
+        if ( pEntry->active == PACING_MODE_BUCKET )
+        {
+            /* an idle interface starts from now, so the credit it
+               accumulates is capped at the burst allowance.  A payload
+               larger than the burst allowance is only charged the
+               allowance here, so an idle interface can still send it */
+            if ( start_ns - now_ns +
+                 PACING_Duration( pEntry,
+                                  ( len < pEntry->burst )
+                                      ? len
+                                      : (size_t)pEntry->burst ) >
+                 burst_ns )
+            {
+                result = ENOBUFS;
+            }
+        }
+        else if ( pEntry->active == PACING_MODE_TXTIME )
+        {
+            if ( start_ns - now_ns > PACING_HORIZON_NS )
+            {
+                result = ENOBUFS;
+            }
+            else
+            {
+                if ( start_ns > now_ns )
+                {
+                    pEntry->deferred++;
+                }
+
+                *pLaunch_ns = start_ns;
+            }
+        }
+
+        if ( result == EOK )
+        {
+            pEntry->next_ns = start_ns + PACING_Duration( pEntry, len );
+            pEntry->admitted++;
+        }
+        else
+        {
+            pEntry->dropped++;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  PACING_Duration                                                           */
+/*!
+    Get the time to send a number of bytes at the pacing rate
+
+    @param[in]
+        pEntry
+            pointer to the pacing entry of the interface
+
+    @param[in]
+        len
+            number of bytes
+
+    @retval time to send the bytes in nanoseconds
+
+==============================================================================*/
+uint64_t PACING_Duration( const PacingEntry *pEntry, size_t len )
+{
+    uint64_t duration_ns = 0;
+
+    if ( ( pEntry != NULL ) &&
+         ( pEntry->rate > 0 ) )
+    {
+        /* split the division so large burst sizes cannot overflow */
+        duration_ns = ( (uint64_t)len / pEntry->rate ) * 1000000000ULL +
+                      ( ( (uint64_t)len % pEntry->rate ) * 1000000000ULL ) /
+                      pEntry->rate;
+    }
+
+    return duration_ns;
+}
+
+/*============================================================================*/
+/*  PACING_ModeName                                                           */
+/*!
+    Get the name of a pacing mode
+
+    @param[in]
+        mode
+            pacing mode
+
+    @retval name of the pacing mode
+
+==============================================================================*/
+const char *PACING_ModeName( int mode )
+{
+    return ( mode == PACING_MODE_FQ ) ? "fq"
+           : ( mode == PACING_MODE_TXTIME ) ? "txtime"
+           : "bucket";
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  ParseEntry                                                                */
+/*!
+    Parse one interface of a pacing specification
+
+    The ParseEntry function parses an ifname:rate[:mode[:burst]] entry
+    into a pacing entry.  The default burst allowance is what the
+    interface sends in PACING_BURST_NS at the pacing rate, and at least
+    PACING_MIN_BURST bytes.
+
+    @param[out]
+        pEntry
+            pointer to the pacing entry to populate
+
+    @param[in]
+        entry
+            entry of the pacing specification, which is modified
+
+    @retval EOK the entry was parsed
+    @retval EINVAL invalid entry
+
+==============================================================================*/
+static int ParseEntry( PacingEntry *pEntry, char *entry )
+{
+    int result = EOK;
+    char *fields[4] = { NULL, NULL, NULL, NULL };
+    char *saveptr = NULL;
+    size_t n = 0;
+    char *p;
+
+    for ( p = strtok_r( entry, ":", &saveptr );
+          ( p != NULL ) && ( result == EOK );
+          p = strtok_r( NULL, ":", &saveptr ) )
+    {
+        if ( n == 4 )
+        {
+            result = EINVAL;
+        }
+        else
+        {
+            fields[n++] = p;
+        }
+    }
+
+    if ( ( result == EOK ) &&
+         ( ( n < 2 ) ||
+           ( strlen( fields[0] ) >= sizeof( pEntry->ifname ) ) ) )
+    {
+        result = EINVAL;
+    }
+
+    if ( result == EOK )
+    {
+        memset( pEntry, 0, sizeof( PacingEntry ) );
+        snprintf( pEntry->ifname, sizeof( pEntry->ifname ), "%s", fields[0] );
+
+        if ( ( ParseSize( fields[1], &pEntry->rate ) != EOK ) ||
+             ( pEntry->rate == 0 ) )
+        {
+            result = EINVAL;
+        }
+        else if ( ( fields[2] == NULL ) ||
+                  ( strcasecmp( fields[2], "bucket" ) == 0 ) )
+        {
+            pEntry->mode = PACING_MODE_BUCKET;
+        }
+        else if ( strcasecmp( fields[2], "fq" ) == 0 )
+        {
+            pEntry->mode = PACING_MODE_FQ;
+        }
+        else if ( strcasecmp( fields[2], "txtime" ) == 0 )
+        {
+            pEntry->mode = PACING_MODE_TXTIME;
+        }
+        else
+        {
+            result = EINVAL;
+        }
+    }
+
+    if ( result == EOK )
+    {
+        pEntry->active = pEntry->mode;
+
+        if ( fields[3] != NULL )
+        {
+            result = ParseSize( fields[3], &pEntry->burst );
+        }
+        else
+        {
+            pEntry->burst = ( pEntry->rate * ( PACING_BURST_NS / 1000 ) ) /
+                            1000000ULL;
+        }
+
+        if ( pEntry->burst < PACING_MIN_BURST )
+        {
+            pEntry->burst = PACING_MIN_BURST;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseSize                                                                 */
+/*!
+    Parse a rate or size with an optional k, M or G suffix
+
+    @param[in]
+        str
+            string to parse
+
+    @param[out]
+        pVal
+            pointer to a location to store the value
+
+    @retval EOK the value was parsed
+    @retval EINVAL invalid value
+
+==============================================================================*/
+static int ParseSize( const char *str, uint64_t *pVal )
+{
+    int result = EINVAL;
+    char *pEnd = NULL;
+    uint64_t val;
+    uint64_t scale = 1;
+
+    errno = 0;
+    val = strtoull( str, &pEnd, 10 );
+    if ( ( errno == 0 ) &&
+         ( pEnd != str ) &&
+         ( str[0] != '-' ) )
+    {
+        switch( *pEnd )
+        {
+            case 'k':
+            case 'K':
+                scale = 1000ULL;
+                pEnd++;
+                break;
+
+            case 'M':
+                scale = 1000000ULL;
+                pEnd++;
+                break;
+
+            case 'G':
+                scale = 1000000000ULL;
+                pEnd++;
+                break;
+
+            default:
+                break;
+        }
+
+        if ( ( *pEnd == '\0' ) &&
+             ( val <= UINT64_MAX / scale ) )
+        {
+            *pVal = val * scale;
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*! @}
+ * end of pacing group */
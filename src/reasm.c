@@ -0,0 +1,654 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup reasm Segment Reassembly
+ * @brief Reassembly of payloads sent as several segments
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file reasm.c
+
+    Segment Reassembly
+
+    The reasm component rebuilds the payloads which udpt sends as a
+    train of segment datagrams.  Segments are matched by their source
+    address and message identifier, so several senders can be
+    reassembled at once, and may arrive in any order.  Every segment
+    but the last carries the same amount of data, so each one is copied
+    straight to its final position in the reassembly buffer.
+
+    A fixed number of payloads can be in progress at once.  Payloads
+    which are not completed within REASM_TIMEOUT_NS, for example because
+    a segment was lost, are discarded, and the oldest payload is
+    discarded if a new one arrives while every slot is busy.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <varserver/varserver.h>
+#include "reasm.h"
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static ReasmMessage *Find( Reasm *pReasm,
+                           const struct sockaddr *pSource,
+                           uint16_t msgId );
+static ReasmMessage *Allocate( Reasm *pReasm );
+static int Start( ReasmMessage *pMsg,
+                  const struct sockaddr *pSource,
+                  const UDPTSegment *pSegment,
+                  uint64_t now_ns );
+static int Place( ReasmMessage *pMsg,
+                  const UDPTSegment *pSegment,
+                  const char *pData,
+                  size_t len );
+static int Reserve( ReasmMessage *pMsg, size_t size );
+static bool SameSource( const struct sockaddr *pA,
+                        const struct sockaddr_storage *pB );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  REASM_Add                                                                 */
+/*!
+    Add a received segment to its payload
+
+    The REASM_Add function copies a received segment into the payload it
+    belongs to.  When the last missing segment of a payload is added,
+    the reassembled payload is returned.  It remains valid until the
+    next call to REASM_Add or REASM_Free.
+
+    @param[in]
+        pReasm
+            pointer to the segment reassembler
+
+    @param[in]
+        pSource
+            address the segment was received from
+
+    @param[in]
+        pSegment
+            pointer to the parsed segment header
+
+    @param[in]
+        pData
+            pointer to the segment data following the header
+
+    @param[in]
+        len
+            length of the segment data
+
+    @param[in]
+        now_ns
+            current monotonic time in nanoseconds
+
+    @param[out]
+        ppPayload
+            pointer to a location to store the reassembled payload
+
+    @param[out]
+        pLen
+            pointer to a location to store the reassembled payload length
+
+    @retval EOK the payload is complete
+    @retval EINPROGRESS more segments of the payload are needed
+    @retval EBADMSG the segment does not fit its payload, which is discarded
+    @retval E2BIG the payload is larger than REASM_MAX_PAYLOAD
+    @retval ENOMEM memory allocation failed
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int REASM_Add( Reasm *pReasm,
+               const struct sockaddr *pSource,
+               const UDPTSegment *pSegment,
+               const char *pData,
+               size_t len,
+               uint64_t now_ns,
+               const char **ppPayload,
+               size_t *pLen )
+{
+    int result = EINVAL;
+    ReasmMessage *pMsg;
+    size_t i;
+
+    if ( ( pReasm == NULL ) ||
+         ( pSource == NULL ) ||
+         ( pSegment == NULL ) ||
+         ( pData == NULL ) ||
+         ( ppPayload == NULL ) ||
+         ( pLen == NULL ) ||
+         ( pSegment->index >= pSegment->count ) )
+    {
+        result = EINVAL;
+    }
+    else if ( pSegment->count == 1 )
+    {
+        /* a single segment is the whole payload */
+        *ppPayload = pData;
+        *pLen = len;
+        pReasm->completed++;
+        result = EOK;
+    }
+    else
+    {
+        /* discard the payloads which can no longer be completed */
+        for ( i = 0; i < REASM_MAX_MESSAGES; i++ )
+        {
+            pMsg = &pReasm->msgs[i];
+            if ( ( pMsg->active == true ) &&
+                 ( now_ns - pMsg->start_ns > REASM_TIMEOUT_NS ) )
+            {
+                pMsg->active = false;
+                pReasm->expired++;
+            }
+        }
+
+        pMsg = Find( pReasm, pSource, pSegment->msgId );
+        if ( ( pMsg != NULL ) &&
+             ( pMsg->count != pSegment->count ) )
+        {
+            /* the message identifier has been re-used for a new payload */
+            pMsg->active = false;
+            pMsg = NULL;
+        }
+
+        result = EOK;
+        if ( pMsg == NULL )
+        {
+            pMsg = Allocate( pReasm );
+            result = Start( pMsg, pSource, pSegment, now_ns );
+        }
+
+        if ( result == EOK )
+        {
+            result = Place( pMsg, pSegment, pData, len );
+        }
+
+        if ( result == EOK )
+        {
+            if ( pMsg->received == pMsg->count )
+            {
+                pMsg->active = false;
+                *ppPayload = pMsg->pBuf;
+                *pLen = (size_t)( pMsg->count - 1 ) * pMsg->segSize +
+                        pMsg->lastLen;
+                pReasm->completed++;
+            }
+            else
+            {
+                result = EINPROGRESS;
+            }
+        }
+        else if ( result != EINPROGRESS )
+        {
+            pMsg->active = false;
+            pReasm->invalid++;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  REASM_Free                                                                */
+/*!
+    Free the resources used by a segment reassembler
+
+    The REASM_Free function releases the reassembly buffers, discarding
+    all of the payloads in progress.
+
+    @param[in]
+        pReasm
+            pointer to the segment reassembler
+
+==============================================================================*/
+void REASM_Free( Reasm *pReasm )
+{
+    size_t i;
+
+    if ( pReasm != NULL )
+    {
+        for ( i = 0; i < REASM_MAX_MESSAGES; i++ )
+        {
+            free( pReasm->msgs[i].pBuf );
+            free( pReasm->msgs[i].pHave );
+        }
+
+        memset( pReasm, 0, sizeof( Reasm ) );
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  Find                                                                      */
+/*!
+    Find the payload a segment belongs to
+
+    @param[in]
+        pReasm
+            pointer to the segment reassembler
+
+    @param[in]
+        pSource
+            address the segment was received from
+
+    @param[in]
+        msgId
+            message identifier of the segment
+
+    @retval pointer to the payload being reassembled
+    @retval NULL the payload is not being reassembled
+
+==============================================================================*/
+static ReasmMessage *Find( Reasm *pReasm,
+                           const struct sockaddr *pSource,
+                           uint16_t msgId )
+{
+    ReasmMessage *pFound = NULL;
+    ReasmMessage *pMsg;
+    size_t i;
+
+    for ( i = 0; ( i < REASM_MAX_MESSAGES ) && ( pFound == NULL ); i++ )
+    {
+        pMsg = &pReasm->msgs[i];
+        if ( ( pMsg->active == true ) &&
+             ( pMsg->msgId == msgId ) &&
+             ( SameSource( pSource, &pMsg->source ) == true ) )
+        {
+            pFound = pMsg;
+        }
+    }
+
+    return pFound;
+}
+
+/*============================================================================*/
+/*  Allocate                                                                  */
+/*!
+    Allocate a slot for a new payload
+
+    The Allocate function gets an unused payload slot, or discards the
+    oldest payload in progress if every slot is in use.
+
+    @param[in]
+        pReasm
+            pointer to the segment reassembler
+
+    @retval pointer to the payload slot
+
+==============================================================================*/
+static ReasmMessage *Allocate( Reasm *pReasm )
+{
+    ReasmMessage *pOldest = &pReasm->msgs[0];
+    ReasmMessage *pFree = NULL;
+    ReasmMessage *pMsg;
+    size_t i;
+
+    for ( i = 0; ( i < REASM_MAX_MESSAGES ) && ( pFree == NULL ); i++ )
+    {
+        pMsg = &pReasm->msgs[i];
+        if ( pMsg->active == false )
+        {
+            pFree = pMsg;
+        }
+        else if ( pMsg->start_ns < pOldest->start_ns )
+        {
+            pOldest = pMsg;
+        }
+    }
+
+    if ( pFree == NULL )
+    {
+        /* every slot is in use */
+        pOldest->active = false;
+        pReasm->evicted++;
+        pFree = pOldest;
+    }
+
+    return pFree;
+}
+
+/*============================================================================*/
+/*  Start                                                                     */
+/*!
+    Start reassembling a payload
+
+    The Start function sets up a payload slot for the payload of a newly
+    received segment, keeping the buffers of its previous payload.
+
+    @param[in]
+        pMsg
+            pointer to the payload slot
+
+    @param[in]
+        pSource
+            address the segment was received from
+
+    @param[in]
+        pSegment
+            pointer to the parsed segment header
+
+    @param[in]
+        now_ns
+            current monotonic time in nanoseconds
+
+    @retval EOK the payload was started
+    @retval ENOMEM memory allocation failed
+
+==============================================================================*/
+static int Start( ReasmMessage *pMsg,
+                  const struct sockaddr *pSource,
+                  const UDPTSegment *pSegment,
+                  uint64_t now_ns )
+{
+    int result = EOK;
+    size_t haveSize = ( (size_t)pSegment->count + 7 ) / 8;
+    uint8_t *p;
+
+    if ( haveSize > pMsg->haveSize )
+    {
+        p = realloc( pMsg->pHave, haveSize );
+        if ( p == NULL )
+        {
+            result = ENOMEM;
+        }
+        else
+        {
+            pMsg->pHave = p;
+            pMsg->haveSize = haveSize;
+        }
+    }
+
+    if ( result == EOK )
+    {
+        memset( pMsg->pHave, 0, haveSize );
+        memcpy( &pMsg->source,
+                pSource,
+                ( pSource->sa_family == AF_INET6 )
+                    ? sizeof( struct sockaddr_in6 )
+                    : sizeof( struct sockaddr_in ) );
+        pMsg->msgId = pSegment->msgId;
+        pMsg->count = pSegment->count;
+        pMsg->received = 0;
+        pMsg->segSize = 0;
+        pMsg->lastLen = 0;
+        pMsg->start_ns = now_ns;
+        pMsg->active = true;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  Place                                                                     */
+/*!
+    Copy a segment into its payload
+
+    The Place function copies the segment data to its position in the
+    reassembly buffer.  The size of the segments is learned from the
+    first segment other than the last one.  If the last segment arrives
+    before that, it is held at the start of the buffer and moved to its
+    position once the segment size is known.
+
+    @param[in]
+        pMsg
+            pointer to the payload being reassembled
+
+    @param[in]
+        pSegment
+            pointer to the parsed segment header
+
+    @param[in]
+        pData
+            pointer to the segment data
+
+    @param[in]
+        len
+            length of the segment data
+
+    @retval EOK the segment was added
+    @retval EINPROGRESS the segment is a duplicate
+    @retval EBADMSG the segment size does not match the payload
+    @retval E2BIG the payload is larger than REASM_MAX_PAYLOAD
+    @retval ENOMEM memory allocation failed
+
+==============================================================================*/
+static int Place( ReasmMessage *pMsg,
+                  const UDPTSegment *pSegment,
+                  const char *pData,
+                  size_t len )
+{
+    int result = EOK;
+    size_t index = pSegment->index;
+    size_t last = (size_t)pMsg->count - 1;
+    uint8_t mask = (uint8_t)( 1 << ( index % 8 ) );
+    bool haveLast = ( pMsg->pHave[last / 8] & ( 1 << ( last % 8 ) ) ) != 0;
+
+    if ( pMsg->pHave[index / 8] & mask )
+    {
+        result = EINPROGRESS;
+    }
+    else if ( len > REASM_MAX_SEGMENT )
+    {
+        result = EBADMSG;
+    }
+    else if ( ( index < last ) && ( pMsg->segSize == 0 ) )
+    {
+        /* learn the segment size from the first full segment */
+        if ( len == 0 )
+        {
+            result = EBADMSG;
+        }
+        else if ( pMsg->count > REASM_MAX_PAYLOAD / len )
+        {
+            result = E2BIG;
+        }
+        else
+        {
+            result = Reserve( pMsg, (size_t)pMsg->count * len );
+        }
+
+        if ( result == EOK )
+        {
+            pMsg->segSize = len;
+
+            if ( haveLast == true )
+            {
+                /* move the early last segment to its position */
+                if ( pMsg->lastLen > len )
+                {
+                    result = EBADMSG;
+                }
+                else
+                {
+                    memmove( &pMsg->pBuf[last * len],
+                             pMsg->pBuf,
+                             pMsg->lastLen );
+                }
+            }
+        }
+    }
+
+    if ( result != EOK )
+    {
+        /* the segment is not placed */
+    }
+    else if ( index < last )
+    {
+        if ( len != pMsg->segSize )
+        {
+            result = EBADMSG;
+        }
+        else
+        {
+            memcpy( &pMsg->pBuf[index * pMsg->segSize], pData, len );
+        }
+    }
+    else if ( pMsg->segSize != 0 )
+    {
+        if ( len > pMsg->segSize )
+        {
+            result = EBADMSG;
+        }
+        else
+        {
+            memcpy( &pMsg->pBuf[last * pMsg->segSize], pData, len );
+            pMsg->lastLen = len;
+        }
+    }
+    else
+    {
+        /* hold the last segment until the segment size is known */
+        result = Reserve( pMsg, len );
+        if ( result == EOK )
+        {
+            memcpy( pMsg->pBuf, pData, len );
+            pMsg->lastLen = len;
+        }
+    }
+
+    if ( result == EOK )
+    {
+        pMsg->pHave[index / 8] |= mask;
+        pMsg->received++;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  Reserve                                                                   */
+/*!
+    Make sure the reassembly buffer is large enough
+
+    The Reserve function grows the reassembly buffer of a payload slot,
+    keeping its content.  The buffer is never shrunk, so it is only
+    re-allocated while the payload sizes are growing.
+
+    @param[in]
+        pMsg
+            pointer to the payload slot
+
+    @param[in]
+        size
+            required size of the buffer
+
+    @retval EOK the buffer is large enough
+    @retval ENOMEM memory allocation failed
+
+==============================================================================*/
+static int Reserve( ReasmMessage *pMsg, size_t size )
+{
+    int result = EOK;
+    char *p;
+
+    if ( size > pMsg->bufSize )
+    {
+        p = realloc( pMsg->pBuf, size );
+        if ( p == NULL )
+        {
+            result = ENOMEM;
+        }
+        else
+        {
+            pMsg->pBuf = p;
+            pMsg->bufSize = size;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SameSource                                                                */
+/*!
+    Check if two source addresses are the same
+
+    @param[in]
+        pA
+            pointer to the first source address
+
+    @param[in]
+        pB
+            pointer to the second source address
+
+    @retval true the addresses and ports are the same
+    @retval false the addresses or ports differ
+
+==============================================================================*/
+static bool SameSource( const struct sockaddr *pA,
+                        const struct sockaddr_storage *pB )
+{
+    bool same = false;
+    const struct sockaddr_in *pA4;
+    const struct sockaddr_in *pB4;
+    const struct sockaddr_in6 *pA6;
+    const struct sockaddr_in6 *pB6;
+
+    if ( pA->sa_family != pB->ss_family )
+    {
+        same = false;
+    }
+    else if ( pA->sa_family == AF_INET6 )
+    {
+        pA6 = (const struct sockaddr_in6 *)pA;
+        pB6 = (const struct sockaddr_in6 *)pB;
+        same = ( pA6->sin6_port == pB6->sin6_port ) &&
+               ( memcmp( &pA6->sin6_addr,
+                         &pB6->sin6_addr,
+                         sizeof( struct in6_addr ) ) == 0 );
+    }
+    else
+    {
+        pA4 = (const struct sockaddr_in *)pA;
+        pB4 = (const struct sockaddr_in *)pB;
+        same = ( pA4->sin_port == pB4->sin_port ) &&
+               ( pA4->sin_addr.s_addr == pB4->sin_addr.s_addr );
+    }
+
+    return same;
+}
+
+/*! @}
+ * end of reasm group */
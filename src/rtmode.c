@@ -0,0 +1,626 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup rtmode Real-Time Mode
+ * @brief Deterministic scheduling of the transmissions
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file rtmode.c
+
+    Real-Time Mode
+
+    The rtmode component sets up the process for deterministic
+    transmission timing.  All of its memory is locked so the event loop
+    never waits for a page fault, the event loop and sender thread can
+    be pinned to dedicated CPUs, and they can be scheduled with the
+    SCHED_FIFO real-time policy so other tasks do not delay them.
+
+    When built with UDPT_RT_ALLOC_CHECK, every heap allocation made by
+    the process is counted, so the allocations made once the
+    transmissions have reached their steady state can be detected.  An
+    allocation on the steady state path may page fault, take a lock
+    shared with other threads, or fail, and adds to the tick jitter.
+    The counting replaces the allocator entry points of the C library
+    for the whole process, so it is a diagnostic build option and is
+    not enabled by default.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <varserver/varserver.h>
+#include "rtmode.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+#if defined( UDPT_RT_ALLOC_CHECK ) && defined( __GLIBC__ )
+/*! the heap allocations are counted */
+#define RTMODE_COUNT_ALLOCATIONS
+#endif
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+#ifdef RTMODE_COUNT_ALLOCATIONS
+/*! number of heap allocations made by the process */
+static atomic_uint_fast64_t allocations;
+#endif
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static void PrefaultStack( void );
+
+#ifdef RTMODE_COUNT_ALLOCATIONS
+extern void *__libc_malloc( size_t size );
+extern void *__libc_calloc( size_t nmemb, size_t size );
+extern void *__libc_realloc( void *ptr, size_t size );
+extern void *__libc_memalign( size_t alignment, size_t size );
+#endif
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  RTMODE_Init                                                               */
+/*!
+    Initialize the real-time mode
+
+    The RTMODE_Init function disables the real-time mode, with no CPU
+    affinity and the default scheduling policy.
+
+    @param[in]
+        pRt
+            pointer to the real-time mode to initialize
+
+==============================================================================*/
+void RTMODE_Init( RtMode *pRt )
+{
+    if ( pRt != NULL )
+    {
+        memset( pRt, 0, sizeof( RtMode ) );
+        CPU_ZERO( &pRt->loopCpus );
+        CPU_ZERO( &pRt->senderCpus );
+    }
+}
+
+/*============================================================================*/
+/*  RTMODE_ParseCpus                                                          */
+/*!
+    Parse a CPU list
+
+    The RTMODE_ParseCpus function parses a comma separated list of CPU
+    numbers and ranges, for example "2,4-7", into a CPU set.
+
+    @param[in]
+        spec
+            CPU list specification
+
+    @param[out]
+        pSet
+            pointer to the CPU set to populate
+
+    @retval EOK the CPU list was parsed
+    @retval EINVAL invalid CPU list
+
+==============================================================================*/
+int RTMODE_ParseCpus( const char *spec, cpu_set_t *pSet )
+{
+    int result = EINVAL;
+    const char *p = spec;
+    char *pEnd = NULL;
+    unsigned long first;
+    unsigned long last;
+
+    if ( ( spec != NULL ) &&
+         ( pSet != NULL ) )
+    {
+        CPU_ZERO( pSet );
+        result = EOK;
+    }
+
+    while ( ( result == EOK ) && ( *p != '\0' ) )
+    {
+        first = strtoul( p, &pEnd, 10 );
+        last = first;
+        if ( pEnd == p )
+        {
+            result = EINVAL;
+        }
+        else if ( *pEnd == '-' )
+        {
+            p = pEnd + 1;
+            last = strtoul( p, &pEnd, 10 );
+            if ( pEnd == p )
+            {
+                result = EINVAL;
+            }
+        }
+
+        if ( ( result == EOK ) &&
+             ( ( last < first ) ||
+               ( last >= CPU_SETSIZE ) ) )
+        {
+            result = EINVAL;
+        }
+
+        if ( result == EOK )
+        {
+            for ( ; first <= last; first++ )
+            {
+                CPU_SET( first, pSet );
+            }
+
+            if ( *pEnd == ',' )
+            {
+                pEnd++;
+            }
+            else if ( *pEnd != '\0' )
+            {
+                result = EINVAL;
+            }
+
+            p = pEnd;
+        }
+    }
+
+    if ( ( result == EOK ) &&
+         ( CPU_COUNT( pSet ) == 0 ) )
+    {
+        result = EINVAL;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RTMODE_Lock                                                               */
+/*!
+    Lock the process memory
+
+    The RTMODE_Lock function locks all of the current and future memory
+    of the process, and touches the stack of the calling thread so it
+    is mapped before the event loop runs.  The heap is kept from
+    returning freed memory to the kernel, or serving large allocations
+    from new mappings, so memory which is freed and allocated again
+    stays locked.
+
+    @param[in]
+        pRt
+            pointer to the real-time mode
+
+    @retval EOK the process memory is locked
+    @retval EINVAL invalid arguments
+    @retval other error from mlockall
+
+==============================================================================*/
+int RTMODE_Lock( RtMode *pRt )
+{
+    int result = EINVAL;
+
+    if ( pRt != NULL )
+    {
+        (void)mallopt( M_TRIM_THRESHOLD, -1 );
+        (void)mallopt( M_MMAP_MAX, 0 );
+
+        if ( mlockall( MCL_CURRENT | MCL_FUTURE ) == 0 )
+        {
+            PrefaultStack();
+            pRt->locked = true;
+            result = EOK;
+        }
+        else
+        {
+            result = errno;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RTMODE_SetupThread                                                        */
+/*!
+    Set the CPU affinity and scheduling policy of a thread
+
+    The RTMODE_SetupThread function pins a thread to a set of CPUs, and
+    schedules it with the SCHED_FIFO policy if a real-time priority is
+    configured.  An empty CPU set leaves the affinity of the thread
+    unchanged.
+
+    @param[in]
+        pRt
+            pointer to the real-time mode
+
+    @param[in]
+        thread
+            thread to set up
+
+    @param[in]
+        pCpus
+            pointer to the set of CPUs to run the thread on
+
+    @retval EOK the thread was set up
+    @retval EINVAL invalid arguments
+    @retval other error from pthread_setaffinity_np or
+            pthread_setschedparam
+
+==============================================================================*/
+int RTMODE_SetupThread( RtMode *pRt,
+                        pthread_t thread,
+                        const cpu_set_t *pCpus )
+{
+    int result = EINVAL;
+    struct sched_param param;
+
+    if ( ( pRt != NULL ) &&
+         ( pCpus != NULL ) )
+    {
+        result = EOK;
+
+        if ( CPU_COUNT( pCpus ) > 0 )
+        {
+            result = pthread_setaffinity_np( thread,
+                                             sizeof( cpu_set_t ),
+                                             pCpus );
+        }
+
+        if ( ( result == EOK ) &&
+             ( pRt->priority > 0 ) )
+        {
+            memset( &param, 0, sizeof( param ) );
+            param.sched_priority = pRt->priority;
+            result = pthread_setschedparam( thread, SCHED_FIFO, &param );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RTMODE_Arm                                                                */
+/*!
+    Enter the steady state
+
+    The RTMODE_Arm function marks the point at which every buffer the
+    transmissions need should have been allocated.  Heap allocations
+    made from now on are counted by RTMODE_Check.
+
+    @param[in]
+        pRt
+            pointer to the real-time mode
+
+==============================================================================*/
+void RTMODE_Arm( RtMode *pRt )
+{
+    if ( pRt != NULL )
+    {
+        pRt->baseline = RTMODE_Allocations();
+        pRt->armed = true;
+    }
+}
+
+/*============================================================================*/
+/*  RTMODE_Check                                                              */
+/*!
+    Check for heap allocations in the steady state
+
+    The RTMODE_Check function counts the heap allocations which have
+    been made since the steady state was entered, or since it was last
+    called, and adds them to the steady state allocation counter.
+
+    @param[in]
+        pRt
+            pointer to the real-time mode
+
+    @retval number of heap allocations since the last check
+
+==============================================================================*/
+uint64_t RTMODE_Check( RtMode *pRt )
+{
+    uint64_t count;
+    uint64_t n = 0;
+
+    if ( ( pRt != NULL ) &&
+         ( pRt->armed == true ) )
+    {
+        count = RTMODE_Allocations();
+        n = count - pRt->baseline;
+        pRt->allocs += n;
+        pRt->baseline = count;
+    }
+
+    return n;
+}
+
+/*============================================================================*/
+/*  RTMODE_Allocations                                                        */
+/*!
+    Get the number of heap allocations made by the process
+
+    The RTMODE_Allocations function gets the number of calls to
+    malloc(), calloc(), realloc(), memalign(), posix_memalign() and
+    aligned_alloc() made by all of the threads of the process, including
+    the calls made inside the C library and the variable server library.
+    The calls are only counted when built with UDPT_RT_ALLOC_CHECK and
+    the GNU C library, otherwise the count is always 0.
+
+    @retval number of heap allocations
+
+==============================================================================*/
+uint64_t RTMODE_Allocations( void )
+{
+#ifdef RTMODE_COUNT_ALLOCATIONS
+    return atomic_load_explicit( &allocations, memory_order_relaxed );
+#else
+    return 0;
+#endif
+}
+
+/*============================================================================*/
+/*  RTMODE_CountsAllocations                                                  */
+/*!
+    Check if the heap allocations are counted
+
+    @retval true the heap allocations are counted
+    @retval false the heap allocations are not counted
+
+==============================================================================*/
+bool RTMODE_CountsAllocations( void )
+{
+#ifdef RTMODE_COUNT_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef RTMODE_COUNT_ALLOCATIONS
+/*============================================================================*/
+/*  malloc                                                                    */
+/*!
+    Allocate memory
+
+    The malloc function counts the allocation and passes it to the
+    C library allocator.  The free functions of the C library are left
+    in place, since they share the same heap.
+
+    @param[in]
+        size
+            number of bytes to allocate
+
+    @retval pointer to the allocated memory
+    @retval NULL memory allocation failed
+
+==============================================================================*/
+void *malloc( size_t size )
+{
+    atomic_fetch_add_explicit( &allocations, 1, memory_order_relaxed );
+    return __libc_malloc( size );
+}
+
+/*============================================================================*/
+/*  calloc                                                                    */
+/*!
+    Allocate zeroed memory
+
+    The calloc function counts the allocation and passes it to the
+    C library allocator.
+
+    @param[in]
+        nmemb
+            number of elements to allocate
+
+    @param[in]
+        size
+            size of each element
+
+    @retval pointer to the allocated memory
+    @retval NULL memory allocation failed
+
+==============================================================================*/
+void *calloc( size_t nmemb, size_t size )
+{
+    atomic_fetch_add_explicit( &allocations, 1, memory_order_relaxed );
+    return __libc_calloc( nmemb, size );
+}
+
+/*============================================================================*/
+/*  realloc                                                                   */
+/*!
+    Resize allocated memory
+
+    The realloc function counts the allocation and passes it to the
+    C library allocator.
+
+    @param[in]
+        ptr
+            pointer to the memory to resize, or NULL
+
+    @param[in]
+        size
+            new size in bytes
+
+    @retval pointer to the resized memory
+    @retval NULL memory allocation failed
+
+==============================================================================*/
+void *realloc( void *ptr, size_t size )
+{
+    atomic_fetch_add_explicit( &allocations, 1, memory_order_relaxed );
+    return __libc_realloc( ptr, size );
+}
+
+/*============================================================================*/
+/*  memalign                                                                  */
+/*!
+    Allocate aligned memory
+
+    The memalign function counts the allocation and passes it to the
+    C library allocator.
+
+    @param[in]
+        alignment
+            alignment of the memory, a power of two
+
+    @param[in]
+        size
+            number of bytes to allocate
+
+    @retval pointer to the allocated memory
+    @retval NULL memory allocation failed
+
+==============================================================================*/
+void *memalign( size_t alignment, size_t size )
+{
+    atomic_fetch_add_explicit( &allocations, 1, memory_order_relaxed );
+    return __libc_memalign( alignment, size );
+}
+
+/*============================================================================*/
+/*  aligned_alloc                                                             */
+/*!
+    Allocate aligned memory
+
+    The aligned_alloc function counts the allocation and passes it to
+    the C library allocator.
+
+    @param[in]
+        alignment
+            alignment of the memory, a power of two
+
+    @param[in]
+        size
+            number of bytes to allocate
+
+    @retval pointer to the allocated memory
+    @retval NULL memory allocation failed
+
+==============================================================================*/
+void *aligned_alloc( size_t alignment, size_t size )
+{
+    atomic_fetch_add_explicit( &allocations, 1, memory_order_relaxed );
+    return __libc_memalign( alignment, size );
+}
+
+/*============================================================================*/
+/*  posix_memalign                                                            */
+/*!
+    Allocate aligned memory
+
+    The posix_memalign function checks the alignment, counts the
+    allocation and passes it to the C library allocator.
+
+    @param[out]
+        memptr
+            pointer to a location to store the allocated memory
+
+    @param[in]
+        alignment
+            alignment of the memory, a power of two multiple of
+            sizeof( void * )
+
+    @param[in]
+        size
+            number of bytes to allocate
+
+    @retval 0 the memory was allocated
+    @retval EINVAL invalid alignment
+    @retval ENOMEM memory allocation failed
+
+==============================================================================*/
+int posix_memalign( void **memptr, size_t alignment, size_t size )
+{
+    int result = EINVAL;
+    void *p;
+
+    if ( ( alignment != 0 ) &&
+         ( alignment % sizeof( void * ) == 0 ) &&
+         ( ( alignment & ( alignment - 1 ) ) == 0 ) )
+    {
+        atomic_fetch_add_explicit( &allocations, 1, memory_order_relaxed );
+        p = __libc_memalign( alignment, size );
+        if ( p == NULL )
+        {
+            result = ENOMEM;
+        }
+        else
+        {
+            *memptr = p;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+#endif
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  PrefaultStack                                                             */
+/*!
+    Map the stack of the calling thread
+
+    The PrefaultStack function touches RTMODE_STACK_PREFAULT bytes of
+    stack, so the pages are mapped and locked before they are needed.
+
+==============================================================================*/
+static void __attribute__((noinline)) PrefaultStack( void )
+{
+    volatile char stack[RTMODE_STACK_PREFAULT];
+    size_t i;
+
+    for ( i = 0; i < sizeof( stack ); i += 4096 )
+    {
+        stack[i] = 0;
+    }
+}
+
+/*! @}
+ * end of rtmode group */
@@ -0,0 +1,723 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup sockcache Interface Socket Cache
+ * @brief Cache of long-lived UDP sockets bound to network interfaces
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file sockcache.c
+
+    Interface Socket Cache
+
+    The sockcache component maintains one UDP broadcast socket per
+    interface and address family.  Sockets are created and bound to
+    their interface on first use, and are re-used for every subsequent
+    transmission until the interface disappears, the socket reports
+    a stale-interface error, or the cache is flushed.  The sockets are
+    also set up to send multicast datagrams out of their interface, and
+    to be paced by the kernel if their interface is paced.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <netinet/in.h>
+#include <net/if.h>
+#include <varserver/varserver.h>
+#include "sockcache.h"
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static int OpenSocket( SockCache *pCache,
+                       const char *ifname,
+                       int family,
+                       int *pFd );
+static int BindInterface( int s, const char *ifname );
+static void SetMulticast( SockCache *pCache,
+                          int s,
+                          const char *ifname,
+                          int family );
+static void CloseEntry( SockCache *pCache, size_t idx );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  SOCKCACHE_Init                                                            */
+/*!
+    Initialize a socket cache
+
+    The SOCKCACHE_Init function initializes an empty socket cache.
+    Multicast datagrams are limited to the local network, and looped
+    back to local receivers, until changed by SOCKCACHE_SetMulticast.
+
+    @param[in]
+        pCache
+            pointer to the socket cache to initialize
+
+==============================================================================*/
+void SOCKCACHE_Init( SockCache *pCache )
+{
+    if ( pCache != NULL )
+    {
+        memset( pCache, 0, sizeof( SockCache ) );
+        pCache->mcastHops = 1;
+        pCache->mcastLoop = true;
+    }
+}
+
+/*============================================================================*/
+/*  SOCKCACHE_SetMulticast                                                    */
+/*!
+    Set the multicast options of the cached sockets
+
+    The SOCKCACHE_SetMulticast function sets the multicast TTL (IPv4) or
+    hop limit (IPv6), and the multicast loopback option, applied to
+    sockets created from now on.  It is intended to be called before
+    the first socket is created.
+
+    @param[in]
+        pCache
+            pointer to the socket cache
+
+    @param[in]
+        hops
+            multicast TTL or hop limit (1 to 255)
+
+    @param[in]
+        loop
+            true to loop multicast datagrams back to local receivers
+
+==============================================================================*/
+void SOCKCACHE_SetMulticast( SockCache *pCache, int hops, bool loop )
+{
+    if ( ( pCache != NULL ) &&
+         ( hops > 0 ) &&
+         ( hops <= 255 ) )
+    {
+        pCache->mcastHops = hops;
+        pCache->mcastLoop = loop;
+    }
+}
+
+/*============================================================================*/
+/*  SOCKCACHE_SetPacing                                                       */
+/*!
+    Set the pacing table of the cached sockets
+
+    The SOCKCACHE_SetPacing function sets the pacing table whose kernel
+    pacing options (SO_MAX_PACING_RATE or SO_TXTIME) are set on sockets
+    created from now on.  It is intended to be called before the first
+    socket is created.
+
+    @param[in]
+        pCache
+            pointer to the socket cache
+
+    @param[in]
+        pPacing
+            pointer to the pacing table, or NULL to not pace the sockets
+
+==============================================================================*/
+void SOCKCACHE_SetPacing( SockCache *pCache, Pacing *pPacing )
+{
+    if ( pCache != NULL )
+    {
+        pCache->pPacing = pPacing;
+    }
+}
+
+/*============================================================================*/
+/*  SOCKCACHE_SetTxStamp                                                      */
+/*!
+    Set the transmit timestamp tracker of the cached sockets
+
+    The SOCKCACHE_SetTxStamp function sets the transmit timestamp
+    tracker which enables timestamping on sockets created from now on,
+    and stops tracking them when they are closed.  It is intended to be
+    called before the first socket is created.
+
+    @param[in]
+        pCache
+            pointer to the socket cache
+
+    @param[in]
+        pTxStamp
+            pointer to the transmit timestamp tracker, or NULL to not
+            timestamp the sockets
+
+==============================================================================*/
+void SOCKCACHE_SetTxStamp( SockCache *pCache, TxStamp *pTxStamp )
+{
+    if ( pCache != NULL )
+    {
+        pCache->pTxStamp = pTxStamp;
+    }
+}
+
+/*============================================================================*/
+/*  SOCKCACHE_Get                                                             */
+/*!
+    Get a socket bound to the specified interface
+
+    The SOCKCACHE_Get function looks up the socket for the specified
+    interface and address family.  If no socket exists yet, a new
+    broadcast socket is created, bound to the interface, and added to
+    the cache.  The cache entry is marked as seen for the current pass.
+
+    @param[in]
+        pCache
+            pointer to the socket cache
+
+    @param[in]
+        ifname
+            name of the interface to get the socket for
+
+    @param[in]
+        family
+            address family of the socket (AF_INET or AF_INET6)
+
+    @param[out]
+        pFd
+            pointer to a location to store the socket file descriptor
+
+    @retval EOK the socket was retrieved
+    @retval ENOSPC the socket cache is full
+    @retval EINVAL invalid arguments
+    @retval other error from socket or setsockopt
+
+==============================================================================*/
+int SOCKCACHE_Get( SockCache *pCache,
+                   const char *ifname,
+                   int family,
+                   int *pFd )
+{
+    int result = EINVAL;
+    SockCacheEntry *pEntry;
+    size_t i;
+    int fd = -1;
+
+    if ( ( pCache != NULL ) &&
+         ( ifname != NULL ) &&
+         ( pFd != NULL ) )
+    {
+        result = ENOENT;
+        for ( i = 0; ( i < pCache->n ) && ( result == ENOENT ); i++ )
+        {
+            pEntry = &pCache->entries[i];
+            if ( ( pEntry->family == family ) &&
+                 ( strcmp( pEntry->ifname, ifname ) == 0 ) )
+            {
+                pEntry->seen = true;
+                *pFd = pEntry->fd;
+                result = EOK;
+            }
+        }
+
+        if ( ( result == ENOENT ) &&
+             ( pCache->n < SOCKCACHE_MAX_ENTRIES ) )
+        {
+            result = OpenSocket( pCache, ifname, family, &fd );
+            if ( result == EOK )
+            {
+                pEntry = &pCache->entries[pCache->n++];
+                snprintf( pEntry->ifname, sizeof( pEntry->ifname ), "%s", ifname );
+                pEntry->family = family;
+                pEntry->fd = fd;
+                pEntry->seen = true;
+                *pFd = fd;
+            }
+        }
+        else if ( result == ENOENT )
+        {
+            result = ENOSPC;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SOCKCACHE_BeginPass                                                       */
+/*!
+    Start a send pass over the available interfaces
+
+    The SOCKCACHE_BeginPass function clears the seen marker on all
+    cached sockets.  Sockets which are not retrieved via SOCKCACHE_Get
+    or marked via SOCKCACHE_Touch before SOCKCACHE_EndPass is called
+    will be closed.
+
+    @param[in]
+        pCache
+            pointer to the socket cache
+
+==============================================================================*/
+void SOCKCACHE_BeginPass( SockCache *pCache )
+{
+    size_t i;
+
+    if ( pCache != NULL )
+    {
+        for ( i = 0; i < pCache->n; i++ )
+        {
+            pCache->entries[i].seen = false;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  SOCKCACHE_Touch                                                           */
+/*!
+    Mark an interface socket as seen without creating it
+
+    The SOCKCACHE_Touch function marks the cached socket for the specified
+    interface and address family as seen for the current pass, so it is
+    kept open by SOCKCACHE_EndPass.  No socket is created if one is not
+    already cached.
+
+    @param[in]
+        pCache
+            pointer to the socket cache
+
+    @param[in]
+        ifname
+            name of the interface to mark
+
+    @param[in]
+        family
+            address family of the socket (AF_INET or AF_INET6)
+
+==============================================================================*/
+void SOCKCACHE_Touch( SockCache *pCache, const char *ifname, int family )
+{
+    size_t i;
+
+    if ( ( pCache != NULL ) &&
+         ( ifname != NULL ) )
+    {
+        for ( i = 0; i < pCache->n; i++ )
+        {
+            if ( ( pCache->entries[i].family == family ) &&
+                 ( strcmp( pCache->entries[i].ifname, ifname ) == 0 ) )
+            {
+                pCache->entries[i].seen = true;
+                break;
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  SOCKCACHE_EndPass                                                         */
+/*!
+    Complete a send pass over the available interfaces
+
+    The SOCKCACHE_EndPass function closes all the sockets whose interface
+    was not seen during the current pass, since the interface has either
+    gone away or is no longer allowed.
+
+    @param[in]
+        pCache
+            pointer to the socket cache
+
+==============================================================================*/
+void SOCKCACHE_EndPass( SockCache *pCache )
+{
+    size_t i = 0;
+
+    if ( pCache != NULL )
+    {
+        while ( i < pCache->n )
+        {
+            if ( pCache->entries[i].seen == false )
+            {
+                /* the last entry is moved into this slot, so do
+                   not advance the index */
+                CloseEntry( pCache, i );
+            }
+            else
+            {
+                i++;
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  SOCKCACHE_Invalidate                                                      */
+/*!
+    Invalidate a cached socket
+
+    The SOCKCACHE_Invalidate function closes the specified socket and
+    removes it from the cache so it will be re-created on next use.
+
+    @param[in]
+        pCache
+            pointer to the socket cache
+
+    @param[in]
+        fd
+            the socket file descriptor to invalidate
+
+==============================================================================*/
+void SOCKCACHE_Invalidate( SockCache *pCache, int fd )
+{
+    size_t i;
+
+    if ( pCache != NULL )
+    {
+        for ( i = 0; i < pCache->n; i++ )
+        {
+            if ( pCache->entries[i].fd == fd )
+            {
+                CloseEntry( pCache, i );
+                break;
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  SOCKCACHE_Flush                                                           */
+/*!
+    Close all cached sockets
+
+    The SOCKCACHE_Flush function closes all of the cached sockets.
+    This is used when the interface allow-list changes, or on shutdown.
+
+    @param[in]
+        pCache
+            pointer to the socket cache
+
+==============================================================================*/
+void SOCKCACHE_Flush( SockCache *pCache )
+{
+    if ( pCache != NULL )
+    {
+        while ( pCache->n > 0 )
+        {
+            CloseEntry( pCache, pCache->n - 1 );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  SOCKCACHE_IsStale                                                         */
+/*!
+    Check if a send error indicates a stale socket
+
+    The SOCKCACHE_IsStale function checks if the specified send error
+    indicates that the socket's bound interface has gone away and the
+    socket should be re-created.
+
+    @param[in]
+        err
+            errno value returned from a failed send
+
+    @retval true the socket should be invalidated
+    @retval false the socket is still usable
+
+==============================================================================*/
+bool SOCKCACHE_IsStale( int err )
+{
+    return ( err == ENODEV ) ||
+           ( err == ENXIO ) ||
+           ( err == EBADF ) ||
+           ( err == ENOTCONN );
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  OpenSocket                                                                */
+/*!
+    Open a broadcast socket bound to an interface
+
+    The OpenSocket function creates a UDP socket, binds it to the
+    specified interface, enables broadcast on it, and sets it up to
+    send multicast datagrams out of the interface.  If the interface is
+    paced by the kernel, its pacing option is set on the socket.  A
+    pacing option which the kernel rejects makes the interface fall
+    back to user space pacing, so it does not fail the socket.
+    Likewise, transmit timestamps are enabled if they were requested,
+    but a socket which cannot be timestamped is still used.  A socket
+    which cannot be bound to the interface, for example because the
+    process lacks CAP_NET_RAW, is reported and used unbound.
+
+    @param[in]
+        pCache
+            pointer to the socket cache
+
+    @param[in]
+        ifname
+            name of the interface to bind to
+
+    @param[in]
+        family
+            address family
+
+    @param[out]
+        pFd
+            pointer to a location to store the new socket
+
+    @retval EOK the socket was created
+    @retval other error from socket or setsockopt
+
+==============================================================================*/
+static int OpenSocket( SockCache *pCache,
+                       const char *ifname,
+                       int family,
+                       int *pFd )
+{
+    int result;
+    int broadcast = 1;
+    int fd;
+
+    fd = socket( family, SOCK_DGRAM | SOCK_CLOEXEC, 0 );
+    if ( fd != -1 )
+    {
+        /* bind the UDP output to a specific interface.  Without the
+           privilege to do so the datagrams are sent unbound, following
+           the routing table, for as long as the socket is cached */
+        result = BindInterface( fd, ifname );
+        if ( result != EOK )
+        {
+            fprintf( stderr,
+                     "Failed to bind socket to %s: %s, sending unbound\n",
+                     ifname,
+                     strerror( result ) );
+        }
+
+        /* set up socket to broadcast */
+        if ( setsockopt( fd,
+                         SOL_SOCKET,
+                         SO_BROADCAST,
+                         &broadcast,
+                         sizeof(broadcast)) != -1 )
+        {
+            SetMulticast( pCache, fd, ifname, family );
+
+            (void)PACING_SetupSocket( PACING_Find( pCache->pPacing, ifname ),
+                                      fd );
+
+            if ( pCache->pTxStamp != NULL )
+            {
+                (void)TXSTAMP_Open( pCache->pTxStamp, fd, ifname );
+            }
+
+            *pFd = fd;
+            result = EOK;
+        }
+        else
+        {
+            result = errno;
+            close( fd );
+        }
+    }
+    else
+    {
+        result = errno;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  BindInterface                                                             */
+/*!
+    Bind a socket to a specific interface
+
+    The BindInterface function binds a socket to a specific interface so that
+    any output on that socket is sent only on the specifically bound interface.
+    This function is platform specific and currently only implemented for
+    Linux.
+
+    @param[in]
+        s
+            socket to bind
+
+    @param[in]
+        ifname
+            name of the interface to bind to
+
+    @retval EOK socket bound ok
+    @retval EINVAL invalid arguments
+    @retval other error from setsockopt
+
+==============================================================================*/
+static int BindInterface( int s, const char *ifname )
+{
+    int result = EINVAL;
+
+    if ( ( s >= 0 ) &&
+         ( ifname != NULL ) )
+    {
+#ifdef __linux__
+        struct ifreq ifr;
+        int rc;
+
+        memset(&ifr, 0, sizeof(ifr));
+        snprintf(ifr.ifr_name, sizeof(ifr.ifr_name), "%s", ifname);
+
+        rc = setsockopt( s,
+                         SOL_SOCKET,
+                         SO_BINDTODEVICE,
+                         (void *)&ifr,
+                         sizeof(ifr) );
+        if ( rc == 0 )
+        {
+            result = EOK;
+        }
+        else
+        {
+            result = errno;
+        }
+#else
+        result = ENOTSUP;
+#endif
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CloseEntry                                                                */
+/*!
+    Close and remove a socket cache entry
+
+    The CloseEntry function closes the socket at the specified index and
+    moves the last entry of the cache into its slot.
+
+    @param[in]
+        pCache
+            pointer to the socket cache
+
+    @param[in]
+        idx
+            index of the entry to remove
+
+==============================================================================*/
+static void CloseEntry( SockCache *pCache, size_t idx )
+{
+    if ( idx < pCache->n )
+    {
+        if ( pCache->pTxStamp != NULL )
+        {
+            TXSTAMP_Close( pCache->pTxStamp, pCache->entries[idx].fd );
+        }
+
+        close( pCache->entries[idx].fd );
+
+        pCache->n--;
+        if ( idx != pCache->n )
+        {
+            pCache->entries[idx] = pCache->entries[pCache->n];
+        }
+
+        memset( &pCache->entries[pCache->n], 0, sizeof( SockCacheEntry ) );
+    }
+}
+
+/*============================================================================*/
+/*  SetMulticast                                                              */
+/*!
+    Set up a socket to send multicast datagrams
+
+    The SetMulticast function selects the interface multicast datagrams
+    are sent out of, and sets their TTL or hop limit and loopback.
+    Failures are ignored, since the socket can still be used for
+    broadcast and unicast datagrams.
+
+    @param[in]
+        pCache
+            pointer to the socket cache holding the multicast options
+
+    @param[in]
+        s
+            socket to set up
+
+    @param[in]
+        ifname
+            name of the interface to send multicast datagrams out of
+
+    @param[in]
+        family
+            address family of the socket
+
+==============================================================================*/
+static void SetMulticast( SockCache *pCache,
+                          int s,
+                          const char *ifname,
+                          int family )
+{
+    struct ip_mreqn mreq;
+    int ifindex = (int)if_nametoindex( ifname );
+    int hops = pCache->mcastHops;
+    int loop4 = ( pCache->mcastLoop == true ) ? 1 : 0;
+    unsigned int loop6 = ( pCache->mcastLoop == true ) ? 1 : 0;
+
+    if ( family == AF_INET )
+    {
+        memset( &mreq, 0, sizeof( mreq ) );
+        mreq.imr_ifindex = ifindex;
+
+        (void)setsockopt( s, IPPROTO_IP, IP_MULTICAST_IF,
+                          &mreq, sizeof( mreq ) );
+        (void)setsockopt( s, IPPROTO_IP, IP_MULTICAST_TTL,
+                          &hops, sizeof( hops ) );
+        (void)setsockopt( s, IPPROTO_IP, IP_MULTICAST_LOOP,
+                          &loop4, sizeof( loop4 ) );
+    }
+    else if ( family == AF_INET6 )
+    {
+        (void)setsockopt( s, IPPROTO_IPV6, IPV6_MULTICAST_IF,
+                          &ifindex, sizeof( ifindex ) );
+        (void)setsockopt( s, IPPROTO_IPV6, IPV6_MULTICAST_HOPS,
+                          &hops, sizeof( hops ) );
+        (void)setsockopt( s, IPPROTO_IPV6, IPV6_MULTICAST_LOOP,
+                          &loop6, sizeof( loop6 ) );
+    }
+}
+
+/*! @}
+ * end of sockcache group */
@@ -0,0 +1,809 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup sublist Subscriber List
+ * @brief List of unicast subscribers with per-subscriber error backoff
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file sublist.c
+
+    Subscriber List
+
+    The sublist component maintains a list of unicast destinations a
+    channel's payloads are sent to, for receivers which cannot be
+    reached by broadcast or multicast, for example because they are
+    behind a router.  The list is parsed from a comma or white space
+    separated set of address:port entries, or from a file containing them,
+    into an array of socket addresses allocated once.
+
+    Errors reported for a subscriber, for example an ICMP port or host
+    unreachable error, put it into an exponential backoff during which
+    it is skipped, so hosts which are down do not cost the rest of the
+    fan-out a system call and an ICMP error per transmission.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#include <varserver/varserver.h>
+#include "sublist.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! separators between subscriber entries */
+#define SUBLIST_SEPARATORS ", \t\r\n"
+
+/*! maximum length of a line of a subscriber file */
+#define SUBLIST_LINE_LEN ( 256 )
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static int ParseList( SubList *pList, char *pText );
+static int ParseFile( SubList *pList, const char *filename );
+static int ParseEntry( const char *text, Subscriber *pSub );
+static uint16_t GetPort( const struct sockaddr_storage *pAddr );
+static void SetPort( struct sockaddr_storage *pAddr, uint16_t port );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  SUBLIST_Parse                                                             */
+/*!
+    Parse a subscriber list
+
+    The SUBLIST_Parse function replaces the subscribers in the list with
+    the ones in the specification.  The specification is either a comma
+    or white space separated list of address:port entries, or the name
+    of a file (starting with '/') containing such entries, where '#'
+    starts a comment.  IPv6 addresses with a port are written in
+    brackets, for example [fd00::1]:5000.  If the port is omitted, the
+    channel port is used.  Only numeric addresses are accepted, so
+    parsing the list never waits for a host name lookup.
+
+    Invalid entries are reported and skipped.
+
+    @param[in]
+        pList
+            pointer to the subscriber list
+
+    @param[in]
+        spec
+            subscriber list specification
+
+    @retval EOK the subscriber list was parsed
+    @retval EINVAL one or more entries were invalid
+    @retval ENOSPC the list was truncated at SUBLIST_MAX_ENTRIES
+    @retval ENOMEM memory allocation failed
+    @retval other error from fopen
+
+==============================================================================*/
+int SUBLIST_Parse( SubList *pList, const char *spec )
+{
+    int result = EINVAL;
+    char *pText;
+
+    if ( ( pList != NULL ) &&
+         ( spec != NULL ) )
+    {
+        pList->n = 0;
+        result = EOK;
+
+        if ( spec[0] != '\0' )
+        {
+            result = SUBLIST_Reserve( pList );
+        }
+
+        if ( ( result == EOK ) &&
+             ( spec[0] == '/' ) )
+        {
+            result = ParseFile( pList, spec );
+        }
+        else if ( ( result == EOK ) &&
+                  ( spec[0] != '\0' ) )
+        {
+            /* make a mutable copy of the list */
+            pText = strdup( spec );
+            result = ( pText != NULL ) ? ParseList( pList, pText ) : ENOMEM;
+            free( pText );
+        }
+
+        SUBLIST_ResolveSources( pList );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SUBLIST_Reserve                                                           */
+/*!
+    Allocate the entries of a subscriber list
+
+    The SUBLIST_Reserve function allocates the SUBLIST_MAX_ENTRIES
+    subscriber entries of the list, if they have not been allocated
+    already.  The entries are otherwise allocated when the first
+    non-empty list is parsed.
+
+    @param[in]
+        pList
+            pointer to the subscriber list
+
+    @retval EOK the entries are allocated
+    @retval ENOMEM memory allocation failed
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int SUBLIST_Reserve( SubList *pList )
+{
+    int result = EINVAL;
+
+    if ( pList != NULL )
+    {
+        result = EOK;
+        if ( pList->entries == NULL )
+        {
+            pList->entries = calloc( SUBLIST_MAX_ENTRIES,
+                                     sizeof( Subscriber ) );
+            if ( pList->entries == NULL )
+            {
+                result = ENOMEM;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SUBLIST_ResolveSources                                                    */
+/*!
+    Find the local address used to reach each subscriber
+
+    The SUBLIST_ResolveSources function asks the kernel which local
+    address it would send from to reach each subscriber, so it can be
+    reported as the source IP address in the payloads sent to it.  It
+    should be called again when the network interfaces change.
+
+    @param[in]
+        pList
+            pointer to the subscriber list
+
+==============================================================================*/
+void SUBLIST_ResolveSources( SubList *pList )
+{
+    struct sockaddr_storage addr;
+    struct sockaddr_storage local;
+    socklen_t len;
+    Subscriber *pSub;
+    size_t i;
+    int fd;
+
+    for ( i = 0; ( pList != NULL ) && ( i < pList->n ); i++ )
+    {
+        pSub = &pList->entries[i];
+        pSub->source[0] = '\0';
+
+        memcpy( &addr, &pSub->addr, sizeof( addr ) );
+        if ( GetPort( &addr ) == 0 )
+        {
+            /* any port will do for the route lookup */
+            SetPort( &addr, 9 );
+        }
+
+        /* connecting a UDP socket selects the route and source address
+           without sending anything */
+        fd = socket( addr.ss_family, SOCK_DGRAM | SOCK_CLOEXEC, 0 );
+        if ( fd != -1 )
+        {
+            len = sizeof( local );
+            if ( ( connect( fd,
+                            (struct sockaddr *)&addr,
+                            pSub->addrlen ) == 0 ) &&
+                 ( getsockname( fd,
+                                (struct sockaddr *)&local,
+                                &len ) == 0 ) &&
+                 ( getnameinfo( (struct sockaddr *)&local,
+                                len,
+                                pSub->source,
+                                sizeof( pSub->source ),
+                                NULL,
+                                0,
+                                NI_NUMERICHOST ) != 0 ) )
+            {
+                pSub->source[0] = '\0';
+            }
+
+            close( fd );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  SUBLIST_Find                                                              */
+/*!
+    Find the subscriber with the specified address
+
+    The SUBLIST_Find function finds the subscriber whose destination
+    address matches the specified address, for example the destination
+    of a datagram reported in a socket error queue.
+
+    @param[in]
+        pList
+            pointer to the subscriber list
+
+    @param[in]
+        pAddr
+            pointer to the address to look up
+
+    @param[in]
+        defaultPort
+            port of subscribers whose port was not specified
+
+    @retval pointer to the subscriber
+    @retval NULL no subscriber has the specified address
+
+==============================================================================*/
+Subscriber *SUBLIST_Find( SubList *pList,
+                          const struct sockaddr *pAddr,
+                          uint16_t defaultPort )
+{
+    const struct sockaddr_in *pIn4 = (const struct sockaddr_in *)pAddr;
+    const struct sockaddr_in6 *pIn6 = (const struct sockaddr_in6 *)pAddr;
+    struct sockaddr_in *pSub4;
+    struct sockaddr_in6 *pSub6;
+    Subscriber *pFound = NULL;
+    Subscriber *pSub;
+    uint16_t port;
+    size_t i;
+
+    for ( i = 0;
+          ( pList != NULL ) &&
+          ( pAddr != NULL ) &&
+          ( i < pList->n ) &&
+          ( pFound == NULL );
+          i++ )
+    {
+        pSub = &pList->entries[i];
+
+        port = GetPort( &pSub->addr );
+        port = ( port != 0 ) ? port : defaultPort;
+
+        if ( pSub->addr.ss_family != pAddr->sa_family )
+        {
+            /* different address family */
+        }
+        else if ( pAddr->sa_family == AF_INET )
+        {
+            pSub4 = (struct sockaddr_in *)&pSub->addr;
+            if ( ( ntohs( pIn4->sin_port ) == port ) &&
+                 ( pIn4->sin_addr.s_addr == pSub4->sin_addr.s_addr ) )
+            {
+                pFound = pSub;
+            }
+        }
+        else if ( pAddr->sa_family == AF_INET6 )
+        {
+            pSub6 = (struct sockaddr_in6 *)&pSub->addr;
+            if ( ( ntohs( pIn6->sin6_port ) == port ) &&
+                 ( memcmp( &pIn6->sin6_addr,
+                           &pSub6->sin6_addr,
+                           sizeof( struct in6_addr ) ) == 0 ) )
+            {
+                pFound = pSub;
+            }
+        }
+    }
+
+    return pFound;
+}
+
+/*============================================================================*/
+/*  SUBLIST_GetAddr                                                           */
+/*!
+    Get the destination address of a subscriber
+
+    The SUBLIST_GetAddr function gets the destination address datagrams
+    are sent to for the subscriber, using the default port if the
+    subscriber entry did not specify one.
+
+    @param[in]
+        pSub
+            pointer to the subscriber
+
+    @param[in]
+        defaultPort
+            port to use if the subscriber has none
+
+    @param[out]
+        pAddr
+            pointer to the location to store the destination address
+
+==============================================================================*/
+void SUBLIST_GetAddr( Subscriber *pSub,
+                      uint16_t defaultPort,
+                      struct sockaddr_storage *pAddr )
+{
+    if ( ( pSub != NULL ) &&
+         ( pAddr != NULL ) )
+    {
+        memcpy( pAddr, &pSub->addr, sizeof( struct sockaddr_storage ) );
+        if ( GetPort( pAddr ) == 0 )
+        {
+            SetPort( pAddr, defaultPort );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  SUBLIST_Ready                                                             */
+/*!
+    Check if a subscriber should be sent to
+
+    The SUBLIST_Ready function checks if the subscriber is not backing
+    off after an error.
+
+    @param[in]
+        pSub
+            pointer to the subscriber
+
+    @param[in]
+        now_ns
+            current monotonic time in nanoseconds
+
+    @retval true the subscriber should be sent to
+    @retval false the subscriber is backing off
+
+==============================================================================*/
+bool SUBLIST_Ready( Subscriber *pSub, uint64_t now_ns )
+{
+    return ( pSub != NULL ) && ( pSub->retry_ns <= now_ns );
+}
+
+/*============================================================================*/
+/*  SUBLIST_Failure                                                           */
+/*!
+    Record an error reported for a subscriber
+
+    The SUBLIST_Failure function records an error for the subscriber
+    and starts a backoff, which doubles with every consecutive error up
+    to SUBLIST_BACKOFF_MAX_NS.  Since a UDP send never confirms that a
+    datagram arrived, the error count is only reset once no error has
+    been reported for twice the longest backoff.  Errors reported for
+    datagrams sent before the backoff started do not extend it.
+
+    @param[in]
+        pSub
+            pointer to the subscriber
+
+    @param[in]
+        err
+            error reported for the subscriber
+
+    @param[in]
+        now_ns
+            current monotonic time in nanoseconds
+
+==============================================================================*/
+void SUBLIST_Failure( Subscriber *pSub, int err, uint64_t now_ns )
+{
+    uint64_t backoff_ns = SUBLIST_BACKOFF_MIN_NS;
+    uint32_t i;
+
+    if ( pSub != NULL )
+    {
+        pSub->errcount++;
+        pSub->lastError = err;
+
+        if ( now_ns >= pSub->retry_ns )
+        {
+            if ( now_ns - pSub->failure_ns > 2 * SUBLIST_BACKOFF_MAX_NS )
+            {
+                /* the subscriber has recovered since its last error */
+                pSub->failures = 0;
+            }
+
+            pSub->failures++;
+
+            for ( i = 1;
+                  ( i < pSub->failures ) &&
+                  ( backoff_ns < SUBLIST_BACKOFF_MAX_NS );
+                  i++ )
+            {
+                backoff_ns *= 2;
+            }
+
+            if ( backoff_ns > SUBLIST_BACKOFF_MAX_NS )
+            {
+                backoff_ns = SUBLIST_BACKOFF_MAX_NS;
+            }
+
+            pSub->retry_ns = now_ns + backoff_ns;
+        }
+
+        pSub->failure_ns = now_ns;
+    }
+}
+
+/*============================================================================*/
+/*  SUBLIST_CountBackoff                                                      */
+/*!
+    Count the subscribers which are backing off
+
+    The SUBLIST_CountBackoff function counts the subscribers which are
+    currently being skipped after an error.
+
+    @param[in]
+        pList
+            pointer to the subscriber list
+
+    @param[in]
+        now_ns
+            current monotonic time in nanoseconds
+
+    @retval number of subscribers backing off
+
+==============================================================================*/
+size_t SUBLIST_CountBackoff( SubList *pList, uint64_t now_ns )
+{
+    size_t count = 0;
+    size_t i;
+
+    for ( i = 0; ( pList != NULL ) && ( i < pList->n ); i++ )
+    {
+        if ( pList->entries[i].retry_ns > now_ns )
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/*============================================================================*/
+/*  SUBLIST_Free                                                              */
+/*!
+    Free a subscriber list
+
+    The SUBLIST_Free function releases the subscriber entries, leaving
+    an empty list.
+
+    @param[in]
+        pList
+            pointer to the subscriber list
+
+==============================================================================*/
+void SUBLIST_Free( SubList *pList )
+{
+    if ( pList != NULL )
+    {
+        free( pList->entries );
+        pList->entries = NULL;
+        pList->n = 0;
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  ParseList                                                                 */
+/*!
+    Parse a list of subscriber entries
+
+    The ParseList function adds each comma or white space separated
+    subscriber entry in the text to the list.
+
+    @param[in]
+        pList
+            pointer to the subscriber list
+
+    @param[in]
+        pText
+            mutable subscriber list text
+
+    @retval EOK the entries were added
+    @retval EINVAL one or more entries were invalid
+    @retval ENOSPC the list is full
+
+==============================================================================*/
+static int ParseList( SubList *pList, char *pText )
+{
+    int result = EOK;
+    char *saveptr = NULL;
+    char *token;
+
+    for ( token = strtok_r( pText, SUBLIST_SEPARATORS, &saveptr );
+          ( token != NULL ) && ( result != ENOSPC );
+          token = strtok_r( NULL, SUBLIST_SEPARATORS, &saveptr ) )
+    {
+        if ( pList->n >= SUBLIST_MAX_ENTRIES )
+        {
+            fprintf( stderr, "Too many subscribers, ignoring %s\n", token );
+            result = ENOSPC;
+        }
+        else if ( ParseEntry( token, &pList->entries[pList->n] ) == EOK )
+        {
+            pList->n++;
+        }
+        else
+        {
+            fprintf( stderr, "Invalid subscriber: %s\n", token );
+            result = EINVAL;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseFile                                                                 */
+/*!
+    Parse a file of subscriber entries
+
+    The ParseFile function adds the subscriber entries on each line of
+    the file to the list.  Text from a '#' to the end of the line is
+    ignored.
+
+    @param[in]
+        pList
+            pointer to the subscriber list
+
+    @param[in]
+        filename
+            name of the subscriber file
+
+    @retval EOK the entries were added
+    @retval EINVAL one or more entries were invalid
+    @retval ENOSPC the list is full
+    @retval other error from fopen
+
+==============================================================================*/
+static int ParseFile( SubList *pList, const char *filename )
+{
+    int result = EOK;
+    char line[SUBLIST_LINE_LEN];
+    char *pComment;
+    FILE *fp;
+    int rc;
+
+    fp = fopen( filename, "r" );
+    if ( fp == NULL )
+    {
+        result = errno;
+    }
+    else
+    {
+        while ( ( result != ENOSPC ) &&
+                ( fgets( line, sizeof( line ), fp ) != NULL ) )
+        {
+            pComment = strchr( line, '#' );
+            if ( pComment != NULL )
+            {
+                *pComment = '\0';
+            }
+
+            rc = ParseList( pList, line );
+            if ( rc != EOK )
+            {
+                result = rc;
+            }
+        }
+
+        fclose( fp );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseEntry                                                                */
+/*!
+    Parse a subscriber entry
+
+    The ParseEntry function parses an address, address:port,
+    [ipv6]:port or bare IPv6 address entry.  The address must be
+    numeric, host names are not looked up.
+
+    @param[in]
+        text
+            subscriber entry
+
+    @param[out]
+        pSub
+            pointer to the subscriber to initialize
+
+    @retval EOK the entry was parsed
+    @retval EINVAL the entry is invalid or not a numeric address
+
+==============================================================================*/
+static int ParseEntry( const char *text, Subscriber *pSub )
+{
+    int result = EINVAL;
+    char host[SUBLIST_NAME_LEN];
+    struct addrinfo hints;
+    struct addrinfo *pInfo = NULL;
+    const char *pPort = NULL;
+    const char *pEnd;
+    unsigned long port = 0;
+    char *pLast = NULL;
+    size_t len;
+
+    len = strlen( text );
+    if ( len >= sizeof( host ) )
+    {
+        /* the entry is too long */
+    }
+    else if ( text[0] == '[' )
+    {
+        /* [ipv6] or [ipv6]:port */
+        pEnd = strchr( text, ']' );
+        if ( ( pEnd != NULL ) &&
+             ( ( pEnd[1] == '\0' ) || ( pEnd[1] == ':' ) ) )
+        {
+            len = (size_t)( pEnd - text - 1 );
+            memcpy( host, &text[1], len );
+            host[len] = '\0';
+            pPort = ( pEnd[1] == ':' ) ? &pEnd[2] : NULL;
+            result = EOK;
+        }
+    }
+    else
+    {
+        memcpy( host, text, len + 1 );
+
+        /* a single colon separates the port, more make an IPv6 address */
+        pEnd = strchr( host, ':' );
+        if ( ( pEnd != NULL ) &&
+             ( strchr( pEnd + 1, ':' ) == NULL ) )
+        {
+            host[pEnd - host] = '\0';
+            pPort = &text[pEnd - host + 1];
+        }
+
+        result = EOK;
+    }
+
+    if ( ( result == EOK ) &&
+         ( pPort != NULL ) )
+    {
+        port = strtoul( pPort, &pLast, 10 );
+        if ( ( pLast == pPort ) ||
+             ( *pLast != '\0' ) ||
+             ( port == 0 ) ||
+             ( port > 65535 ) )
+        {
+            result = EINVAL;
+        }
+    }
+
+    if ( result == EOK )
+    {
+        memset( &hints, 0, sizeof( hints ) );
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_DGRAM;
+        hints.ai_flags = AI_NUMERICHOST;
+
+        if ( ( getaddrinfo( host, NULL, &hints, &pInfo ) != 0 ) ||
+             ( pInfo == NULL ) )
+        {
+            result = EINVAL;
+        }
+    }
+
+    if ( result == EOK )
+    {
+        memset( pSub, 0, sizeof( Subscriber ) );
+        memcpy( &pSub->addr, pInfo->ai_addr, pInfo->ai_addrlen );
+        pSub->addrlen = pInfo->ai_addrlen;
+        SetPort( &pSub->addr, (uint16_t)port );
+        snprintf( pSub->name, sizeof( pSub->name ), "%s", text );
+    }
+
+    if ( pInfo != NULL )
+    {
+        freeaddrinfo( pInfo );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  GetPort                                                                   */
+/*!
+    Get the port of a socket address
+
+    @param[in]
+        pAddr
+            pointer to the socket address
+
+    @retval port in host byte order
+
+==============================================================================*/
+static uint16_t GetPort( const struct sockaddr_storage *pAddr )
+{
+    uint16_t port = 0;
+
+    if ( pAddr->ss_family == AF_INET )
+    {
+        port = ntohs( ((const struct sockaddr_in *)pAddr)->sin_port );
+    }
+    else if ( pAddr->ss_family == AF_INET6 )
+    {
+        port = ntohs( ((const struct sockaddr_in6 *)pAddr)->sin6_port );
+    }
+
+    return port;
+}
+
+/*============================================================================*/
+/*  SetPort                                                                   */
+/*!
+    Set the port of a socket address
+
+    @param[in]
+        pAddr
+            pointer to the socket address
+
+    @param[in]
+        port
+            port in host byte order
+
+==============================================================================*/
+static void SetPort( struct sockaddr_storage *pAddr, uint16_t port )
+{
+    if ( pAddr->ss_family == AF_INET )
+    {
+        ((struct sockaddr_in *)pAddr)->sin_port = htons( port );
+    }
+    else if ( pAddr->ss_family == AF_INET6 )
+    {
+        ((struct sockaddr_in6 *)pAddr)->sin6_port = htons( port );
+    }
+}
+
+/*! @}
+ * end of sublist group */
@@ -0,0 +1,568 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup txbatch Transmit Batch
+ * @brief Batched datagram transmission using sendmmsg()
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file txbatch.c
+
+    Transmit Batch
+
+    The txbatch component collects all of the datagrams generated during
+    a transmission pass, and sends them using as few sendmmsg() calls as
+    possible.  Consecutive datagrams for the same socket are sent with a
+    single call, and the result of each datagram is recorded so it can
+    be mapped back to the caller's counters.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <varserver/varserver.h>
+#include "txbatch.h"
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static void SendRun( TxBatch *pBatch, size_t start, size_t count );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  TXBATCH_Reset                                                             */
+/*!
+    Reset a transmit batch
+
+    The TXBATCH_Reset function discards all of the datagrams in the
+    transmit batch.
+
+    @param[in]
+        pBatch
+            pointer to the transmit batch
+
+==============================================================================*/
+void TXBATCH_Reset( TxBatch *pBatch )
+{
+    if ( pBatch != NULL )
+    {
+        pBatch->n = 0;
+        pBatch->nCalls = 0;
+    }
+}
+
+/*============================================================================*/
+/*  TXBATCH_GetSlot                                                           */
+/*!
+    Get the datagram buffer for the next message
+
+    The TXBATCH_GetSlot function gets a pointer to the preallocated
+    buffer which belongs to the next datagram to be added to the batch.
+    The caller may build its payload in this buffer before calling
+    TXBATCH_Add.
+
+    @param[in]
+        pBatch
+            pointer to the transmit batch
+
+    @param[out]
+        pSize
+            pointer to a location to store the size of the buffer
+
+    @retval pointer to the datagram buffer
+    @retval NULL the batch is full
+
+==============================================================================*/
+char *TXBATCH_GetSlot( TxBatch *pBatch, size_t *pSize )
+{
+    char *p = NULL;
+
+    if ( ( pBatch != NULL ) &&
+         ( pSize != NULL ) &&
+         ( pBatch->n < TXBATCH_MAX_MSGS ) )
+    {
+        p = pBatch->slots[pBatch->n];
+        *pSize = TXBATCH_SLOT_SIZE;
+    }
+
+    return p;
+}
+
+/*============================================================================*/
+/*  TXBATCH_Add                                                               */
+/*!
+    Add a datagram to a transmit batch
+
+    The TXBATCH_Add function adds a datagram to the transmit batch.
+    The payload is not copied, so it must remain valid until the
+    batch is sent.
+
+    @param[in]
+        pBatch
+            pointer to the transmit batch
+
+    @param[in]
+        fd
+            socket to send the datagram on
+
+    @param[in]
+        pAddr
+            pointer to the destination address
+
+    @param[in]
+        addrlen
+            length of the destination address
+
+    @param[in]
+        pMsg
+            pointer to the datagram payload
+
+    @param[in]
+        len
+            length of the datagram payload
+
+    @param[in]
+        pCtx
+            caller context associated with the datagram
+
+    @retval EOK the datagram was added
+    @retval ENOSPC the batch is full
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int TXBATCH_Add( TxBatch *pBatch,
+                 int fd,
+                 const struct sockaddr *pAddr,
+                 socklen_t addrlen,
+                 char *pMsg,
+                 size_t len,
+                 void *pCtx )
+{
+    int result = EINVAL;
+    struct msghdr *pHdr;
+    size_t i;
+
+    if ( ( pBatch != NULL ) &&
+         ( pAddr != NULL ) &&
+         ( addrlen <= sizeof( struct sockaddr_storage ) ) &&
+         ( pMsg != NULL ) )
+    {
+        result = ENOSPC;
+        if ( pBatch->n < TXBATCH_MAX_MSGS )
+        {
+            i = pBatch->n++;
+
+            memcpy( &pBatch->addr[i], pAddr, addrlen );
+            pBatch->iov[i].iov_base = pMsg;
+            pBatch->iov[i].iov_len = len;
+            pBatch->fd[i] = fd;
+            pBatch->pCtx[i] = pCtx;
+            pBatch->result[i] = EINPROGRESS;
+
+            pHdr = &pBatch->msgs[i].msg_hdr;
+            memset( pHdr, 0, sizeof( struct msghdr ) );
+            pHdr->msg_name = &pBatch->addr[i];
+            pHdr->msg_namelen = addrlen;
+            pHdr->msg_iov = &pBatch->iov[i];
+            pHdr->msg_iovlen = 1;
+            pBatch->msgs[i].msg_len = 0;
+
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  TXBATCH_AddCopy                                                           */
+/*!
+    Add a copy of a datagram to a transmit batch
+
+    The TXBATCH_AddCopy function adds a datagram to the transmit batch,
+    copying its payload into the batch's next datagram buffer unless it
+    was already built there.  The caller's buffer may be re-used as soon
+    as the function returns, which is required when the batch is sent
+    after the caller has moved on, for example by a sender thread.
+
+    @param[in]
+        pBatch
+            pointer to the transmit batch
+
+    @param[in]
+        fd
+            socket to send the datagram on
+
+    @param[in]
+        pAddr
+            pointer to the destination address
+
+    @param[in]
+        addrlen
+            length of the destination address
+
+    @param[in]
+        pMsg
+            pointer to the datagram payload
+
+    @param[in]
+        len
+            length of the datagram payload
+
+    @param[in]
+        pCtx
+            caller context associated with the datagram
+
+    @retval EOK the datagram was added
+    @retval ENOSPC the batch is full
+    @retval E2BIG the payload does not fit in a datagram buffer
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int TXBATCH_AddCopy( TxBatch *pBatch,
+                     int fd,
+                     const struct sockaddr *pAddr,
+                     socklen_t addrlen,
+                     const char *pMsg,
+                     size_t len,
+                     void *pCtx )
+{
+    int result = EINVAL;
+    char *pSlot;
+    size_t size;
+
+    if ( ( pBatch != NULL ) &&
+         ( pMsg != NULL ) )
+    {
+        pSlot = TXBATCH_GetSlot( pBatch, &size );
+        if ( pSlot == NULL )
+        {
+            result = ENOSPC;
+        }
+        else if ( len > size )
+        {
+            result = E2BIG;
+        }
+        else
+        {
+            if ( pMsg != pSlot )
+            {
+                memcpy( pSlot, pMsg, len );
+            }
+
+            result = TXBATCH_Add( pBatch, fd, pAddr, addrlen, pSlot, len, pCtx );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  TXBATCH_AddControl                                                        */
+/*!
+    Add ancillary data to the last datagram in a transmit batch
+
+    The TXBATCH_AddControl function appends a control message to the
+    ancillary data of the datagram most recently added to the batch,
+    for example a UDP_SEGMENT size to send it using UDP GSO.
+
+    @param[in]
+        pBatch
+            pointer to the transmit batch
+
+    @param[in]
+        level
+            control message level (e.g. SOL_UDP)
+
+    @param[in]
+        type
+            control message type (e.g. UDP_SEGMENT)
+
+    @param[in]
+        pData
+            pointer to the control message data
+
+    @param[in]
+        len
+            length of the control message data
+
+    @retval EOK the control message was added
+    @retval ENOSPC the ancillary data buffer is full
+    @retval EINVAL invalid arguments or the batch is empty
+
+==============================================================================*/
+int TXBATCH_AddControl( TxBatch *pBatch,
+                        int level,
+                        int type,
+                        const void *pData,
+                        size_t len )
+{
+    int result = EINVAL;
+    struct msghdr *pHdr;
+    struct cmsghdr *pCmsg;
+    size_t used;
+    size_t i;
+
+    if ( ( pBatch != NULL ) &&
+         ( pBatch->n > 0 ) &&
+         ( pData != NULL ) )
+    {
+        i = pBatch->n - 1;
+        pHdr = &pBatch->msgs[i].msg_hdr;
+        used = pHdr->msg_controllen;
+
+        result = ENOSPC;
+        if ( used + CMSG_SPACE( len ) <= TXBATCH_CONTROL_SIZE )
+        {
+            pHdr->msg_control = pBatch->control[i].buf;
+
+            pCmsg = (struct cmsghdr *)&pBatch->control[i].buf[used];
+            memset( pCmsg, 0, CMSG_SPACE( len ) );
+            pCmsg->cmsg_level = level;
+            pCmsg->cmsg_type = type;
+            pCmsg->cmsg_len = CMSG_LEN( len );
+            memcpy( CMSG_DATA( pCmsg ), pData, len );
+
+            pHdr->msg_controllen = used + CMSG_SPACE( len );
+
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  TXBATCH_HasControl                                                        */
+/*!
+    Check whether a datagram carries a type of ancillary data
+
+    @param[in]
+        pBatch
+            pointer to the transmit batch
+
+    @param[in]
+        i
+            index of the datagram in the batch
+
+    @param[in]
+        level
+            protocol level of the ancillary data
+
+    @param[in]
+        type
+            type of the ancillary data
+
+    @retval true the datagram carries the ancillary data
+    @retval false the datagram does not carry the ancillary data
+
+==============================================================================*/
+bool TXBATCH_HasControl( TxBatch *pBatch, size_t i, int level, int type )
+{
+    bool found = false;
+    struct msghdr *pHdr;
+    struct cmsghdr *pCmsg;
+
+    if ( ( pBatch != NULL ) &&
+         ( i < pBatch->n ) )
+    {
+        pHdr = &pBatch->msgs[i].msg_hdr;
+        for ( pCmsg = CMSG_FIRSTHDR( pHdr );
+              ( pCmsg != NULL ) && ( found == false );
+              pCmsg = CMSG_NXTHDR( pHdr, pCmsg ) )
+        {
+            found = ( pCmsg->cmsg_level == level ) &&
+                    ( pCmsg->cmsg_type == type );
+        }
+    }
+
+    return found;
+}
+
+/*============================================================================*/
+/*  TXBATCH_Send                                                              */
+/*!
+    Send all of the datagrams in a transmit batch
+
+    The TXBATCH_Send function sends all of the datagrams in the batch.
+    Consecutive datagrams for the same socket are sent with one
+    sendmmsg() call.  The result of each datagram is stored in the
+    batch result array.
+
+    @param[in]
+        pBatch
+            pointer to the transmit batch
+
+    @retval EOK all the datagrams were sent
+    @retval EIO one or more datagrams could not be sent
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int TXBATCH_Send( TxBatch *pBatch )
+{
+    int result = EINVAL;
+    size_t start = 0;
+    size_t i;
+
+    if ( pBatch != NULL )
+    {
+        result = EOK;
+        pBatch->nCalls = 0;
+
+        for ( i = 1; i <= pBatch->n; i++ )
+        {
+            if ( ( i == pBatch->n ) ||
+                 ( pBatch->fd[i] != pBatch->fd[start] ) )
+            {
+                SendRun( pBatch, start, i - start );
+                start = i;
+            }
+        }
+
+        for ( i = 0; i < pBatch->n; i++ )
+        {
+            if ( pBatch->result[i] != EOK )
+            {
+                result = EIO;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  TXBATCH_ProbeGSO                                                          */
+/*!
+    Check if the kernel supports UDP GSO
+
+    The TXBATCH_ProbeGSO function checks if the kernel supports UDP
+    generic segmentation offload (UDP_SEGMENT), which allows a large
+    datagram to be sent as a train of equal sized datagrams with a
+    single send.
+
+    @retval true UDP GSO is supported
+    @retval false UDP GSO is not supported
+
+==============================================================================*/
+bool TXBATCH_ProbeGSO( void )
+{
+    bool supported = false;
+    int size = TXBATCH_SLOT_SIZE;
+    int fd;
+
+    fd = socket( AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0 );
+    if ( fd != -1 )
+    {
+        supported = ( setsockopt( fd,
+                                  SOL_UDP,
+                                  UDP_SEGMENT,
+                                  &size,
+                                  sizeof( size ) ) == 0 );
+        close( fd );
+    }
+
+    return supported;
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  SendRun                                                                   */
+/*!
+    Send a run of datagrams on the same socket
+
+    The SendRun function sends a run of consecutive datagrams which share
+    the same socket.  If sendmmsg() fails part way through the run, the
+    failing datagram is marked with the error and the remaining
+    datagrams are retried.
+
+    @param[in]
+        pBatch
+            pointer to the transmit batch
+
+    @param[in]
+        start
+            index of the first datagram in the run
+
+    @param[in]
+        count
+            number of datagrams in the run
+
+==============================================================================*/
+static void SendRun( TxBatch *pBatch, size_t start, size_t count )
+{
+    size_t end = start + count;
+    size_t i = start;
+    size_t j;
+    int rc;
+
+    while ( i < end )
+    {
+        rc = sendmmsg( pBatch->fd[i], &pBatch->msgs[i], end - i, 0 );
+        pBatch->nCalls++;
+
+        if ( rc > 0 )
+        {
+            for ( j = i; j < i + (size_t)rc; j++ )
+            {
+                pBatch->result[j] = EOK;
+            }
+
+            i += rc;
+        }
+        else if ( ( rc == -1 ) && ( errno == EINTR ) )
+        {
+            continue;
+        }
+        else
+        {
+            /* the first datagram of the remaining run failed */
+            pBatch->result[i] = ( rc == -1 ) ? errno : EIO;
+            i++;
+        }
+    }
+}
+
+/*! @}
+ * end of txbatch group */
@@ -0,0 +1,531 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup txring Transmit Ring
+ * @brief Transmit batches handed to a sender thread
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file txring.c
+
+    Transmit Ring
+
+    The txring component decouples building datagrams from sending them.
+    The producer (the control thread) fills a preallocated transmit
+    batch and publishes it to a bounded single producer, single consumer
+    ring.  A sender thread sends the published batches in order, so a
+    slow or congested interface only holds up the sender thread.  Once
+    a batch has been sent, the producer is woken through an eventfd to
+    reap its results and re-use the slot.
+
+    The ring indices are free running counters.  Only the producer
+    writes the head and reaped counters, and only the sender thread
+    writes the tail counter, so no locks are needed.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <varserver/varserver.h>
+#include "txsched.h"
+#include "txring.h"
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static void *SenderThread( void *arg );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  TXRING_Init                                                               */
+/*!
+    Initialize a transmit ring and start its sender thread
+
+    The TXRING_Init function allocates the transmit batches of the ring,
+    creates its event file descriptors, and starts the sender thread.
+
+    @param[in]
+        pRing
+            pointer to the transmit ring to initialize
+
+    @param[in]
+        size
+            number of transmit batches in the ring (1 to TXRING_MAX_SLOTS)
+
+    @param[in]
+        pfnSend
+            function used to send each batch, or NULL to use TXBATCH_Send
+
+    @param[in]
+        pSendCtx
+            context passed to the send function
+
+    @retval EOK the transmit ring is running
+    @retval ENOMEM memory allocation failed
+    @retval EINVAL invalid arguments
+    @retval EAGAIN the sender thread could not be started
+    @retval other error from eventfd or pthread_create
+
+==============================================================================*/
+int TXRING_Init( TxRing *pRing,
+                 size_t size,
+                 TxRingSendFn pfnSend,
+                 void *pSendCtx )
+{
+    int result = EINVAL;
+    size_t i;
+
+    if ( ( pRing != NULL ) &&
+         ( size > 0 ) &&
+         ( size <= TXRING_MAX_SLOTS ) )
+    {
+        memset( pRing, 0, sizeof( TxRing ) );
+        pRing->kickFd = -1;
+        pRing->doneFd = -1;
+        pRing->size = size;
+        pRing->pfnSend = pfnSend;
+        pRing->pSendCtx = pSendCtx;
+        atomic_init( &pRing->head, 0 );
+        atomic_init( &pRing->tail, 0 );
+        atomic_init( &pRing->stop, false );
+
+        result = ENOMEM;
+        pRing->slots = calloc( size, sizeof( TxRingSlot ) );
+        if ( pRing->slots != NULL )
+        {
+            for ( i = 0; i < size; i++ )
+            {
+                TXBATCH_Reset( &pRing->slots[i].batch );
+            }
+
+            /* the sender thread blocks reading the kick eventfd,
+               while the done eventfd is polled by the event loop */
+            pRing->kickFd = eventfd( 0, EFD_CLOEXEC );
+            pRing->doneFd = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+            if ( ( pRing->kickFd == -1 ) ||
+                 ( pRing->doneFd == -1 ) )
+            {
+                result = errno;
+            }
+            else
+            {
+                result = pthread_create( &pRing->thread,
+                                         NULL,
+                                         SenderThread,
+                                         pRing );
+                pRing->running = ( result == EOK );
+            }
+        }
+
+        if ( result != EOK )
+        {
+            TXRING_Close( pRing );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  TXRING_Close                                                              */
+/*!
+    Stop the sender thread and free a transmit ring
+
+    The TXRING_Close function stops the sender thread once it has sent
+    the batch it is working on, and releases the resources of the ring.
+    Published batches which have not been sent are discarded.
+
+    @param[in]
+        pRing
+            pointer to the transmit ring to close
+
+==============================================================================*/
+void TXRING_Close( TxRing *pRing )
+{
+    uint64_t one = 1;
+
+    if ( pRing != NULL )
+    {
+        if ( pRing->running == true )
+        {
+            atomic_store( &pRing->stop, true );
+            (void)write( pRing->kickFd, &one, sizeof( one ) );
+            (void)pthread_join( pRing->thread, NULL );
+            pRing->running = false;
+        }
+
+        if ( pRing->kickFd != -1 )
+        {
+            close( pRing->kickFd );
+            pRing->kickFd = -1;
+        }
+
+        if ( pRing->doneFd != -1 )
+        {
+            close( pRing->doneFd );
+            pRing->doneFd = -1;
+        }
+
+        free( pRing->slots );
+        pRing->slots = NULL;
+        pRing->size = 0;
+    }
+}
+
+/*============================================================================*/
+/*  TXRING_GetSlot                                                            */
+/*!
+    Get a transmit ring slot by index
+
+    The TXRING_GetSlot function gets a pointer to one of the slots of
+    the transmit ring, so the caller can associate its own context
+    with each slot.
+
+    @param[in]
+        pRing
+            pointer to the transmit ring
+
+    @param[in]
+        idx
+            index of the slot
+
+    @retval pointer to the slot
+    @retval NULL invalid arguments
+
+==============================================================================*/
+TxRingSlot *TXRING_GetSlot( TxRing *pRing, size_t idx )
+{
+    TxRingSlot *pSlot = NULL;
+
+    if ( ( pRing != NULL ) &&
+         ( pRing->slots != NULL ) &&
+         ( idx < pRing->size ) )
+    {
+        pSlot = &pRing->slots[idx];
+    }
+
+    return pSlot;
+}
+
+/*============================================================================*/
+/*  TXRING_Acquire                                                            */
+/*!
+    Get the next free transmit batch
+
+    The TXRING_Acquire function gets the slot which will be published
+    next, if it is free.  A slot is free once its previous batch has
+    been sent and reaped.  Calling TXRING_Acquire again before
+    TXRING_Publish returns the same slot.
+
+    @param[in]
+        pRing
+            pointer to the transmit ring
+
+    @retval pointer to the free slot
+    @retval NULL every slot is waiting to be sent or reaped
+
+==============================================================================*/
+TxRingSlot *TXRING_Acquire( TxRing *pRing )
+{
+    TxRingSlot *pSlot = NULL;
+    size_t head;
+
+    if ( ( pRing != NULL ) &&
+         ( pRing->slots != NULL ) )
+    {
+        head = atomic_load_explicit( &pRing->head, memory_order_relaxed );
+        if ( head - pRing->reaped < pRing->size )
+        {
+            pSlot = &pRing->slots[head % pRing->size];
+        }
+    }
+
+    return pSlot;
+}
+
+/*============================================================================*/
+/*  TXRING_Publish                                                            */
+/*!
+    Hand the acquired transmit batch to the sender thread
+
+    The TXRING_Publish function publishes the slot returned by
+    TXRING_Acquire, and wakes the sender thread to send it.  The
+    producer must not modify the batch until it has been reaped.
+
+    @param[in]
+        pRing
+            pointer to the transmit ring
+
+==============================================================================*/
+void TXRING_Publish( TxRing *pRing )
+{
+    uint64_t one = 1;
+    size_t head;
+
+    if ( ( pRing != NULL ) &&
+         ( pRing->slots != NULL ) )
+    {
+        head = atomic_load_explicit( &pRing->head, memory_order_relaxed );
+        if ( head - pRing->reaped < pRing->size )
+        {
+            /* make the batch contents visible before the new head */
+            atomic_store_explicit( &pRing->head,
+                                   head + 1,
+                                   memory_order_release );
+            (void)write( pRing->kickFd, &one, sizeof( one ) );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  TXRING_Reap                                                               */
+/*!
+    Get the oldest sent transmit batch
+
+    The TXRING_Reap function gets the oldest batch which has been sent
+    by the sender thread but not yet reaped, so the producer can
+    process the send results.  The slot must be returned to the ring
+    using TXRING_Release.
+
+    @param[in]
+        pRing
+            pointer to the transmit ring
+
+    @retval pointer to the sent slot
+    @retval NULL no sent batch is waiting to be reaped
+
+==============================================================================*/
+TxRingSlot *TXRING_Reap( TxRing *pRing )
+{
+    TxRingSlot *pSlot = NULL;
+    size_t tail;
+
+    if ( ( pRing != NULL ) &&
+         ( pRing->slots != NULL ) )
+    {
+        tail = atomic_load_explicit( &pRing->tail, memory_order_acquire );
+        if ( pRing->reaped != tail )
+        {
+            pSlot = &pRing->slots[pRing->reaped % pRing->size];
+        }
+    }
+
+    return pSlot;
+}
+
+/*============================================================================*/
+/*  TXRING_Release                                                            */
+/*!
+    Return a reaped transmit batch to the ring
+
+    The TXRING_Release function resets the batch returned by TXRING_Reap
+    and frees its slot for re-use.
+
+    @param[in]
+        pRing
+            pointer to the transmit ring
+
+==============================================================================*/
+void TXRING_Release( TxRing *pRing )
+{
+    TxRingSlot *pSlot;
+
+    pSlot = TXRING_Reap( pRing );
+    if ( pSlot != NULL )
+    {
+        TXBATCH_Reset( &pSlot->batch );
+        pRing->reaped++;
+    }
+}
+
+/*============================================================================*/
+/*  TXRING_ClearEvent                                                         */
+/*!
+    Clear the transmit ring completion event
+
+    The TXRING_ClearEvent function clears the completion eventfd.  It
+    must be called before reaping the sent batches, so a batch which
+    completes while they are being reaped signals the eventfd again.
+
+    @param[in]
+        pRing
+            pointer to the transmit ring
+
+==============================================================================*/
+void TXRING_ClearEvent( TxRing *pRing )
+{
+    uint64_t count;
+
+    if ( ( pRing != NULL ) &&
+         ( pRing->doneFd != -1 ) )
+    {
+        (void)read( pRing->doneFd, &count, sizeof( count ) );
+    }
+}
+
+/*============================================================================*/
+/*  TXRING_Wait                                                               */
+/*!
+    Wait for the sender thread to send all of the published batches
+
+    The TXRING_Wait function blocks until every published batch has been
+    sent.  It is used before closing sockets which may still be
+    referenced by the published batches.  The sent batches still need
+    to be reaped.
+
+    @param[in]
+        pRing
+            pointer to the transmit ring
+
+==============================================================================*/
+void TXRING_Wait( TxRing *pRing )
+{
+    struct pollfd pfd;
+
+    if ( ( pRing != NULL ) &&
+         ( pRing->running == true ) )
+    {
+        pfd.fd = pRing->doneFd;
+        pfd.events = POLLIN;
+
+        while ( atomic_load_explicit( &pRing->tail, memory_order_acquire ) !=
+                atomic_load_explicit( &pRing->head, memory_order_relaxed ) )
+        {
+            if ( poll( &pfd, 1, -1 ) > 0 )
+            {
+                TXRING_ClearEvent( pRing );
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  TXRING_GetFd                                                              */
+/*!
+    Get the transmit ring completion file descriptor
+
+    The TXRING_GetFd function gets the eventfd which becomes readable
+    when the sender thread has sent a batch.
+
+    @param[in]
+        pRing
+            pointer to the transmit ring
+
+    @retval the completion file descriptor
+    @retval -1 the ring is not initialized
+
+==============================================================================*/
+int TXRING_GetFd( TxRing *pRing )
+{
+    return ( ( pRing != NULL ) && ( pRing->slots != NULL ) )
+           ? pRing->doneFd
+           : -1;
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  SenderThread                                                              */
+/*!
+    Send the published transmit batches
+
+    The SenderThread function is the body of the sender thread.  It
+    sends each published batch in order, records how long the send
+    took, and signals the producer.  It sleeps on the kick eventfd
+    while there is nothing to send.
+
+    @param[in]
+        arg
+            pointer to the transmit ring
+
+    @retval NULL
+
+==============================================================================*/
+static void *SenderThread( void *arg )
+{
+    TxRing *pRing = (TxRing *)arg;
+    TxRingSlot *pSlot;
+    uint64_t one = 1;
+    uint64_t count;
+    uint64_t start_ns;
+    size_t tail;
+
+    while ( atomic_load( &pRing->stop ) == false )
+    {
+        tail = atomic_load_explicit( &pRing->tail, memory_order_relaxed );
+        if ( tail == atomic_load_explicit( &pRing->head,
+                                           memory_order_acquire ) )
+        {
+            /* nothing to send, wait to be kicked */
+            (void)read( pRing->kickFd, &count, sizeof( count ) );
+        }
+        else
+        {
+            pSlot = &pRing->slots[tail % pRing->size];
+
+            start_ns = SCHED_Now();
+            if ( pRing->pfnSend != NULL )
+            {
+                (void)pRing->pfnSend( pRing->pSendCtx, &pSlot->batch );
+            }
+            else
+            {
+                (void)TXBATCH_Send( &pSlot->batch );
+            }
+            pSlot->send_ns = SCHED_Now() - start_ns;
+
+            /* make the send results visible before the new tail */
+            atomic_store_explicit( &pRing->tail,
+                                   tail + 1,
+                                   memory_order_release );
+            (void)write( pRing->doneFd, &one, sizeof( one ) );
+        }
+    }
+
+    return NULL;
+}
+
+/*! @}
+ * end of txring group */
@@ -0,0 +1,497 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup txsched Transmission Schedule
+ * @brief Min-heap of transmission deadlines
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file txsched.c
+
+    Transmission Schedule
+
+    The txsched component keeps the next transmission deadline of every
+    channel in a binary min-heap, so a single timer can be armed for the
+    earliest deadline regardless of how many channels are running.
+    Deadlines are absolute CLOCK_MONOTONIC times in nanoseconds.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <varserver/varserver.h>
+#include "txsched.h"
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static void SiftUp( Schedule *pSched, size_t idx );
+static void SiftDown( Schedule *pSched, size_t idx );
+static void Swap( Schedule *pSched, size_t a, size_t b );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  SCHED_Init                                                                */
+/*!
+    Initialize a transmission schedule
+
+    The SCHED_Init function initializes an empty transmission schedule
+
+    @param[in]
+        pSched
+            pointer to the schedule to initialize
+
+==============================================================================*/
+void SCHED_Init( Schedule *pSched )
+{
+    if ( pSched != NULL )
+    {
+        memset( pSched, 0, sizeof( Schedule ) );
+    }
+}
+
+/*============================================================================*/
+/*  SCHED_Insert                                                              */
+/*!
+    Add a deadline to the schedule
+
+    The SCHED_Insert function adds a deadline and its associated caller
+    context to the schedule.  A context should be scheduled at most once,
+    so callers re-scheduling a context must remove it first.
+
+    @param[in]
+        pSched
+            pointer to the schedule
+
+    @param[in]
+        deadline_ns
+            absolute monotonic deadline in nanoseconds
+
+    @param[in]
+        pCtx
+            caller context associated with the deadline
+
+    @retval EOK the deadline was scheduled
+    @retval ENOSPC the schedule is full
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int SCHED_Insert( Schedule *pSched, uint64_t deadline_ns, void *pCtx )
+{
+    int result = EINVAL;
+
+    if ( pSched != NULL )
+    {
+        result = ENOSPC;
+        if ( pSched->n < SCHED_MAX_ENTRIES )
+        {
+            pSched->entries[pSched->n].deadline_ns = deadline_ns;
+            pSched->entries[pSched->n].pCtx = pCtx;
+            SiftUp( pSched, pSched->n++ );
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SCHED_Remove                                                              */
+/*!
+    Remove a context from the schedule
+
+    The SCHED_Remove function removes the deadline associated with the
+    specified caller context from the schedule.
+
+    @param[in]
+        pSched
+            pointer to the schedule
+
+    @param[in]
+        pCtx
+            caller context to remove
+
+    @retval EOK the context was removed
+    @retval ENOENT the context was not scheduled
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int SCHED_Remove( Schedule *pSched, void *pCtx )
+{
+    int result = EINVAL;
+    size_t i;
+
+    if ( pSched != NULL )
+    {
+        result = ENOENT;
+        for ( i = 0; i < pSched->n; i++ )
+        {
+            if ( pSched->entries[i].pCtx == pCtx )
+            {
+                pSched->n--;
+                if ( i != pSched->n )
+                {
+                    /* move the last entry into the hole and restore
+                       the heap order in whichever direction it is broken */
+                    pSched->entries[i] = pSched->entries[pSched->n];
+                    SiftDown( pSched, i );
+                    SiftUp( pSched, i );
+                }
+
+                result = EOK;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SCHED_Peek                                                                */
+/*!
+    Get the earliest deadline in the schedule
+
+    The SCHED_Peek function gets the earliest deadline in the schedule
+    and its associated context without removing it.
+
+    @param[in]
+        pSched
+            pointer to the schedule
+
+    @param[out]
+        pDeadline
+            pointer to a location to store the deadline (may be NULL)
+
+    @param[out]
+        ppCtx
+            pointer to a location to store the context (may be NULL)
+
+    @retval EOK the earliest deadline was retrieved
+    @retval ENOENT the schedule is empty
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int SCHED_Peek( Schedule *pSched, uint64_t *pDeadline, void **ppCtx )
+{
+    int result = EINVAL;
+
+    if ( pSched != NULL )
+    {
+        result = ENOENT;
+        if ( pSched->n > 0 )
+        {
+            if ( pDeadline != NULL )
+            {
+                *pDeadline = pSched->entries[0].deadline_ns;
+            }
+
+            if ( ppCtx != NULL )
+            {
+                *ppCtx = pSched->entries[0].pCtx;
+            }
+
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SCHED_Pop                                                                 */
+/*!
+    Remove the earliest deadline from the schedule
+
+    The SCHED_Pop function removes the earliest deadline from the
+    schedule and returns it along with its associated context.
+
+    @param[in]
+        pSched
+            pointer to the schedule
+
+    @param[out]
+        pDeadline
+            pointer to a location to store the deadline (may be NULL)
+
+    @param[out]
+        ppCtx
+            pointer to a location to store the context (may be NULL)
+
+    @retval EOK the earliest deadline was removed
+    @retval ENOENT the schedule is empty
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int SCHED_Pop( Schedule *pSched, uint64_t *pDeadline, void **ppCtx )
+{
+    int result;
+
+    result = SCHED_Peek( pSched, pDeadline, ppCtx );
+    if ( result == EOK )
+    {
+        pSched->n--;
+        if ( pSched->n > 0 )
+        {
+            pSched->entries[0] = pSched->entries[pSched->n];
+            SiftDown( pSched, 0 );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SCHED_Now                                                                 */
+/*!
+    Get the current monotonic time
+
+    The SCHED_Now function gets the current CLOCK_MONOTONIC time in
+    nanoseconds, on the same time base as the schedule deadlines.
+
+    @retval the current monotonic time in nanoseconds
+
+==============================================================================*/
+uint64_t SCHED_Now( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/*============================================================================*/
+/*  SCHED_Align                                                               */
+/*!
+    Get the next deadline on a phase-aligned grid
+
+    The SCHED_Align function gets the first time after now_ns which
+    lies on the grid of period_ns intervals offset by phase_ns, where
+    the grid is anchored at time zero of a reference clock which is
+    epoch_ns ahead of the monotonic clock.  With an epoch of zero the
+    grid is anchored to the monotonic clock, and with the offset from
+    SCHED_RealtimeOffset it is anchored to the wall clock.
+
+    @param[in]
+        now_ns
+            current monotonic time in nanoseconds
+
+    @param[in]
+        period_ns
+            grid period in nanoseconds
+
+    @param[in]
+        phase_ns
+            offset of the grid within the period in nanoseconds
+
+    @param[in]
+        epoch_ns
+            offset of the reference clock from the monotonic clock
+
+    @retval the next aligned monotonic deadline in nanoseconds
+    @retval now_ns if period_ns is zero
+
+==============================================================================*/
+uint64_t SCHED_Align( uint64_t now_ns,
+                      uint64_t period_ns,
+                      uint64_t phase_ns,
+                      uint64_t epoch_ns )
+{
+    uint64_t deadline_ns = now_ns;
+    uint64_t ref_ns;
+    uint64_t delta_ns;
+
+    if ( period_ns > 0 )
+    {
+        /* time since the previous grid point on the reference clock */
+        ref_ns = now_ns + epoch_ns + period_ns - ( phase_ns % period_ns );
+        delta_ns = ref_ns % period_ns;
+
+        deadline_ns = now_ns + ( period_ns - delta_ns );
+    }
+
+    return deadline_ns;
+}
+
+/*============================================================================*/
+/*  SCHED_RealtimeOffset                                                      */
+/*!
+    Get the offset of the wall clock from the monotonic clock
+
+    The SCHED_RealtimeOffset function gets the difference between the
+    CLOCK_REALTIME and CLOCK_MONOTONIC times in nanoseconds, so wall
+    clock instants can be converted to schedule deadlines.  The offset
+    changes when the wall clock is stepped.
+
+    @retval the wall clock offset in nanoseconds
+
+==============================================================================*/
+uint64_t SCHED_RealtimeOffset( void )
+{
+    struct timespec now;
+    uint64_t realtime_ns;
+
+    clock_gettime( CLOCK_REALTIME, &now );
+    realtime_ns = (uint64_t)now.tv_sec * 1000000000ULL +
+                  (uint64_t)now.tv_nsec;
+
+    return realtime_ns - SCHED_Now();
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  SiftUp                                                                    */
+/*!
+    Move a heap entry towards the root
+
+    The SiftUp function restores the heap order by moving the entry at
+    the specified index up while its deadline is earlier than its parent.
+
+    @param[in]
+        pSched
+            pointer to the schedule
+
+    @param[in]
+        idx
+            index of the entry to move
+
+==============================================================================*/
+static void SiftUp( Schedule *pSched, size_t idx )
+{
+    size_t parent;
+
+    while ( idx > 0 )
+    {
+        parent = ( idx - 1 ) / 2;
+        if ( pSched->entries[idx].deadline_ns >=
+             pSched->entries[parent].deadline_ns )
+        {
+            break;
+        }
+
+        Swap( pSched, idx, parent );
+        idx = parent;
+    }
+}
+
+/*============================================================================*/
+/*  SiftDown                                                                  */
+/*!
+    Move a heap entry towards the leaves
+
+    The SiftDown function restores the heap order by moving the entry at
+    the specified index down while its deadline is later than either of
+    its children.
+
+    @param[in]
+        pSched
+            pointer to the schedule
+
+    @param[in]
+        idx
+            index of the entry to move
+
+==============================================================================*/
+static void SiftDown( Schedule *pSched, size_t idx )
+{
+    size_t child;
+    size_t smallest;
+
+    while ( 1 )
+    {
+        smallest = idx;
+
+        child = 2 * idx + 1;
+        if ( ( child < pSched->n ) &&
+             ( pSched->entries[child].deadline_ns <
+               pSched->entries[smallest].deadline_ns ) )
+        {
+            smallest = child;
+        }
+
+        child++;
+        if ( ( child < pSched->n ) &&
+             ( pSched->entries[child].deadline_ns <
+               pSched->entries[smallest].deadline_ns ) )
+        {
+            smallest = child;
+        }
+
+        if ( smallest == idx )
+        {
+            break;
+        }
+
+        Swap( pSched, idx, smallest );
+        idx = smallest;
+    }
+}
+
+/*============================================================================*/
+/*  Swap                                                                      */
+/*!
+    Swap two heap entries
+
+    @param[in]
+        pSched
+            pointer to the schedule
+
+    @param[in]
+        a
+            index of the first entry
+
+    @param[in]
+        b
+            index of the second entry
+
+==============================================================================*/
+static void Swap( Schedule *pSched, size_t a, size_t b )
+{
+    SchedEntry tmp = pSched->entries[a];
+
+    pSched->entries[a] = pSched->entries[b];
+    pSched->entries[b] = tmp;
+}
+
+/*! @}
+ * end of txsched group */
@@ -0,0 +1,634 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup txstamp Transmit Timestamps
+ * @brief Kernel transmit timestamps of the sent datagrams
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file txstamp.c
+
+    Transmit Timestamps
+
+    The txstamp component enables kernel transmit timestamping
+    (SO_TIMESTAMPING) on the interface sockets, and matches the
+    timestamps read back from their error queues with the datagrams
+    they belong to.  Each datagram is timestamped when it enters the
+    qdisc, when it is handed to the device driver, and, where the
+    interface supports it, when the device puts it on the wire, so the
+    latency of every stage of the send path can be measured.
+
+    The kernel numbers the datagrams sent on each socket
+    (SOF_TIMESTAMPING_OPT_ID), and the timestamps carry that number.
+    The same count is kept here for every successful send, so each
+    timestamp's key locates the datagram's send time and context.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <netinet/in.h>
+#include <net/if.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
+#include <varserver/varserver.h>
+#include "txstamp.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! size of the ancillary data buffer of a timestamp message */
+#define TXSTAMP_CONTROL_SIZE ( 512 )
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static TxStampSocket *FindSocket( TxStamp *pTxStamp, int fd );
+static bool EnableHardware( int fd, const char *ifname );
+static uint64_t ToNs( const struct timespec *pTs );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  TXSTAMP_Init                                                              */
+/*!
+    Initialize a transmit timestamp tracker
+
+    @param[in]
+        pTxStamp
+            pointer to the transmit timestamp tracker to initialize
+
+    @param[in]
+        mode
+            timestamp mode (TXSTAMP_OFF, TXSTAMP_SOFTWARE or
+            TXSTAMP_HARDWARE)
+
+==============================================================================*/
+void TXSTAMP_Init( TxStamp *pTxStamp, int mode )
+{
+    if ( pTxStamp != NULL )
+    {
+        memset( pTxStamp, 0, sizeof( TxStamp ) );
+        pTxStamp->mode = mode;
+    }
+}
+
+/*============================================================================*/
+/*  TXSTAMP_Open                                                              */
+/*!
+    Enable transmit timestamps on a socket
+
+    The TXSTAMP_Open function enables transmit timestamping on a new
+    socket bound to an interface, and starts tracking the datagrams sent
+    on it.  Only the timestamps are looped back to the error queue, not
+    the datagrams.  In hardware mode, transmit timestamping is also
+    turned on in the interface, keeping its receive filter so other
+    users of the hardware clock, such as PTP, are not disturbed.  If
+    the interface does not support it, or we are not privileged to
+    change it, only software timestamps are taken.
+
+    @param[in]
+        pTxStamp
+            pointer to the transmit timestamp tracker
+
+    @param[in]
+        fd
+            socket to timestamp
+
+    @param[in]
+        ifname
+            name of the interface the socket is bound to
+
+    @retval EOK timestamping was enabled
+    @retval ENOTSUP timestamping is off
+    @retval ENOSPC too many sockets are timestamped
+    @retval EINVAL invalid arguments
+    @retval other error from setsockopt
+
+==============================================================================*/
+int TXSTAMP_Open( TxStamp *pTxStamp, int fd, const char *ifname )
+{
+    int result = EINVAL;
+    TxStampSocket *pSocket;
+    bool hardware = false;
+    int flags;
+
+    if ( ( pTxStamp != NULL ) &&
+         ( fd >= 0 ) &&
+         ( ifname != NULL ) )
+    {
+        if ( pTxStamp->mode == TXSTAMP_OFF )
+        {
+            return ENOTSUP;
+        }
+
+        /* a re-used file descriptor starts again */
+        TXSTAMP_Close( pTxStamp, fd );
+
+        if ( pTxStamp->n >= TXSTAMP_MAX_SOCKETS )
+        {
+            return ENOSPC;
+        }
+
+        flags = SOF_TIMESTAMPING_TX_SCHED |
+                SOF_TIMESTAMPING_TX_SOFTWARE |
+                SOF_TIMESTAMPING_SOFTWARE |
+                SOF_TIMESTAMPING_OPT_ID |
+                SOF_TIMESTAMPING_OPT_TSONLY;
+
+        if ( pTxStamp->mode == TXSTAMP_HARDWARE )
+        {
+            hardware = EnableHardware( fd, ifname );
+            if ( hardware == true )
+            {
+                flags |= SOF_TIMESTAMPING_TX_HARDWARE |
+                         SOF_TIMESTAMPING_RAW_HARDWARE;
+            }
+        }
+
+        if ( setsockopt( fd,
+                         SOL_SOCKET,
+                         SO_TIMESTAMPING,
+                         &flags,
+                         sizeof( flags ) ) == 0 )
+        {
+            pSocket = &pTxStamp->sockets[pTxStamp->n++];
+            memset( pSocket, 0, sizeof( TxStampSocket ) );
+            pSocket->fd = fd;
+            pSocket->hardware = hardware;
+            result = EOK;
+        }
+        else
+        {
+            result = errno;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  TXSTAMP_Close                                                             */
+/*!
+    Stop tracking a socket
+
+    The TXSTAMP_Close function stops tracking the datagrams sent on a
+    socket which is being closed.
+
+    @param[in]
+        pTxStamp
+            pointer to the transmit timestamp tracker
+
+    @param[in]
+        fd
+            socket which is being closed
+
+==============================================================================*/
+void TXSTAMP_Close( TxStamp *pTxStamp, int fd )
+{
+    TxStampSocket *pSocket = FindSocket( pTxStamp, fd );
+    TxStampSocket *pLast;
+
+    if ( pSocket != NULL )
+    {
+        /* move the last socket into this slot */
+        pLast = &pTxStamp->sockets[--pTxStamp->n];
+        if ( pSocket != pLast )
+        {
+            memcpy( pSocket, pLast, sizeof( TxStampSocket ) );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  TXSTAMP_IsOpen                                                            */
+/*!
+    Check if a socket is timestamped
+
+    @param[in]
+        pTxStamp
+            pointer to the transmit timestamp tracker
+
+    @param[in]
+        fd
+            socket to check
+
+    @retval true the socket is timestamped
+    @retval false the socket is not timestamped
+
+==============================================================================*/
+bool TXSTAMP_IsOpen( TxStamp *pTxStamp, int fd )
+{
+    return ( FindSocket( pTxStamp, fd ) != NULL );
+}
+
+/*============================================================================*/
+/*  TXSTAMP_Sent                                                              */
+/*!
+    Record a datagram sent on a timestamped socket
+
+    The TXSTAMP_Sent function records the send time and context of a
+    datagram under the key the kernel gave it.  Sends which failed
+    before the datagram was built do not use up a key, but a datagram
+    dropped by the qdisc (ENOBUFS) or a packet filter (EPERM) has
+    already been given one, so the key is skipped without being
+    recorded.
+
+    @param[in]
+        pTxStamp
+            pointer to the transmit timestamp tracker
+
+    @param[in]
+        fd
+            socket the datagram was sent on
+
+    @param[in]
+        result
+            send result of the datagram (EOK or errno)
+
+    @param[in]
+        sent_ns
+            wall clock (CLOCK_REALTIME) time of the send in nanoseconds
+
+    @param[in]
+        pCtx
+            caller context returned with the datagram's timestamps
+
+==============================================================================*/
+void TXSTAMP_Sent( TxStamp *pTxStamp,
+                   int fd,
+                   int result,
+                   uint64_t sent_ns,
+                   void *pCtx )
+{
+    TxStampSocket *pSocket = FindSocket( pTxStamp, fd );
+    TxStampPending *pPending;
+
+    if ( pSocket != NULL )
+    {
+        if ( result == EOK )
+        {
+            pPending = &pSocket->pending[pSocket->nextKey %
+                                         TXSTAMP_PENDING];
+            pPending->key = pSocket->nextKey;
+            pPending->valid = true;
+            pPending->sent_ns = sent_ns;
+            pPending->pCtx = pCtx;
+            pSocket->nextKey++;
+        }
+        else if ( ( result == ENOBUFS ) ||
+                  ( result == EPERM ) )
+        {
+            pSocket->nextKey++;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  TXSTAMP_Read                                                              */
+/*!
+    Read the next transmit timestamp of a socket
+
+    The TXSTAMP_Read function reads timestamps from the error queue of a
+    socket until one can be matched with a sent datagram, and returns
+    the latency from the send to the timestamp.  Timestamps whose key is
+    no longer remembered, or whose latency is implausible, are counted
+    as unmatched and skipped.
+
+    Software timestamps are taken from the system clock.  Hardware
+    timestamps are taken from the clock of the interface, so their
+    latency is only meaningful if that clock is synchronized to the
+    system clock (for example by phc2sys).
+
+    @param[in]
+        pTxStamp
+            pointer to the transmit timestamp tracker
+
+    @param[in]
+        fd
+            socket to read the timestamps of
+
+    @param[out]
+        pSample
+            pointer to the timestamp sample to populate
+
+    @retval EOK a timestamp sample was read
+    @retval EAGAIN the error queue of the socket is empty
+    @retval ENOENT the socket is not timestamped
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int TXSTAMP_Read( TxStamp *pTxStamp, int fd, TxStampSample *pSample )
+{
+    TxStampSocket *pSocket = FindSocket( pTxStamp, fd );
+    TxStampPending *pPending;
+    struct scm_timestamping tss;
+    struct sock_extended_err ee;
+    struct cmsghdr *pCmsg;
+    struct msghdr msg;
+    struct iovec iov;
+    char data[64];
+    union
+    {
+        char buf[TXSTAMP_CONTROL_SIZE];
+        struct cmsghdr align;
+    } control;
+    bool haveStamp;
+    bool haveErr;
+    uint64_t stamp_ns;
+
+    if ( pSample == NULL )
+    {
+        return EINVAL;
+    }
+
+    if ( pSocket == NULL )
+    {
+        return ENOENT;
+    }
+
+    for ( ;; )
+    {
+        memset( &msg, 0, sizeof( msg ) );
+        iov.iov_base = data;
+        iov.iov_len = sizeof( data );
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof( control.buf );
+
+        if ( recvmsg( fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT ) == -1 )
+        {
+            return ( errno == EINTR ) ? EINTR : EAGAIN;
+        }
+
+        haveStamp = false;
+        haveErr = false;
+        memset( &tss, 0, sizeof( tss ) );
+        memset( &ee, 0, sizeof( ee ) );
+
+        for ( pCmsg = CMSG_FIRSTHDR( &msg );
+              pCmsg != NULL;
+              pCmsg = CMSG_NXTHDR( &msg, pCmsg ) )
+        {
+            if ( ( pCmsg->cmsg_level == SOL_SOCKET ) &&
+                 ( pCmsg->cmsg_type == SCM_TIMESTAMPING ) )
+            {
+                memcpy( &tss, CMSG_DATA( pCmsg ), sizeof( tss ) );
+                haveStamp = true;
+            }
+            else if ( ( ( pCmsg->cmsg_level == IPPROTO_IP ) &&
+                        ( pCmsg->cmsg_type == IP_RECVERR ) ) ||
+                      ( ( pCmsg->cmsg_level == IPPROTO_IPV6 ) &&
+                        ( pCmsg->cmsg_type == IPV6_RECVERR ) ) )
+            {
+                memcpy( &ee, CMSG_DATA( pCmsg ), sizeof( ee ) );
+                haveErr = true;
+            }
+        }
+
+        if ( ( haveStamp == false ) ||
+             ( haveErr == false ) ||
+             ( ee.ee_origin != SO_EE_ORIGIN_TIMESTAMPING ) )
+        {
+            /* not a transmit timestamp */
+            continue;
+        }
+
+        if ( ee.ee_info == SCM_TSTAMP_SCHED )
+        {
+            pSample->type = TXSTAMP_TYPE_SCHED;
+            stamp_ns = ToNs( &tss.ts[0] );
+        }
+        else if ( ee.ee_info == SCM_TSTAMP_SND )
+        {
+            /* hardware timestamps are in ts[2], software in ts[0] */
+            stamp_ns = ToNs( &tss.ts[2] );
+            if ( stamp_ns != 0 )
+            {
+                pSample->type = TXSTAMP_TYPE_WIRE;
+            }
+            else
+            {
+                pSample->type = TXSTAMP_TYPE_DRIVER;
+                stamp_ns = ToNs( &tss.ts[0] );
+            }
+        }
+        else
+        {
+            continue;
+        }
+
+        pPending = &pSocket->pending[ee.ee_data % TXSTAMP_PENDING];
+        if ( ( pPending->valid == false ) ||
+             ( pPending->key != ee.ee_data ) ||
+             ( stamp_ns < pPending->sent_ns ) ||
+             ( stamp_ns - pPending->sent_ns > TXSTAMP_MAX_LATENCY_NS ) )
+        {
+            pTxStamp->unmatched++;
+            continue;
+        }
+
+        pSample->pCtx = pPending->pCtx;
+        pSample->latency_ns = stamp_ns - pPending->sent_ns;
+        pTxStamp->samples++;
+
+        return EOK;
+    }
+}
+
+/*============================================================================*/
+/*  TXSTAMP_CountHardware                                                     */
+/*!
+    Count the sockets with hardware timestamps
+
+    @param[in]
+        pTxStamp
+            pointer to the transmit timestamp tracker
+
+    @retval number of sockets on interfaces with hardware timestamps
+
+==============================================================================*/
+size_t TXSTAMP_CountHardware( TxStamp *pTxStamp )
+{
+    size_t count = 0;
+    size_t i;
+
+    if ( pTxStamp != NULL )
+    {
+        for ( i = 0; i < pTxStamp->n; i++ )
+        {
+            if ( pTxStamp->sockets[i].hardware == true )
+            {
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
+
+/*============================================================================*/
+/*  TXSTAMP_ModeName                                                          */
+/*!
+    Get the name of a timestamp mode
+
+    @param[in]
+        mode
+            timestamp mode
+
+    @retval name of the timestamp mode
+
+==============================================================================*/
+const char *TXSTAMP_ModeName( int mode )
+{
+    return ( mode == TXSTAMP_HARDWARE ) ? "hardware"
+           : ( mode == TXSTAMP_SOFTWARE ) ? "software"
+           : "off";
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  FindSocket                                                                */
+/*!
+    Find a timestamped socket
+
+    @param[in]
+        pTxStamp
+            pointer to the transmit timestamp tracker
+
+    @param[in]
+        fd
+            socket to find
+
+    @retval pointer to the timestamped socket
+    @retval NULL the socket is not timestamped
+
+==============================================================================*/
+static TxStampSocket *FindSocket( TxStamp *pTxStamp, int fd )
+{
+    size_t i;
+
+    if ( ( pTxStamp != NULL ) &&
+         ( fd >= 0 ) )
+    {
+        for ( i = 0; i < pTxStamp->n; i++ )
+        {
+            if ( pTxStamp->sockets[i].fd == fd )
+            {
+                return &pTxStamp->sockets[i];
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/*============================================================================*/
+/*  EnableHardware                                                            */
+/*!
+    Turn on hardware transmit timestamps in an interface
+
+    The EnableHardware function reads the hardware timestamping
+    configuration of an interface, and turns on transmit timestamping
+    if it is off.  The receive filter is left as it is.
+
+    @param[in]
+        fd
+            socket to issue the ioctls on
+
+    @param[in]
+        ifname
+            name of the interface
+
+    @retval true the interface takes hardware transmit timestamps
+    @retval false hardware transmit timestamps are not available
+
+==============================================================================*/
+static bool EnableHardware( int fd, const char *ifname )
+{
+    struct hwtstamp_config config;
+    struct ifreq ifr;
+
+    memset( &ifr, 0, sizeof( ifr ) );
+    memset( &config, 0, sizeof( config ) );
+    snprintf( ifr.ifr_name, sizeof( ifr.ifr_name ), "%s", ifname );
+    ifr.ifr_data = (void *)&config;
+
+    if ( ioctl( fd, SIOCGHWTSTAMP, &ifr ) != 0 )
+    {
+        return false;
+    }
+
+    if ( config.tx_type == HWTSTAMP_TX_ON )
+    {
+        return true;
+    }
+
+    config.tx_type = HWTSTAMP_TX_ON;
+
+    return ( ioctl( fd, SIOCSHWTSTAMP, &ifr ) == 0 );
+}
+
+/*============================================================================*/
+/*  ToNs                                                                      */
+/*!
+    Convert a timespec to nanoseconds
+
+    @param[in]
+        pTs
+            pointer to the timespec
+
+    @retval time in nanoseconds
+
+==============================================================================*/
+static uint64_t ToNs( const struct timespec *pTs )
+{
+    return (uint64_t)pTs->tv_sec * 1000000000ULL + (uint64_t)pTs->tv_nsec;
+}
+
+/*! @}
+ * end of txstamp group */
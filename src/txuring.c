@@ -0,0 +1,710 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup txuring io_uring Transmit Backend
+ * @brief Sends transmit batches using io_uring
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file txuring.c
+
+    io_uring Transmit Backend
+
+    The txuring component sends the datagrams of a transmit batch using
+    io_uring instead of sendmmsg().  All of the datagrams of the batch
+    are submitted, and their completions waited for, with a single
+    io_uring_enter() call.
+
+    The cached interface sockets are registered in a sparse fixed file
+    table the first time they are used, so the kernel does not look up
+    the file on every send.  The preallocated datagram buffers of the
+    transmit batches are registered as fixed buffers, so the datagrams
+    built in them are sent with zero copy fixed buffer sends.  Datagrams
+    with ancillary data (for example UDP GSO segment trains) are sent
+    with an ordinary sendmsg operation.
+
+    The backend is only available if udpt was built with liburing
+    (UDPT_WITH_URING).  At run time, each optional feature which the
+    kernel does not support is disabled, falling back to the plainer
+    form of send.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <varserver/varserver.h>
+#ifdef UDPT_WITH_URING
+#include <liburing.h>
+#endif
+#include "txuring.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! completion user data flag marking a zero copy send */
+#define TXURING_ZC_FLAG ( 1ULL << 63 )
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+#ifdef UDPT_WITH_URING
+static void PrepareSend( TxUring *pUring,
+                         TxBatch *pBatch,
+                         size_t i,
+                         struct io_uring_sqe *pSqe );
+static int GetFileIndex( TxUring *pUring, int fd );
+static int GetBufferIndex( TxUring *pUring, const void *p, size_t len );
+static void ReapCompletions( TxUring *pUring,
+                             TxBatch *pBatch,
+                             size_t submitted );
+#endif
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  TXURING_IsSupported                                                       */
+/*!
+    Check if the io_uring transmit backend is available
+
+    The TXURING_IsSupported function checks if udpt was built with
+    liburing.  The kernel may still not support io_uring.
+
+    @retval true the io_uring backend is available
+    @retval false the io_uring backend is not available
+
+==============================================================================*/
+bool TXURING_IsSupported( void )
+{
+#ifdef UDPT_WITH_URING
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*============================================================================*/
+/*  TXURING_Init                                                              */
+/*!
+    Initialize the io_uring transmit backend
+
+    The TXURING_Init function creates an io_uring instance large enough
+    to submit a full transmit batch at once, with room in the completion
+    queue for the zero copy notifications, and sets up its sparse fixed
+    file table.
+
+    @param[in]
+        pUring
+            pointer to the io_uring backend to initialize
+
+    @retval EOK the io_uring backend is ready
+    @retval ENOTSUP udpt was built without liburing
+    @retval ENOMEM memory allocation failed
+    @retval EINVAL invalid arguments
+    @retval other error from io_uring_queue_init_params
+
+==============================================================================*/
+int TXURING_Init( TxUring *pUring )
+{
+    int result = EINVAL;
+#ifdef UDPT_WITH_URING
+    struct io_uring *pRing;
+    struct io_uring_params params;
+    size_t i;
+    int rc;
+#endif
+
+    if ( pUring != NULL )
+    {
+        memset( pUring, 0, sizeof( TxUring ) );
+
+#ifdef UDPT_WITH_URING
+        for ( i = 0; i < TXURING_MAX_FILES; i++ )
+        {
+            pUring->files[i] = -1;
+        }
+
+        result = ENOMEM;
+        pRing = calloc( 1, sizeof( struct io_uring ) );
+        if ( pRing != NULL )
+        {
+            memset( &params, 0, sizeof( params ) );
+            params.flags = IORING_SETUP_CQSIZE;
+            params.cq_entries = 2 * TXBATCH_MAX_MSGS;
+
+            rc = io_uring_queue_init_params( TXBATCH_MAX_MSGS,
+                                             pRing,
+                                             &params );
+            if ( rc == 0 )
+            {
+                pUring->pRing = pRing;
+
+                /* sockets are registered as they are first used */
+                pUring->fixedFiles =
+                    ( io_uring_register_files_sparse( pRing,
+                                                      TXURING_MAX_FILES ) == 0 );
+                result = EOK;
+            }
+            else
+            {
+                free( pRing );
+                result = -rc;
+            }
+        }
+#else
+        result = ENOTSUP;
+#endif
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  TXURING_RegisterBuffers                                                   */
+/*!
+    Register the datagram buffers with the io_uring instance
+
+    The TXURING_RegisterBuffers function registers the buffers which the
+    datagrams are built in, so datagrams in them can be sent with zero
+    copy fixed buffer sends.  If registration fails, for example because
+    of the locked memory limit, datagrams are copied as usual.
+
+    @param[in]
+        pUring
+            pointer to the io_uring backend
+
+    @param[in]
+        pBuffers
+            array of buffers to register
+
+    @param[in]
+        count
+            number of buffers to register
+
+    @retval EOK the buffers were registered
+    @retval E2BIG too many buffers
+    @retval ENOTSUP udpt was built without liburing
+    @retval EINVAL invalid arguments
+    @retval other error from io_uring_register_buffers
+
+==============================================================================*/
+int TXURING_RegisterBuffers( TxUring *pUring,
+                             const struct iovec *pBuffers,
+                             size_t count )
+{
+    int result = EINVAL;
+#ifdef UDPT_WITH_URING
+    int rc;
+#endif
+
+    if ( ( pUring != NULL ) &&
+         ( pUring->pRing != NULL ) &&
+         ( pBuffers != NULL ) &&
+         ( count > 0 ) )
+    {
+        result = E2BIG;
+        if ( count <= TXURING_MAX_BUFFERS )
+        {
+#ifdef UDPT_WITH_URING
+            rc = io_uring_register_buffers( (struct io_uring *)pUring->pRing,
+                                            pBuffers,
+                                            count );
+            if ( rc == 0 )
+            {
+                memcpy( pUring->buffers,
+                        pBuffers,
+                        count * sizeof( struct iovec ) );
+                pUring->nBuffers = count;
+                pUring->zeroCopy = true;
+                result = EOK;
+            }
+            else
+            {
+                result = -rc;
+            }
+#else
+            result = ENOTSUP;
+#endif
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  TXURING_Send                                                              */
+/*!
+    Send all of the datagrams in a transmit batch using io_uring
+
+    The TXURING_Send function queues a send for every datagram in the
+    batch, submits them all and waits for their completions with one
+    io_uring_enter() call, and stores the result of each datagram in
+    the batch result array in the same way as TXBATCH_Send.  If the
+    backend is not initialized, the batch is sent using TXBATCH_Send.
+
+    @param[in]
+        pUring
+            pointer to the io_uring backend
+
+    @param[in]
+        pBatch
+            pointer to the transmit batch
+
+    @retval EOK all the datagrams were sent
+    @retval EIO one or more datagrams could not be sent
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int TXURING_Send( TxUring *pUring, TxBatch *pBatch )
+{
+    int result = EINVAL;
+#ifdef UDPT_WITH_URING
+    struct io_uring *pRing;
+    struct io_uring_sqe *pSqe;
+    size_t submitted = 0;
+    size_t i;
+    int rc;
+#endif
+
+    if ( ( pUring == NULL ) ||
+         ( pUring->pRing == NULL ) )
+    {
+        result = TXBATCH_Send( pBatch );
+    }
+#ifdef UDPT_WITH_URING
+    else if ( pBatch != NULL )
+    {
+        pRing = (struct io_uring *)pUring->pRing;
+        pBatch->nCalls = 0;
+
+        for ( i = 0; i < pBatch->n; i++ )
+        {
+            pSqe = io_uring_get_sqe( pRing );
+            if ( pSqe == NULL )
+            {
+                /* the submission queue is full */
+                pBatch->result[i] = EBUSY;
+            }
+            else
+            {
+                pBatch->result[i] = EINPROGRESS;
+                PrepareSend( pUring, pBatch, i, pSqe );
+                submitted++;
+            }
+        }
+
+        if ( submitted > 0 )
+        {
+            rc = io_uring_submit_and_wait( pRing, submitted );
+            pBatch->nCalls++;
+
+            if ( ( rc >= 0 ) || ( rc == -EINTR ) )
+            {
+                ReapCompletions( pUring, pBatch, submitted );
+            }
+        }
+
+        result = EOK;
+        for ( i = 0; i < pBatch->n; i++ )
+        {
+            if ( pBatch->result[i] == EINPROGRESS )
+            {
+                pBatch->result[i] = EIO;
+            }
+
+            if ( pBatch->result[i] != EOK )
+            {
+                result = EIO;
+            }
+        }
+    }
+#endif
+
+    return result;
+}
+
+/*============================================================================*/
+/*  TXURING_ResetFiles                                                        */
+/*!
+    Remove all of the sockets from the fixed file table
+
+    The TXURING_ResetFiles function removes every registered socket from
+    the fixed file table.  It must be called before any cached socket
+    is closed, since the fixed file table keeps its own reference to
+    the socket, and its descriptor number may be re-used by a new
+    socket.
+
+    @param[in]
+        pUring
+            pointer to the io_uring backend
+
+==============================================================================*/
+void TXURING_ResetFiles( TxUring *pUring )
+{
+#ifdef UDPT_WITH_URING
+    int none = -1;
+    size_t i;
+
+    if ( ( pUring != NULL ) &&
+         ( pUring->pRing != NULL ) )
+    {
+        for ( i = 0; i < TXURING_MAX_FILES; i++ )
+        {
+            if ( pUring->files[i] != -1 )
+            {
+                (void)io_uring_register_files_update(
+                                    (struct io_uring *)pUring->pRing,
+                                    (unsigned)i,
+                                    &none,
+                                    1 );
+                pUring->files[i] = -1;
+            }
+        }
+    }
+#else
+    (void)pUring;
+#endif
+}
+
+/*============================================================================*/
+/*  TXURING_Close                                                             */
+/*!
+    Close the io_uring transmit backend
+
+    The TXURING_Close function releases the io_uring instance, along with
+    its registered files and buffers.
+
+    @param[in]
+        pUring
+            pointer to the io_uring backend
+
+==============================================================================*/
+void TXURING_Close( TxUring *pUring )
+{
+    if ( ( pUring != NULL ) &&
+         ( pUring->pRing != NULL ) )
+    {
+#ifdef UDPT_WITH_URING
+        io_uring_queue_exit( (struct io_uring *)pUring->pRing );
+#endif
+        free( pUring->pRing );
+        pUring->pRing = NULL;
+        pUring->nBuffers = 0;
+        pUring->fixedFiles = false;
+        pUring->zeroCopy = false;
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+#ifdef UDPT_WITH_URING
+/*============================================================================*/
+/*  PrepareSend                                                               */
+/*!
+    Prepare the send of one datagram of a transmit batch
+
+    The PrepareSend function prepares a submission queue entry to send
+    a datagram of the batch.  A datagram in a registered buffer without
+    ancillary data is sent with a zero copy fixed buffer send, if zero
+    copy sends are enabled, and any other datagram is sent with
+    sendmsg.  The socket's fixed file slot is used if it has one.
+
+    @param[in]
+        pUring
+            pointer to the io_uring backend
+
+    @param[in]
+        pBatch
+            pointer to the transmit batch
+
+    @param[in]
+        i
+            index of the datagram in the batch
+
+    @param[in]
+        pSqe
+            pointer to the submission queue entry to prepare
+
+==============================================================================*/
+static void PrepareSend( TxUring *pUring,
+                         TxBatch *pBatch,
+                         size_t i,
+                         struct io_uring_sqe *pSqe )
+{
+    struct msghdr *pHdr = &pBatch->msgs[i].msg_hdr;
+    uint64_t data = i;
+    int file;
+    int buf;
+
+    file = ( pUring->fixedFiles == true )
+           ? GetFileIndex( pUring, pBatch->fd[i] )
+           : -1;
+
+    buf = ( ( pUring->zeroCopy == true ) &&
+            ( pHdr->msg_controllen == 0 ) )
+          ? GetBufferIndex( pUring,
+                            pBatch->iov[i].iov_base,
+                            pBatch->iov[i].iov_len )
+          : -1;
+
+    if ( buf >= 0 )
+    {
+        io_uring_prep_send_zc_fixed( pSqe,
+                                     ( file >= 0 ) ? file : pBatch->fd[i],
+                                     pBatch->iov[i].iov_base,
+                                     pBatch->iov[i].iov_len,
+                                     0,
+                                     0,
+                                     (unsigned)buf );
+        io_uring_prep_send_set_addr( pSqe,
+                                     (struct sockaddr *)pHdr->msg_name,
+                                     (__u16)pHdr->msg_namelen );
+        data |= TXURING_ZC_FLAG;
+    }
+    else
+    {
+        io_uring_prep_sendmsg( pSqe,
+                               ( file >= 0 ) ? file : pBatch->fd[i],
+                               pHdr,
+                               0 );
+    }
+
+    if ( file >= 0 )
+    {
+        pSqe->flags |= IOSQE_FIXED_FILE;
+    }
+
+    io_uring_sqe_set_data64( pSqe, data );
+}
+
+/*============================================================================*/
+/*  GetFileIndex                                                              */
+/*!
+    Get the fixed file slot of a socket
+
+    The GetFileIndex function gets the fixed file slot the socket is
+    registered in, registering it in a free slot if it is not
+    registered yet.
+
+    @param[in]
+        pUring
+            pointer to the io_uring backend
+
+    @param[in]
+        fd
+            socket to look up
+
+    @retval index of the fixed file slot
+    @retval -1 the socket could not be registered
+
+==============================================================================*/
+static int GetFileIndex( TxUring *pUring, int fd )
+{
+    int index = -1;
+    int slot = -1;
+    int i;
+
+    for ( i = 0; ( i < TXURING_MAX_FILES ) && ( index == -1 ); i++ )
+    {
+        if ( pUring->files[i] == fd )
+        {
+            index = i;
+        }
+        else if ( ( pUring->files[i] == -1 ) &&
+                  ( slot == -1 ) )
+        {
+            slot = i;
+        }
+    }
+
+    if ( ( index == -1 ) &&
+         ( slot != -1 ) &&
+         ( io_uring_register_files_update( (struct io_uring *)pUring->pRing,
+                                           (unsigned)slot,
+                                           &fd,
+                                           1 ) == 1 ) )
+    {
+        /* register the socket in the free slot */
+        pUring->files[slot] = fd;
+        index = slot;
+    }
+
+    return index;
+}
+
+/*============================================================================*/
+/*  GetBufferIndex                                                            */
+/*!
+    Get the registered buffer containing a datagram
+
+    The GetBufferIndex function finds the registered buffer which
+    entirely contains the datagram.
+
+    @param[in]
+        pUring
+            pointer to the io_uring backend
+
+    @param[in]
+        p
+            pointer to the datagram
+
+    @param[in]
+        len
+            length of the datagram
+
+    @retval index of the registered buffer
+    @retval -1 the datagram is not in a registered buffer
+
+==============================================================================*/
+static int GetBufferIndex( TxUring *pUring, const void *p, size_t len )
+{
+    const char *pStart;
+    const char *pData = (const char *)p;
+    int index = -1;
+    size_t i;
+
+    for ( i = 0; ( i < pUring->nBuffers ) && ( index == -1 ); i++ )
+    {
+        pStart = (const char *)pUring->buffers[i].iov_base;
+        if ( ( pData >= pStart ) &&
+             ( len <= pUring->buffers[i].iov_len ) &&
+             ( (size_t)( pData - pStart ) <=
+               pUring->buffers[i].iov_len - len ) )
+        {
+            index = (int)i;
+        }
+    }
+
+    return index;
+}
+
+/*============================================================================*/
+/*  ReapCompletions                                                           */
+/*!
+    Collect the completions of a submitted transmit batch
+
+    The ReapCompletions function waits for the completion of every
+    submitted send, and stores its result in the batch.  Zero copy
+    sends post a second notification completion once the kernel no
+    longer needs the buffer, so those are waited for as well before
+    the batch buffers are re-used.  If the kernel rejects zero copy
+    sends, they are disabled and later datagrams are copied.  The
+    rejected datagrams report the error in their batch result, so it
+    is counted with the other send errors.
+
+    @param[in]
+        pUring
+            pointer to the io_uring backend
+
+    @param[in]
+        pBatch
+            pointer to the transmit batch
+
+    @param[in]
+        submitted
+            number of sends which were submitted
+
+==============================================================================*/
+static void ReapCompletions( TxUring *pUring,
+                             TxBatch *pBatch,
+                             size_t submitted )
+{
+    struct io_uring *pRing = (struct io_uring *)pUring->pRing;
+    struct io_uring_cqe *pCqe;
+    size_t pending = submitted;
+    size_t notifications = 0;
+    uint64_t data;
+    size_t i;
+    int rc = 0;
+
+    while ( ( rc == 0 ) &&
+            ( ( pending > 0 ) || ( notifications > 0 ) ) )
+    {
+        rc = io_uring_wait_cqe( pRing, &pCqe );
+        if ( rc == -EINTR )
+        {
+            /* wait again */
+            rc = 0;
+        }
+        else if ( rc == 0 )
+        {
+            data = io_uring_cqe_get_data64( pCqe );
+            i = (size_t)( data & ~TXURING_ZC_FLAG );
+
+            if ( pCqe->flags & IORING_CQE_F_NOTIF )
+            {
+                /* the kernel is done with a zero copy buffer */
+                notifications--;
+            }
+            else
+            {
+                if ( pCqe->flags & IORING_CQE_F_MORE )
+                {
+                    /* a notification will follow */
+                    notifications++;
+                }
+
+                if ( i < pBatch->n )
+                {
+                    pBatch->result[i] = ( pCqe->res >= 0 ) ? EOK
+                                                           : -pCqe->res;
+                }
+
+                if ( ( data & TXURING_ZC_FLAG ) &&
+                     ( ( pCqe->res == -EOPNOTSUPP ) ||
+                       ( pCqe->res == -EINVAL ) ) )
+                {
+                    /* the failed datagram reports the error, later
+                       datagrams are copied */
+                    pUring->zeroCopy = false;
+                }
+
+                pending--;
+            }
+
+            io_uring_cqe_seen( pRing, pCqe );
+        }
+    }
+}
+#endif
+
+/*! @}
+ * end of txuring group */
@@ -60,16 +60,42 @@ SOFTWARE.
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
-#include <ifaddrs.h>
+#include <netinet/udp.h>
 #include <netdb.h>
 #include <net/if.h>
 #include <linux/if_link.h>
+#include <linux/errqueue.h>
 #include <sys/mman.h>
 #include <signal.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
 #include <time.h>
+#include <limits.h>
+#include <ifaddrs.h>
+#include <net/ethernet.h>
+#include <netpacket/packet.h>
 #include <varserver/varserver.h>
-#include <varserver/vartemplate.h>
 #include <varserver/varfp.h>
+#include "sockcache.h"
+#include "pacing.h"
+#include "txstamp.h"
+#include "rtmode.h"
+#include "loadgen.h"
+#include "sublist.h"
+#include "ifset.h"
+#include "varsnap.h"
+#include "iftable.h"
+#include "ctemplate.h"
+#include "txbatch.h"
+#include "txring.h"
+#include "txuring.h"
+#include "txsched.h"
+#include "histogram.h"
+#include "udptmsg.h"
+#include "compress.h"
+#include "hash.h"
+#include "cbor.h"
 
 /*==============================================================================
         Private definitions
@@ -77,13 +103,43 @@ SOFTWARE.
 
 #ifndef INTERFACE_LIST_LEN
 /*! length of the interface list string */
-#define INTERFACE_LIST_LEN ( 256 )
+#define INTERFACE_LIST_LEN ( 4096 )
+#endif
+
+#ifndef GROUP_LIST_LEN
+/*! length of the multicast group list string */
+#define GROUP_LIST_LEN ( 128 )
+#endif
+
+#ifndef SUBSCRIBER_LIST_LEN
+/*! length of the subscriber list string */
+#define SUBSCRIBER_LIST_LEN ( 1024 )
+#endif
+
+#ifndef SUBSCRIBER_SNDBUF
+/*! send buffer size requested for the subscriber sockets, which queue
+    a datagram for every subscriber at once */
+#define SUBSCRIBER_SNDBUF ( 1048576 )
 #endif
 
+/*! name of the statistics entry of the unicast subscriber fan-out */
+#define SUBSCRIBER_IFNAME "subscribers"
+
 #ifndef MAX_UDPT_SIZE
+/*! default maximum size of the rendered payload */
 #define MAX_UDPT_SIZE ( 1472 )
 #endif
 
+#ifndef MAX_PAYLOAD_LIMIT
+/*! upper limit for the maximum rendered payload size option */
+#define MAX_PAYLOAD_LIMIT ( 1048576 )
+#endif
+
+#ifndef MAX_GSO_BUFFERS
+/*! number of UDP GSO buffers which may be queued in one transmit batch */
+#define MAX_GSO_BUFFERS ( 4 )
+#endif
+
 #ifndef IPADDR_SIZE
 #define IPADDR_SIZE ( 128 )
 #endif
@@ -92,26 +148,215 @@ SOFTWARE.
 #define TEMPLATE_FILENAME_SIZE  ( 256 )
 #endif
 
-/*! UDP Template Engine state object */
-typedef struct _udptState
+/*! splice field of the interface IP address */
+#define SPLICE_IPADDR ( 0 )
+
+/*! splice field of the load generator source seed */
+#define SPLICE_LOAD_SEED ( 1 )
+
+/*! splice field of the load generator source sequence number */
+#define SPLICE_LOAD_SEQ ( 2 )
+
+/*! number of splice fields */
+#define SPLICE_FIELDS ( 3 )
+
+/*! size of an encoded splice field.  The IP address is the longest */
+#define SPLICE_FIELD_SIZE ( CBOR_MAX_HEAD_SIZE + IPADDR_SIZE )
+
+#ifndef CACHE_REFRESH_RENDERS
+/*! number of incremental renderings after which every template variable
+    is formatted again, as a safety net for missed notifications */
+#define CACHE_REFRESH_RENDERS ( 1000 )
+#endif
+
+#ifndef MAX_PENDING_MODIFIED
+/*! maximum number of distinct modified variables coalesced per wakeup */
+#define MAX_PENDING_MODIFIED ( 64 )
+#endif
+
+#ifndef MAX_SIGNALS_PER_READ
+/*! maximum number of signals read from the signalfd in one read() */
+#define MAX_SIGNALS_PER_READ ( 32 )
+#endif
+
+#ifndef MAX_EPOLL_EVENTS
+/*! maximum number of events returned from one epoll_wait() */
+#define MAX_EPOLL_EVENTS ( 8 )
+#endif
+
+#ifndef MAX_STALE_FDS
+/*! maximum number of stale sockets waiting to be invalidated */
+#define MAX_STALE_FDS ( 8 )
+#endif
+
+#ifndef RT_MAX_SNAPSHOT_VARS
+/*! number of snapshot variables preallocated by the real-time mode */
+#define RT_MAX_SNAPSHOT_VARS ( 512 )
+#endif
+
+#ifndef RT_MAX_IFINDEX
+/*! largest interface index preallocated by the real-time mode */
+#define RT_MAX_IFINDEX ( 1023 )
+#endif
+
+#ifndef MAX_IFSTATS
+/*! maximum number of interfaces to keep transmission statistics for */
+#define MAX_IFSTATS ( 32 )
+#endif
+
+#ifndef MAX_CHANNELS
+/*! maximum number of broadcast channels.  Each channel takes one entry
+    of the transmission and change schedules, which hold up to
+    SCHED_MAX_ENTRIES entries each */
+#define MAX_CHANNELS ( 16 )
+#endif
+
+/*! IPv4 and UDP header bytes sent with each datagram, counted by pacing
+    and segment sizing */
+#define UDP_IPV4_OVERHEAD ( 28 )
+
+/*! IPv6 and UDP header bytes sent with each datagram, counted by pacing
+    and segment sizing */
+#define UDP_IPV6_OVERHEAD ( 48 )
+
+/*! largest UDP payload, which also bounds the length of a UDP GSO train */
+#define UDP_MAX_PAYLOAD ( 65507 )
+
+/*! MTU assumed for links whose MTU is not known, and for subscribers */
+#define DEFAULT_MTU ( 1500 )
+
+/*! number of configuration variables per broadcast channel */
+#define CHANNEL_VAR_COUNT ( 15 )
+
+/*! channel payload encoding: rendered template text */
+#define ENCODING_TEXT ( 0 )
+
+/*! channel payload encoding: CBOR array of the template variable values */
+#define ENCODING_CBOR ( 1 )
+
+/*! per-interface transmission statistics */
+typedef struct _udptIfStats
 {
-    /*! variable definition list */
-    struct _varDef *pVarDef;
+    /*! name of the interface */
+    char ifname[IFNAMSIZ];
 
-    /*! count of variables */
-    size_t varCount;
+    /*! address family sent on the interface */
+    int family;
 
-    /*! variable server handle */
-    VARSERVER_HANDLE hVarServer;
+    /*! transmission counter */
+    uint32_t txcount;
 
-    /*! verbose variable name */
-    char *verboseVarName;
+    /*! transmission error counter */
+    uint32_t errcount;
 
-    /*! verbose variable handle */
-    VAR_HANDLE hVerbose;
+    /*! number of payload bytes transmitted */
+    uint64_t bytes;
 
-    /*! verbose flag */
-    uint16_t verbose;
+    /*! errno value of the most recent transmission error */
+    int lastError;
+
+    /*! hash of the most recently transmitted payload */
+    uint64_t hash;
+
+    /*! indicates the payload hash is valid */
+    bool hashValid;
+
+    /*! number of consecutive unchanged payloads which were suppressed */
+    uint32_t unchanged;
+
+    /*! number of unchanged payloads which were not transmitted */
+    uint32_t suppressed;
+
+    /*! number of payloads deferred to a later launch time by pacing */
+    uint32_t deferred;
+
+    /*! number of payloads dropped because they exceeded the pacing rate */
+    uint32_t pacedDrops;
+
+    /*! latency from the send to the qdisc (transmit timestamps) */
+    Histogram txSched;
+
+    /*! latency from the send to the device driver (transmit timestamps) */
+    Histogram txDriver;
+
+    /*! latency from the send to the wire (hardware transmit timestamps) */
+    Histogram txWire;
+
+} UDPTIfStats;
+
+struct _udptState;
+struct _udptChannel;
+
+/*! Var Definition object to define a message variable to be created */
+typedef struct _varDef
+{
+    /* name of the variable */
+    char **name;
+
+    /*! variable flags to be set */
+    uint32_t flags;
+
+    /*! variable type */
+    VarType type;
+
+    /*! length variable (used for strings/blobs only) */
+    size_t len;
+
+    /*! notification type for the variable */
+    NotificationType notifyType;
+
+    /*! pointer to a location to store the variable handle once it is created */
+    VAR_HANDLE *pVarHandle;
+
+    /*! pointer to store the variable value */
+    void *pVal;
+
+    /*! callback function */
+    int (*cb)( struct _udptState *pState, struct _udptChannel *pChannel );
+
+} VarDef;
+
+/*! compiled template shared by all channels which use the same file */
+typedef struct _udptTemplate
+{
+    /*! name of the template file */
+    char filename[TEMPLATE_FILENAME_SIZE];
+
+    /*! number of channels using this template */
+    size_t refCount;
+
+    /*! compiled template */
+    CompiledTemplate compiled;
+
+    /*! payload compressor, using the template's static text as its
+        dictionary */
+    Compressor compressor;
+
+    /*! template generation the compression dictionary was built from */
+    uint32_t dictGeneration;
+
+    /*! template variable bindings whose variables we have requested
+        modification notifications for */
+    uint32_t notifyGeneration;
+
+    /*! template variable bindings whose variables are in the variable
+        snapshot set */
+    uint32_t snapGeneration;
+
+    /*! number of incremental renders since the formatted text cache
+        was last discarded */
+    uint32_t cachedRenders;
+
+} UDPTTemplate;
+
+/*! UDP broadcast channel */
+typedef struct _udptChannel
+{
+    /*! channel name (variable name prefix), or NULL for the default channel */
+    char *name;
+
+    /*! channel variable definition list */
+    VarDef vars[CHANNEL_VAR_COUNT];
 
     /*! trigger variable name */
     char *triggerVarName;
@@ -128,23 +373,23 @@ typedef struct _udptState
     /* transmission rate (in seconds) */
     uint32_t txrate_s;
 
-    /*! enable/disable variable name */
-    char *enableVarName;
+    /*! transmission interval variable name */
+    char *txIntervalVarName;
 
-    /*! IP Address variable handle */
-    VAR_HANDLE hIPAddr;
+    /*! transmission interval variable handle */
+    VAR_HANDLE hTxInterval;
 
-    /*! IP Address */
-    char IPAddr[IPADDR_SIZE];
+    /*! transmission interval (in microseconds).  Overrides txrate_s */
+    uint32_t txinterval_us;
 
-    /*! IP Address variable name */
-    char *ipAddrVarName;
+    /*! enable/disable variable name */
+    char *enableVarName;
 
     /*! enable/disable variable handle */
     VAR_HANDLE hEnable;
 
     /*! enable/disable */
-    bool enable;
+    uint16_t enable;
 
     /*! interface variable name */
     char *interfaceVarName;
@@ -155,6 +400,9 @@ typedef struct _udptState
     /*! interface list length */
     char interfaceList[INTERFACE_LIST_LEN];
 
+    /*! compiled interface allow-list */
+    IfSet allowed;
+
     /*! name of the port variable */
     char *portVarName;
 
@@ -164,14 +412,41 @@ typedef struct _udptState
     /*! UDP broadcast port */
     uint16_t port;
 
-    /*! metrics variable name */
-    char *metricsVarName;
+    /*! name of the multicast group variable */
+    char *groupVarName;
 
-    /*! metrics variable handle */
-    VAR_HANDLE hMetrics;
+    /*! handle to the multicast group variable */
+    VAR_HANDLE hGroup;
 
-    /*! metrics - unused - placeholder only */
-    uint16_t metrics;
+    /*! comma separated multicast groups, at most one IPv4 and one IPv6
+        group.  When empty, the channel is broadcast */
+    char groupList[GROUP_LIST_LEN];
+
+    /*! indicates the channel is sent to the IPv4 multicast group */
+    bool hasGroup4;
+
+    /*! IPv4 multicast group */
+    struct in_addr group4;
+
+    /*! indicates the channel is sent to the IPv6 multicast group */
+    bool hasGroup6;
+
+    /*! IPv6 multicast group */
+    struct in6_addr group6;
+
+    /*! name of the subscriber list variable */
+    char *subscribersVarName;
+
+    /*! handle to the subscriber list variable */
+    VAR_HANDLE hSubscribers;
+
+    /*! unicast subscriber list specification: host:port entries, or
+        the name of a file containing them.  When not empty, the
+        channel is sent to the subscribers instead of the interfaces */
+    char subscriberSpec[SUBSCRIBER_LIST_LEN];
+
+    /*! unicast subscribers */
+    SubList subscribers;
 
     /*! name of the template file */
     char templateFilename[TEMPLATE_FILENAME_SIZE];
@@ -182,188 +457,618 @@ typedef struct _udptState
     /*! handle to the template file */
     VAR_HANDLE hTemplate;
 
-    /*! Variable Output stream */
-    VarFP *pVarFP;
+    /*! compiled template used by this channel */
+    UDPTTemplate *pTemplate;
 
-    /*! Variable output file descriptor */
-    int varFd;
+    /*! name of the compression variable */
+    char *compressionVarName;
 
-    /*! interval timer for UDP broadcast */
-    timer_t timer;
+    /*! handle to the compression variable */
+    VAR_HANDLE hCompression;
 
-    /*! interval timer pointer */
-    timer_t *timerID;
+    /*! payload compression algorithm (COMPRESS_NONE, COMPRESS_LZ4,
+        COMPRESS_ZSTD) */
+    uint16_t compression;
 
-    /*! transmission counter */
-    uint32_t txcount;
+    /*! name of the payload encoding variable */
+    char *encodingVarName;
 
-    /*! transmission error counter */
-    uint32_t errcount;
+    /*! handle to the payload encoding variable */
+    VAR_HANDLE hEncoding;
 
-} UDPTState;
+    /*! payload encoding (ENCODING_TEXT, ENCODING_CBOR) */
+    uint16_t encoding;
 
-/*! Var Definition object to define a message variable to be created */
-typedef struct _varDef
-{
-    /* name of the variable */
-    char **name;
+    /*! name of the heartbeat variable */
+    char *heartbeatVarName;
 
-    /*! variable flags to be set */
-    uint32_t flags;
+    /*! handle to the heartbeat variable */
+    VAR_HANDLE hHeartbeat;
 
-    /*! variable type */
-    VarType type;
+    /*! suppress periodic transmission of unchanged payloads, but still
+        transmit at least every heartbeat ticks (0 = never suppress) */
+    uint32_t heartbeat;
 
-    /*! length variable (used for strings/blobs only) */
-    size_t len;
+    /*! name of the change-triggered transmission variable */
+    char *onChangeVarName;
 
-    /*! notification type for the variable */
-    NotificationType notifyType;
+    /*! handle to the change-triggered transmission variable */
+    VAR_HANDLE hOnChange;
 
-    /*! pointer to a location to store the variable handle once it is created */
-    VAR_HANDLE *pVarHandle;
+    /*! transmit when a variable referenced by the template changes */
+    uint16_t onChange;
 
-    /*! pointer to store the variable value */
-    void *pVal;
+    /*! name of the debounce variable */
+    char *debounceVarName;
 
-    /*! callback function */
-    int (*cb)( UDPTState *pState );
+    /*! handle to the debounce variable */
+    VAR_HANDLE hDebounce;
 
-} VarDef;
+    /*! time to wait after a variable change for further changes
+        before transmitting, in microseconds */
+    uint32_t debounce_us;
 
-/*==============================================================================
-        Private file scoped variables
-==============================================================================*/
+    /*! name of the minimum interval variable */
+    char *minIntervalVarName;
 
-/*! Variable Message Manager State */
-static UDPTState state;
+    /*! handle to the minimum interval variable */
+    VAR_HANDLE hMinInterval;
 
-/*==============================================================================
-        Private function declarations
-==============================================================================*/
+    /*! minimum time between a transmission and a change-triggered
+        transmission, in microseconds */
+    uint32_t mininterval_us;
 
-int main(int argc, char **argv);
-static int ProcessOptions( int argC, char *argV[], UDPTState *pState );
-static void usage( char *cmdname );
-static void TerminationHandler( int signum, siginfo_t *info, void *ptr );
-static void SetupTerminationHandler( void );
-static int SetupVars( UDPTState *pState );
-VAR_HANDLE SetupVar( VARSERVER_HANDLE hVarServer,
-                     char *name,
-                     VarType type,
-                     size_t len,
-                     uint32_t flags,
-                     NotificationType notify );
-static int SetupTimer( UDPTState *pState );
-static int GetVar( VARSERVER_HANDLE hVarServer, VarDef *pVarDef );
-static int SetupVarFP( UDPTState *pState );
-static void RunMessageHandler( UDPTState *pState );
-static int ProcessModified( UDPTState *pState, VAR_HANDLE hVar );
-static int ProcessTimer( UDPTState *pState );
-static int ProcessTemplate( UDPTState *pState );
-static int UpdateInterfaceIP( UDPTState *pState, struct ifaddrs *ifa );
-static int SendOutput( UDPTState *pState );
-static int BindInterface( int s, struct ifaddrs *ifa );
-static bool CheckInterface( const char *interfaces, const char *interface );
-static int SendUDP( int family,
-                    struct ifaddrs *ifa,
-                    int port,
-                    char *pMsg,
-                    size_t len );
-static int HandlePrintRequest( UDPTState *pState, int32_t id );
-static int PrintUDPTInfo( VAR_HANDLE hVar, UDPTState *pState, int fd );
-static int DumpStats( UDPTState *pState, int fd );
-static void Output( int fd, char *buf, size_t len );
-static int cbTrigger( UDPTState *pState );
-static int cbTimer( UDPTState *pState );
+    /*! indicates a change-triggered transmission is scheduled */
+    bool changePending;
 
-/*==============================================================================
-        Private function definitions
-==============================================================================*/
+    /*! monotonic time of the most recent transmission in nanoseconds */
+    uint64_t lastSend_ns;
 
-/*============================================================================*/
-/*  main                                                                      */
-/*!
-    Main entry point for the UDP Template Engine
+    /*! per-interface transmission statistics */
+    UDPTIfStats ifStats[MAX_IFSTATS];
 
-    The main function starts the UDP templating engine
+    /*! number of interfaces with transmission statistics */
+    size_t nIfStats;
 
-    @param[in]
-        argc
-            number of arguments on the command line
-            (including the command itself)
+    /*! transmission period in nanoseconds (0 = no periodic transmission) */
+    uint64_t period_ns;
 
-    @param[in]
-        argv
-            array of pointers to the command line arguments
+    /*! number of scheduled transmissions which were missed */
+    uint32_t overruns;
 
-    @retval 0 - no error
-    @retval 1 - an error occurred
+    /*! transmission counter */
+    uint32_t txcount;
 
-==============================================================================*/
-int main(int argc, char **argv)
-{
-    int result = EINVAL;
-    VarDef vars[] =
-    {
-        {   &state.verboseVarName,
-            VARFLAG_NONE,
-            VARTYPE_UINT16,
-            0,
-            NOTIFY_MODIFIED,
-            &(state.hVerbose ),
-            (void *)&(state.verbose),
-            NULL },
+    /*! transmission error counter */
+    uint32_t errcount;
 
-        {   &state.triggerVarName,
-            VARFLAG_VOLATILE | VARFLAG_TRIGGER,
-            VARTYPE_UINT16,
-            0,
-            NOTIFY_MODIFIED,
-            &(state.hTrigger ),
-            NULL,
-            cbTrigger },
+    /*! identifier of the most recent transmission, sent in the
+        segment headers of segmented payloads */
+    uint16_t msgId;
 
-        {   &state.txRateVarName,
-            VARFLAG_NONE,
-            VARTYPE_UINT32,
-            0,
-            NOTIFY_MODIFIED,
-            &(state.hTxRate),
-            (void *)&(state.txrate_s),
-            cbTimer },
+    /*! number of payloads which were sent as segments */
+    uint32_t segmented;
 
-        {   &state.enableVarName,
-            VARFLAG_NONE,
-            VARTYPE_UINT16,
-            0,
-            NOTIFY_MODIFIED,
-            &(state.hEnable),
-            (void *)(&state.enable),
-            NULL },
+    /*! number of payloads which were sent compressed */
+    uint32_t compressed;
 
-        {   &state.interfaceVarName,
-            VARFLAG_NONE,
-            VARTYPE_STR,
-            INTERFACE_LIST_LEN,
-            NOTIFY_MODIFIED,
-            &(state.hInterfaceList),
-            (void *)(&state.interfaceList),
-            NULL },
+    /*! number of unchanged payloads which were not transmitted */
+    uint32_t suppressed;
 
-        {   &state.portVarName,
-            VARFLAG_NONE,
-            VARTYPE_UINT16,
-            0,
-            NOTIFY_MODIFIED,
-            &(state.hPort),
-            (void *)(&state.port),
-            NULL },
+    /*! number of datagrams which were dropped because every transmit
+        batch was waiting for the sender thread */
+    uint32_t queueFull;
 
-        {   &state.metricsVarName,
-            VARFLAG_VOLATILE,
-            VARTYPE_UINT16,
-            0,
+    /*! number of changes to template variables which were notified */
+    uint32_t changes;
+
+    /*! number of change-triggered transmissions */
+    uint32_t changeSends;
+
+    /*! total length of the compressed payloads before compression */
+    uint64_t compressIn;
+
+    /*! total length of the compressed payloads after compression */
+    uint64_t compressOut;
+
+    /*! template render time histogram */
+    Histogram renderTime;
+
+    /*! datagram send time histogram */
+    Histogram sendTime;
+
+    /*! total transmission time histogram */
+    Histogram tickTime;
+
+    /*! schedule jitter (actual versus intended transmission time) */
+    Histogram jitter;
+
+} UDPTChannel;
+
+/*! transmit batch, and the resources its datagrams refer to */
+typedef struct _udptBatch
+{
+    /*! batch of datagrams */
+    TxBatch *pTxBatch;
+
+    /*! channel the batch was built for */
+    UDPTChannel *pChannel;
+
+    /*! buffers for building UDP GSO segment trains */
+    char *pGsoBuf[MAX_GSO_BUFFERS];
+
+    /*! number of GSO buffers queued in the batch */
+    size_t nGsoUsed;
+
+} UDPTBatch;
+
+/*! UDP Template Engine state object */
+typedef struct _udptState
+{
+    /*! process-wide variable definition list */
+    struct _varDef *pVarDef;
+
+    /*! count of variables */
+    size_t varCount;
+
+    /*! variable server handle */
+    VARSERVER_HANDLE hVarServer;
+
+    /*! verbose variable name */
+    char *verboseVarName;
+
+    /*! verbose variable handle */
+    VAR_HANDLE hVerbose;
+
+    /*! verbose flag */
+    uint16_t verbose;
+
+    /*! IP Address variable handle */
+    VAR_HANDLE hIPAddr;
+
+    /*! IP Address */
+    char IPAddr[IPADDR_SIZE];
+
+    /*! IP Address last written to the IP Address variable */
+    char IPAddrVar[IPADDR_SIZE];
+
+    /*! number of writes to the IP Address variable */
+    uint32_t ipAddrWrites;
+
+    /*! IP Address variable name */
+    char *ipAddrVarName;
+
+    /*! metrics variable name */
+    char *metricsVarName;
+
+    /*! metrics variable handle */
+    VAR_HANDLE hMetrics;
+
+    /*! metrics - unused - placeholder only */
+    uint16_t metrics;
+
+    /*! broadcast channels */
+    UDPTChannel channels[MAX_CHANNELS];
+
+    /*! number of broadcast channels */
+    size_t nChannels;
+
+    /*! compiled templates shared between the channels */
+    UDPTTemplate templates[MAX_CHANNELS];
+
+    /*! render the whole template for each interface instead of splicing
+        in the per-interface fields */
+    bool perInterfaceRender;
+
+    /*! render from a snapshot of the template variables taken once per
+        event loop pass */
+    bool useSnapshot;
+
+    /*! snapshot of the variables referenced by the channel templates */
+    VarSnapshot snapshot;
+
+    /*! re-format only the template variables which have changed since
+        the previous rendering */
+    bool incremental;
+
+    /*! variables which are spliced into the rendered output, and the
+        output offsets of their references */
+    CTSplices splices;
+
+    /*! pointer to the most recently rendered output */
+    char *pRendered;
+
+    /*! length of the most recently rendered output */
+    size_t renderedLen;
+
+    /*! encoding of the most recently rendered output */
+    uint16_t renderEncoding;
+
+    /*! buffer for binary (CBOR) renderings */
+    char *pBinary;
+
+    /*! buffer for text renderings */
+    char *pText;
+
+    /*! maximum size of the rendered payload */
+    size_t maxPayload;
+
+    /*! send payloads which do not fit in one datagram as segments */
+    bool segmented;
+
+    /*! indicates UDP GSO is used to send segmented payloads */
+    bool gso;
+
+    /*! buffer for building payloads which do not fit in one datagram */
+    char *pPayload;
+
+    /*! do not use the template static text as a compression dictionary */
+    bool noDictionary;
+
+    /*! buffer for building compressed payloads */
+    char *pCompressed;
+
+    /*! size of the compressed payload buffer */
+    size_t compressedSize;
+
+    /*! batch of UDP messages to be transmitted when there is no
+        sender thread */
+    TxBatch txBatch;
+
+    /*! send the UDP messages from a sender thread */
+    bool threaded;
+
+    /*! ring of transmit batches handed to the sender thread */
+    TxRing txRing;
+
+    /*! send the UDP messages using io_uring */
+    bool useUring;
+
+    /*! io_uring transmit backend */
+    TxUring txUring;
+
+    /*! transmit batches, one for each transmit ring slot, or just one
+        when there is no sender thread */
+    UDPTBatch batches[TXRING_MAX_SLOTS];
+
+    /*! transmit batch currently being built, or NULL */
+    UDPTBatch *pBatch;
+
+    /*! sockets which reported a stale interface error, to be removed
+        from the socket cache once no batch refers to them */
+    int staleFds[MAX_STALE_FDS];
+
+    /*! number of stale sockets */
+    size_t nStale;
+
+    /*! Variable Output stream */
+    VarFP *pVarFP;
+
+    /*! Variable output file descriptor */
+    int varFd;
+
+    /*! transmission timer file descriptor, armed for the earliest
+        channel deadline */
+    int timerFd;
+
+    /*! signal file descriptor for varserver notifications */
+    int sigFd;
+
+    /*! event loop file descriptor */
+    int epollFd;
+
+    /*! transmission schedule of all the channels */
+    Schedule schedule;
+
+    /*! schedule of the pending change-triggered transmissions */
+    Schedule changeSchedule;
+
+    /*! align the periodic transmissions to the wall clock */
+    bool alignWallClock;
+
+    /*! offset of the wall clock aligned transmissions within their
+        period (nanoseconds) */
+    uint64_t alignOffset_ns;
+
+    /*! source of the transmission stagger key ("mac", "hostname" or a
+        literal key), or NULL if the transmissions are not staggered */
+    char *staggerKey;
+
+    /*! hash of the stagger key, which offsets the transmissions of this
+        instance within their period */
+    uint64_t staggerHash;
+
+    /*! cache of sockets bound to the output interfaces */
+    SockCache sockCache;
+
+    /*! per-interface transmit pacing */
+    Pacing pacing;
+
+    /*! kernel transmit timestamps of the interface sockets */
+    TxStamp txStamp;
+
+    /*! real-time mode configuration and state */
+    RtMode rt;
+
+    /*! synthetic load generator */
+    LoadGen load;
+
+    /*! channel the synthetic load is sent on, or NULL if there is none */
+    UDPTChannel *pLoadChannel;
+
+    /*! load generator timer file descriptor */
+    int loadFd;
+
+    /*! name of the variable whose references are replaced by the seed
+        of the transmitting virtual source, or NULL without -G */
+    char *loadSeedVarName;
+
+    /*! name of the variable whose references are replaced by the
+        sequence number of the transmitting virtual source, or NULL
+        without -G */
+    char *loadSeqVarName;
+
+    /*! handle to the virtual source seed variable */
+    VAR_HANDLE hLoadSeed;
+
+    /*! handle to the virtual source sequence number variable */
+    VAR_HANDLE hLoadSeq;
+
+    /*! seed of the transmitting virtual source */
+    uint32_t loadSeed;
+
+    /*! sequence number of the transmitting virtual source */
+    uint32_t loadSeq;
+
+    /*! multicast TTL (IPv4) or hop limit (IPv6), or 0 for the default */
+    int mcastHops;
+
+    /*! do not loop multicast datagrams back to local receivers */
+    bool noLoopback;
+
+    /*! unbound IPv4 and IPv6 sockets used to send to the unicast
+        subscribers of every channel */
+    int subFd[2];
+
+    /*! table of the network interface addresses */
+    IfTable ifTable;
+
+} UDPTState;
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! Variable Message Manager State */
+static UDPTState state;
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+int main(int argc, char **argv);
+static int ProcessOptions( int argC, char *argV[], UDPTState *pState );
+static void usage( char *cmdname );
+static void TerminationHandler( int signum, siginfo_t *info, void *ptr );
+static void SetupTerminationHandler( void );
+static UDPTChannel *AddChannel( UDPTState *pState, const char *prefix );
+static UDPTChannel *GetChannel( UDPTState *pState );
+static char *MakeVarName( const char *prefix, const char *suffix );
+static int SetupVars( UDPTState *pState );
+static int SetupVarDefs( UDPTState *pState, VarDef *pVarDef, size_t count );
+VAR_HANDLE SetupVar( VARSERVER_HANDLE hVarServer,
+                     char *name,
+                     VarType type,
+                     size_t len,
+                     uint32_t flags,
+                     NotificationType notify );
+static int SetupTimer( UDPTState *pState );
+static int SetupLoad( UDPTState *pState );
+static int ScheduleChannel( UDPTState *pState,
+                            UDPTChannel *pChannel,
+                            uint64_t now_ns );
+static uint64_t FirstDeadline( UDPTState *pState,
+                               UDPTChannel *pChannel,
+                               uint64_t now_ns );
+static int SetupStagger( UDPTState *pState );
+static int GetMACAddress( unsigned char *pAddr, size_t len );
+static int ArmTimer( UDPTState *pState );
+static int GetVar( VARSERVER_HANDLE hVarServer, VarDef *pVarDef );
+static int SetupVarFP( UDPTState *pState );
+static int SetupPayload( UDPTState *pState );
+static int SetupSignals( UDPTState *pState );
+static int SetupBatches( UDPTState *pState );
+static void SetupRealtime( UDPTState *pState );
+static void CheckSteadyState( UDPTState *pState, bool tick );
+static int SetupEventLoop( UDPTState *pState );
+static void RunMessageHandler( UDPTState *pState );
+static void ProcessSignals( UDPTState *pState,
+                            VAR_HANDLE *pPending,
+                            size_t *pNumPending );
+static int ProcessModified( UDPTState *pState, VAR_HANDLE hVar );
+static int ProcessChange( UDPTState *pState, VAR_HANDLE hVar );
+static int ScheduleChange( UDPTState *pState,
+                           UDPTChannel *pChannel,
+                           uint64_t now_ns );
+static int DispatchModified( UDPTState *pState,
+                             UDPTChannel *pChannel,
+                             VarDef *pVarDef,
+                             size_t count,
+                             VAR_HANDLE hVar );
+static int ProcessTimer( UDPTState *pState );
+static void ProcessLoad( UDPTState *pState );
+static void ProcessInterfaces( UDPTState *pState );
+static int ProcessTemplate( UDPTState *pState, UDPTChannel *pChannel );
+static const VarSnapshot *GetSnapshot( UDPTState *pState );
+static int RenderText( UDPTState *pState, UDPTTemplate *pTemplate );
+static void InvalidateTemplates( UDPTState *pState, VAR_HANDLE hVar );
+static int RenderCBOR( UDPTState *pState, CompiledTemplate *pTemplate );
+static UDPTTemplate *AcquireTemplate( UDPTState *pState, const char *filename );
+static void ReleaseTemplate( UDPTTemplate *pTemplate );
+static int SubscribeTemplate( UDPTState *pState, UDPTChannel *pChannel );
+static int UpdateInterfaceIP( UDPTState *pState, IfEntry *pEntry );
+static int SetIPAddr( UDPTState *pState, const char *host );
+static int SendOutput( UDPTState *pState,
+                       UDPTChannel *pChannel,
+                       bool periodic );
+static bool SuppressPayload( UDPTChannel *pChannel,
+                             UDPTIfStats *pIfStats,
+                             char *pMsg,
+                             size_t len );
+static UDPTBatch *GetBatch( UDPTState *pState, UDPTChannel *pChannel );
+static char *GetTxSlot( UDPTState *pState,
+                        UDPTChannel *pChannel,
+                        size_t *pSize );
+static bool FlushBatch( UDPTState *pState );
+static int SendBatch( void *pCtx, TxBatch *pBatch );
+static bool CompleteBatch( UDPTState *pState, UDPTBatch *pBatch );
+static void ProcessCompletions( UDPTState *pState );
+static void ReapBatches( UDPTState *pState );
+static void WaitSender( UDPTState *pState );
+static void InvalidateStale( UDPTState *pState );
+static int CompressPayload( UDPTState *pState,
+                            UDPTChannel *pChannel,
+                            char **ppMsg,
+                            size_t *pLen );
+static int UpdateDictionary( UDPTState *pState, UDPTTemplate *pTemplate );
+static int QueuePayload( UDPTState *pState,
+                         UDPTChannel *pChannel,
+                         void *pCtx,
+                         int fd,
+                         struct sockaddr_storage *pAddr,
+                         socklen_t addrlen,
+                         unsigned int mtu,
+                         size_t slotSize,
+                         char *pMsg,
+                         size_t len,
+                         const PacingEntry *pPacing,
+                         uint64_t launch_ns );
+static int QueueSegments( UDPTState *pState,
+                          UDPTChannel *pChannel,
+                          void *pCtx,
+                          int fd,
+                          struct sockaddr_storage *pAddr,
+                          socklen_t addrlen,
+                          unsigned int mtu,
+                          char *pMsg,
+                          size_t len,
+                          const PacingEntry *pPacing,
+                          uint64_t launch_ns );
+static int PacePayload( UDPTState *pState,
+                        IfEntry *pEntry,
+                        UDPTIfStats *pIfStats,
+                        size_t slotSize,
+                        size_t len,
+                        PacingEntry **ppPacing,
+                        uint64_t *pLaunch_ns );
+static size_t GetSegmentSize( int family, unsigned int mtu );
+static int AddLaunchTime( TxBatch *pTxBatch, uint64_t launch_ns );
+static int RenderPayload( UDPTState *pState,
+                          UDPTChannel *pChannel,
+                          bool *pRendered );
+static int GetPayload( UDPTState *pState,
+                       char *pOut,
+                       size_t size,
+                       char **ppMsg,
+                       size_t *pLen );
+static void EncodeFields( UDPTState *pState,
+                          char fields[][SPLICE_FIELD_SIZE],
+                          size_t *pLens );
+static int SpliceFields( UDPTState *pState,
+                         char fields[][SPLICE_FIELD_SIZE],
+                         const size_t *pLens,
+                         char *pOut,
+                         size_t size,
+                         size_t *pLen );
+static int GetDestAddr( UDPTState *pState,
+                        UDPTChannel *pChannel,
+                        IfEntry *pEntry,
+                        struct sockaddr_storage *pAddr,
+                        socklen_t *pAddrLen );
+static int GetMulticastAddr( UDPTState *pState,
+                             UDPTChannel *pChannel,
+                             IfEntry *pEntry,
+                             struct sockaddr_storage *pAddr,
+                             socklen_t *pAddrLen );
+static int ParseGroups( UDPTChannel *pChannel );
+static int GetBroadcastAddr( IfEntry *pEntry,
+                             int port,
+                             struct sockaddr_storage *pAddr,
+                             socklen_t *pAddrLen );
+static UDPTIfStats *GetIfStats( UDPTChannel *pChannel,
+                                const char *ifname,
+                                int family );
+static int HandlePrintRequest( UDPTState *pState, int32_t id );
+static int PrintUDPTInfo( VAR_HANDLE hVar, UDPTState *pState, int fd );
+static int DumpStats( UDPTState *pState, int fd );
+static void DumpChannelStats( UDPTChannel *pChannel, int fd );
+static void DumpSubscribers( UDPTChannel *pChannel, int fd );
+static void DumpCacheStats( UDPTState *pState, int fd );
+static void DumpPacingStats( UDPTState *pState, int fd );
+static void DumpTxStampStats( UDPTIfStats *pIfStats, int fd );
+static void DumpRealtimeStats( UDPTState *pState, int fd );
+static void DumpLoadStats( UDPTState *pState, int fd );
+static int cbTrigger( UDPTState *pState, UDPTChannel *pChannel );
+static int cbTimer( UDPTState *pState, UDPTChannel *pChannel );
+static int cbInterfaces( UDPTState *pState, UDPTChannel *pChannel );
+static int cbTemplate( UDPTState *pState, UDPTChannel *pChannel );
+static int cbCompression( UDPTState *pState, UDPTChannel *pChannel );
+static int cbOnChange( UDPTState *pState, UDPTChannel *pChannel );
+static int cbGroup( UDPTState *pState, UDPTChannel *pChannel );
+static int cbSubscribers( UDPTState *pState, UDPTChannel *pChannel );
+static int SetupSubscribers( UDPTState *pState );
+static int SendSubscribers( UDPTState *pState,
+                            UDPTChannel *pChannel,
+                            bool periodic );
+static int GetSubscriberSocket( UDPTState *pState, int family );
+static bool IsSubscriberSocket( UDPTState *pState, int fd );
+static void SubscriberError( Subscriber *pSub, int err );
+static void ProcessSubscriberErrors( UDPTState *pState, int fd );
+static void ProcessTxStamps( UDPTState *pState );
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  main                                                                      */
+/*!
+    Main entry point for the UDP Template Engine
+
+    The main function starts the UDP templating engine
+
+    @param[in]
+        argc
+            number of arguments on the command line
+            (including the command itself)
+
+    @param[in]
+        argv
+            array of pointers to the command line arguments
+
+    @retval 0 - no error
+    @retval 1 - an error occurred
+
+==============================================================================*/
+int main(int argc, char **argv)
+{
+    int result = EINVAL;
+    size_t i;
+    VarDef vars[] =
+    {
+        {   &state.verboseVarName,
+            VARFLAG_NONE,
+            VARTYPE_UINT16,
+            0,
+            NOTIFY_MODIFIED,
+            &(state.hVerbose ),
+            (void *)&(state.verbose),
+            NULL },
+
+        {   &state.metricsVarName,
+            VARFLAG_VOLATILE,
+            VARTYPE_UINT16,
+            0,
             NOTIFY_PRINT,
             &(state.hMetrics),
             (void *)(&state.metrics),
@@ -378,30 +1083,129 @@ int main(int argc, char **argv)
             (void *)(&state.IPAddr),
             NULL },
 
-        {   &state.templateVarName,
+        /* the load generator variables are only created with -G,
+           which names them.  They are never written: their references
+           are splice points for the values of each virtual source */
+        {   &state.loadSeedVarName,
             VARFLAG_NONE,
-            VARTYPE_STR,
-            TEMPLATE_FILENAME_SIZE,
-            NOTIFY_MODIFIED,
-            &(state.hTemplate),
-            (void *)(&state.templateFilename),
+            VARTYPE_UINT32,
+            0,
+            NOTIFY_NONE,
+            &(state.hLoadSeed),
+            (void *)(&state.loadSeed),
+            NULL },
+
+        {   &state.loadSeqVarName,
+            VARFLAG_NONE,
+            VARTYPE_UINT32,
+            0,
+            NOTIFY_NONE,
+            &(state.hLoadSeq),
+            (void *)(&state.loadSeq),
             NULL },
 
     };
 
     /* clear the UDP template engine state object */
     memset( &state, 0, sizeof( state ) );
+    state.timerFd = -1;
+    state.subFd[0] = -1;
+    state.subFd[1] = -1;
+    state.sigFd = -1;
+    state.epollFd = -1;
+    state.loadFd = -1;
+
+    /* initialize the interface socket cache */
+    SOCKCACHE_Init( &state.sockCache );
+
+    /* no interface is paced until configured */
+    PACING_Init( &state.pacing );
+
+    /* transmit timestamps are off until configured */
+    TXSTAMP_Init( &state.txStamp, TXSTAMP_OFF );
+
+    /* the real-time mode is off until configured */
+    RTMODE_Init( &state.rt );
+
+    /* there is no synthetic load until configured */
+    LOADGEN_Init( &state.load );
+
+    /* initialize the transmission schedules */
+    SCHED_Init( &state.schedule );
+    SCHED_Init( &state.changeSchedule );
 
     /* set up variable definition list */
     state.pVarDef = vars;
     state.varCount = sizeof(vars) / sizeof( vars[0]);
 
     /* process the command line options */
-    ProcessOptions( argc, argv, &state );
+    if ( ProcessOptions( argc, argv, &state ) != EOK )
+    {
+        return 1;
+    }
+
+    /* make sure there is always at least the default channel */
+    (void)GetChannel( &state );
+
+    /* derive the transmission stagger of this instance */
+    if ( SetupStagger( &state ) != EOK )
+    {
+        fprintf( stderr, "Failed to setup transmission stagger\n" );
+    }
+
+    /* apply the multicast options to the interface sockets */
+    SOCKCACHE_SetMulticast( &state.sockCache,
+                            ( state.mcastHops != 0 )
+                                ? state.mcastHops
+                                : state.sockCache.mcastHops,
+                            !state.noLoopback );
+
+    /* pace the interface sockets in the kernel where configured */
+    SOCKCACHE_SetPacing( &state.sockCache, &state.pacing );
+
+    /* timestamp the interface sockets if requested */
+    if ( state.txStamp.mode != TXSTAMP_OFF )
+    {
+        SOCKCACHE_SetTxStamp( &state.sockCache, &state.txStamp );
+    }
+
+    /* allocate the payload buffers */
+    if ( SetupPayload( &state ) != EOK )
+    {
+        fprintf( stderr, "Failed to setup payload buffers\n" );
+        return 1;
+    }
 
     /* set up the abnormal termination handler */
     SetupTerminationHandler();
 
+    /* route the varserver notification signals to a signalfd.  This
+       must be done before any notifications are requested */
+    if ( SetupSignals( &state ) != EOK )
+    {
+        fprintf( stderr, "Failed to setup signals\n" );
+        return 1;
+    }
+
+    /* set up the transmit batches.  Any sender thread must be started
+       after the notification signals are blocked so it inherits the
+       signal mask */
+    if ( SetupBatches( &state ) != EOK )
+    {
+        fprintf( stderr, "Failed to setup transmit batches\n" );
+        return 1;
+    }
+
+    /* preallocate and lock the memory, and pin and prioritize the
+       event loop and sender thread */
+    SetupRealtime( &state );
+
+    /* open the unicast subscriber sockets */
+    if ( SetupSubscribers( &state ) != EOK )
+    {
+        fprintf( stderr, "Failed to setup subscriber sockets\n" );
+    }
+
     /* open a handle to the variable server */
     state.hVarServer = VARSERVER_Open();
     if( state.hVarServer != NULL )
@@ -410,24 +1214,47 @@ int main(int argc, char **argv)
         result = SetupVarFP( &state );
         if ( result == EOK )
         {
-            /* Set up varserver variables to control the UDP Template engine */
-            result = SetupVars( &state );
+            /* populate the network interface table */
+            result = IFTABLE_Init( &state.ifTable );
             if ( result == EOK )
             {
-                /* Set up timer for periodic UDP broadcast */
-                result = SetupTimer( &state );
+                /* Set up varserver variables to control the UDP Template engine */
+                result = SetupVars( &state );
                 if ( result == EOK )
                 {
-                    RunMessageHandler( &state );
+                    /* Set up the timers for periodic UDP broadcast
+                       and the synthetic load */
+                    result = SetupTimer( &state );
+                    if ( result == EOK )
+                    {
+                        result = SetupLoad( &state );
+                    }
+
+                    if ( result == EOK )
+                    {
+                        result = SetupEventLoop( &state );
+                        if ( result == EOK )
+                        {
+                            RunMessageHandler( &state );
+                        }
+                        else
+                        {
+                            fprintf(stderr, "Failed to setup event loop\n");
+                        }
+                    }
+                    else
+                    {
+                        fprintf(stderr, "Failed to setup timer\n");
+                    }
                 }
                 else
                 {
-                    fprintf(stderr, "Failed to setup timer\n");
+                    fprintf(stderr, "Failed to setup vars\n");
                 }
             }
             else
             {
-                fprintf(stderr, "Failed to setup vars\n");
+                fprintf(stderr, "Failed to setup interface table\n");
             }
         }
         else
@@ -435,12 +1262,60 @@ int main(int argc, char **argv)
             fprintf(stderr, "Failed to setup VarFP\n");
         }
 
-        /* close the handle to the variable server */
-       if ( VARSERVER_Close( state.hVarServer ) == EOK )
-       {
-            state.hVarServer = NULL;
-       }
-    }
+        /* stop the sender thread before closing its sockets */
+        TXRING_Close( &state.txRing );
+        TXURING_Close( &state.txUring );
+
+        /* close all of the cached interface sockets */
+        SOCKCACHE_Flush( &state.sockCache );
+
+        /* close the subscriber sockets */
+        for ( i = 0; i < 2; i++ )
+        {
+            if ( state.subFd[i] != -1 )
+            {
+                close( state.subFd[i] );
+            }
+        }
+
+        /* close the interface table */
+        IFTABLE_Close( &state.ifTable );
+
+        /* release the compiled templates */
+        for ( i = 0; i < state.nChannels; i++ )
+        {
+            ReleaseTemplate( state.channels[i].pTemplate );
+            state.channels[i].pTemplate = NULL;
+            SUBLIST_Free( &state.channels[i].subscribers );
+            IFSET_Free( &state.channels[i].allowed );
+        }
+
+        VARSNAP_Free( &state.snapshot );
+
+        /* close the event loop file descriptors */
+        if ( state.epollFd != -1 )
+        {
+            close( state.epollFd );
+        }
+
+        if ( state.timerFd != -1 )
+        {
+            close( state.timerFd );
+        }
+
+        if ( state.loadFd != -1 )
+        {
+            close( state.loadFd );
+        }
+
+        LOADGEN_Free( &state.load );
+
+        /* close the handle to the variable server */
+       if ( VARSERVER_Close( state.hVarServer ) == EOK )
+       {
+            state.hVarServer = NULL;
+       }
+    }
 
     return ( result == EOK ) ? 0 : 1;
 }
@@ -466,16 +1341,66 @@ static void usage( char *cmdname )
     {
         fprintf( stderr,
                  "usage: %s [-h] [-v verbose var] [-t trigger var] "
-                 "[-r rate var] [-f filename var] [-e enable var] "
-                 "[-i interface var] [-m metrics var]\n"
+                 "[-r rate var] [-u interval var] [-f filename var] "
+                 "[-e enable var] "
+                 "[-i interface var] [-m metrics var] [-c channel] "
+                 "[-s max size] [-g] [-z compression var] [-d] "
+                 "[-k heartbeat var] [-b encoding var] [-n on change var] "
+                 "[-w debounce var] [-l min interval var] [-o group var] "
+                 "[-x subscriber var] "
+                 "[-A offset] [-j stagger key] [-P pacing] "
+                 "[-X sw|hw] [-M] [-C cpus] [-K cpus] [-F priority] "
+                 "[-G load] "
+                 "[-H hops] [-I] [-L] [-S] [-T] [-U]\n"
                  " [-v] : verbose mode variable\n"
                  " [-t] : trigger variable\n"
                  " [-r] : transmission rate variable\n"
+                 " [-u] : transmission interval variable (microseconds)\n"
                  " [-f] : template file variable\n"
                  " [-e] : enable/disable variable\n"
                  " [-i] : interface list variable\n"
+                 " [-p] : port variable\n"
                  " [-m] : metrics variable\n"
                  " [-a] : source IP address variable (output)\n"
+                 " [-c] : add a channel using <channel>/<name> variables\n"
+                 " [-R] : render the template separately for each interface\n"
+                 " [-S] : render from a snapshot of the template variables\n"
+                 " [-I] : re-format only the template variables which changed "
+                 "(implies -S)\n"
+                 " [-s] : maximum rendered payload size (bytes)\n"
+                 " [-g] : send payloads larger than a datagram as segments\n"
+                 " [-z] : payload compression variable (0=none, 1=lz4, 2=zstd)\n"
+                 " [-d] : do not use the template as a compression dictionary\n"
+                 " [-k] : heartbeat variable (ticks, suppress unchanged payloads)\n"
+                 " [-b] : payload encoding variable (0=text, 1=CBOR)\n"
+                 " [-n] : transmit on template variable change variable\n"
+                 " [-w] : change debounce variable (microseconds)\n"
+                 " [-l] : minimum change transmission interval variable "
+                 "(microseconds)\n"
+                 " [-o] : multicast group variable (IPv4 and/or IPv6 group)\n"
+                 " [-x] : unicast subscriber list variable (address:port list "
+                 "or /file)\n"
+                 " [-A] : align transmissions to the wall clock, at an offset "
+                 "(microseconds)\n"
+                 " [-j] : stagger transmissions by a key (mac, hostname "
+                 "or a literal key)\n"
+                 " [-P] : pace interfaces (ifname:bytes/s[:bucket|fq|txtime"
+                 "[:burst]],...)\n"
+                 " [-X] : measure send latency with software (sw) or "
+                 "hardware (hw) transmit timestamps\n"
+                 " [-M] : real-time mode (preallocate and lock memory, and "
+                 "count steady state allocations if built with "
+                 "UDPT_RT_ALLOC_CHECK)\n"
+                 " [-C] : pin the event loop to a CPU list (e.g. 2,4-5)\n"
+                 " [-K] : pin the sender thread to a CPU list\n"
+                 " [-F] : SCHED_FIFO priority of the event loop and sender "
+                 "thread (1-99)\n"
+                 " [-G] : send a synthetic load on the current channel "
+                 "(sources:rate[:endrate[:ramp[:prefix]]])\n"
+                 " [-H] : multicast TTL / hop limit (default 1)\n"
+                 " [-L] : do not loop multicast datagrams back to this host\n"
+                 " [-T] : send the datagrams from a sender thread\n"
+                 " [-U] : send the datagrams using io_uring\n"
                  " [-h] : display this help\n",
                  cmdname );
     }
@@ -489,6 +1414,10 @@ static void usage( char *cmdname )
     The ProcessOptions function processes the command line options and
     populates the UDPTState object
 
+    The channel options (-t, -r, -u, -f, -e, -i, -p, -z, -k, -b, -n,
+    -w, -l, -o, -x) apply to the most recently declared channel, or to the
+    default channel if no channel has been declared with -c.
+
     @param[in]
         argC
             number of arguments
@@ -502,20 +1431,31 @@ static void usage( char *cmdname )
         pState
             pointer to the UDPT State object
 
-    @return 0
+    @retval EOK the options were processed
+    @retval ENOSPC too many channels were declared
+    @retval EINVAL invalid arguments
 
 ==============================================================================*/
 static int ProcessOptions( int argC, char *argV[], UDPTState *pState )
 {
     int c;
     int result = EINVAL;
-    const char *options = "hvf:p:i:e:r:t:m:a:";
+    const char *options = "hv:RSIgdTULMH:A:j:P:X:C:K:F:G:s:c:f:p:i:e:r:u:t:m:a:z:k:b:n:w:l:o:x:";
+    UDPTChannel *pChannel;
 
     if( ( pState != NULL ) &&
         ( argV != NULL ) )
     {
-        while( ( c = getopt( argC, argV, options ) ) != -1 )
+        result = EOK;
+
+        while( ( result == EOK ) &&
+               ( ( c = getopt( argC, argV, options ) ) != -1 ) )
         {
+            /* get the channel the option applies to */
+            pChannel = ( strchr( "fpiertuzkbnwlox", c ) != NULL )
+                       ? GetChannel( pState )
+                       : NULL;
+
             switch( c )
             {
                 case 'v':
@@ -526,28 +1466,210 @@ static int ProcessOptions( int argC, char *argV[], UDPTState *pState )
                     usage( argV[0] );
                     break;
 
+                case 'R':
+                    pState->perInterfaceRender = true;
+                    break;
+
+                case 'S':
+                    pState->useSnapshot = true;
+                    break;
+
+                case 'I':
+                    /* only values formatted from the snapshot are
+                       cached */
+                    pState->incremental = true;
+                    pState->useSnapshot = true;
+                    break;
+
+                case 'g':
+                    pState->segmented = true;
+                    break;
+
+                case 'd':
+                    pState->noDictionary = true;
+                    break;
+
+                case 'T':
+                    pState->threaded = true;
+                    break;
+
+                case 'U':
+                    pState->useUring = true;
+                    break;
+
+                case 'L':
+                    pState->noLoopback = true;
+                    break;
+
+                case 'M':
+                    pState->rt.enabled = true;
+                    break;
+
+                case 'C':
+                    if ( RTMODE_ParseCpus( optarg,
+                                           &pState->rt.loopCpus ) != EOK )
+                    {
+                        fprintf( stderr, "Invalid CPU list: %s\n", optarg );
+                    }
+                    break;
+
+                case 'K':
+                    if ( RTMODE_ParseCpus( optarg,
+                                           &pState->rt.senderCpus ) != EOK )
+                    {
+                        fprintf( stderr, "Invalid CPU list: %s\n", optarg );
+                    }
+                    break;
+
+                case 'F':
+                    pState->rt.priority = atoi( optarg );
+                    if ( ( pState->rt.priority < 1 ) ||
+                         ( pState->rt.priority > 99 ) )
+                    {
+                        fprintf( stderr,
+                                 "Invalid real-time priority: %s\n",
+                                 optarg );
+                        pState->rt.priority = 0;
+                    }
+                    break;
+
+                case 'G':
+                    if ( LOADGEN_Parse( &pState->load, optarg ) == EOK )
+                    {
+                        pState->pLoadChannel = GetChannel( pState );
+                        free( pState->loadSeedVarName );
+                        free( pState->loadSeqVarName );
+                        pState->loadSeedVarName =
+                            MakeVarName( pState->load.prefix, "seed" );
+                        pState->loadSeqVarName =
+                            MakeVarName( pState->load.prefix, "seq" );
+                    }
+                    else
+                    {
+                        fprintf( stderr, "Invalid load: %s\n", optarg );
+                    }
+                    break;
+
+                case 'H':
+                    pState->mcastHops = atoi( optarg );
+                    if ( ( pState->mcastHops < 1 ) ||
+                         ( pState->mcastHops > 255 ) )
+                    {
+                        fprintf( stderr,
+                                 "Invalid multicast hops: %s\n",
+                                 optarg );
+                        pState->mcastHops = 0;
+                    }
+                    break;
+
+                case 'A':
+                    pState->alignWallClock = true;
+                    pState->alignOffset_ns = strtoull( optarg, NULL, 0 ) *
+                                             1000ULL;
+                    break;
+
+                case 'j':
+                    pState->staggerKey = strdup( optarg );
+                    break;
+
+                case 'P':
+                    if ( PACING_Parse( &pState->pacing, optarg ) != EOK )
+                    {
+                        fprintf( stderr, "Invalid pacing: %s\n", optarg );
+                    }
+                    break;
+
+                case 'X':
+                    if ( strcmp( optarg, "hw" ) == 0 )
+                    {
+                        pState->txStamp.mode = TXSTAMP_HARDWARE;
+                    }
+                    else if ( strcmp( optarg, "sw" ) == 0 )
+                    {
+                        pState->txStamp.mode = TXSTAMP_SOFTWARE;
+                    }
+                    else
+                    {
+                        fprintf( stderr,
+                                 "Invalid timestamp mode: %s\n",
+                                 optarg );
+                    }
+                    break;
+
+                case 's':
+                    pState->maxPayload = strtoul( optarg, NULL, 0 );
+                    break;
+
+                case 'c':
+                    if ( AddChannel( pState, optarg ) == NULL )
+                    {
+                        fprintf( stderr,
+                                 "Failed to add channel: %s "
+                                 "(at most %d channels)\n",
+                                 optarg,
+                                 MAX_CHANNELS );
+                        result = ENOSPC;
+                    }
+                    break;
+
                 case 'f':
-                    pState->templateVarName = strdup(optarg);
+                    pChannel->templateVarName = strdup(optarg);
                     break;
 
                 case 'p':
-                    pState->portVarName = strdup(optarg);
+                    pChannel->portVarName = strdup(optarg);
                     break;
 
                 case 'i':
-                    pState->interfaceVarName = strdup(optarg);
+                    pChannel->interfaceVarName = strdup(optarg);
                     break;
 
                 case 'e':
-                    pState->enableVarName = strdup(optarg);
+                    pChannel->enableVarName = strdup(optarg);
                     break;
 
                 case 'r':
-                    pState->txRateVarName = strdup(optarg);
+                    pChannel->txRateVarName = strdup(optarg);
+                    break;
+
+                case 'u':
+                    pChannel->txIntervalVarName = strdup(optarg);
                     break;
 
                 case 't':
-                    pState->triggerVarName = strdup(optarg);
+                    pChannel->triggerVarName = strdup(optarg);
+                    break;
+
+                case 'z':
+                    pChannel->compressionVarName = strdup(optarg);
+                    break;
+
+                case 'k':
+                    pChannel->heartbeatVarName = strdup(optarg);
+                    break;
+
+                case 'b':
+                    pChannel->encodingVarName = strdup(optarg);
+                    break;
+
+                case 'n':
+                    pChannel->onChangeVarName = strdup(optarg);
+                    break;
+
+                case 'w':
+                    pChannel->debounceVarName = strdup(optarg);
+                    break;
+
+                case 'l':
+                    pChannel->minIntervalVarName = strdup(optarg);
+                    break;
+
+                case 'o':
+                    pChannel->groupVarName = strdup(optarg);
+                    break;
+
+                case 'x':
+                    pChannel->subscribersVarName = strdup(optarg);
                     break;
 
                 case 'm':
@@ -564,310 +1686,5305 @@ static int ProcessOptions( int argC, char *argV[], UDPTState *pState )
         }
     }
 
-    return 0;
-}
-
-
-/*============================================================================*/
-/*  SetupTerminationHandler                                                   */
-/*!
-    Set up an abnormal termination handler
-
-    The SetupTerminationHandler function registers a termination handler
-    function with the kernel in case of an abnormal termination of this
-    process.
-
-==============================================================================*/
-static void SetupTerminationHandler( void )
-{
-    static struct sigaction sigact;
-
-    memset( &sigact, 0, sizeof(sigact) );
-
-    sigact.sa_sigaction = TerminationHandler;
-    sigact.sa_flags = SA_SIGINFO;
+    return result;
+}
+
+/*============================================================================*/
+/*  AddChannel                                                                */
+/*!
+    Add a broadcast channel
+
+    The AddChannel function adds a new broadcast channel and sets up its
+    variable definitions.  If a prefix is specified, the channel
+    configuration variables are named <prefix>/trigger, <prefix>/txrate,
+    <prefix>/txinterval, <prefix>/template, <prefix>/enable,
+    <prefix>/interfaces, <prefix>/port, <prefix>/compression,
+    <prefix>/heartbeat, <prefix>/encoding, <prefix>/onchange,
+    <prefix>/debounce, <prefix>/mininterval, <prefix>/group, and
+    <prefix>/subscribers.  These names may be overridden by the channel
+    options which follow.
+
+    @param[in]
+        pState
+            pointer to the UDPT State object
+
+    @param[in]
+        prefix
+            variable name prefix for the channel, or NULL for the default
+            channel whose variables are all specified explicitly
+
+    @retval pointer to the new channel
+    @retval NULL the channel could not be added
+
+==============================================================================*/
+static UDPTChannel *AddChannel( UDPTState *pState, const char *prefix )
+{
+    UDPTChannel *pChannel = NULL;
+
+    if ( ( pState != NULL ) &&
+         ( pState->nChannels < MAX_CHANNELS ) )
+    {
+        pChannel = &pState->channels[pState->nChannels++];
+
+        if ( prefix != NULL )
+        {
+            pChannel->name = strdup( prefix );
+            pChannel->triggerVarName = MakeVarName( prefix, "trigger" );
+            pChannel->txRateVarName = MakeVarName( prefix, "txrate" );
+            pChannel->txIntervalVarName = MakeVarName( prefix, "txinterval" );
+            pChannel->templateVarName = MakeVarName( prefix, "template" );
+            pChannel->enableVarName = MakeVarName( prefix, "enable" );
+            pChannel->interfaceVarName = MakeVarName( prefix, "interfaces" );
+            pChannel->portVarName = MakeVarName( prefix, "port" );
+            pChannel->compressionVarName = MakeVarName( prefix, "compression" );
+            pChannel->heartbeatVarName = MakeVarName( prefix, "heartbeat" );
+            pChannel->encodingVarName = MakeVarName( prefix, "encoding" );
+            pChannel->onChangeVarName = MakeVarName( prefix, "onchange" );
+            pChannel->debounceVarName = MakeVarName( prefix, "debounce" );
+            pChannel->minIntervalVarName = MakeVarName( prefix,
+                                                        "mininterval" );
+            pChannel->groupVarName = MakeVarName( prefix, "group" );
+            pChannel->subscribersVarName = MakeVarName( prefix,
+                                                        "subscribers" );
+        }
+
+        pChannel->vars[0] = (VarDef){ &pChannel->triggerVarName,
+                                      VARFLAG_VOLATILE | VARFLAG_TRIGGER,
+                                      VARTYPE_UINT16,
+                                      0,
+                                      NOTIFY_MODIFIED,
+                                      &(pChannel->hTrigger),
+                                      NULL,
+                                      cbTrigger };
+
+        pChannel->vars[1] = (VarDef){ &pChannel->txRateVarName,
+                                      VARFLAG_NONE,
+                                      VARTYPE_UINT32,
+                                      0,
+                                      NOTIFY_MODIFIED,
+                                      &(pChannel->hTxRate),
+                                      (void *)&(pChannel->txrate_s),
+                                      cbTimer };
+
+        pChannel->vars[2] = (VarDef){ &pChannel->txIntervalVarName,
+                                      VARFLAG_NONE,
+                                      VARTYPE_UINT32,
+                                      0,
+                                      NOTIFY_MODIFIED,
+                                      &(pChannel->hTxInterval),
+                                      (void *)&(pChannel->txinterval_us),
+                                      cbTimer };
+
+        pChannel->vars[3] = (VarDef){ &pChannel->enableVarName,
+                                      VARFLAG_NONE,
+                                      VARTYPE_UINT16,
+                                      0,
+                                      NOTIFY_MODIFIED,
+                                      &(pChannel->hEnable),
+                                      (void *)(&pChannel->enable),
+                                      NULL };
+
+        pChannel->vars[4] = (VarDef){ &pChannel->interfaceVarName,
+                                      VARFLAG_NONE,
+                                      VARTYPE_STR,
+                                      INTERFACE_LIST_LEN,
+                                      NOTIFY_MODIFIED,
+                                      &(pChannel->hInterfaceList),
+                                      (void *)(&pChannel->interfaceList),
+                                      cbInterfaces };
+
+        pChannel->vars[5] = (VarDef){ &pChannel->portVarName,
+                                      VARFLAG_NONE,
+                                      VARTYPE_UINT16,
+                                      0,
+                                      NOTIFY_MODIFIED,
+                                      &(pChannel->hPort),
+                                      (void *)(&pChannel->port),
+                                      NULL };
+
+        pChannel->vars[6] = (VarDef){ &pChannel->templateVarName,
+                                      VARFLAG_NONE,
+                                      VARTYPE_STR,
+                                      TEMPLATE_FILENAME_SIZE,
+                                      NOTIFY_MODIFIED,
+                                      &(pChannel->hTemplate),
+                                      (void *)(&pChannel->templateFilename),
+                                      cbTemplate };
+
+        pChannel->vars[7] = (VarDef){ &pChannel->compressionVarName,
+                                      VARFLAG_NONE,
+                                      VARTYPE_UINT16,
+                                      0,
+                                      NOTIFY_MODIFIED,
+                                      &(pChannel->hCompression),
+                                      (void *)(&pChannel->compression),
+                                      cbCompression };
+
+        pChannel->vars[8] = (VarDef){ &pChannel->heartbeatVarName,
+                                      VARFLAG_NONE,
+                                      VARTYPE_UINT32,
+                                      0,
+                                      NOTIFY_MODIFIED,
+                                      &(pChannel->hHeartbeat),
+                                      (void *)(&pChannel->heartbeat),
+                                      NULL };
+
+        pChannel->vars[9] = (VarDef){ &pChannel->encodingVarName,
+                                      VARFLAG_NONE,
+                                      VARTYPE_UINT16,
+                                      0,
+                                      NOTIFY_MODIFIED,
+                                      &(pChannel->hEncoding),
+                                      (void *)(&pChannel->encoding),
+                                      NULL };
+
+        pChannel->vars[10] = (VarDef){ &pChannel->onChangeVarName,
+                                       VARFLAG_NONE,
+                                       VARTYPE_UINT16,
+                                       0,
+                                       NOTIFY_MODIFIED,
+                                       &(pChannel->hOnChange),
+                                       (void *)(&pChannel->onChange),
+                                       cbOnChange };
+
+        pChannel->vars[11] = (VarDef){ &pChannel->debounceVarName,
+                                       VARFLAG_NONE,
+                                       VARTYPE_UINT32,
+                                       0,
+                                       NOTIFY_MODIFIED,
+                                       &(pChannel->hDebounce),
+                                       (void *)(&pChannel->debounce_us),
+                                       NULL };
+
+        pChannel->vars[12] = (VarDef){ &pChannel->minIntervalVarName,
+                                       VARFLAG_NONE,
+                                       VARTYPE_UINT32,
+                                       0,
+                                       NOTIFY_MODIFIED,
+                                       &(pChannel->hMinInterval),
+                                       (void *)(&pChannel->mininterval_us),
+                                       NULL };
+
+        pChannel->vars[13] = (VarDef){ &pChannel->groupVarName,
+                                       VARFLAG_NONE,
+                                       VARTYPE_STR,
+                                       GROUP_LIST_LEN,
+                                       NOTIFY_MODIFIED,
+                                       &(pChannel->hGroup),
+                                       (void *)(&pChannel->groupList),
+                                       cbGroup };
+
+        pChannel->vars[14] = (VarDef){ &pChannel->subscribersVarName,
+                                       VARFLAG_NONE,
+                                       VARTYPE_STR,
+                                       SUBSCRIBER_LIST_LEN,
+                                       NOTIFY_MODIFIED,
+                                       &(pChannel->hSubscribers),
+                                       (void *)(&pChannel->subscriberSpec),
+                                       cbSubscribers };
+    }
+
+    return pChannel;
+}
+
+/*============================================================================*/
+/*  GetChannel                                                                */
+/*!
+    Get the channel which is currently being configured
+
+    The GetChannel function gets the most recently added channel,
+    creating the default channel if no channels have been added yet.
+
+    @param[in]
+        pState
+            pointer to the UDPT State object
+
+    @retval pointer to the current channel
+
+==============================================================================*/
+static UDPTChannel *GetChannel( UDPTState *pState )
+{
+    if ( pState->nChannels == 0 )
+    {
+        (void)AddChannel( pState, NULL );
+    }
+
+    return &pState->channels[pState->nChannels - 1];
+}
+
+/*============================================================================*/
+/*  MakeVarName                                                               */
+/*!
+    Build a channel variable name
+
+    The MakeVarName function allocates a variable name of the form
+    <prefix>/<suffix>
+
+    @param[in]
+        prefix
+            channel variable name prefix
+
+    @param[in]
+        suffix
+            variable name suffix
+
+    @retval pointer to the allocated variable name
+    @retval NULL memory allocation failed
+
+==============================================================================*/
+static char *MakeVarName( const char *prefix, const char *suffix )
+{
+    char *name = NULL;
+
+    if ( asprintf( &name, "%s/%s", prefix, suffix ) == -1 )
+    {
+        name = NULL;
+    }
+
+    return name;
+}
+
+/*============================================================================*/
+/*  SetupTerminationHandler                                                   */
+/*!
+    Set up an abnormal termination handler
+
+    The SetupTerminationHandler function registers a termination handler
+    function with the kernel in case of an abnormal termination of this
+    process.
+
+==============================================================================*/
+static void SetupTerminationHandler( void )
+{
+    static struct sigaction sigact;
+
+    memset( &sigact, 0, sizeof(sigact) );
+
+    sigact.sa_sigaction = TerminationHandler;
+    sigact.sa_flags = SA_SIGINFO;
+
+    sigaction( SIGTERM, &sigact, NULL );
+    sigaction( SIGINT, &sigact, NULL );
+}
+
+/*============================================================================*/
+/*  TerminationHandler                                                        */
+/*!
+    Abnormal termination handler
+
+    The TerminationHandler function will be invoked in case of an abnormal
+    termination of this process.  The termination handler closes
+    the connection with the variable server and cleans up any open
+    resources.
+
+    @param[in]
+        signum
+            The signal which caused the abnormal termination (unused)
+
+    @param[in]
+        info
+            pointer to a siginfo_t object (unused)
+
+    @param[in]
+        ptr
+            signal context information (ucontext_t) (unused)
+
+==============================================================================*/
+static void TerminationHandler( int signum, siginfo_t *info, void *ptr )
+{
+    /* signum, info, and ptr are unused */
+    (void)signum;
+    (void)info;
+    (void)ptr;
+
+    fprintf( stderr, "Abnormal termination of the UDP template generator\n" );
+
+    SOCKCACHE_Flush( &state.sockCache );
+
+    if ( state.hVarServer != NULL )
+    {
+        if ( VARSERVER_Close( state.hVarServer ) == EOK )
+        {
+            state.hVarServer = NULL;
+        }
+    }
+
+    exit( 1 );
+}
+
+/*============================================================================*/
+/*  SetupVars                                                                 */
+/*!
+    Set up the UDP template generator variables
+
+    The SetupVars function creates and configures the process-wide
+    UDP template generator variables, and the variables of every
+    broadcast channel.  Change-triggered channels are subscribed to
+    the variables referenced by their templates.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object containing the names of the
+            variables to set up.
+
+    @retval
+        EOK - UDP Template variables successfully set up
+        EINVAL - invalid arguments
+
+==============================================================================*/
+static int SetupVars( UDPTState *pState )
+{
+    int result = EINVAL;
+    size_t i;
+
+    if ( pState != NULL )
+    {
+        result = SetupVarDefs( pState, pState->pVarDef, pState->varCount );
+
+        for ( i = 0; i < pState->nChannels; i++ )
+        {
+            if ( SetupVarDefs( pState,
+                               pState->channels[i].vars,
+                               CHANNEL_VAR_COUNT ) != EOK )
+            {
+                result = EINVAL;
+            }
+
+            (void)SubscribeTemplate( pState, &pState->channels[i] );
+
+            (void)ParseGroups( &pState->channels[i] );
+
+            (void)SUBLIST_Parse( &pState->channels[i].subscribers,
+                                 pState->channels[i].subscriberSpec );
+
+            (void)IFSET_Parse( &pState->channels[i].allowed,
+                               pState->channels[i].interfaceList );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupVarDefs                                                              */
+/*!
+    Set up a list of variables
+
+    The SetupVarDefs function creates and configures the variables in
+    a variable definition list, and gets their initial values.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        pVarDef
+            pointer to the variable definition list
+
+    @param[in]
+        count
+            number of variables in the list
+
+    @retval
+        EOK - variables successfully set up
+        EINVAL - one or more variables could not be set up
+
+==============================================================================*/
+static int SetupVarDefs( UDPTState *pState, VarDef *pVarDef, size_t count )
+{
+    int result = EINVAL;
+    int errcount = 0;
+    size_t i;
+    VAR_HANDLE *pVarHandle;
+    VARSERVER_HANDLE hVarServer = pState->hVarServer;
+
+    for ( i=0 ; i < count ; i++ )
+    {
+        if ( *(pVarDef[i].name) != NULL )
+        {
+            /* get a pointer to the location to store the variable handle */
+            pVarHandle = pVarDef[i].pVarHandle;
+            if ( pVarHandle != NULL )
+            {
+                /* create a message variable */
+                *pVarHandle = SetupVar( hVarServer,
+                                        *pVarDef[i].name,
+                                        pVarDef[i].type,
+                                        pVarDef[i].len,
+                                        pVarDef[i].flags,
+                                        pVarDef[i].notifyType );
+                if ( *pVarHandle == VAR_INVALID )
+                {
+                    fprintf( stderr,
+                             "Error creating variable: %s\n",
+                             *pVarDef[i].name );
+                    errcount++;
+                }
+                else
+                {
+                    GetVar( hVarServer, &pVarDef[i] );
+                }
+            }
+        }
+    }
+
+    if ( errcount == 0 )
+    {
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupVar                                                                  */
+/*!
+    Set up a variable
+
+    The SetupVar function creates a varserver variable to be used to
+    interact with the manifest generator.
+    The variable may or may not have a notification associated with it.
+
+@param[in]
+    hVarServer
+        handle to the variable server
+
+@param[in]
+    name
+        specify the variable name to create
+
+@param[in]
+    type
+        type of the variable
+
+@param[in]
+    len
+        length of the variable (strings/blobs only)
+
+@param[in]
+    flags
+        flags to add to the variable flag set
+
+@param[in]
+    notify
+        specify the notification type.  Use NOTIFY_NONE if no notification is
+        required
+
+==============================================================================*/
+VAR_HANDLE SetupVar( VARSERVER_HANDLE hVarServer,
+                     char *name,
+                     VarType type,
+                     size_t len,
+                     uint32_t flags,
+                     NotificationType notify )
+{
+    VAR_HANDLE hVar = VAR_INVALID;
+    VarInfo info;
+    int result;
+    size_t l;
+    VarType vartype = VARTYPE_INVALID;
+
+    if ( name != NULL )
+    {
+        l = strlen( name );
+        if ( l < sizeof( info.name ) )
+        {
+            memset( &info, 0, sizeof( VarInfo ) );
+
+            info.flags = flags;
+            info.var.type = type;
+            info.var.len = len;
+
+            /* set the variable name */
+            strcpy( info.name, name );
+
+            /* try to create the variable.  This will fail if the variable
+               was already pre-created */
+            result = VARSERVER_CreateVar( hVarServer, &info );
+            if ( result == EOK )
+            {
+                hVar = info.hVar;
+            }
+
+            if ( hVar == VAR_INVALID )
+            {
+                /* search for the variable which may have been pre-created */
+                hVar = VAR_FindByName( hVarServer, info.name );
+                if ( hVar != VAR_INVALID )
+                {
+                    result = VAR_GetType( hVarServer, hVar, &vartype );
+                    if ( result == EOK )
+                    {
+                        result = ( vartype == type ) ? EOK : ENOTSUP;
+                    }
+                }
+            }
+
+            if ( result == EOK )
+            {
+                if ( ( hVar != VAR_INVALID ) &&
+                     ( notify != NOTIFY_NONE ) )
+                {
+                    /* set up variable notification */
+                    result = VAR_Notify( hVarServer, hVar, notify );
+                    if ( result != EOK )
+                    {
+                        fprintf( stderr,
+                                 "UDPT: Failed to set up notification: '%s'\n",
+                                 info.name );
+                    }
+                }
+            }
+        }
+    }
+
+    return hVar;
+}
+
+/*============================================================================*/
+/*  GetVar                                                                    */
+/*!
+    Get the value of a varserver variable
+
+    The GetVar function copies the value of a varserver variable
+    into its local value within the UDPTState object.
+
+@param[in]
+    hVarServer
+        handle to the variable server
+
+@param[in]
+    pVarDef
+        pointer to a variable definition that maps the variable handle
+        to its local data storage.
+
+==============================================================================*/
+static int GetVar( VARSERVER_HANDLE hVarServer, VarDef *pVarDef )
+{
+    int result = EINVAL;
+    VarObject obj;
+    VAR_HANDLE hVar;
+
+    if ( pVarDef != NULL )
+    {
+        hVar = *(pVarDef->pVarHandle);
+        if ( ( hVar != VAR_INVALID ) &&
+             ( pVarDef->pVal != NULL ) )
+        {
+            if ( pVarDef->type == VARTYPE_STR )
+            {
+                obj.len = pVarDef->len;
+                obj.val.str = (char *)pVarDef->pVal;
+            }
+
+            result = VAR_Get( hVarServer, hVar, &obj );
+            if ( result == EOK )
+            {
+                switch( pVarDef->type )
+                {
+                    case VARTYPE_UINT16:
+                        *(uint16_t *)(pVarDef->pVal) = obj.val.ui;
+                        break;
+
+                    case VARTYPE_UINT32:
+                        *(uint32_t *)(pVarDef->pVal) = obj.val.ul;
+                        break;
+
+                    default:
+                        result = ENOTSUP;
+                        break;
+                }
+            }
+        }
+        else
+        {
+            /* no variable handle or local data reference */
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupVarFP                                                                */
+/*!
+    Set up a variable output stream for rendering variables to text
+
+    The SetupVarFP function sets up a shared memory buffer backed by an
+    output stream to allow us to render variables (possibly from other
+    processes) into a memory buffer.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object to initialize
+
+    @retval EOK the Variable Message rendering buffer was created
+    @retval EBADF failed to create the memory buffer
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int SetupVarFP( UDPTState *pState )
+{
+    int result = EINVAL;
+    char varfp_name[64];
+    time_t now;
+    int n;
+    size_t len = sizeof(varfp_name);
+
+    if ( pState != NULL )
+    {
+        result = EBADF;
+
+        /* generate a temporary name for the VarFP */
+        now = time(NULL);
+        n = snprintf(varfp_name, sizeof(varfp_name), "udpt_%ld", now );
+        if ( ( n > 0 ) && ( (size_t)n < len ) )
+        {
+            /* open a VarFP object for printing */
+            pState->pVarFP = VARFP_Open(varfp_name, pState->maxPayload + 1 );
+            if ( pState->pVarFP != NULL )
+            {
+                /* get a file descriptor for the memory buffer */
+                pState->varFd = VARFP_GetFd( pState->pVarFP );
+                if ( pState->varFd != -1 )
+                {
+                    result = EOK;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupPayload                                                              */
+/*!
+    Set up the payload buffers
+
+    The SetupPayload function applies the maximum rendered payload size,
+    and allocates the buffers used to build payloads which do not fit
+    in a single datagram, and to build binary and compressed payloads.  If
+    segmentation is enabled, it checks if the kernel supports UDP GSO.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object to initialize
+
+    @retval EOK the payload buffers were allocated
+    @retval ENOMEM memory allocation failed
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int SetupPayload( UDPTState *pState )
+{
+    int result = EINVAL;
+    size_t bound;
+
+    if ( pState != NULL )
+    {
+        if ( pState->maxPayload == 0 )
+        {
+            pState->maxPayload = MAX_UDPT_SIZE;
+        }
+        else if ( pState->maxPayload > MAX_PAYLOAD_LIMIT )
+        {
+            pState->maxPayload = MAX_PAYLOAD_LIMIT;
+        }
+
+        result = ENOMEM;
+
+        /* the compressed payload buffer must hold the worst case
+           output of any of the compression algorithms */
+        bound = COMPRESS_Bound( COMPRESS_LZ4, pState->maxPayload );
+        if ( COMPRESS_Bound( COMPRESS_ZSTD, pState->maxPayload ) > bound )
+        {
+            bound = COMPRESS_Bound( COMPRESS_ZSTD, pState->maxPayload );
+        }
+
+        pState->compressedSize = UDPTMSG_COMPRESSED_HEADER_SIZE + bound;
+        pState->pCompressed = malloc( pState->compressedSize );
+
+        pState->pPayload = malloc( pState->maxPayload );
+        pState->pBinary = malloc( pState->maxPayload );
+        pState->pText = malloc( pState->maxPayload );
+        if ( ( pState->pPayload != NULL ) &&
+             ( pState->pCompressed != NULL ) &&
+             ( pState->pBinary != NULL ) &&
+             ( pState->pText != NULL ) )
+        {
+            result = EOK;
+
+            if ( pState->segmented == true )
+            {
+                pState->gso = TXBATCH_ProbeGSO();
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupBatches                                                              */
+/*!
+    Set up the transmit batches
+
+    The SetupBatches function sets up the batches the UDP messages are
+    collected into before they are sent.  If the sender thread is
+    selected, there is one batch for each slot of the transmit ring,
+    and the sender thread is started.  Otherwise a single batch is
+    sent directly from the event loop.  If UDP GSO is in use, the GSO
+    buffers of each batch are also allocated.
+
+    If io_uring is selected, the io_uring backend is set up first, and
+    the datagram buffers of every batch are registered with it so they
+    can be sent without copying.  If io_uring is not available, the
+    batches are sent using sendmmsg().
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @retval EOK the transmit batches were set up
+    @retval ENOMEM memory allocation failed
+    @retval EINVAL invalid arguments
+    @retval other error from TXRING_Init
+
+==============================================================================*/
+static int SetupBatches( UDPTState *pState )
+{
+    int result = EINVAL;
+    UDPTBatch *pBatch;
+    TxRingSlot *pSlot;
+    struct iovec buffers[TXRING_MAX_SLOTS];
+    size_t nBatches = 1;
+    size_t i;
+    size_t j;
+
+    if ( pState != NULL )
+    {
+        result = EOK;
+
+        if ( ( pState->useUring == true ) &&
+             ( TXURING_Init( &pState->txUring ) != EOK ) )
+        {
+            fprintf( stderr, "io_uring is not available, using sendmmsg\n" );
+        }
+
+        if ( pState->threaded == true )
+        {
+            result = TXRING_Init( &pState->txRing,
+                                  TXRING_MAX_SLOTS,
+                                  SendBatch,
+                                  pState );
+            nBatches = TXRING_MAX_SLOTS;
+        }
+
+        for ( i = 0; ( i < nBatches ) && ( result == EOK ); i++ )
+        {
+            pBatch = &pState->batches[i];
+
+            if ( pState->threaded == true )
+            {
+                /* find our batch context from the ring slot */
+                pSlot = TXRING_GetSlot( &pState->txRing, i );
+                pSlot->pCtx = pBatch;
+                pBatch->pTxBatch = &pSlot->batch;
+            }
+            else
+            {
+                pBatch->pTxBatch = &pState->txBatch;
+            }
+
+            buffers[i].iov_base = pBatch->pTxBatch->slots;
+            buffers[i].iov_len = sizeof( pBatch->pTxBatch->slots );
+
+            for ( j = 0; ( j < MAX_GSO_BUFFERS ) && ( pState->gso ); j++ )
+            {
+                pBatch->pGsoBuf[j] = malloc( UDP_MAX_PAYLOAD );
+                if ( pBatch->pGsoBuf[j] == NULL )
+                {
+                    result = ENOMEM;
+                    break;
+                }
+            }
+        }
+
+        if ( ( result == EOK ) &&
+             ( pState->txUring.pRing != NULL ) &&
+             ( TXURING_RegisterBuffers( &pState->txUring,
+                                        buffers,
+                                        nBatches ) != EOK ) )
+        {
+            fprintf( stderr, "Failed to register io_uring buffers\n" );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupRealtime                                                             */
+/*!
+    Set up the real-time mode
+
+    The SetupRealtime function prepares the process for deterministic
+    transmission timing.  In real-time mode, the variable snapshot, the
+    interface bitmaps and the subscriber tables of every channel are
+    preallocated to their maximum sizes, and all of the process memory
+    is locked.  The payload and transmit batch buffers are already
+    allocated at their maximum sizes.  The event loop and the sender
+    thread are then pinned to their CPU lists, and scheduled with the
+    SCHED_FIFO policy if a real-time priority is configured.  Failures
+    are reported, but do not stop the transmissions.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+==============================================================================*/
+static void SetupRealtime( UDPTState *pState )
+{
+    RtMode *pRt = &pState->rt;
+    int result = EOK;
+    size_t i;
+
+    if ( pRt->enabled == true )
+    {
+        if ( VARSNAP_Reserve( &pState->snapshot,
+                              RT_MAX_SNAPSHOT_VARS ) != EOK )
+        {
+            result = ENOMEM;
+        }
+
+        for ( i = 0; i < pState->nChannels; i++ )
+        {
+            if ( ( IFSET_Reserve( &pState->channels[i].allowed,
+                                  RT_MAX_IFINDEX ) != EOK ) ||
+                 ( SUBLIST_Reserve( &pState->channels[i].subscribers )
+                        != EOK ) )
+            {
+                result = ENOMEM;
+            }
+        }
+
+        if ( result != EOK )
+        {
+            fprintf( stderr, "Failed to preallocate real-time tables\n" );
+        }
+
+        result = RTMODE_Lock( pRt );
+        if ( result != EOK )
+        {
+            fprintf( stderr,
+                     "Failed to lock memory: %s\n",
+                     strerror( result ) );
+        }
+    }
+
+    result = RTMODE_SetupThread( pRt, pthread_self(), &pRt->loopCpus );
+    if ( result != EOK )
+    {
+        fprintf( stderr,
+                 "Failed to set up the event loop scheduling: %s\n",
+                 strerror( result ) );
+    }
+
+    if ( pState->txRing.running == true )
+    {
+        result = RTMODE_SetupThread( pRt,
+                                     pState->txRing.thread,
+                                     &pRt->senderCpus );
+        if ( result != EOK )
+        {
+            fprintf( stderr,
+                     "Failed to set up the sender thread scheduling: %s\n",
+                     strerror( result ) );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  CheckSteadyState                                                          */
+/*!
+    Check that the event loop does not allocate memory
+
+    The CheckSteadyState function enters the steady state on the first
+    timer tick at which every enabled channel has rendered its payload,
+    so the buffers which are allocated on first use have been
+    allocated.  From then on, the heap allocations made during each
+    pass of the event loop are counted, and the first one is reported.
+    It is only used when the build counts the heap allocations
+    (UDPT_RT_ALLOC_CHECK).
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        tick
+            indicates the pass processed a timer tick
+
+==============================================================================*/
+static void CheckSteadyState( UDPTState *pState, bool tick )
+{
+    RtMode *pRt = &pState->rt;
+    uint64_t allocs = pRt->allocs;
+    size_t i;
+
+    if ( pRt->armed == false )
+    {
+        for ( i = 0; ( tick == true ) && ( i < pState->nChannels ); i++ )
+        {
+            if ( ( pState->channels[i].enable ) &&
+                 ( pState->channels[i].renderTime.count == 0 ) )
+            {
+                tick = false;
+            }
+        }
+
+        if ( tick == true )
+        {
+            RTMODE_Arm( pRt );
+        }
+    }
+    else if ( ( RTMODE_Check( pRt ) > 0 ) &&
+              ( allocs == 0 ) )
+    {
+        fprintf( stderr, "Heap allocation in the steady state\n" );
+    }
+}
+
+/*============================================================================*/
+/*  SetupTimer                                                                */
+/*!
+    Set up a timer
+
+    The SetupTimer function sets up a timer to periodically broadcast
+    the rendered UDP templates of all of the channels.
+
+    The timer is a timerfd which runs against CLOCK_MONOTONIC so the
+    schedule is not shifted by changes to the wall clock.  Every channel
+    with a non-zero transmission period is added to the transmission
+    schedule, and the timer is armed for the earliest channel deadline.
+    A channel which does not fit in the schedule is reported.
+
+    @param[in]
+        pState
+            Pointer to the UDPTState object containing the timer
+
+    @retval EOK timer set up ok
+    @retval ENOSPC a channel could not be scheduled
+    @retval other error from timerfd_create or timerfd_settime
+
+==============================================================================*/
+static int SetupTimer( UDPTState *pState )
+{
+    int result = EINVAL;
+    uint64_t now_ns;
+    size_t i;
+    int rc;
+
+    if ( pState != NULL )
+    {
+        result = EOK;
+
+        if ( pState->timerFd == -1 )
+        {
+            /* create the transmission timer */
+            pState->timerFd = timerfd_create( CLOCK_MONOTONIC,
+                                              TFD_NONBLOCK | TFD_CLOEXEC );
+            if ( pState->timerFd == -1 )
+            {
+                result = errno;
+            }
+        }
+
+        if ( result == EOK )
+        {
+            /* schedule the first transmission of each channel */
+            now_ns = SCHED_Now();
+            for ( i = 0; i < pState->nChannels; i++ )
+            {
+                rc = ScheduleChannel( pState, &pState->channels[i], now_ns );
+                if ( rc != EOK )
+                {
+                    fprintf( stderr,
+                             "UDPT: Failed to schedule channel %zu: %s\n",
+                             i,
+                             strerror( rc ) );
+                    result = rc;
+                }
+            }
+
+            rc = ArmTimer( pState );
+            result = ( result == EOK ) ? rc : result;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupLoad                                                                 */
+/*!
+    Set up the load generator timer
+
+    The SetupLoad function creates a timer which wakes the event loop
+    every LOADGEN_TICK_NS while a synthetic load is configured.  The
+    number of transmissions sent on each tick follows the target rate,
+    so the load does not depend on the channel's own schedule.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @retval EOK the timer was set up, or there is no synthetic load
+    @retval other error from timerfd_create or timerfd_settime
+
+==============================================================================*/
+static int SetupLoad( UDPTState *pState )
+{
+    int result = EOK;
+    struct itimerspec its;
+
+    if ( pState->pLoadChannel != NULL )
+    {
+        pState->loadFd = timerfd_create( CLOCK_MONOTONIC,
+                                         TFD_NONBLOCK | TFD_CLOEXEC );
+        if ( pState->loadFd != -1 )
+        {
+            memset( &its, 0, sizeof( its ) );
+            its.it_interval.tv_sec = LOADGEN_TICK_NS / 1000000000ULL;
+            its.it_interval.tv_nsec = LOADGEN_TICK_NS % 1000000000ULL;
+            its.it_value = its.it_interval;
+
+            if ( timerfd_settime( pState->loadFd, 0, &its, NULL ) != 0 )
+            {
+                result = errno;
+            }
+        }
+        else
+        {
+            result = errno;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ScheduleChannel                                                           */
+/*!
+    Schedule the periodic transmission of a channel
+
+    The ScheduleChannel function calculates the transmission period of
+    the channel from its microsecond interval variable if it is set,
+    otherwise from its transmission rate variable in seconds.  The
+    channel is re-scheduled for its first deadline (see FirstDeadline),
+    or removed from the schedule if its period is zero.
+
+    The caller must re-arm the timer using ArmTimer once the schedule
+    has been updated.
+
+    @param[in]
+        pState
+            Pointer to the UDPTState object containing the schedule
+
+    @param[in]
+        pChannel
+            Pointer to the channel to schedule
+
+    @param[in]
+        now_ns
+            current monotonic time in nanoseconds
+
+    @retval EOK the channel was scheduled
+    @retval ENOSPC the schedule is full
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int ScheduleChannel( UDPTState *pState,
+                            UDPTChannel *pChannel,
+                            uint64_t now_ns )
+{
+    int result = EINVAL;
+
+    if ( ( pState != NULL ) &&
+         ( pChannel != NULL ) )
+    {
+        pChannel->period_ns = ( pChannel->txinterval_us != 0 )
+                            ? (uint64_t)pChannel->txinterval_us * 1000ULL
+                            : (uint64_t)pChannel->txrate_s * 1000000000ULL;
+
+        (void)SCHED_Remove( &pState->schedule, pChannel );
+
+        result = EOK;
+        if ( pChannel->period_ns != 0 )
+        {
+            result = SCHED_Insert( &pState->schedule,
+                                   FirstDeadline( pState, pChannel, now_ns ),
+                                   pChannel );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  FirstDeadline                                                             */
+/*!
+    Get the first periodic transmission deadline of a channel
+
+    The FirstDeadline function gets the first transmission deadline of a
+    newly scheduled channel.  By default this is one period from now.
+    With wall clock alignment (-A) the deadline is the next wall clock
+    multiple of the period plus the alignment offset, and with a stagger
+    key (-j) it is further offset within the period by the stagger hash
+    of this instance, so instances which start together do not transmit
+    together.  A stagger without alignment is anchored to the monotonic
+    clock.  Later deadlines stay on the same grid (see ProcessTimer).
+
+    @param[in]
+        pState
+            Pointer to the UDPTState object
+
+    @param[in]
+        pChannel
+            Pointer to the channel to schedule
+
+    @param[in]
+        now_ns
+            current monotonic time in nanoseconds
+
+    @retval the first transmission deadline in nanoseconds
+
+==============================================================================*/
+static uint64_t FirstDeadline( UDPTState *pState,
+                               UDPTChannel *pChannel,
+                               uint64_t now_ns )
+{
+    uint64_t deadline_ns = now_ns + pChannel->period_ns;
+    uint64_t phase_ns = 0;
+    uint64_t epoch_ns = 0;
+
+    if ( ( pState->alignWallClock == true ) ||
+         ( pState->staggerKey != NULL ) )
+    {
+        if ( pState->alignWallClock == true )
+        {
+            phase_ns = pState->alignOffset_ns;
+            epoch_ns = SCHED_RealtimeOffset();
+        }
+
+        if ( ( pState->staggerKey != NULL ) &&
+             ( pChannel->period_ns > 0 ) )
+        {
+            phase_ns += pState->staggerHash % pChannel->period_ns;
+        }
+
+        deadline_ns = SCHED_Align( now_ns,
+                                   pChannel->period_ns,
+                                   phase_ns,
+                                   epoch_ns );
+    }
+
+    return deadline_ns;
+}
+
+/*============================================================================*/
+/*  SetupStagger                                                              */
+/*!
+    Derive the transmission stagger of this instance
+
+    The SetupStagger function hashes the stagger key selected with the
+    -j option.  The key "mac" uses the hardware address of the first
+    non-loopback network interface, and the key "hostname" uses the
+    host name, so every device gets its own deterministic offset
+    within the transmission period.  Any other key is hashed as given.
+
+    @param[in]
+        pState
+            Pointer to the UDPTState object
+
+    @retval EOK the stagger was set up, or no stagger key was given
+    @retval ENOENT the MAC address or host name is not available
+    @retval EINVAL invalid argument
+
+==============================================================================*/
+static int SetupStagger( UDPTState *pState )
+{
+    int result = EINVAL;
+    unsigned char mac[ETH_ALEN];
+    char hostname[HOST_NAME_MAX + 1];
+
+    if ( pState != NULL )
+    {
+        result = EOK;
+
+        if ( pState->staggerKey == NULL )
+        {
+            /* transmissions are not staggered */
+        }
+        else if ( strcmp( pState->staggerKey, "mac" ) == 0 )
+        {
+            result = GetMACAddress( mac, sizeof( mac ) );
+            if ( result == EOK )
+            {
+                pState->staggerHash = HASH_Compute( mac, sizeof( mac ) );
+            }
+        }
+        else if ( strcmp( pState->staggerKey, "hostname" ) == 0 )
+        {
+            result = ENOENT;
+            if ( gethostname( hostname, sizeof( hostname ) ) == 0 )
+            {
+                hostname[HOST_NAME_MAX] = '\0';
+                pState->staggerHash = HASH_Compute( hostname,
+                                                    strlen( hostname ) );
+                result = EOK;
+            }
+        }
+        else
+        {
+            pState->staggerHash = HASH_Compute( pState->staggerKey,
+                                                strlen( pState->staggerKey ) );
+        }
+
+        if ( result != EOK )
+        {
+            /* do not stagger without a key */
+            free( pState->staggerKey );
+            pState->staggerKey = NULL;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  GetMACAddress                                                             */
+/*!
+    Get the hardware address of this device
+
+    The GetMACAddress function gets the hardware address of the
+    non-loopback network interface with the lowest name which has a
+    non-zero hardware address, so the same interface is chosen every
+    time the device starts.
+
+    @param[out]
+        pAddr
+            pointer to a buffer to store the hardware address
+
+    @param[in]
+        len
+            length of the hardware address buffer
+
+    @retval EOK the hardware address was found
+    @retval ENOENT no interface has a hardware address
+    @retval other error from getifaddrs
+
+==============================================================================*/
+static int GetMACAddress( unsigned char *pAddr, size_t len )
+{
+    int result = ENOENT;
+    struct ifaddrs *pList;
+    struct ifaddrs *pIfa;
+    struct ifaddrs *pBest = NULL;
+    struct sockaddr_ll *pLL;
+    static const unsigned char zero[8] = { 0 };
+
+    if ( getifaddrs( &pList ) != 0 )
+    {
+        result = errno;
+    }
+    else
+    {
+        for ( pIfa = pList; pIfa != NULL; pIfa = pIfa->ifa_next )
+        {
+            pLL = (struct sockaddr_ll *)pIfa->ifa_addr;
+            if ( ( pLL != NULL ) &&
+                 ( pLL->sll_family == AF_PACKET ) &&
+                 ( ( pIfa->ifa_flags & IFF_LOOPBACK ) == 0 ) &&
+                 ( pLL->sll_halen == len ) &&
+                 ( len <= sizeof( zero ) ) &&
+                 ( memcmp( pLL->sll_addr, zero, len ) != 0 ) &&
+                 ( ( pBest == NULL ) ||
+                   ( strcmp( pIfa->ifa_name, pBest->ifa_name ) < 0 ) ) )
+            {
+                pBest = pIfa;
+            }
+        }
+
+        if ( pBest != NULL )
+        {
+            pLL = (struct sockaddr_ll *)pBest->ifa_addr;
+            memcpy( pAddr, pLL->sll_addr, len );
+            result = EOK;
+        }
+
+        freeifaddrs( pList );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ArmTimer                                                                  */
+/*!
+    Arm the transmission timer for the earliest channel deadline
+
+    The ArmTimer function arms the transmission timer as a one-shot
+    absolute timer which expires at the earliest deadline in the
+    transmission schedule or the change-triggered transmission
+    schedule.  The timer is disarmed if no channel is scheduled.
+
+    @param[in]
+        pState
+            Pointer to the UDPTState object containing the timer
+
+    @retval EOK the timer was armed
+    @retval other error from timerfd_settime
+
+==============================================================================*/
+static int ArmTimer( UDPTState *pState )
+{
+    struct itimerspec its;
+    uint64_t deadline_ns = 0;
+    uint64_t next_ns;
+    int rc;
+
+    /* a zero expiry time disarms the timer */
+    memset( &its, 0, sizeof( its ) );
+
+    if ( SCHED_Peek( &pState->schedule, &next_ns, NULL ) == EOK )
+    {
+        deadline_ns = next_ns;
+    }
+
+    if ( ( SCHED_Peek( &pState->changeSchedule, &next_ns, NULL ) == EOK ) &&
+         ( ( deadline_ns == 0 ) || ( next_ns < deadline_ns ) ) )
+    {
+        deadline_ns = next_ns;
+    }
+
+    if ( deadline_ns != 0 )
+    {
+        its.it_value.tv_sec = deadline_ns / 1000000000ULL;
+        its.it_value.tv_nsec = deadline_ns % 1000000000ULL;
+    }
+
+    rc = timerfd_settime( pState->timerFd, TFD_TIMER_ABSTIME, &its, NULL );
+
+    return ( rc == 0 ) ? EOK : errno;
+}
+
+/*============================================================================*/
+/*  SetupSignals                                                              */
+/*!
+    Set up the varserver notification signal file descriptor
+
+    The SetupSignals function blocks the varserver notification signals
+    so they are not delivered asynchronously, and creates a signalfd
+    from which they can be read by the event loop.
+
+    @param[in]
+        pState
+            Pointer to the UDPTState object
+
+    @retval EOK the signal file descriptor was created
+    @retval EINVAL invalid arguments
+    @retval other error from sigprocmask or signalfd
+
+==============================================================================*/
+static int SetupSignals( UDPTState *pState )
+{
+    int result = EINVAL;
+    sigset_t mask;
+
+    if ( pState != NULL )
+    {
+        sigemptyset( &mask );
+        sigaddset( &mask, SIG_VAR_MODIFIED );
+        sigaddset( &mask, SIG_VAR_PRINT );
+
+        if ( sigprocmask( SIG_BLOCK, &mask, NULL ) == 0 )
+        {
+            pState->sigFd = signalfd( -1, &mask, SFD_NONBLOCK | SFD_CLOEXEC );
+            result = ( pState->sigFd != -1 ) ? EOK : errno;
+        }
+        else
+        {
+            result = errno;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupEventLoop                                                            */
+/*!
+    Set up the event loop
+
+    The SetupEventLoop function creates the epoll instance used by
+    the message handler, and registers the signal, timer, netlink, and
+    sender thread completion file descriptors with it.  The subscriber
+    sockets are registered for their error events, which signal errors
+    queued on their error queues.
+
+    @param[in]
+        pState
+            Pointer to the UDPTState object
+
+    @retval EOK the event loop was set up
+    @retval EINVAL invalid arguments
+    @retval other error from epoll_create1 or epoll_ctl
+
+==============================================================================*/
+static int SetupEventLoop( UDPTState *pState )
+{
+    int result = EINVAL;
+    struct epoll_event ev;
+    int fds[5];
+    size_t i;
+
+    if ( pState != NULL )
+    {
+        result = EOK;
+
+        pState->epollFd = epoll_create1( EPOLL_CLOEXEC );
+        if ( pState->epollFd != -1 )
+        {
+            fds[0] = pState->sigFd;
+            fds[1] = pState->timerFd;
+            fds[2] = IFTABLE_GetFd( &pState->ifTable );
+            fds[3] = TXRING_GetFd( &pState->txRing );
+            fds[4] = pState->loadFd;
+
+            for ( i = 0; ( i < sizeof(fds)/sizeof(fds[0]) ) && ( result == EOK ); i++ )
+            {
+                if ( fds[i] != -1 )
+                {
+                    memset( &ev, 0, sizeof( ev ) );
+                    ev.events = EPOLLIN;
+                    ev.data.fd = fds[i];
+                    if ( epoll_ctl( pState->epollFd,
+                                    EPOLL_CTL_ADD,
+                                    fds[i],
+                                    &ev ) != 0 )
+                    {
+                        result = errno;
+                    }
+                }
+            }
+
+            for ( i = 0; ( i < 2 ) && ( result == EOK ); i++ )
+            {
+                if ( pState->subFd[i] != -1 )
+                {
+                    memset( &ev, 0, sizeof( ev ) );
+                    ev.events = EPOLLERR;
+                    ev.data.fd = pState->subFd[i];
+                    if ( epoll_ctl( pState->epollFd,
+                                    EPOLL_CTL_ADD,
+                                    pState->subFd[i],
+                                    &ev ) != 0 )
+                    {
+                        result = errno;
+                    }
+                }
+            }
+        }
+        else
+        {
+            result = errno;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RunMessageHandler                                                         */
+/*!
+    Run the message handler loop
+
+    The RunMessageHandler function waits for events from the timer, the
+    variable server, the network interface table, the sender thread or
+    the load generator.
+    On each wakeup
+    all of the pending events are drained.  Duplicate modification
+    notifications for the same variable are coalesced, and the
+    modifications are applied before any timer tick is processed so
+    the transmission uses the latest configuration.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+==============================================================================*/
+static void RunMessageHandler( UDPTState *pState )
+{
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    VAR_HANDLE pending[MAX_PENDING_MODIFIED];
+    size_t nPending;
+    bool tick;
+    bool loadTick;
+    int n;
+    int i;
+    size_t j;
+
+    while( 1 )
+    {
+        /* wait for events */
+        n = epoll_wait( pState->epollFd, events, MAX_EPOLL_EVENTS, -1 );
+        if ( n == -1 )
+        {
+            if ( errno != EINTR )
+            {
+                fprintf( stderr, "epoll_wait failed: %s\n", strerror( errno ) );
+            }
+
+            continue;
+        }
+
+        nPending = 0;
+        tick = false;
+        loadTick = false;
+
+        /* the transmissions of this pass share a new variable snapshot */
+        VARSNAP_Invalidate( &pState->snapshot );
+
+        for ( i = 0; i < n; i++ )
+        {
+            if ( events[i].data.fd == pState->sigFd )
+            {
+                /* drain the varserver notifications */
+                ProcessSignals( pState, pending, &nPending );
+            }
+            else if ( events[i].data.fd == pState->timerFd )
+            {
+                tick = true;
+            }
+            else if ( events[i].data.fd == pState->loadFd )
+            {
+                loadTick = true;
+            }
+            else if ( events[i].data.fd == IFTABLE_GetFd( &pState->ifTable ) )
+            {
+                /* apply the network interface changes */
+                ProcessInterfaces( pState );
+            }
+            else if ( events[i].data.fd == TXRING_GetFd( &pState->txRing ) )
+            {
+                /* collect the results of the sent batches */
+                ProcessCompletions( pState );
+            }
+            else if ( IsSubscriberSocket( pState, events[i].data.fd ) )
+            {
+                /* collect the errors reported for the subscribers */
+                ProcessSubscriberErrors( pState, events[i].data.fd );
+            }
+        }
+
+        /* dispatch the coalesced modification notifications */
+        for ( j = 0; j < nPending; j++ )
+        {
+            (void)ProcessModified( pState, pending[j] );
+        }
+
+        if ( tick == true )
+        {
+            /* process received timer tick */
+            (void)ProcessTimer( pState );
+        }
+
+        if ( loadTick == true )
+        {
+            /* send the synthetic load which is due */
+            ProcessLoad( pState );
+        }
+
+        if ( pState->txStamp.mode != TXSTAMP_OFF )
+        {
+            /* collect the transmit timestamps of the sent datagrams */
+            ProcessTxStamps( pState );
+        }
+
+        if ( ( pState->rt.enabled == true ) &&
+             ( RTMODE_CountsAllocations() == true ) )
+        {
+            /* check that the pass did not allocate memory */
+            CheckSteadyState( pState, tick );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  ProcessSignals                                                            */
+/*!
+    Drain the varserver notification signals
+
+    The ProcessSignals function reads all of the pending signals from the
+    signal file descriptor.  Print requests are handled immediately.
+    Modification notifications are added to the pending list unless the
+    variable is already in it.  If the pending list is full, the
+    notification is handled immediately.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in,out]
+        pPending
+            pointer to the list of variables with pending modifications
+
+    @param[in,out]
+        pNumPending
+            pointer to the number of variables in the pending list
+
+==============================================================================*/
+static void ProcessSignals( UDPTState *pState,
+                            VAR_HANDLE *pPending,
+                            size_t *pNumPending )
+{
+    struct signalfd_siginfo info[MAX_SIGNALS_PER_READ];
+    VAR_HANDLE hVar;
+    ssize_t len;
+    size_t count;
+    size_t i;
+    size_t j;
+
+    while ( ( len = read( pState->sigFd, info, sizeof( info ) ) ) > 0 )
+    {
+        count = (size_t)len / sizeof( struct signalfd_siginfo );
+        for ( i = 0; i < count; i++ )
+        {
+            if ( (int)info[i].ssi_signo == SIG_VAR_MODIFIED )
+            {
+                hVar = (VAR_HANDLE)info[i].ssi_int;
+
+                for ( j = 0; j < *pNumPending; j++ )
+                {
+                    if ( pPending[j] == hVar )
+                    {
+                        break;
+                    }
+                }
+
+                if ( j == *pNumPending )
+                {
+                    if ( *pNumPending < MAX_PENDING_MODIFIED )
+                    {
+                        pPending[(*pNumPending)++] = hVar;
+                    }
+                    else
+                    {
+                        (void)ProcessModified( pState, hVar );
+                    }
+                }
+            }
+            else if ( (int)info[i].ssi_signo == SIG_VAR_PRINT )
+            {
+                (void)HandlePrintRequest( pState, info[i].ssi_int );
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  ProcessTimer                                                              */
+/*!
+    Process a received timer tick
+
+    The ProcessTimer function processes every channel whose deadline
+    has been reached, rendering its UDP template and transmitting the
+    broadcast message.  Each channel is re-scheduled relative to its
+    previous deadline so the schedule does not drift, and any periods
+    which were missed are skipped and counted as overruns.  Every
+    change-triggered transmission which has become due is then sent,
+    and the timer is re-armed for the next earliest deadline.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object to process
+
+    @retval EOK Timer handler processed successfully
+    @retval EINVAL invalid argument
+
+==============================================================================*/
+static int ProcessTimer( UDPTState *pState )
+{
+    int result = EINVAL;
+    uint64_t expirations;
+    uint64_t now_ns;
+    uint64_t deadline_ns;
+    uint64_t missed;
+    UDPTChannel *pChannel;
+    void *pCtx;
+    int rc;
+
+    if ( pState != NULL )
+    {
+        /* acknowledge the timer expiry */
+        (void)read( pState->timerFd, &expirations, sizeof( expirations ) );
+
+        now_ns = SCHED_Now();
+
+        while ( ( SCHED_Peek( &pState->schedule, &deadline_ns, NULL ) == EOK ) &&
+                ( deadline_ns <= now_ns ) )
+        {
+            (void)SCHED_Pop( &pState->schedule, &deadline_ns, &pCtx );
+            pChannel = (UDPTChannel *)pCtx;
+
+            /* count the transmissions we did not get to */
+            missed = ( now_ns - deadline_ns ) / pChannel->period_ns;
+            pChannel->overruns += (uint32_t)missed;
+
+            /* schedule the next transmission on the original grid */
+            rc = SCHED_Insert( &pState->schedule,
+                               deadline_ns +
+                               ( missed + 1 ) * pChannel->period_ns,
+                               pChannel );
+            if ( rc != EOK )
+            {
+                fprintf( stderr,
+                         "UDPT: Failed to re-schedule channel: %s\n",
+                         strerror( rc ) );
+            }
+
+            if ( pChannel->enable )
+            {
+                /* record how late this transmission is */
+                HISTOGRAM_Record( &pChannel->jitter,
+                                  SCHED_Now() - deadline_ns );
+
+                (void)SendOutput( pState, pChannel, true );
+            }
+        }
+
+        while ( ( SCHED_Peek( &pState->changeSchedule,
+                              &deadline_ns,
+                              NULL ) == EOK ) &&
+                ( deadline_ns <= now_ns ) )
+        {
+            (void)SCHED_Pop( &pState->changeSchedule, &deadline_ns, &pCtx );
+            pChannel = (UDPTChannel *)pCtx;
+            pChannel->changePending = false;
+
+            if ( pChannel->enable )
+            {
+                pChannel->changeSends++;
+                (void)SendOutput( pState, pChannel, false );
+            }
+        }
+
+        result = ArmTimer( pState );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessLoad                                                               */
+/*!
+    Send the synthetic load which is due
+
+    The ProcessLoad function sends the transmissions of the load
+    generator's virtual sources which are due at its target rate.  The
+    seed and sequence number of each transmission's source are spliced
+    into the rendered payload, in the same way as the interface IP
+    address, so no variables are written per transmission.  Each one
+    is sent through the same path as a change-triggered transmission,
+    so it is compressed, paced and batched like any other payload, but
+    never suppressed, since its sequence number differs from the last.
+    The load generator is started when the load channel is enabled, and
+    stopped when it is disabled.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+==============================================================================*/
+static void ProcessLoad( UDPTState *pState )
+{
+    UDPTChannel *pChannel = pState->pLoadChannel;
+    LoadGen *pGen = &pState->load;
+    LoadSource *pSource;
+    uint64_t expirations;
+    uint64_t now_ns;
+    size_t n;
+
+    /* acknowledge the timer expiry */
+    (void)read( pState->loadFd, &expirations, sizeof( expirations ) );
+
+    now_ns = SCHED_Now();
+
+    if ( pChannel->enable == 0 )
+    {
+        LOADGEN_Stop( pGen );
+    }
+    else
+    {
+        if ( pGen->running == false )
+        {
+            /* salt the seeds with the stagger key so the virtual
+               sources of different instances are distinct */
+            LOADGEN_Start( pGen, now_ns, pState->staggerHash );
+        }
+
+        for ( n = LOADGEN_Due( pGen, now_ns ); n > 0; n-- )
+        {
+            pSource = LOADGEN_Next( pGen );
+
+            /* the fields spliced into the load channel's payload */
+            pState->loadSeed = pSource->seed;
+            pState->loadSeq = pSource->seq;
+
+            (void)SendOutput( pState, pChannel, false );
+            LOADGEN_Sent( pGen, pSource );
+        }
+
+        LOADGEN_Sample( pGen, SCHED_Now() );
+    }
+}
+
+/*============================================================================*/
+/*  ProcessInterfaces                                                         */
+/*!
+    Process network interface table changes
+
+    The ProcessInterfaces function applies the pending network interface
+    changes to the interface table.  If the table has changed, the
+    cached sockets of interfaces which have gone away are closed.
+    This is done here rather than in the send pass, since each channel
+    only sends on the interfaces in its own allow-list.  The source
+    addresses of the unicast subscribers are also looked up again.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+==============================================================================*/
+static void ProcessInterfaces( UDPTState *pState )
+{
+    uint32_t generation = pState->ifTable.generation;
+    IfEntry *pEntry;
+    size_t i;
+
+    (void)IFTABLE_Process( &pState->ifTable );
+
+    if ( pState->ifTable.generation != generation )
+    {
+        /* the sender thread may still be using the sockets */
+        WaitSender( pState );
+
+        SOCKCACHE_BeginPass( &pState->sockCache );
+
+        for ( i = 0; i < pState->ifTable.n; i++ )
+        {
+            pEntry = &pState->ifTable.entries[i];
+            if ( pEntry->up == true )
+            {
+                SOCKCACHE_Touch( &pState->sockCache,
+                                 pEntry->ifname,
+                                 pEntry->family );
+            }
+        }
+
+        SOCKCACHE_EndPass( &pState->sockCache );
+
+        for ( i = 0; i < pState->nChannels; i++ )
+        {
+            SUBLIST_ResolveSources( &pState->channels[i].subscribers );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  ProcessModified                                                           */
+/*!
+    Process a NOTIFY_MODIFIED notification
+
+    The ProcessModified function handles changes to varserver variables.
+    The process-wide variables and the variables of every channel are
+    checked, since a variable may be shared by several channels.
+    Changes to the variables referenced by the templates of
+    change-triggered channels schedule a transmission, and in
+    incremental mode discard the cached text of the variable.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        hVar
+            handle to the modified variable
+
+    @retval EOK Modified handler processed successfully
+    @retval ENOENT the variable was not found
+    @retval EINVAL invalid argument
+
+==============================================================================*/
+static int ProcessModified( UDPTState *pState, VAR_HANDLE hVar )
+{
+    int result = EINVAL;
+    int rc;
+    size_t i;
+
+    if ( pState != NULL )
+    {
+        result = DispatchModified( pState,
+                                   NULL,
+                                   pState->pVarDef,
+                                   pState->varCount,
+                                   hVar );
+
+        for ( i = 0; i < pState->nChannels; i++ )
+        {
+            rc = DispatchModified( pState,
+                                   &pState->channels[i],
+                                   pState->channels[i].vars,
+                                   CHANNEL_VAR_COUNT,
+                                   hVar );
+            if ( rc != ENOENT )
+            {
+                result = rc;
+            }
+        }
+
+        if ( pState->incremental == true )
+        {
+            InvalidateTemplates( pState, hVar );
+        }
+
+        rc = ProcessChange( pState, hVar );
+        if ( rc != ENOENT )
+        {
+            result = rc;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  InvalidateTemplates                                                       */
+/*!
+    Discard the cached text of a modified variable
+
+    The InvalidateTemplates function discards the formatted text of a
+    modified variable from the cache of every compiled template, so the
+    next incremental rendering formats its new value.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        hVar
+            handle to the modified variable
+
+==============================================================================*/
+static void InvalidateTemplates( UDPTState *pState, VAR_HANDLE hVar )
+{
+    size_t i;
+
+    for ( i = 0; i < MAX_CHANNELS; i++ )
+    {
+        if ( pState->templates[i].refCount > 0 )
+        {
+            (void)CTEMPLATE_Invalidate( &pState->templates[i].compiled,
+                                        hVar );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  ProcessChange                                                             */
+/*!
+    Process a change to a template variable
+
+    The ProcessChange function schedules a change-triggered transmission
+    on every enabled change-triggered channel whose template references
+    the modified variable.  The IP address and load generator variables
+    are ignored.  Their values are spliced into the payload at send
+    time rather than read from the varserver, and with -R the IP
+    address variable is only written by UDPt itself when the sending
+    interface's address changes.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        hVar
+            handle to the modified variable
+
+    @retval EOK a transmission was scheduled on at least one channel
+    @retval ENOENT no change-triggered channel references the variable
+    @retval other error from ScheduleChange
+
+==============================================================================*/
+static int ProcessChange( UDPTState *pState, VAR_HANDLE hVar )
+{
+    int result = ENOENT;
+    UDPTChannel *pChannel;
+    uint64_t now_ns = SCHED_Now();
+    size_t i;
+
+    if ( ( hVar != pState->hIPAddr ) &&
+         ( hVar != pState->hLoadSeed ) &&
+         ( hVar != pState->hLoadSeq ) )
+    {
+        for ( i = 0; i < pState->nChannels; i++ )
+        {
+            pChannel = &pState->channels[i];
+
+            if ( ( pChannel->onChange != 0 ) &&
+                 ( pChannel->enable != 0 ) &&
+                 ( pChannel->pTemplate != NULL ) &&
+                 ( CTEMPLATE_References( &pChannel->pTemplate->compiled,
+                                         hVar ) == true ) )
+            {
+                pChannel->changes++;
+                result = ScheduleChange( pState, pChannel, now_ns );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ScheduleChange                                                            */
+/*!
+    Schedule a change-triggered transmission
+
+    The ScheduleChange function schedules a transmission of the channel
+    at the end of its debounce window, so all the changes made during
+    the window are sent in a single payload.  The window starts at the
+    first change, so a continuous stream of changes cannot hold off
+    the transmission indefinitely.  The transmission is also held off
+    until the channel's minimum interval has passed since its previous
+    transmission.  Changes made while a transmission is already
+    scheduled are coalesced into it.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        pChannel
+            pointer to the channel to schedule
+
+    @param[in]
+        now_ns
+            current monotonic time in nanoseconds
+
+    @retval EOK the transmission is scheduled
+    @retval ENOSPC the change schedule is full
+    @retval other error from timerfd_settime
+
+==============================================================================*/
+static int ScheduleChange( UDPTState *pState,
+                           UDPTChannel *pChannel,
+                           uint64_t now_ns )
+{
+    int result = EOK;
+    uint64_t deadline_ns;
+    uint64_t earliest_ns;
+
+    if ( pChannel->changePending == false )
+    {
+        deadline_ns = now_ns + (uint64_t)pChannel->debounce_us * 1000ULL;
+
+        earliest_ns = pChannel->lastSend_ns +
+                      (uint64_t)pChannel->mininterval_us * 1000ULL;
+        if ( ( pChannel->lastSend_ns != 0 ) &&
+             ( deadline_ns < earliest_ns ) )
+        {
+            deadline_ns = earliest_ns;
+        }
+
+        result = SCHED_Insert( &pState->changeSchedule,
+                               deadline_ns,
+                               pChannel );
+        if ( result == EOK )
+        {
+            pChannel->changePending = true;
+            result = ArmTimer( pState );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  DispatchModified                                                          */
+/*!
+    Dispatch a modification notification to a variable definition list
+
+    The DispatchModified function gets the new value of every variable
+    in the list which matches the modified variable handle, and invokes
+    its change callback.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        pChannel
+            pointer to the channel which owns the list, or NULL for
+            the process-wide variables
+
+    @param[in]
+        pVarDef
+            pointer to the variable definition list
+
+    @param[in]
+        count
+            number of variables in the list
+
+    @param[in]
+        hVar
+            handle to the modified variable
+
+    @retval EOK the modification was processed
+    @retval ENOENT the variable is not in the list
+    @retval other error from the change callback
+
+==============================================================================*/
+static int DispatchModified( UDPTState *pState,
+                             UDPTChannel *pChannel,
+                             VarDef *pVarDef,
+                             size_t count,
+                             VAR_HANDLE hVar )
+{
+    int result = ENOENT;
+    size_t i;
+
+    if ( pVarDef != NULL )
+    {
+        for ( i = 0; i < count; i++ )
+        {
+            if ( ( pVarDef[i].pVarHandle != NULL ) &&
+                 ( *(pVarDef[i].name) != NULL ) &&
+                 ( *(pVarDef[i].pVarHandle) == hVar ) )
+            {
+                /* get the variable value */
+                GetVar( pState->hVarServer, &pVarDef[i] );
+
+                result = EOK;
+                if ( pVarDef[i].cb != NULL )
+                {
+                    /* invoke the var change callback */
+                    result = pVarDef[i].cb( pState, pChannel );
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessTemplate                                                           */
+/*!
+    Process a UDP template
+
+    The ProcessTemplate function renders the channel's compiled template
+    into the text rendering buffer, or as CBOR if the channel uses the binary
+    encoding, ready to be sent as a UDP broadcast on all allowed
+    networks.  Unless per-interface rendering is selected, the
+    references to the IP address variable are left out and their
+    offsets recorded, so the rendered output can be shared by all
+    interfaces.  The references to the load generator variables in the
+    load channel's template are left out in the same way, so each
+    virtual source's seed and sequence number can be spliced in.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        pChannel
+            pointer to the channel whose template is to be rendered
+
+    @retval EOK template rendered successfully
+    @retval ENOENT no valid template is available
+    @retval E2BIG the rendering is larger than the maximum payload size
+    @retval EBADF a variable must be printed but there is no output stream
+    @retval EIO output stream seek error
+    @retval EINVAL invalid argument
+
+==============================================================================*/
+static int ProcessTemplate( UDPTState *pState, UDPTChannel *pChannel )
+{
+    int result = EINVAL;
+    bool load;
+
+    if ( ( pState != NULL ) &&
+         ( pChannel != NULL ) )
+    {
+        pState->pRendered = NULL;
+        pState->renderedLen = 0;
+
+        /* the variables spliced into the rendered output */
+        load = ( pChannel == pState->pLoadChannel );
+        pState->splices.hVars[SPLICE_IPADDR] =
+            pState->perInterfaceRender ? VAR_INVALID : pState->hIPAddr;
+        pState->splices.hVars[SPLICE_LOAD_SEED] =
+            load ? pState->hLoadSeed : VAR_INVALID;
+        pState->splices.hVars[SPLICE_LOAD_SEQ] =
+            load ? pState->hLoadSeq : VAR_INVALID;
+        pState->splices.nVars = SPLICE_FIELDS;
+
+        if ( ( pChannel->pTemplate != NULL ) &&
+             ( pChannel->pTemplate->compiled.valid == true ) )
+        {
+            if ( pChannel->encoding == ENCODING_CBOR )
+            {
+                result = RenderCBOR( pState, &pChannel->pTemplate->compiled );
+            }
+            else
+            {
+                result = RenderText( pState, pChannel->pTemplate );
+            }
+        }
+        else
+        {
+            fprintf( stderr, "invalid template input\n");
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RenderText                                                                */
+/*!
+    Render a compiled template as text
+
+    The RenderText function renders the template as text directly into
+    the text rendering buffer, leaving out the fields selected by
+    ProcessTemplate which are spliced into each payload.  Only
+    the variables which are printed by the variable server go through
+    the VarFP output stream.
+
+    In incremental mode the text of the notified variables which have
+    not been modified is reused from the previous rendering.  Variables
+    which are printed by the variable server, such as the IP address
+    and values produced by print handlers, are formatted every time.
+    The whole cache is also discarded every CACHE_REFRESH_RENDERS
+    renderings in case a notification was missed.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        pTemplate
+            pointer to the template to render
+
+    @retval EOK template rendered successfully
+    @retval E2BIG the rendering is larger than the maximum payload size
+    @retval other error from CTEMPLATE_RenderBuffer
+
+==============================================================================*/
+static int RenderText( UDPTState *pState, UDPTTemplate *pTemplate )
+{
+    int result;
+    CTBuffer buffer;
+
+    buffer.pBuf = pState->pText;
+    buffer.size = pState->maxPayload;
+    buffer.len = 0;
+    buffer.fd = ( pState->pVarFP != NULL ) ? pState->varFd : -1;
+    buffer.pFdData = ( pState->pVarFP != NULL )
+                     ? VARFP_GetData( pState->pVarFP )
+                     : NULL;
+    buffer.fdSize = pState->maxPayload + 1;
+    buffer.fdOffset = -1;
+
+    if ( pState->incremental == true )
+    {
+        if ( ++pTemplate->cachedRenders >= CACHE_REFRESH_RENDERS )
+        {
+            pTemplate->cachedRenders = 0;
+            (void)CTEMPLATE_Invalidate( &pTemplate->compiled, VAR_INVALID );
+        }
+
+        result = CTEMPLATE_RenderCached( &pTemplate->compiled,
+                                         pState->hVarServer,
+                                         GetSnapshot( pState ),
+                                         &buffer,
+                                         &pState->splices );
+    }
+    else
+    {
+        result = CTEMPLATE_RenderBuffer( &pTemplate->compiled,
+                                         pState->hVarServer,
+                                         GetSnapshot( pState ),
+                                         &buffer,
+                                         &pState->splices );
+    }
+    if ( result == EOK )
+    {
+        pState->pRendered = pState->pText;
+        pState->renderedLen = buffer.len;
+        pState->renderEncoding = ENCODING_TEXT;
+    }
+    else
+    {
+        fprintf( stderr, "template generation error\n" );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  GetSnapshot                                                               */
+/*!
+    Get the variable snapshot for the current event loop pass
+
+    The GetSnapshot function gets the snapshot of the variables
+    referenced by the channel templates which the renderings of the
+    current event loop pass are formatted from.  The snapshot is taken
+    on the first rendering of each pass, so every interface and channel
+    rendered during the pass retrieves each variable only once, and
+    carries the same values.
+
+    The set of variables is rebuilt when a channel's template is
+    compiled or re-compiled.  The IP address variable is left out of
+    the set, since it changes between the interfaces of a pass.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @retval pointer to the variable snapshot
+    @retval NULL variable snapshots are not used
+
+==============================================================================*/
+static const VarSnapshot *GetSnapshot( UDPTState *pState )
+{
+    VarSnapshot *pSnap = NULL;
+    UDPTTemplate *pTemplate;
+    CTElement *pElement;
+    bool stale = false;
+    size_t i;
+    size_t j;
+
+    if ( pState->useSnapshot == true )
+    {
+        pSnap = &pState->snapshot;
+
+        for ( i = 0; i < pState->nChannels; i++ )
+        {
+            pTemplate = pState->channels[i].pTemplate;
+            if ( ( pTemplate != NULL ) &&
+                 ( pTemplate->snapGeneration != pTemplate->compiled.bindings ) )
+            {
+                stale = true;
+            }
+        }
+
+        if ( stale == true )
+        {
+            /* rebuild the set of template variables */
+            VARSNAP_Clear( pSnap );
+
+            for ( i = 0; i < pState->nChannels; i++ )
+            {
+                pTemplate = pState->channels[i].pTemplate;
+                for ( j = 0;
+                      ( pTemplate != NULL ) &&
+                      ( j < pTemplate->compiled.nElements );
+                      j++ )
+                {
+                    pElement = &pTemplate->compiled.elements[j];
+                    if ( ( pElement->isVar == true ) &&
+                         ( pElement->hVar != pState->hIPAddr ) )
+                    {
+                        (void)VARSNAP_Add( pSnap, pElement->hVar );
+                    }
+                }
+
+                if ( pTemplate != NULL )
+                {
+                    pTemplate->snapGeneration = pTemplate->compiled.bindings;
+                }
+            }
+        }
+
+        if ( pSnap->valid == false )
+        {
+            (void)VARSNAP_Take( pSnap, pState->hVarServer );
+        }
+    }
+
+    return pSnap;
+}
+
+/*============================================================================*/
+/*  RenderCBOR                                                                */
+/*!
+    Render a template as CBOR
+
+    The RenderCBOR function renders the values of the template's variable
+    references as a CBOR array into the binary rendering buffer, behind
+    a header carrying the template's schema identifier.  The fields
+    selected by ProcessTemplate are left out and their offsets
+    recorded, in the same way as for text renderings.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        pTemplate
+            pointer to the compiled template to render
+
+    @retval EOK template rendered successfully
+    @retval E2BIG the rendering is larger than the maximum payload size
+    @retval other error from CTEMPLATE_RenderCBOR
+
+==============================================================================*/
+static int RenderCBOR( UDPTState *pState, CompiledTemplate *pTemplate )
+{
+    int result = E2BIG;
+    CborWriter writer;
+    size_t hdrLen = UDPTMSG_CBOR_HEADER_SIZE;
+    size_t i;
+
+    if ( pState->maxPayload > hdrLen )
+    {
+        (void)UDPTMSG_WriteCBORHeader( pState->pBinary, pTemplate->schemaId );
+
+        CBOR_Init( &writer,
+                   &pState->pBinary[hdrLen],
+                   pState->maxPayload - hdrLen );
+
+        result = CTEMPLATE_RenderCBOR( pTemplate,
+                                       pState->hVarServer,
+                                       GetSnapshot( pState ),
+                                       &writer,
+                                       &pState->splices );
+        if ( result == EOK )
+        {
+            /* make the splice offsets relative to the start of the
+               payload */
+            for ( i = 0; i < pState->splices.nPoints; i++ )
+            {
+                pState->splices.points[i].offset += hdrLen;
+            }
+
+            pState->pRendered = pState->pBinary;
+            pState->renderedLen = hdrLen + writer.len;
+            pState->renderEncoding = ENCODING_CBOR;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  AcquireTemplate                                                           */
+/*!
+    Get the compiled template for a template file
+
+    The AcquireTemplate function gets the shared compiled template for
+    the specified template file, so channels which broadcast the same
+    template share a single compiled form.  If no channel is using the
+    template file yet, it is compiled into a free template slot.
+    The caller must release the template using ReleaseTemplate.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object containing the templates
+
+    @param[in]
+        filename
+            name of the template file
+
+    @retval pointer to the shared template
+    @retval NULL no template is specified, or no template slot is free
+
+==============================================================================*/
+static UDPTTemplate *AcquireTemplate( UDPTState *pState, const char *filename )
+{
+    UDPTTemplate *pTemplate = NULL;
+    UDPTTemplate *pFree = NULL;
+    size_t i;
+
+    if ( ( filename != NULL ) &&
+         ( filename[0] != '\0' ) )
+    {
+        for ( i = 0; ( i < MAX_CHANNELS ) && ( pTemplate == NULL ); i++ )
+        {
+            if ( pState->templates[i].refCount == 0 )
+            {
+                if ( pFree == NULL )
+                {
+                    pFree = &pState->templates[i];
+                }
+            }
+            else if ( strcmp( pState->templates[i].filename, filename ) == 0 )
+            {
+                pTemplate = &pState->templates[i];
+            }
+        }
+
+        if ( pTemplate != NULL )
+        {
+            /* pick up any changes to the template file */
+            (void)CTEMPLATE_Refresh( &pTemplate->compiled,
+                                     pState->hVarServer,
+                                     pTemplate->filename );
+            pTemplate->refCount++;
+        }
+        else if ( pFree != NULL )
+        {
+            pTemplate = pFree;
+            snprintf( pTemplate->filename,
+                      sizeof( pTemplate->filename ),
+                      "%s",
+                      filename );
+            pTemplate->refCount = 1;
+
+            if ( CTEMPLATE_Compile( &pTemplate->compiled,
+                                    pState->hVarServer,
+                                    pTemplate->filename ) != EOK )
+            {
+                fprintf( stderr,
+                         "Failed to compile template: %s\n",
+                         pTemplate->filename );
+            }
+        }
+    }
+
+    return pTemplate;
+}
+
+/*============================================================================*/
+/*  ReleaseTemplate                                                           */
+/*!
+    Release a shared compiled template
+
+    The ReleaseTemplate function releases a channel's reference to a
+    shared compiled template.  The compiled template is freed when it
+    is no longer used by any channel.
+
+    @param[in]
+        pTemplate
+            pointer to the template to release (may be NULL)
+
+==============================================================================*/
+static void ReleaseTemplate( UDPTTemplate *pTemplate )
+{
+    if ( ( pTemplate != NULL ) &&
+         ( pTemplate->refCount > 0 ) )
+    {
+        if ( --pTemplate->refCount == 0 )
+        {
+            CTEMPLATE_Free( &pTemplate->compiled );
+            COMPRESS_Free( &pTemplate->compressor );
+            pTemplate->dictGeneration = 0;
+            pTemplate->notifyGeneration = 0;
+            pTemplate->snapGeneration = 0;
+            pTemplate->cachedRenders = 0;
+            pTemplate->filename[0] = '\0';
+        }
+    }
+}
+
+/*============================================================================*/
+/*  SubscribeTemplate                                                         */
+/*!
+    Request notifications for the variables referenced by a template
+
+    The SubscribeTemplate function requests a NOTIFY_MODIFIED
+    notification for every resolved variable referenced by the template
+    of a change-triggered channel, or of every channel in incremental
+    mode, other than the IP address and load generator variables.
+    This is done whenever the template's variable bindings change, so
+    the variables of a re-compiled template, and variables which were
+    created after the template was compiled, are picked up as well.
+    Each variable reference is only subscribed once.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        pChannel
+            pointer to the channel whose template is to be subscribed
+
+    @retval EOK the template variables are subscribed, or the channel
+                does not need notifications
+    @retval ENOENT no valid template is available
+    @retval other error from CTEMPLATE_Subscribe
+
+==============================================================================*/
+static int SubscribeTemplate( UDPTState *pState, UDPTChannel *pChannel )
+{
+    int result = EOK;
+    UDPTTemplate *pTemplate;
+    VAR_HANDLE exclude[3];
+
+    if ( ( pChannel->onChange != 0 ) ||
+         ( pState->incremental == true ) )
+    {
+        if ( pChannel->pTemplate == NULL )
+        {
+            /* get the compiled template for this channel */
+            pChannel->pTemplate = AcquireTemplate( pState,
+                                                   pChannel->templateFilename );
+        }
+
+        pTemplate = pChannel->pTemplate;
+        if ( ( pTemplate == NULL ) ||
+             ( pTemplate->compiled.valid == false ) )
+        {
+            result = ENOENT;
+        }
+        else if ( pTemplate->notifyGeneration !=
+                  pTemplate->compiled.bindings )
+        {
+            /* the IP address and load variables are spliced into the
+               payload, so their changes do not need to be notified */
+            exclude[0] = pState->hIPAddr;
+            exclude[1] = pState->hLoadSeed;
+            exclude[2] = pState->hLoadSeq;
+
+            result = CTEMPLATE_Subscribe( &pTemplate->compiled,
+                                          pState->hVarServer,
+                                          exclude,
+                                          sizeof( exclude ) /
+                                          sizeof( exclude[0] ) );
+            if ( result != EOK )
+            {
+                fprintf( stderr,
+                         "UDPT: Failed to set up notification for %s\n",
+                         pTemplate->filename );
+            }
+
+            pTemplate->notifyGeneration = pTemplate->compiled.bindings;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  HandlePrintRequest                                                        */
+/*!
+    Handle a varserver print request notification
+
+    The HandlePrintRequest function handles a print request notification
+    from the variable server.
+
+    @param[in]
+        pState
+            pointer to the UDPT State
+
+    @param[in]
+        id
+            print notification identifier
+
+    @retval EOK print request notification handled successfully
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int HandlePrintRequest( UDPTState *pState, int32_t id )
+{
+    int result = EINVAL;
+    VAR_HANDLE hVar;
+    int fd;
+
+    if ( pState != NULL )
+    {
+        /* open a print session */
+        if ( VAR_OpenPrintSession( pState->hVarServer,
+                                   id,
+                                   &hVar,
+                                   &fd ) == EOK )
+        {
+            result = ENOENT;
+
+            if ( hVar == pState->hMetrics )
+            {
+                (void)PrintUDPTInfo( hVar, pState, fd );
+            }
+
+            /* Close the print session */
+            result = VAR_ClosePrintSession( pState->hVarServer,
+                                            id,
+                                            fd );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  PrintUDPTInfo                                                             */
+/*!
+    Print UDP Templating Engine Information
+
+    The PrintUDPTInfo function prints out the operating statistics information
+    for the UDP Templating Engine in response to a varserver print
+    request.
+
+    @param[in]
+        hVar
+            the handle to the variable associated with the data to print
+
+    @param[in]
+        pState
+            pointer to the UDPTState object containing the info to print
+
+    @param[in]
+        fd
+            output file descriptor
+
+    @retval EOK print request notification handled successfully
+    @retval ENOENT print request is not for the specified manifest
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int PrintUDPTInfo( VAR_HANDLE hVar, UDPTState *pState, int fd )
+{
+    int result = EINVAL;
+
+    if ( pState != NULL )
+    {
+        result = DumpStats( pState, fd );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SendOutput                                                                */
+/*!
+    Send output to UDP broadcast targets
+
+    The SendOutput function sends the channel's UDP payload out to the
+    UDP broadcast targets.  The sockets used to send on each interface
+    are retrieved from the socket cache, which is shared by all of
+    the channels.  If the channel has unicast subscribers, the payload
+    is sent to them instead.
+    The template is rendered at most once per call unless per-interface
+    rendering is selected.  The datagrams for all of the interfaces
+    are collected into a transmit batch and sent together, or handed to
+    the sender thread if there is one.  Any pending
+    change-triggered transmission of the channel is cancelled, since
+    this transmission carries the changes.
+
+    For periodic transmissions on a channel with a heartbeat, payloads
+    which have not changed since they were last sent on an interface
+    are suppressed, except that one is sent every heartbeat ticks so
+    receivers can tell the sender is alive.  Triggered transmissions
+    are always sent.
+
+    If the channel has a compression algorithm selected, each payload
+    is compressed before it is queued.  Payloads which do not fit in a
+    single datagram are sent as a sequence of segments if segmentation
+    is enabled, otherwise they are counted as transmission errors.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        pChannel
+            pointer to the channel containing the output to send
+
+    @param[in]
+        periodic
+            true if this is a scheduled transmission, which may be
+            suppressed if the payload has not changed
+
+    @retval EOK output sent successfully
+    @retval ENOENT no interface was found to send on
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int SendOutput( UDPTState *pState,
+                       UDPTChannel *pChannel,
+                       bool periodic )
+{
+    int result = EINVAL;
+    char *pMsg;
+    char *pSlot;
+    size_t slotSize;
+    size_t len;
+    bool rendered = false;
+    IfEntry *pEntry;
+    UDPTIfStats *pIfStats;
+    struct sockaddr_storage addr;
+    socklen_t addrlen;
+    size_t i;
+    int fd;
+    int rc;
+    uint64_t start_ns;
+    PacingEntry *pPacing;
+    uint64_t launch_ns;
+
+    if ( ( pState != NULL ) &&
+         ( pChannel != NULL ) )
+    {
+        start_ns = SCHED_Now();
+
+        if ( pChannel->pTemplate == NULL )
+        {
+            /* get the compiled template for this channel */
+            pChannel->pTemplate = AcquireTemplate( pState,
+                                                   pChannel->templateFilename );
+        }
+        else
+        {
+            /* re-compile the template if the template file has changed */
+            (void)CTEMPLATE_Refresh( &pChannel->pTemplate->compiled,
+                                     pState->hVarServer,
+                                     pChannel->pTemplate->filename );
+        }
+
+        /* pick up the variables of a re-compiled template */
+        (void)SubscribeTemplate( pState, pChannel );
+
+        if ( pChannel->changePending == true )
+        {
+            /* this transmission carries the pending changes */
+            (void)SCHED_Remove( &pState->changeSchedule, pChannel );
+            pChannel->changePending = false;
+        }
+
+        pChannel->lastSend_ns = start_ns;
+
+        /* default result if no interface was found to send on */
+        result = ENOENT;
+
+        /* all the segments of this transmission share a message id */
+        pChannel->msgId++;
+
+        if ( pChannel->subscribers.n > 0 )
+        {
+            /* the channel is unicast to its subscribers */
+            result = SendSubscribers( pState, pChannel, periodic );
+        }
+        else
+        {
+            /* rebuild the allow-list bitmap if the interfaces changed */
+            (void)IFSET_Resolve( &pChannel->allowed, &pState->ifTable );
+        }
+
+        for ( i = 0;
+              ( i < pState->ifTable.n ) && ( pChannel->subscribers.n == 0 );
+              i++ )
+        {
+            pEntry = &pState->ifTable.entries[i];
+
+            /* skip interfaces which are down */
+            if ( pEntry->up == false )
+            {
+                continue;
+            }
+
+            /* check against the interface allow list */
+            if ( IFSET_Contains( &pChannel->allowed,
+                                 pEntry->ifindex ) == false )
+            {
+                /* not sending on this interface */
+                continue;
+            }
+
+            /* get the broadcast or multicast destination address */
+            rc = GetDestAddr( pState, pChannel, pEntry, &addr, &addrlen );
+            if ( rc == ENOENT )
+            {
+                /* the channel is not sent to this interface address */
+                continue;
+            }
+
+            pIfStats = GetIfStats( pChannel, pEntry->ifname, pEntry->family );
+
+            if ( rc == EOK )
+            {
+                /* get the socket bound to this interface */
+                rc = SOCKCACHE_Get( &pState->sockCache,
+                                    pEntry->ifname,
+                                    pEntry->family,
+                                    &fd );
+            }
+
+            if ( rc == EOK )
+            {
+                /* make space in the transmit batch */
+                pSlot = GetTxSlot( pState, pChannel, &slotSize );
+                if ( pSlot == NULL )
+                {
+                    rc = ENOBUFS;
+                }
+            }
+
+            if ( rc == EOK )
+            {
+                /* update the interface we are processing */
+                UpdateInterfaceIP( pState, pEntry );
+
+                /* render the template if required */
+                rc = RenderPayload( pState, pChannel, &rendered );
+            }
+
+            if ( rc == EOK )
+            {
+                /* get the payload for this interface */
+                rc = GetPayload( pState, pSlot, slotSize, &pMsg, &len );
+                if ( ( rc == E2BIG ) &&
+                     ( ( pState->segmented == true ) ||
+                       ( pChannel->compression != COMPRESS_NONE ) ) )
+                {
+                    /* the payload does not fit in one datagram, so build
+                       it in the payload buffer.  It may still be sent
+                       once compressed, or as segments */
+                    rc = GetPayload( pState,
+                                     pState->pPayload,
+                                     pState->maxPayload,
+                                     &pMsg,
+                                     &len );
+                }
+
+                if ( ( rc == EOK ) &&
+                     ( periodic == true ) &&
+                     ( SuppressPayload( pChannel, pIfStats, pMsg, len ) ) )
+                {
+                    /* nothing has changed since the last transmission */
+                    pChannel->suppressed++;
+                    pIfStats->suppressed++;
+                    result = EOK;
+                    continue;
+                }
+
+                if ( rc == EOK )
+                {
+                    rc = CompressPayload( pState, pChannel, &pMsg, &len );
+                }
+
+                if ( rc == EOK )
+                {
+                    rc = PacePayload( pState,
+                                      pEntry,
+                                      pIfStats,
+                                      slotSize,
+                                      len,
+                                      &pPacing,
+                                      &launch_ns );
+                    if ( rc == ENOBUFS )
+                    {
+                        /* the interface is over its pacing rate, so drop
+                           the payload and make sure the next is sent */
+                        if ( pIfStats != NULL )
+                        {
+                            pIfStats->pacedDrops++;
+                            pIfStats->hashValid = false;
+                        }
+                        result = EOK;
+                        continue;
+                    }
+                }
+
+                if ( rc == EOK )
+                {
+                    /* queue the UDP message(s) for transmission */
+                    rc = QueuePayload( pState,
+                                       pChannel,
+                                       pIfStats,
+                                       fd,
+                                       &addr,
+                                       addrlen,
+                                       pEntry->mtu,
+                                       slotSize,
+                                       pMsg,
+                                       len,
+                                       pPacing,
+                                       launch_ns );
+                }
+            }
+
+            if ( rc != EOK )
+            {
+                pChannel->errcount++;
+                if ( pIfStats != NULL )
+                {
+                    pIfStats->errcount++;
+                    pIfStats->lastError = rc;
+                    pIfStats->hashValid = false;
+                }
+            }
+
+            result = rc;
+        }
+
+        /* send all of the queued UDP messages */
+        if ( FlushBatch( pState ) == false )
+        {
+            result = EIO;
+        }
+
+        InvalidateStale( pState );
+
+        HISTOGRAM_Record( &pChannel->tickTime, SCHED_Now() - start_ns );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SendSubscribers                                                           */
+/*!
+    Send output to the unicast subscribers of a channel
+
+    The SendSubscribers function queues the channel's UDP payload for
+    every unicast subscriber which is not backing off after an error.
+    The local address used to reach each subscriber is used in place
+    of the interface IP address, and the template is rendered once for
+    all of the subscribers unless per-interface rendering is selected.
+    The datagrams for each address family share one unbound socket, so
+    the whole fan-out is sent with as few sendmmsg() calls as the
+    transmit batches allow.
+
+    For periodic transmissions on a channel with a heartbeat, the whole
+    fan-out is suppressed if the payload has not changed.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        pChannel
+            pointer to the channel containing the output to send
+
+    @param[in]
+        periodic
+            true if this is a scheduled transmission, which may be
+            suppressed if the payload has not changed
+
+    @retval EOK output queued successfully
+    @retval ENOENT every subscriber is backing off
+    @retval other error queueing the output for the last subscriber
+
+==============================================================================*/
+static int SendSubscribers( UDPTState *pState,
+                            UDPTChannel *pChannel,
+                            bool periodic )
+{
+    int result = ENOENT;
+    UDPTIfStats *pIfStats;
+    Subscriber *pSub;
+    struct sockaddr_storage addr;
+    uint64_t now_ns = SCHED_Now();
+    bool rendered = false;
+    bool first = true;
+    bool suppressed = false;
+    char *pSlot = NULL;
+    size_t slotSize = 0;
+    char *pMsg;
+    size_t len;
+    size_t i;
+    int fd;
+    int rc;
+
+    /* collect errors which arrived since the last fan-out, so they are
+       not reported against the datagrams about to be sent */
+    ProcessSubscriberErrors( pState, pState->subFd[0] );
+    ProcessSubscriberErrors( pState, pState->subFd[1] );
+
+    pIfStats = GetIfStats( pChannel, SUBSCRIBER_IFNAME, AF_UNSPEC );
+
+    for ( i = 0;
+          ( i < pChannel->subscribers.n ) && ( suppressed == false );
+          i++ )
+    {
+        pSub = &pChannel->subscribers.entries[i];
+
+        if ( SUBLIST_Ready( pSub, now_ns ) == false )
+        {
+            /* the subscriber is backing off after an error */
+            pSub->skipped++;
+            continue;
+        }
+
+        fd = GetSubscriberSocket( pState, pSub->addr.ss_family );
+        rc = ( fd != -1 ) ? EOK : EAFNOSUPPORT;
+
+        if ( rc == EOK )
+        {
+            /* make space in the transmit batch */
+            pSlot = GetTxSlot( pState, pChannel, &slotSize );
+            if ( pSlot == NULL )
+            {
+                rc = ENOBUFS;
+            }
+        }
+
+        if ( rc == EOK )
+        {
+            /* the source address used to reach the subscriber
+               stands in for the interface address */
+            (void)SetIPAddr( pState, pSub->source );
+
+            /* render the template if required */
+            rc = RenderPayload( pState, pChannel, &rendered );
+        }
+
+        if ( rc == EOK )
+        {
+            rc = GetPayload( pState, pSlot, slotSize, &pMsg, &len );
+            if ( ( rc == E2BIG ) &&
+                 ( ( pState->segmented == true ) ||
+                   ( pChannel->compression != COMPRESS_NONE ) ) )
+            {
+                rc = GetPayload( pState,
+                                 pState->pPayload,
+                                 pState->maxPayload,
+                                 &pMsg,
+                                 &len );
+            }
+
+            if ( ( rc == EOK ) &&
+                 ( first == true ) &&
+                 ( periodic == true ) &&
+                 ( SuppressPayload( pChannel, pIfStats, pMsg, len ) ) )
+            {
+                /* nothing has changed since the last transmission */
+                pChannel->suppressed++;
+                pIfStats->suppressed++;
+                suppressed = true;
+            }
+
+            first = false;
+
+            if ( ( rc == EOK ) && ( suppressed == false ) )
+            {
+                rc = CompressPayload( pState, pChannel, &pMsg, &len );
+            }
+
+            if ( ( rc == EOK ) && ( suppressed == false ) )
+            {
+                SUBLIST_GetAddr( pSub, pChannel->port, &addr );
+                rc = QueuePayload( pState,
+                                   pChannel,
+                                   pSub,
+                                   fd,
+                                   &addr,
+                                   pSub->addrlen,
+                                   0,
+                                   slotSize,
+                                   pMsg,
+                                   len,
+                                   NULL,
+                                   0 );
+            }
+        }
+
+        if ( rc != EOK )
+        {
+            pChannel->errcount++;
+            if ( pIfStats != NULL )
+            {
+                pIfStats->errcount++;
+                pIfStats->lastError = rc;
+                pIfStats->hashValid = false;
+            }
+        }
+
+        result = rc;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupSubscribers                                                          */
+/*!
+    Open the unicast subscriber sockets
+
+    The SetupSubscribers function opens one unbound UDP socket per
+    address family, which is shared by the subscribers of every
+    channel.  ICMP errors are queued on the socket error queues along
+    with the destination they refer to, so they can be attributed to
+    the right subscriber instead of failing the next send on the
+    socket.  A larger send buffer is requested since a datagram for
+    every subscriber is queued at once.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @retval EOK at least one subscriber socket was opened
+    @retval EINVAL invalid arguments
+    @retval other error from socket
+
+==============================================================================*/
+static int SetupSubscribers( UDPTState *pState )
+{
+    int result = EINVAL;
+    int families[2] = { AF_INET, AF_INET6 };
+    int size = SUBSCRIBER_SNDBUF;
+    int on = 1;
+    size_t i;
+    int fd;
+
+    if ( pState != NULL )
+    {
+        for ( i = 0; i < 2; i++ )
+        {
+            fd = socket( families[i], SOCK_DGRAM | SOCK_CLOEXEC, 0 );
+            if ( fd == -1 )
+            {
+                /* the address family may not be available */
+                result = errno;
+                continue;
+            }
+
+            if ( families[i] == AF_INET )
+            {
+                (void)setsockopt( fd, IPPROTO_IP, IP_RECVERR,
+                                  &on, sizeof( on ) );
+            }
+            else
+            {
+                (void)setsockopt( fd, IPPROTO_IPV6, IPV6_RECVERR,
+                                  &on, sizeof( on ) );
+                (void)setsockopt( fd, IPPROTO_IPV6, IPV6_V6ONLY,
+                                  &on, sizeof( on ) );
+            }
+
+            (void)setsockopt( fd, SOL_SOCKET, SO_SNDBUF,
+                              &size, sizeof( size ) );
+
+            pState->subFd[i] = fd;
+        }
+
+        if ( ( pState->subFd[0] != -1 ) ||
+             ( pState->subFd[1] != -1 ) )
+        {
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  GetSubscriberSocket                                                       */
+/*!
+    Get the subscriber socket for an address family
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        family
+            address family of the subscriber
+
+    @retval the subscriber socket
+    @retval -1 there is no socket for the address family
+
+==============================================================================*/
+static int GetSubscriberSocket( UDPTState *pState, int family )
+{
+    return ( family == AF_INET ) ? pState->subFd[0]
+           : ( family == AF_INET6 ) ? pState->subFd[1]
+           : -1;
+}
+
+/*============================================================================*/
+/*  IsSubscriberSocket                                                        */
+/*!
+    Check if a socket is one of the subscriber sockets
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        fd
+            socket to check
+
+    @retval true the socket is a subscriber socket
+    @retval false the socket is not a subscriber socket
+
+==============================================================================*/
+static bool IsSubscriberSocket( UDPTState *pState, int fd )
+{
+    return ( fd != -1 ) &&
+           ( ( fd == pState->subFd[0] ) || ( fd == pState->subFd[1] ) );
+}
+
+/*============================================================================*/
+/*  SubscriberError                                                           */
+/*!
+    Record a send error for a subscriber
+
+    The SubscriberError function records an error returned when sending
+    to a subscriber.  Routing errors start the subscriber's backoff.
+    Local congestion errors are counted without backing off, and
+    ECONNREFUSED is not counted, since a send only returns it for an
+    earlier datagram whose error is reported with its own destination
+    on the error queue.
+
+    @param[in]
+        pSub
+            pointer to the subscriber
+
+    @param[in]
+        err
+            send error
+
+==============================================================================*/
+static void SubscriberError( Subscriber *pSub, int err )
+{
+    switch( err )
+    {
+        case ECONNREFUSED:
+            break;
+
+        case EAGAIN:
+        case ENOBUFS:
+        case ENOMEM:
+            pSub->errcount++;
+            pSub->lastError = err;
+            break;
+
+        default:
+            SUBLIST_Failure( pSub, err, SCHED_Now() );
+            break;
+    }
+}
+
+/*============================================================================*/
+/*  ProcessSubscriberErrors                                                   */
+/*!
+    Process the errors queued on a subscriber socket
+
+    The ProcessSubscriberErrors function drains the error queue of a
+    subscriber socket.  Each queued error, for example an ICMP port or
+    host unreachable error, carries the destination of the datagram it
+    refers to, and starts the backoff of the subscriber with that
+    destination.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        fd
+            subscriber socket
+
+==============================================================================*/
+static void ProcessSubscriberErrors( UDPTState *pState, int fd )
+{
+    struct sockaddr_storage addr;
+    struct sock_extended_err ee;
+    struct cmsghdr *pCmsg;
+    struct msghdr msg;
+    struct iovec iov;
+    char data[64];
+    char control[256];
+    uint64_t now_ns = SCHED_Now();
+    Subscriber *pSub;
+    UDPTChannel *pChannel;
+    size_t i;
+    int err;
+
+    while ( fd != -1 )
+    {
+        memset( &msg, 0, sizeof( msg ) );
+        iov.iov_base = data;
+        iov.iov_len = sizeof( data );
+        msg.msg_name = &addr;
+        msg.msg_namelen = sizeof( addr );
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof( control );
+
+        if ( recvmsg( fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT ) == -1 )
+        {
+            break;
+        }
+
+        err = 0;
+        for ( pCmsg = CMSG_FIRSTHDR( &msg );
+              pCmsg != NULL;
+              pCmsg = CMSG_NXTHDR( &msg, pCmsg ) )
+        {
+            if ( ( ( pCmsg->cmsg_level == IPPROTO_IP ) &&
+                   ( pCmsg->cmsg_type == IP_RECVERR ) ) ||
+                 ( ( pCmsg->cmsg_level == IPPROTO_IPV6 ) &&
+                   ( pCmsg->cmsg_type == IPV6_RECVERR ) ) )
+            {
+                memcpy( &ee, CMSG_DATA( pCmsg ), sizeof( ee ) );
+                err = (int)ee.ee_errno;
+            }
+        }
+
+        for ( i = 0; ( err != 0 ) && ( i < pState->nChannels ); i++ )
+        {
+            pChannel = &pState->channels[i];
+            pSub = SUBLIST_Find( &pChannel->subscribers,
+                                 (struct sockaddr *)&addr,
+                                 pChannel->port );
+            SUBLIST_Failure( pSub, err, now_ns );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  ProcessTxStamps                                                           */
+/*!
+    Process the transmit timestamps of the interface sockets
+
+    The ProcessTxStamps function drains the error queue of every
+    timestamped interface socket, and records the latency of each
+    datagram to the qdisc, the device driver and the wire in the
+    histograms of the interface it was sent on.  It is called after
+    every pass of the event loop, so the timestamps of a pass are
+    collected by the next one.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+==============================================================================*/
+static void ProcessTxStamps( UDPTState *pState )
+{
+    TxStamp *pTxStamp = &pState->txStamp;
+    TxStampSample sample;
+    UDPTIfStats *pIfStats;
+    size_t i;
+
+    for ( i = 0; i < pTxStamp->n; i++ )
+    {
+        while ( TXSTAMP_Read( pTxStamp,
+                              pTxStamp->sockets[i].fd,
+                              &sample ) == EOK )
+        {
+            pIfStats = (UDPTIfStats *)sample.pCtx;
+            if ( pIfStats == NULL )
+            {
+                continue;
+            }
+
+            switch ( sample.type )
+            {
+                case TXSTAMP_TYPE_SCHED:
+                    HISTOGRAM_Record( &pIfStats->txSched, sample.latency_ns );
+                    break;
+
+                case TXSTAMP_TYPE_DRIVER:
+                    HISTOGRAM_Record( &pIfStats->txDriver, sample.latency_ns );
+                    break;
+
+                case TXSTAMP_TYPE_WIRE:
+                    HISTOGRAM_Record( &pIfStats->txWire, sample.latency_ns );
+                    break;
+
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  SuppressPayload                                                           */
+/*!
+    Check if an unchanged payload may be suppressed
+
+    The SuppressPayload function compares the hash of the payload with
+    the hash of the payload last transmitted on the interface.  If the
+    channel has a heartbeat and the payload is unchanged, it may be
+    suppressed, unless it has already been suppressed for heartbeat - 1
+    consecutive ticks.  The hash of a payload which is not suppressed is
+    stored so the next payload can be compared with it.
+
+    @param[in]
+        pChannel
+            pointer to the channel being sent
+
+    @param[in]
+        pIfStats
+            pointer to the statistics of the interface being sent on
+
+    @param[in]
+        pMsg
+            pointer to the uncompressed payload
+
+    @param[in]
+        len
+            length of the payload
+
+    @retval true the payload is unchanged and need not be sent
+    @retval false the payload must be sent
+
+==============================================================================*/
+static bool SuppressPayload( UDPTChannel *pChannel,
+                             UDPTIfStats *pIfStats,
+                             char *pMsg,
+                             size_t len )
+{
+    bool suppress = false;
+    uint64_t hash;
+
+    if ( ( pChannel->heartbeat > 0 ) &&
+         ( pIfStats != NULL ) )
+    {
+        hash = HASH_Compute( pMsg, len );
+
+        if ( ( pIfStats->hashValid == true ) &&
+             ( pIfStats->hash == hash ) &&
+             ( pIfStats->unchanged + 1 < pChannel->heartbeat ) )
+        {
+            pIfStats->unchanged++;
+            suppress = true;
+        }
+        else
+        {
+            pIfStats->hash = hash;
+            pIfStats->hashValid = true;
+            pIfStats->unchanged = 0;
+        }
+    }
+
+    return suppress;
+}
+
+/*============================================================================*/
+/*  CompressPayload                                                           */
+/*!
+    Compress a UDP payload
+
+    The CompressPayload function compresses the payload using the
+    channel's compression algorithm, and the static text of the
+    channel's template as the dictionary unless dictionaries are
+    disabled.  The compressed payload is built in the compressed
+    payload buffer behind a compressed payload header.
+
+    If compression is not selected or not available, or the payload
+    does not get smaller, the payload is left as it is.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        pChannel
+            pointer to the channel being sent
+
+    @param[in,out]
+        ppMsg
+            pointer to the payload pointer, which is updated to point to
+            the compressed payload
+
+    @param[in,out]
+        pLen
+            pointer to the payload length, which is updated with the
+            length of the compressed payload
+
+    @retval EOK the payload is ready to send
+
+==============================================================================*/
+static int CompressPayload( UDPTState *pState,
+                            UDPTChannel *pChannel,
+                            char **ppMsg,
+                            size_t *pLen )
+{
+    int result = EOK;
+    Compressor *pCompressor;
+    size_t hdrLen = UDPTMSG_COMPRESSED_HEADER_SIZE;
+    size_t len;
+
+    if ( ( pChannel->compression != COMPRESS_NONE ) &&
+         ( COMPRESS_IsSupported( pChannel->compression ) == true ) &&
+         ( pChannel->pTemplate != NULL ) &&
+         ( *pLen <= UINT32_MAX ) )
+    {
+        pCompressor = &pChannel->pTemplate->compressor;
+
+        /* keep the dictionary in step with the template */
+        (void)UpdateDictionary( pState, pChannel->pTemplate );
+
+        result = COMPRESS_Compress( pCompressor,
+                                    pChannel->compression,
+                                    *ppMsg,
+                                    *pLen,
+                                    &pState->pCompressed[hdrLen],
+                                    pState->compressedSize - hdrLen,
+                                    &len );
+        if ( ( result == EOK ) &&
+             ( hdrLen + len >= *pLen ) )
+        {
+            /* the payload did not get smaller */
+            result = E2BIG;
+        }
+
+        if ( result == EOK )
+        {
+            (void)UDPTMSG_WriteCompressedHeader( pState->pCompressed,
+                                                 (uint8_t)pChannel->compression,
+                                                 pCompressor->dictId,
+                                                 (uint32_t)*pLen );
+
+            pChannel->compressed++;
+            pChannel->compressIn += *pLen;
+            pChannel->compressOut += hdrLen + len;
+
+            *ppMsg = pState->pCompressed;
+            *pLen = hdrLen + len;
+        }
+        else
+        {
+            /* send the payload as it is */
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  UpdateDictionary                                                          */
+/*!
+    Update the compression dictionary of a template
+
+    The UpdateDictionary function rebuilds the compression dictionary of
+    a shared template from its static text if the template has been
+    re-compiled since the dictionary was built.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        pTemplate
+            pointer to the shared template
+
+    @retval EOK the dictionary is up to date
+    @retval ENOMEM memory allocation failed
+
+==============================================================================*/
+static int UpdateDictionary( UDPTState *pState, UDPTTemplate *pTemplate )
+{
+    int result = EOK;
+    CompiledTemplate *pCompiled = &pTemplate->compiled;
+    char *pText;
+    size_t len;
+
+    if ( ( pCompiled->valid == true ) &&
+         ( pCompiled->generation != pTemplate->dictGeneration ) )
+    {
+        pTemplate->dictGeneration = pCompiled->generation;
+
+        if ( pState->noDictionary == true )
+        {
+            result = COMPRESS_SetDictionary( &pTemplate->compressor, NULL, 0 );
+        }
+        else
+        {
+            result = ENOMEM;
+
+            /* the static text is never longer than the template */
+            pText = malloc( pCompiled->textLen + 1 );
+            if ( pText != NULL )
+            {
+                len = CTEMPLATE_GetStaticText( pCompiled,
+                                               pText,
+                                               pCompiled->textLen );
+                result = COMPRESS_SetDictionary( &pTemplate->compressor,
+                                                 pText,
+                                                 len );
+                free( pText );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  QueuePayload                                                              */
+/*!
+    Queue a UDP payload for transmission
+
+    The QueuePayload function queues the payload for one interface in
+    the transmit batch.  A payload which fits in one datagram is queued
+    from the interface's transmit slot, copying it there if it was built
+    in one of the shared payload buffers.  The shared rendered output is
+    only queued in place when the batch is sent with sendmmsg() before
+    the next render.  A batch handed to the sender thread is sent after
+    the template may have been rendered again, and io_uring only sends
+    the transmit slots with zero copy, so the payload is always copied
+    into the slot for them.  A larger payload is queued as segments if
+    segmentation is enabled.  A paced payload is queued with its
+    SO_TXTIME launch time.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        pChannel
+            pointer to the channel being sent
+
+    @param[in]
+        pCtx
+            context stored with the messages: the interface statistics,
+            or the subscriber of unicast messages
+
+    @param[in]
+        fd
+            socket to send the payload on
+
+    @param[in]
+        pAddr
+            pointer to the destination address
+
+    @param[in]
+        addrlen
+            length of the destination address
+
+    @param[in]
+        mtu
+            MTU of the interface, or 0 if it is not known
+
+    @param[in]
+        slotSize
+            size of the interface's transmit slot
+
+    @param[in]
+        pMsg
+            pointer to the payload
+
+    @param[in]
+        len
+            length of the payload
+
+    @param[in]
+        pPacing
+            pointer to the pacing entry of the interface, or NULL
+
+    @param[in]
+        launch_ns
+            SO_TXTIME launch time of the payload, or 0 to send it now
+
+    @retval EOK the payload was queued
+    @retval E2BIG the payload does not fit in a datagram
+    @retval other error from TXBATCH_Add, AddLaunchTime or QueueSegments
+
+==============================================================================*/
+static int QueuePayload( UDPTState *pState,
+                         UDPTChannel *pChannel,
+                         void *pCtx,
+                         int fd,
+                         struct sockaddr_storage *pAddr,
+                         socklen_t addrlen,
+                         unsigned int mtu,
+                         size_t slotSize,
+                         char *pMsg,
+                         size_t len,
+                         const PacingEntry *pPacing,
+                         uint64_t launch_ns )
+{
+    int result = E2BIG;
+
+    if ( len <= slotSize )
+    {
+        if ( ( pMsg == pState->pPayload ) ||
+             ( pMsg == pState->pCompressed ) ||
+             ( pState->threaded == true ) ||
+             ( pState->txUring.pRing != NULL ) )
+        {
+            /* the shared buffers are re-used for the next interface,
+               and the rendered output by the next render */
+            result = TXBATCH_AddCopy( pState->pBatch->pTxBatch,
+                                      fd,
+                                      (struct sockaddr *)pAddr,
+                                      addrlen,
+                                      pMsg,
+                                      len,
+                                      pCtx );
+        }
+        else
+        {
+            result = TXBATCH_Add( pState->pBatch->pTxBatch,
+                                  fd,
+                                  (struct sockaddr *)pAddr,
+                                  addrlen,
+                                  pMsg,
+                                  len,
+                                  pCtx );
+        }
+
+        if ( result == EOK )
+        {
+            result = AddLaunchTime( pState->pBatch->pTxBatch, launch_ns );
+        }
+    }
+    else if ( pState->segmented == true )
+    {
+        result = QueueSegments( pState,
+                                pChannel,
+                                pCtx,
+                                fd,
+                                pAddr,
+                                addrlen,
+                                mtu,
+                                pMsg,
+                                len,
+                                pPacing,
+                                launch_ns );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  QueueSegments                                                             */
+/*!
+    Queue a payload which does not fit in one datagram
+
+    The QueueSegments function splits a payload into segments which each
+    fit in one datagram, and queues them for transmission.  Each segment
+    starts with a segment header carrying the channel's message id, the
+    segment index, and the segment count, so the payload can be
+    re-assembled by the receivers.  The segments are sized for the MTU
+    of the interface and the headers of the address family, so they are
+    not fragmented.
+
+    If the kernel supports UDP GSO, the segments are built back to back
+    in GSO buffers and queued as messages with a UDP_SEGMENT size, so
+    the kernel sends each of these segment trains with one send.  A
+    train is never longer than the largest UDP payload.  Otherwise each
+    segment is queued in its own transmit slot.
+
+    A paced payload's segments, or segment trains, are given launch
+    times spaced at the interface's pacing rate, starting from the
+    payload's launch time.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        pChannel
+            pointer to the channel being sent
+
+    @param[in]
+        pCtx
+            context stored with the messages: the interface statistics,
+            or the subscriber of unicast messages
+
+    @param[in]
+        fd
+            socket to send the segments on
+
+    @param[in]
+        pAddr
+            pointer to the destination address
+
+    @param[in]
+        addrlen
+            length of the destination address
+
+    @param[in]
+        mtu
+            MTU of the interface, or 0 if it is not known
+
+    @param[in]
+        pMsg
+            pointer to the payload
+
+    @param[in]
+        len
+            length of the payload
+
+    @param[in]
+        pPacing
+            pointer to the pacing entry of the interface, or NULL
+
+    @param[in]
+        launch_ns
+            SO_TXTIME launch time of the first segment, or 0 to send
+            the segments now
+
+    @retval EOK the segments were queued
+    @retval E2BIG the payload needs too many segments
+    @retval ENOBUFS no transmit batch is available
+    @retval other error from TXBATCH_Add or TXBATCH_AddControl
+
+==============================================================================*/
+static int QueueSegments( UDPTState *pState,
+                          UDPTChannel *pChannel,
+                          void *pCtx,
+                          int fd,
+                          struct sockaddr_storage *pAddr,
+                          socklen_t addrlen,
+                          unsigned int mtu,
+                          char *pMsg,
+                          size_t len,
+                          const PacingEntry *pPacing,
+                          uint64_t launch_ns )
+{
+    int result = EOK;
+    size_t segSize = GetSegmentSize( pAddr->ss_family, mtu );
+    size_t segData = segSize - UDPTMSG_SEGMENT_HEADER_SIZE;
+    size_t count = ( len + segData - 1 ) / segData;
+    size_t trainMax = UDP_MAX_PAYLOAD / segSize;
+    uint16_t gsoSize = (uint16_t)segSize;
+    size_t offset = 0;
+    size_t total = 0;
+    size_t slotSize;
+    size_t first;
+    size_t last;
+    size_t n;
+    size_t i;
+    char *pBuf;
+    UDPTBatch *pBatch;
+
+    if ( count > UDPTMSG_MAX_SEGMENTS )
+    {
+        result = E2BIG;
+    }
+    else
+    {
+        pChannel->segmented++;
+    }
+
+    if ( trainMax > TXBATCH_GSO_MAX_SEGMENTS )
+    {
+        trainMax = TXBATCH_GSO_MAX_SEGMENTS;
+    }
+
+    if ( pState->gso == true )
+    {
+        for ( first = 0; ( first < count ) && ( result == EOK ); first = last )
+        {
+            last = ( count - first < trainMax ) ? count : first + trainMax;
+
+            if ( ( pState->pBatch != NULL ) &&
+                 ( ( pState->pBatch->nGsoUsed == MAX_GSO_BUFFERS ) ||
+                   ( pState->pBatch->pTxBatch->n == TXBATCH_MAX_MSGS ) ) )
+            {
+                /* all of the GSO buffers or messages are queued */
+                FlushBatch( pState );
+            }
+
+            pBatch = GetBatch( pState, pChannel );
+            if ( pBatch == NULL )
+            {
+                result = ENOBUFS;
+            }
+            else
+            {
+                /* build the segments of the train back to back */
+                pBuf = pBatch->pGsoBuf[pBatch->nGsoUsed++];
+                total = 0;
+                for ( i = first; i < last; i++ )
+                {
+                    n = ( len - offset < segData ) ? len - offset : segData;
+                    total += UDPTMSG_WriteSegmentHeader( &pBuf[total],
+                                                         pChannel->msgId,
+                                                         (uint16_t)i,
+                                                         (uint16_t)count );
+                    memcpy( &pBuf[total], &pMsg[offset], n );
+                    total += n;
+                    offset += n;
+                }
+
+                result = TXBATCH_Add( pBatch->pTxBatch,
+                                      fd,
+                                      (struct sockaddr *)pAddr,
+                                      addrlen,
+                                      pBuf,
+                                      total,
+                                      pCtx );
+            }
+            if ( ( result == EOK ) &&
+                 ( last - first > 1 ) )
+            {
+                /* let the kernel split the buffer into datagrams */
+                result = TXBATCH_AddControl( pBatch->pTxBatch,
+                                             SOL_UDP,
+                                             UDP_SEGMENT,
+                                             &gsoSize,
+                                             sizeof( gsoSize ) );
+            }
+
+            if ( ( result == EOK ) &&
+                 ( launch_ns != 0 ) )
+            {
+                /* spread the trains out at the pacing rate */
+                result = AddLaunchTime(
+                            pBatch->pTxBatch,
+                            launch_ns +
+                            PACING_Duration( pPacing, first * segSize ) );
+            }
+        }
+    }
+    else
+    {
+        for ( i = 0; ( i < count ) && ( result == EOK ); i++ )
+        {
+            pBuf = GetTxSlot( pState, pChannel, &slotSize );
+            if ( pBuf == NULL )
+            {
+                result = ENOBUFS;
+            }
+            else
+            {
+                n = ( len - offset < segData ) ? len - offset : segData;
+                total = UDPTMSG_WriteSegmentHeader( pBuf,
+                                                    pChannel->msgId,
+                                                    (uint16_t)i,
+                                                    (uint16_t)count );
+                memcpy( &pBuf[total], &pMsg[offset], n );
+                offset += n;
+
+                result = TXBATCH_Add( pState->pBatch->pTxBatch,
+                                      fd,
+                                      (struct sockaddr *)pAddr,
+                                      addrlen,
+                                      pBuf,
+                                      total + n,
+                                      pCtx );
+            }
+            if ( ( result == EOK ) &&
+                 ( launch_ns != 0 ) )
+            {
+                /* spread the segments out at the pacing rate */
+                result = AddLaunchTime(
+                            pState->pBatch->pTxBatch,
+                            launch_ns +
+                            PACING_Duration( pPacing, i * segSize ) );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  GetSegmentSize                                                            */
+/*!
+    Get the size of the datagrams a payload is segmented into
+
+    The GetSegmentSize function gets the largest datagram, including its
+    segment header, which can be sent without fragmentation on a link
+    with the specified MTU.  It is never larger than a transmit slot.
+
+    @param[in]
+        family
+            address family of the destination (AF_INET or AF_INET6)
+
+    @param[in]
+        mtu
+            MTU of the link, or 0 if it is not known
+
+    @return the size of a segment datagram
+
+==============================================================================*/
+static size_t GetSegmentSize( int family, unsigned int mtu )
+{
+    size_t overhead = ( family == AF_INET6 ) ? UDP_IPV6_OVERHEAD
+                                             : UDP_IPV4_OVERHEAD;
+    size_t size;
+
+    if ( mtu <= overhead + UDPTMSG_SEGMENT_HEADER_SIZE )
+    {
+        /* the MTU is not known */
+        mtu = DEFAULT_MTU;
+    }
+
+    size = mtu - overhead;
+
+    return ( size < TXBATCH_SLOT_SIZE ) ? size : TXBATCH_SLOT_SIZE;
+}
+
+/*============================================================================*/
+/*  PacePayload                                                               */
+/*!
+    Apply the pacing of an interface to a payload
+
+    The PacePayload function admits a payload for transmission on a
+    paced interface.  The payload is accounted for by its length on the
+    wire, including the segment headers and the IP and UDP headers of
+    each of its datagrams.  Payloads for interfaces which are not paced
+    are always admitted.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        pEntry
+            pointer to the interface the payload is sent on
+
+    @param[in]
+        pIfStats
+            pointer to the interface statistics, or NULL
+
+    @param[in]
+        slotSize
+            size of a transmit slot, above which the payload is segmented
+
+    @param[in]
+        len
+            length of the payload
+
+    @param[out]
+        ppPacing
+            pointer to a location to store the pacing entry of the
+            interface, or NULL if it is not paced
+
+    @param[out]
+        pLaunch_ns
+            pointer to a location to store the SO_TXTIME launch time of
+            the payload, or 0 if it is sent now
+
+    @retval EOK the payload may be sent
+    @retval ENOBUFS the payload exceeds the pacing rate of the interface
+
+==============================================================================*/
+static int PacePayload( UDPTState *pState,
+                        IfEntry *pEntry,
+                        UDPTIfStats *pIfStats,
+                        size_t slotSize,
+                        size_t len,
+                        PacingEntry **ppPacing,
+                        uint64_t *pLaunch_ns )
+{
+    int result = EOK;
+    size_t segData = GetSegmentSize( pEntry->family, pEntry->mtu ) -
+                     UDPTMSG_SEGMENT_HEADER_SIZE;
+    size_t count = 1;
+    size_t wire = len;
+    uint64_t now_ns;
+    PacingEntry *pPacing;
+
+    pPacing = PACING_Find( &pState->pacing, pEntry->ifname );
+    *ppPacing = pPacing;
+    *pLaunch_ns = 0;
+
+    if ( pPacing != NULL )
+    {
+        if ( len > slotSize )
+        {
+            count = ( len + segData - 1 ) / segData;
+            wire += count * UDPTMSG_SEGMENT_HEADER_SIZE;
+        }
+
+        wire += count * ( ( pEntry->family == AF_INET6 ) ? UDP_IPV6_OVERHEAD
+                                                         : UDP_IPV4_OVERHEAD );
+
+        now_ns = SCHED_Now();
+        result = PACING_Admit( pPacing, wire, now_ns, pLaunch_ns );
+        if ( ( result == EOK ) &&
+             ( *pLaunch_ns > now_ns ) &&
+             ( pIfStats != NULL ) )
+        {
+            pIfStats->deferred++;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  AddLaunchTime                                                             */
+/*!
+    Set the launch time of the last queued datagram
+
+    The AddLaunchTime function adds an SO_TXTIME launch time to the
+    datagram most recently added to a transmit batch, so the kernel
+    holds it back until then.
+
+    @param[in]
+        pTxBatch
+            pointer to the transmit batch
+
+    @param[in]
+        launch_ns
+            monotonic launch time in nanoseconds, or 0 to send the
+            datagram now
+
+    @retval EOK the launch time was set, or none was required
+    @retval ENOTSUP SO_TXTIME is not supported
+    @retval other error from TXBATCH_AddControl
+
+==============================================================================*/
+static int AddLaunchTime( TxBatch *pTxBatch, uint64_t launch_ns )
+{
+    int result = EOK;
+
+    if ( launch_ns != 0 )
+    {
+#ifdef SCM_TXTIME
+        result = TXBATCH_AddControl( pTxBatch,
+                                     SOL_SOCKET,
+                                     SCM_TXTIME,
+                                     &launch_ns,
+                                     sizeof( launch_ns ) );
+#else
+        (void)pTxBatch;
+        result = ENOTSUP;
+#endif
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  GetBatch                                                                  */
+/*!
+    Get the transmit batch to add UDP messages to
+
+    The GetBatch function gets the transmit batch which is currently
+    being built.  If there is none, the single direct batch is used, or
+    a free batch is taken from the transmit ring.  If every batch in the
+    ring is queued, the batches already sent by the sender thread are
+    reaped to free one.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        pChannel
+            pointer to the channel the messages are sent for
+
+    @retval pointer to the transmit batch
+    @retval NULL every transmit batch is waiting for the sender thread
+
+==============================================================================*/
+static UDPTBatch *GetBatch( UDPTState *pState, UDPTChannel *pChannel )
+{
+    TxRingSlot *pSlot;
+
+    if ( pState->pBatch == NULL )
+    {
+        if ( pState->threaded == true )
+        {
+            pSlot = TXRING_Acquire( &pState->txRing );
+            if ( pSlot == NULL )
+            {
+                ReapBatches( pState );
+                pSlot = TXRING_Acquire( &pState->txRing );
+            }
+
+            if ( pSlot != NULL )
+            {
+                pState->pBatch = (UDPTBatch *)pSlot->pCtx;
+            }
+            else
+            {
+                pChannel->queueFull++;
+            }
+        }
+        else
+        {
+            pState->pBatch = &pState->batches[0];
+        }
+    }
+
+    if ( ( pState->pBatch != NULL ) &&
+         ( pState->pBatch->pTxBatch->n == 0 ) )
+    {
+        pState->pBatch->pChannel = pChannel;
+    }
+
+    return pState->pBatch;
+}
+
+/*============================================================================*/
+/*  GetTxSlot                                                                 */
+/*!
+    Get the buffer for the next UDP message
+
+    The GetTxSlot function gets the preallocated buffer of the next
+    message in the current transmit batch.  If the batch is full, it
+    is sent and a new batch is started.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        pChannel
+            pointer to the channel the message is sent for
+
+    @param[out]
+        pSize
+            pointer to a location to store the size of the buffer
+
+    @retval pointer to the message buffer
+    @retval NULL no transmit batch is available
+
+==============================================================================*/
+static char *GetTxSlot( UDPTState *pState,
+                        UDPTChannel *pChannel,
+                        size_t *pSize )
+{
+    UDPTBatch *pBatch;
+    char *pSlot = NULL;
+
+    pBatch = GetBatch( pState, pChannel );
+    if ( pBatch != NULL )
+    {
+        pSlot = TXBATCH_GetSlot( pBatch->pTxBatch, pSize );
+        if ( pSlot == NULL )
+        {
+            FlushBatch( pState );
+
+            pBatch = GetBatch( pState, pChannel );
+            if ( pBatch != NULL )
+            {
+                pSlot = TXBATCH_GetSlot( pBatch->pTxBatch, pSize );
+            }
+        }
+    }
+
+    return pSlot;
+}
+
+/*============================================================================*/
+/*  FlushBatch                                                                */
+/*!
+    Send the queued UDP messages
+
+    The FlushBatch function sends all of the UDP messages in the current
+    transmit batch.  If there is a sender thread, the batch is handed to
+    it, and its results are processed once it has been sent.  Otherwise
+    the batch is sent immediately and its results are processed by
+    CompleteBatch.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object containing the transmit batch
+
+    @retval true all of the queued UDP messages were sent or handed to
+                 the sender thread
+    @retval false one or more UDP messages could not be sent
+
+==============================================================================*/
+static bool FlushBatch( UDPTState *pState )
+{
+    UDPTBatch *pBatch = pState->pBatch;
+    bool ok = true;
+    uint64_t start_ns;
+
+    if ( ( pBatch != NULL ) &&
+         ( pBatch->pTxBatch->n > 0 ) )
+    {
+        if ( pState->threaded == true )
+        {
+            TXRING_Publish( &pState->txRing );
+        }
+        else
+        {
+            start_ns = SCHED_Now();
+            (void)SendBatch( pState, pBatch->pTxBatch );
+            HISTOGRAM_Record( &pBatch->pChannel->sendTime,
+                              SCHED_Now() - start_ns );
+
+            ok = CompleteBatch( pState, pBatch );
+        }
+    }
+
+    /* the next message starts a new batch.  An empty batch taken from
+       the transmit ring is simply acquired again */
+    pState->pBatch = NULL;
+
+    return ok;
+}
+
+/*============================================================================*/
+/*  SendBatch                                                                 */
+/*!
+    Send a transmit batch
+
+    The SendBatch function sends all of the UDP messages of a transmit
+    batch, using io_uring if it is available, or sendmmsg() otherwise.
+    It is called from the event loop, or from the sender thread.
+
+    @param[in]
+        pCtx
+            pointer to the UDPTState object
+
+    @param[in]
+        pBatch
+            pointer to the transmit batch
+
+    @retval EOK all of the UDP messages were sent
+    @retval EIO one or more UDP messages could not be sent
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int SendBatch( void *pCtx, TxBatch *pBatch )
+{
+    UDPTState *pState = (UDPTState *)pCtx;
+
+    pBatch->sent_ns = SCHED_Now();
+
+    return ( pState->txUring.pRing != NULL )
+           ? TXURING_Send( &pState->txUring, pBatch )
+           : TXBATCH_Send( pBatch );
+}
+
+/*============================================================================*/
+/*  CompleteBatch                                                             */
+/*!
+    Process the results of a sent transmit batch
+
+    The CompleteBatch function maps the result of each message in a sent
+    transmit batch back into the channel and per-interface transmission
+    counters, or the counters of the subscriber of unicast messages.
+    Sockets which report a stale interface error are queued to be
+    removed from the socket cache.  Messages sent on timestamped
+    sockets are recorded so their transmit timestamps can be matched
+    with their interface.  If a UDP GSO message is rejected by the
+    kernel or the device, including for being too large, UDP GSO is
+    disabled and
+    subsequent segmented payloads are sent one datagram at a time.
+    The batch is then emptied so it can be re-used.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        pBatch
+            pointer to the sent transmit batch
+
+    @retval true all of the UDP messages in the batch were sent
+    @retval false one or more UDP messages could not be sent
+
+==============================================================================*/
+static bool CompleteBatch( UDPTState *pState, UDPTBatch *pBatch )
+{
+    TxBatch *pTxBatch = pBatch->pTxBatch;
+    UDPTChannel *pChannel = pBatch->pChannel;
+    UDPTIfStats *pIfStats;
+    Subscriber *pSub = NULL;
+    uint64_t sent_ns;
+    bool ok = true;
+    size_t i;
+
+    /* transmit timestamps are taken from the system clock */
+    sent_ns = pTxBatch->sent_ns + SCHED_RealtimeOffset();
+
+    for ( i = 0; i < pTxBatch->n; i++ )
+    {
+        if ( IsSubscriberSocket( pState, pTxBatch->fd[i] ) )
+        {
+            /* unicast messages carry their subscriber */
+            pSub = (Subscriber *)pTxBatch->pCtx[i];
+            pIfStats = GetIfStats( pChannel, SUBSCRIBER_IFNAME, AF_UNSPEC );
+        }
+        else
+        {
+            pSub = NULL;
+            pIfStats = (UDPTIfStats *)pTxBatch->pCtx[i];
+
+            TXSTAMP_Sent( &pState->txStamp,
+                          pTxBatch->fd[i],
+                          pTxBatch->result[i],
+                          sent_ns,
+                          pIfStats );
+        }
+
+        if ( pTxBatch->result[i] == EOK )
+        {
+            pChannel->txcount++;
+            if ( pIfStats != NULL )
+            {
+                pIfStats->txcount++;
+                pIfStats->bytes += pTxBatch->iov[i].iov_len;
+            }
+
+            if ( pSub != NULL )
+            {
+                pSub->txcount++;
+            }
+        }
+        else
+        {
+            ok = false;
+            pChannel->errcount++;
+            if ( pIfStats != NULL )
+            {
+                pIfStats->errcount++;
+                pIfStats->lastError = pTxBatch->result[i];
+
+                /* make sure the next payload is sent */
+                pIfStats->hashValid = false;
+            }
+
+            if ( pSub != NULL )
+            {
+                SubscriberError( pSub, pTxBatch->result[i] );
+            }
+            else if ( ( SOCKCACHE_IsStale( pTxBatch->result[i] ) ) &&
+                      ( pState->nStale < MAX_STALE_FDS ) )
+            {
+                /* re-create the socket on next use */
+                pState->staleFds[pState->nStale++] = pTxBatch->fd[i];
+            }
+
+            if ( ( ( pTxBatch->result[i] == EIO ) ||
+                   ( pTxBatch->result[i] == EINVAL ) ||
+                   ( pTxBatch->result[i] == EMSGSIZE ) ) &&
+                 ( pState->gso == true ) &&
+                 ( TXBATCH_HasControl( pTxBatch,
+                                       i,
+                                       SOL_UDP,
+                                       UDP_SEGMENT ) == true ) )
+            {
+                fprintf( stderr, "UDP GSO failed, disabling it\n" );
+                pState->gso = false;
+            }
+        }
+    }
+
+    TXBATCH_Reset( pTxBatch );
+
+    /* the GSO buffers are free once the batch has been sent */
+    pBatch->nGsoUsed = 0;
+
+    return ok;
+}
+
+/*============================================================================*/
+/*  ProcessCompletions                                                        */
+/*!
+    Process the transmit batches sent by the sender thread
+
+    The ProcessCompletions function is invoked when the sender thread
+    signals that it has sent one or more batches.  It reaps the sent
+    batches and removes any stale sockets they reported from the
+    socket cache.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+==============================================================================*/
+static void ProcessCompletions( UDPTState *pState )
+{
+    TXRING_ClearEvent( &pState->txRing );
+    ReapBatches( pState );
+    InvalidateStale( pState );
+}
+
+/*============================================================================*/
+/*  ReapBatches                                                               */
+/*!
+    Reap the transmit batches sent by the sender thread
+
+    The ReapBatches function processes the results of every batch the
+    sender thread has sent, and returns them to the transmit ring.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+==============================================================================*/
+static void ReapBatches( UDPTState *pState )
+{
+    TxRingSlot *pSlot;
+    UDPTBatch *pBatch;
+
+    while ( ( pSlot = TXRING_Reap( &pState->txRing ) ) != NULL )
+    {
+        pBatch = (UDPTBatch *)pSlot->pCtx;
+
+        HISTOGRAM_Record( &pBatch->pChannel->sendTime, pSlot->send_ns );
+        (void)CompleteBatch( pState, pBatch );
+
+        TXRING_Release( &pState->txRing );
+    }
+}
+
+/*============================================================================*/
+/*  WaitSender                                                                */
+/*!
+    Wait for the sender thread to finish sending
+
+    The WaitSender function waits until the sender thread has sent every
+    batch handed to it, and reaps them.  It must be called before any
+    cached socket is closed, since the queued batches may refer to it.
+    The sockets are also removed from the io_uring fixed file table,
+    which holds its own reference to them.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+==============================================================================*/
+static void WaitSender( UDPTState *pState )
+{
+    if ( pState->threaded == true )
+    {
+        TXRING_Wait( &pState->txRing );
+        ReapBatches( pState );
+    }
+
+    TXURING_ResetFiles( &pState->txUring );
+}
+
+/*============================================================================*/
+/*  InvalidateStale                                                           */
+/*!
+    Remove the stale sockets from the socket cache
+
+    The InvalidateStale function removes the sockets which reported a
+    stale interface error from the socket cache, so they are re-created
+    on next use.  This is deferred until no transmit batch is being
+    built, and the sender thread has sent all of the batches which may
+    still refer to them.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+==============================================================================*/
+static void InvalidateStale( UDPTState *pState )
+{
+    size_t i;
+
+    if ( ( pState->nStale > 0 ) &&
+         ( pState->pBatch == NULL ) )
+    {
+        WaitSender( pState );
+
+        for ( i = 0; i < pState->nStale; i++ )
+        {
+            SOCKCACHE_Invalidate( &pState->sockCache, pState->staleFds[i] );
+        }
+
+        pState->nStale = 0;
+    }
+}
+
+/*============================================================================*/
+/*  RenderPayload                                                             */
+/*!
+    Render the UDP payload for the current interface if required
+
+    The RenderPayload function renders the channel's template for the
+    interface whose IP address was most recently set by
+    UpdateInterfaceIP.  If per-interface rendering is selected, the
+    template is rendered for every interface.  Otherwise, it is only
+    rendered on the first call of a send pass.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        pChannel
+            pointer to the channel whose template is being sent
+
+    @param[in,out]
+        pRendered
+            pointer to a flag indicating the template was already
+            rendered during this send pass
+
+    @retval EOK the rendered output is ready
+    @retval other error from ProcessTemplate
+
+==============================================================================*/
+static int RenderPayload( UDPTState *pState,
+                          UDPTChannel *pChannel,
+                          bool *pRendered )
+{
+    int result = EOK;
+    uint64_t start_ns;
+
+    if ( ( pState->perInterfaceRender == true ) ||
+         ( *pRendered == false ) )
+    {
+        /* process the template */
+        start_ns = SCHED_Now();
+        result = ProcessTemplate( pState, pChannel );
+        HISTOGRAM_Record( &pChannel->renderTime, SCHED_Now() - start_ns );
+        *pRendered = ( result == EOK );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  GetPayload                                                                */
+/*!
+    Get the UDP payload for the current interface
+
+    The GetPayload function gets the payload to send on the interface
+    whose IP address was most recently set by UpdateInterfaceIP, from
+    the output of the most recent render.  Unless per-interface
+    rendering is selected, the interface IP address is spliced into a
+    copy of the rendered output, along with the seed and sequence
+    number of the transmitting virtual source for the load channel,
+    encoded as text or CBOR depending on the encoding of the rendered
+    output.
+
+    If the payload is specific to this interface, it is built in the
+    supplied output buffer, otherwise the shared rendered output is
+    used directly.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        pOut
+            pointer to the output buffer for this interface's payload
+
+    @param[in]
+        size
+            size of the output buffer, which is also the largest
+            payload that may be returned
+
+    @param[out]
+        ppMsg
+            pointer to a location to store a pointer to the payload
+
+    @param[out]
+        pLen
+            pointer to a location to store the payload length
+
+    @retval EOK the payload was generated
+    @retval E2BIG the payload does not fit in the output buffer
+    @retval ENOENT there is no rendered output
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int GetPayload( UDPTState *pState,
+                       char *pOut,
+                       size_t size,
+                       char **ppMsg,
+                       size_t *pLen )
+{
+    int result = EINVAL;
+    char fields[SPLICE_FIELDS][SPLICE_FIELD_SIZE];
+    size_t lens[SPLICE_FIELDS];
+    char *pBase;
+    size_t len;
+
+    if ( ( pState != NULL ) &&
+         ( pOut != NULL ) &&
+         ( ppMsg != NULL ) &&
+         ( pLen != NULL ) )
+    {
+        result = EOK;
+
+        /* get a pointer to the rendered template output */
+        pBase = pState->pRendered;
+        len = pState->renderedLen;
+        if ( pBase == NULL )
+        {
+            result = ENOENT;
+        }
+        else if ( pState->splices.nPoints > 0 )
+        {
+            /* insert the per-interface and per-source fields */
+            EncodeFields( pState, fields, lens );
+            result = SpliceFields( pState, fields, lens, pOut, size, pLen );
+            *ppMsg = pOut;
+        }
+        else if ( len > size )
+        {
+            result = E2BIG;
+        }
+        else if ( pState->perInterfaceRender == true )
+        {
+            /* the rendered output will be overwritten by the next
+               interface, so take a copy of it */
+            memcpy( pOut, pBase, len );
+            *ppMsg = pOut;
+            *pLen = len;
+        }
+        else
+        {
+            /* no per-interface fields, send the rendered output */
+            *ppMsg = pBase;
+            *pLen = len;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  EncodeFields                                                              */
+/*!
+    Encode the fields spliced into the rendered output
+
+    The EncodeFields function encodes the value of each spliced
+    variable of the most recent render: the interface IP address, and
+    the seed and sequence number of the transmitting virtual source.
+    They are encoded as text, in the same format as the variable server
+    uses, or as CBOR, depending on the encoding of the rendered output.
+    Fields which are not spliced are left empty.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[out]
+        fields
+            array of SPLICE_FIELDS buffers to encode the fields into
+
+    @param[out]
+        pLens
+            array of SPLICE_FIELDS locations to store the field lengths
+
+==============================================================================*/
+static void EncodeFields( UDPTState *pState,
+                          char fields[][SPLICE_FIELD_SIZE],
+                          size_t *pLens )
+{
+    uint32_t values[SPLICE_FIELDS];
+    CborWriter writer;
+    size_t i;
+    int n;
+
+    values[SPLICE_LOAD_SEED] = pState->loadSeed;
+    values[SPLICE_LOAD_SEQ] = pState->loadSeq;
+
+    for ( i = 0; i < SPLICE_FIELDS; i++ )
+    {
+        pLens[i] = 0;
+
+        if ( pState->splices.hVars[i] == VAR_INVALID )
+        {
+            /* the field is not spliced */
+        }
+        else if ( pState->renderEncoding == ENCODING_CBOR )
+        {
+            CBOR_Init( &writer, fields[i], SPLICE_FIELD_SIZE );
+            if ( i == SPLICE_IPADDR )
+            {
+                CBOR_Text( &writer,
+                           pState->IPAddr,
+                           strnlen( pState->IPAddr, IPADDR_SIZE ) );
+            }
+            else
+            {
+                CBOR_UInt( &writer, values[i] );
+            }
+
+            pLens[i] = writer.len;
+        }
+        else if ( i == SPLICE_IPADDR )
+        {
+            pLens[i] = strnlen( pState->IPAddr, IPADDR_SIZE );
+            memcpy( fields[i], pState->IPAddr, pLens[i] );
+        }
+        else
+        {
+            n = snprintf( fields[i], SPLICE_FIELD_SIZE, "%" PRIu32, values[i] );
+            pLens[i] = ( n > 0 ) ? (size_t)n : 0;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  SpliceFields                                                              */
+/*!
+    Splice the encoded fields into the rendered output
+
+    The SpliceFields function copies the most recently rendered output
+    into a transmit slot, inserting the encoded field of the spliced
+    variable at each splice point recorded during rendering.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        fields
+            array of SPLICE_FIELDS encoded fields
+
+    @param[in]
+        pLens
+            array of SPLICE_FIELDS encoded field lengths
+
+    @param[out]
+        pOut
+            pointer to the output buffer
+
+    @param[in]
+        size
+            size of the output buffer
+
+    @param[out]
+        pLen
+            pointer to a location to store the length of the payload
+
+    @retval EOK the payload was generated
+    @retval E2BIG the payload does not fit in the output buffer
+
+==============================================================================*/
+static int SpliceFields( UDPTState *pState,
+                         char fields[][SPLICE_FIELD_SIZE],
+                         const size_t *pLens,
+                         char *pOut,
+                         size_t size,
+                         size_t *pLen )
+{
+    int result = EOK;
+    CTSplices *pSplices = &pState->splices;
+    char *pBase = pState->pRendered;
+    size_t baseLen = pState->renderedLen;
+    size_t pos = 0;
+    size_t len = 0;
+    size_t offset;
+    size_t field;
+    size_t n;
+    size_t i;
+
+    for ( i = 0; ( i <= pSplices->nPoints ) && ( result == EOK ); i++ )
+    {
+        /* copy the rendered output up to the next splice point */
+        offset = ( i < pSplices->nPoints ) ? pSplices->points[i].offset
+                                           : baseLen;
+        if ( offset > baseLen )
+        {
+            offset = baseLen;
+        }
+
+        n = offset - pos;
+        if ( len + n > size )
+        {
+            result = E2BIG;
+        }
+        else
+        {
+            memcpy( &pOut[len], &pBase[pos], n );
+            len += n;
+            pos = offset;
+        }
+
+        if ( ( result == EOK ) &&
+             ( i < pSplices->nPoints ) )
+        {
+            /* insert the field of the spliced variable */
+            field = pSplices->points[i].field;
+            if ( len + pLens[field] > size )
+            {
+                result = E2BIG;
+            }
+            else
+            {
+                memcpy( &pOut[len], fields[field], pLens[field] );
+                len += pLens[field];
+            }
+        }
+    }
+
+    if ( result == EOK )
+    {
+        *pLen = len;
+    }
 
-    sigaction( SIGTERM, &sigact, NULL );
-    sigaction( SIGINT, &sigact, NULL );
+    return result;
 }
 
 /*============================================================================*/
-/*  TerminationHandler                                                        */
+/*  UpdateInterfaceIP                                                         */
 /*!
-    Abnormal termination handler
+    Update the interface IP address
 
-    The TerminationHandler function will be invoked in case of an abnormal
-    termination of this process.  The termination handler closes
-    the connection with the variable server and cleans up any open
-    resources.
+    The UpdateInterfaceIP function sets our IP address on the specified
+    interface as the source IP address of the payload being sent, using
+    the numeric address the interface table formatted when the address
+    was learned.
 
     @param[in]
-        signum
-            The signal which caused the abnormal termination (unused)
+        pState
+            pointer to the UDPTState object
 
     @param[in]
-        info
-            pointer to a siginfo_t object (unused)
+        pEntry
+            pointer to an interface table entry
 
-    @param[in]
-        ptr
-            signal context information (ucontext_t) (unused)
+    @retval EOK the IP address was successfully updated
+    @retval EINVAL invalid arguments
+    @retval ENOENT the interface address could not be formatted
+    @retval other error from SetIPAddr
 
 ==============================================================================*/
-static void TerminationHandler( int signum, siginfo_t *info, void *ptr )
+static int UpdateInterfaceIP( UDPTState *pState, IfEntry *pEntry )
 {
-    /* signum, info, and ptr are unused */
-    (void)signum;
-    (void)info;
-    (void)ptr;
-
-    fprintf( stderr, "Abnormal termination of the UDP template generator\n" );
+    int result = EINVAL;
 
-    if ( state.hVarServer != NULL )
+    if ( ( pState != NULL ) &&
+         ( pEntry != NULL ) )
     {
-        if ( VARSERVER_Close( state.hVarServer ) == EOK )
+        if ( pEntry->host[0] != '\0' )
         {
-            state.hVarServer = NULL;
+            result = SetIPAddr( pState, pEntry->host );
+        }
+        else
+        {
+            result = ENOENT;
+            fprintf( stderr, "Failed to get host IP\n");
         }
     }
 
-    exit( 1 );
+    return result;
 }
 
 /*============================================================================*/
-/*  SetupVars                                                                 */
+/*  SetIPAddr                                                                 */
 /*!
-    Set up the UDP template generator variables
+    Set the source IP address of the payload being sent
+
+    The SetIPAddr function keeps a copy of the local IP address the
+    payload is sent from, which GetPayload splices into the rendered
+    output.
 
-    The SetupVars function creates and configures the UDP template generator
-    variables
+    The IPAddress varserver variable referenced by hIPAddr is only
+    written if per-interface rendering is selected, since the renderer
+    then reads the address from it, and only if the address differs
+    from the one last written.  Every write is a varserver round trip,
+    and notifies any other process watching the variable.
 
     @param[in]
         pState
-            pointer to the UDPTState object containing the names of the
-            variables to set up.
+            pointer to the UDPTState object
 
-    @retval
-        EOK - UDP Template variables successfully set up
-        EINVAL - invalid arguments
+    @param[in]
+        host
+            numeric local IP address
+
+    @retval EOK the IP address was successfully updated
+    @retval other error from VAR_Set
 
 ==============================================================================*/
-static int SetupVars( UDPTState *pState )
+static int SetIPAddr( UDPTState *pState, const char *host )
 {
-    int result = EINVAL;
-    int errcount = 0;
-    int i;
-    int n;
-    VAR_HANDLE *pVarHandle;
-    VarDef *pVarDef;
+    int result = EOK;
+    VarObject obj;
 
-    if ( pState != NULL )
+    /* keep a copy of the IP address so it can be spliced
+       into the rendered output */
+    snprintf( pState->IPAddr, sizeof( pState->IPAddr ), "%s", host );
+
+    if ( ( pState->perInterfaceRender == true ) &&
+         ( pState->hIPAddr != VAR_INVALID ) &&
+         ( strcmp( pState->IPAddr, pState->IPAddrVar ) != 0 ) )
     {
-        VARSERVER_HANDLE hVarServer = pState->hVarServer;
-        for ( i=0 ; i < pState->varCount ; i++ )
+        /* store the IP address on the varserver variable
+            so it may be included in the packet via the
+            template rendering mechanism */
+        obj.val.str = pState->IPAddr;
+        obj.len = strlen( pState->IPAddr );
+        obj.type = VARTYPE_STR;
+
+        result = VAR_Set( pState->hVarServer, pState->hIPAddr, &obj );
+        if ( result == EOK )
         {
-            pVarDef = pState->pVarDef;
-            if ( *(pVarDef[i].name) != NULL )
-            {
-                /* get a pointer to the location to store the variable handle */
-                pVarHandle = pVarDef[i].pVarHandle;
-                if ( pVarHandle != NULL )
-                {
-                    /* create a message variable */
-                    *pVarHandle = SetupVar( hVarServer,
-                                            *pVarDef[i].name,
-                                            pVarDef[i].type,
-                                            pVarDef[i].len,
-                                            pVarDef[i].flags,
-                                            pVarDef[i].notifyType );
-                    if ( *pVarHandle == VAR_INVALID )
-                    {
-                        fprintf( stderr,
-                                 "Error creating variable: %s\n",
-                                 *pVarDef[i].name );
-                        errcount++;
-                    }
-                    else
-                    {
-                        GetVar( hVarServer, &pVarDef[i] );
-                    }
-                }
-            }
+            strcpy( pState->IPAddrVar, pState->IPAddr );
+            pState->ipAddrWrites++;
         }
     }
 
-    if ( errcount == 0 )
-    {
-        result = EOK;
-    }
-
     return result;
 }
 
 /*============================================================================*/
-/*  SetupVar                                                                  */
+/*  GetDestAddr                                                               */
 /*!
-    Set up a variable
+    Get the destination address of a channel for an interface address
 
-    The SetupVar function creates a varserver variable to be used to
-    interact with the manifest generator.
-    The variable may or may not have a notification associated with it.
+    The GetDestAddr function builds the UDP destination address of the
+    channel for the specified interface address.  A broadcast channel
+    is sent to the broadcast address of every IPv4 interface address.
+    A multicast channel is sent to its group of the same address
+    family, once per interface.
 
-@param[in]
-    hVarServer
-        handle to the variable server
+    @param[in]
+        pState
+            pointer to the UDPTState object
 
-@param[in]
-    name
-        specify the variable name to create
+    @param[in]
+        pChannel
+            pointer to the channel being sent
 
-@param[in]
-    type
-        type of the variable
+    @param[in]
+        pEntry
+            pointer to the interface table entry to send on
 
-@param[in]
-    len
-        length of the variable (strings/blobs only)
+    @param[out]
+        pAddr
+            pointer to the location to store the destination address
 
-@param[in]
-    flags
-        flags to add to the variable flag set
+    @param[out]
+        pAddrLen
+            pointer to the location to store the destination address length
 
-@param[in]
-    notify
-        specify the notification type.  Use NOTIFY_NONE if no notification is
-        required
+    @retval EOK the destination address was generated
+    @retval ENOENT the channel is not sent to this interface address
+    @retval ENOTSUP unsupported address family
+    @retval EINVAL invalid arguments
 
 ==============================================================================*/
-VAR_HANDLE SetupVar( VARSERVER_HANDLE hVarServer,
-                     char *name,
-                     VarType type,
-                     size_t len,
-                     uint32_t flags,
-                     NotificationType notify )
+static int GetDestAddr( UDPTState *pState,
+                        UDPTChannel *pChannel,
+                        IfEntry *pEntry,
+                        struct sockaddr_storage *pAddr,
+                        socklen_t *pAddrLen )
 {
-    VAR_HANDLE hVar = VAR_INVALID;
-    VarInfo info;
-    int result;
-    size_t l;
-    VarType vartype = VARTYPE_INVALID;
+    int result = EINVAL;
 
-    if ( name != NULL )
+    if ( ( pState != NULL ) &&
+         ( pChannel != NULL ) &&
+         ( pEntry != NULL ) )
     {
-        l = strlen( name );
-        if ( l < sizeof( info.name ) )
+        if ( ( pChannel->hasGroup4 == true ) ||
+             ( pChannel->hasGroup6 == true ) )
         {
-            memset( &info, 0, sizeof( VarInfo ) );
-
-            info.flags = flags;
-            info.var.type = type;
-            info.var.len = len;
-
-            /* set the variable name */
-            strcpy( info.name, name );
-
-            /* try to create the variable.  This will fail if the variable
-               was already pre-created */
-            result = VARSERVER_CreateVar( hVarServer, &info );
-            if ( result == EOK )
-            {
-                hVar = info.hVar;
-            }
-
-            if ( hVar == VAR_INVALID )
-            {
-                /* search for the variable which may have been pre-created */
-                hVar = VAR_FindByName( hVarServer, info.name );
-                if ( hVar != VAR_INVALID )
-                {
-                    result = VAR_GetType( hVarServer, hVar, &vartype );
-                    if ( result == EOK )
-                    {
-                        result = ( vartype == type ) ? EOK : ENOTSUP;
-                    }
-                }
-            }
-
-            if ( result == EOK )
-            {
-                if ( ( hVar != VAR_INVALID ) &&
-                     ( notify != NOTIFY_NONE ) )
-                {
-                    /* set up variable notification */
-                    result = VAR_Notify( hVarServer, hVar, notify );
-                    if ( result != EOK )
-                    {
-                        fprintf( stderr,
-                                 "UDPT: Failed to set up notification: '%s'\n",
-                                 info.name );
-                    }
-                }
-            }
+            result = GetMulticastAddr( pState,
+                                       pChannel,
+                                       pEntry,
+                                       pAddr,
+                                       pAddrLen );
+        }
+        else if ( pEntry->hasBroadcast == false )
+        {
+            /* IPv6 and point to point addresses have no broadcast */
+            result = ENOENT;
+        }
+        else
+        {
+            result = GetBroadcastAddr( pEntry,
+                                       pChannel->port,
+                                       pAddr,
+                                       pAddrLen );
         }
     }
 
-    return hVar;
+    return result;
 }
 
 /*============================================================================*/
-/*  GetVar                                                                    */
+/*  GetMulticastAddr                                                          */
 /*!
-    Get the value of a varserver variable
+    Get the multicast destination address for an interface address
 
-    The GetVar function copies the value of a varserver variable
-    into its local value within the UDPTState object.
+    The GetMulticastAddr function builds the UDP destination address of
+    the channel's multicast group with the same address family as the
+    interface address.  Since the interface table holds one entry per
+    address, only the first address of each family on an interface is
+    sent to, so an interface with several addresses does not receive
+    duplicate datagrams.  The scope of IPv6 groups is the interface.
 
-@param[in]
-    hVarServer
-        handle to the variable server
+    @param[in]
+        pState
+            pointer to the UDPTState object
 
-@param[in]
-    pVarDef
-        pointer to a variable definition that maps the variable handle
-        to its local data storage.
+    @param[in]
+        pChannel
+            pointer to the channel being sent
+
+    @param[in]
+        pEntry
+            pointer to the interface table entry to send on
+
+    @param[out]
+        pAddr
+            pointer to the location to store the destination address
+
+    @param[out]
+        pAddrLen
+            pointer to the location to store the destination address length
+
+    @retval EOK the destination address was generated
+    @retval ENOENT the channel is not sent to this interface address
+    @retval EINVAL invalid arguments
 
 ==============================================================================*/
-static int GetVar( VARSERVER_HANDLE hVarServer, VarDef *pVarDef )
+static int GetMulticastAddr( UDPTState *pState,
+                             UDPTChannel *pChannel,
+                             IfEntry *pEntry,
+                             struct sockaddr_storage *pAddr,
+                             socklen_t *pAddrLen )
 {
     int result = EINVAL;
-    VarObject obj;
-    VAR_HANDLE hVar;
-
-    if ( pVarDef != NULL )
+    struct sockaddr_in *pAddr4 = (struct sockaddr_in *)pAddr;
+    struct sockaddr_in6 *pAddr6 = (struct sockaddr_in6 *)pAddr;
+    IfEntry *pOther;
+    bool found = false;
+    size_t i;
+
+    if ( ( pAddr != NULL ) &&
+         ( pAddrLen != NULL ) &&
+         ( pChannel->port != 0 ) )
     {
-        hVar = *(pVarDef->pVarHandle);
-        if ( ( hVar != VAR_INVALID ) &&
-             ( pVarDef->pVal != NULL ) )
+        result = ENOENT;
+
+        /* look for an earlier address of the same family on the
+           interface */
+        for ( i = 0;
+              ( i < pState->ifTable.n ) &&
+              ( &pState->ifTable.entries[i] != pEntry ) &&
+              ( found == false );
+              i++ )
         {
-            if ( pVarDef->type == VARTYPE_STR )
+            pOther = &pState->ifTable.entries[i];
+            if ( ( pOther->up == true ) &&
+                 ( pOther->ifindex == pEntry->ifindex ) &&
+                 ( pOther->family == pEntry->family ) )
             {
-                obj.len = pVarDef->len;
-                obj.val.str = (char *)pVarDef->pVal;
+                found = true;
             }
+        }
 
-            result = VAR_Get( hVarServer, hVar, &obj );
-            if ( result == EOK )
-            {
-                switch( pVarDef->type )
-                {
-                    case VARTYPE_UINT16:
-                        *(uint16_t *)(pVarDef->pVal) = obj.val.ui;
-                        break;
-
-                    case VARTYPE_UINT32:
-                        *(uint32_t *)(pVarDef->pVal) = obj.val.ul;
-                        break;
+        memset( pAddr, 0, sizeof( struct sockaddr_storage ) );
 
-                    default:
-                        result = ENOTSUP;
-                        break;
-                }
-            }
+        if ( found == true )
+        {
+            /* already sent to this interface */
         }
-        else
+        else if ( ( pEntry->family == AF_INET ) &&
+                  ( pChannel->hasGroup4 == true ) )
         {
-            /* no variable handle or local data reference */
-            result = ENOENT;
+            pAddr4->sin_family = AF_INET;
+            pAddr4->sin_port = htons( pChannel->port );
+            pAddr4->sin_addr = pChannel->group4;
+            *pAddrLen = sizeof( struct sockaddr_in );
+            result = EOK;
+        }
+        else if ( ( pEntry->family == AF_INET6 ) &&
+                  ( pChannel->hasGroup6 == true ) )
+        {
+            pAddr6->sin6_family = AF_INET6;
+            pAddr6->sin6_port = htons( pChannel->port );
+            pAddr6->sin6_addr = pChannel->group6;
+            pAddr6->sin6_scope_id = (uint32_t)pEntry->ifindex;
+            *pAddrLen = sizeof( struct sockaddr_in6 );
+            result = EOK;
         }
     }
 
@@ -875,50 +6992,61 @@ static int GetVar( VARSERVER_HANDLE hVarServer, VarDef *pVarDef )
 }
 
 /*============================================================================*/
-/*  SetupVarFP                                                                */
+/*  ParseGroups                                                               */
 /*!
-    Set up a variable output stream for rendering variables to text
+    Parse the multicast group list of a channel
 
-    The SetupVarFP function sets up a shared memory buffer backed by an
-    output stream to allow us to render variables (possibly from other
-    processes) into a memory buffer.
+    The ParseGroups function parses the channel's comma separated list
+    of multicast groups, which may contain one IPv4 group and one IPv6
+    group, for example "239.1.1.1,ff02::1".  If the list is empty, the
+    channel is broadcast.
 
     @param[in]
-        pState
-            pointer to the UDPTState object to initialize
+        pChannel
+            pointer to the channel
 
-    @retval EOK the Variable Message rendering buffer was created
-    @retval EBADF failed to create the memory buffer
-    @retval EINVAL invalid arguments
+    @retval EOK the multicast group list was parsed
+    @retval EINVAL the list contains an invalid multicast group
 
 ==============================================================================*/
-static int SetupVarFP( UDPTState *pState )
+static int ParseGroups( UDPTChannel *pChannel )
 {
     int result = EINVAL;
-    char varfp_name[64];
-    time_t now;
-    int n;
-    size_t len = sizeof(varfp_name);
+    char groupList[GROUP_LIST_LEN];
+    char *saveptr = NULL;
+    char *token;
+    struct in_addr addr4;
+    struct in6_addr addr6;
 
-    if ( pState != NULL )
+    if ( pChannel != NULL )
     {
-        result = EBADF;
+        result = EOK;
+        pChannel->hasGroup4 = false;
+        pChannel->hasGroup6 = false;
 
-        /* generate a temporary name for the VarFP */
-        now = time(NULL);
-        n = snprintf(varfp_name, sizeof(varfp_name), "udpt_%ld", now );
-        if ( ( n > 0 ) && ( (size_t)n < len ) )
+        /* make a mutable copy of the group list */
+        snprintf( groupList, sizeof( groupList ), "%s", pChannel->groupList );
+
+        for ( token = strtok_r( groupList, ", ", &saveptr );
+              token != NULL;
+              token = strtok_r( NULL, ", ", &saveptr ) )
         {
-            /* open a VarFP object for printing */
-            pState->pVarFP = VARFP_Open(varfp_name, MAX_UDPT_SIZE );
-            if ( pState->pVarFP != NULL )
+            if ( ( inet_pton( AF_INET, token, &addr4 ) == 1 ) &&
+                 ( IN_MULTICAST( ntohl( addr4.s_addr ) ) ) )
             {
-                /* get a file descriptor for the memory buffer */
-                pState->varFd = VARFP_GetFd( pState->pVarFP );
-                if ( pState->varFd != -1 )
-                {
-                    result = EOK;
-                }
+                pChannel->group4 = addr4;
+                pChannel->hasGroup4 = true;
+            }
+            else if ( ( inet_pton( AF_INET6, token, &addr6 ) == 1 ) &&
+                      ( IN6_IS_ADDR_MULTICAST( &addr6 ) ) )
+            {
+                pChannel->group6 = addr6;
+                pChannel->hasGroup6 = true;
+            }
+            else
+            {
+                fprintf( stderr, "Invalid multicast group: %s\n", token );
+                result = EINVAL;
             }
         }
     }
@@ -927,65 +7055,75 @@ static int SetupVarFP( UDPTState *pState )
 }
 
 /*============================================================================*/
-/*  SetupTimer                                                                */
+/*  GetBroadcastAddr                                                          */
 /*!
-    Set up a timer
+    Get the broadcast destination address for an interface
 
-    The SetupTimer function sets up a timer to periodically broadcast
-    the rendered UDP template.
+    The GetBroadcastAddr function builds the UDP broadcast destination
+    address for the specified interface.
 
     @param[in]
-        pState
-            Pointer to the UDPTState object containing the timer
+        pEntry
+            pointer to the interface table entry to send on
 
-    @retval EOK timer set up ok
-    @retval other error from timer_create or timer_settime
+    @param[in]
+        port
+            output port
+
+    @param[out]
+        pAddr
+            pointer to the location to store the destination address
+
+    @param[out]
+        pAddrLen
+            pointer to the location to store the destination address length
+
+    @retval EOK the destination address was generated
+    @retval ENOTSUP unsupported address family
+    @retval EINVAL invalid arguments or no broadcast address
 
 ==============================================================================*/
-static int SetupTimer( UDPTState *pState )
+static int GetBroadcastAddr( IfEntry *pEntry,
+                             int port,
+                             struct sockaddr_storage *pAddr,
+                             socklen_t *pAddrLen )
 {
-    struct sigevent te;
-    struct itimerspec its;
-    time_t secs;
     int result = EINVAL;
-    static timer_t timer = 0;
-    int rc;
+    struct sockaddr_in *broadcast_addr4 = (struct sockaddr_in *)pAddr;
+    struct sockaddr_in6 *broadcast_addr6 = (struct sockaddr_in6 *)pAddr;
+    struct sockaddr *pSockAddr;
 
-    if ( pState != NULL )
+    if ( ( pEntry != NULL ) &&
+         ( pEntry->hasBroadcast == true ) &&
+         ( pAddr != NULL ) &&
+         ( pAddrLen != NULL ) &&
+         ( port != 0 ))
     {
-        if ( pState->txrate_s != 0 )
-        {
-            if ( pState->timerID != NULL )
-            {
-                timer_delete( *(pState->timerID));
-            }
-
-            secs = pState->txrate_s;
-            pState->timerID = &pState->timer;
+        pSockAddr = (struct sockaddr *)&pEntry->broadaddr;
+        memset( pAddr, 0, sizeof( struct sockaddr_storage ) );
 
-            /* Set and enable alarm */
-            te.sigev_notify = SIGEV_SIGNAL;
-            te.sigev_signo = SIG_VAR_TIMER;
-            te.sigev_value.sival_int = 1;
-            rc = timer_create(CLOCK_REALTIME, &te, pState->timerID);
-            if ( rc == 0 )
-            {
-                its.it_interval.tv_sec = secs;
-                its.it_interval.tv_nsec = 0;
-                its.it_value.tv_sec = secs;
-                its.it_value.tv_nsec = 0;
-                rc = timer_settime(*(pState->timerID), 0, &its, NULL);
-                result = ( rc == 0 ) ? EOK : errno;
-            }
-            else
-            {
-                result = errno;
-            }
-        }
-        else
+        switch( pEntry->family )
         {
-            /* no timer set */
-            result = EOK;
+            case AF_INET:
+                broadcast_addr4->sin_family = AF_INET;
+                broadcast_addr4->sin_port = htons(port);
+                broadcast_addr4->sin_addr =
+                            ((struct sockaddr_in *)pSockAddr)->sin_addr;
+                *pAddrLen = sizeof( struct sockaddr_in );
+                result = EOK;
+                break;
+
+            case AF_INET6:
+                broadcast_addr6->sin6_family = AF_INET6;
+                broadcast_addr6->sin6_port = htons(port);
+                broadcast_addr6->sin6_addr =
+                        ((struct sockaddr_in6 *)pSockAddr)->sin6_addr;
+                *pAddrLen = sizeof( struct sockaddr_in6 );
+                result = EOK;
+                break;
+
+            default:
+                result = ENOTSUP;
         }
     }
 
@@ -993,481 +7131,576 @@ static int SetupTimer( UDPTState *pState )
 }
 
 /*============================================================================*/
-/*  RunMessageHandler                                                         */
+/*  GetIfStats                                                                */
 /*!
-    Run the message handler loop
+    Get the statistics for an interface
 
-    The RunMessageHandler function waits for an external signal
-    either from a timer, or from the variable server.
+    The GetIfStats function gets the transmission statistics object
+    of a channel for the specified interface and address family,
+    creating it if necessary.
 
     @param[in]
-        pState
-            pointer to the UDPTState object
+        pChannel
+            pointer to the channel containing the statistics
+
+    @param[in]
+        ifname
+            name of the interface
+
+    @param[in]
+        family
+            address family sent on the interface
 
-    @retval EOK message handler exited ok
-    @retval other error
+    @retval pointer to the interface statistics
+    @retval NULL the interface statistics table is full
 
 ==============================================================================*/
-static void RunMessageHandler( UDPTState *pState )
+static UDPTIfStats *GetIfStats( UDPTChannel *pChannel,
+                                const char *ifname,
+                                int family )
 {
-    int sig;
-    int sigval;
-    int result;
-    VAR_HANDLE hVar;
+    UDPTIfStats *pIfStats = NULL;
+    size_t i;
 
-    while( 1 )
+    for ( i = 0; ( i < pChannel->nIfStats ) && ( pIfStats == NULL ); i++ )
     {
-        /* wait for a received signal */
-        sig = VARSERVER_WaitSignal( &sigval );
-        if ( sig == SIG_VAR_TIMER )
-        {
-            /* process received timer signal */
-            result = ProcessTimer( pState );
-        }
-        else if ( sig == SIG_VAR_MODIFIED )
-        {
-            hVar = (VAR_HANDLE)sigval;
-            result = ProcessModified( pState, hVar );
-        }
-        else if ( sig == SIG_VAR_PRINT )
+        if ( ( pChannel->ifStats[i].family == family ) &&
+             ( strcmp( pChannel->ifStats[i].ifname, ifname ) == 0 ) )
         {
-            result = HandlePrintRequest( pState, sigval );
+            pIfStats = &pChannel->ifStats[i];
         }
     }
+
+    if ( ( pIfStats == NULL ) &&
+         ( pChannel->nIfStats < MAX_IFSTATS ) )
+    {
+        pIfStats = &pChannel->ifStats[pChannel->nIfStats++];
+        memset( pIfStats, 0, sizeof( UDPTIfStats ) );
+        snprintf( pIfStats->ifname, sizeof( pIfStats->ifname ), "%s", ifname );
+        pIfStats->family = family;
+    }
+
+    return pIfStats;
 }
 
 /*============================================================================*/
-/*  ProcessTimer                                                              */
+/*  DumpStats                                                                 */
 /*!
-    Process a received timer tick
+    Dump the UDPT statistics to the output file descriptor
 
-    The ProcessTimer function processes the UDP template and
-    transmits the broadcast message
+    The DumpStats function writes the UDPT statistics
+    to the output file descriptor as a JSON object.  The statistics
+    of the default (first) channel are written at the top level.  If
+    there are multiple channels, the statistics of every channel are
+    also written to a channels array.
 
     @param[in]
         pState
-            pointer to the UDPTState object to process
+            pointer to the UDPTState containing the statistics
 
-    @retval EOK Timer handler processed successfully
-    @retval EINVAL invalid argument
+    @param[in]
+        fd
+            output file descriptor
+
+    @retval EOK output generated ok
+    @retval EINVAL invalid arguments
 
 ==============================================================================*/
-static int ProcessTimer( UDPTState *pState )
+static int DumpStats( UDPTState *pState, int fd )
 {
     int result = EINVAL;
+    size_t i;
+
+    /* write the opening brace */
+    dprintf( fd, "{" );
 
     if ( pState != NULL )
     {
-        if ( pState->enable == true )
+        DumpChannelStats( &pState->channels[0], fd );
+
+        dprintf( fd, ", \"ipaddr_writes\": %u", pState->ipAddrWrites );
+
+        if ( pState->pacing.n > 0 )
         {
-            result = SendOutput( pState );
+            DumpPacingStats( pState, fd );
         }
-        else
+
+        DumpRealtimeStats( pState, fd );
+
+        if ( pState->pLoadChannel != NULL )
         {
-            result = EOK;
+            DumpLoadStats( pState, fd );
+        }
+
+        if ( pState->txStamp.mode != TXSTAMP_OFF )
+        {
+            dprintf( fd,
+                     ", \"txstamp\": {\"mode\": \"%s\", "
+                     "\"samples\": %" PRIu64 ", "
+                     "\"unmatched\": %" PRIu64 ", "
+                     "\"hw_sockets\": %zu}",
+                     TXSTAMP_ModeName( pState->txStamp.mode ),
+                     pState->txStamp.samples,
+                     pState->txStamp.unmatched,
+                     TXSTAMP_CountHardware( &pState->txStamp ) );
+        }
+
+        if ( pState->useSnapshot == true )
+        {
+            dprintf( fd,
+                     ", \"snapshot_vars\": %zu, \"snapshots\": %u",
+                     pState->snapshot.n,
+                     pState->snapshot.count );
+        }
+
+        if ( pState->incremental == true )
+        {
+            DumpCacheStats( pState, fd );
+        }
+
+        if ( pState->nChannels > 1 )
+        {
+            dprintf( fd, ", \"channels\": [" );
+            for ( i = 0; i < pState->nChannels; i++ )
+            {
+                dprintf( fd,
+                         "%s{\"name\": \"%s\", ",
+                         ( i > 0 ) ? ", " : "",
+                         ( pState->channels[i].name != NULL )
+                            ? pState->channels[i].name
+                            : "" );
+                DumpChannelStats( &pState->channels[i], fd );
+                dprintf( fd, "}" );
+            }
+            dprintf( fd, "]" );
         }
+
+        result = EOK;
     }
 
+    /* write the closing brace */
+    dprintf(fd, "}" );
+
     return result;
 }
 
 /*============================================================================*/
-/*  ProcessModified                                                           */
+/*  DumpSubscribers                                                           */
 /*!
-    Process a NOTIFY_MODIFIED notification
+    Dump the unicast subscriber statistics of a channel
 
-    The ProcessModified function handles changes to varserver variables
+    The DumpSubscribers function writes the number of unicast
+    subscribers of a channel, and the subscribers which are currently
+    backing off after an error, as members of a JSON object.
 
     @param[in]
-        pState
-            pointer to the UDPTState object
+        pChannel
+            pointer to the channel containing the subscribers
 
     @param[in]
-        hVar
-            handle to the modified variable
-
-    @retval EOK Modified handler processed successfully
-    @retval EINVAL invalid argument
+        fd
+            output file descriptor
 
 ==============================================================================*/
-static int ProcessModified( UDPTState *pState, VAR_HANDLE hVar )
+static void DumpSubscribers( UDPTChannel *pChannel, int fd )
 {
-    VarObject obj;
-    int result = EINVAL;
-    VarDef *pVarDef;
-    int i;
-    VAR_HANDLE hRefVar;
-
-    if ( pState != NULL )
+    SubList *pList = &pChannel->subscribers;
+    uint64_t now_ns = SCHED_Now();
+    Subscriber *pSub;
+    bool comma = false;
+    size_t i;
+
+    dprintf( fd, "\"subscribers\": %zu, ", pList->n );
+    dprintf( fd,
+             "\"subscribers_backoff\": %zu, ",
+             SUBLIST_CountBackoff( pList, now_ns ) );
+    dprintf( fd, "\"unreachable\": [" );
+    for ( i = 0; i < pList->n; i++ )
     {
-        pVarDef = pState->pVarDef;
-
-        if ( pVarDef != NULL )
+        pSub = &pList->entries[i];
+        if ( pSub->retry_ns > now_ns )
         {
-            result = ENOENT;
-            for(i=0;i<pState->varCount;i++)
-            {
-                pVarDef = &pState->pVarDef[i];
-                if ( pVarDef->pVarHandle != NULL )
-                {
-                    hRefVar = *(pVarDef->pVarHandle);
-                    if ( hVar == hRefVar )
-                    {
-                        /* get the variable value */
-                        GetVar( pState->hVarServer, pVarDef );
-                        if ( pVarDef->cb != NULL )
-                        {
-                            /* invoke the var change callback */
-                            result = pVarDef->cb( pState );
-                        }
-                    }
-                    else
-                    {
-                        result = ENOTSUP;
-                    }
-                }
-            }
+            dprintf( fd,
+                     "%s{\"name\": \"%s\", \"txcount\": %u, "
+                     "\"errcount\": %u, \"skipped\": %u, "
+                     "\"lasterror\": %d}",
+                     comma ? ", " : "",
+                     pSub->name,
+                     pSub->txcount,
+                     pSub->errcount,
+                     pSub->skipped,
+                     pSub->lastError );
+            comma = true;
         }
     }
-
-    return result;
+    dprintf( fd, "], " );
 }
 
 /*============================================================================*/
-/*  ProcessTemplate                                                           */
+/*  DumpCacheStats                                                            */
 /*!
-    Process a UDP template
+    Dump the formatted text cache statistics
 
-    The ProcessTemplate function processes a template and sends the generated
-    output as a UDP broadcast on all allowed networks
+    The DumpCacheStats function writes the number of template variable
+    references which were formatted and the number which were reused
+    from the formatted text cache, summed over all templates, as members
+    of a JSON object.
 
     @param[in]
         pState
             pointer to the UDPTState object
 
     @param[in]
-        hVar
-            handle to the modified variable
-
-    @retval EOK Modified handler processed successfully
-    @retval EINVAL invalid argument
+        fd
+            output file descriptor
 
 ==============================================================================*/
-static int ProcessTemplate( UDPTState *pState )
+static void DumpCacheStats( UDPTState *pState, int fd )
 {
-    int fd;
-    int result = EINVAL;
+    uint64_t formatted = 0;
+    uint64_t reused = 0;
+    size_t i;
 
-    if ( pState != NULL )
+    for ( i = 0; i < MAX_CHANNELS; i++ )
     {
-        /* open input template */
-        if ( strlen( pState->templateFilename ) > 0 )
-        {
-            fd = open( pState->templateFilename, O_RDONLY );
-            if ( fd != -1 )
-            {
-                if ( pState->varFd > 0 )
-                {
-                    if ( lseek( pState->varFd, 0, SEEK_SET) == 0 )
-                    {
-                        /* generate the output payload */
-                        result = TEMPLATE_FileToFile( pState->hVarServer,
-                                                      fd,
-                                                      pState->varFd );
-                        if ( result == EOK )
-                        {
-                            /* NUL terminate the buffer */
-                            Output( pState->varFd, "\0", 1 );
-                        }
-                        else
-                        {
-                            fprintf(stderr, "template generation error\n");
-                        }
-                    }
-                    else
-                    {
-                        fprintf( stderr, "seek error\n");
-                        result = EIO;
-                    }
-                }
-                else
-                {
-                    fprintf( stderr, "invalid output stream\n");
-                    result = EBADF;
-                }
-
-                close( fd );
-            }
-            else
-            {
-                fprintf( stderr, "invalid template input\n");
-                result = ENOENT;
-            }
-        }
-        else
+        if ( pState->templates[i].refCount > 0 )
         {
-            fprintf( stderr, "No template specified\n");
-            result = ENOENT;
+            formatted += pState->templates[i].compiled.formatted;
+            reused += pState->templates[i].compiled.reused;
         }
     }
 
-    return result;
+    dprintf( fd,
+             ", \"vars_formatted\": %" PRIu64 ", \"vars_reused\": %" PRIu64,
+             formatted,
+             reused );
 }
 
 /*============================================================================*/
-/*  HandlePrintRequest                                                        */
+/*  DumpPacingStats                                                           */
 /*!
-    Handle a varserver print request notification
+    Dump the transmit pacing statistics
 
-    The HandlePrintRequest function handles a print request notification
-    from the variable server.
+    The DumpPacingStats function writes the configuration and counters
+    of every paced interface, summed over all channels, as a member of
+    a JSON object.  The mode is the one in use, which is "bucket" if
+    the kernel rejected the configured mode.
 
     @param[in]
         pState
-            pointer to the UDPT State
+            pointer to the UDPTState object
 
     @param[in]
-        id
-            print notification identifier
+        fd
+            output file descriptor
 
-    @retval EOK print request notification handled successfully
-    @retval EINVAL invalid arguments
+==============================================================================*/
+static void DumpPacingStats( UDPTState *pState, int fd )
+{
+    PacingEntry *pEntry;
+    size_t i;
+
+    dprintf( fd, ", \"pacing\": [" );
+    for ( i = 0; i < pState->pacing.n; i++ )
+    {
+        pEntry = &pState->pacing.entries[i];
+        dprintf( fd,
+                 "%s{\"name\": \"%s\", \"mode\": \"%s\", "
+                 "\"rate\": %" PRIu64 ", \"burst\": %" PRIu64 ", "
+                 "\"admitted\": %" PRIu64 ", \"deferred\": %" PRIu64 ", "
+                 "\"dropped\": %" PRIu64 "}",
+                 ( i > 0 ) ? ", " : "",
+                 pEntry->ifname,
+                 PACING_ModeName( pEntry->active ),
+                 pEntry->rate,
+                 pEntry->burst,
+                 pEntry->admitted,
+                 pEntry->deferred,
+                 pEntry->dropped );
+    }
+    dprintf( fd, "]" );
+}
+
+/*============================================================================*/
+/*  DumpRealtimeStats                                                         */
+/*!
+    Dump the timing statistics of the real-time mode
+
+    The DumpRealtimeStats function writes the largest schedule jitter
+    and total transmission time of all of the channels to the output
+    file descriptor as members of a JSON object.  In real-time mode,
+    the memory lock and the real-time priority are also written, and
+    when the heap allocations are counted (UDPT_RT_ALLOC_CHECK), whether
+    the steady state has been entered and the number of allocations
+    made in it.
+
+    @param[in]
+        pState
+            pointer to the UDPTState object
+
+    @param[in]
+        fd
+            output file descriptor
 
 ==============================================================================*/
-static int HandlePrintRequest( UDPTState *pState, int32_t id )
+static void DumpRealtimeStats( UDPTState *pState, int fd )
 {
-    int result = EINVAL;
-    VAR_HANDLE hVar;
-    int fd;
+    RtMode *pRt = &pState->rt;
+    uint64_t jitter_ns = 0;
+    uint64_t tick_ns = 0;
+    size_t i;
 
-    if ( pState != NULL )
+    for ( i = 0; i < pState->nChannels; i++ )
     {
-        /* open a print session */
-        if ( VAR_OpenPrintSession( pState->hVarServer,
-                                   id,
-                                   &hVar,
-                                   &fd ) == EOK )
+        if ( pState->channels[i].jitter.max_ns > jitter_ns )
         {
-            result = ENOENT;
-
-            if ( hVar == pState->hMetrics )
-            {
-                (void)PrintUDPTInfo( hVar, pState, fd );
-            }
+            jitter_ns = pState->channels[i].jitter.max_ns;
+        }
 
-            /* Close the print session */
-            result = VAR_ClosePrintSession( pState->hVarServer,
-                                            id,
-                                            fd );
+        if ( pState->channels[i].tickTime.max_ns > tick_ns )
+        {
+            tick_ns = pState->channels[i].tickTime.max_ns;
         }
     }
 
-    return result;
+    dprintf( fd,
+             ", \"max_jitter_us\": %" PRIu64 ", \"max_tick_us\": %" PRIu64,
+             jitter_ns / 1000,
+             tick_ns / 1000 );
+
+    if ( pRt->enabled == true )
+    {
+        dprintf( fd,
+                 ", \"rt\": {\"locked\": %s, \"priority\": %d",
+                 pRt->locked ? "true" : "false",
+                 pRt->priority );
+
+        if ( RTMODE_CountsAllocations() == true )
+        {
+            dprintf( fd,
+                     ", \"steady\": %s, \"allocs\": %" PRIu64,
+                     pRt->armed ? "true" : "false",
+                     pRt->allocs );
+        }
+
+        dprintf( fd, "}" );
+    }
 }
 
 /*============================================================================*/
-/*  PrintUDPTInfo                                                             */
+/*  DumpLoadStats                                                             */
 /*!
-    Print UDP Templating Engine Information
-
-    The PrintUDPTInfo function prints out the operating statistics information
-    for the UDP Templating Engine in response to a varserver print
-    request.
+    Dump the load generator statistics
 
-    @param[in]
-        hVar
-            the handle to the variable associated with the data to print
+    The DumpLoadStats function writes the target and achieved rates of
+    the synthetic load, the number of transmissions sent and still
+    owed, and the process CPU time per transmission to the output file
+    descriptor as a member of a JSON object.  The average rate is over
+    the whole run, including the ramp.
 
     @param[in]
         pState
-            pointer to the UDPTState object containing the info to print
+            pointer to the UDPTState object
 
     @param[in]
         fd
             output file descriptor
 
-    @retval EOK print request notification handled successfully
-    @retval ENOENT print request is not for the specified manifest
-    @retval EINVAL invalid arguments
-
 ==============================================================================*/
-static int PrintUDPTInfo( VAR_HANDLE hVar, UDPTState *pState, int fd )
+static void DumpLoadStats( UDPTState *pState, int fd )
 {
-    int result = EINVAL;
+    LoadGen *pGen = &pState->load;
+    uint64_t now_ns = SCHED_Now();
+    uint64_t elapsed_ns = now_ns - pGen->start_ns;
+    uint64_t average = 0;
 
-    if ( pState != NULL )
+    if ( ( pGen->running == true ) &&
+         ( elapsed_ns > 0 ) )
     {
-        result = DumpStats( pState, fd );
+        average = (uint64_t)( (double)pGen->sent * 1e9 /
+                              (double)elapsed_ns );
     }
 
-    return result;
+    dprintf( fd,
+             ", \"load\": {\"sources\": %zu, \"running\": %s, "
+             "\"target_pps\": %" PRIu64 ", "
+             "\"achieved_pps\": %" PRIu64 ", "
+             "\"average_pps\": %" PRIu64 ", "
+             "\"sent\": %" PRIu64 ", "
+             "\"behind\": %" PRIu64 ", "
+             "\"cpu_ns_per_send\": %" PRIu64 "}",
+             pGen->nSources,
+             pGen->running ? "true" : "false",
+             LOADGEN_Target( pGen, now_ns ),
+             pGen->achieved,
+             average,
+             pGen->sent,
+             LOADGEN_Behind( pGen, now_ns ),
+             pGen->cpuPerSend_ns );
 }
 
 /*============================================================================*/
-/*  SendOutput                                                                */
+/*  DumpTxStampStats                                                          */
 /*!
-    Send output to UDP broadcast targets
+    Dump the transmit timestamp histograms of an interface
 
-    The SendOutput function sends the UDP payload out to the UDP
-    broadcast targets.
+    The DumpTxStampStats function writes the qdisc, device driver and
+    wire latency histograms of an interface to the output file
+    descriptor as members of its JSON object.  Histograms without any
+    samples are omitted.
 
     @param[in]
-        pState
-            pointer to the UDPTState object containing the output to send
+        pIfStats
+            pointer to the interface statistics
 
-    @retval EOK output sent successfully
-    @retval EINVAL invalid arguments
+    @param[in]
+        fd
+            output file descriptor
 
 ==============================================================================*/
-static int SendOutput( UDPTState *pState )
+static void DumpTxStampStats( UDPTIfStats *pIfStats, int fd )
 {
-    int result = EINVAL;
-    char *pMsg;
-    struct ifaddrs *addrs;
-    struct ifaddrs *ifa;
-    int family;
-    int rc;
+    if ( pIfStats->txSched.count > 0 )
+    {
+        dprintf( fd, ", \"tx_sched\": " );
+        HISTOGRAM_Dump( &pIfStats->txSched, fd );
+    }
 
-    if ( pState != NULL )
+    if ( pIfStats->txDriver.count > 0 )
     {
-        /* get a list of the output interfaces */
-        if ( getifaddrs(&addrs) == 0 )
-        {
-            /* default result if no interface was found to send on */
-            result = ENOENT;
+        dprintf( fd, ", \"tx_driver\": " );
+        HISTOGRAM_Dump( &pIfStats->txDriver, fd );
+    }
 
-            ifa = addrs;
-            for ( ifa = addrs; ifa != NULL; ifa = ifa->ifa_next )
-            {
-                if (ifa->ifa_addr == NULL)
-                        continue;
+    if ( pIfStats->txWire.count > 0 )
+    {
+        dprintf( fd, ", \"tx_wire\": " );
+        HISTOGRAM_Dump( &pIfStats->txWire, fd );
+    }
+}
 
-                family = ifa->ifa_addr->sa_family;
+/*============================================================================*/
+/*  DumpChannelStats                                                          */
+/*!
+    Dump the statistics of a channel to the output file descriptor
 
-                /* only broadcast on AF_INET or AF_INET6 interfaces */
-                if ( ( family == AF_INET ) ||
-                     ( family == AF_INET6 ) )
-                {
-                    /* check against the interface allow list */
-                    if ( CheckInterface( pState->interfaceList,
-                                         ifa->ifa_name ) == false )
-                    {
-                        /* not sending on this interface */
-                        continue;
-                    }
+    The DumpChannelStats function writes the configuration and
+    transmission statistics of a channel to the output file descriptor
+    as the members of a JSON object, including the render, send, total
+    transmission time and schedule jitter histograms.
 
-                    /* update the interface we are processing */
-                    UpdateInterfaceIP( pState, ifa );
+    @param[in]
+        pChannel
+            pointer to the channel containing the statistics
 
-                    /* process the template */
-                    result = ProcessTemplate( pState );
-                    if ( result == EOK )
-                    {
-                        /* get a pointer to the rendered template output */
-                        pMsg = VARFP_GetData( pState->pVarFP );
-                        if ( pMsg != NULL )
-                        {
-                            /* send out a UDP message */
-                            rc = SendUDP( family,
-                                        ifa,
-                                        pState->port,
-                                        pMsg,
-                                        strlen( pMsg ) );
-                            if ( rc == EOK )
-                            {
-                                pState->txcount++;
-                            }
-                            else
-                            {
-                                pState->errcount++;
-                            }
-                        }
-                        else
-                        {
-                            pState->errcount++;
-                        }
-                    }
-                    else
-                    {
-                        pState->errcount++;
-                    }
-                }
-            }
+    @param[in]
+        fd
+            output file descriptor
 
-            if ( addrs != NULL )
-            {
-                freeifaddrs(addrs);
-            }
-        }
-        else
-        {
-            result = errno;
-        }
+==============================================================================*/
+static void DumpChannelStats( UDPTChannel *pChannel, int fd )
+{
+    size_t i;
+
+    dprintf( fd, "\"enabled\": \"%s\",", pChannel->enable ? "yes" : "no" );
+    dprintf( fd, "\"port\": %d, ", pChannel->port );
+    dprintf( fd, "\"group\": \"%s\", ", pChannel->groupList );
+    DumpSubscribers( pChannel, fd );
+    dprintf( fd, "\"txrate\": %d, ", pChannel->txrate_s );
+    dprintf( fd, "\"txinterval_us\": %u, ", pChannel->txinterval_us );
+    dprintf( fd, "\"overruns\": %u, ", pChannel->overruns );
+    dprintf( fd, "\"txcount\": %d, ", pChannel->txcount );
+    dprintf( fd, "\"errcount\": %d, ", pChannel->errcount );
+    dprintf( fd, "\"segmented\": %u, ", pChannel->segmented );
+    dprintf( fd,
+             "\"compression\": \"%s\", ",
+             COMPRESS_Name( pChannel->compression ) );
+    dprintf( fd,
+             "\"encoding\": \"%s\", ",
+             ( pChannel->encoding == ENCODING_CBOR ) ? "cbor" : "text" );
+    dprintf( fd, "\"heartbeat\": %u, ", pChannel->heartbeat );
+    dprintf( fd, "\"suppressed\": %u, ", pChannel->suppressed );
+    dprintf( fd, "\"queue_full\": %u, ", pChannel->queueFull );
+    dprintf( fd,
+             "\"onchange\": \"%s\", ",
+             pChannel->onChange ? "yes" : "no" );
+    dprintf( fd, "\"debounce_us\": %u, ", pChannel->debounce_us );
+    dprintf( fd, "\"mininterval_us\": %u, ", pChannel->mininterval_us );
+    dprintf( fd, "\"changes\": %u, ", pChannel->changes );
+    dprintf( fd, "\"change_sends\": %u, ", pChannel->changeSends );
+    dprintf( fd, "\"compressed\": %u, ", pChannel->compressed );
+    dprintf( fd,
+             "\"compress_in\": %llu, ",
+             (unsigned long long)pChannel->compressIn );
+    dprintf( fd,
+             "\"compress_out\": %llu, ",
+             (unsigned long long)pChannel->compressOut );
+    dprintf( fd, "\"ifstats\": [" );
+    for ( i = 0; i < pChannel->nIfStats; i++ )
+    {
+        dprintf( fd,
+                 "%s{\"name\": \"%s\", \"family\": \"%s\", \"txcount\": %u, "
+                 "\"errcount\": %u, \"suppressed\": %u, \"bytes\": %llu, "
+                 "\"deferred\": %u, \"paced_drops\": %u, "
+                 "\"lasterror\": %d",
+                 ( i > 0 ) ? ", " : "",
+                 pChannel->ifStats[i].ifname,
+                 ( pChannel->ifStats[i].family == AF_INET6 ) ? "ipv6"
+                 : ( pChannel->ifStats[i].family == AF_INET ) ? "ipv4"
+                 : "any",
+                 pChannel->ifStats[i].txcount,
+                 pChannel->ifStats[i].errcount,
+                 pChannel->ifStats[i].suppressed,
+                 (unsigned long long)pChannel->ifStats[i].bytes,
+                 pChannel->ifStats[i].deferred,
+                 pChannel->ifStats[i].pacedDrops,
+                 pChannel->ifStats[i].lastError );
+        DumpTxStampStats( &pChannel->ifStats[i], fd );
+        dprintf( fd, "}" );
     }
-
-    return result;
+    dprintf( fd, "], " );
+    dprintf( fd, "\"render\": " );
+    HISTOGRAM_Dump( &pChannel->renderTime, fd );
+    dprintf( fd, ", \"send\": " );
+    HISTOGRAM_Dump( &pChannel->sendTime, fd );
+    dprintf( fd, ", \"tick\": " );
+    HISTOGRAM_Dump( &pChannel->tickTime, fd );
+    dprintf( fd, ", \"jitter\": " );
+    HISTOGRAM_Dump( &pChannel->jitter, fd );
+    dprintf( fd, ", \"interfaces\": \"%s\"", pChannel->interfaceList );
 }
 
 /*============================================================================*/
-/*  UpdateInterfaceIP                                                         */
+/*  cbTrigger                                                                 */
 /*!
-    Update the interface IP address variable
+    Trigger callback
 
-    The UpdateInterfaceIP function gets our IP address on the specified
-    interface and updates the IPAddress varserver variable referenced
-    by hIPAddr.
+    The cbTrigger function is invoked when a channel's hTrigger variable
+    changes.  It causes an on-demand UDP packet broadcast on the channel.
 
     @param[in]
         pState
-            pointer to the UDPTState object containing the varserver variable
-            reference to update
+            pointer to the UDPTState object
 
     @param[in]
-        ifa
-            pointer to an interface address object
-
-    @retval EOK the IP address was successfully updated
-    @retval EINVAL invalid arguments
-    @retval other error from getnameinfo()
+        pChannel
+            pointer to the channel to broadcast
 
 ==============================================================================*/
-static int UpdateInterfaceIP( UDPTState *pState, struct ifaddrs *ifa )
+static int cbTrigger( UDPTState *pState, UDPTChannel *pChannel )
 {
     int result = EINVAL;
-    VarObject obj;
-    char host[NI_MAXHOST];
-    int family;
-    int rc;
 
     if ( ( pState != NULL ) &&
-         ( ifa != NULL ) )
+         ( pChannel != NULL ) )
     {
-        family = ifa->ifa_addr->sa_family;
-
-        /* get our IP address on this interface */
-        rc = getnameinfo(ifa->ifa_addr,
-            (family == AF_INET) ? sizeof(struct sockaddr_in) :
-                                    sizeof(struct sockaddr_in6),
-            host,
-            NI_MAXHOST,
-            NULL,
-            0,
-            NI_NUMERICHOST );
-
-        if (rc == 0)
+        if ( pChannel->enable )
         {
-            /* store the IP address on the varserver variable
-                so it may be included in the packet via the
-                template rendering mechanism */
-            obj.val.str = host;
-            obj.len = strlen( host );
-            obj.type = VARTYPE_STR;
-            result = VAR_Set(pState->hVarServer, pState->hIPAddr, &obj);
+            result = SendOutput( pState, pChannel, false );
         }
         else
         {
-            result = errno;
-            fprintf( stderr, "Failed to get host IP\n");
+            result = EOK;
         }
     }
 
@@ -1475,134 +7708,34 @@ static int UpdateInterfaceIP( UDPTState *pState, struct ifaddrs *ifa )
 }
 
 /*============================================================================*/
-/*  SendUDP                                                                   */
+/*  cbTimer                                                                   */
 /*!
-    Send out a UDP broadcast message
-
-    The SendUDP function sends out a UDP broadcast message on the specified
-    broadcast address.
-
-    @param[in]
-        family
-            interface family
-
-    @param[in]
-        pSockAddr
-            output inet address
+    Transmission rate callback
 
-    @param[in]
-        port
-            output port
+    The cbTimer function is invoked when a channel's hTxRate or
+    hTxInterval variable changes.  It re-schedules the channel's
+    periodic transmission and re-arms the transmission timer.
 
     @param[in]
-        pMsg
-            pointer to the message to send
+        pState
+            pointer to the UDPTState object
 
     @param[in]
-        len
-            length of message to send
-
-    @retval EOK output generated ok
-    @retval EINVAL invalid arguments
-    @retval other error from socket, setsockopt, sendto
+        pChannel
+            pointer to the channel to re-schedule
 
 ==============================================================================*/
-static int SendUDP( int family,
-                    struct ifaddrs *ifa,
-                    int port,
-                    char *pMsg,
-                    size_t len )
+static int cbTimer( UDPTState *pState, UDPTChannel *pChannel )
 {
     int result = EINVAL;
-    int fd;
-    int broadcast = 1;
-    int rc;
-    int addrsize = (family==AF_INET6)
-                 ? sizeof(struct sockaddr_in6)
-                 : sizeof(struct sockaddr_in);
-    struct sockaddr_in broadcast_addr4;
-    struct sockaddr_in6 broadcast_addr6;
-    struct sockaddr *pSockAddr;
 
-    char buf[BUFSIZ];
-
-    if ( ( pMsg != NULL ) &&
-         ( ifa != NULL ) &&
-         ( ifa->ifa_broadaddr != NULL ) &&
-         ( ifa->ifa_addr != NULL ) &&
-         ( port != 0 ))
+    if ( ( pState != NULL ) &&
+         ( pChannel != NULL ) )
     {
-
-        pSockAddr = ifa->ifa_broadaddr;
-
-        /* open a UDP socket */
-        fd = socket( family, SOCK_DGRAM, 0 );
-        if ( fd > 0 )
-        {
-            /* bind the UDP output to a specific interface */
-            BindInterface( fd, ifa );
-
-            /* set up socket to broadcast */
-            if ( setsockopt( fd,
-                             SOL_SOCKET,
-                             SO_BROADCAST,
-                             &broadcast,
-                             sizeof(broadcast)) != -1 )
-            {
-                switch( family )
-                {
-                    case AF_INET:
-                        broadcast_addr4.sin_family = AF_INET;
-                        broadcast_addr4.sin_port = htons(port);
-                        broadcast_addr4.sin_addr =
-                                    ((struct sockaddr_in *)pSockAddr)->sin_addr;
-
-                        /* send out the packet */
-                        rc = sendto( fd,
-                                        pMsg,
-                                        len,
-                                        0,
-                                        &broadcast_addr4,
-                                        sizeof( struct sockaddr_in) );
-                        if ( result != -1 )
-                        {
-                            result = EOK;
-                        }
-                        break;
-
-                    case AF_INET6:
-                        broadcast_addr6.sin6_family = AF_INET6;
-                        broadcast_addr6.sin6_port = port;
-                        broadcast_addr6.sin6_addr =
-                                ((struct sockaddr_in6 *)pSockAddr)->sin6_addr;
-
-                        /* send out the packet */
-                        result = sendto( fd,
-                                        pMsg,
-                                        len,
-                                        0,
-                                        &broadcast_addr6,
-                                        sizeof( struct sockaddr_in6) );
-                        if ( result != -1 )
-                        {
-                            result = EOK;
-                        }
-                        break;
-
-                    default:
-                        result = ENOTSUP;
-                }
-            }
-            else
-            {
-                result = errno;
-            }
-
-            close( fd );
-        }
-        else
+        result = ScheduleChannel( pState, pChannel, SCHED_Now() );
+        if ( result == EOK )
         {
-            result = errno;
+            result = ArmTimer( pState );
         }
     }
 
@@ -1610,263 +7743,244 @@ static int SendUDP( int family,
 }
 
 /*============================================================================*/
-/*  BindInterface                                                             */
+/*  cbInterfaces                                                              */
 /*!
-    Bind a socket to a specific interface
+    Interface list callback
 
-    The BindInterface function binds a socket to a specific interface so that
-    any output on that socket is sent only on the specifically bound interface.
-    This function is platform specific and currently only implemented for
-    Linux.
+    The cbInterfaces function is invoked when a channel's hInterfaceList
+    variable changes.  It compiles the new allow-list, and closes all of
+    the cached interface sockets so they are re-created for the new
+    allow-list on the next transmission.
 
     @param[in]
-        s
-            interface family
+        pState
+            pointer to the UDPTState object
 
     @param[in]
-        ifa
-            pointer to the interface address info
+        pChannel
+            pointer to the channel whose interface list changed
 
-    @retval EOK output generated ok
-    @retval EINVAL invalid arguments
-    @retval other error from socket, setsockopt, sendto
+    @retval EOK the interface list was applied
+    @retval other error from IFSET_Parse
 
 ==============================================================================*/
-static int BindInterface( int s, struct ifaddrs *ifa )
+static int cbInterfaces( UDPTState *pState, UDPTChannel *pChannel )
 {
     int result = EINVAL;
 
-    if ( ( s > 0 ) &&
-         ( ifa != NULL ) &&
-         ( ifa->ifa_name != NULL ) )
+    if ( ( pState != NULL ) &&
+         ( pChannel != NULL ) )
     {
-#ifdef __linux__
-        struct ifreq ifr;
-        int rc;
+        /* the sender thread may still be using the sockets */
+        WaitSender( pState );
 
-        memset(&ifr, 0, sizeof(ifr));
-        snprintf(ifr.ifr_name, sizeof(ifr.ifr_name), "%s", ifa->ifa_name);
+        SOCKCACHE_Flush( &pState->sockCache );
 
-        rc = setsockopt( s,
-                         SOL_SOCKET,
-                         SO_BINDTODEVICE,
-                         (void *)&ifr,
-                         sizeof(ifr) );
-        if ( rc == 0 )
-        {
-            result = EOK;
-        }
-        else
-        {
-            result = errno;
-        }
-#else
-        result = ENOTSUP;
-#endif
+        result = IFSET_Parse( &pChannel->allowed, pChannel->interfaceList );
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  CheckInterface                                                            */
+/*  cbTemplate                                                                */
 /*!
-    Check if we can send a packet on the specified interface
-
-    The CheckInterface function checks if we are allowed to send a packet
-    on the specified interface.  There are two conditions where sending is
-    allowed:
+    Template callback
 
-    1.  The interfaces list is empty
-    2.  The interface name is found in the comma separated interface list
+    The cbTemplate function is invoked when a channel's hTemplate variable
+    changes.  It releases the channel's previous template and gets the
+    compiled form of the new template file, compiling it if no other
+    channel is already using it, so it is ready to be rendered on the
+    next transmission.  If the channel is change-triggered, the
+    variables referenced by the new template are subscribed to.
 
     @param[in]
-        interfaces
-            pointer to a comma separated string of interface names
+        pState
+            pointer to the UDPTState object
 
     @param[in]
-        interface
-            the name of the interface we are checking for
-
-    @retval true - we are allowed to send on the specified interface
-    @retval false - we are not allowed to send on the specified interface
+        pChannel
+            pointer to the channel whose template changed
 
 ==============================================================================*/
-static bool CheckInterface( const char *interfaces, const char *interface )
+static int cbTemplate( UDPTState *pState, UDPTChannel *pChannel )
 {
-    char interfaceList[INTERFACE_LIST_LEN];
-    char *saveptr = NULL;
-    char *token;
-    bool sendOK = false;
+    int result = EINVAL;
 
-    if ( ( interfaces != NULL ) &&
-         ( interface != NULL ) )
+    if ( ( pState != NULL ) &&
+         ( pChannel != NULL ) )
     {
-        if ( strlen( interfaces ) == 0 )
-        {
-            /* we are allowed to send on any interface if the interfaces
-               list is empty */
-            sendOK = true;
-        }
-        else
-        {
-            /* make a mutable copy of the interface list */
-            strcpy( interfaceList, interfaces );
+        ReleaseTemplate( pChannel->pTemplate );
 
-            /* check if the interface is in the interface list */
-            for (token = strtok_r(interfaceList, ",", &saveptr);
-                token != NULL;
-                token = strtok_r(NULL, ",", &saveptr))
-            {
-                /* check if we have an interface name match */
-                if ( strcmp( token, interface ) == 0 )
-                {
-                    /* we have a match - it is ok to send on this interface */
-                    sendOK = true;
-                    break;
-                }
-            }
-        }
+        pChannel->pTemplate = AcquireTemplate( pState,
+                                               pChannel->templateFilename );
+
+        result = ( ( pChannel->pTemplate != NULL ) &&
+                   ( pChannel->pTemplate->compiled.valid == true ) )
+                 ? SubscribeTemplate( pState, pChannel )
+                 : ENOENT;
     }
 
-    return sendOK;
+    return result;
 }
 
 /*============================================================================*/
-/*  DumpStats                                                                 */
+/*  cbCompression                                                             */
 /*!
-    Dump the UDPT statistics to the output file descriptor
+    Compression callback
 
-    The DumpStats function writes the UDPT statistics
-    to the output file descriptor as a JSON object.
+    The cbCompression function is invoked when a channel's hCompression
+    variable changes.  It checks the selected compression algorithm is
+    available.  Payloads are sent uncompressed if it is not.
 
     @param[in]
         pState
-            pointer to the UDPTState containing the statistics
+            pointer to the UDPTState object
 
     @param[in]
-        fd
-            output file descriptor
+        pChannel
+            pointer to the channel whose compression setting changed
 
-    @retval EOK output generated ok
+    @retval EOK the compression algorithm is available
+    @retval ENOTSUP the compression algorithm is not available
     @retval EINVAL invalid arguments
 
 ==============================================================================*/
-static int DumpStats( UDPTState *pState, int fd )
+static int cbCompression( UDPTState *pState, UDPTChannel *pChannel )
 {
     int result = EINVAL;
-    char timestr[128];
-    time_t duration;
-
-    /* write the opening brace */
-    dprintf( fd, "{" );
 
-    if ( pState != NULL )
+    if ( ( pState != NULL ) &&
+         ( pChannel != NULL ) )
     {
-        dprintf( fd, "\"enabled\": \"%s\",", pState->enable ? "yes" : "no" );
-        dprintf( fd, "\"port\": %d, ", pState->port );
-        dprintf( fd, "\"txrate\": %d, ", pState->txrate_s );
-        dprintf( fd, "\"txcount\": %d, ", pState->txcount );
-        dprintf( fd, "\"errcount\": %d, ", pState->errcount );
-        dprintf( fd, "\"interfaces\":, \"%s\" ", pState->interfaceList );
         result = EOK;
-    }
 
-    /* write the closing brace */
-    dprintf(fd, "}" );
+        if ( COMPRESS_IsSupported( pChannel->compression ) == false )
+        {
+            fprintf( stderr,
+                     "Compression %d (%s) is not available\n",
+                     pChannel->compression,
+                     COMPRESS_Name( pChannel->compression ) );
+            result = ENOTSUP;
+        }
+    }
 
     return result;
 }
 
 /*============================================================================*/
-/*  Output                                                                    */
+/*  cbOnChange                                                                */
 /*!
-    Output a buffer to an output file descriptor
+    Change-triggered transmission callback
 
-    The Output function wraps the write() system call and performs
-    error checking.
+    The cbOnChange function is invoked when a channel's hOnChange
+    variable changes.  When change-triggered transmission is enabled,
+    the variables referenced by the channel's template are subscribed
+    to.  When it is disabled, any pending change-triggered transmission
+    is cancelled.
 
     @param[in]
-        fd
-            output file descriptor
+        pState
+            pointer to the UDPTState object
 
     @param[in]
-        buf
-            pointer to output buffer
+        pChannel
+            pointer to the channel whose setting changed
 
-    @param[in]
-        len
-            number of bytes to write
+    @retval EOK the setting was applied
+    @retval ENOENT no valid template is available
+    @retval EINVAL invalid arguments
 
 ==============================================================================*/
-static void Output( int fd, char *buf, size_t len )
+static int cbOnChange( UDPTState *pState, UDPTChannel *pChannel )
 {
-    int n;
+    int result = EINVAL;
 
-    if ( ( buf != NULL ) &&
-         ( fd != -1 ) &&
-         ( len > 0 ) )
+    if ( ( pState != NULL ) &&
+         ( pChannel != NULL ) )
     {
-        n = write( fd, buf, len );
-        if ( (size_t)n != len )
+        if ( pChannel->onChange != 0 )
+        {
+            result = SubscribeTemplate( pState, pChannel );
+        }
+        else
         {
-            fprintf( stderr, "write failed\n" );
+            if ( pChannel->changePending == true )
+            {
+                (void)SCHED_Remove( &pState->changeSchedule, pChannel );
+                pChannel->changePending = false;
+            }
+
+            result = EOK;
         }
     }
+
+    return result;
 }
 
 /*============================================================================*/
-/*  cbTrigger                                                                 */
+/*  cbGroup                                                                   */
 /*!
-    Trigger callback
+    Multicast group callback
 
-    The cbTrigger function is invoked when the hTrigger variable changes.
-    It causes an on-demand UDP packet broadcast
+    The cbGroup function is invoked when a channel's hGroup variable
+    changes.  It parses the new multicast group list, which switches
+    the channel between broadcast and multicast transmission from the
+    next transmission.
 
     @param[in]
         pState
             pointer to the UDPTState object
 
+    @param[in]
+        pChannel
+            pointer to the channel whose multicast groups changed
+
+    @retval EOK the multicast group list was applied
+    @retval EINVAL the list contains an invalid multicast group
+
 ==============================================================================*/
-static int cbTrigger( UDPTState *pState )
+static int cbGroup( UDPTState *pState, UDPTChannel *pChannel )
 {
-    int result = EINVAL;
-
-    if ( pState != NULL )
-    {
-        if ( pState->enable == true )
-        {
-            result = SendOutput( pState );
-        }
-        else
-        {
-            result = EOK;
-        }
-    }
+    (void)pState;
 
-    return result;
+    return ParseGroups( pChannel );
 }
 
 /*============================================================================*/
-/*  cbTrigger                                                                 */
+/*  cbSubscribers                                                             */
 /*!
-    Trigger callback
+    Subscriber list callback
 
-    The cbTrigger function is invoked when the hTrigger variable changes.
-    It causes an on-demand UDP packet broadcast
+    The cbSubscribers function is invoked when a channel's hSubscribers
+    variable changes.  It parses the new unicast subscriber list.  When
+    the list is not empty, the channel is sent to the subscribers
+    instead of the interfaces from the next transmission.
 
     @param[in]
         pState
             pointer to the UDPTState object
 
+    @param[in]
+        pChannel
+            pointer to the channel whose subscriber list changed
+
+    @retval EOK the subscriber list was applied
+    @retval other error from SUBLIST_Parse
+
 ==============================================================================*/
-static int cbTimer( UDPTState *pState )
+static int cbSubscribers( UDPTState *pState, UDPTChannel *pChannel )
 {
     int result = EINVAL;
 
-    if ( pState != NULL )
+    if ( ( pState != NULL ) &&
+         ( pChannel != NULL ) )
     {
-        result = SetupTimer( pState );
+        /* the sender thread may still be sending to the old list */
+        WaitSender( pState );
+
+        result = SUBLIST_Parse( &pChannel->subscribers,
+                                pChannel->subscriberSpec );
     }
 
     return result;
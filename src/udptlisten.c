@@ -0,0 +1,2232 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup udptlisten UDP Template Receiver
+ * @brief Receive UDP template payloads and apply them to variables
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file udptlisten.c
+
+    UDP Template Receiver
+
+    The udpt-listen application is the companion receiver of udpt.  It
+    binds to the udpt port and drains the received datagrams in batches
+    using recvmmsg().  Segmented payloads are reassembled, compressed
+    payloads are decompressed, and the values they carry are written to
+    the variable server through a name to handle cache.
+
+    Text payloads are matched against the same templates the senders
+    use, so any template format can be received, and the values of the
+    variable references are written to the referenced variables.
+    Without a template, text payloads are parsed as a flat JSON object
+    of variable names and values.  CBOR payloads are matched to their
+    template by its schema identifier.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <math.h>
+#include <float.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#include <varserver/varserver.h>
+#include "ctemplate.h"
+#include "compress.h"
+#include "udptmsg.h"
+#include "reasm.h"
+#include "varcache.h"
+#include "txsched.h"
+#include "hash.h"
+#include "cbor.h"
+#include "jsonobj.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+#ifndef LISTEN_BATCH
+/*! maximum number of datagrams received with one recvmmsg() call */
+#define LISTEN_BATCH ( 64 )
+#endif
+
+#ifndef LISTEN_DATAGRAM_SIZE
+/*! size of the receive buffer of each datagram */
+#define LISTEN_DATAGRAM_SIZE ( 65536 )
+#endif
+
+#ifndef LISTEN_MAX_TEMPLATES
+/*! maximum number of templates the payloads are matched against */
+#define LISTEN_MAX_TEMPLATES ( 16 )
+#endif
+
+#ifndef LISTEN_MAX_GROUPS
+/*! maximum number of multicast groups to join */
+#define LISTEN_MAX_GROUPS ( 8 )
+#endif
+
+#ifndef LISTEN_CACHE_REFRESH_NS
+/*! interval at which the variable cache is cleared to pick up new
+    variables */
+#define LISTEN_CACHE_REFRESH_NS ( 10000000000ULL )
+#endif
+
+#ifndef LISTEN_VALUE_SIZE
+/*! maximum length of a received value */
+#define LISTEN_VALUE_SIZE ( 1024 )
+#endif
+
+/*! receive timeout, so the statistics and cache refresh are serviced
+    while no datagrams arrive */
+#define LISTEN_RECV_TIMEOUT_S ( 1 )
+
+/*! ancillary data buffer of a received datagram, aligned for struct
+    cmsghdr */
+typedef union _listenControl
+{
+    /*! ancillary data holding the SO_RXQ_OVFL drop counter */
+    char buf[CMSG_SPACE( sizeof( uint32_t ) )];
+
+    /*! alignment of the ancillary data */
+    struct cmsghdr align;
+
+} ListenControl;
+
+/*! template the received payloads are matched against */
+typedef struct _listenTemplate
+{
+    /*! name of the template file */
+    char *filename;
+
+    /*! compiled template */
+    CompiledTemplate compiled;
+
+    /*! decompressor using the template's static text as its dictionary */
+    Compressor compressor;
+
+    /*! values of the variable references of the last matched payload */
+    CborItem *pValues;
+
+} ListenTemplate;
+
+/*! receiver counters */
+typedef struct _listenStats
+{
+    /*! number of datagrams received */
+    uint64_t datagrams;
+
+    /*! number of segment datagrams received */
+    uint64_t segments;
+
+    /*! number of complete payloads which were parsed */
+    uint64_t payloads;
+
+    /*! number of compressed payloads */
+    uint64_t compressed;
+
+    /*! number of CBOR payloads */
+    uint64_t cbor;
+
+    /*! number of text payloads */
+    uint64_t text;
+
+    /*! number of values received */
+    uint64_t values;
+
+    /*! number of values written to their variables */
+    uint64_t written;
+
+    /*! number of values not written because they were unchanged */
+    uint64_t unchanged;
+
+    /*! number of values for variables which do not exist */
+    uint64_t unknown;
+
+    /*! number of values which could not be converted or written */
+    uint64_t setErrors;
+
+    /*! number of payloads which could not be parsed */
+    uint64_t parseErrors;
+
+    /*! number of payloads with an unknown schema or dictionary */
+    uint64_t unknownSchema;
+
+    /*! number of datagrams dropped by the kernel (SO_RXQ_OVFL) */
+    uint32_t drops;
+
+} ListenStats;
+
+/*! UDP template receiver state */
+typedef struct _listenState
+{
+    /*! variable server handle */
+    VARSERVER_HANDLE hVarServer;
+
+    /*! port to receive on */
+    uint16_t port;
+
+    /*! local address to bind to, or NULL for any address */
+    char *bindAddr;
+
+    /*! multicast groups to join */
+    char *groups[LISTEN_MAX_GROUPS];
+
+    /*! number of multicast groups to join */
+    size_t nGroups;
+
+    /*! socket receive buffer size, or 0 for the system default */
+    int rcvbuf;
+
+    /*! prefix added to the received variable names, or NULL */
+    char *prefix;
+
+    /*! templates the payloads are matched against */
+    ListenTemplate templates[LISTEN_MAX_TEMPLATES];
+
+    /*! number of templates */
+    size_t nTemplates;
+
+    /*! decompressor for payloads compressed without a dictionary */
+    Compressor plain;
+
+    /*! receive socket */
+    int fd;
+
+    /*! message headers passed to recvmmsg() */
+    struct mmsghdr msgs[LISTEN_BATCH];
+
+    /*! datagram buffer vectors */
+    struct iovec iov[LISTEN_BATCH];
+
+    /*! datagram source addresses */
+    struct sockaddr_storage addr[LISTEN_BATCH];
+
+    /*! ancillary data of each datagram */
+    ListenControl control[LISTEN_BATCH];
+
+    /*! datagram buffers */
+    char *pBuffers;
+
+    /*! decompressed payload buffer */
+    char *pPayload;
+
+    /*! parser of the JSON object payloads */
+    JsonObject json;
+
+    /*! segment reassembler */
+    Reasm reasm;
+
+    /*! variable name to handle cache */
+    VarCache cache;
+
+    /*! interval between statistics reports in seconds, or 0 for none */
+    uint32_t statsInterval_s;
+
+    /*! write every received value, even if it is unchanged */
+    bool writeAll;
+
+    /*! parse the payloads without writing the values */
+    bool dryRun;
+
+    /*! print every value written */
+    bool verbose;
+
+    /*! receiver counters */
+    ListenStats stats;
+
+} ListenState;
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! UDP template receiver state object */
+static ListenState state;
+
+/*! indicates the receiver should keep running */
+static volatile sig_atomic_t running = 1;
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static void usage( char *cmdname );
+static int ProcessOptions( int argC, char *argV[], ListenState *pState );
+static int ParseUnsigned( const char *text,
+                          unsigned long max,
+                          unsigned long *pValue );
+static void SetupTerminationHandler( void );
+static void TerminationHandler( int signum, siginfo_t *info, void *ptr );
+static int SetupTemplates( ListenState *pState );
+static int SetupSocket( ListenState *pState );
+static int JoinGroup( int fd, const char *group );
+static int SetupBuffers( ListenState *pState );
+static void Run( ListenState *pState );
+static void ReadDrops( ListenState *pState, struct msghdr *pHdr );
+static void ProcessDatagram( ListenState *pState,
+                             const struct sockaddr *pSource,
+                             const char *pBuf,
+                             size_t len );
+static int ProcessPayload( ListenState *pState,
+                           const char *pBuf,
+                           size_t len,
+                           bool allowCompressed );
+static int Decompress( ListenState *pState, const char *pBuf, size_t len );
+static int DecodeCBOR( ListenState *pState, const char *pBuf, size_t len );
+static int MatchText( ListenTemplate *pTemplate,
+                      const char *pBuf,
+                      size_t len );
+static void ApplyValues( ListenState *pState, ListenTemplate *pTemplate );
+static int ParseJSON( ListenState *pState, const char *pBuf, size_t len );
+static void SetValue( ListenState *pState,
+                      const char *name,
+                      size_t nameLen,
+                      const CborItem *pItem );
+static int Convert( VarType type,
+                    const CborItem *pItem,
+                    VarObject *pObj,
+                    char *pStr,
+                    size_t size );
+static void DumpStats( ListenState *pState, FILE *fp );
+static void Cleanup( ListenState *pState );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  main                                                                      */
+/*!
+    Main entry point for the UDP template receiver
+
+    The main function starts the UDP template receiver
+
+    @param[in]
+        argc
+            number of arguments on the command line
+            (including the command itself)
+
+    @param[in]
+        argv
+            array of pointers to the command line arguments
+
+    @return 0 if the receiver ran, 1 if it could not be set up
+
+==============================================================================*/
+int main( int argc, char **argv )
+{
+    int result;
+
+    memset( &state, 0, sizeof( state ) );
+    state.fd = -1;
+    COMPRESS_Init( &state.plain );
+
+    result = ProcessOptions( argc, argv, &state );
+    if ( result != EOK )
+    {
+        usage( argv[0] );
+    }
+    else
+    {
+        SetupTerminationHandler();
+
+        if ( state.dryRun == false )
+        {
+            state.hVarServer = VARSERVER_Open();
+            if ( state.hVarServer == NULL )
+            {
+                fprintf( stderr,
+                         "udpt-listen: unable to open variable server\n" );
+                result = ENOTCONN;
+            }
+        }
+
+        if ( result == EOK )
+        {
+            result = SetupTemplates( &state );
+        }
+
+        if ( result == EOK )
+        {
+            result = SetupBuffers( &state );
+        }
+
+        if ( result == EOK )
+        {
+            result = SetupSocket( &state );
+        }
+
+        if ( result == EOK )
+        {
+            Run( &state );
+            DumpStats( &state, stdout );
+        }
+        else
+        {
+            fprintf( stderr,
+                     "udpt-listen: setup failed: %s\n",
+                     strerror( result ) );
+        }
+    }
+
+    Cleanup( &state );
+
+    return ( result == EOK ) ? 0 : 1;
+}
+
+/*============================================================================*/
+/*  usage                                                                     */
+/*!
+    Display the application usage
+
+    The usage function dumps the application usage message
+    to stderr.
+
+    @param[in]
+       cmdname
+            pointer to the invoked command name
+
+    @return none
+
+==============================================================================*/
+static void usage( char *cmdname )
+{
+    if ( cmdname != NULL )
+    {
+        fprintf( stderr,
+                 "usage: %s -p port [-h] [-f template] [-b address] "
+                 "[-o group] [-P prefix] [-r rcvbuf] [-s interval] "
+                 "[-d] [-w] [-v]\n"
+                 " [-p] : UDP port to receive on\n"
+                 " [-f] : template the payloads are rendered from "
+                 "(may be repeated)\n"
+                 " [-b] : local address to bind to\n"
+                 " [-o] : multicast group to join (may be repeated)\n"
+                 " [-P] : prefix added to the received variable names\n"
+                 " [-r] : socket receive buffer size (bytes)\n"
+                 " [-s] : statistics report interval (seconds)\n"
+                 " [-d] : parse the payloads without writing the values\n"
+                 " [-w] : write every value, even if it is unchanged\n"
+                 " [-v] : print every value written\n"
+                 " [-h] : display this help\n",
+                 cmdname );
+    }
+}
+
+/*============================================================================*/
+/*  ProcessOptions                                                            */
+/*!
+    Process the command line options
+
+    The ProcessOptions function processes the command line options and
+    populates the ListenState object
+
+    @param[in]
+        argC
+            number of arguments
+            (including the command itself)
+
+    @param[in]
+        argv
+            array of pointers to the command line arguments
+
+    @param[in]
+        pState
+            pointer to the receiver state
+
+    @retval EOK the options were processed
+    @retval EINVAL invalid options, or no port was specified
+    @retval ENOSPC too many templates or multicast groups
+
+==============================================================================*/
+static int ProcessOptions( int argC, char *argV[], ListenState *pState )
+{
+    int c;
+    int result = EINVAL;
+    const char *options = "hp:f:b:o:P:r:s:dwv";
+    unsigned long value;
+
+    if ( ( pState != NULL ) &&
+         ( argV != NULL ) )
+    {
+        result = EOK;
+
+        while ( ( c = getopt( argC, argV, options ) ) != -1 )
+        {
+            switch ( c )
+            {
+                case 'p':
+                    if ( ( ParseUnsigned( optarg, 65535, &value ) != EOK ) ||
+                         ( value == 0 ) )
+                    {
+                        fprintf( stderr, "Invalid port: %s\n", optarg );
+                        result = EINVAL;
+                    }
+                    else
+                    {
+                        pState->port = (uint16_t)value;
+                    }
+                    break;
+
+                case 'f':
+                    if ( pState->nTemplates < LISTEN_MAX_TEMPLATES )
+                    {
+                        pState->templates[pState->nTemplates++].filename =
+                            strdup( optarg );
+                    }
+                    else
+                    {
+                        fprintf( stderr, "Too many templates: %s\n", optarg );
+                        result = ENOSPC;
+                    }
+                    break;
+
+                case 'b':
+                    pState->bindAddr = strdup( optarg );
+                    break;
+
+                case 'o':
+                    if ( pState->nGroups < LISTEN_MAX_GROUPS )
+                    {
+                        pState->groups[pState->nGroups++] = strdup( optarg );
+                    }
+                    else
+                    {
+                        fprintf( stderr, "Too many groups: %s\n", optarg );
+                        result = ENOSPC;
+                    }
+                    break;
+
+                case 'P':
+                    pState->prefix = strdup( optarg );
+                    break;
+
+                case 'r':
+                    if ( ParseUnsigned( optarg, INT_MAX, &value ) != EOK )
+                    {
+                        fprintf( stderr,
+                                 "Invalid receive buffer size: %s\n",
+                                 optarg );
+                        result = EINVAL;
+                    }
+                    else
+                    {
+                        pState->rcvbuf = (int)value;
+                    }
+                    break;
+
+                case 's':
+                    if ( ParseUnsigned( optarg, UINT32_MAX, &value ) != EOK )
+                    {
+                        fprintf( stderr,
+                                 "Invalid statistics interval: %s\n",
+                                 optarg );
+                        result = EINVAL;
+                    }
+                    else
+                    {
+                        pState->statsInterval_s = (uint32_t)value;
+                    }
+                    break;
+
+                case 'd':
+                    pState->dryRun = true;
+                    break;
+
+                case 'w':
+                    pState->writeAll = true;
+                    break;
+
+                case 'v':
+                    pState->verbose = true;
+                    break;
+
+                case 'h':
+                default:
+                    result = EINVAL;
+                    break;
+            }
+        }
+
+        if ( pState->port == 0 )
+        {
+            result = EINVAL;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseUnsigned                                                             */
+/*!
+    Parse an unsigned option value
+
+    The ParseUnsigned function parses a decimal, hexadecimal or octal
+    option value, which must be a whole number no larger than the
+    specified maximum, with nothing following it.
+
+    @param[in]
+        text
+            pointer to the option value
+
+    @param[in]
+        max
+            largest valid value
+
+    @param[out]
+        pValue
+            pointer to the location to store the value
+
+    @retval EOK the value was parsed
+    @retval EINVAL the value is not a number or is out of range
+
+==============================================================================*/
+static int ParseUnsigned( const char *text,
+                          unsigned long max,
+                          unsigned long *pValue )
+{
+    int result = EINVAL;
+    char *pEnd = NULL;
+    unsigned long value;
+
+    errno = 0;
+    value = strtoul( text, &pEnd, 0 );
+    if ( ( errno == 0 ) &&
+         ( pEnd != text ) &&
+         ( *pEnd == '\0' ) &&
+         ( text[0] != '-' ) &&
+         ( value <= max ) )
+    {
+        *pValue = value;
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupTerminationHandler                                                   */
+/*!
+    Set up a termination handler
+
+    The SetupTerminationHandler function registers a termination handler
+    so the receiver can report its statistics and clean up when it is
+    stopped.  SA_RESTART is not used, so recvmmsg() is interrupted.
+
+==============================================================================*/
+static void SetupTerminationHandler( void )
+{
+    static struct sigaction sigact;
+
+    memset( &sigact, 0, sizeof(sigact) );
+
+    sigact.sa_sigaction = TerminationHandler;
+    sigact.sa_flags = SA_SIGINFO;
+
+    sigaction( SIGTERM, &sigact, NULL );
+    sigaction( SIGINT, &sigact, NULL );
+}
+
+/*============================================================================*/
+/*  TerminationHandler                                                        */
+/*!
+    Termination handler
+
+    The TerminationHandler function stops the receive loop.
+
+    @param[in]
+        signum
+            The signal which caused the termination (unused)
+
+    @param[in]
+        info
+            pointer to a siginfo_t object (unused)
+
+    @param[in]
+        ptr
+            signal context information (ucontext_t) (unused)
+
+==============================================================================*/
+static void TerminationHandler( int signum, siginfo_t *info, void *ptr )
+{
+    /* signum, info, and ptr are unused */
+    (void)signum;
+    (void)info;
+    (void)ptr;
+
+    running = 0;
+}
+
+/*============================================================================*/
+/*  SetupTemplates                                                            */
+/*!
+    Compile the templates the payloads are matched against
+
+    The SetupTemplates function compiles every template specified with
+    the -f option, and sets its static text as the dictionary of its
+    decompressor, in the same way as udpt builds its compression
+    dictionary.
+
+    @param[in]
+        pState
+            pointer to the receiver state
+
+    @retval EOK the templates were compiled
+    @retval ENOMEM memory allocation failed
+    @retval other error from CTEMPLATE_Compile
+
+==============================================================================*/
+static int SetupTemplates( ListenState *pState )
+{
+    int result = EOK;
+    ListenTemplate *pTemplate;
+    char *pText;
+    size_t len;
+    size_t i;
+
+    for ( i = 0; ( i < pState->nTemplates ) && ( result == EOK ); i++ )
+    {
+        pTemplate = &pState->templates[i];
+        COMPRESS_Init( &pTemplate->compressor );
+
+        result = ( pTemplate->filename != NULL ) ? EOK : ENOMEM;
+        if ( result == EOK )
+        {
+            result = CTEMPLATE_Compile( &pTemplate->compiled,
+                                        pState->hVarServer,
+                                        pTemplate->filename );
+            if ( result != EOK )
+            {
+                fprintf( stderr,
+                         "udpt-listen: unable to compile %s: %s\n",
+                         pTemplate->filename,
+                         strerror( result ) );
+            }
+        }
+
+        if ( result == EOK )
+        {
+            pTemplate->pValues = calloc( pTemplate->compiled.nVars + 1,
+                                         sizeof( CborItem ) );
+
+            /* the static text is never longer than the template */
+            pText = malloc( pTemplate->compiled.textLen + 1 );
+            result = ( ( pTemplate->pValues != NULL ) && ( pText != NULL ) )
+                     ? EOK
+                     : ENOMEM;
+            if ( result == EOK )
+            {
+                len = CTEMPLATE_GetStaticText( &pTemplate->compiled,
+                                               pText,
+                                               pTemplate->compiled.textLen );
+                result = COMPRESS_SetDictionary( &pTemplate->compressor,
+                                                 pText,
+                                                 len );
+            }
+
+            free( pText );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupSocket                                                               */
+/*!
+    Set up the receive socket
+
+    The SetupSocket function opens a dual-stack UDP socket, or an IPv4
+    socket if IPv6 is not available or an IPv4 bind address is given,
+    binds it to the receive port and joins the multicast groups.  The
+    socket reports the number of datagrams dropped by the kernel with
+    every datagram (SO_RXQ_OVFL).
+
+    @param[in]
+        pState
+            pointer to the receiver state
+
+    @retval EOK the socket was set up
+    @retval other error from socket, bind or getaddrinfo
+
+==============================================================================*/
+static int SetupSocket( ListenState *pState )
+{
+    int result = EOK;
+    struct sockaddr_storage addr;
+    struct sockaddr_in *pAddr4 = (struct sockaddr_in *)&addr;
+    struct sockaddr_in6 *pAddr6 = (struct sockaddr_in6 *)&addr;
+    struct addrinfo hints;
+    struct addrinfo *pInfo = NULL;
+    struct timeval tv;
+    socklen_t addrlen;
+    int family = AF_INET6;
+    int one = 1;
+    int zero = 0;
+    int rc;
+    size_t i;
+
+    memset( &addr, 0, sizeof( addr ) );
+
+    if ( pState->bindAddr != NULL )
+    {
+        memset( &hints, 0, sizeof( hints ) );
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_DGRAM;
+        hints.ai_flags = AI_PASSIVE | AI_NUMERICHOST;
+
+        rc = getaddrinfo( pState->bindAddr, NULL, &hints, &pInfo );
+        if ( rc == 0 )
+        {
+            memcpy( &addr, pInfo->ai_addr, pInfo->ai_addrlen );
+            family = pInfo->ai_family;
+            freeaddrinfo( pInfo );
+        }
+        else
+        {
+            fprintf( stderr,
+                     "udpt-listen: invalid address %s: %s\n",
+                     pState->bindAddr,
+                     gai_strerror( rc ) );
+            result = EINVAL;
+        }
+    }
+
+    if ( result == EOK )
+    {
+        pState->fd = socket( family, SOCK_DGRAM | SOCK_CLOEXEC, 0 );
+        if ( ( pState->fd == -1 ) &&
+             ( family == AF_INET6 ) &&
+             ( pState->bindAddr == NULL ) )
+        {
+            /* IPv6 is not available */
+            family = AF_INET;
+            pState->fd = socket( family, SOCK_DGRAM | SOCK_CLOEXEC, 0 );
+        }
+
+        if ( pState->fd == -1 )
+        {
+            result = errno;
+        }
+    }
+
+    if ( result == EOK )
+    {
+        if ( family == AF_INET6 )
+        {
+            /* receive IPv4 datagrams as well */
+            (void)setsockopt( pState->fd,
+                              IPPROTO_IPV6,
+                              IPV6_V6ONLY,
+                              &zero,
+                              sizeof( zero ) );
+            pAddr6->sin6_family = AF_INET6;
+            pAddr6->sin6_port = htons( pState->port );
+            addrlen = sizeof( struct sockaddr_in6 );
+        }
+        else
+        {
+            pAddr4->sin_family = AF_INET;
+            pAddr4->sin_port = htons( pState->port );
+            addrlen = sizeof( struct sockaddr_in );
+        }
+
+        (void)setsockopt( pState->fd,
+                          SOL_SOCKET,
+                          SO_REUSEADDR,
+                          &one,
+                          sizeof( one ) );
+        (void)setsockopt( pState->fd,
+                          SOL_SOCKET,
+                          SO_RXQ_OVFL,
+                          &one,
+                          sizeof( one ) );
+
+        tv.tv_sec = LISTEN_RECV_TIMEOUT_S;
+        tv.tv_usec = 0;
+        (void)setsockopt( pState->fd,
+                          SOL_SOCKET,
+                          SO_RCVTIMEO,
+                          &tv,
+                          sizeof( tv ) );
+
+        if ( pState->rcvbuf > 0 )
+        {
+            /* SO_RCVBUFFORCE can exceed rmem_max if we are privileged */
+            if ( setsockopt( pState->fd,
+                             SOL_SOCKET,
+                             SO_RCVBUFFORCE,
+                             &pState->rcvbuf,
+                             sizeof( pState->rcvbuf ) ) != 0 )
+            {
+                (void)setsockopt( pState->fd,
+                                  SOL_SOCKET,
+                                  SO_RCVBUF,
+                                  &pState->rcvbuf,
+                                  sizeof( pState->rcvbuf ) );
+            }
+        }
+
+        if ( bind( pState->fd, (struct sockaddr *)&addr, addrlen ) != 0 )
+        {
+            result = errno;
+            fprintf( stderr,
+                     "udpt-listen: unable to bind port %u: %s\n",
+                     pState->port,
+                     strerror( result ) );
+        }
+    }
+
+    for ( i = 0; ( i < pState->nGroups ) && ( result == EOK ); i++ )
+    {
+        result = JoinGroup( pState->fd, pState->groups[i] );
+        if ( result != EOK )
+        {
+            fprintf( stderr,
+                     "udpt-listen: unable to join %s: %s\n",
+                     pState->groups[i],
+                     strerror( result ) );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  JoinGroup                                                                 */
+/*!
+    Join a multicast group
+
+    The JoinGroup function joins an IPv4 or IPv6 multicast group on the
+    default interface.  IPv4 groups are joined at the IPv4 level, which
+    a dual-stack socket passes on to its IPv4 side.
+
+    @param[in]
+        fd
+            receive socket
+
+    @param[in]
+        group
+            numeric multicast group address
+
+    @retval EOK the group was joined
+    @retval EINVAL the group is not a numeric address
+    @retval other error from setsockopt
+
+==============================================================================*/
+static int JoinGroup( int fd, const char *group )
+{
+    int result = EINVAL;
+    struct addrinfo hints;
+    struct addrinfo *pInfo = NULL;
+    struct group_req req;
+
+    memset( &hints, 0, sizeof( hints ) );
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = AI_NUMERICHOST;
+
+    if ( getaddrinfo( group, NULL, &hints, &pInfo ) == 0 )
+    {
+        memset( &req, 0, sizeof( req ) );
+        req.gr_interface = 0;
+        memcpy( &req.gr_group, pInfo->ai_addr, pInfo->ai_addrlen );
+
+        result = EOK;
+        if ( setsockopt( fd,
+                         ( pInfo->ai_family == AF_INET6 ) ? IPPROTO_IPV6
+                                                          : IPPROTO_IP,
+                         MCAST_JOIN_GROUP,
+                         &req,
+                         sizeof( req ) ) != 0 )
+        {
+            result = errno;
+        }
+
+        freeaddrinfo( pInfo );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupBuffers                                                              */
+/*!
+    Allocate the receive buffers
+
+    The SetupBuffers function allocates the datagram buffers of a
+    receive batch and the decompressed payload buffer, and points the
+    recvmmsg() message headers at them.
+
+    @param[in]
+        pState
+            pointer to the receiver state
+
+    @retval EOK the buffers were allocated
+    @retval ENOMEM memory allocation failed
+
+==============================================================================*/
+static int SetupBuffers( ListenState *pState )
+{
+    int result = ENOMEM;
+    struct msghdr *pHdr;
+    size_t i;
+
+    pState->pBuffers = malloc( (size_t)LISTEN_BATCH * LISTEN_DATAGRAM_SIZE );
+    pState->pPayload = malloc( REASM_MAX_PAYLOAD );
+    if ( ( pState->pBuffers != NULL ) &&
+         ( pState->pPayload != NULL ) &&
+         ( JSONOBJ_Init( &pState->json, REASM_MAX_PAYLOAD ) == EOK ) )
+    {
+        for ( i = 0; i < LISTEN_BATCH; i++ )
+        {
+            pState->iov[i].iov_base =
+                &pState->pBuffers[i * LISTEN_DATAGRAM_SIZE];
+            pState->iov[i].iov_len = LISTEN_DATAGRAM_SIZE;
+
+            pHdr = &pState->msgs[i].msg_hdr;
+            memset( pHdr, 0, sizeof( struct msghdr ) );
+            pHdr->msg_name = &pState->addr[i];
+            pHdr->msg_iov = &pState->iov[i];
+            pHdr->msg_iovlen = 1;
+            pHdr->msg_control = pState->control[i].buf;
+        }
+
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  Run                                                                       */
+/*!
+    Run the receive loop
+
+    The Run function receives batches of datagrams with recvmmsg() and
+    processes them until the receiver is stopped.  MSG_WAITFORONE
+    blocks until the first datagram arrives and then returns everything
+    which is already queued, so a busy socket is drained with few system
+    calls while an idle one adds no latency.  The statistics are
+    reported and the variable cache is refreshed between batches.
+
+    @param[in]
+        pState
+            pointer to the receiver state
+
+==============================================================================*/
+static void Run( ListenState *pState )
+{
+    struct msghdr *pHdr;
+    uint64_t now_ns;
+    uint64_t stats_ns;
+    uint64_t cache_ns;
+    int result = EOK;
+    int n;
+    int i;
+
+    now_ns = SCHED_Now();
+    stats_ns = now_ns + (uint64_t)pState->statsInterval_s * 1000000000ULL;
+    cache_ns = now_ns + LISTEN_CACHE_REFRESH_NS;
+
+    while ( ( running ) && ( result == EOK ) )
+    {
+        for ( i = 0; i < LISTEN_BATCH; i++ )
+        {
+            pHdr = &pState->msgs[i].msg_hdr;
+            pHdr->msg_namelen = sizeof( struct sockaddr_storage );
+            pHdr->msg_controllen = sizeof( ListenControl );
+            pHdr->msg_flags = 0;
+        }
+
+        n = recvmmsg( pState->fd,
+                      pState->msgs,
+                      LISTEN_BATCH,
+                      MSG_WAITFORONE,
+                      NULL );
+        if ( ( n == -1 ) &&
+             ( errno != EINTR ) &&
+             ( errno != EAGAIN ) &&
+             ( errno != EWOULDBLOCK ) )
+        {
+            result = errno;
+            fprintf( stderr,
+                     "udpt-listen: recvmmsg: %s\n",
+                     strerror( result ) );
+        }
+
+        now_ns = SCHED_Now();
+
+        for ( i = 0; i < n; i++ )
+        {
+            pHdr = &pState->msgs[i].msg_hdr;
+            ReadDrops( pState, pHdr );
+
+            if ( ( pHdr->msg_flags & MSG_TRUNC ) != 0 )
+            {
+                /* the datagram did not fit in its buffer */
+                pState->stats.datagrams++;
+                pState->stats.parseErrors++;
+            }
+            else
+            {
+                ProcessDatagram( pState,
+                                 (struct sockaddr *)&pState->addr[i],
+                                 pState->iov[i].iov_base,
+                                 pState->msgs[i].msg_len );
+            }
+        }
+
+        if ( now_ns >= cache_ns )
+        {
+            /* pick up variables created since they were looked up */
+            VARCACHE_Clear( &pState->cache );
+            cache_ns = now_ns + LISTEN_CACHE_REFRESH_NS;
+        }
+
+        if ( ( pState->statsInterval_s != 0 ) &&
+             ( now_ns >= stats_ns ) )
+        {
+            DumpStats( pState, stdout );
+            stats_ns = now_ns + (uint64_t)pState->statsInterval_s *
+                                1000000000ULL;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  ReadDrops                                                                 */
+/*!
+    Read the kernel drop counter of a received datagram
+
+    The ReadDrops function gets the number of datagrams the kernel has
+    dropped on the socket so far, which SO_RXQ_OVFL attaches to every
+    received datagram.
+
+    @param[in]
+        pState
+            pointer to the receiver state
+
+    @param[in]
+        pHdr
+            pointer to the message header of the received datagram
+
+==============================================================================*/
+static void ReadDrops( ListenState *pState, struct msghdr *pHdr )
+{
+    struct cmsghdr *pCmsg;
+
+    for ( pCmsg = CMSG_FIRSTHDR( pHdr );
+          pCmsg != NULL;
+          pCmsg = CMSG_NXTHDR( pHdr, pCmsg ) )
+    {
+        if ( ( pCmsg->cmsg_level == SOL_SOCKET ) &&
+             ( pCmsg->cmsg_type == SO_RXQ_OVFL ) )
+        {
+            memcpy( &pState->stats.drops,
+                    CMSG_DATA( pCmsg ),
+                    sizeof( uint32_t ) );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  ProcessDatagram                                                           */
+/*!
+    Process a received datagram
+
+    The ProcessDatagram function adds segment datagrams to their
+    payload, and processes complete payloads.
+
+    @param[in]
+        pState
+            pointer to the receiver state
+
+    @param[in]
+        pSource
+            address the datagram was received from
+
+    @param[in]
+        pBuf
+            pointer to the datagram
+
+    @param[in]
+        len
+            length of the datagram
+
+==============================================================================*/
+static void ProcessDatagram( ListenState *pState,
+                             const struct sockaddr *pSource,
+                             const char *pBuf,
+                             size_t len )
+{
+    UDPTSegment segment;
+    const char *pPayload;
+    size_t payloadLen;
+    int rc;
+
+    pState->stats.datagrams++;
+
+    rc = UDPTMSG_ParseSegmentHeader( pBuf, len, &segment );
+    if ( rc == EOK )
+    {
+        pState->stats.segments++;
+
+        rc = REASM_Add( &pState->reasm,
+                        pSource,
+                        &segment,
+                        &pBuf[UDPTMSG_SEGMENT_HEADER_SIZE],
+                        len - UDPTMSG_SEGMENT_HEADER_SIZE,
+                        SCHED_Now(),
+                        &pPayload,
+                        &payloadLen );
+        if ( rc == EOK )
+        {
+            rc = ProcessPayload( pState, pPayload, payloadLen, true );
+        }
+        else if ( rc == EINPROGRESS )
+        {
+            rc = EOK;
+        }
+    }
+    else if ( rc == ENOENT )
+    {
+        rc = ProcessPayload( pState, pBuf, len, true );
+    }
+
+    if ( ( rc != EOK ) &&
+         ( rc != ENOENT ) )
+    {
+        pState->stats.parseErrors++;
+    }
+}
+
+/*============================================================================*/
+/*  ProcessPayload                                                            */
+/*!
+    Process a complete payload
+
+    The ProcessPayload function decompresses a compressed payload, and
+    decodes a CBOR payload or matches a text payload against the
+    templates.
+
+    @param[in]
+        pState
+            pointer to the receiver state
+
+    @param[in]
+        pBuf
+            pointer to the payload
+
+    @param[in]
+        len
+            length of the payload
+
+    @param[in]
+        allowCompressed
+            true if the payload may be compressed.  A decompressed
+            payload is never compressed again.
+
+    @retval EOK the payload was processed
+    @retval ENOENT the schema or dictionary of the payload is unknown
+    @retval EBADMSG the payload could not be parsed
+    @retval other error from Decompress
+
+==============================================================================*/
+static int ProcessPayload( ListenState *pState,
+                           const char *pBuf,
+                           size_t len,
+                           bool allowCompressed )
+{
+    int result;
+    bool decompressed = false;
+    size_t i;
+
+    if ( ( len >= 2 ) &&
+         ( (unsigned char)pBuf[0] == UDPTMSG_MAGIC ) )
+    {
+        if ( ( (unsigned char)pBuf[1] == UDPTMSG_TYPE_COMPRESSED ) &&
+             ( allowCompressed == true ) )
+        {
+            /* the decompressed payload is counted when it is processed */
+            result = Decompress( pState, pBuf, len );
+            decompressed = true;
+        }
+        else if ( (unsigned char)pBuf[1] == UDPTMSG_TYPE_CBOR )
+        {
+            pState->stats.cbor++;
+            result = DecodeCBOR( pState, pBuf, len );
+        }
+        else
+        {
+            result = EBADMSG;
+        }
+    }
+    else if ( pState->nTemplates > 0 )
+    {
+        pState->stats.text++;
+
+        result = EBADMSG;
+        for ( i = 0; ( i < pState->nTemplates ) && ( result != EOK ); i++ )
+        {
+            result = MatchText( &pState->templates[i], pBuf, len );
+            if ( result == EOK )
+            {
+                ApplyValues( pState, &pState->templates[i] );
+            }
+        }
+    }
+    else
+    {
+        pState->stats.text++;
+        result = ParseJSON( pState, pBuf, len );
+    }
+
+    if ( ( decompressed == false ) &&
+         ( ( result == EOK ) || ( result == ENOENT ) ) )
+    {
+        pState->stats.payloads++;
+    }
+
+    if ( ( decompressed == false ) &&
+         ( result == ENOENT ) )
+    {
+        pState->stats.unknownSchema++;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  Decompress                                                                */
+/*!
+    Decompress and process a compressed payload
+
+    The Decompress function decompresses a payload using the template
+    dictionary with the identifier given in its header, or no dictionary
+    if the identifier is zero, and processes the decompressed payload.
+
+    @param[in]
+        pState
+            pointer to the receiver state
+
+    @param[in]
+        pBuf
+            pointer to the compressed payload
+
+    @param[in]
+        len
+            length of the compressed payload
+
+    @retval EOK the payload was processed
+    @retval ENOENT the dictionary is unknown
+    @retval EBADMSG the payload is corrupt or its length does not match
+    @retval other error from COMPRESS_Decompress or ProcessPayload
+
+==============================================================================*/
+static int Decompress( ListenState *pState, const char *pBuf, size_t len )
+{
+    int result;
+    UDPTCompressed hdr;
+    Compressor *pCompressor = NULL;
+    size_t outLen = 0;
+    size_t i;
+
+    result = UDPTMSG_ParseCompressedHeader( pBuf, len, &hdr );
+    if ( result != EOK )
+    {
+        result = EBADMSG;
+    }
+    else
+    {
+        pState->stats.compressed++;
+
+        if ( hdr.dictId == 0 )
+        {
+            pCompressor = &pState->plain;
+        }
+
+        for ( i = 0;
+              ( i < pState->nTemplates ) && ( pCompressor == NULL );
+              i++ )
+        {
+            if ( pState->templates[i].compressor.dictId == hdr.dictId )
+            {
+                pCompressor = &pState->templates[i].compressor;
+            }
+        }
+
+        if ( pCompressor == NULL )
+        {
+            /* we do not have the dictionary */
+            pState->stats.unknownSchema++;
+            result = ENOENT;
+        }
+        else if ( hdr.len > REASM_MAX_PAYLOAD )
+        {
+            result = EBADMSG;
+        }
+    }
+
+    if ( result == EOK )
+    {
+        result = COMPRESS_Decompress( pCompressor,
+                                      hdr.algorithm,
+                                      &pBuf[UDPTMSG_COMPRESSED_HEADER_SIZE],
+                                      len - UDPTMSG_COMPRESSED_HEADER_SIZE,
+                                      pState->pPayload,
+                                      hdr.len,
+                                      &outLen );
+        if ( ( result == EOK ) &&
+             ( outLen != hdr.len ) )
+        {
+            result = EBADMSG;
+        }
+    }
+
+    if ( result == EOK )
+    {
+        result = ProcessPayload( pState, pState->pPayload, outLen, false );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  DecodeCBOR                                                                */
+/*!
+    Decode a CBOR payload
+
+    The DecodeCBOR function finds the template with the schema
+    identifier of a CBOR payload, decodes the array of variable values,
+    which is in template order, and writes them to the variables.
+
+    @param[in]
+        pState
+            pointer to the receiver state
+
+    @param[in]
+        pBuf
+            pointer to the CBOR payload
+
+    @param[in]
+        len
+            length of the CBOR payload
+
+    @retval EOK the payload was decoded
+    @retval ENOENT no template has the schema identifier of the payload
+    @retval EBADMSG the payload does not match the template
+
+==============================================================================*/
+static int DecodeCBOR( ListenState *pState, const char *pBuf, size_t len )
+{
+    int result = EBADMSG;
+    ListenTemplate *pTemplate = NULL;
+    CborReader reader;
+    CborItem item;
+    uint32_t schemaId;
+    size_t n = 0;
+    size_t i;
+
+    if ( UDPTMSG_ParseCBORHeader( pBuf, len, &schemaId ) == EOK )
+    {
+        for ( i = 0;
+              ( i < pState->nTemplates ) && ( pTemplate == NULL );
+              i++ )
+        {
+            if ( pState->templates[i].compiled.schemaId == schemaId )
+            {
+                pTemplate = &pState->templates[i];
+            }
+        }
+
+        if ( pTemplate == NULL )
+        {
+            result = ENOENT;
+        }
+        else
+        {
+            CBOR_InitReader( &reader,
+                             &pBuf[UDPTMSG_CBOR_HEADER_SIZE],
+                             len - UDPTMSG_CBOR_HEADER_SIZE );
+
+            if ( ( CBOR_Read( &reader, &item ) == EOK ) &&
+                 ( item.type == CBOR_TYPE_ARRAY ) &&
+                 ( item.len == pTemplate->compiled.nVars ) )
+            {
+                result = EOK;
+            }
+        }
+    }
+
+    for ( n = 0;
+          ( result == EOK ) && ( n < pTemplate->compiled.nVars );
+          n++ )
+    {
+        if ( ( CBOR_Read( &reader, &pTemplate->pValues[n] ) != EOK ) ||
+             ( pTemplate->pValues[n].type == CBOR_TYPE_ARRAY ) )
+        {
+            result = EBADMSG;
+        }
+    }
+
+    if ( result == EOK )
+    {
+        ApplyValues( pState, pTemplate );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  MatchText                                                                 */
+/*!
+    Match a text payload against a template
+
+    The MatchText function checks that a text payload consists of the
+    static text of the template, and extracts the value of every
+    variable reference in between.  A value extends up to the first
+    occurrence of the static text which follows it, so values must not
+    contain that text.  Adjacent variable references cannot be told
+    apart, so all but the last of them are taken to be empty.
+
+    @param[in]
+        pTemplate
+            pointer to the template
+
+    @param[in]
+        pBuf
+            pointer to the text payload
+
+    @param[in]
+        len
+            length of the text payload
+
+    @retval EOK the payload matches the template
+    @retval EBADMSG the payload does not match the template
+
+==============================================================================*/
+static int MatchText( ListenTemplate *pTemplate,
+                      const char *pBuf,
+                      size_t len )
+{
+    int result = EOK;
+    CompiledTemplate *pCompiled = &pTemplate->compiled;
+    CTElement *pElement;
+    CTElement *pNext;
+    const char *pText;
+    const char *pFound;
+    size_t pos = 0;
+    size_t end;
+    size_t n = 0;
+    size_t i;
+
+    for ( i = 0; ( i < pCompiled->nElements ) && ( result == EOK ); i++ )
+    {
+        pElement = &pCompiled->elements[i];
+        pText = &pCompiled->text[pElement->offset];
+
+        pNext = ( i + 1 < pCompiled->nElements )
+                ? &pCompiled->elements[i + 1]
+                : NULL;
+
+        if ( pElement->isVar == false )
+        {
+            if ( ( len - pos < pElement->len ) ||
+                 ( memcmp( &pBuf[pos], pText, pElement->len ) != 0 ) )
+            {
+                result = EBADMSG;
+            }
+            else
+            {
+                pos += pElement->len;
+            }
+        }
+        else
+        {
+            if ( pNext == NULL )
+            {
+                /* the last value extends to the end of the payload */
+                end = len;
+            }
+            else if ( pNext->isVar == true )
+            {
+                end = pos;
+            }
+            else
+            {
+                pFound = memmem( &pBuf[pos],
+                                 len - pos,
+                                 &pCompiled->text[pNext->offset],
+                                 pNext->len );
+                if ( pFound == NULL )
+                {
+                    result = EBADMSG;
+                }
+
+                end = ( pFound != NULL ) ? (size_t)( pFound - pBuf ) : pos;
+            }
+
+            if ( result == EOK )
+            {
+                memset( &pTemplate->pValues[n], 0, sizeof( CborItem ) );
+                pTemplate->pValues[n].type = CBOR_TYPE_TEXT;
+                pTemplate->pValues[n].pText = &pBuf[pos];
+                pTemplate->pValues[n].len = end - pos;
+                n++;
+
+                pos = end;
+            }
+        }
+    }
+
+    if ( ( result == EOK ) &&
+         ( pos != len ) )
+    {
+        result = EBADMSG;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ApplyValues                                                               */
+/*!
+    Write the values of a matched payload
+
+    The ApplyValues function writes the values extracted from a payload
+    to the variables referenced by its template.
+
+    @param[in]
+        pState
+            pointer to the receiver state
+
+    @param[in]
+        pTemplate
+            pointer to the template the payload was matched against
+
+==============================================================================*/
+static void ApplyValues( ListenState *pState, ListenTemplate *pTemplate )
+{
+    CompiledTemplate *pCompiled = &pTemplate->compiled;
+    CTElement *pElement;
+    size_t n = 0;
+    size_t i;
+
+    for ( i = 0; i < pCompiled->nElements; i++ )
+    {
+        pElement = &pCompiled->elements[i];
+        if ( pElement->isVar == true )
+        {
+            SetValue( pState,
+                      &pCompiled->text[pElement->offset],
+                      pElement->len,
+                      &pTemplate->pValues[n++] );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  ParseJSON                                                                 */
+/*!
+    Parse a flat JSON object payload
+
+    The ParseJSON function parses a text payload which is a JSON object
+    of variable names and scalar values, and writes each value to the
+    named variable.  Numbers are converted to the type of the variable,
+    true and false are written as 1 and 0, and null values are skipped.
+    Nested objects and arrays are not supported.  The members are
+    collected first, and only written once the whole object has been
+    parsed, so a malformed or truncated payload writes nothing.
+
+    @param[in]
+        pState
+            pointer to the receiver state
+
+    @param[in]
+        pBuf
+            pointer to the text payload
+
+    @param[in]
+        len
+            length of the text payload
+
+    @retval EOK the payload was parsed
+    @retval EBADMSG the payload is not a flat JSON object
+    @retval E2BIG the object has more than JSONOBJ_MAX_MEMBERS members,
+            or a name or value is too long
+
+==============================================================================*/
+static int ParseJSON( ListenState *pState, const char *pBuf, size_t len )
+{
+    JsonMember *pMember;
+    size_t i;
+    int result;
+
+    result = JSONOBJ_Parse( &pState->json, pBuf, len );
+    for ( i = 0; ( result == EOK ) && ( i < pState->json.n ); i++ )
+    {
+        pMember = &pState->json.pMembers[i];
+        SetValue( pState, pMember->name, pMember->nameLen, &pMember->item );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetValue                                                                  */
+/*!
+    Write a received value to its variable
+
+    The SetValue function looks up the variable with the received name,
+    plus the -P prefix, converts the value to the type of the variable
+    and writes it.  Values which are the same as the value last written
+    to the variable are not written again unless -w is given.  Null
+    values, which udpt sends for unresolved references, are skipped.
+
+    @param[in]
+        pState
+            pointer to the receiver state
+
+    @param[in]
+        name
+            pointer to the variable name, which need not be NUL
+            terminated
+
+    @param[in]
+        nameLen
+            length of the variable name
+
+    @param[in]
+        pItem
+            pointer to the received value
+
+==============================================================================*/
+static void SetValue( ListenState *pState,
+                      const char *name,
+                      size_t nameLen,
+                      const CborItem *pItem )
+{
+    char fullname[MAX_NAME_LEN + 1];
+    char str[LISTEN_VALUE_SIZE];
+    VarCacheEntry *pEntry;
+    VarObject obj;
+    uint64_t hash;
+    int n;
+
+    if ( pItem->type != CBOR_TYPE_NULL )
+    {
+        pState->stats.values++;
+
+        n = snprintf( fullname,
+                      sizeof( fullname ),
+                      "%s%.*s",
+                      ( pState->prefix != NULL ) ? pState->prefix : "",
+                      (int)nameLen,
+                      name );
+        if ( ( n < 0 ) || ( (size_t)n >= sizeof( fullname ) ) )
+        {
+            pState->stats.unknown++;
+        }
+        else if ( pState->dryRun == true )
+        {
+            pState->stats.written++;
+        }
+        else if ( VARCACHE_Lookup( &pState->cache,
+                                   pState->hVarServer,
+                                   fullname,
+                                   &pEntry ) != EOK )
+        {
+            pState->stats.unknown++;
+        }
+        else if ( Convert( pEntry->type,
+                           pItem,
+                           &obj,
+                           str,
+                           sizeof( str ) ) != EOK )
+        {
+            pState->stats.setErrors++;
+        }
+        else
+        {
+            hash = ( obj.type == VARTYPE_STR )
+                   ? HASH_Compute( obj.val.str, strlen( obj.val.str ) )
+                   : HASH_Compute( &obj.val, sizeof( obj.val ) );
+
+            if ( ( pState->writeAll == false ) &&
+                 ( pEntry->written == true ) &&
+                 ( pEntry->valueHash == hash ) )
+            {
+                pState->stats.unchanged++;
+            }
+            else if ( VAR_Set( pState->hVarServer,
+                               pEntry->hVar,
+                               &obj ) == EOK )
+            {
+                pEntry->valueHash = hash;
+                pEntry->written = true;
+                pState->stats.written++;
+
+                if ( pState->verbose == true )
+                {
+                    if ( pItem->type == CBOR_TYPE_TEXT )
+                    {
+                        printf( "%s=%.*s\n",
+                                fullname,
+                                (int)pItem->len,
+                                pItem->pText );
+                    }
+                    else
+                    {
+                        printf( "%s (%d)\n", fullname, (int)pItem->type );
+                    }
+                }
+            }
+            else
+            {
+                pState->stats.setErrors++;
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  Convert                                                                   */
+/*!
+    Convert a received value to the type of its variable
+
+    The Convert function converts a received text or number to a
+    variable object of the specified type.  Text is parsed as a number
+    for the numeric types, and numbers are formatted as text for
+    string variables.  Floating point values are only stored in integer
+    variables if they are whole numbers within the range of the type.
+
+    @param[in]
+        type
+            type of the variable
+
+    @param[in]
+        pItem
+            pointer to the received value
+
+    @param[out]
+        pObj
+            pointer to the variable object to populate
+
+    @param[in]
+        pStr
+            pointer to a buffer for the string value
+
+    @param[in]
+        size
+            size of the string buffer
+
+    @retval EOK the value was converted
+    @retval ERANGE the value does not fit the variable type, is not
+            finite, or is not a whole number for an integer type
+    @retval EBADMSG the text is not a valid number
+    @retval ENOTSUP the variable type is not supported
+
+==============================================================================*/
+static int Convert( VarType type,
+                    const CborItem *pItem,
+                    VarObject *pObj,
+                    char *pStr,
+                    size_t size )
+{
+    int result = EOK;
+    char *pEnd = NULL;
+    uint64_t u = 0;
+    int64_t i = 0;
+    double d = 0.0;
+    bool isSigned = false;
+    bool isFloat = false;
+    bool isText = false;
+
+    memset( pObj, 0, sizeof( VarObject ) );
+    pObj->type = type;
+
+    if ( pItem->type == CBOR_TYPE_TEXT )
+    {
+        snprintf( pStr, size, "%.*s", (int)pItem->len, pItem->pText );
+        if ( type == VARTYPE_STR )
+        {
+            /* text is stored as it is */
+            isText = true;
+        }
+        else if ( pItem->len == 0 )
+        {
+            result = EBADMSG;
+        }
+        else
+        {
+            errno = 0;
+            if ( type == VARTYPE_FLOAT )
+            {
+                d = strtod( pStr, &pEnd );
+                isFloat = true;
+            }
+            else if ( pStr[0] == '-' )
+            {
+                i = strtoll( pStr, &pEnd, 0 );
+                isSigned = true;
+            }
+            else
+            {
+                u = strtoull( pStr, &pEnd, 0 );
+            }
+
+            if ( ( errno != 0 ) || ( pEnd == NULL ) || ( *pEnd != '\0' ) )
+            {
+                result = EBADMSG;
+            }
+        }
+    }
+    else if ( pItem->type == CBOR_TYPE_UINT )
+    {
+        u = pItem->val.u;
+    }
+    else if ( pItem->type == CBOR_TYPE_INT )
+    {
+        i = pItem->val.i;
+        isSigned = true;
+    }
+    else if ( pItem->type == CBOR_TYPE_FLOAT )
+    {
+        d = pItem->val.d;
+        isFloat = true;
+    }
+    else
+    {
+        result = ENOTSUP;
+    }
+
+    /* use a single representation for the range checks.  A double is
+       only converted to an integer if it is finite, within range and
+       a whole number, since anything else is undefined or lossy */
+    if ( ( result != EOK ) || ( isText == true ) )
+    {
+        /* nothing to range check */
+    }
+    else if ( ( isFloat == true ) &&
+              ( type != VARTYPE_STR ) )
+    {
+        if ( isfinite( d ) == 0 )
+        {
+            result = ERANGE;
+        }
+        else if ( type == VARTYPE_FLOAT )
+        {
+            if ( ( d > FLT_MAX ) || ( d < -FLT_MAX ) )
+            {
+                result = ERANGE;
+            }
+        }
+        else if ( d < 0.0 )
+        {
+            /* -2^63 is the smallest int64_t */
+            if ( d < -9223372036854775808.0 )
+            {
+                result = ERANGE;
+            }
+            else
+            {
+                isSigned = true;
+                i = (int64_t)d;
+                if ( (double)i != d )
+                {
+                    result = ERANGE;
+                }
+            }
+        }
+        else
+        {
+            /* 2^64 is one more than the largest uint64_t */
+            if ( d >= 18446744073709551616.0 )
+            {
+                result = ERANGE;
+            }
+            else
+            {
+                u = (uint64_t)d;
+                if ( (double)u != d )
+                {
+                    result = ERANGE;
+                }
+            }
+        }
+    }
+    else if ( isSigned == true )
+    {
+        d = (double)i;
+    }
+    else
+    {
+        d = (double)u;
+    }
+
+    if ( result == EOK )
+    {
+        switch( type )
+        {
+            case VARTYPE_UINT16:
+                if ( isSigned || ( u > UINT16_MAX ) )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    pObj->val.ui = (uint16_t)u;
+                }
+                break;
+
+            case VARTYPE_INT16:
+                if ( isSigned ? ( i < INT16_MIN ) : ( u > INT16_MAX ) )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    pObj->val.i = isSigned ? (int16_t)i : (int16_t)u;
+                }
+                break;
+
+            case VARTYPE_UINT32:
+                if ( isSigned || ( u > UINT32_MAX ) )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    pObj->val.ul = (uint32_t)u;
+                }
+                break;
+
+            case VARTYPE_INT32:
+                if ( isSigned ? ( i < INT32_MIN ) : ( u > INT32_MAX ) )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    pObj->val.l = isSigned ? (int32_t)i : (int32_t)u;
+                }
+                break;
+
+            case VARTYPE_UINT64:
+                if ( isSigned )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    pObj->val.ull = u;
+                }
+                break;
+
+            case VARTYPE_INT64:
+                if ( !isSigned && ( u > INT64_MAX ) )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    pObj->val.ll = isSigned ? i : (int64_t)u;
+                }
+                break;
+
+            case VARTYPE_FLOAT:
+                pObj->val.f = (float)d;
+                break;
+
+            case VARTYPE_STR:
+                if ( isText )
+                {
+                    /* the text is already in the string buffer */
+                }
+                else if ( isFloat )
+                {
+                    snprintf( pStr, size, "%f", d );
+                }
+                else if ( isSigned )
+                {
+                    snprintf( pStr, size, "%" PRId64, i );
+                }
+                else
+                {
+                    snprintf( pStr, size, "%" PRIu64, u );
+                }
+                pObj->val.str = pStr;
+                pObj->len = strlen( pStr );
+                break;
+
+            default:
+                result = ENOTSUP;
+                break;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  DumpStats                                                                 */
+/*!
+    Report the receiver counters
+
+    The DumpStats function writes the receiver counters as a JSON
+    object on one line.
+
+    @param[in]
+        pState
+            pointer to the receiver state
+
+    @param[in]
+        fp
+            output stream
+
+==============================================================================*/
+static void DumpStats( ListenState *pState, FILE *fp )
+{
+    ListenStats *pStats = &pState->stats;
+
+    fprintf( fp,
+             "{\"datagrams\": %" PRIu64 ", \"segments\": %" PRIu64
+             ", \"payloads\": %" PRIu64 ", \"compressed\": %" PRIu64
+             ", \"cbor\": %" PRIu64 ", \"text\": %" PRIu64
+             ", \"values\": %" PRIu64 ", \"written\": %" PRIu64
+             ", \"unchanged\": %" PRIu64 ", \"unknown_vars\": %" PRIu64
+             ", \"set_errors\": %" PRIu64 ", \"parse_errors\": %" PRIu64
+             ", \"unknown_schema\": %" PRIu64 ", \"drops\": %u"
+             ", \"reassembled\": %" PRIu64 ", \"reasm_expired\": %" PRIu64
+             ", \"reasm_evicted\": %" PRIu64 ", \"reasm_invalid\": %" PRIu64
+             ", \"cache_misses\": %" PRIu64 "}\n",
+             pStats->datagrams,
+             pStats->segments,
+             pStats->payloads,
+             pStats->compressed,
+             pStats->cbor,
+             pStats->text,
+             pStats->values,
+             pStats->written,
+             pStats->unchanged,
+             pStats->unknown,
+             pStats->setErrors,
+             pStats->parseErrors,
+             pStats->unknownSchema,
+             pStats->drops,
+             pState->reasm.completed,
+             pState->reasm.expired,
+             pState->reasm.evicted,
+             pState->reasm.invalid,
+             pState->cache.misses );
+    fflush( fp );
+}
+
+/*============================================================================*/
+/*  Cleanup                                                                   */
+/*!
+    Release the receiver resources
+
+    The Cleanup function closes the socket and the variable server
+    connection, and frees the templates, buffers, reassembler and
+    variable cache.
+
+    @param[in]
+        pState
+            pointer to the receiver state
+
+==============================================================================*/
+static void Cleanup( ListenState *pState )
+{
+    ListenTemplate *pTemplate;
+    size_t i;
+
+    if ( pState->fd != -1 )
+    {
+        close( pState->fd );
+        pState->fd = -1;
+    }
+
+    if ( pState->hVarServer != NULL )
+    {
+        (void)VARSERVER_Close( pState->hVarServer );
+        pState->hVarServer = NULL;
+    }
+
+    for ( i = 0; i < pState->nTemplates; i++ )
+    {
+        pTemplate = &pState->templates[i];
+        CTEMPLATE_Free( &pTemplate->compiled );
+        COMPRESS_Free( &pTemplate->compressor );
+        free( pTemplate->pValues );
+        free( pTemplate->filename );
+        pTemplate->pValues = NULL;
+        pTemplate->filename = NULL;
+    }
+
+    for ( i = 0; i < pState->nGroups; i++ )
+    {
+        free( pState->groups[i] );
+        pState->groups[i] = NULL;
+    }
+
+    COMPRESS_Free( &pState->plain );
+    REASM_Free( &pState->reasm );
+    VARCACHE_Free( &pState->cache );
+    JSONOBJ_Free( &pState->json );
+
+    free( pState->pBuffers );
+    free( pState->pPayload );
+    free( pState->bindAddr );
+    free( pState->prefix );
+    pState->pBuffers = NULL;
+    pState->pPayload = NULL;
+    pState->bindAddr = NULL;
+    pState->prefix = NULL;
+}
+
+/*! @}
+ * end of udptlisten group */
@@ -0,0 +1,433 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup udptmsg UDPT Message Framing
+ * @brief Framing of UDPT payloads which are not plain rendered templates
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file udptmsg.c
+
+    UDPT Message Framing
+
+    The udptmsg component writes and parses the headers of framed UDPT
+    messages.  Plain rendered templates are sent without a header.
+    Framed messages start with the UDPTMSG_MAGIC byte followed by a
+    message type byte, so receivers can tell the two apart.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <errno.h>
+#include <varserver/varserver.h>
+#include "udptmsg.h"
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static void PutU16( char *pBuf, uint16_t val );
+static uint16_t GetU16( const char *pBuf );
+static void PutU32( char *pBuf, uint32_t val );
+static uint32_t GetU32( const char *pBuf );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  UDPTMSG_WriteSegmentHeader                                                */
+/*!
+    Write a segment header
+
+    The UDPTMSG_WriteSegmentHeader function writes the header of one
+    segment of a segmented payload.  The buffer must have space for
+    UDPTMSG_SEGMENT_HEADER_SIZE bytes.
+
+    @param[out]
+        pBuf
+            pointer to the buffer to write the header to
+
+    @param[in]
+        msgId
+            message identifier shared by all segments of the payload
+
+    @param[in]
+        index
+            index of the segment
+
+    @param[in]
+        count
+            total number of segments in the payload
+
+    @retval number of bytes written
+
+==============================================================================*/
+size_t UDPTMSG_WriteSegmentHeader( char *pBuf,
+                                   uint16_t msgId,
+                                   uint16_t index,
+                                   uint16_t count )
+{
+    pBuf[0] = (char)UDPTMSG_MAGIC;
+    pBuf[1] = (char)UDPTMSG_TYPE_SEGMENT;
+    PutU16( &pBuf[2], msgId );
+    PutU16( &pBuf[4], index );
+    PutU16( &pBuf[6], count );
+
+    return UDPTMSG_SEGMENT_HEADER_SIZE;
+}
+
+/*============================================================================*/
+/*  UDPTMSG_ParseSegmentHeader                                                */
+/*!
+    Parse a segment header
+
+    The UDPTMSG_ParseSegmentHeader function parses the header of a
+    received datagram which may be a segment of a segmented payload.
+
+    @param[in]
+        pBuf
+            pointer to the received datagram
+
+    @param[in]
+        len
+            length of the received datagram
+
+    @param[out]
+        pSegment
+            pointer to a location to store the parsed header
+
+    @retval EOK the datagram is a valid segment
+    @retval ENOENT the datagram is not a segment
+    @retval EBADMSG the segment header is invalid
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int UDPTMSG_ParseSegmentHeader( const char *pBuf,
+                                size_t len,
+                                UDPTSegment *pSegment )
+{
+    int result = EINVAL;
+
+    if ( ( pBuf != NULL ) &&
+         ( pSegment != NULL ) )
+    {
+        result = ENOENT;
+
+        if ( ( len >= 2 ) &&
+             ( (unsigned char)pBuf[0] == UDPTMSG_MAGIC ) &&
+             ( (unsigned char)pBuf[1] == UDPTMSG_TYPE_SEGMENT ) )
+        {
+            result = EBADMSG;
+
+            if ( len >= UDPTMSG_SEGMENT_HEADER_SIZE )
+            {
+                pSegment->msgId = GetU16( &pBuf[2] );
+                pSegment->index = GetU16( &pBuf[4] );
+                pSegment->count = GetU16( &pBuf[6] );
+
+                if ( pSegment->index < pSegment->count )
+                {
+                    result = EOK;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  UDPTMSG_WriteCompressedHeader                                             */
+/*!
+    Write a compressed payload header
+
+    The UDPTMSG_WriteCompressedHeader function writes the header of a
+    compressed payload.  The buffer must have space for
+    UDPTMSG_COMPRESSED_HEADER_SIZE bytes.
+
+    @param[out]
+        pBuf
+            pointer to the buffer to write the header to
+
+    @param[in]
+        algorithm
+            compression algorithm used to compress the payload
+
+    @param[in]
+        dictId
+            identifier of the dictionary used, or 0 if none
+
+    @param[in]
+        len
+            length of the uncompressed payload
+
+    @retval number of bytes written
+
+==============================================================================*/
+size_t UDPTMSG_WriteCompressedHeader( char *pBuf,
+                                      uint8_t algorithm,
+                                      uint32_t dictId,
+                                      uint32_t len )
+{
+    pBuf[0] = (char)UDPTMSG_MAGIC;
+    pBuf[1] = (char)UDPTMSG_TYPE_COMPRESSED;
+    pBuf[2] = (char)algorithm;
+    pBuf[3] = 0;
+    PutU32( &pBuf[4], dictId );
+    PutU32( &pBuf[8], len );
+
+    return UDPTMSG_COMPRESSED_HEADER_SIZE;
+}
+
+/*============================================================================*/
+/*  UDPTMSG_ParseCompressedHeader                                             */
+/*!
+    Parse a compressed payload header
+
+    The UDPTMSG_ParseCompressedHeader function parses the header of a
+    received (and re-assembled) payload which may be compressed.
+
+    @param[in]
+        pBuf
+            pointer to the received payload
+
+    @param[in]
+        len
+            length of the received payload
+
+    @param[out]
+        pCompressed
+            pointer to a location to store the parsed header
+
+    @retval EOK the payload is compressed
+    @retval ENOENT the payload is not compressed
+    @retval EBADMSG the compressed payload header is invalid
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int UDPTMSG_ParseCompressedHeader( const char *pBuf,
+                                   size_t len,
+                                   UDPTCompressed *pCompressed )
+{
+    int result = EINVAL;
+
+    if ( ( pBuf != NULL ) &&
+         ( pCompressed != NULL ) )
+    {
+        result = ENOENT;
+
+        if ( ( len >= 2 ) &&
+             ( (unsigned char)pBuf[0] == UDPTMSG_MAGIC ) &&
+             ( (unsigned char)pBuf[1] == UDPTMSG_TYPE_COMPRESSED ) )
+        {
+            result = EBADMSG;
+
+            if ( len >= UDPTMSG_COMPRESSED_HEADER_SIZE )
+            {
+                pCompressed->algorithm = (uint8_t)pBuf[2];
+                pCompressed->dictId = GetU32( &pBuf[4] );
+                pCompressed->len = GetU32( &pBuf[8] );
+                result = EOK;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  UDPTMSG_WriteCBORHeader                                                   */
+/*!
+    Write a CBOR payload header
+
+    The UDPTMSG_WriteCBORHeader function writes the header of a CBOR
+    rendering of a template.  The buffer must have space for
+    UDPTMSG_CBOR_HEADER_SIZE bytes.
+
+    @param[out]
+        pBuf
+            pointer to the buffer to write the header to
+
+    @param[in]
+        schemaId
+            schema identifier of the template
+
+    @retval number of bytes written
+
+==============================================================================*/
+size_t UDPTMSG_WriteCBORHeader( char *pBuf, uint32_t schemaId )
+{
+    pBuf[0] = (char)UDPTMSG_MAGIC;
+    pBuf[1] = (char)UDPTMSG_TYPE_CBOR;
+    PutU32( &pBuf[2], schemaId );
+
+    return UDPTMSG_CBOR_HEADER_SIZE;
+}
+
+/*============================================================================*/
+/*  UDPTMSG_ParseCBORHeader                                                   */
+/*!
+    Parse a CBOR payload header
+
+    The UDPTMSG_ParseCBORHeader function parses the header of a received
+    (and re-assembled, and decompressed) payload which may be a CBOR
+    rendering of a template.
+
+    @param[in]
+        pBuf
+            pointer to the received payload
+
+    @param[in]
+        len
+            length of the received payload
+
+    @param[out]
+        pSchemaId
+            pointer to a location to store the schema identifier
+
+    @retval EOK the payload is a CBOR rendering
+    @retval ENOENT the payload is not a CBOR rendering
+    @retval EBADMSG the CBOR payload header is invalid
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int UDPTMSG_ParseCBORHeader( const char *pBuf,
+                             size_t len,
+                             uint32_t *pSchemaId )
+{
+    int result = EINVAL;
+
+    if ( ( pBuf != NULL ) &&
+         ( pSchemaId != NULL ) )
+    {
+        result = ENOENT;
+
+        if ( ( len >= 2 ) &&
+             ( (unsigned char)pBuf[0] == UDPTMSG_MAGIC ) &&
+             ( (unsigned char)pBuf[1] == UDPTMSG_TYPE_CBOR ) )
+        {
+            result = EBADMSG;
+
+            if ( len >= UDPTMSG_CBOR_HEADER_SIZE )
+            {
+                *pSchemaId = GetU32( &pBuf[2] );
+                result = EOK;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  PutU16                                                                    */
+/*!
+    Write a 16-bit value in network byte order
+
+    @param[out]
+        pBuf
+            pointer to the buffer to write to
+
+    @param[in]
+        val
+            value to write
+
+==============================================================================*/
+static void PutU16( char *pBuf, uint16_t val )
+{
+    pBuf[0] = (char)( val >> 8 );
+    pBuf[1] = (char)( val & 0xFF );
+}
+
+/*============================================================================*/
+/*  GetU16                                                                    */
+/*!
+    Read a 16-bit value in network byte order
+
+    @param[in]
+        pBuf
+            pointer to the buffer to read from
+
+    @retval the value read
+
+==============================================================================*/
+static uint16_t GetU16( const char *pBuf )
+{
+    return (uint16_t)( ( (unsigned char)pBuf[0] << 8 ) |
+                       (unsigned char)pBuf[1] );
+}
+
+/*============================================================================*/
+/*  PutU32                                                                    */
+/*!
+    Write a 32-bit value in network byte order
+
+    @param[out]
+        pBuf
+            pointer to the buffer to write to
+
+    @param[in]
+        val
+            value to write
+
+==============================================================================*/
+static void PutU32( char *pBuf, uint32_t val )
+{
+    PutU16( &pBuf[0], (uint16_t)( val >> 16 ) );
+    PutU16( &pBuf[2], (uint16_t)( val & 0xFFFF ) );
+}
+
+/*============================================================================*/
+/*  GetU32                                                                    */
+/*!
+    Read a 32-bit value in network byte order
+
+    @param[in]
+        pBuf
+            pointer to the buffer to read from
+
+    @retval the value read
+
+==============================================================================*/
+static uint32_t GetU32( const char *pBuf )
+{
+    return ( (uint32_t)GetU16( &pBuf[0] ) << 16 ) | GetU16( &pBuf[2] );
+}
+
+/*! @}
+ * end of udptmsg group */
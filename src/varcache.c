@@ -0,0 +1,313 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup varcache Variable Cache
+ * @brief Cache mapping variable names to their handles
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file varcache.c
+
+    Variable Cache
+
+    The varcache component keeps the handle and type of every variable
+    name it has been asked for in an open-addressed hash table, so a
+    receiver only queries the variable server the first time it sees
+    a name.  Names which do not exist are cached as well, so a sender
+    which references unknown variables does not cost a query per
+    value.  The cache is cleared periodically to pick up variables
+    which have been created since.
+
+    Each entry also holds a hash of the value last written to the
+    variable, so unchanged values do not need to be written again.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <varserver/varserver.h>
+#include "varcache.h"
+#include "hash.h"
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static VarCacheEntry *Probe( VarCache *pCache,
+                             const char *name,
+                             uint64_t hash );
+static int Grow( VarCache *pCache );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  VARCACHE_Lookup                                                           */
+/*!
+    Look up a variable by name
+
+    The VARCACHE_Lookup function gets the cache entry of a variable,
+    querying the variable server for its handle and type the first
+    time the name is looked up.
+
+    @param[in]
+        pCache
+            pointer to the variable cache
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        name
+            name of the variable
+
+    @param[out]
+        ppEntry
+            pointer to a location to store the cache entry
+
+    @retval EOK the variable was found
+    @retval ENOENT the variable does not exist
+    @retval ENOMEM memory allocation failed
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARCACHE_Lookup( VarCache *pCache,
+                     VARSERVER_HANDLE hVarServer,
+                     const char *name,
+                     VarCacheEntry **ppEntry )
+{
+    VarCacheEntry *pEntry;
+    uint64_t hash;
+    int result;
+
+    if ( ( pCache == NULL ) ||
+         ( name == NULL ) ||
+         ( ppEntry == NULL ) )
+    {
+        return EINVAL;
+    }
+
+    /* keep the table at most half full */
+    if ( ( pCache->n + 1 ) * 2 > pCache->size )
+    {
+        result = Grow( pCache );
+        if ( result != EOK )
+        {
+            return result;
+        }
+    }
+
+    hash = HASH_Compute( name, strlen( name ) );
+    pEntry = Probe( pCache, name, hash );
+    if ( pEntry->name == NULL )
+    {
+        pEntry->name = strdup( name );
+        if ( pEntry->name == NULL )
+        {
+            return ENOMEM;
+        }
+
+        pEntry->hash = hash;
+        pEntry->hVar = VAR_FindByName( hVarServer, pEntry->name );
+        pEntry->type = VARTYPE_INVALID;
+        pEntry->written = false;
+        if ( ( pEntry->hVar != VAR_INVALID ) &&
+             ( VAR_GetType( hVarServer,
+                            pEntry->hVar,
+                            &pEntry->type ) != EOK ) )
+        {
+            pEntry->hVar = VAR_INVALID;
+        }
+
+        pCache->n++;
+        pCache->misses++;
+    }
+
+    *ppEntry = pEntry;
+
+    return ( pEntry->hVar != VAR_INVALID ) ? EOK : ENOENT;
+}
+
+/*============================================================================*/
+/*  VARCACHE_Clear                                                            */
+/*!
+    Clear the variable cache
+
+    The VARCACHE_Clear function discards all of the cached variables,
+    keeping the hash table allocated.
+
+    @param[in]
+        pCache
+            pointer to the variable cache
+
+==============================================================================*/
+void VARCACHE_Clear( VarCache *pCache )
+{
+    size_t i;
+
+    if ( pCache != NULL )
+    {
+        for ( i = 0; i < pCache->size; i++ )
+        {
+            free( pCache->entries[i].name );
+            pCache->entries[i].name = NULL;
+        }
+
+        pCache->n = 0;
+    }
+}
+
+/*============================================================================*/
+/*  VARCACHE_Free                                                             */
+/*!
+    Free the resources used by the variable cache
+
+    @param[in]
+        pCache
+            pointer to the variable cache
+
+==============================================================================*/
+void VARCACHE_Free( VarCache *pCache )
+{
+    if ( pCache != NULL )
+    {
+        VARCACHE_Clear( pCache );
+        free( pCache->entries );
+        memset( pCache, 0, sizeof( VarCache ) );
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  Probe                                                                     */
+/*!
+    Find the slot of a variable name
+
+    The Probe function finds the slot holding a variable name using
+    linear probing, or the unused slot where it should be added.  The
+    table must have at least one unused slot.
+
+    @param[in]
+        pCache
+            pointer to the variable cache
+
+    @param[in]
+        name
+            name of the variable
+
+    @param[in]
+        hash
+            hash of the variable name
+
+    @retval pointer to the slot
+
+==============================================================================*/
+static VarCacheEntry *Probe( VarCache *pCache,
+                             const char *name,
+                             uint64_t hash )
+{
+    size_t mask = pCache->size - 1;
+    size_t i = (size_t)hash & mask;
+    VarCacheEntry *pEntry;
+
+    for ( ;; )
+    {
+        pEntry = &pCache->entries[i];
+        if ( ( pEntry->name == NULL ) ||
+             ( ( pEntry->hash == hash ) &&
+               ( strcmp( pEntry->name, name ) == 0 ) ) )
+        {
+            return pEntry;
+        }
+
+        i = ( i + 1 ) & mask;
+    }
+}
+
+/*============================================================================*/
+/*  Grow                                                                      */
+/*!
+    Double the size of the hash table
+
+    The Grow function allocates a hash table twice the size of the
+    current one, or VARCACHE_INITIAL_SIZE slots if there is none, and
+    moves the cached variables into it.
+
+    @param[in]
+        pCache
+            pointer to the variable cache
+
+    @retval EOK the table was grown
+    @retval ENOMEM memory allocation failed
+
+==============================================================================*/
+static int Grow( VarCache *pCache )
+{
+    VarCacheEntry *pOld = pCache->entries;
+    size_t oldSize = pCache->size;
+    size_t size;
+    size_t i;
+
+    size = ( oldSize != 0 ) ? oldSize * 2 : VARCACHE_INITIAL_SIZE;
+
+    pCache->entries = calloc( size, sizeof( VarCacheEntry ) );
+    if ( pCache->entries == NULL )
+    {
+        pCache->entries = pOld;
+        return ENOMEM;
+    }
+
+    pCache->size = size;
+
+    for ( i = 0; i < oldSize; i++ )
+    {
+        if ( pOld[i].name != NULL )
+        {
+            *Probe( pCache, pOld[i].name, pOld[i].hash ) = pOld[i];
+        }
+    }
+
+    free( pOld );
+
+    return EOK;
+}
+
+/*! @}
+ * end of varcache group */
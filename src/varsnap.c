@@ -0,0 +1,521 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup varsnap Variable Snapshot
+ * @brief Bulk snapshot of the variables referenced by the templates
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file varsnap.c
+
+    Variable Snapshot
+
+    The varsnap component takes a snapshot of the values of a set of
+    variables, so that every rendering during a transmission pass can
+    be formatted from the same values.  Each variable is retrieved
+    once per snapshot however many interfaces, channels and templates
+    reference it, and every payload of the pass carries a coherent set
+    of values.
+
+    The set of variables is sorted by handle so values can be looked up
+    with a binary search, and the string values are retrieved into an
+    arena which is only reallocated when the set grows.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <varserver/varserver.h>
+#include "varsnap.h"
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static size_t Search( const VarSnapshot *pSnap, VAR_HANDLE hVar );
+static int Grow( VarSnapshot *pSnap );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  VARSNAP_Add                                                               */
+/*!
+    Add a variable to a snapshot
+
+    The VARSNAP_Add function adds a variable to the set of variables
+    retrieved by VARSNAP_Take.  Adding a variable which is already in
+    the set has no effect.  The current snapshot is invalidated.
+
+    @param[in]
+        pSnap
+            pointer to the snapshot
+
+    @param[in]
+        hVar
+            handle of the variable to add
+
+    @retval EOK the variable is in the snapshot set
+    @retval ENOMEM memory allocation failed
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARSNAP_Add( VarSnapshot *pSnap, VAR_HANDLE hVar )
+{
+    int result = EINVAL;
+    size_t i;
+
+    if ( ( pSnap != NULL ) &&
+         ( hVar != VAR_INVALID ) )
+    {
+        result = EOK;
+
+        i = Search( pSnap, hVar );
+        if ( ( i == pSnap->n ) ||
+             ( pSnap->entries[i].hVar != hVar ) )
+        {
+            if ( pSnap->n == pSnap->max )
+            {
+                result = Grow( pSnap );
+            }
+
+            if ( result == EOK )
+            {
+                memmove( &pSnap->entries[i + 1],
+                         &pSnap->entries[i],
+                         ( pSnap->n - i ) * sizeof( VarSnapEntry ) );
+                memset( &pSnap->entries[i], 0, sizeof( VarSnapEntry ) );
+                pSnap->entries[i].hVar = hVar;
+                pSnap->n++;
+                pSnap->valid = false;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARSNAP_Reserve                                                           */
+/*!
+    Reserve space in a snapshot
+
+    The VARSNAP_Reserve function allocates space for at least the
+    specified number of variables, so they can be added to the snapshot
+    without allocating memory.
+
+    @param[in]
+        pSnap
+            pointer to the snapshot
+
+    @param[in]
+        n
+            number of variables to reserve space for
+
+    @retval EOK the space was reserved
+    @retval ENOMEM memory allocation failed
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARSNAP_Reserve( VarSnapshot *pSnap, size_t n )
+{
+    int result = EINVAL;
+
+    if ( pSnap != NULL )
+    {
+        result = EOK;
+        while ( ( result == EOK ) &&
+                ( pSnap->max < n ) )
+        {
+            result = Grow( pSnap );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARSNAP_Clear                                                             */
+/*!
+    Remove all of the variables from a snapshot
+
+    The VARSNAP_Clear function empties the set of variables retrieved
+    by VARSNAP_Take, keeping the allocated space for the next set.
+
+    @param[in]
+        pSnap
+            pointer to the snapshot
+
+==============================================================================*/
+void VARSNAP_Clear( VarSnapshot *pSnap )
+{
+    if ( pSnap != NULL )
+    {
+        pSnap->n = 0;
+        pSnap->valid = false;
+    }
+}
+
+/*============================================================================*/
+/*  VARSNAP_Take                                                              */
+/*!
+    Take a snapshot of the variable values
+
+    The VARSNAP_Take function retrieves the current value of every
+    variable in the snapshot set.  Variables which cannot be retrieved,
+    or whose type cannot be formatted from the snapshot, are marked as
+    not valid so that the caller falls back to retrieving them
+    directly.
+
+    @param[in]
+        pSnap
+            pointer to the snapshot
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @retval EOK the snapshot was taken
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARSNAP_Take( VarSnapshot *pSnap, VARSERVER_HANDLE hVarServer )
+{
+    int result = EINVAL;
+    VarSnapEntry *pEntry;
+    char *pStr;
+    size_t i;
+
+    if ( pSnap != NULL )
+    {
+        for ( i = 0; i < pSnap->n; i++ )
+        {
+            pEntry = &pSnap->entries[i];
+            pStr = &pSnap->arena[i * VARSNAP_STRING_LEN];
+
+            /* string values are copied into the entry's arena space */
+            memset( &pEntry->obj, 0, sizeof( VarObject ) );
+            pEntry->obj.val.str = pStr;
+            pEntry->obj.len = VARSNAP_STRING_LEN;
+
+            pEntry->valid = ( VAR_Get( hVarServer,
+                                       pEntry->hVar,
+                                       &pEntry->obj ) == EOK );
+
+            switch( pEntry->obj.type )
+            {
+                case VARTYPE_UINT16:
+                case VARTYPE_INT16:
+                case VARTYPE_UINT32:
+                case VARTYPE_INT32:
+                case VARTYPE_UINT64:
+                case VARTYPE_INT64:
+                case VARTYPE_FLOAT:
+                    break;
+
+                case VARTYPE_STR:
+                    pStr[VARSNAP_STRING_LEN - 1] = '\0';
+                    break;
+
+                default:
+                    pEntry->valid = false;
+                    break;
+            }
+        }
+
+        pSnap->valid = true;
+        pSnap->count++;
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARSNAP_Invalidate                                                        */
+/*!
+    Invalidate a snapshot
+
+    The VARSNAP_Invalidate function marks the snapshot values as out of
+    date, so that they are not used until the next VARSNAP_Take.
+
+    @param[in]
+        pSnap
+            pointer to the snapshot
+
+==============================================================================*/
+void VARSNAP_Invalidate( VarSnapshot *pSnap )
+{
+    if ( pSnap != NULL )
+    {
+        pSnap->valid = false;
+    }
+}
+
+/*============================================================================*/
+/*  VARSNAP_Get                                                               */
+/*!
+    Get the value of a variable from a snapshot
+
+    @param[in]
+        pSnap
+            pointer to the snapshot, or NULL if no snapshot is used
+
+    @param[in]
+        hVar
+            handle of the variable to get
+
+    @retval pointer to the variable value in the snapshot
+    @retval NULL the snapshot does not hold a valid value for the variable
+
+==============================================================================*/
+const VarObject *VARSNAP_Get( const VarSnapshot *pSnap, VAR_HANDLE hVar )
+{
+    const VarObject *pObj = NULL;
+    size_t i;
+
+    if ( ( pSnap != NULL ) &&
+         ( pSnap->valid == true ) )
+    {
+        i = Search( pSnap, hVar );
+        if ( ( i < pSnap->n ) &&
+             ( pSnap->entries[i].hVar == hVar ) &&
+             ( pSnap->entries[i].valid == true ) )
+        {
+            pObj = &pSnap->entries[i].obj;
+        }
+    }
+
+    return pObj;
+}
+
+/*============================================================================*/
+/*  VARSNAP_Format                                                            */
+/*!
+    Format a variable value as text
+
+    The VARSNAP_Format function formats a snapshot value as text, with
+    integers in decimal and floats with six decimal places.
+
+    @param[in]
+        pObj
+            pointer to the variable value
+
+    @param[out]
+        pBuf
+            pointer to the buffer to store the text
+
+    @param[in]
+        size
+            size of the buffer
+
+    @retval length of the formatted text, which is truncated to fit
+            the buffer
+
+==============================================================================*/
+size_t VARSNAP_Format( const VarObject *pObj, char *pBuf, size_t size )
+{
+    int n = 0;
+
+    if ( ( pObj == NULL ) ||
+         ( pBuf == NULL ) ||
+         ( size == 0 ) )
+    {
+        return 0;
+    }
+
+    switch( pObj->type )
+    {
+        case VARTYPE_UINT16:
+            n = snprintf( pBuf, size, "%" PRIu16, pObj->val.ui );
+            break;
+
+        case VARTYPE_INT16:
+            n = snprintf( pBuf, size, "%" PRId16, pObj->val.i );
+            break;
+
+        case VARTYPE_UINT32:
+            n = snprintf( pBuf, size, "%" PRIu32, pObj->val.ul );
+            break;
+
+        case VARTYPE_INT32:
+            n = snprintf( pBuf, size, "%" PRId32, pObj->val.l );
+            break;
+
+        case VARTYPE_UINT64:
+            n = snprintf( pBuf, size, "%" PRIu64, pObj->val.ull );
+            break;
+
+        case VARTYPE_INT64:
+            n = snprintf( pBuf, size, "%" PRId64, pObj->val.ll );
+            break;
+
+        case VARTYPE_FLOAT:
+            n = snprintf( pBuf, size, "%f", pObj->val.f );
+            break;
+
+        case VARTYPE_STR:
+            n = snprintf( pBuf, size, "%s", pObj->val.str );
+            break;
+
+        default:
+            pBuf[0] = '\0';
+            break;
+    }
+
+    if ( n < 0 )
+    {
+        n = 0;
+    }
+
+    return ( (size_t)n < size ) ? (size_t)n : size - 1;
+}
+
+/*============================================================================*/
+/*  VARSNAP_Free                                                              */
+/*!
+    Free a snapshot
+
+    The VARSNAP_Free function releases the memory used by the snapshot,
+    leaving it empty.
+
+    @param[in]
+        pSnap
+            pointer to the snapshot
+
+==============================================================================*/
+void VARSNAP_Free( VarSnapshot *pSnap )
+{
+    if ( pSnap != NULL )
+    {
+        free( pSnap->entries );
+        free( pSnap->arena );
+        memset( pSnap, 0, sizeof( VarSnapshot ) );
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  Search                                                                    */
+/*!
+    Find the position of a variable in a snapshot
+
+    The Search function performs a binary search of the snapshot
+    entries for a variable handle.
+
+    @param[in]
+        pSnap
+            pointer to the snapshot
+
+    @param[in]
+        hVar
+            handle of the variable to search for
+
+    @retval index of the variable's entry, or of the first entry with a
+            larger handle, which is where the variable would be inserted
+
+==============================================================================*/
+static size_t Search( const VarSnapshot *pSnap, VAR_HANDLE hVar )
+{
+    size_t lo = 0;
+    size_t hi = pSnap->n;
+    size_t mid;
+
+    while ( lo < hi )
+    {
+        mid = lo + ( hi - lo ) / 2;
+        if ( pSnap->entries[mid].hVar < hVar )
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+/*============================================================================*/
+/*  Grow                                                                      */
+/*!
+    Grow the space allocated for a snapshot
+
+    The Grow function doubles the number of snapshot entries, and the
+    arena space for their string values.
+
+    @param[in]
+        pSnap
+            pointer to the snapshot
+
+    @retval EOK the snapshot space was grown
+    @retval ENOMEM memory allocation failed
+
+==============================================================================*/
+static int Grow( VarSnapshot *pSnap )
+{
+    int result = ENOMEM;
+    size_t max = ( pSnap->max > 0 ) ? pSnap->max * 2 : 16;
+    VarSnapEntry *pEntries;
+    char *pArena;
+
+    pEntries = realloc( pSnap->entries, max * sizeof( VarSnapEntry ) );
+    if ( pEntries != NULL )
+    {
+        pSnap->entries = pEntries;
+
+        pArena = realloc( pSnap->arena, max * VARSNAP_STRING_LEN );
+        if ( pArena != NULL )
+        {
+            pSnap->arena = pArena;
+            pSnap->max = max;
+
+            /* the string values moved with the arena */
+            pSnap->valid = false;
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*! @}
+ * end of varsnap group */
@@ -0,0 +1,1865 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup udpt_selftest UDP Template Engine Self Test
+ * @brief Self test of the udpt and udpt-listen modules
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file udpt_selftest.c
+
+    UDP Template Engine Self Test
+
+    The udpt_selftest application exercises the modules of udpt and
+    udpt-listen which work without a variable server or a network
+    configuration, through their public functions.  Each check which
+    fails is reported on stderr, and the exit status is the number of
+    failed checks, so it can be run with ctest.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <varserver/varserver.h>
+#include "txsched.h"
+#include "histogram.h"
+#include "udptmsg.h"
+#include "compress.h"
+#include "cbor.h"
+#include "txbatch.h"
+#include "sublist.h"
+#include "ifset.h"
+#include "reasm.h"
+#include "pacing.h"
+#include "loadgen.h"
+#include "jsonobj.h"
+#include "ctemplate.h"
+#include "varsnap.h"
+#include "varstub.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! report a failed check */
+#define CHECK( cond ) Check( ( cond ), #cond, __LINE__ )
+
+/*! number of variable references in the test templates, enough for the
+    element array to be grown several times */
+#define TEST_TEMPLATE_VARS ( 100 )
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! number of checks which failed */
+static int failures;
+
+/*! payload larger than a transmit slot */
+static char bigPayload[TXBATCH_SLOT_SIZE + 1];
+
+/*! transmit batch, too large for the stack */
+static TxBatch batch;
+
+/*! interface table, too large for the stack */
+static IfTable ifTable;
+
+/*! segment data larger than REASM_MAX_SEGMENT */
+static char bigSegment[REASM_MAX_SEGMENT + 1];
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+int main( int argc, char **argv );
+static void Check( bool ok, const char *cond, int line );
+static void TestSchedOrder( void );
+static void TestSchedFull( void );
+static void TestSchedAlign( void );
+static void TestHistogram( void );
+static void TestSegmentHeader( void );
+static void TestCompressedHeader( void );
+static void TestCompress( void );
+static int EncodeCBOR( CborWriter *pWriter );
+static void TestCBOREncode( void );
+static void TestCBORDecode( void );
+static int OpenLoopback( struct sockaddr_in *pAddr );
+static void TestBatchCopy( void );
+static void TestSubList( void );
+static void TestSubBackoff( void );
+static void TestIfSetMatch( void );
+static void TestIfSetResolve( void );
+static int AddSegment( Reasm *pReasm,
+                       const struct sockaddr_in *pSource,
+                       uint16_t msgId,
+                       uint16_t index,
+                       uint16_t count,
+                       const char *pData,
+                       size_t len,
+                       uint64_t now_ns,
+                       const char **ppPayload,
+                       size_t *pLen );
+static void TestReasmOrder( void );
+static void TestReasmEarlyLast( void );
+static void TestReasmDuplicate( void );
+static void TestReasmInvalid( void );
+static void TestReasmSources( void );
+static void TestPacingParse( void );
+static void TestPacingAdmit( void );
+static void TestLoadGenParse( void );
+static void TestLoadGenRate( void );
+static int Parse( JsonObject *pObject, const char *pText );
+static void TestJSONValues( void );
+static void TestJSONMalformed( void );
+static void TestJSONLimits( void );
+static int MakeTemplate( char *filename, size_t nVars );
+static void DirtyHeap( void );
+static size_t CountNotified( CompiledTemplate *pTemplate );
+static void TestTemplateSubscribe( void );
+static int RenderCached( CompiledTemplate *pTemplate,
+                         VarSnapshot *pSnap,
+                         CTBuffer *pBuffer );
+static void TestTemplateCached( void );
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  main                                                                      */
+/*!
+    Main entry point for the UDP Template Engine self test
+
+    @param[in]
+        argc
+            number of arguments on the command line
+            (including the command itself)
+
+    @param[in]
+        argv
+            array of pointers to the command line arguments
+
+    @return the number of failed checks
+
+==============================================================================*/
+int main( int argc, char **argv )
+{
+    (void)argc;
+    (void)argv;
+
+    TestSchedOrder();
+    TestSchedFull();
+    TestSchedAlign();
+    TestHistogram();
+    TestSegmentHeader();
+    TestCompressedHeader();
+    TestCompress();
+    TestCBOREncode();
+    TestCBORDecode();
+    TestBatchCopy();
+    TestSubList();
+    TestSubBackoff();
+    TestIfSetMatch();
+    TestIfSetResolve();
+    TestReasmOrder();
+    TestReasmEarlyLast();
+    TestReasmDuplicate();
+    TestReasmInvalid();
+    TestReasmSources();
+    TestPacingParse();
+    TestPacingAdmit();
+    TestLoadGenParse();
+    TestLoadGenRate();
+    TestJSONValues();
+    TestJSONMalformed();
+    TestJSONLimits();
+    TestTemplateSubscribe();
+    TestTemplateCached();
+
+    printf( "udpt_selftest: %d failure(s)\n", failures );
+
+    return failures;
+}
+
+/*============================================================================*/
+/*  Check                                                                     */
+/*!
+    Record the outcome of a check
+
+    @param[in]
+        ok
+            true if the check passed
+
+    @param[in]
+        cond
+            text of the checked condition
+
+    @param[in]
+        line
+            source line of the check
+
+==============================================================================*/
+static void Check( bool ok, const char *cond, int line )
+{
+    if ( ok == false )
+    {
+        fprintf( stderr, "udpt_selftest.c:%d: check failed: %s\n", line, cond );
+        failures++;
+    }
+}
+
+/*============================================================================*/
+/*  TestSchedOrder                                                            */
+/*!
+    Check that channels leave the schedule in deadline order
+
+==============================================================================*/
+static void TestSchedOrder( void )
+{
+    static uint64_t deadlines[] = { 50, 10, 40, 30, 20, 60, 0, 70 };
+    size_t n = sizeof( deadlines ) / sizeof( deadlines[0] );
+    Schedule sched;
+    uint64_t deadline = 0;
+    uint64_t last = 0;
+    void *pCtx = NULL;
+    size_t i;
+
+    SCHED_Init( &sched );
+    CHECK( SCHED_Peek( &sched, &deadline, &pCtx ) == ENOENT );
+
+    for ( i = 0; i < n; i++ )
+    {
+        CHECK( SCHED_Insert( &sched, deadlines[i], &deadlines[i] ) == EOK );
+    }
+
+    /* the earliest deadline is at the root */
+    CHECK( SCHED_Peek( &sched, &deadline, &pCtx ) == EOK );
+    CHECK( ( deadline == 0 ) && ( pCtx == &deadlines[6] ) );
+
+    /* an entry can be removed from the middle of the heap */
+    CHECK( SCHED_Remove( &sched, &deadlines[3] ) == EOK );
+    CHECK( SCHED_Remove( &sched, &deadlines[3] ) == ENOENT );
+
+    for ( i = 0; SCHED_Pop( &sched, &deadline, &pCtx ) == EOK; i++ )
+    {
+        CHECK( deadline >= last );
+        CHECK( *(uint64_t *)pCtx == deadline );
+        CHECK( deadline != deadlines[3] );
+        last = deadline;
+    }
+
+    CHECK( i == n - 1 );
+}
+
+/*============================================================================*/
+/*  TestSchedFull                                                             */
+/*!
+    Check that a full schedule refuses more channels
+
+==============================================================================*/
+static void TestSchedFull( void )
+{
+    Schedule sched;
+    uint64_t deadline = 0;
+    void *pCtx = NULL;
+    size_t i;
+
+    SCHED_Init( &sched );
+
+    for ( i = 0; i < SCHED_MAX_ENTRIES; i++ )
+    {
+        CHECK( SCHED_Insert( &sched, SCHED_MAX_ENTRIES - i, NULL ) == EOK );
+    }
+
+    CHECK( SCHED_Insert( &sched, 0, NULL ) == ENOSPC );
+    CHECK( SCHED_Insert( NULL, 0, NULL ) == EINVAL );
+
+    /* the refused deadline did not replace the earliest one */
+    CHECK( SCHED_Peek( &sched, &deadline, &pCtx ) == EOK );
+    CHECK( deadline == 1 );
+}
+
+/*============================================================================*/
+/*  TestSchedAlign                                                            */
+/*!
+    Check that periodic deadlines are aligned to the wall clock grid
+
+==============================================================================*/
+static void TestSchedAlign( void )
+{
+    /* no period leaves the deadline unaligned */
+    CHECK( SCHED_Align( 1000, 0, 0, 0 ) == 1000 );
+
+    /* the next multiple of the period, which is never now */
+    CHECK( SCHED_Align( 1000, 300, 0, 0 ) == 1200 );
+    CHECK( SCHED_Align( 1200, 300, 0, 0 ) == 1500 );
+
+    /* a phase offset moves the grid, modulo the period */
+    CHECK( SCHED_Align( 1000, 300, 50, 0 ) == 1250 );
+    CHECK( SCHED_Align( 1000, 300, 350, 0 ) == 1250 );
+
+    /* the grid is on the clock which is epoch ahead of now */
+    CHECK( SCHED_Align( 1000, 300, 0, 100 ) == 1100 );
+}
+
+/*============================================================================*/
+/*  TestHistogram                                                             */
+/*!
+    Check the bucket and statistics of recorded latencies
+
+==============================================================================*/
+static void TestHistogram( void )
+{
+    Histogram histogram;
+
+    memset( &histogram, 0, sizeof( histogram ) );
+
+    HISTOGRAM_Record( &histogram, 500 );
+    HISTOGRAM_Record( &histogram, 1000 );
+    HISTOGRAM_Record( &histogram, 1999 );
+    HISTOGRAM_Record( &histogram, 3000 );
+    HISTOGRAM_Record( &histogram, 4000 );
+    HISTOGRAM_Record( &histogram, 3600000000000ULL );
+    HISTOGRAM_Record( NULL, 1000 );
+
+    /* below 1us, then one bucket per power of two microseconds */
+    CHECK( histogram.buckets[0] == 1 );
+    CHECK( histogram.buckets[1] == 2 );
+    CHECK( histogram.buckets[2] == 1 );
+    CHECK( histogram.buckets[3] == 1 );
+
+    /* the last bucket holds everything larger */
+    CHECK( histogram.buckets[HISTOGRAM_BUCKETS - 1] == 1 );
+
+    CHECK( histogram.count == 6 );
+    CHECK( histogram.min_ns == 500 );
+    CHECK( histogram.max_ns == 3600000000000ULL );
+    CHECK( histogram.sum_ns == 3600000010499ULL );
+}
+
+/*============================================================================*/
+/*  TestSegmentHeader                                                         */
+/*!
+    Check the encoding and validation of segment headers
+
+==============================================================================*/
+static void TestSegmentHeader( void )
+{
+    char buf[UDPTMSG_SEGMENT_HEADER_SIZE];
+    UDPTSegment segment;
+
+    CHECK( UDPTMSG_WriteSegmentHeader( buf, 0x1234, 2, 3 ) == sizeof( buf ) );
+    CHECK( (unsigned char)buf[0] == UDPTMSG_MAGIC );
+
+    /* the header is in network byte order */
+    CHECK( ( buf[2] == 0x12 ) && ( buf[3] == 0x34 ) );
+
+    CHECK( UDPTMSG_ParseSegmentHeader( buf, sizeof( buf ), &segment ) == EOK );
+    CHECK( ( segment.msgId == 0x1234 ) &&
+           ( segment.index == 2 ) &&
+           ( segment.count == 3 ) );
+
+    /* a truncated header */
+    CHECK( UDPTMSG_ParseSegmentHeader( buf,
+                                       sizeof( buf ) - 1,
+                                       &segment ) == EBADMSG );
+
+    /* an index beyond the segment count */
+    (void)UDPTMSG_WriteSegmentHeader( buf, 0x1234, 3, 3 );
+    CHECK( UDPTMSG_ParseSegmentHeader( buf,
+                                       sizeof( buf ),
+                                       &segment ) == EBADMSG );
+
+    /* a payload which is not segmented */
+    CHECK( UDPTMSG_ParseSegmentHeader( "{\"a\":1}", 7, &segment ) == ENOENT );
+    CHECK( UDPTMSG_ParseSegmentHeader( NULL, 0, &segment ) == EINVAL );
+}
+
+/*============================================================================*/
+/*  TestCompressedHeader                                                      */
+/*!
+    Check the encoding and validation of compressed payload headers
+
+==============================================================================*/
+static void TestCompressedHeader( void )
+{
+    char buf[UDPTMSG_COMPRESSED_HEADER_SIZE];
+    UDPTCompressed compressed;
+
+    CHECK( UDPTMSG_WriteCompressedHeader( buf,
+                                          COMPRESS_ZSTD,
+                                          0xdeadbeef,
+                                          100000 ) == sizeof( buf ) );
+    CHECK( UDPTMSG_ParseCompressedHeader( buf,
+                                          sizeof( buf ),
+                                          &compressed ) == EOK );
+    CHECK( ( compressed.algorithm == COMPRESS_ZSTD ) &&
+           ( compressed.dictId == 0xdeadbeef ) &&
+           ( compressed.len == 100000 ) );
+
+    /* a truncated header */
+    CHECK( UDPTMSG_ParseCompressedHeader( buf,
+                                          sizeof( buf ) - 1,
+                                          &compressed ) == EBADMSG );
+
+    /* a segment is not a compressed payload */
+    (void)UDPTMSG_WriteSegmentHeader( buf, 1, 0, 1 );
+    CHECK( UDPTMSG_ParseCompressedHeader( buf,
+                                          sizeof( buf ),
+                                          &compressed ) == ENOENT );
+}
+
+/*============================================================================*/
+/*  TestCompress                                                              */
+/*!
+    Check the round trip of payloads compressed with a dictionary
+
+    Each compression algorithm udpt is built with must shrink a
+    repetitive payload and restore it.  The others are reported as not
+    supported.
+
+==============================================================================*/
+static void TestCompress( void )
+{
+    static const int algorithms[] = { COMPRESS_LZ4, COMPRESS_ZSTD };
+    Compressor compressor;
+    char text[512];
+    char packed[1024];
+    char unpacked[512];
+    size_t packedLen = 0;
+    size_t unpackedLen = 0;
+    size_t len = 0;
+    uint32_t dictId;
+    size_t i;
+    int rc;
+
+    /* a repetitive payload, like a rendered template */
+    for ( i = 0; len + 32 < sizeof( text ); i++ )
+    {
+        len += (size_t)sprintf( &text[len], "{\"/v%zu\":%zu},", i % 4, i );
+    }
+
+    COMPRESS_Init( &compressor );
+    CHECK( COMPRESS_IsSupported( COMPRESS_NONE ) );
+
+    /* the dictionary identifier depends only on the dictionary */
+    CHECK( COMPRESS_SetDictionary( &compressor, text, 64 ) == EOK );
+    dictId = compressor.dictId;
+    CHECK( dictId != 0 );
+    CHECK( COMPRESS_SetDictionary( &compressor, text, 64 ) == EOK );
+    CHECK( compressor.dictId == dictId );
+
+    CHECK( COMPRESS_Compress( &compressor,
+                              COMPRESS_NONE,
+                              text,
+                              len,
+                              packed,
+                              sizeof( packed ),
+                              &packedLen ) == ENOTSUP );
+
+    for ( i = 0; i < sizeof( algorithms ) / sizeof( algorithms[0] ); i++ )
+    {
+        rc = COMPRESS_Compress( &compressor,
+                                algorithms[i],
+                                text,
+                                len,
+                                packed,
+                                sizeof( packed ),
+                                &packedLen );
+        if ( COMPRESS_IsSupported( algorithms[i] ) )
+        {
+            CHECK( rc == EOK );
+            CHECK( packedLen < len );
+            CHECK( COMPRESS_Decompress( &compressor,
+                                        algorithms[i],
+                                        packed,
+                                        packedLen,
+                                        unpacked,
+                                        sizeof( unpacked ),
+                                        &unpackedLen ) == EOK );
+            CHECK( ( unpackedLen == len ) &&
+                   ( memcmp( unpacked, text, len ) == 0 ) );
+        }
+        else
+        {
+            CHECK( rc == ENOTSUP );
+        }
+    }
+
+    COMPRESS_Free( &compressor );
+}
+
+/*============================================================================*/
+/*  EncodeCBOR                                                                */
+/*!
+    Encode one data item of each type the CBOR writer supports
+
+    @param[in]
+        pWriter
+            pointer to the CBOR writer, initialized with its output buffer
+
+    @return the result of CBOR_Result
+
+==============================================================================*/
+static int EncodeCBOR( CborWriter *pWriter )
+{
+    CBOR_Array( pWriter, 6 );
+    CBOR_UInt( pWriter, 1 );
+    CBOR_UInt( pWriter, 500 );
+    CBOR_Int( pWriter, -10 );
+    CBOR_Float( pWriter, 1.5f );
+    CBOR_Text( pWriter, "abc", 3 );
+    CBOR_Null( pWriter );
+
+    return CBOR_Result( pWriter );
+}
+
+/*============================================================================*/
+/*  TestCBOREncode                                                            */
+/*!
+    Check the CBOR encoding of each data item type and the CBOR header
+
+==============================================================================*/
+static void TestCBOREncode( void )
+{
+    static const unsigned char expected[] =
+    {
+        0x86,                       /* array of 6 */
+        0x01,                       /* 1 */
+        0x19, 0x01, 0xf4,           /* 500 */
+        0x29,                       /* -10 */
+        0xfa, 0x3f, 0xc0, 0x00, 0x00, /* 1.5 */
+        0x63, 'a', 'b', 'c',        /* "abc" */
+        0xf6                        /* null */
+    };
+    CborWriter writer;
+    char buf[32];
+    uint32_t schemaId = 0;
+
+    CBOR_Init( &writer, buf, sizeof( buf ) );
+    CHECK( EncodeCBOR( &writer ) == EOK );
+    CHECK( ( writer.len == sizeof( expected ) ) &&
+           ( memcmp( buf, expected, sizeof( expected ) ) == 0 ) );
+
+    /* data items which do not fit in the buffer */
+    CBOR_Init( &writer, buf, 8 );
+    CHECK( EncodeCBOR( &writer ) == E2BIG );
+    CHECK( writer.len <= 8 );
+
+    CHECK( UDPTMSG_WriteCBORHeader( buf, 0x01020304 ) ==
+           UDPTMSG_CBOR_HEADER_SIZE );
+    CHECK( UDPTMSG_ParseCBORHeader( buf,
+                                    UDPTMSG_CBOR_HEADER_SIZE,
+                                    &schemaId ) == EOK );
+    CHECK( schemaId == 0x01020304 );
+    CHECK( UDPTMSG_ParseCBORHeader( buf,
+                                    UDPTMSG_CBOR_HEADER_SIZE - 1,
+                                    &schemaId ) == EBADMSG );
+}
+
+/*============================================================================*/
+/*  TestCBORDecode                                                            */
+/*!
+    Check that the CBOR reader decodes what the CBOR writer encodes
+
+==============================================================================*/
+static void TestCBORDecode( void )
+{
+    CborWriter writer;
+    CborReader reader;
+    CborItem item;
+    char buf[32];
+
+    CBOR_Init( &writer, buf, sizeof( buf ) );
+    CHECK( EncodeCBOR( &writer ) == EOK );
+
+    CBOR_InitReader( &reader, buf, writer.len );
+    CHECK( CBOR_Read( &reader, &item ) == EOK );
+    CHECK( ( item.type == CBOR_TYPE_ARRAY ) && ( item.len == 6 ) );
+    CHECK( CBOR_Read( &reader, &item ) == EOK );
+    CHECK( ( item.type == CBOR_TYPE_UINT ) && ( item.val.u == 1 ) );
+    CHECK( CBOR_Read( &reader, &item ) == EOK );
+    CHECK( ( item.type == CBOR_TYPE_UINT ) && ( item.val.u == 500 ) );
+    CHECK( CBOR_Read( &reader, &item ) == EOK );
+    CHECK( ( item.type == CBOR_TYPE_INT ) && ( item.val.i == -10 ) );
+    CHECK( CBOR_Read( &reader, &item ) == EOK );
+    CHECK( ( item.type == CBOR_TYPE_FLOAT ) && ( item.val.d == 1.5 ) );
+    CHECK( CBOR_Read( &reader, &item ) == EOK );
+    CHECK( ( item.type == CBOR_TYPE_TEXT ) &&
+           ( item.len == 3 ) &&
+           ( memcmp( item.pText, "abc", 3 ) == 0 ) );
+    CHECK( CBOR_Read( &reader, &item ) == EOK );
+    CHECK( item.type == CBOR_TYPE_NULL );
+    CHECK( CBOR_Read( &reader, &item ) == ENODATA );
+
+    /* a data item cut short by the end of the payload */
+    CBOR_InitReader( &reader, buf, 3 );
+    CHECK( CBOR_Read( &reader, &item ) == EOK );
+    CHECK( CBOR_Read( &reader, &item ) == EOK );
+    CHECK( CBOR_Read( &reader, &item ) == EBADMSG );
+}
+
+/*============================================================================*/
+/*  OpenLoopback                                                              */
+/*!
+    Open a UDP socket bound to an ephemeral loopback port
+
+    @param[out]
+        pAddr
+            pointer to a location to store the bound address
+
+    @retval socket file descriptor
+    @retval -1 the socket could not be opened
+
+==============================================================================*/
+static int OpenLoopback( struct sockaddr_in *pAddr )
+{
+    struct timeval timeout = { 1, 0 };
+    socklen_t addrlen = sizeof( struct sockaddr_in );
+    int fd;
+
+    memset( pAddr, 0, sizeof( struct sockaddr_in ) );
+    pAddr->sin_family = AF_INET;
+    pAddr->sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+
+    fd = socket( AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0 );
+    if ( ( fd != -1 ) &&
+         ( ( bind( fd, (struct sockaddr *)pAddr, addrlen ) != 0 ) ||
+           ( getsockname( fd, (struct sockaddr *)pAddr, &addrlen ) != 0 ) ||
+           ( setsockopt( fd, SOL_SOCKET, SO_RCVTIMEO,
+                         &timeout, sizeof( timeout ) ) != 0 ) ) )
+    {
+        close( fd );
+        fd = -1;
+    }
+
+    return fd;
+}
+
+/*============================================================================*/
+/*  TestBatchCopy                                                             */
+/*!
+    Check that a queued datagram is sent as it was when it was queued
+
+    A datagram is queued from a render buffer, the buffer is overwritten,
+    as it is by the next render before a sender thread gets to the
+    batch, and the batch is then sent.  The first contents of the buffer
+    must be received, not the second.
+
+==============================================================================*/
+static void TestBatchCopy( void )
+{
+    struct sockaddr_in addr;
+    char text[64];
+    char rx[64];
+    char *pSlot;
+    size_t size;
+    ssize_t n;
+    int rxFd;
+    int txFd;
+
+    rxFd = OpenLoopback( &addr );
+    txFd = socket( AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0 );
+    CHECK( rxFd != -1 );
+    CHECK( txFd != -1 );
+
+    if ( ( rxFd != -1 ) && ( txFd != -1 ) )
+    {
+        TXBATCH_Reset( &batch );
+
+        /* queue the first render */
+        strcpy( text, "render 1" );
+        CHECK( TXBATCH_AddCopy( &batch,
+                                txFd,
+                                (struct sockaddr *)&addr,
+                                sizeof( addr ),
+                                text,
+                                strlen( text ),
+                                NULL ) == EOK );
+
+        /* a payload built in its slot is queued in place */
+        pSlot = TXBATCH_GetSlot( &batch, &size );
+        CHECK( pSlot != NULL );
+        if ( pSlot != NULL )
+        {
+            strcpy( pSlot, "slot" );
+            CHECK( TXBATCH_AddCopy( &batch,
+                                    txFd,
+                                    (struct sockaddr *)&addr,
+                                    sizeof( addr ),
+                                    pSlot,
+                                    strlen( pSlot ),
+                                    NULL ) == EOK );
+            CHECK( batch.iov[1].iov_base == pSlot );
+        }
+
+        /* a payload larger than a slot is not queued */
+        CHECK( TXBATCH_AddCopy( &batch,
+                                txFd,
+                                (struct sockaddr *)&addr,
+                                sizeof( addr ),
+                                bigPayload,
+                                sizeof( bigPayload ),
+                                NULL ) == E2BIG );
+
+        /* render again before the batch is sent */
+        strcpy( text, "render 2" );
+
+        CHECK( TXBATCH_Send( &batch ) == EOK );
+
+        n = recv( rxFd, rx, sizeof( rx ), 0 );
+        CHECK( ( n == 8 ) && ( memcmp( rx, "render 1", 8 ) == 0 ) );
+
+        n = recv( rxFd, rx, sizeof( rx ), 0 );
+        CHECK( ( n == 4 ) && ( memcmp( rx, "slot", 4 ) == 0 ) );
+    }
+
+    if ( rxFd != -1 )
+    {
+        close( rxFd );
+    }
+
+    if ( txFd != -1 )
+    {
+        close( txFd );
+    }
+}
+
+/*============================================================================*/
+/*  TestSubList                                                               */
+/*!
+    Check the parsing and address lookup of a subscriber list
+
+==============================================================================*/
+static void TestSubList( void )
+{
+    SubList list;
+    struct sockaddr_storage addr;
+    struct sockaddr_in *pIn4 = (struct sockaddr_in *)&addr;
+    struct sockaddr_in6 *pIn6 = (struct sockaddr_in6 *)&addr;
+
+    memset( &list, 0, sizeof( list ) );
+
+    CHECK( SUBLIST_Parse( &list,
+                          "127.0.0.1:5000, [::1]:6000 127.0.0.2" ) == EOK );
+    CHECK( list.n == 3 );
+    if ( list.n == 3 )
+    {
+        SUBLIST_GetAddr( &list.entries[0], 4000, &addr );
+        CHECK( ( addr.ss_family == AF_INET ) &&
+               ( ntohs( pIn4->sin_port ) == 5000 ) );
+        CHECK( SUBLIST_Find( &list,
+                             (struct sockaddr *)&addr,
+                             4000 ) == &list.entries[0] );
+
+        SUBLIST_GetAddr( &list.entries[1], 4000, &addr );
+        CHECK( ( addr.ss_family == AF_INET6 ) &&
+               ( ntohs( pIn6->sin6_port ) == 6000 ) );
+        CHECK( SUBLIST_Find( &list,
+                             (struct sockaddr *)&addr,
+                             4000 ) == &list.entries[1] );
+
+        /* the channel port is used when the entry has none */
+        SUBLIST_GetAddr( &list.entries[2], 4000, &addr );
+        CHECK( ( addr.ss_family == AF_INET ) &&
+               ( ntohs( pIn4->sin_port ) == 4000 ) );
+        CHECK( SUBLIST_Find( &list,
+                             (struct sockaddr *)&addr,
+                             4000 ) == &list.entries[2] );
+
+        pIn4->sin_port = htons( 4001 );
+        CHECK( SUBLIST_Find( &list, (struct sockaddr *)&addr, 4000 ) == NULL );
+    }
+
+    /* invalid entries are skipped */
+    CHECK( SUBLIST_Parse( &list,
+                          "127.0.0.1:0 [::1 127.0.0.1:70000 127.0.0.3:7" ) ==
+           EINVAL );
+    CHECK( list.n == 1 );
+
+    /* host names are not looked up */
+    CHECK( SUBLIST_Parse( &list, "localhost:5000 127.0.0.1" ) == EINVAL );
+    CHECK( list.n == 1 );
+
+    CHECK( SUBLIST_Parse( &list, "" ) == EOK );
+    CHECK( list.n == 0 );
+
+    SUBLIST_Free( &list );
+}
+
+/*============================================================================*/
+/*  TestSubBackoff                                                            */
+/*!
+    Check the backoff of a subscriber which reports errors
+
+==============================================================================*/
+static void TestSubBackoff( void )
+{
+    uint64_t now = 1000 * SUBLIST_BACKOFF_MIN_NS;
+    uint64_t min = SUBLIST_BACKOFF_MIN_NS;
+    Subscriber sub;
+    uint32_t i;
+
+    memset( &sub, 0, sizeof( sub ) );
+    CHECK( SUBLIST_Ready( &sub, now ) );
+
+    SUBLIST_Failure( &sub, ECONNREFUSED, now );
+    CHECK( SUBLIST_Ready( &sub, now ) == false );
+    CHECK( SUBLIST_Ready( &sub, now + min ) );
+
+    /* the backoff doubles with every consecutive error */
+    SUBLIST_Failure( &sub, ECONNREFUSED, now + min );
+    CHECK( SUBLIST_Ready( &sub, now + 2 * min ) == false );
+    CHECK( SUBLIST_Ready( &sub, now + 3 * min ) );
+
+    /* errors for datagrams sent before the backoff do not extend it */
+    SUBLIST_Failure( &sub, ECONNREFUSED, now + min + 1 );
+    CHECK( SUBLIST_Ready( &sub, now + 3 * min ) );
+    CHECK( ( sub.errcount == 3 ) && ( sub.lastError == ECONNREFUSED ) );
+
+    /* up to the longest backoff */
+    for ( i = 0; i < 16; i++ )
+    {
+        now = sub.retry_ns;
+        SUBLIST_Failure( &sub, ECONNREFUSED, now );
+    }
+
+    CHECK( sub.retry_ns - now == SUBLIST_BACKOFF_MAX_NS );
+
+    /* a subscriber which recovered starts again from the shortest */
+    now += 3 * SUBLIST_BACKOFF_MAX_NS;
+    SUBLIST_Failure( &sub, ECONNREFUSED, now );
+    CHECK( sub.retry_ns - now == min );
+}
+
+/*============================================================================*/
+/*  TestIfSetMatch                                                            */
+/*!
+    Check the matching of interface names against an allow-list
+
+==============================================================================*/
+static void TestIfSetMatch( void )
+{
+    IfSet set;
+
+    memset( &set, 0, sizeof( set ) );
+
+    CHECK( IFSET_Parse( &set, "eth*, !eth1 wlan0" ) == EOK );
+    CHECK( ( set.nPatterns == 3 ) && ( set.nIncludes == 2 ) );
+    CHECK( IFSET_Match( &set, "eth0" ) );
+    CHECK( IFSET_Match( &set, "eth1" ) == false );
+    CHECK( IFSET_Match( &set, "wlan0" ) );
+    CHECK( IFSET_Match( &set, "lo" ) == false );
+
+    /* only exclusions allow every other interface */
+    CHECK( IFSET_Parse( &set, "!lo" ) == EOK );
+    CHECK( IFSET_Match( &set, "eth0" ) );
+    CHECK( IFSET_Match( &set, "lo" ) == false );
+
+    /* an empty list allows every interface */
+    CHECK( IFSET_Parse( &set, "" ) == EOK );
+    CHECK( IFSET_Match( &set, "lo" ) );
+
+    /* a rejected list keeps the previous list */
+    CHECK( IFSET_Parse( &set, "eth0" ) == EOK );
+    CHECK( IFSET_Parse( &set, "wlan0 an_interface_name_which_is_too_long" ) ==
+           E2BIG );
+    CHECK( IFSET_Match( &set, "eth0" ) );
+    CHECK( IFSET_Match( &set, "wlan0" ) == false );
+
+    IFSET_Free( &set );
+
+    /* a rejected list with nothing to fall back to allows nothing */
+    CHECK( IFSET_Parse( &set, "!" ) == E2BIG );
+    CHECK( IFSET_Match( &set, "eth0" ) == false );
+    CHECK( IFSET_Match( &set, "lo" ) == false );
+
+    CHECK( IFSET_Parse( &set, "" ) == EOK );
+    CHECK( IFSET_Match( &set, "lo" ) );
+
+    IFSET_Free( &set );
+}
+
+/*============================================================================*/
+/*  TestIfSetResolve                                                          */
+/*!
+    Check the interface index bitmap built from an interface table
+
+==============================================================================*/
+static void TestIfSetResolve( void )
+{
+    IfSet set;
+
+    memset( &set, 0, sizeof( set ) );
+    memset( &ifTable, 0, sizeof( ifTable ) );
+
+    ifTable.generation = 1;
+    ifTable.links[0].ifindex = 1;
+    strcpy( ifTable.links[0].ifname, "lo" );
+    ifTable.links[1].ifindex = 2;
+    strcpy( ifTable.links[1].ifname, "eth0" );
+    ifTable.links[2].ifindex = 3;
+    strcpy( ifTable.links[2].ifname, "eth1" );
+    ifTable.nLinks = 3;
+
+    /* an address of an interface which is not in the link table */
+    ifTable.entries[0].ifindex = 70;
+    strcpy( ifTable.entries[0].ifname, "eth7" );
+    ifTable.n = 1;
+
+    CHECK( IFSET_Parse( &set, "eth*, !eth1" ) == EOK );
+    CHECK( IFSET_Resolve( &set, &ifTable ) == EOK );
+    CHECK( IFSET_Contains( &set, 1 ) == false );
+    CHECK( IFSET_Contains( &set, 2 ) );
+    CHECK( IFSET_Contains( &set, 3 ) == false );
+    CHECK( IFSET_Contains( &set, 70 ) );
+    CHECK( IFSET_Contains( &set, 1000 ) == false );
+    CHECK( IFSET_Contains( &set, -1 ) == false );
+
+    /* a new table generation rebuilds the bitmap */
+    strcpy( ifTable.links[2].ifname, "eth2" );
+    ifTable.generation++;
+    CHECK( IFSET_Resolve( &set, &ifTable ) == EOK );
+    CHECK( IFSET_Contains( &set, 3 ) );
+
+    IFSET_Free( &set );
+}
+
+/*============================================================================*/
+/*  AddSegment                                                                */
+/*!
+    Add a segment to a reassembler
+
+    @param[in]
+        pReasm
+            pointer to the segment reassembler
+
+    @param[in]
+        pSource
+            address the segment is received from
+
+    @param[in]
+        msgId
+            message identifier of the segment
+
+    @param[in]
+        index
+            index of the segment
+
+    @param[in]
+        count
+            number of segments in the payload
+
+    @param[in]
+        pData
+            pointer to the segment data
+
+    @param[in]
+        len
+            length of the segment data
+
+    @param[in]
+        now_ns
+            time the segment is received
+
+    @param[out]
+        ppPayload
+            pointer to a location to store the reassembled payload
+
+    @param[out]
+        pLen
+            pointer to a location to store the reassembled payload length
+
+    @return the result of REASM_Add
+
+==============================================================================*/
+static int AddSegment( Reasm *pReasm,
+                       const struct sockaddr_in *pSource,
+                       uint16_t msgId,
+                       uint16_t index,
+                       uint16_t count,
+                       const char *pData,
+                       size_t len,
+                       uint64_t now_ns,
+                       const char **ppPayload,
+                       size_t *pLen )
+{
+    UDPTSegment segment;
+
+    segment.msgId = msgId;
+    segment.index = index;
+    segment.count = count;
+
+    return REASM_Add( pReasm,
+                      (const struct sockaddr *)pSource,
+                      &segment,
+                      pData,
+                      len,
+                      now_ns,
+                      ppPayload,
+                      pLen );
+}
+
+/*============================================================================*/
+/*  TestReasmOrder                                                            */
+/*!
+    Check payloads reassembled from segments received in any order
+
+==============================================================================*/
+static void TestReasmOrder( void )
+{
+    struct sockaddr_in source;
+    Reasm reasm;
+    const char *pPayload = NULL;
+    size_t len = 0;
+
+    memset( &reasm, 0, sizeof( reasm ) );
+    memset( &source, 0, sizeof( source ) );
+    source.sin_family = AF_INET;
+    source.sin_port = htons( 1234 );
+    source.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+
+    /* a single segment is passed straight through */
+    CHECK( AddSegment( &reasm, &source, 1, 0, 1, "abc", 3, 0,
+                       &pPayload, &len ) == EOK );
+    CHECK( ( len == 3 ) && ( memcmp( pPayload, "abc", 3 ) == 0 ) );
+
+    CHECK( AddSegment( &reasm, &source, 2, 1, 3, "efgh", 4, 0,
+                       &pPayload, &len ) == EINPROGRESS );
+    CHECK( AddSegment( &reasm, &source, 2, 0, 3, "abcd", 4, 0,
+                       &pPayload, &len ) == EINPROGRESS );
+    CHECK( AddSegment( &reasm, &source, 2, 2, 3, "ij", 2, 0,
+                       &pPayload, &len ) == EOK );
+    CHECK( ( len == 10 ) && ( memcmp( pPayload, "abcdefghij", 10 ) == 0 ) );
+    CHECK( reasm.completed == 2 );
+
+    /* the index of a segment must be within its payload */
+    CHECK( AddSegment( &reasm, &source, 3, 3, 3, "abcd", 4, 0,
+                       &pPayload, &len ) == EINVAL );
+
+    REASM_Free( &reasm );
+}
+
+/*============================================================================*/
+/*  TestReasmEarlyLast                                                        */
+/*!
+    Check payloads whose last segment arrives before the others
+
+==============================================================================*/
+static void TestReasmEarlyLast( void )
+{
+    struct sockaddr_in source;
+    Reasm reasm;
+    const char *pPayload = NULL;
+    size_t len = 0;
+
+    memset( &reasm, 0, sizeof( reasm ) );
+    memset( &source, 0, sizeof( source ) );
+    source.sin_family = AF_INET;
+    source.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+
+    CHECK( AddSegment( &reasm, &source, 1, 2, 3, "ij", 2, 0,
+                       &pPayload, &len ) == EINPROGRESS );
+    CHECK( AddSegment( &reasm, &source, 1, 0, 3, "abcd", 4, 0,
+                       &pPayload, &len ) == EINPROGRESS );
+    CHECK( AddSegment( &reasm, &source, 1, 1, 3, "efgh", 4, 0,
+                       &pPayload, &len ) == EOK );
+    CHECK( ( len == 10 ) && ( memcmp( pPayload, "abcdefghij", 10 ) == 0 ) );
+
+    /* an early last segment may not be longer than the others */
+    CHECK( AddSegment( &reasm, &source, 2, 1, 2, "efghij", 6, 0,
+                       &pPayload, &len ) == EINPROGRESS );
+    CHECK( AddSegment( &reasm, &source, 2, 0, 2, "abcd", 4, 0,
+                       &pPayload, &len ) == EBADMSG );
+    CHECK( reasm.invalid == 1 );
+
+    REASM_Free( &reasm );
+}
+
+/*============================================================================*/
+/*  TestReasmDuplicate                                                        */
+/*!
+    Check that duplicate segments are ignored
+
+==============================================================================*/
+static void TestReasmDuplicate( void )
+{
+    struct sockaddr_in source;
+    Reasm reasm;
+    const char *pPayload = NULL;
+    size_t len = 0;
+
+    memset( &reasm, 0, sizeof( reasm ) );
+    memset( &source, 0, sizeof( source ) );
+    source.sin_family = AF_INET;
+    source.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+
+    CHECK( AddSegment( &reasm, &source, 1, 0, 2, "abcd", 4, 0,
+                       &pPayload, &len ) == EINPROGRESS );
+    CHECK( AddSegment( &reasm, &source, 1, 0, 2, "wxyz", 4, 0,
+                       &pPayload, &len ) == EINPROGRESS );
+    CHECK( AddSegment( &reasm, &source, 1, 1, 2, "ef", 2, 0,
+                       &pPayload, &len ) == EOK );
+    CHECK( ( len == 6 ) && ( memcmp( pPayload, "abcdef", 6 ) == 0 ) );
+
+    /* a duplicate of a completed payload starts a new one */
+    CHECK( AddSegment( &reasm, &source, 1, 1, 2, "ef", 2, 0,
+                       &pPayload, &len ) == EINPROGRESS );
+    CHECK( reasm.completed == 1 );
+
+    REASM_Free( &reasm );
+}
+
+/*============================================================================*/
+/*  TestReasmInvalid                                                          */
+/*!
+    Check that oversized and inconsistent segments are rejected
+
+==============================================================================*/
+static void TestReasmInvalid( void )
+{
+    struct sockaddr_in source;
+    Reasm reasm;
+    const char *pPayload = NULL;
+    size_t len = 0;
+
+    memset( &reasm, 0, sizeof( reasm ) );
+    memset( &source, 0, sizeof( source ) );
+    source.sin_family = AF_INET;
+    source.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+
+    /* a segment larger than REASM_MAX_SEGMENT */
+    CHECK( AddSegment( &reasm, &source, 1, 0, 2,
+                       bigSegment, sizeof( bigSegment ), 0,
+                       &pPayload, &len ) == EBADMSG );
+
+    /* a payload larger than REASM_MAX_PAYLOAD */
+    CHECK( AddSegment( &reasm, &source, 2, 0, UDPTMSG_MAX_SEGMENTS,
+                       bigSegment, REASM_MAX_SEGMENT, 0,
+                       &pPayload, &len ) == E2BIG );
+
+    /* segments of different sizes */
+    CHECK( AddSegment( &reasm, &source, 3, 0, 3, "abcd", 4, 0,
+                       &pPayload, &len ) == EINPROGRESS );
+    CHECK( AddSegment( &reasm, &source, 3, 1, 3, "efghi", 5, 0,
+                       &pPayload, &len ) == EBADMSG );
+
+    /* a last segment longer than the others */
+    CHECK( AddSegment( &reasm, &source, 4, 0, 2, "abcd", 4, 0,
+                       &pPayload, &len ) == EINPROGRESS );
+    CHECK( AddSegment( &reasm, &source, 4, 1, 2, "efghi", 5, 0,
+                       &pPayload, &len ) == EBADMSG );
+
+    /* empty segments other than the last */
+    CHECK( AddSegment( &reasm, &source, 5, 0, 2, "", 0, 0,
+                       &pPayload, &len ) == EBADMSG );
+
+    CHECK( reasm.invalid == 5 );
+    CHECK( reasm.completed == 0 );
+
+    /* an incomplete payload expires */
+    CHECK( AddSegment( &reasm, &source, 6, 0, 2, "abcd", 4, 0,
+                       &pPayload, &len ) == EINPROGRESS );
+    CHECK( AddSegment( &reasm, &source, 6, 1, 2, "ef", 2,
+                       REASM_TIMEOUT_NS + 1,
+                       &pPayload, &len ) == EINPROGRESS );
+    CHECK( reasm.expired == 1 );
+
+    REASM_Free( &reasm );
+}
+
+/*============================================================================*/
+/*  TestReasmSources                                                          */
+/*!
+    Check that segments from different sources are kept apart
+
+==============================================================================*/
+static void TestReasmSources( void )
+{
+    struct sockaddr_in a;
+    struct sockaddr_in b;
+    Reasm reasm;
+    const char *pPayload = NULL;
+    size_t len = 0;
+
+    memset( &reasm, 0, sizeof( reasm ) );
+    memset( &a, 0, sizeof( a ) );
+    a.sin_family = AF_INET;
+    a.sin_port = htons( 1000 );
+    a.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+    b = a;
+    b.sin_port = htons( 1001 );
+
+    CHECK( AddSegment( &reasm, &a, 7, 0, 2, "aaaa", 4, 0,
+                       &pPayload, &len ) == EINPROGRESS );
+    CHECK( AddSegment( &reasm, &b, 7, 0, 2, "bbbb", 4, 0,
+                       &pPayload, &len ) == EINPROGRESS );
+    CHECK( AddSegment( &reasm, &b, 7, 1, 2, "B", 1, 0,
+                       &pPayload, &len ) == EOK );
+    CHECK( ( len == 5 ) && ( memcmp( pPayload, "bbbbB", 5 ) == 0 ) );
+    CHECK( AddSegment( &reasm, &a, 7, 1, 2, "A", 1, 0,
+                       &pPayload, &len ) == EOK );
+    CHECK( ( len == 5 ) && ( memcmp( pPayload, "aaaaA", 5 ) == 0 ) );
+
+    REASM_Free( &reasm );
+}
+
+/*============================================================================*/
+/*  TestPacingParse                                                           */
+/*!
+    Check the parsing of pacing specifications
+
+==============================================================================*/
+static void TestPacingParse( void )
+{
+    static const char *bad[] =
+    {
+        "eth0",
+        "eth0:0",
+        "eth0:1x",
+        "eth0:1M:fast",
+        "eth0:1M:bucket:1k:2",
+        "eth0:-1k",
+        "eth0:20000000000G",
+        "an_interface_name_too_long:1M"
+    };
+    Pacing pacing;
+    size_t i;
+
+    PACING_Init( &pacing );
+    CHECK( PACING_Parse( &pacing, "eth0:1M,*:100k:txtime:3k" ) == EOK );
+    CHECK( pacing.n == 2 );
+
+    /* the default burst is what the rate sends in PACING_BURST_NS */
+    CHECK( strcmp( pacing.entries[0].ifname, "eth0" ) == 0 );
+    CHECK( pacing.entries[0].rate == 1000000 );
+    CHECK( pacing.entries[0].mode == PACING_MODE_BUCKET );
+    CHECK( pacing.entries[0].burst == 10000 );
+
+    CHECK( strcmp( pacing.entries[1].ifname, "*" ) == 0 );
+    CHECK( pacing.entries[1].rate == 100000 );
+    CHECK( pacing.entries[1].mode == PACING_MODE_TXTIME );
+    CHECK( pacing.entries[1].burst == 3000 );
+
+    /* the burst is never smaller than a datagram */
+    PACING_Init( &pacing );
+    CHECK( PACING_Parse( &pacing, "eth0:1k:fq" ) == EOK );
+    CHECK( pacing.entries[0].burst == PACING_MIN_BURST );
+
+    for ( i = 0; i < sizeof( bad ) / sizeof( bad[0] ); i++ )
+    {
+        PACING_Init( &pacing );
+        CHECK( PACING_Parse( &pacing, bad[i] ) == EINVAL );
+        CHECK( pacing.n == 0 );
+    }
+}
+
+/*============================================================================*/
+/*  TestPacingAdmit                                                           */
+/*!
+    Check the admission of payloads at the pacing rate
+
+==============================================================================*/
+static void TestPacingAdmit( void )
+{
+    uint64_t now = 1000000000ULL;
+    uint64_t launch = 0;
+    PacingEntry *pEntry;
+    Pacing pacing;
+    size_t i;
+
+    PACING_Init( &pacing );
+    CHECK( PACING_Parse( &pacing, "eth0:1M,eth1:100k:txtime" ) == EOK );
+
+    pEntry = &pacing.entries[0];
+    CHECK( PACING_Duration( pEntry, 1000 ) == 1000000 );
+
+    /* an idle interface sends its burst allowance at once */
+    for ( i = 0; i < 10; i++ )
+    {
+        CHECK( PACING_Admit( pEntry, 1000, now, &launch ) == EOK );
+        CHECK( launch == 0 );
+    }
+
+    CHECK( PACING_Admit( pEntry, 1000, now, &launch ) == ENOBUFS );
+
+    /* and then sends at the pacing rate */
+    CHECK( PACING_Admit( pEntry, 1000, now + 1000000, &launch ) == EOK );
+    CHECK( ( pEntry->admitted == 11 ) && ( pEntry->dropped == 1 ) );
+
+    /* txtime defers payloads to launch times at the pacing rate */
+    pEntry = &pacing.entries[1];
+    CHECK( PACING_Admit( pEntry, 1000, now, &launch ) == EOK );
+    CHECK( launch == now );
+    CHECK( PACING_Admit( pEntry, 1000, now, &launch ) == EOK );
+    CHECK( launch == now + 10000000 );
+    CHECK( pEntry->deferred == 1 );
+
+    /* but not beyond the horizon */
+    pEntry->next_ns = now + PACING_HORIZON_NS + 1;
+    CHECK( PACING_Admit( pEntry, 1000, now, &launch ) == ENOBUFS );
+
+    /* a payload larger than the burst allowance is sent by an idle
+       interface, and is charged in full */
+    PACING_Init( &pacing );
+    CHECK( PACING_Parse( &pacing, "eth0:1k" ) == EOK );
+    pEntry = &pacing.entries[0];
+    CHECK( pEntry->burst == 1500 );
+    CHECK( PACING_Admit( pEntry, 4000, now, &launch ) == EOK );
+    CHECK( PACING_Admit( pEntry, 100, now, &launch ) == ENOBUFS );
+}
+
+/*============================================================================*/
+/*  TestLoadGenParse                                                          */
+/*!
+    Check the parsing of load generator specifications
+
+==============================================================================*/
+static void TestLoadGenParse( void )
+{
+    static const char *bad[] =
+    {
+        "4",
+        "0:1k",
+        "4:1x",
+        "4:1k:2k:x",
+        "4:-1k",
+        "4:1k:2k:10:/load:extra"
+    };
+    LoadGen gen;
+    size_t i;
+
+    LOADGEN_Init( &gen );
+
+    CHECK( LOADGEN_Parse( &gen, "4:1k" ) == EOK );
+    CHECK( gen.nSources == 4 );
+    CHECK( ( gen.startRate == 1000 ) && ( gen.endRate == 1000 ) );
+    CHECK( strcmp( gen.prefix, LOADGEN_DEFAULT_PREFIX ) == 0 );
+
+    CHECK( LOADGEN_Parse( &gen, "2:1k:2M:10:/load/test" ) == EOK );
+    CHECK( gen.nSources == 2 );
+    CHECK( ( gen.startRate == 1000 ) && ( gen.endRate == 2000000 ) );
+    CHECK( gen.ramp_ns == 10000000000ULL );
+    CHECK( strcmp( gen.prefix, "/load/test" ) == 0 );
+
+    for ( i = 0; i < sizeof( bad ) / sizeof( bad[0] ); i++ )
+    {
+        CHECK( LOADGEN_Parse( &gen, bad[i] ) == EINVAL );
+    }
+
+    LOADGEN_Free( &gen );
+}
+
+/*============================================================================*/
+/*  TestLoadGenRate                                                           */
+/*!
+    Check the target rate and the rotation of the virtual sources
+
+==============================================================================*/
+static void TestLoadGenRate( void )
+{
+    uint64_t start = 5000000000ULL;
+    LoadSource *pFirst;
+    LoadSource *pSource;
+    LoadGen gen;
+    size_t i;
+
+    LOADGEN_Init( &gen );
+
+    /* a constant rate */
+    CHECK( LOADGEN_Parse( &gen, "4:1k" ) == EOK );
+    CHECK( LOADGEN_Due( &gen, start ) == 0 );
+    LOADGEN_Start( &gen, start, 1 );
+    CHECK( LOADGEN_Target( &gen, start + 500000000ULL ) == 1000 );
+    CHECK( LOADGEN_Due( &gen, start + 1000000000ULL ) == 1000 );
+
+    /* a burst is capped so other events are still served */
+    CHECK( LOADGEN_Due( &gen, start + 2000000000ULL ) == LOADGEN_MAX_BURST );
+
+    /* the sources take turns, and each has its own seed */
+    pFirst = LOADGEN_Next( &gen );
+    for ( i = 1; i < gen.nSources; i++ )
+    {
+        pSource = LOADGEN_Next( &gen );
+        CHECK( ( pSource != pFirst ) && ( pSource->seed != pFirst->seed ) );
+    }
+
+    CHECK( LOADGEN_Next( &gen ) == pFirst );
+
+    LOADGEN_Sent( &gen, pFirst );
+    CHECK( ( pFirst->seq == 1 ) && ( gen.sent == 1 ) );
+    CHECK( LOADGEN_Behind( &gen, start + 1000000000ULL ) == 999 );
+
+    /* a ramp from 1k to 2k transmissions per second over 10 seconds */
+    CHECK( LOADGEN_Parse( &gen, "2:1k:2k:10" ) == EOK );
+    LOADGEN_Start( &gen, start, 2 );
+    CHECK( LOADGEN_Target( &gen, start + 5000000000ULL ) == 1500 );
+    CHECK( LOADGEN_Target( &gen, start + 20000000000ULL ) == 2000 );
+    CHECK( LOADGEN_Behind( &gen, start + 10000000000ULL ) == 15000 );
+
+    LOADGEN_Free( &gen );
+}
+
+/*============================================================================*/
+/*  Parse                                                                     */
+/*!
+    Parse a NUL terminated JSON text
+
+    @param[in]
+        pObject
+            pointer to the JSON object parser
+
+    @param[in]
+        pText
+            pointer to the JSON text
+
+    @return the result of JSONOBJ_Parse
+
+==============================================================================*/
+static int Parse( JsonObject *pObject, const char *pText )
+{
+    return JSONOBJ_Parse( pObject, pText, strlen( pText ) );
+}
+
+/*============================================================================*/
+/*  TestJSONValues                                                            */
+/*!
+    Check the members decoded from valid JSON objects
+
+==============================================================================*/
+static void TestJSONValues( void )
+{
+    JsonObject obj;
+    JsonMember *m;
+
+    CHECK( JSONOBJ_Init( &obj, 4096 ) == EOK );
+
+    CHECK( Parse( &obj, " { } " ) == EOK );
+    CHECK( obj.n == 0 );
+
+    CHECK( Parse( &obj, "{\"a\":0,\"b\":-0.25E+2,\"c\":10e-1}" ) == EOK );
+    CHECK( obj.n == 3 );
+
+    CHECK( Parse( &obj,
+                  "{\"/a\": \"x\\\"y\\u00e9\\ud83d\\ude00\", \"/b\":-1.5e3,"
+                  "\"/c\":true,\"/d\":false, \"/e\" : null}" ) == EOK );
+    CHECK( obj.n == 5 );
+    if ( obj.n == 5 )
+    {
+        m = obj.pMembers;
+        CHECK( ( m[0].nameLen == 2 ) && ( strcmp( m[0].name, "/a" ) == 0 ) );
+        CHECK( m[0].item.type == CBOR_TYPE_TEXT );
+        CHECK( ( m[0].item.len == 9 ) &&
+               ( memcmp( m[0].item.pText,
+                         "x\"y\xc3\xa9\xf0\x9f\x98\x80",
+                         9 ) == 0 ) );
+        CHECK( ( m[1].item.len == 6 ) &&
+               ( memcmp( m[1].item.pText, "-1.5e3", 6 ) == 0 ) );
+        CHECK( ( m[2].item.len == 1 ) && ( m[2].item.pText[0] == '1' ) );
+        CHECK( ( m[3].item.len == 1 ) && ( m[3].item.pText[0] == '0' ) );
+        CHECK( m[4].item.type == CBOR_TYPE_NULL );
+    }
+
+    JSONOBJ_Free( &obj );
+}
+
+/*============================================================================*/
+/*  TestJSONMalformed                                                         */
+/*!
+    Check that malformed JSON objects yield no members
+
+==============================================================================*/
+static void TestJSONMalformed( void )
+{
+    static const char *bad[] =
+    {
+        "",
+        "[1,2]",
+        "{\"a\":1,\"b\":",
+        "{\"a\":1,\"b\":2",
+        "{\"a\":1,}",
+        "{\"a\" 1}",
+        "{a:1}",
+        "{\"a\":1} x",
+        "{\"a\":{\"b\":1}}",
+        "{\"a\":[1]}",
+        "{\"a\":\"\\x\"}",
+        "{\"a\":\"\\u12\"}",
+        "{\"a\":\"abc}",
+        "{\"a\":tru}",
+        "{\"a\":1}}",
+        "{\"a\":--1}",
+        "{\"a\":+.}",
+        "{\"a\":+1}",
+        "{\"a\":1.}",
+        "{\"a\":.5}",
+        "{\"a\":-}",
+        "{\"a\":01}",
+        "{\"a\":1e}",
+        "{\"a\":1e+}",
+        "{\"a\":1.5.2}",
+        "{\"a\":1-2}"
+    };
+    JsonObject obj;
+    size_t i;
+
+    CHECK( JSONOBJ_Init( &obj, 4096 ) == EOK );
+
+    for ( i = 0; i < sizeof( bad ) / sizeof( bad[0] ); i++ )
+    {
+        /* a valid object first, so stale members would be noticed */
+        CHECK( Parse( &obj, "{\"a\":1}" ) == EOK );
+        CHECK( Parse( &obj, bad[i] ) == EBADMSG );
+        CHECK( obj.n == 0 );
+    }
+
+    JSONOBJ_Free( &obj );
+}
+
+/*============================================================================*/
+/*  TestJSONLimits                                                            */
+/*!
+    Check that over-long objects, names and values are rejected
+
+==============================================================================*/
+static void TestJSONLimits( void )
+{
+    size_t maxLen = ( JSONOBJ_MAX_MEMBERS + 1 ) * 8 + JSONOBJ_VALUE_SIZE;
+    JsonObject obj;
+    char *pText;
+    size_t len;
+    size_t i;
+
+    pText = malloc( maxLen + 1 );
+    CHECK( pText != NULL );
+    CHECK( JSONOBJ_Init( &obj, maxLen ) == EOK );
+    if ( pText != NULL )
+    {
+        /* a name longer than MAX_NAME_LEN */
+        len = (size_t)sprintf( pText, "{\"" );
+        memset( &pText[len], 'n', MAX_NAME_LEN + 1 );
+        len += MAX_NAME_LEN + 1;
+        len += (size_t)sprintf( &pText[len], "\":1}" );
+        CHECK( JSONOBJ_Parse( &obj, pText, len ) == E2BIG );
+
+        /* a value longer than JSONOBJ_VALUE_SIZE */
+        len = (size_t)sprintf( pText, "{\"a\":\"" );
+        memset( &pText[len], 'v', JSONOBJ_VALUE_SIZE );
+        len += JSONOBJ_VALUE_SIZE;
+        len += (size_t)sprintf( &pText[len], "\"}" );
+        CHECK( JSONOBJ_Parse( &obj, pText, len ) == E2BIG );
+
+        /* more than JSONOBJ_MAX_MEMBERS members */
+        len = (size_t)sprintf( pText, "{" );
+        for ( i = 0; i <= JSONOBJ_MAX_MEMBERS; i++ )
+        {
+            len += (size_t)sprintf( &pText[len], "\"a\":1," );
+        }
+        pText[len - 1] = '}';
+        CHECK( JSONOBJ_Parse( &obj, pText, len ) == E2BIG );
+        CHECK( obj.n == 0 );
+
+        /* exactly JSONOBJ_MAX_MEMBERS members */
+        len -= 6;
+        pText[len - 1] = '}';
+        CHECK( JSONOBJ_Parse( &obj, pText, len ) == EOK );
+        CHECK( obj.n == JSONOBJ_MAX_MEMBERS );
+
+        /* an object longer than the parser's maximum */
+        CHECK( JSONOBJ_Parse( &obj, pText, maxLen + 1 ) == E2BIG );
+    }
+
+    JSONOBJ_Free( &obj );
+    free( pText );
+}
+
+/*============================================================================*/
+/*  MakeTemplate                                                              */
+/*!
+    Create a template file which references the stub variables
+
+    @param[in,out]
+        filename
+            mkstemp() template for the name of the file to create.
+            On return it contains the name of the created file.
+
+    @param[in]
+        nVars
+            number of variable references in the template
+
+    @retval EOK the template was created
+    @retval EIO the template could not be written
+    @retval other error from mkstemp() or close()
+
+==============================================================================*/
+static int MakeTemplate( char *filename, size_t nVars )
+{
+    int result = EOK;
+    size_t i;
+    int fd;
+
+    fd = mkstemp( filename );
+    if ( fd == -1 )
+    {
+        result = errno;
+    }
+
+    for ( i = 0; ( result == EOK ) && ( i < nVars ); i++ )
+    {
+        if ( dprintf( fd, "v%zu=${" VARSTUB_PREFIX "%zu};", i, i ) < 0 )
+        {
+            result = EIO;
+        }
+    }
+
+    if ( ( fd != -1 ) &&
+         ( close( fd ) != 0 ) &&
+         ( result == EOK ) )
+    {
+        result = errno;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  DirtyHeap                                                                 */
+/*!
+    Fill freed heap memory with non-zero bytes
+
+    The DirtyHeap function allocates, fills and frees blocks of the sizes
+    a growing template element array is allocated with, so a following
+    compile gets memory which was not zeroed.
+
+==============================================================================*/
+static void DirtyHeap( void )
+{
+    void *p[8];
+    size_t n = 16;
+    size_t i;
+
+    for ( i = 0; i < sizeof( p ) / sizeof( p[0] ); i++ )
+    {
+        p[i] = malloc( n * sizeof( CTElement ) );
+        if ( p[i] != NULL )
+        {
+            memset( p[i], 0xff, n * sizeof( CTElement ) );
+        }
+
+        n *= 2;
+    }
+
+    for ( i = 0; i < sizeof( p ) / sizeof( p[0] ); i++ )
+    {
+        free( p[i] );
+    }
+}
+
+/*============================================================================*/
+/*  CountNotified                                                             */
+/*!
+    Count the variable references of a template which are notified
+
+    @param[in]
+        pTemplate
+            pointer to the compiled template
+
+    @return the number of notified variable references
+
+==============================================================================*/
+static size_t CountNotified( CompiledTemplate *pTemplate )
+{
+    size_t n = 0;
+    size_t i;
+
+    for ( i = 0; i < pTemplate->nElements; i++ )
+    {
+        if ( ( pTemplate->elements[i].isVar == true ) &&
+             ( pTemplate->elements[i].notified == true ) )
+        {
+            n++;
+        }
+    }
+
+    return n;
+}
+
+/*============================================================================*/
+/*  TestTemplateSubscribe                                                     */
+/*!
+    Check that every variable reference of a compiled template is
+    subscribed, including after a re-compile
+
+==============================================================================*/
+static void TestTemplateSubscribe( void )
+{
+    char filename[] = "/tmp/udpt_selftestXXXXXX";
+    CompiledTemplate compiled;
+    VAR_HANDLE exclude = (VAR_HANDLE)1;
+
+    memset( &compiled, 0, sizeof( compiled ) );
+
+    CHECK( MakeTemplate( filename, TEST_TEMPLATE_VARS ) == EOK );
+
+    DirtyHeap();
+    CHECK( CTEMPLATE_Compile( &compiled, NULL, filename ) == EOK );
+    CHECK( compiled.nVars == TEST_TEMPLATE_VARS );
+    CHECK( CountNotified( &compiled ) == 0 );
+
+    /* every reference but the excluded one is subscribed */
+    CHECK( CTEMPLATE_Subscribe( &compiled, NULL, &exclude, 1 ) == EOK );
+    CHECK( CountNotified( &compiled ) == TEST_TEMPLATE_VARS - 1 );
+    CHECK( compiled.elements[1].hVar == exclude );
+    CHECK( compiled.elements[1].notified == false );
+
+    /* a re-compile reuses the freed, notified, element array */
+    DirtyHeap();
+    CHECK( CTEMPLATE_Compile( &compiled, NULL, filename ) == EOK );
+    CHECK( CountNotified( &compiled ) == 0 );
+    CHECK( CTEMPLATE_Subscribe( &compiled, NULL, NULL, 0 ) == EOK );
+    CHECK( CountNotified( &compiled ) == TEST_TEMPLATE_VARS );
+
+    CTEMPLATE_Free( &compiled );
+    CHECK( CTEMPLATE_Subscribe( &compiled, NULL, NULL, 0 ) == ENOENT );
+
+    unlink( filename );
+}
+
+/*============================================================================*/
+/*  RenderCached                                                              */
+/*!
+    Take a new snapshot and render a template from it with the cache
+
+    @param[in]
+        pTemplate
+            pointer to the compiled template
+
+    @param[in]
+        pSnap
+            pointer to the snapshot of the template variables
+
+    @param[in]
+        pBuffer
+            pointer to the buffer to render into
+
+    @return the result of CTEMPLATE_RenderCached
+
+==============================================================================*/
+static int RenderCached( CompiledTemplate *pTemplate,
+                         VarSnapshot *pSnap,
+                         CTBuffer *pBuffer )
+{
+    (void)VARSNAP_Take( pSnap, NULL );
+
+    return CTEMPLATE_RenderCached( pTemplate, NULL, pSnap, pBuffer, NULL );
+}
+
+/*============================================================================*/
+/*  TestTemplateCached                                                        */
+/*!
+    Check that a cached render only reuses the text of notified references
+
+    Every snapshot of a stub variable has a new value.  The notified
+    reference keeps its cached text until it is invalidated, while the
+    reference which is not notified is formatted again by every render.
+
+==============================================================================*/
+static void TestTemplateCached( void )
+{
+    char filename[] = "/tmp/udpt_selftestXXXXXX";
+    CompiledTemplate compiled;
+    VarSnapshot snap;
+    CTBuffer buffer;
+    char text[64];
+    VAR_HANDLE exclude;
+    size_t i;
+
+    memset( &compiled, 0, sizeof( compiled ) );
+    memset( &snap, 0, sizeof( snap ) );
+    memset( &buffer, 0, sizeof( buffer ) );
+    buffer.pBuf = text;
+    buffer.size = sizeof( text );
+    buffer.fd = -1;
+
+    CHECK( MakeTemplate( filename, 2 ) == EOK );
+
+    DirtyHeap();
+    CHECK( CTEMPLATE_Compile( &compiled, NULL, filename ) == EOK );
+    CHECK( compiled.nVars == 2 );
+    if ( compiled.nVars == 2 )
+    {
+        /* only the first reference is notified */
+        exclude = compiled.elements[3].hVar;
+        CHECK( CTEMPLATE_Subscribe( &compiled, NULL, &exclude, 1 ) == EOK );
+
+        for ( i = 0; i < compiled.nElements; i++ )
+        {
+            if ( compiled.elements[i].isVar == true )
+            {
+                CHECK( VARSNAP_Add( &snap,
+                                    compiled.elements[i].hVar ) == EOK );
+            }
+        }
+
+        CHECK( RenderCached( &compiled, &snap, &buffer ) == EOK );
+        CHECK( strcmp( text, "v0=0;v1=0;" ) == 0 );
+
+        CHECK( RenderCached( &compiled, &snap, &buffer ) == EOK );
+        CHECK( strcmp( text, "v0=0;v1=1;" ) == 0 );
+
+        CHECK( RenderCached( &compiled, &snap, &buffer ) == EOK );
+        CHECK( strcmp( text, "v0=0;v1=2;" ) == 0 );
+        CHECK( compiled.reused == 2 );
+
+        CHECK( CTEMPLATE_Invalidate( &compiled, compiled.elements[1].hVar ) );
+        CHECK( RenderCached( &compiled, &snap, &buffer ) == EOK );
+        CHECK( strcmp( text, "v0=3;v1=3;" ) == 0 );
+        CHECK( compiled.reused == 2 );
+    }
+
+    VARSNAP_Free( &snap );
+    CTEMPLATE_Free( &compiled );
+    unlink( filename );
+}
+
+/*! @}
+ * end of udpt_selftest group */